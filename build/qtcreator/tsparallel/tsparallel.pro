@@ -0,0 +1,3 @@
+CONFIG += tstool
+TARGET = tsparallel
+include(../tsduck.pri)
@@ -0,0 +1,3 @@
+CONFIG += tsplugin
+TARGET = tsplugin_svsplit
+include(../tsduck.pri)
@@ -0,0 +1,147 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck sample benchmark: operations on sets of PID's.
+//
+// A large multiplex is simulated with 128 services, each one with one PMT
+// PID and 6 component PID's. When the PMT of a service changes, the set of
+// PID's of the service is updated and the PID filter of a section demux is
+// rebuilt, as in most plugins which track the services of a stream.
+//
+// Usage: pidset-benchmark [iterations]
+//
+//----------------------------------------------------------------------------
+
+#include "tsduck.h"
+#include <iomanip>
+
+namespace {
+
+    // Description of the simulated multiplex.
+    const size_t SERVICE_COUNT = 128;
+    const size_t COMPONENT_COUNT = 6;
+    const ts::PID PMT_PID_BASE = 0x0100;
+    const ts::PID COMPONENT_PID_BASE = 0x1000;
+    const ts::PID COMPONENT_PID_ALT = 0x1800;  // Component PID's after a PMT change.
+
+    // Number of packets in a batch for TSPacket::FindPID().
+    const size_t BATCH_SIZE = 1024;
+
+    // Accumulate results here, so that the compiler does not optimize the tests away.
+    volatile size_t sink = 0;
+
+    // Run a test and display the average duration of one iteration.
+    template <class FUNC>
+    void Run(const char* title, size_t iterations, FUNC func)
+    {
+        const ts::Monotonic start(true);
+        for (size_t i = 0; i < iterations; ++i) {
+            func(i);
+        }
+        const ts::NanoSecond duration = ts::Monotonic(true) - start;
+        std::cout << std::left << std::setw(48) << title << std::right << std::setw(10)
+                  << (duration / ts::NanoSecond(iterations)) << " ns" << std::endl;
+    }
+
+    // Set of PID's of a service, before or after a PMT change.
+    ts::PIDSet ServicePIDs(size_t service, bool changed)
+    {
+        ts::PIDSet pids;
+        pids.set(PMT_PID_BASE + service);
+        for (size_t i = 0; i < COMPONENT_COUNT; ++i) {
+            pids.set((changed ? COMPONENT_PID_ALT : COMPONENT_PID_BASE) + service * COMPONENT_COUNT + i);
+        }
+        return pids;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Application entry point.
+//----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    const size_t iterations = argc > 1 ? size_t(std::max(1, std::atoi(argv[1]))) : 100000;
+    std::cout << "PID set benchmark, " << SERVICE_COUNT << " services, "
+              << iterations << " iterations per test" << std::endl;
+
+    // Initial state of the multiplex.
+    std::vector<ts::PIDSet> services(SERVICE_COUNT);
+    std::vector<bool> changed(SERVICE_COUNT, false);
+    ts::PIDSet all_pids;
+    all_pids.set(ts::PID_PAT);
+    all_pids.set(ts::PID_SDT);
+    for (size_t srv = 0; srv < SERVICE_COUNT; ++srv) {
+        services[srv] = ServicePIDs(srv, false);
+        all_pids |= services[srv];
+    }
+
+    ts::DuckContext duck;
+    ts::SectionDemux demux(duck, nullptr, nullptr, all_pids);
+
+    // Table change handling: the PMT of one service changes, the PID filter of the demux is rebuilt.
+    Run("PMT change, rebuild demux PID filter", iterations, [&](size_t i) {
+        const size_t srv = i % SERVICE_COUNT;
+        changed[srv] = !changed[srv];
+        const ts::PIDSet pids(ServicePIDs(srv, changed[srv]));
+        all_pids.exclude(services[srv]);
+        all_pids |= pids;
+        services[srv] = pids;
+        demux.setPIDFilter(all_pids);
+    });
+
+    // Table change handling: find which PID's of a service were removed and added.
+    Run("PMT change, list removed and added PID's", iterations, [&](size_t i) {
+        const size_t srv = i % SERVICE_COUNT;
+        ts::PIDSet removed(services[srv]);
+        ts::PIDSet added(ServicePIDs(srv, !changed[srv]));
+        removed.exclude(added);
+        added.exclude(services[srv]);
+        size_t count = 0;
+        for (size_t pid = removed.first(); pid < removed.size(); pid = removed.next(pid)) {
+            count++;
+        }
+        for (size_t pid = added.first(); pid < added.size(); pid = added.next(pid)) {
+            count++;
+        }
+        sink = sink + count;
+    });
+
+    // Iteration on all PID's of the multiplex, bit by bit and using the set bits only.
+    Run("Iterate on the PID's of the mux, bit by bit", iterations, [&](size_t) {
+        size_t sum = 0;
+        for (size_t pid = 0; pid < all_pids.size(); ++pid) {
+            if (all_pids.test(pid)) {
+                sum += pid;
+            }
+        }
+        sink = sink + sum;
+    });
+    Run("Iterate on the PID's of the mux, first/next", iterations, [&](size_t) {
+        size_t sum = 0;
+        for (size_t pid = all_pids.first(); pid < all_pids.size(); pid = all_pids.next(pid)) {
+            sum += pid;
+        }
+        sink = sink + sum;
+    });
+
+    // Check if a service is affected by a batch of packets, packet by packet and in bulk.
+    ts::TSPacketVector batch(BATCH_SIZE);
+    for (size_t i = 0; i < BATCH_SIZE; ++i) {
+        batch[i].init(ts::PID(COMPONENT_PID_BASE + i % (SERVICE_COUNT * COMPONENT_COUNT)));
+    }
+    const ts::PIDSet target(ServicePIDs(SERVICE_COUNT - 1, true));
+    batch[BATCH_SIZE - 1].setPID(PMT_PID_BASE + SERVICE_COUNT - 1);
+    Run("Find a service PID in 1024 packets, one by one", iterations, [&](size_t) {
+        size_t index = 0;
+        while (index < BATCH_SIZE && !target.test(batch[index].getPID())) {
+            index++;
+        }
+        sink = sink + index;
+    });
+    Run("Find a service PID in 1024 packets, FindPID", iterations, [&](size_t) {
+        sink = sink + ts::TSPacket::FindPID(batch.data(), BATCH_SIZE, target);
+    });
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck sample benchmark: serialization and deserialization of PSI/SI.
+//
+// Large PAT, PMT, SDT, NIT and EIT are built, as found in a large multiplex
+// or a large network. Each table is serialized into sections and the
+// sections are deserialized into a table object.
+//
+// Usage: tables-benchmark [iterations]
+//
+//----------------------------------------------------------------------------
+
+#include "tsduck.h"
+#include <iomanip>
+
+namespace {
+
+    // Accumulate results here, so that the compiler does not optimize the tests away.
+    volatile size_t sink = 0;
+
+    // Run a test and display the average duration of one iteration.
+    template <class FUNC>
+    void Run(const std::string& title, size_t iterations, FUNC func)
+    {
+        const ts::Monotonic start(true);
+        for (size_t i = 0; i < iterations; ++i) {
+            func();
+        }
+        const ts::NanoSecond duration = ts::Monotonic(true) - start;
+        std::cout << std::left << std::setw(40) << title << std::right << std::setw(12)
+                  << (duration / ts::NanoSecond(iterations)) << " ns" << std::endl;
+    }
+
+    // Serialize and deserialize one table.
+    template <class TABLE>
+    void RunTable(ts::DuckContext& duck, const std::string& name, const TABLE& table, size_t iterations)
+    {
+        ts::BinaryTable bin;
+        table.serialize(duck, bin);
+        const std::string title(name + " (" + std::to_string(bin.sectionCount()) + " sections)");
+
+        Run(title + ", serialize", iterations, [&]() {
+            ts::BinaryTable out;
+            table.serialize(duck, out);
+            sink = sink + out.sectionCount();
+        });
+        Run(title + ", deserialize", iterations, [&]() {
+            TABLE in(duck, bin);
+            sink = sink + in.isValid();
+        });
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Application entry point.
+//----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    const size_t iterations = argc > 1 ? size_t(std::max(1, std::atoi(argv[1]))) : 1000;
+    std::cout << "PSI/SI benchmark, " << iterations << " iterations per test" << std::endl;
+
+    ts::DuckContext duck;
+
+    // A PAT with 200 services.
+    ts::PAT pat(1, true, 0x0001);
+    for (uint16_t i = 0; i < 200; ++i) {
+        pat.pmts[uint16_t(i + 1)] = ts::PID(0x0100 + i);
+    }
+    RunTable(duck, "PAT", pat, iterations);
+
+    // A PMT with one video, 8 audio and 8 subtitle streams.
+    ts::PMT pmt(1, true, 0x0001, 0x1000);
+    for (uint16_t i = 0; i < 17; ++i) {
+        ts::PMT::Stream& stream(pmt.streams[ts::PID(0x1000 + i)]);
+        stream.stream_type = i == 0 ? ts::ST_AVC_VIDEO : (i <= 8 ? ts::ST_MPEG1_AUDIO : ts::ST_PES_PRIV);
+        stream.descs.add(duck, ts::StreamIdentifierDescriptor(uint8_t(i)));
+        if (i > 0) {
+            stream.descs.add(duck, ts::ISO639LanguageDescriptor(u"eng", 0));
+        }
+    }
+    RunTable(duck, "PMT", pmt, iterations);
+
+    // An SDT with 200 services.
+    ts::SDT sdt(true, 1, true, 0x0001, 0x0001);
+    for (uint16_t i = 0; i < 200; ++i) {
+        ts::SDT::Service& srv(sdt.services[uint16_t(i + 1)]);
+        srv.EITpf_present = true;
+        srv.running_status = ts::RS_RUNNING;
+        srv.setName(duck, ts::UString::Format(u"Service %d", {i + 1}));
+        srv.setProvider(duck, u"Provider");
+    }
+    RunTable(duck, "SDT", sdt, iterations);
+
+    // A NIT with 100 transport streams of 20 services each.
+    ts::NIT nit(true, 1, true, 0x0001);
+    nit.descs.add(duck, ts::NetworkNameDescriptor(u"Network"));
+    for (uint16_t ts_id = 1; ts_id <= 100; ++ts_id) {
+        ts::NIT::Transport& ts(nit.transports[ts::TransportStreamId(ts_id, 0x0001)]);
+        ts::ServiceListDescriptor sld;
+        for (uint16_t i = 0; i < 20; ++i) {
+            sld.entries.push_back(ts::ServiceListDescriptor::Entry(uint16_t(ts_id * 20 + i), 0x01));
+        }
+        ts.descs.add(duck, sld);
+    }
+    RunTable(duck, "NIT", nit, iterations);
+
+    // An EIT schedule with 200 events.
+    ts::EIT eit(true, false, 0, 1, true, 0x0001, 0x0001, 0x0001);
+    const ts::Time base(2020, 1, 1, 0, 0);
+    for (uint16_t i = 0; i < 200; ++i) {
+        ts::EIT::Event& ev(eit.events.newEntry());
+        ev.event_id = uint16_t(i + 1);
+        ev.start_time = base + ts::MilliSecond(i) * 30 * ts::MilliSecPerMin;
+        ev.duration = 30 * 60;
+        ev.running_status = ts::RS_NOT_RUNNING;
+        ev.descs.add(duck, ts::ShortEventDescriptor(u"eng", ts::UString::Format(u"Event %d", {i + 1}), u"Description of the event"));
+    }
+    RunTable(duck, "EIT", eit, iterations);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,607 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsjsonReader.h"
+#include "tsjsonNull.h"
+#include "tsjsonTrue.h"
+#include "tsjsonFalse.h"
+#include "tsjsonNumber.h"
+#include "tsjsonString.h"
+#include "tsjsonObject.h"
+#include "tsjsonArray.h"
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::json::Reader::DEFAULT_CHUNK_SIZE;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Constructors.
+//----------------------------------------------------------------------------
+
+ts::json::Reader::Reader(std::istream& stream, Report& report, size_t chunk_size) :
+    _stream(stream),
+    _report(report),
+    _buffer(std::max<size_t>(chunk_size, 16)),
+    _pos(0),
+    _end(0),
+    _eof(false),
+    _started(false),
+    _line(1),
+    _event(EndOfStream),
+    _frames(),
+    _depth(0),
+    _path_depth(0),
+    _raw(),
+    _text()
+{
+}
+
+ts::json::Reader::Frame::Frame() :
+    is_array(false),
+    name_done(false),
+    count(0),
+    name()
+{
+}
+
+ts::json::Reader::PatternItem::PatternItem() :
+    is_index(false),
+    any(false),
+    index(0),
+    name()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Low-level input.
+//----------------------------------------------------------------------------
+
+bool ts::json::Reader::fill()
+{
+    while (!_eof) {
+        _pos = 0;
+        _end = 0;
+        if (_stream) {
+            _stream.read(_buffer.data(), std::streamsize(_buffer.size()));
+            _end = size_t(_stream.gcount());
+        }
+        if (_end == 0) {
+            _eof = true;
+        }
+        else {
+            // Skip the optional UTF-8 BOM at start of stream.
+            if (!_started && _end >= UString::UTF8_BOM_SIZE && ::memcmp(_buffer.data(), UString::UTF8_BOM, UString::UTF8_BOM_SIZE) == 0) {
+                _pos = UString::UTF8_BOM_SIZE;
+            }
+            _started = true;
+            if (_pos < _end) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+int ts::json::Reader::skipWhiteSpace()
+{
+    int c;
+    while ((c = peekChar()) == ' ' || c == '\t' || c == '\r' || c == '\n') {
+        if (c == '\n') {
+            _line++;
+        }
+        skipChar();
+    }
+    return c;
+}
+
+
+//----------------------------------------------------------------------------
+// Report an error.
+//----------------------------------------------------------------------------
+
+ts::json::Reader::Event ts::json::Reader::error(const UChar* message)
+{
+    _report.error(u"line %d: %s", {_line, message});
+    return _event = Error;
+}
+
+
+//----------------------------------------------------------------------------
+// Read the next event.
+//----------------------------------------------------------------------------
+
+ts::json::Reader::Event ts::json::Reader::next()
+{
+    // Errors are final.
+    if (_event == Error) {
+        return Error;
+    }
+
+    int c = skipWhiteSpace();
+
+    // Outside any object or array, expect a new top-level value or end of stream.
+    if (_depth == 0) {
+        _path_depth = 0;
+        return c < 0 ? (_event = EndOfStream) : readValueStart();
+    }
+    if (c < 0) {
+        return error(u"unexpected end of JSON text");
+    }
+
+    Frame& top(_frames[_depth - 1]);
+    _path_depth = _depth;
+
+    if (top.is_array) {
+        // Inside an array, expect end of array or next element.
+        if (c == ']') {
+            skipChar();
+            _path_depth = --_depth;
+            return _event = EndArray;
+        }
+        if (top.count > 0) {
+            if (c != ',') {
+                return error(u"syntax error in JSON array, missing ','");
+            }
+            skipChar();
+            skipWhiteSpace();
+        }
+        top.count++;
+        return readValueStart();
+    }
+    else if (top.name_done) {
+        // Inside an object, after the member name, expect the member value.
+        top.name_done = false;
+        return readValueStart();
+    }
+    else {
+        // Inside an object, expect end of object or next member name.
+        if (c == '}') {
+            skipChar();
+            _path_depth = --_depth;
+            return _event = EndObject;
+        }
+        if (top.count > 0) {
+            if (c != ',') {
+                return error(u"syntax error in JSON object, missing ','");
+            }
+            skipChar();
+            c = skipWhiteSpace();
+        }
+        if (c != '"') {
+            return error(u"syntax error in JSON object, expected member name");
+        }
+        if (!readString()) {
+            return _event;
+        }
+        if (skipWhiteSpace() != ':') {
+            return error(u"syntax error in JSON object, missing ':'");
+        }
+        skipChar();
+        top.count++;
+        top.name = _text;
+        top.name_done = true;
+        return _event = Name;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Read the start of a value.
+//----------------------------------------------------------------------------
+
+ts::json::Reader::Event ts::json::Reader::readValueStart()
+{
+    const int c = peekChar();
+    switch (c) {
+        case '{':
+            skipChar();
+            pushFrame(false);
+            return _event = BeginObject;
+        case '[':
+            skipChar();
+            pushFrame(true);
+            return _event = BeginArray;
+        case '"':
+            return readString() ? (_event = StringValue) : _event;
+        case 't':
+            return readLiteral("true") ? (_event = TrueValue) : _event;
+        case 'f':
+            return readLiteral("false") ? (_event = FalseValue) : _event;
+        case 'n':
+            return readLiteral("null") ? (_event = NullValue) : _event;
+        default:
+            if (c == '-' || (c >= '0' && c <= '9')) {
+                return readNumber() ? (_event = NumberValue) : _event;
+            }
+            return error(u"not a valid JSON value");
+    }
+}
+
+ts::json::Reader::Frame& ts::json::Reader::pushFrame(bool is_array)
+{
+    // The frames are never deallocated to reuse the allocated names.
+    if (_depth >= _frames.size()) {
+        _frames.resize(_depth + 1);
+    }
+    Frame& frame(_frames[_depth++]);
+    frame.is_array = is_array;
+    frame.name_done = false;
+    frame.count = 0;
+    frame.name.clear();
+    return frame;
+}
+
+
+//----------------------------------------------------------------------------
+// Read a string literal. The current character is the opening quote.
+//----------------------------------------------------------------------------
+
+bool ts::json::Reader::readString()
+{
+    skipChar();
+    _raw.clear();
+    bool escaped = false;
+
+    for (;;) {
+        if (_pos >= _end && !fill()) {
+            error(u"unterminated JSON string");
+            return false;
+        }
+
+        // Copy the longest sequence of plain characters in the current chunk.
+        const char* const start = _buffer.data() + _pos;
+        const char* const end = _buffer.data() + _end;
+        const char* p = start;
+        while (p < end && *p != '"' && *p != '\\' && *p != '\n') {
+            ++p;
+        }
+        _raw.append(start, p - start);
+        _pos += p - start;
+
+        if (p == end) {
+            continue;
+        }
+        else if (*p == '"') {
+            skipChar();
+            break;
+        }
+        else if (*p == '\n') {
+            error(u"unterminated JSON string");
+            return false;
+        }
+        else {
+            // Backslash sequence, keep it with next character, decoded later.
+            escaped = true;
+            _raw.push_back('\\');
+            skipChar();
+            const int c = peekChar();
+            if (c < 0 || c == '\n') {
+                error(u"unterminated JSON string");
+                return false;
+            }
+            _raw.push_back(char(c));
+            skipChar();
+        }
+    }
+
+    // The string is decoded in place to reuse the allocated memory.
+    _text.assignFromUTF8(_raw);
+    if (escaped) {
+        _text.convertFromJSON();
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Read a number or a literal.
+//----------------------------------------------------------------------------
+
+bool ts::json::Reader::readNumber()
+{
+    // JSON syntax: -? (0 | [1-9][0-9]*) (.[0-9]+)? ([eE][+-]?[0-9]+)?
+    _raw.clear();
+    int c = peekChar();
+    if (c == '-') {
+        _raw.push_back(char(c));
+        skipChar();
+        c = peekChar();
+    }
+    bool valid = c == '0' ? readDigits() == 1 : readDigits() > 0;
+    c = peekChar();
+    if (valid && c == '.') {
+        _raw.push_back(char(c));
+        skipChar();
+        valid = readDigits() > 0;
+        c = peekChar();
+    }
+    if (valid && (c == 'e' || c == 'E')) {
+        _raw.push_back(char(c));
+        skipChar();
+        c = peekChar();
+        if (c == '+' || c == '-') {
+            _raw.push_back(char(c));
+            skipChar();
+        }
+        valid = readDigits() > 0;
+        c = peekChar();
+    }
+    // A number cannot be immediately followed by another number character.
+    if (!valid || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E' || (c >= '0' && c <= '9')) {
+        error(u"invalid JSON number");
+        return false;
+    }
+    _text.assignFromUTF8(_raw);
+    return true;
+}
+
+size_t ts::json::Reader::readDigits()
+{
+    size_t count = 0;
+    int c;
+    while ((c = peekChar()) >= '0' && c <= '9') {
+        _raw.push_back(char(c));
+        skipChar();
+        count++;
+    }
+    return count;
+}
+
+bool ts::json::Reader::readLiteral(const char* literal)
+{
+    for (const char* p = literal; *p != 0; ++p) {
+        if (peekChar() != int(uint8_t(*p))) {
+            error(u"not a valid JSON value");
+            return false;
+        }
+        skipChar();
+    }
+    return true;
+}
+
+bool ts::json::Reader::intValue(int64_t& value) const
+{
+    return _event == NumberValue && _text.toInteger(value);
+}
+
+
+//----------------------------------------------------------------------------
+// Path of last event.
+//----------------------------------------------------------------------------
+
+ts::UString ts::json::Reader::path() const
+{
+    UString result;
+    for (size_t i = 0; i < _path_depth; ++i) {
+        const Frame& frame(_frames[i]);
+        if (frame.is_array) {
+            result.append(UString::Format(u"[%d]", {frame.count - 1}));
+        }
+        else {
+            if (!result.empty()) {
+                result.push_back(u'.');
+            }
+            result.append(frame.name);
+        }
+    }
+    return result;
+}
+
+void ts::json::Reader::ParsePattern(Pattern& pattern, const UString& str)
+{
+    pattern.clear();
+    const size_t len = str.length();
+    size_t i = 0;
+    while (i < len) {
+        PatternItem item;
+        if (str[i] == u'[') {
+            // Array index.
+            const size_t close = str.find(u']', i);
+            const UString index(str.substr(i + 1, close == NPOS ? NPOS : close - i - 1));
+            item.is_index = true;
+            item.any = index == u"*";
+            if (!item.any && !index.toInteger(item.index)) {
+                item.index = NPOS; // never match
+            }
+            i = close == NPOS ? len : close + 1;
+        }
+        else {
+            // Member name.
+            if (str[i] == u'.') {
+                i++;
+            }
+            size_t end = i;
+            while (end < len && str[end] != u'.' && str[end] != u'[') {
+                end++;
+            }
+            item.name = str.substr(i, end - i);
+            item.any = item.name == u"*";
+            i = end;
+        }
+        pattern.push_back(item);
+    }
+}
+
+bool ts::json::Reader::matchPattern(const Pattern& pattern) const
+{
+    if (pattern.size() != _path_depth) {
+        return false;
+    }
+    for (size_t i = 0; i < _path_depth; ++i) {
+        const Frame& frame(_frames[i]);
+        const PatternItem& item(pattern[i]);
+        if (item.is_index != frame.is_array) {
+            return false;
+        }
+        if (!item.any && (frame.is_array ? item.index != frame.count - 1 : item.name != frame.name)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ts::json::Reader::matchPath(const UString& pattern) const
+{
+    Pattern pat;
+    ParsePattern(pat, pattern);
+    return matchPattern(pat);
+}
+
+
+//----------------------------------------------------------------------------
+// Read events until the start of a value which matches a path pattern.
+//----------------------------------------------------------------------------
+
+bool ts::json::Reader::findNext(const UString& pattern)
+{
+    Pattern pat;
+    ParsePattern(pat, pattern);
+    for (;;) {
+        switch (next()) {
+            case EndOfStream:
+            case Error:
+                return false;
+            case Name:
+            case EndObject:
+            case EndArray:
+                break;
+            default:
+                if (matchPattern(pat)) {
+                    return true;
+                }
+                break;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Skip the value which starts at the last event.
+//----------------------------------------------------------------------------
+
+bool ts::json::Reader::skipValue()
+{
+    if (_event == Name) {
+        next();
+    }
+    if (_event == BeginObject || _event == BeginArray) {
+        const size_t target = _depth - 1;
+        while (_depth > target) {
+            const Event ev = next();
+            if (ev == Error || ev == EndOfStream) {
+                return false;
+            }
+        }
+    }
+    return _event != Error && _event != EndOfStream;
+}
+
+
+//----------------------------------------------------------------------------
+// Read a complete JSON value as a tree of JSON values.
+//----------------------------------------------------------------------------
+
+bool ts::json::Reader::readValue(ValuePtr& value)
+{
+    if (_event == Name) {
+        next();
+    }
+    return buildValue(value);
+}
+
+bool ts::json::Reader::buildValue(ValuePtr& value)
+{
+    value.clear();
+    switch (_event) {
+        case NullValue:
+            value = new Null;
+            return true;
+        case TrueValue:
+            value = new True;
+            return true;
+        case FalseValue:
+            value = new False;
+            return true;
+        case StringValue:
+            value = new String(_text);
+            return true;
+        case NumberValue: {
+            int64_t intVal = 0;
+            if (intValue(intVal)) {
+                value = new Number(intVal);
+            }
+            else {
+                // Same as ts::json::Parse().
+                _report.error(u"line %d: JSON floating-point numbers not yet supported, using \"null\" instead", {_line});
+                value = new Null;
+            }
+            return true;
+        }
+        case BeginArray: {
+            value = new Array;
+            while (next() != EndArray) {
+                ValuePtr element;
+                if (!buildValue(element)) {
+                    value.clear();
+                    return false;
+                }
+                value->set(element);
+            }
+            return true;
+        }
+        case BeginObject: {
+            value = new Object;
+            while (next() != EndObject) {
+                ValuePtr element;
+                if (_event != Name) {
+                    value.clear();
+                    return false;
+                }
+                const UString name(_text);
+                next();
+                if (!buildValue(element)) {
+                    value.clear();
+                    return false;
+                }
+                value->add(name, element);
+            }
+            return true;
+        }
+        case EndObject:
+        case EndArray:
+        case Name:
+        case EndOfStream:
+        case Error:
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,249 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Streaming (pull-style) JSON reader.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsjson.h"
+
+namespace ts {
+    namespace json {
+        //!
+        //! Streaming (pull-style) JSON reader.
+        //! @ingroup json
+        //!
+        //! Unlike ts::json::Parse(), this class does not build a tree of values.
+        //! The JSON text is read from a standard stream in chunks of fixed size and
+        //! the application pulls "events" one by one using next(). The memory usage
+        //! is independent of the size of the JSON text: it only depends on the chunk
+        //! size, the nesting depth and the size of the largest string.
+        //!
+        //! The input stream may contain several JSON values, one after the other.
+        //! This is typically the case of "JSON lines" event feeds.
+        //!
+        //! Example: print the title of all events in the array "events".
+        //! @code
+        //! std::ifstream file("feed.json");
+        //! ts::json::Reader reader(file, CERR);
+        //! while (reader.findNext(u"events[*].title")) {
+        //!     std::cout << reader.text() << std::endl;
+        //! }
+        //! @endcode
+        //!
+        class TSDUCKDLL Reader
+        {
+            TS_NOBUILD_NOCOPY(Reader);
+        public:
+            //!
+            //! Default size in bytes of input chunks.
+            //!
+            static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+            //!
+            //! Events which are returned by the reader.
+            //!
+            enum Event {
+                BeginObject,  //!< Start of an object.
+                EndObject,    //!< End of an object.
+                BeginArray,   //!< Start of an array.
+                EndArray,     //!< End of an array.
+                Name,         //!< Name of an object member, followed by the value of the member.
+                StringValue,  //!< A string value.
+                NumberValue,  //!< A number value.
+                NullValue,    //!< The null literal.
+                TrueValue,    //!< The true literal.
+                FalseValue,   //!< The false literal.
+                EndOfStream,  //!< End of input stream, after complete values.
+                Error,        //!< JSON syntax error or I/O error, already reported.
+            };
+
+            //!
+            //! Constructor.
+            //! @param [in,out] stream The input stream containing UTF-8 JSON text.
+            //! The stream must remain valid as long as this object is used.
+            //! @param [in,out] report Where to report errors.
+            //! @param [in] chunk_size Size in bytes of input chunks.
+            //!
+            explicit Reader(std::istream& stream, Report& report = NULLREP, size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+            //!
+            //! Read the next event.
+            //! After EndOfStream or Error, the same event is always returned.
+            //! @return The next event.
+            //!
+            Event next();
+
+            //!
+            //! Get the last event which was returned by next().
+            //! @return The last event.
+            //!
+            Event event() const { return _event; }
+
+            //!
+            //! Get the text of the last event.
+            //! @return For Name and StringValue, the decoded string.
+            //! For NumberValue, the number as it appears in the JSON text.
+            //! The content is unspecified for other events.
+            //! The returned reference is valid until the next call to next().
+            //!
+            const UString& text() const { return _text; }
+
+            //!
+            //! Get the integer value of the last NumberValue event.
+            //! @param [out] value Integer value.
+            //! @return True if the last event is a NumberValue and the number is an integer.
+            //!
+            bool intValue(int64_t& value) const;
+
+            //!
+            //! Get the nesting depth of the last event.
+            //! @return The number of components in the path of the last event.
+            //! @see path()
+            //!
+            size_t depth() const { return _path_depth; }
+
+            //!
+            //! Get the path of the last event.
+            //! The path is made of object member names and array indexes, starting at the
+            //! top-level value, as in @c "events[12].title". The path of a top-level value
+            //! is an empty string. The path of a Name event is the path of the member value.
+            //! The path of BeginObject, EndObject, BeginArray and EndArray events is the path
+            //! of the object or array.
+            //! @return The path of the last event.
+            //!
+            UString path() const;
+
+            //!
+            //! Check if the path of the last event matches a path pattern.
+            //! @param [in] pattern A path pattern as in path(). The wildcard @c * can be used as
+            //! member name or array index to match any member or any element, as in @c "events[*].*".
+            //! @return True if the path matches.
+            //!
+            bool matchPath(const UString& pattern) const;
+
+            //!
+            //! Read events until the start of a value which matches a path pattern.
+            //! Name events are not considered: the reader stops on the value.
+            //! @param [in] pattern A path pattern as in matchPath().
+            //! @return True if a matching value is found. The current event is either a scalar value
+            //! (string, number, literal) or BeginObject or BeginArray. Return false on end of stream
+            //! or error.
+            //!
+            bool findNext(const UString& pattern);
+
+            //!
+            //! Skip the value which starts at the last event.
+            //! If the last event is BeginObject or BeginArray, read all events up to the corresponding
+            //! EndObject or EndArray. If the last event is a Name, skip the corresponding member value.
+            //! Otherwise, do nothing.
+            //! @return True on success, false on end of stream or error.
+            //!
+            bool skipValue();
+
+            //!
+            //! Read a complete JSON value, starting at the last event, as a tree of JSON values.
+            //! This is typically used to extract a sub-tree of reasonable size from a large JSON text.
+            //! If the last event is BeginObject or BeginArray, read all events up to the corresponding
+            //! EndObject or EndArray. If the last event is a Name, read the corresponding member value.
+            //! @param [out] value A smart pointer to the JSON value (null on error).
+            //! @return True on success, false on error.
+            //!
+            bool readValue(ValuePtr& value);
+
+            //!
+            //! Get the current line number in the input stream.
+            //! @return The current line number in the input stream.
+            //!
+            size_t lineNumber() const { return _line; }
+
+        private:
+            // Context of an enclosing object or array.
+            struct Frame
+            {
+                Frame();
+                bool    is_array;    // Array or object.
+                bool    name_done;   // In object, member name read, expecting the value.
+                size_t  count;       // Number of elements or members which were started.
+                UString name;        // In object, name of current member.
+            };
+
+            // One component of a path pattern.
+            struct PatternItem
+            {
+                PatternItem();
+                bool    is_index;   // Array index or member name.
+                bool    any;        // Wildcard.
+                size_t  index;      // Array index.
+                UString name;       // Member name.
+            };
+            typedef std::vector<PatternItem> Pattern;
+
+            std::istream&      _stream;      // Input stream.
+            Report&            _report;      // Where to report errors.
+            std::vector<char>  _buffer;      // Input buffer, one chunk.
+            size_t             _pos;         // Index of next byte in _buffer.
+            size_t             _end;         // Size of valid data in _buffer.
+            bool               _eof;         // End of input stream reached.
+            bool               _started;     // Some data have been read (check UTF-8 BOM).
+            size_t             _line;        // Current line number.
+            Event              _event;       // Last event.
+            std::vector<Frame> _frames;      // Stack of enclosing objects and arrays, not shrunk.
+            size_t             _depth;       // Number of used frames in _frames.
+            size_t             _path_depth;  // Number of frames in the path of the last event.
+            std::string        _raw;         // Raw UTF-8 text of last string or number.
+            UString            _text;        // Text of last event.
+
+            // Low-level input. Return false on end of stream.
+            bool fill();
+            // Return the next byte without consuming it, -1 on end of stream.
+            int peekChar() { return _pos < _end || fill() ? int(uint8_t(_buffer[_pos])) : -1; }
+            void skipChar() { _pos++; }
+            int skipWhiteSpace();
+
+            // Parsing helpers.
+            Event error(const UChar* message);
+            Event readValueStart();
+            bool readString();
+            bool readNumber();
+            size_t readDigits();
+            bool readLiteral(const char* literal);
+            Frame& pushFrame(bool is_array);
+
+            // Parse a path pattern.
+            static void ParsePattern(Pattern& pattern, const UString& str);
+            bool matchPattern(const Pattern& pattern) const;
+
+            // Build a tree of JSON values from the current event.
+            bool buildValue(ValuePtr& value);
+        };
+    }
+}
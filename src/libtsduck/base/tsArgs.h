@@ -37,6 +37,7 @@
 #include "tsException.h"
 #include "tsEnumeration.h"
 #include "tsVariable.h"
+#include "tsBitSet.h"
 
 namespace ts {
 
@@ -802,6 +803,21 @@ namespace ts {
         template <std::size_t N>
         void getIntValues(std::bitset<N>& values, const UChar* name = nullptr, bool defValue = false) const;
 
+        //!
+        //! Get all occurences of an option as a bitmask of values.
+        //!
+        //! @param [out] values A bitset receiving all values of the option or parameter.
+        //! For each value of the option, the corresponding bit is set. Values which are
+        //! out of range are ignored.
+        //! @param [in] name The full name of the option. If the parameter is a null pointer or
+        //! an empty string, this specifies a parameter, not an option. If the specified option
+        //! was not declared in the syntax of the command, a fatal error is reported.
+        //! @param [in] defValue The boolean to set in all values if the option or parameter
+        //! is not present in the command line.
+        //!
+        template <std::size_t N>
+        void getIntValues(BitSet<N>& values, const UChar* name = nullptr, bool defValue = false) const;
+
         //!
         //! Get an OR'ed of all values of an integer option in the last analyzed command line.
         //!
@@ -1084,6 +1100,10 @@ namespace ts {
         // Throw exception if not found.
         const IOption& getIOption(const UChar* name) const;
         IOption& getIOption(const UChar* name);
+
+        // Get all occurences of an option as a bitmask of values, BITSET is std::bitset or ts::BitSet.
+        template <class BITSET>
+        void getBitValues(BITSET& values, const UChar* name, bool defValue) const;
     };
 }
 
@@ -152,6 +152,18 @@ void ts::Args::getIntValues(std::set<INT>& values, const UChar* name) const
 
 template <std::size_t N>
 void ts::Args::getIntValues(std::bitset<N>& values, const UChar* name, bool defValue) const
+{
+    getBitValues(values, name, defValue);
+}
+
+template <std::size_t N>
+void ts::Args::getIntValues(BitSet<N>& values, const UChar* name, bool defValue) const
+{
+    getBitValues(values, name, defValue);
+}
+
+template <class BITSET>
+void ts::Args::getBitValues(BITSET& values, const UChar* name, bool defValue) const
 {
     const IOption& opt(getIOption(name));
     if (opt.value_count > 0) {
@@ -0,0 +1,322 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Fixed-size set of bits with word-level operations.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsIntegerUtils.h"
+
+namespace ts {
+    //!
+    //! Fixed-size set of bits with word-level operations.
+    //!
+    //! This class has the same interface as @c std::bitset (the parts of it which are
+    //! used in TSDuck) but its implementation is public: the bits are stored in an
+    //! array of 64-bit words. This enables efficient operations which are not available
+    //! on @c std::bitset, typically the iteration on bits which are set, using a
+    //! count-trailing-zeros instruction on each word, and the set operations on
+    //! complete words (with simple loops which are vectorized by the compiler).
+    //!
+    //! Iterating over all bits which are set is done as follows:
+    //! @code
+    //! for (size_t i = bits.first(); i < bits.size(); i = bits.next(i)) {
+    //!     ...
+    //! }
+    //! @endcode
+    //!
+    //! @tparam N Number of bits in the set.
+    //! @ingroup cpp
+    //!
+    template <std::size_t N>
+    class BitSet
+    {
+    public:
+        //!
+        //! Number of bits in the set.
+        //!
+        static constexpr std::size_t SIZE = N;
+
+        //!
+        //! Proxy class to a bit in a set, as returned by the non-const operator[].
+        //!
+        class reference
+        {
+        public:
+            //!
+            //! Set the value of the referenced bit.
+            //! @param [in] value New value of the bit.
+            //! @return A reference to this object.
+            //!
+            reference& operator=(bool value) { _set.set(_pos, value); return *this; }
+
+            //!
+            //! Set the value of the referenced bit from another referenced bit.
+            //! @param [in] other Other referenced bit.
+            //! @return A reference to this object.
+            //!
+            reference& operator=(const reference& other) { _set.set(_pos, bool(other)); return *this; }
+
+            //!
+            //! Get the value of the referenced bit.
+            //! @return The value of the referenced bit.
+            //!
+            operator bool() const { return static_cast<const BitSet&>(_set)[_pos]; }
+
+            //!
+            //! Get the inverted value of the referenced bit.
+            //! @return The inverted value of the referenced bit.
+            //!
+            bool operator~() const { return !static_cast<const BitSet&>(_set)[_pos]; }
+
+            //!
+            //! Flip the referenced bit.
+            //! @return A reference to this object.
+            //!
+            reference& flip() { _set.flip(_pos); return *this; }
+
+        private:
+            friend class BitSet;
+            BitSet& _set;
+            std::size_t _pos;
+            reference(BitSet& set, std::size_t pos) : _set(set), _pos(pos) {}
+        };
+
+        //!
+        //! Default constructor.
+        //! All bits are cleared.
+        //!
+        constexpr BitSet() : _words() {}
+
+        //!
+        //! Get the number of bits in the set.
+        //! @return The number of bits in the set.
+        //!
+        static constexpr std::size_t size() { return N; }
+
+        //!
+        //! Test the value of a bit.
+        //! @param [in] pos Index of the bit. Must be less than N, no check.
+        //! @return The value of the bit.
+        //!
+        bool operator[](std::size_t pos) const { return (_words[pos / WORD_BITS] & (Word(1) << (pos % WORD_BITS))) != 0; }
+
+        //!
+        //! Access a bit.
+        //! @param [in] pos Index of the bit. Must be less than N, no check.
+        //! @return A proxy to the bit.
+        //!
+        reference operator[](std::size_t pos) { return reference(*this, pos); }
+
+        //!
+        //! Test the value of a bit.
+        //! @param [in] pos Index of the bit.
+        //! @return The value of the bit.
+        //! @throw std::out_of_range If @a pos is out of range.
+        //!
+        bool test(std::size_t pos) const { return (*this)[checkPosition(pos)]; }
+
+        //!
+        //! Set all bits.
+        //! @return A reference to this object.
+        //!
+        BitSet& set();
+
+        //!
+        //! Set or clear one bit.
+        //! @param [in] pos Index of the bit.
+        //! @param [in] value Value to set in the bit.
+        //! @return A reference to this object.
+        //! @throw std::out_of_range If @a pos is out of range.
+        //!
+        BitSet& set(std::size_t pos, bool value = true);
+
+        //!
+        //! Clear all bits.
+        //! @return A reference to this object.
+        //!
+        BitSet& reset();
+
+        //!
+        //! Clear one bit.
+        //! @param [in] pos Index of the bit.
+        //! @return A reference to this object.
+        //! @throw std::out_of_range If @a pos is out of range.
+        //!
+        BitSet& reset(std::size_t pos) { return set(pos, false); }
+
+        //!
+        //! Flip all bits.
+        //! @return A reference to this object.
+        //!
+        BitSet& flip();
+
+        //!
+        //! Flip one bit.
+        //! @param [in] pos Index of the bit.
+        //! @return A reference to this object.
+        //! @throw std::out_of_range If @a pos is out of range.
+        //!
+        BitSet& flip(std::size_t pos);
+
+        //!
+        //! Count the number of bits which are set.
+        //! @return The number of bits which are set.
+        //!
+        std::size_t count() const;
+
+        //!
+        //! Check if at least one bit is set.
+        //! @return True if at least one bit is set.
+        //!
+        bool any() const;
+
+        //!
+        //! Check if no bit is set.
+        //! @return True if no bit is set.
+        //!
+        bool none() const { return !any(); }
+
+        //!
+        //! Check if all bits are set.
+        //! @return True if all bits are set.
+        //!
+        bool all() const { return count() == N; }
+
+        //!
+        //! Get the index of the first bit which is set.
+        //! @return The index of the first bit which is set or size() if no bit is set.
+        //!
+        std::size_t first() const { return findFrom(0); }
+
+        //!
+        //! Get the index of the next bit which is set after a given position.
+        //! @param [in] pos Index of a bit (typically the previous one which was returned).
+        //! @return The index of the first bit which is set after @a pos or size() if there is none.
+        //!
+        std::size_t next(std::size_t pos) const { return pos + 1 >= N ? N : findFrom(pos + 1); }
+
+        //!
+        //! Check if this set and another one have at least one bit in common.
+        //! This is equivalent to <code>(*this & other).any()</code> without building a temporary set.
+        //! @param [in] other Another set.
+        //! @return True if at least one bit is set in both sets.
+        //!
+        bool intersects(const BitSet& other) const;
+
+        //!
+        //! Clear all bits which are set in another set (set difference).
+        //! This is equivalent to <code>*this &= ~other</code> without building a temporary set.
+        //! @param [in] other Another set.
+        //! @return A reference to this object.
+        //!
+        BitSet& exclude(const BitSet& other);
+
+        //!
+        //! Intersection with another set.
+        //! @param [in] other Another set.
+        //! @return A reference to this object.
+        //!
+        BitSet& operator&=(const BitSet& other);
+
+        //!
+        //! Union with another set.
+        //! @param [in] other Another set.
+        //! @return A reference to this object.
+        //!
+        BitSet& operator|=(const BitSet& other);
+
+        //!
+        //! Symmetric difference with another set.
+        //! @param [in] other Another set.
+        //! @return A reference to this object.
+        //!
+        BitSet& operator^=(const BitSet& other);
+
+        //!
+        //! Get a copy of this set with all bits flipped.
+        //! @return A copy of this set with all bits flipped.
+        //!
+        BitSet operator~() const { return BitSet(*this).flip(); }
+
+        //!
+        //! Intersection of two sets.
+        //! @param [in] other Another set.
+        //! @return A new set.
+        //!
+        BitSet operator&(const BitSet& other) const { return BitSet(*this) &= other; }
+
+        //!
+        //! Union of two sets.
+        //! @param [in] other Another set.
+        //! @return A new set.
+        //!
+        BitSet operator|(const BitSet& other) const { return BitSet(*this) |= other; }
+
+        //!
+        //! Symmetric difference of two sets.
+        //! @param [in] other Another set.
+        //! @return A new set.
+        //!
+        BitSet operator^(const BitSet& other) const { return BitSet(*this) ^= other; }
+
+        //!
+        //! Equality operator.
+        //! @param [in] other Another set.
+        //! @return True if the two sets are identical.
+        //!
+        bool operator==(const BitSet& other) const;
+
+        //!
+        //! Unequality operator.
+        //! @param [in] other Another set.
+        //! @return True if the two sets are different.
+        //!
+        bool operator!=(const BitSet& other) const { return !operator==(other); }
+
+    private:
+        typedef uint64_t Word;
+        static constexpr std::size_t WORD_BITS = 64;
+        static constexpr std::size_t WORD_COUNT = (N + WORD_BITS - 1) / WORD_BITS;
+        static constexpr Word LAST_WORD_MASK = N % WORD_BITS == 0 ? ~Word(0) : (Word(1) << (N % WORD_BITS)) - 1;
+
+        // All bits, the unused bits in the last word are always zero.
+        Word _words[WORD_COUNT];
+
+        // Check that a bit position is in range, throw std::out_of_range if not.
+        static std::size_t checkPosition(std::size_t pos);
+
+        // Find the first bit which is set, starting at a given position.
+        std::size_t findFrom(std::size_t pos) const;
+    };
+}
+
+#include "tsBitSetTemplate.h"
@@ -0,0 +1,222 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Fixed-size set of bits with word-level operations.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+template <std::size_t N> constexpr std::size_t ts::BitSet<N>::SIZE;
+template <std::size_t N> constexpr std::size_t ts::BitSet<N>::WORD_BITS;
+template <std::size_t N> constexpr std::size_t ts::BitSet<N>::WORD_COUNT;
+template <std::size_t N> constexpr typename ts::BitSet<N>::Word ts::BitSet<N>::LAST_WORD_MASK;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Check that a bit position is in range.
+//----------------------------------------------------------------------------
+
+template <std::size_t N>
+std::size_t ts::BitSet<N>::checkPosition(std::size_t pos)
+{
+    if (pos >= N) {
+        throw std::out_of_range("ts::BitSet position out of range");
+    }
+    return pos;
+}
+
+
+//----------------------------------------------------------------------------
+// Set, clear or flip bits.
+//----------------------------------------------------------------------------
+
+template <std::size_t N>
+ts::BitSet<N>& ts::BitSet<N>::set()
+{
+    for (std::size_t i = 0; i < WORD_COUNT; ++i) {
+        _words[i] = ~Word(0);
+    }
+    _words[WORD_COUNT - 1] &= LAST_WORD_MASK;
+    return *this;
+}
+
+template <std::size_t N>
+ts::BitSet<N>& ts::BitSet<N>::set(std::size_t pos, bool value)
+{
+    const Word mask = Word(1) << (checkPosition(pos) % WORD_BITS);
+    if (value) {
+        _words[pos / WORD_BITS] |= mask;
+    }
+    else {
+        _words[pos / WORD_BITS] &= ~mask;
+    }
+    return *this;
+}
+
+template <std::size_t N>
+ts::BitSet<N>& ts::BitSet<N>::reset()
+{
+    for (std::size_t i = 0; i < WORD_COUNT; ++i) {
+        _words[i] = 0;
+    }
+    return *this;
+}
+
+template <std::size_t N>
+ts::BitSet<N>& ts::BitSet<N>::flip()
+{
+    for (std::size_t i = 0; i < WORD_COUNT; ++i) {
+        _words[i] = ~_words[i];
+    }
+    _words[WORD_COUNT - 1] &= LAST_WORD_MASK;
+    return *this;
+}
+
+template <std::size_t N>
+ts::BitSet<N>& ts::BitSet<N>::flip(std::size_t pos)
+{
+    _words[checkPosition(pos) / WORD_BITS] ^= Word(1) << (pos % WORD_BITS);
+    return *this;
+}
+
+
+//----------------------------------------------------------------------------
+// Global properties of the set.
+//----------------------------------------------------------------------------
+
+template <std::size_t N>
+std::size_t ts::BitSet<N>::count() const
+{
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < WORD_COUNT; ++i) {
+        total += CountOneBits(_words[i]);
+    }
+    return total;
+}
+
+template <std::size_t N>
+bool ts::BitSet<N>::any() const
+{
+    // OR all words, without early exit, the loop is vectorized.
+    Word all = 0;
+    for (std::size_t i = 0; i < WORD_COUNT; ++i) {
+        all |= _words[i];
+    }
+    return all != 0;
+}
+
+template <std::size_t N>
+bool ts::BitSet<N>::operator==(const BitSet& other) const
+{
+    Word diff = 0;
+    for (std::size_t i = 0; i < WORD_COUNT; ++i) {
+        diff |= _words[i] ^ other._words[i];
+    }
+    return diff == 0;
+}
+
+template <std::size_t N>
+bool ts::BitSet<N>::intersects(const BitSet& other) const
+{
+    Word common = 0;
+    for (std::size_t i = 0; i < WORD_COUNT; ++i) {
+        common |= _words[i] & other._words[i];
+    }
+    return common != 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Find the first bit which is set, starting at a given position.
+//----------------------------------------------------------------------------
+
+template <std::size_t N>
+std::size_t ts::BitSet<N>::findFrom(std::size_t pos) const
+{
+    std::size_t index = pos / WORD_BITS;
+    if (index >= WORD_COUNT) {
+        return N;
+    }
+
+    // Ignore the bits before pos in the first word.
+    Word word = _words[index] & (~Word(0) << (pos % WORD_BITS));
+
+    // Skip words without bit set.
+    while (word == 0) {
+        if (++index >= WORD_COUNT) {
+            return N;
+        }
+        word = _words[index];
+    }
+    return index * WORD_BITS + CountTrailingZeroBits(word);
+}
+
+
+//----------------------------------------------------------------------------
+// Set operations on complete words.
+//----------------------------------------------------------------------------
+
+template <std::size_t N>
+ts::BitSet<N>& ts::BitSet<N>::exclude(const BitSet& other)
+{
+    for (std::size_t i = 0; i < WORD_COUNT; ++i) {
+        _words[i] &= ~other._words[i];
+    }
+    return *this;
+}
+
+template <std::size_t N>
+ts::BitSet<N>& ts::BitSet<N>::operator&=(const BitSet& other)
+{
+    for (std::size_t i = 0; i < WORD_COUNT; ++i) {
+        _words[i] &= other._words[i];
+    }
+    return *this;
+}
+
+template <std::size_t N>
+ts::BitSet<N>& ts::BitSet<N>::operator|=(const BitSet& other)
+{
+    for (std::size_t i = 0; i < WORD_COUNT; ++i) {
+        _words[i] |= other._words[i];
+    }
+    return *this;
+}
+
+template <std::size_t N>
+ts::BitSet<N>& ts::BitSet<N>::operator^=(const BitSet& other)
+{
+    for (std::size_t i = 0; i < WORD_COUNT; ++i) {
+        _words[i] ^= other._words[i];
+    }
+    return *this;
+}
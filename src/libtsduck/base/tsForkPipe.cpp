@@ -59,6 +59,7 @@ ts::ForkPipe::ForkPipe() :
     _ignore_abort(false),
     _broken_pipe(false),
     _eof(false),
+    _exit_code(-1),
 #if defined(TS_WINDOWS)
     _handle(INVALID_HANDLE_VALUE),
     _process(INVALID_HANDLE_VALUE)
@@ -119,6 +120,7 @@ bool ts::ForkPipe::open(const UString& command, WaitMode wait_mode, size_t buffe
     _out_mode = out_mode;
     _broken_pipe = false;
     _wait_mode = wait_mode;
+    _exit_code = -1;
     _eof = !_out_pipe;
 
     report.debug(u"creating process \"%s\"", {command});
@@ -474,9 +476,15 @@ bool ts::ForkPipe::close(Report& report)
     }
 
     // Wait for termination of child process
-    if (_wait_mode == SYNCHRONOUS && ::WaitForSingleObject(_process, INFINITE) != WAIT_OBJECT_0) {
-        report.error(u"error waiting for process termination: %s", {ErrorCodeMessage()});
-        result = false;
+    if (_wait_mode == SYNCHRONOUS) {
+        ::DWORD code = 0;
+        if (::WaitForSingleObject(_process, INFINITE) != WAIT_OBJECT_0) {
+            report.error(u"error waiting for process termination: %s", {ErrorCodeMessage()});
+            result = false;
+        }
+        else if (::GetExitCodeProcess(_process, &code)) {
+            _exit_code = int(code);
+        }
     }
 
     if (_process != INVALID_HANDLE_VALUE) {
@@ -493,9 +501,15 @@ bool ts::ForkPipe::close(Report& report)
 
     // Wait for termination of forked process
     assert(_fpid != 0);
-    if (_wait_mode == SYNCHRONOUS && ::waitpid(_fpid, nullptr, 0) < 0) {
-        report.error(u"error waiting for process termination: %s", {ErrorCodeMessage()});
-        result = false;
+    if (_wait_mode == SYNCHRONOUS) {
+        int status = 0;
+        if (::waitpid(_fpid, &status, 0) < 0) {
+            report.error(u"error waiting for process termination: %s", {ErrorCodeMessage()});
+            result = false;
+        }
+        else if (WIFEXITED(status)) {
+            _exit_code = WEXITSTATUS(status);
+        }
     }
 
 #endif
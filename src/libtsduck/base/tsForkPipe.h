@@ -124,6 +124,16 @@ namespace ts {
             return _is_open;
         }
 
+        //!
+        //! Get the exit code of the process.
+        //! The exit code is known only after close() when @a wait_mode was SYNCHRONOUS on open().
+        //! @return The exit code of the process or -1 if unknown or if the process was abnormally terminated.
+        //!
+        int exitCode() const
+        {
+            return _exit_code;
+        }
+
         //!
         //! Check if the pipe was broken.
         //! @return True if was broken (unexpected process termination for instance).
@@ -222,6 +232,7 @@ namespace ts {
         bool          _ignore_abort;  // Ignore early termination of child process.
         volatile bool _broken_pipe;   // Pipe is broken, do not attempt to write.
         volatile bool _eof;           // Got end of file on input pipe.
+        int           _exit_code;     // Exit code of the process, -1 if unknown.
 #if defined(TS_WINDOWS)
         ::HANDLE      _handle;        // Pipe output handle.
         ::HANDLE      _process;       // Handle to child process.
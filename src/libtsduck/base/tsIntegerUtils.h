@@ -119,6 +119,55 @@ namespace ts {
     //! @return The maximum width in characters.
     //!
     size_t MaxHexaWidth(size_t typeSize, size_t digitSeparatorSize = 0);
+
+    //!
+    //! Count the number of bits which are set in a 64-bit integer (population count).
+    //! @param [in] x A 64-bit integer.
+    //! @return The number of 1 bits in @a x.
+    //!
+    inline size_t CountOneBits(uint64_t x)
+    {
+#if defined(TS_GCC)
+        return size_t(__builtin_popcountll(x));
+#else
+        // Portable version, without relying on the POPCNT instruction.
+        x = x - ((x >> 1) & TS_UCONST64(0x5555555555555555));
+        x = (x & TS_UCONST64(0x3333333333333333)) + ((x >> 2) & TS_UCONST64(0x3333333333333333));
+        x = (x + (x >> 4)) & TS_UCONST64(0x0F0F0F0F0F0F0F0F);
+        return size_t((x * TS_UCONST64(0x0101010101010101)) >> 56);
+#endif
+    }
+
+    //!
+    //! Count the number of trailing zero bits in a 64-bit integer.
+    //! This is the index of the least significant bit which is set.
+    //! @param [in] x A 64-bit integer.
+    //! @return The number of least significant 0 bits in @a x, 64 if @a x is zero.
+    //!
+    inline size_t CountTrailingZeroBits(uint64_t x)
+    {
+        if (x == 0) {
+            return 64;
+        }
+#if defined(TS_GCC)
+        return size_t(__builtin_ctzll(x));
+#elif defined(TS_MSC) && (defined(TS_X86_64) || defined(TS_ARM64))
+        unsigned long index = 0;
+        ::_BitScanForward64(&index, x);
+        return size_t(index);
+#else
+        size_t count = 0;
+        while ((x & 0xFF) == 0) {
+            x >>= 8;
+            count += 8;
+        }
+        while ((x & 1) == 0) {
+            x >>= 1;
+            count++;
+        }
+        return count;
+#endif
+    }
 }
 
 #include "tsIntegerUtilsTemplate.h"
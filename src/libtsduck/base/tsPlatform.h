@@ -880,6 +880,8 @@ TS_MSC_NOWARNING(5027)
 #include <map>
 #include <set>
 #include <bitset>
+#include <stdexcept>
+#include <atomic>
 #include <algorithm>
 #include <iterator>
 #include <limits>
@@ -40,6 +40,36 @@
 #include "tsNullMutex.h"
 
 namespace ts {
+
+    template <typename T, class MUTEX> class SafePtr;
+
+    //!
+    //! Allocate an object and its safe pointer management in one single memory block.
+    //!
+    //! @c MakeSafe<Foo>(args) is equivalent to <code>ts::SafePtr<Foo>(new Foo(args))</code>
+    //! but the object and the reference counter of the safe pointers are allocated
+    //! together. This saves one memory allocation and one deallocation.
+    //!
+    //! If the ownership of the object is later transfered out of the safe pointers
+    //! (using @c release(), @c upcast(), @c downcast() or @c changeMutex()), the object
+    //! is moved into a separately allocated instance. In that case, the class @a T must
+    //! be move-constructible.
+    //!
+    //! Example:
+    //! @code
+    //! ts::SafePtr<Foo, ts::Mutex> ptr(ts::MakeSafe<Foo, ts::Mutex>(1, "abc"));
+    //! @endcode
+    //!
+    //! @tparam T The type of the object to allocate.
+    //! @tparam MUTEX The mutex type of the safe pointer.
+    //! @tparam ARGS The types of the constructor arguments.
+    //! @param [in] args The arguments of the constructor of @a T.
+    //! @return A safe pointer to the new object.
+    //! @exception std::bad_alloc Thrown if insufficient memory is available.
+    //!
+    template <typename T, class MUTEX = NullMutex, typename... ARGS>
+    SafePtr<T,MUTEX> MakeSafe(ARGS&&... args);
+
     //!
     //!  Template safe pointer (reference-counted, auto-delete, thread-safe).
     //!  @ingroup cpp
@@ -74,17 +104,21 @@ namespace ts {
     //!  pointer is a null pointer, use the method @c isNull(). Do not
     //!  use comparisons such as <code>p == nullptr</code>, the result will be incorrect.
     //!
-    //!  The ts::SafePtr template class can be made thread-safe using a mutex.
-    //!  The type of mutex to use is given by the template parameter @a MUTEX
-    //!  which must be a subclass of ts::MutexInterface. By default,
-    //!  ts::NullMutex is used. The default implementation is consequently
+    //!  The ts::SafePtr template class can be made thread-safe using the
+    //!  template parameter @a MUTEX which must be a subclass of ts::MutexInterface.
+    //!  By default, ts::NullMutex is used. The default implementation is consequently
     //!  not thread-safe but there is no synchronization overhead. To use
     //!  safe pointers in a multi-thread environment, specify an actual
-    //!  mutex implementation for the target environment.
+    //!  mutex class such as ts::Mutex.
+    //!
+    //!  Thread-safe safe pointers do not actually lock a mutex. The reference
+    //!  counter and the pointer to the object are atomic variables. Copying,
+    //!  assigning or destroying a thread-safe safe pointer is lock-free.
     //!
     //!  @tparam T The type of the pointed object. Cannot be an array type.
-    //!  @tparam MUTEX A subclass of ts::MutexInterface which is used to
-    //!  synchronize access to the safe pointer internal state.
+    //!  @tparam MUTEX A subclass of ts::MutexInterface. When this is ts::NullMutex,
+    //!  the safe pointer is not thread-safe. With any other class, the safe pointer
+    //!  internal state is updated using atomic operations.
     //!
     template <typename T, class MUTEX = NullMutex>
     class SafePtr
@@ -453,6 +487,15 @@ namespace ts {
             return _shared->pointer();
         }
 
+        //!
+        //! Check if this safe pointer is thread-safe.
+        //! @return True if this safe pointer is thread-safe, false otherwise.
+        //!
+        static constexpr bool isThreadSafe()
+        {
+            return !std::is_same<MUTEX, NullMutex>::value;
+        }
+
         //!
         //! Get the reference count value.
         //!
@@ -470,22 +513,45 @@ namespace ts {
 
     private:
         // All safe pointers which reference the same T object share one single SafePtrShared object.
+        // In thread-safe safe pointers, the pointer and the reference counter are updated using atomic
+        // read-modify-write operations. Otherwise, relaxed loads and stores are used, without overhead.
         class SafePtrShared
         {
             TS_NOBUILD_NOCOPY(SafePtrShared);
         private:
             // Private members:
-            T*    _ptr;        // pointer to actual object
-            int   _ref_count;  // reference counter
-            MUTEX _mutex;      // protect the SafePtrShared
+            std::atomic<T*>  _ptr;        // pointer to actual object
+            std::atomic<int> _ref_count;  // reference counter
+            const bool       _embedded;   // the object was initially allocated in the same memory block
+
+            // Offset of the embedded object in the memory block, after the SafePtrShared.
+            static constexpr size_t EmbeddedOffset() { return (sizeof(SafePtrShared) + alignof(T) - 1) / alignof(T) * alignof(T); }
+
+            // Address of the embedded object.
+            T* embeddedObject() { return reinterpret_cast<T*>(reinterpret_cast<char*>(this) + EmbeddedOffset()); }
+
+            // Replace the pointer value, return the previous one.
+            T* exchange(T* p);
+
+            // Deallocate an object, embedded or not.
+            void deleteObject(T* p);
+
+            // Transfer the ownership of an object out of this instance. An embedded object is moved.
+            T* extractObject(T* p);
+            static T* MoveObject(T* p, std::true_type);
+            static T* MoveObject(T* p, std::false_type);
 
         public:
             // Constructor. Initial reference count is 1.
-            SafePtrShared(T* p) : _ptr(p), _ref_count(1), _mutex() {}
+            SafePtrShared(T* p, bool embedded = false) : _ptr(p), _ref_count(1), _embedded(embedded) {}
 
             // Destructor. Deallocate actual object (if any).
             ~SafePtrShared();
 
+            // Allocate a SafePtrShared and its object in one memory block.
+            template <typename... ARGS>
+            static SafePtrShared* NewEmbedded(ARGS&&... args);
+
             // Same semantics as SafePtr counterparts:
             T* release();
             void reset(T* p);
@@ -509,34 +575,44 @@ namespace ts {
             // Perform a class downcast (cast to a subclass).
             template <typename ST> SafePtr<ST,MUTEX> downcast()
             {
-                Guard lock(_mutex);
-                ST* sp = dynamic_cast<ST*>(_ptr);
-                if (sp != nullptr) {
-                    // Successful downcast, the original safe pointer must be released.
-                    _ptr = nullptr;
+                T* p = _ptr.load(std::memory_order_acquire);
+                for (;;) {
+                    if (dynamic_cast<ST*>(p) == nullptr) {
+                        // Not a subclass, the original safe pointer is unmodified.
+                        return SafePtr<ST,MUTEX>(nullptr);
+                    }
+                    else if (!isThreadSafe()) {
+                        _ptr.store(nullptr, std::memory_order_relaxed);
+                        break;
+                    }
+                    else if (_ptr.compare_exchange_weak(p, nullptr, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                        break;
+                    }
                 }
-                return SafePtr<ST,MUTEX>(sp);
+                // Successful downcast, the original safe pointer has been released.
+                return SafePtr<ST,MUTEX>(dynamic_cast<ST*>(extractObject(p)));
             }
 
             // Perform a class upcast.
             template <typename ST> SafePtr<ST,MUTEX> upcast()
             {
-                Guard lock(_mutex);
-                ST* sp = _ptr;
-                _ptr = nullptr;
-                return SafePtr<ST,MUTEX>(sp);
+                return SafePtr<ST,MUTEX>(extractObject(exchange(nullptr)));
             }
 
             // Change mutex type.
             template <typename NEWMUTEX> SafePtr<T,NEWMUTEX> changeMutex()
             {
-                Guard lock(_mutex);
-                T* sp = _ptr;
-                _ptr = nullptr;
-                return SafePtr<T,NEWMUTEX>(sp);
+                return SafePtr<T,NEWMUTEX>(extractObject(exchange(nullptr)));
             }
         };
 
+        // Private constructor from an allocated SafePtrShared.
+        // The second parameter is only used to avoid ambiguities with the public constructor.
+        SafePtr(SafePtrShared* shared, std::true_type) : _shared(shared) {}
+
+        template <typename T1, class MUTEX1, typename... ARGS>
+        friend SafePtr<T1,MUTEX1> MakeSafe(ARGS&&... args);
+
         // This is the only member field in SafePtr.
         SafePtrShared* _shared;
     };
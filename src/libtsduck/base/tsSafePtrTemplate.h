@@ -84,6 +84,37 @@ ts::SafePtr<T,MUTEX>& ts::SafePtr<T,MUTEX>::operator=(T* p)
 }
 
 
+//----------------------------------------------------------------------------
+// Allocate an object and its safe pointer management in one memory block.
+//----------------------------------------------------------------------------
+
+template <typename T, class MUTEX, typename... ARGS>
+ts::SafePtr<T,MUTEX> ts::MakeSafe(ARGS&&... args)
+{
+    return SafePtr<T,MUTEX>(SafePtr<T,MUTEX>::SafePtrShared::NewEmbedded(std::forward<ARGS>(args)...), std::true_type());
+}
+
+template <typename T, class MUTEX>
+template <typename... ARGS>
+typename ts::SafePtr<T,MUTEX>::SafePtrShared* ts::SafePtr<T,MUTEX>::SafePtrShared::NewEmbedded(ARGS&&... args)
+{
+    // Objects with extended alignment cannot be allocated that way.
+    static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned type in MakeSafe");
+
+    void* block = ::operator new(EmbeddedOffset() + sizeof(T));
+    SafePtrShared* shared = new(block) SafePtrShared(nullptr, true);
+    try {
+        shared->_ptr.store(new(shared->embeddedObject()) T(std::forward<ARGS>(args)...), std::memory_order_relaxed);
+    }
+    catch (...) {
+        shared->~SafePtrShared();
+        ::operator delete(block);
+        throw;
+    }
+    return shared;
+}
+
+
 //----------------------------------------------------------------------------
 // Destructor. Deallocate actual object (if any).
 //----------------------------------------------------------------------------
@@ -91,13 +122,80 @@ ts::SafePtr<T,MUTEX>& ts::SafePtr<T,MUTEX>::operator=(T* p)
 template <typename T, class MUTEX>
 ts::SafePtr<T,MUTEX>::SafePtrShared::~SafePtrShared()
 {
-    if (_ptr != nullptr) {
-        delete _ptr;
-        _ptr = nullptr;
+    deleteObject(_ptr.load(std::memory_order_relaxed));
+    _ptr.store(nullptr, std::memory_order_relaxed);
+}
+
+
+//----------------------------------------------------------------------------
+// Replace the pointer value, return the previous one.
+//----------------------------------------------------------------------------
+
+template <typename T, class MUTEX>
+T* ts::SafePtr<T,MUTEX>::SafePtrShared::exchange(T* p)
+{
+    if (isThreadSafe()) {
+        return _ptr.exchange(p, std::memory_order_acq_rel);
+    }
+    else {
+        T* previous = _ptr.load(std::memory_order_relaxed);
+        _ptr.store(p, std::memory_order_relaxed);
+        return previous;
     }
 }
 
 
+//----------------------------------------------------------------------------
+// Deallocate an object, embedded or not.
+//----------------------------------------------------------------------------
+
+template <typename T, class MUTEX>
+void ts::SafePtr<T,MUTEX>::SafePtrShared::deleteObject(T* p)
+{
+    if (p == nullptr) {
+        return;
+    }
+    else if (_embedded && p == embeddedObject()) {
+        // The memory is freed with the SafePtrShared.
+        p->~T();
+    }
+    else {
+        delete p;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Transfer the ownership of an object out of this instance.
+//----------------------------------------------------------------------------
+
+template <typename T, class MUTEX>
+T* ts::SafePtr<T,MUTEX>::SafePtrShared::extractObject(T* p)
+{
+    if (p != nullptr && _embedded && p == embeddedObject()) {
+        // The memory of an embedded object cannot be separately deleted, move it.
+        return MoveObject(p, typename std::is_move_constructible<T>::type());
+    }
+    return p;
+}
+
+template <typename T, class MUTEX>
+T* ts::SafePtr<T,MUTEX>::SafePtrShared::MoveObject(T* p, std::true_type)
+{
+    T* moved = new T(std::move(*p));
+    p->~T();
+    return moved;
+}
+
+template <typename T, class MUTEX>
+T* ts::SafePtr<T,MUTEX>::SafePtrShared::MoveObject(T* p, std::false_type)
+{
+    static const char msg[] = "\n\n*** Fatal error: cannot move object out of MakeSafe block\n\n";
+    (void)(p);
+    FatalError(msg, sizeof(msg) - 1);
+}
+
+
 //----------------------------------------------------------------------------
 // Sets the pointer value to 0 and returns its old value.
 // Do not deallocate the object.
@@ -106,10 +204,7 @@ ts::SafePtr<T,MUTEX>::SafePtrShared::~SafePtrShared()
 template <typename T, class MUTEX>
 T* ts::SafePtr<T,MUTEX>::SafePtrShared::release()
 {
-    Guard lock(_mutex);
-    T* previous = _ptr;
-    _ptr = nullptr;
-    return previous;
+    return extractObject(exchange(nullptr));
 }
 
 
@@ -120,11 +215,7 @@ T* ts::SafePtr<T,MUTEX>::SafePtrShared::release()
 template <typename T, class MUTEX>
 void ts::SafePtr<T,MUTEX>::SafePtrShared::reset(T* p)
 {
-    Guard lock(_mutex);
-    if (_ptr != nullptr) {
-        delete _ptr;
-    }
-    _ptr = p;
+    deleteObject(exchange(p));
 }
 
 
@@ -135,8 +226,7 @@ void ts::SafePtr<T,MUTEX>::SafePtrShared::reset(T* p)
 template <typename T, class MUTEX>
 T* ts::SafePtr<T,MUTEX>::SafePtrShared::pointer()
 {
-    Guard lock(_mutex);
-    return _ptr;
+    return _ptr.load(isThreadSafe() ? std::memory_order_acquire : std::memory_order_relaxed);
 }
 
 
@@ -147,8 +237,7 @@ T* ts::SafePtr<T,MUTEX>::SafePtrShared::pointer()
 template <typename T, class MUTEX>
 int ts::SafePtr<T,MUTEX>::SafePtrShared::count()
 {
-    Guard lock(_mutex);
-    return _ref_count;
+    return _ref_count.load(std::memory_order_relaxed);
 }
 
 
@@ -159,8 +248,7 @@ int ts::SafePtr<T,MUTEX>::SafePtrShared::count()
 template <typename T, class MUTEX>
 bool ts::SafePtr<T,MUTEX>::SafePtrShared::isNull()
 {
-    Guard lock(_mutex);
-    return _ptr == nullptr;
+    return pointer() == nullptr;
 }
 
 
@@ -171,8 +259,13 @@ bool ts::SafePtr<T,MUTEX>::SafePtrShared::isNull()
 template <typename T, class MUTEX>
 typename ts::SafePtr<T,MUTEX>::SafePtrShared* ts::SafePtr<T,MUTEX>::SafePtrShared::attach()
 {
-    Guard lock(_mutex);
-    _ref_count++;
+    if (isThreadSafe()) {
+        // A new reference is always created from an existing one, no ordering is required.
+        _ref_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    else {
+        _ref_count.store(_ref_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
     return this;
 }
 
@@ -186,13 +279,25 @@ template <typename T, class MUTEX>
 bool ts::SafePtr<T,MUTEX>::SafePtrShared::detach()
 {
     int refcount;
-    {
-        Guard lock(_mutex);
-        refcount = --_ref_count;
+    if (isThreadSafe()) {
+        // Release our accesses to the object, acquire all others before deletion.
+        refcount = _ref_count.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    }
+    else {
+        refcount = _ref_count.load(std::memory_order_relaxed) - 1;
+        _ref_count.store(refcount, std::memory_order_relaxed);
+    }
+    if (refcount > 0) {
+        return false;
+    }
+    else if (_embedded) {
+        // Allocated by NewEmbedded() as a raw memory block.
+        void* block = this;
+        this->~SafePtrShared();
+        ::operator delete(block);
     }
-    if (refcount == 0) {
+    else {
         delete this;
-        return true;
     }
-    return false;
+    return true;
 }
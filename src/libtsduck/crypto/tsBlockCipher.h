@@ -314,6 +314,22 @@ namespace ts {
         //!
         virtual bool decryptInPlaceImpl(void* data, size_t data_length, size_t* max_actual_length);
 
+        //!
+        //! Check if encryption is allowed and increment the encryption counter.
+        //! Called once per encrypted message by encrypt() and encryptInPlace().
+        //! Subclasses which encrypt several messages at a time shall call it once per message.
+        //! @return True if encryption is allowed, false otherwise.
+        //!
+        bool allowEncrypt();
+
+        //!
+        //! Check if decryption is allowed and increment the decryption counter.
+        //! Called once per decrypted message by decrypt() and decryptInPlace().
+        //! Subclasses which decrypt several messages at a time shall call it once per message.
+        //! @return True if decryption is allowed, false otherwise.
+        //!
+        bool allowDecrypt();
+
     private:
         bool      _key_set;                // Current key successfully set.
         int       _cipher_id;              // Cipher identity (from application).
@@ -323,9 +339,5 @@ namespace ts {
         size_t    _key_decrypt_max;        // Maximum number of times a key should be used for decryption.
         ByteBlock _current_key;            // Current unscheduled key.
         BlockCipherAlertInterface* _alert; // Alert handler.
-
-        // Check if encryption or decryption is allowed. Increment counters.
-        bool allowEncrypt();
-        bool allowDecrypt();
     };
 }
@@ -106,6 +106,31 @@ bool ts::CipherChaining::setKeyImpl(const void* key, size_t key_length, size_t r
 }
 
 
+//----------------------------------------------------------------------------
+// Encrypt or decrypt several messages, default implementation.
+//----------------------------------------------------------------------------
+
+bool ts::CipherChaining::encryptBatch(uint8_t* const data[], const size_t sizes[], size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (!encryptInPlace(data[i], sizes[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ts::CipherChaining::decryptBatch(uint8_t* const data[], const size_t sizes[], size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (!decryptInPlace(data[i], sizes[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Set a new IV.
 //----------------------------------------------------------------------------
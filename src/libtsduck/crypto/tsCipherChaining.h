@@ -91,6 +91,30 @@ namespace ts {
         //!
         virtual bool residueAllowed() const = 0;
 
+        //!
+        //! Encrypt several independent messages in place, all with the current key and IV.
+        //! The result is the same as calling encryptInPlace() on each message.
+        //! The default implementation does exactly that. Subclasses may provide a more
+        //! efficient implementation, processing blocks from several messages in parallel.
+        //! @param [in] data Array of @a count addresses of messages to encrypt in place.
+        //! @param [in] sizes Array of @a count message sizes in bytes.
+        //! @param [in] count Number of messages.
+        //! @return True on success, false on error. On error, some messages may be already encrypted.
+        //!
+        virtual bool encryptBatch(uint8_t* const data[], const size_t sizes[], size_t count);
+
+        //!
+        //! Decrypt several independent messages in place, all with the current key and IV.
+        //! The result is the same as calling decryptInPlace() on each message.
+        //! The default implementation does exactly that. Subclasses may provide a more
+        //! efficient implementation, processing blocks from several messages in parallel.
+        //! @param [in] data Array of @a count addresses of messages to decrypt in place.
+        //! @param [in] sizes Array of @a count message sizes in bytes.
+        //! @param [in] count Number of messages.
+        //! @return True on success, false on error. On error, some messages may be already decrypted.
+        //!
+        virtual bool decryptBatch(uint8_t* const data[], const size_t sizes[], size_t count);
+
     protected:
         // Protected fields, for chaining mode subclass implementation.
         BlockCipher* algo;        //!< An instance of the block cipher.
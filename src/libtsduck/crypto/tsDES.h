@@ -69,8 +69,9 @@ namespace ts {
         uint32_t _ek[32];  // Encryption keys
         uint32_t _dk[32];  // Decryption keys
 
-        // Computation static methods, shared with TDES
+        // Computation static methods, shared with TDES and DESBatch
         friend class TDES;
+        friend class DESBatch;
         static const uint16_t EN0 = 0;
         static const uint16_t DE1 = 1;
         static void cookey(const uint32_t* raw1, uint32_t* keyout);
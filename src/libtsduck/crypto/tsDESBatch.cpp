@@ -0,0 +1,342 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsDESBatch.h"
+#include "tsMemory.h"
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::DESBatch::BLOCK_SIZE;
+constexpr size_t ts::DESBatch::KEY_SIZE;
+constexpr size_t ts::DESBatch::BATCH_SIZE;
+constexpr size_t ts::DESBatch::MIN_BITSLICE;
+constexpr size_t ts::DESBatch::SLICE_WORDS;
+#endif
+
+// Permutation tables from FIPS 46-3. Bits are numbered from 1, most significant first.
+namespace {
+
+    // Initial permutation (IP). The final permutation is its inverse.
+    const uint8_t IP[64] = {
+        58, 50, 42, 34, 26, 18, 10,  2, 60, 52, 44, 36, 28, 20, 12,  4,
+        62, 54, 46, 38, 30, 22, 14,  6, 64, 56, 48, 40, 32, 24, 16,  8,
+        57, 49, 41, 33, 25, 17,  9,  1, 59, 51, 43, 35, 27, 19, 11,  3,
+        61, 53, 45, 37, 29, 21, 13,  5, 63, 55, 47, 39, 31, 23, 15,  7
+    };
+
+    // Expansion of the right half (E).
+    const uint8_t E[48] = {
+        32,  1,  2,  3,  4,  5,  4,  5,  6,  7,  8,  9,
+         8,  9, 10, 11, 12, 13, 12, 13, 14, 15, 16, 17,
+        16, 17, 18, 19, 20, 21, 20, 21, 22, 23, 24, 25,
+        24, 25, 26, 27, 28, 29, 28, 29, 30, 31, 32,  1
+    };
+
+    // Inverse of the permutation P, from 0: position of the S-box output bit N in the output of f.
+    const uint8_t PINV[32] = {
+         8, 16, 22, 30, 12, 27,  1, 17, 23, 15, 29,  5, 25, 19,  9,  0,
+         7, 13, 24,  2,  3, 28, 10, 18, 31, 11, 21,  6,  4, 26, 14, 20
+    };
+
+    // Permuted choices of the key schedule.
+    const uint8_t PC1[56] = {
+        57, 49, 41, 33, 25, 17,  9,  1, 58, 50, 42, 34, 26, 18,
+        10,  2, 59, 51, 43, 35, 27, 19, 11,  3, 60, 52, 44, 36,
+        63, 55, 47, 39, 31, 23, 15,  7, 62, 54, 46, 38, 30, 22,
+        14,  6, 61, 53, 45, 37, 29, 21, 13,  5, 28, 20, 12,  4
+    };
+    const uint8_t PC2[48] = {
+        14, 17, 11, 24,  1,  5,  3, 28, 15,  6, 21, 10,
+        23, 19, 12,  4, 26,  8, 16,  7, 27, 20, 13,  2,
+        41, 52, 31, 37, 47, 55, 30, 40, 51, 45, 33, 48,
+        44, 49, 39, 56, 34, 53, 46, 42, 50, 36, 29, 32
+    };
+
+    // Left rotations of the key halves, per round.
+    const uint8_t SHIFTS[16] = {1, 1, 2, 2, 2, 2, 2, 2, 1, 2, 2, 2, 2, 2, 2, 1};
+
+    // S-boxes, indexed by row * 16 + column.
+    const uint8_t SBOX[8][64] = {
+        {14,  4, 13,  1,  2, 15, 11,  8,  3, 10,  6, 12,  5,  9,  0,  7,
+          0, 15,  7,  4, 14,  2, 13,  1, 10,  6, 12, 11,  9,  5,  3,  8,
+          4,  1, 14,  8, 13,  6,  2, 11, 15, 12,  9,  7,  3, 10,  5,  0,
+         15, 12,  8,  2,  4,  9,  1,  7,  5, 11,  3, 14, 10,  0,  6, 13},
+        {15,  1,  8, 14,  6, 11,  3,  4,  9,  7,  2, 13, 12,  0,  5, 10,
+          3, 13,  4,  7, 15,  2,  8, 14, 12,  0,  1, 10,  6,  9, 11,  5,
+          0, 14,  7, 11, 10,  4, 13,  1,  5,  8, 12,  6,  9,  3,  2, 15,
+         13,  8, 10,  1,  3, 15,  4,  2, 11,  6,  7, 12,  0,  5, 14,  9},
+        {10,  0,  9, 14,  6,  3, 15,  5,  1, 13, 12,  7, 11,  4,  2,  8,
+         13,  7,  0,  9,  3,  4,  6, 10,  2,  8,  5, 14, 12, 11, 15,  1,
+         13,  6,  4,  9,  8, 15,  3,  0, 11,  1,  2, 12,  5, 10, 14,  7,
+          1, 10, 13,  0,  6,  9,  8,  7,  4, 15, 14,  3, 11,  5,  2, 12},
+        { 7, 13, 14,  3,  0,  6,  9, 10,  1,  2,  8,  5, 11, 12,  4, 15,
+         13,  8, 11,  5,  6, 15,  0,  3,  4,  7,  2, 12,  1, 10, 14,  9,
+         10,  6,  9,  0, 12, 11,  7, 13, 15,  1,  3, 14,  5,  2,  8,  4,
+          3, 15,  0,  6, 10,  1, 13,  8,  9,  4,  5, 11, 12,  7,  2, 14},
+        { 2, 12,  4,  1,  7, 10, 11,  6,  8,  5,  3, 15, 13,  0, 14,  9,
+         14, 11,  2, 12,  4,  7, 13,  1,  5,  0, 15, 10,  3,  9,  8,  6,
+          4,  2,  1, 11, 10, 13,  7,  8, 15,  9, 12,  5,  6,  3,  0, 14,
+         11,  8, 12,  7,  1, 14,  2, 13,  6, 15,  0,  9, 10,  4,  5,  3},
+        {12,  1, 10, 15,  9,  2,  6,  8,  0, 13,  3,  4, 14,  7,  5, 11,
+         10, 15,  4,  2,  7, 12,  9,  5,  6,  1, 13, 14,  0, 11,  3,  8,
+          9, 14, 15,  5,  2,  8, 12,  3,  7,  0,  4, 10,  1, 13, 11,  6,
+          4,  3,  2, 12,  9,  5, 15, 10, 11, 14,  1,  7,  6,  0,  8, 13},
+        { 4, 11,  2, 14, 15,  0,  8, 13,  3, 12,  9,  7,  5, 10,  6,  1,
+         13,  0, 11,  7,  4,  9,  1, 10, 14,  3,  5, 12,  2, 15,  8,  6,
+          1,  4, 11, 13, 12,  3,  7, 14, 10, 15,  6,  8,  0,  5,  9,  2,
+          6, 11, 13,  8,  1,  4, 10,  7,  9,  5,  0, 15, 14,  2,  3, 12},
+        {13,  2,  8,  4,  6, 15, 11,  1, 10,  9,  3, 14,  5,  0, 12,  7,
+          1, 15, 13,  8, 10,  3,  7,  4, 12,  5,  6, 11,  0, 14,  9,  2,
+          7, 11,  4,  1,  9, 12, 14,  2,  0,  6, 10, 13, 15,  3,  5,  8,
+          2,  1, 14,  7,  4, 10,  8, 13, 15, 12,  9,  0,  3,  5,  6, 11}
+    };
+
+    // Index of the lowest bit which is set in a 4-bit value.
+    const uint8_t LOW_BIT[16] = {0, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0};
+}
+
+
+//----------------------------------------------------------------------------
+// Constructor.
+//----------------------------------------------------------------------------
+
+ts::DESBatch::DESBatch() :
+    _key_set(false),
+    _ek(),
+    _dk(),
+    _truth()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Schedule a new key.
+//----------------------------------------------------------------------------
+
+bool ts::DESBatch::setKey(const void* key, size_t key_length)
+{
+    _key_set = false;
+    if (key == nullptr || key_length != KEY_SIZE) {
+        return false;
+    }
+    const uint8_t* const kbytes = reinterpret_cast<const uint8_t*>(key);
+
+    // Key schedule for the classical implementation.
+    DES::deskey(kbytes, DES::EN0, _ek);
+    DES::deskey(kbytes, DES::DE1, _dk);
+
+    // Key halves C and D after permuted choice 1, one bit per byte.
+    uint8_t cd[56];
+    for (size_t i = 0; i < 56; ++i) {
+        const size_t bit = PC1[i] - 1;
+        cd[i] = (kbytes[bit / 8] >> (7 - bit % 8)) & 0x01;
+    }
+
+    for (size_t round = 0; round < DES::ROUNDS; ++round) {
+        // Rotate the two key halves.
+        std::rotate(cd, cd + SHIFTS[round], cd + 28);
+        std::rotate(cd + 28, cd + 28 + SHIFTS[round], cd + 56);
+
+        for (size_t sbox = 0; sbox < 8; ++sbox) {
+            // The 6 bits of round key for this S-box.
+            uint8_t kbits = 0;
+            for (size_t b = 0; b < 6; ++b) {
+                kbits = uint8_t(kbits << 1) | cd[PC2[6 * sbox + b] - 1];
+            }
+            // Truth tables, with the key merged in the S-box input.
+            for (size_t out = 0; out < 4; ++out) {
+                for (uint8_t upper = 0; upper < 16; ++upper) {
+                    uint8_t func = 0;
+                    for (uint8_t lower = 0; lower < 4; ++lower) {
+                        const uint8_t in = (uint8_t(upper << 2) | lower) ^ kbits;
+                        const uint8_t row = ((in >> 4) & 0x02) | (in & 0x01);
+                        const uint8_t col = (in >> 1) & 0x0F;
+                        func |= ((SBOX[sbox][16 * row + col] >> (3 - out)) & 0x01) << lower;
+                    }
+                    _truth[round][sbox][out][upper] = func;
+                }
+            }
+        }
+    }
+
+    _key_set = true;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// In-place transposition of a 64x64 bit matrix (Hacker's Delight, 7-3).
+// Row N is a 64-bit word, column 0 is its most significant bit.
+//----------------------------------------------------------------------------
+
+void ts::DESBatch::Transpose(uint64_t* rows)
+{
+    uint64_t mask = TS_UCONST64(0x00000000FFFFFFFF);
+    for (size_t shift = 32; shift != 0; shift >>= 1, mask ^= mask << shift) {
+        for (size_t k = 0; k < 64; k = ((k | shift) + 1) & ~shift) {
+            const uint64_t t = (rows[k] ^ (rows[k | shift] >> shift)) & mask;
+            rows[k] ^= t;
+            rows[k | shift] ^= t << shift;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Compute the DES rounds on 64 bit slices.
+//----------------------------------------------------------------------------
+
+void ts::DESBatch::rounds(Slice* bits, bool decrypt) const
+{
+    // Initial permutation: simply a different selection of slices.
+    Slice lr[64];
+    for (size_t i = 0; i < 64; ++i) {
+        lr[i] = bits[IP[i] - 1];
+    }
+    Slice* left = lr;
+    Slice* right = lr + 32;
+
+    for (size_t round = 0; round < DES::ROUNDS; ++round) {
+        const auto& truth(_truth[decrypt ? DES::ROUNDS - 1 - round : round]);
+
+        for (size_t sbox = 0; sbox < 8; ++sbox) {
+            // The 6 S-box input bits, from the expansion of the right half.
+            const Slice* in[6];
+            for (size_t b = 0; b < 6; ++b) {
+                in[b] = &right[E[6 * sbox + b] - 1];
+            }
+
+            // All 16 boolean functions of the 2 last input bits.
+            Slice minterm[4];
+            Slice func[16];
+            for (size_t w = 0; w < SLICE_WORDS; ++w) {
+                const uint64_t a = in[4]->w[w];
+                const uint64_t b = in[5]->w[w];
+                minterm[0].w[w] = ~a & ~b;
+                minterm[1].w[w] = ~a & b;
+                minterm[2].w[w] = a & ~b;
+                minterm[3].w[w] = a & b;
+                func[0].w[w] = 0;
+            }
+            for (size_t f = 1; f < 16; ++f) {
+                for (size_t w = 0; w < SLICE_WORDS; ++w) {
+                    func[f].w[w] = func[f & (f - 1)].w[w] | minterm[LOW_BIT[f]].w[w];
+                }
+            }
+
+            // Each output bit is a multiplexer tree over the 4 first input bits.
+            for (size_t out = 0; out < 4; ++out) {
+                const uint8_t* const index = truth[sbox][out];
+                Slice level3[8], level2[4], level1[2];
+                for (size_t j = 0; j < 8; ++j) {
+                    level3[j] = Mux(func[index[2 * j]], func[index[2 * j + 1]], *in[3]);
+                }
+                for (size_t j = 0; j < 4; ++j) {
+                    level2[j] = Mux(level3[2 * j], level3[2 * j + 1], *in[2]);
+                }
+                for (size_t j = 0; j < 2; ++j) {
+                    level1[j] = Mux(level2[2 * j], level2[2 * j + 1], *in[1]);
+                }
+                const Slice result(Mux(level1[0], level1[1], *in[0]));
+
+                // Permutation P and addition to the left half.
+                Slice& dest(left[PINV[4 * sbox + out]]);
+                for (size_t w = 0; w < SLICE_WORDS; ++w) {
+                    dest.w[w] ^= result.w[w];
+                }
+            }
+        }
+        std::swap(left, right);
+    }
+
+    // Final permutation of R16 L16.
+    for (size_t i = 0; i < 32; ++i) {
+        bits[IP[i] - 1] = right[i];
+        bits[IP[32 + i] - 1] = left[i];
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Process a list of blocks.
+//----------------------------------------------------------------------------
+
+bool ts::DESBatch::process(const uint8_t* const input[], uint8_t* const output[], size_t count, bool decrypt)
+{
+    if (!_key_set) {
+        return false;
+    }
+
+    while (count > 0) {
+        const size_t n = std::min(count, BATCH_SIZE);
+        if (n < MIN_BITSLICE) {
+            // Not enough blocks, use the classical implementation.
+            uint32_t work[2];
+            for (size_t i = 0; i < n; ++i) {
+                work[0] = GetUInt32(input[i]);
+                work[1] = GetUInt32(input[i] + 4);
+                DES::desfunc(work, decrypt ? _dk : _ek);
+                PutUInt32(output[i], work[0]);
+                PutUInt32(output[i] + 4, work[1]);
+            }
+        }
+        else {
+            // Transpose groups of 64 blocks into bit slices.
+            uint64_t rows[SLICE_WORDS][64];
+            Slice bits[64];
+            for (size_t w = 0; w < SLICE_WORDS; ++w) {
+                for (size_t j = 0; j < 64; ++j) {
+                    const size_t k = 64 * w + j;
+                    rows[w][j] = k < n ? GetUInt64(input[k]) : 0;
+                }
+                Transpose(rows[w]);
+                for (size_t i = 0; i < 64; ++i) {
+                    bits[i].w[w] = rows[w][i];
+                }
+            }
+
+            rounds(bits, decrypt);
+
+            // Transpose back the bit slices into blocks.
+            for (size_t w = 0; w < SLICE_WORDS; ++w) {
+                for (size_t i = 0; i < 64; ++i) {
+                    rows[w][i] = bits[i].w[w];
+                }
+                Transpose(rows[w]);
+                for (size_t j = 0; j < 64 && 64 * w + j < n; ++j) {
+                    PutUInt64(output[64 * w + j], rows[w][j]);
+                }
+            }
+        }
+        input += n;
+        output += n;
+        count -= n;
+    }
+    return true;
+}
@@ -0,0 +1,143 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Bitsliced DES engine, processing many independent blocks at once.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsDES.h"
+
+namespace ts {
+    //!
+    //! Bitsliced DES engine, processing many independent blocks at once.
+    //! @ingroup crypto
+    //!
+    //! This class is not a BlockCipher. It encrypts or decrypts a set of unrelated
+    //! DES blocks (ECB mode) with the same key. The blocks are transposed into
+    //! "bit slices", one 64-bit word per bit position, and the 16 DES rounds are
+    //! computed using bitwise operations on BATCH_SIZE blocks at a time. The S-boxes
+    //! are evaluated as multiplexer trees over precomputed truth tables in which
+    //! the round keys are already merged.
+    //!
+    //! The bitsliced computation has a fixed cost per batch. Smaller batches are
+    //! processed by the classical DES implementation, one block at a time.
+    //! The results are identical in all cases.
+    //!
+    class TSDUCKDLL DESBatch
+    {
+        TS_NOCOPY(DESBatch);
+    public:
+        static constexpr size_t BLOCK_SIZE = DES::BLOCK_SIZE;  //!< DES block size in bytes.
+        static constexpr size_t KEY_SIZE = DES::KEY_SIZE;      //!< DES key size in bytes.
+        static constexpr size_t BATCH_SIZE = 128;              //!< Number of blocks which are processed in parallel.
+        static constexpr size_t MIN_BITSLICE = 48;             //!< Below this number of blocks, the classical implementation is used.
+
+        //!
+        //! Constructor.
+        //!
+        DESBatch();
+
+        //!
+        //! Schedule a new key.
+        //! @param [in] key Address of key value.
+        //! @param [in] key_length Key length in bytes, must be KEY_SIZE.
+        //! @return True on success, false on error.
+        //!
+        bool setKey(const void* key, size_t key_length);
+
+        //!
+        //! Check if a key has been successfully set.
+        //! @return True if a key is set.
+        //!
+        bool hasKey() const { return _key_set; }
+
+        //!
+        //! Encrypt independent blocks.
+        //! @param [in] input Array of @a count addresses of BLOCK_SIZE-byte plain text blocks.
+        //! @param [out] output Array of @a count addresses of BLOCK_SIZE-byte cipher text blocks.
+        //! An output block may be identical to its input block (encryption in place).
+        //! @param [in] count Number of blocks.
+        //! @return True on success, false on error (no key set).
+        //!
+        bool encrypt(const uint8_t* const input[], uint8_t* const output[], size_t count)
+        {
+            return process(input, output, count, false);
+        }
+
+        //!
+        //! Decrypt independent blocks.
+        //! @param [in] input Array of @a count addresses of BLOCK_SIZE-byte cipher text blocks.
+        //! @param [out] output Array of @a count addresses of BLOCK_SIZE-byte plain text blocks.
+        //! An output block may be identical to its input block (decryption in place).
+        //! @param [in] count Number of blocks.
+        //! @return True on success, false on error (no key set).
+        //!
+        bool decrypt(const uint8_t* const input[], uint8_t* const output[], size_t count)
+        {
+            return process(input, output, count, true);
+        }
+
+    private:
+        // A bit slice: one bit from each of the BATCH_SIZE blocks.
+        static constexpr size_t SLICE_WORDS = BATCH_SIZE / 64;
+        struct alignas(16) Slice {
+            uint64_t w[SLICE_WORDS];
+        };
+
+        bool     _key_set;
+        uint32_t _ek[32];  // Encryption keys, for the classical implementation.
+        uint32_t _dk[32];  // Decryption keys, for the classical implementation.
+
+        // Truth tables of the S-boxes with merged round key. For each round, S-box and
+        // output bit, indexed by the 4 first S-box input bits, a 4-bit boolean function
+        // of the 2 last input bits (bit N is the result when the 2 last bits are N).
+        uint8_t  _truth[DES::ROUNDS][8][4][16];
+
+        // Process a list of blocks.
+        bool process(const uint8_t* const input[], uint8_t* const output[], size_t count, bool decrypt);
+
+        // Compute the DES rounds on 64 bit slices.
+        void rounds(Slice* bits, bool decrypt) const;
+
+        // Bitwise multiplexer: bits from x when s is 0, from y when s is 1.
+        static inline Slice Mux(const Slice& x, const Slice& y, const Slice& s)
+        {
+            Slice r;
+            for (size_t i = 0; i < SLICE_WORDS; ++i) {
+                r.w[i] = x.w[i] ^ ((x.w[i] ^ y.w[i]) & s.w[i]);
+            }
+            return r;
+        }
+
+        // In-place transposition of a 64x64 bit matrix.
+        static void Transpose(uint64_t* rows);
+    };
+}
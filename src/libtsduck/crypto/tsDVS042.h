@@ -55,6 +55,11 @@ namespace ts {
     //! The ATIS-0800006 standard (IDSA) uses the same chaining mode and residue
     //! processing as DVS-042 but is based on AES instead of DES.
     //!
+    //! Batch processing (encryptBatch() and decryptBatch()) processes the block
+    //! number N of all messages at once since the messages are independent.
+    //! Subclasses may override encryptBlocks() and decryptBlocks() to use an
+    //! implementation of the block cipher which is faster on many blocks.
+    //!
     //! @tparam CIPHER A subclass of ts::BlockCipher, the underlying block cipher.
     //!
     template <class CIPHER>
@@ -95,7 +100,36 @@ namespace ts {
         //! @copydoc ts::BlockCipher::name()
         virtual UString name() const override;
 
+        //! @copydoc ts::CipherChaining::encryptBatch()
+        virtual bool encryptBatch(uint8_t* const data[], const size_t sizes[], size_t count) override;
+
+        //! @copydoc ts::CipherChaining::decryptBatch()
+        virtual bool decryptBatch(uint8_t* const data[], const size_t sizes[], size_t count) override;
+
     protected:
+        //!
+        //! Encrypt independent blocks with the underlying block cipher, in ECB mode.
+        //! Used by encryptBatch() and decryptBatch(). The default implementation
+        //! encrypts the blocks one by one.
+        //! @param [in] input Array of @a count addresses of input blocks.
+        //! @param [out] output Array of @a count addresses of output blocks.
+        //! Input and output blocks never overlap.
+        //! @param [in] count Number of blocks.
+        //! @return True on success, false on error.
+        //!
+        virtual bool encryptBlocks(const uint8_t* const input[], uint8_t* const output[], size_t count);
+
+        //!
+        //! Decrypt independent blocks with the underlying block cipher, in ECB mode.
+        //! Used by decryptBatch(). The default implementation decrypts the blocks one by one.
+        //! @param [in] input Array of @a count addresses of input blocks.
+        //! @param [out] output Array of @a count addresses of output blocks.
+        //! Input and output blocks never overlap.
+        //! @param [in] count Number of blocks.
+        //! @return True on success, false on error.
+        //!
+        virtual bool decryptBlocks(const uint8_t* const input[], uint8_t* const output[], size_t count);
+
         //! @copydoc ts::BlockCipher::encryptImpl()
         virtual bool encryptImpl(const void* plain, size_t plain_length, void* cipher, size_t cipher_maxsize, size_t* cipher_length) override;
 
@@ -104,6 +138,16 @@ namespace ts {
 
     protected:
         ByteBlock shortIV;  //!< Current initialization vector for short blocks.
+
+    private:
+        // Work areas for batch processing.
+        std::vector<const uint8_t*> _batch_in;    // Input blocks.
+        std::vector<uint8_t*>       _batch_out;   // Output blocks.
+        std::vector<const uint8_t*> _batch_prev;  // Previous cipher block (or IV) of each message.
+        ByteBlock                   _batch_work;  // Intermediate blocks.
+
+        // Process the final incomplete blocks of all messages in a batch.
+        bool processResidues(uint8_t* const data[], const size_t sizes[], size_t count);
     };
 }
 
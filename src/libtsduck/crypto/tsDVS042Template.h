@@ -46,7 +46,11 @@ TS_MSC_NOWARNING(4505) // warning C4505: 'ts::DVS042<ts::AES>::encrypt': unrefer
 template<class CIPHER>
 ts::DVS042<CIPHER>::DVS042() :
     CipherChainingTemplate<CIPHER>(1, 1, 1),
-    shortIV(this->block_size)
+    shortIV(this->block_size),
+    _batch_in(),
+    _batch_out(),
+    _batch_prev(),
+    _batch_work()
 {
 }
 
@@ -223,4 +227,193 @@ bool ts::DVS042<CIPHER>::decryptImpl(const void* cipher, size_t cipher_length, v
     return true;
 }
 
+//----------------------------------------------------------------------------
+// Encrypt / decrypt independent blocks, default implementation.
+//----------------------------------------------------------------------------
+
+template<class CIPHER>
+bool ts::DVS042<CIPHER>::encryptBlocks(const uint8_t* const input[], uint8_t* const output[], size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (!this->algo->encrypt(input[i], this->block_size, output[i], this->block_size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<class CIPHER>
+bool ts::DVS042<CIPHER>::decryptBlocks(const uint8_t* const input[], uint8_t* const output[], size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (!this->algo->decrypt(input[i], this->block_size, output[i], this->block_size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Process the final incomplete blocks of all messages in a batch.
+// On input, _batch_prev contains the last full cipher block of each message
+// or the short IV for short messages. Same processing in both directions.
+//----------------------------------------------------------------------------
+
+template<class CIPHER>
+bool ts::DVS042<CIPHER>::processResidues(uint8_t* const data[], const size_t sizes[], size_t count)
+{
+    const size_t bsize = this->block_size;
+
+    _batch_in.clear();
+    _batch_out.clear();
+    _batch_work.resize(count * bsize);
+
+    // work = encrypt (Cn-1), which is encrypt (shortIV) for short packets
+    for (size_t i = 0; i < count; ++i) {
+        if (sizes[i] % bsize != 0) {
+            _batch_in.push_back(_batch_prev[i]);
+            _batch_out.push_back(_batch_work.data() + _batch_out.size() * bsize);
+        }
+    }
+    if (_batch_in.empty()) {
+        return true;
+    }
+    if (!encryptBlocks(_batch_in.data(), _batch_out.data(), _batch_in.size())) {
+        return false;
+    }
+
+    // Cn = work XOR Pn or Pn = work XOR Cn, truncated
+    const uint8_t* work_block = _batch_work.data();
+    for (size_t i = 0; i < count; ++i) {
+        const size_t residue = sizes[i] % bsize;
+        if (residue != 0) {
+            uint8_t* last = data[i] + sizes[i] - residue;
+            for (size_t k = 0; k < residue; ++k) {
+                last[k] ^= work_block[k];
+            }
+            work_block += bsize;
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Encryption of several messages in DVS 042 mode.
+//----------------------------------------------------------------------------
+
+template<class CIPHER>
+bool ts::DVS042<CIPHER>::encryptBatch(uint8_t* const data[], const size_t sizes[], size_t count)
+{
+    const size_t bsize = this->block_size;
+
+    if (this->algo == nullptr || this->iv.size() != bsize || this->shortIV.size() != bsize) {
+        return false;
+    }
+
+    // Select IV depending on block size. Each message counts as one encryption.
+    size_t max_blocks = 0;
+    _batch_prev.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (!this->allowEncrypt()) {
+            return false;
+        }
+        _batch_prev[i] = sizes[i] < bsize ? this->shortIV.data() : this->iv.data();
+        max_blocks = std::max(max_blocks, sizes[i] / bsize);
+    }
+
+    // The chaining is sequential inside a message but the messages are independent.
+    // Encrypt the block number N of all messages at once in CBC mode.
+    _batch_work.resize(count * bsize);
+    for (size_t blk = 0; blk < max_blocks; ++blk) {
+        _batch_in.clear();
+        _batch_out.clear();
+        for (size_t i = 0; i < count; ++i) {
+            if (blk < sizes[i] / bsize) {
+                uint8_t* pt = data[i] + blk * bsize;
+                uint8_t* xored = _batch_work.data() + _batch_in.size() * bsize;
+                // xored = previous-cipher XOR plain-text
+                for (size_t k = 0; k < bsize; ++k) {
+                    xored[k] = _batch_prev[i][k] ^ pt[k];
+                }
+                // cipher-text = encrypt (xored), in place of plain-text
+                _batch_in.push_back(xored);
+                _batch_out.push_back(pt);
+                // previous-cipher = cipher-text
+                _batch_prev[i] = pt;
+            }
+        }
+        if (!encryptBlocks(_batch_in.data(), _batch_out.data(), _batch_in.size())) {
+            return false;
+        }
+    }
+
+    // Process final blocks if incomplete.
+    return processResidues(data, sizes, count);
+}
+
+
+//----------------------------------------------------------------------------
+// Decryption of several messages in DVS 042 mode.
+//----------------------------------------------------------------------------
+
+template<class CIPHER>
+bool ts::DVS042<CIPHER>::decryptBatch(uint8_t* const data[], const size_t sizes[], size_t count)
+{
+    const size_t bsize = this->block_size;
+
+    if (this->algo == nullptr || this->iv.size() != bsize || this->shortIV.size() != bsize) {
+        return false;
+    }
+
+    // Each message counts as one decryption. Locate the last full cipher block of each message.
+    size_t total_blocks = 0;
+    _batch_prev.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (!this->allowDecrypt()) {
+            return false;
+        }
+        const size_t nblocks = sizes[i] / bsize;
+        _batch_prev[i] = nblocks == 0 ? this->shortIV.data() : data[i] + (nblocks - 1) * bsize;
+        total_blocks += nblocks;
+    }
+
+    // Process final blocks first, while the previous cipher blocks are still intact.
+    if (!processResidues(data, sizes, count)) {
+        return false;
+    }
+
+    // Without chaining dependency on decryption, decrypt all full blocks at once.
+    _batch_in.clear();
+    _batch_out.clear();
+    _batch_work.resize(total_blocks * bsize);
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t blk = 0; blk < sizes[i] / bsize; ++blk) {
+            _batch_in.push_back(data[i] + blk * bsize);
+            _batch_out.push_back(_batch_work.data() + _batch_out.size() * bsize);
+        }
+    }
+    if (!decryptBlocks(_batch_in.data(), _batch_out.data(), _batch_in.size())) {
+        return false;
+    }
+
+    // plain-text = previous-cipher XOR decrypted block. Start from the
+    // end of each message so that the previous cipher block is still there.
+    const uint8_t* decrypted = _batch_work.data();
+    for (size_t i = 0; i < count; ++i) {
+        const size_t nblocks = sizes[i] / bsize;
+        for (size_t blk = nblocks; blk > 0; --blk) {
+            uint8_t* pt = data[i] + (blk - 1) * bsize;
+            const uint8_t* previous = blk == 1 ? this->iv.data() : pt - bsize;
+            const uint8_t* dec = decrypted + (blk - 1) * bsize;
+            for (size_t k = 0; k < bsize; ++k) {
+                pt[k] = previous[k] ^ dec[k];
+            }
+        }
+        decrypted += nblocks * bsize;
+    }
+    return true;
+}
+
 TS_POP_WARNING()
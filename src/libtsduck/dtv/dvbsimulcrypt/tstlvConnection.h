@@ -155,6 +155,8 @@ namespace ts {
             size_t          _invalid_msg_count;
             MUTEX           _send_mutex;
             MUTEX           _receive_mutex;
+            ByteBlockPtr    _send_buffer;     // Serialization buffer, reused by all messages, protected by _send_mutex.
+            ByteBlock       _receive_buffer;  // Input buffer, reused by all messages, protected by _receive_mutex.
         };
     }
 }
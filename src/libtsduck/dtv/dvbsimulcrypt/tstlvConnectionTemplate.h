@@ -46,7 +46,9 @@ ts::tlv::Connection<MUTEX>::Connection(const Protocol* protocol, bool auto_error
     _max_invalid_msg(max_invalid_msg),
     _invalid_msg_count(0),
     _send_mutex(),
-    _receive_mutex()
+    _receive_mutex(),
+    _send_buffer(new ByteBlock),
+    _receive_buffer()
 {
 }
 
@@ -86,12 +88,13 @@ bool ts::tlv::Connection<MUTEX>::send(const Message& msg, Logger& logger)
 {
     logger.log(msg, u"sending message to " + peerName());
 
-    ByteBlockPtr bbp(new ByteBlock);
-    Serializer serial(bbp);
-    msg.serialize(serial);
-
+    // Serialize into the send buffer. Its capacity is kept from one message
+    // to another, there is no memory allocation in the steady state.
     Guard lock(_send_mutex);
-    return SuperClass::send(bbp->data(), bbp->size(), logger.report());
+    _send_buffer->clear();
+    Serializer serial(_send_buffer);
+    msg.serialize(serial);
+    return SuperClass::send(_send_buffer->data(), _send_buffer->size(), logger.report());
 }
 
 
@@ -115,27 +118,27 @@ bool ts::tlv::Connection<MUTEX>::receive(MessagePtr& msg, const AbortInterface*
 
     // Loop until a valid message is received
     for (;;) {
-        ByteBlock bb(header_size);
 
-        // Receive complete message
-        {
-            Guard lock(_receive_mutex);
+        // The message is received in a buffer which is reused from one message to
+        // another and analyzed in place. The lock is held until the message object
+        // is built since the message factory points into the receive buffer.
+        Guard lock(_receive_mutex);
 
-            // Read message header
-            if (!SuperClass::receive(bb.data(), header_size, abort, logger.report())) {
-                return false;
-            }
+        // Read message header
+        _receive_buffer.resize(header_size);
+        if (!SuperClass::receive(_receive_buffer.data(), header_size, abort, logger.report())) {
+            return false;
+        }
 
-            // Get message length and read message payload
-            const size_t length = GetUInt16(bb.data() + length_offset);
-            bb.resize(header_size + length);
-            if (!SuperClass::receive(bb.data() + header_size, length, abort, logger.report())) {
-                return false;
-            }
+        // Get message length and read message payload
+        const size_t length = GetUInt16(_receive_buffer.data() + length_offset);
+        _receive_buffer.resize(header_size + length);
+        if (!SuperClass::receive(_receive_buffer.data() + header_size, length, abort, logger.report())) {
+            return false;
         }
 
         // Analyze the message
-        MessageFactory mf(bb.data(), bb.size(), _protocol);
+        MessageFactory mf(_receive_buffer.data(), _receive_buffer.size(), _protocol);
         if (mf.errorStatus() == tlv::OK) {
             _invalid_msg_count = 0;
             mf.factory(msg);
@@ -35,6 +35,10 @@
 #include "tstlvAnalyzer.h"
 TSDUCK_SOURCE;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::tlv::MessageFactory::INLINE_PARAM_COUNT;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Constructors: Analyze a TLV message in memory.
@@ -49,7 +53,8 @@ ts::tlv::MessageFactory::MessageFactory(const void* addr, size_t size, const Pro
     _error_info_is_offset(false),
     _protocol_version(0),
     _command_tag(0),
-    _params()
+    _params(),
+    _compounds()
 {
     analyzeMessage();
 }
@@ -63,7 +68,8 @@ ts::tlv::MessageFactory::MessageFactory(const ByteBlock &bb, const Protocol* pro
     _error_info_is_offset(false),
     _protocol_version(0),
     _command_tag(0),
-    _params()
+    _params(),
+    _compounds()
 {
     analyzeMessage();
 }
@@ -186,15 +192,17 @@ void ts::tlv::MessageFactory::analyzeMessage()
         if (parm_it->second.compound != nullptr) {
 
             // The parameter is a compound TLV, analyze it.
-            // Store the parameter value in the multimap for this command.
+            // Store the parameter value in the list for this command.
             // Analyze the compound parameter.
 
-            auto it = _params.insert(ParameterMultimap::value_type(parm_tag, ExtParameter(tlv_addr, tlv_size, value_addr, value_length, new MessageFactory(tlv_addr, tlv_size, parm_it->second.compound))));
+            _compounds.push_back(new MessageFactory(tlv_addr, tlv_size, parm_it->second.compound));
+            const MessageFactory* compound = _compounds.back().pointer();
+            _params.push_back(ExtParameter(parm_tag, tlv_addr, tlv_size, value_addr, value_length, compound));
 
             // Check if the analysis is successful
-            if ((_error_status = it->second.compound->_error_status) != OK) {
-                _error_info = it->second.compound->_error_info;
-                _error_info_is_offset = it->second.compound->_error_info_is_offset;
+            if ((_error_status = compound->_error_status) != OK) {
+                _error_info = compound->_error_info;
+                _error_info_is_offset = compound->_error_info_is_offset;
                 if (_error_info_is_offset) {
                     _error_info += uint16_t(uint8_ptr(tlv_addr) - _msg_base); // offset
                 }
@@ -213,9 +221,9 @@ void ts::tlv::MessageFactory::analyzeMessage()
         else {
 
             // The parameter is not a compound TLV and its length is fine.
-            // Store the parameter value in the multimap for this command
+            // Store the parameter value in the list for this command
 
-            _params.insert(ParameterMultimap::value_type (parm_tag, ExtParameter(tlv_addr, tlv_size, value_addr, value_length)));
+            _params.push_back(ExtParameter(parm_tag, tlv_addr, tlv_size, value_addr, value_length));
         }
 
         // Advance to next parameter
@@ -244,7 +252,7 @@ void ts::tlv::MessageFactory::analyzeMessage()
         // Protocol-defined parameter properties:
         const Protocol::Parameter& desc = parm_it->second;
         // Number of actual occurences in current command:
-        size_t count = _params.count (tag);
+        size_t count = this->count(tag);
 
         if (count < desc.min_count || count > desc.max_count) {
             if (count == 0 && desc.min_count > 0) {
@@ -261,18 +269,64 @@ void ts::tlv::MessageFactory::analyzeMessage()
 }
 
 
+//----------------------------------------------------------------------------
+// Add a parameter in the list, allocate only after INLINE_PARAM_COUNT.
+//----------------------------------------------------------------------------
+
+void ts::tlv::MessageFactory::ParameterList::push_back(const ExtParameter& param)
+{
+    if (_count < INLINE_PARAM_COUNT) {
+        _inline[_count] = param;
+    }
+    else {
+        if (_extra.empty()) {
+            _extra.reserve(2 * INLINE_PARAM_COUNT);
+            _extra.assign(_inline, _inline + _count);
+        }
+        _extra.push_back(param);
+    }
+    _count++;
+}
+
+
+//----------------------------------------------------------------------------
+// Search parameters in the message.
+//----------------------------------------------------------------------------
+
+const ts::tlv::MessageFactory::ExtParameter* ts::tlv::MessageFactory::findParameter(TAG tag) const
+{
+    for (const auto& it : _params) {
+        if (it.tag == tag) {
+            return &it;
+        }
+    }
+    return nullptr;
+}
+
+size_t ts::tlv::MessageFactory::count(TAG tag) const
+{
+    size_t n = 0;
+    for (const auto& it : _params) {
+        if (it.tag == tag) {
+            n++;
+        }
+    }
+    return n;
+}
+
+
 //----------------------------------------------------------------------------
 // Get location of the first occurence of a parameter:
 //----------------------------------------------------------------------------
 
 void ts::tlv::MessageFactory::get(TAG tag, Parameter& param) const
 {
-    ParameterMultimap::const_iterator it = _params.find(tag);
-    if (it == _params.end()) {
+    const ExtParameter* p = findParameter(tag);
+    if (p == nullptr) {
         throw DeserializationInternalError(UString::Format(u"No parameter 0x%X in message", {tag}));
     }
     else {
-        param = it->second;
+        param = *p;
     }
 }
 
@@ -285,12 +339,12 @@ void ts::tlv::MessageFactory::get(TAG tag, std::vector<Parameter>& param) const
 {
     // Reinitialize result vector
     param.clear();
-    param.reserve (_params.count (tag));
+    param.reserve(count(tag));
     // Fill vector with parameter values
-    ParameterMultimap::const_iterator it = _params.lower_bound(tag);
-    ParameterMultimap::const_iterator last = _params.upper_bound (tag);
-    for (; it != last; ++it) {
-        param.push_back(it->second);
+    for (const auto& it : _params) {
+        if (it.tag == tag) {
+            param.push_back(it);
+        }
     }
 }
 
@@ -303,13 +357,13 @@ void ts::tlv::MessageFactory::get(TAG tag, std::vector<bool>& param) const
 {
     // Reinitialize result vector
     param.clear ();
-    param.reserve(_params.count(tag));
+    param.reserve(count(tag));
     // Fill vector with parameter values
-    ParameterMultimap::const_iterator it = _params.lower_bound(tag);
-    ParameterMultimap::const_iterator last = _params.upper_bound(tag);
-    for (; it != last; ++it) {
-        checkParamSize<uint8_t> (tag, it);
-        param.push_back(GetUInt8(it->second.addr) != 0);
+    for (const auto& it : _params) {
+        if (it.tag == tag) {
+            checkParamSize<uint8_t>(it);
+            param.push_back(GetUInt8(it.addr) != 0);
+        }
     }
 }
 
@@ -322,12 +376,12 @@ void ts::tlv::MessageFactory::get(TAG tag, std::vector<std::string>& param) cons
 {
     // Reinitialize result vector
     param.clear ();
-    param.resize(_params.count(tag));
+    param.reserve(count(tag));
     // Fill vector with parameter values
-    ParameterMultimap::const_iterator it = _params.lower_bound(tag);
-    ParameterMultimap::const_iterator last = _params.upper_bound(tag);
-    for (int i = 0; it != last; ++it, ++i) {
-        param[i].assign(static_cast<const char*> (it->second.addr), it->second.length);
+    for (const auto& it : _params) {
+        if (it.tag == tag) {
+            param.push_back(std::string(static_cast<const char*>(it.addr), it.length));
+        }
     }
 }
 
@@ -338,15 +392,15 @@ void ts::tlv::MessageFactory::get(TAG tag, std::vector<std::string>& param) cons
 
 void ts::tlv::MessageFactory::getCompound(TAG tag, MessagePtr& param) const
 {
-    ParameterMultimap::const_iterator it = _params.find(tag);
-    if (it == _params.end()) {
+    const ExtParameter* p = findParameter(tag);
+    if (p == nullptr) {
         throw DeserializationInternalError(UString::Format(u"No parameter 0x%X in message", {tag}));
     }
-    else if (it->second.compound.isNull()) {
+    else if (p->compound == nullptr) {
         throw DeserializationInternalError(UString::Format(u"Parameter 0x%X is not a compound TLV", {tag}));
     }
     else {
-        it->second.compound->factory(param);
+        p->compound->factory(param);
     }
 }
 
@@ -359,16 +413,18 @@ void ts::tlv::MessageFactory::getCompound(TAG tag, std::vector<MessagePtr>& para
 {
     // Reinitialize result vector
     param.clear ();
-    param.resize(_params.count(tag));
+    param.resize(count(tag));
     // Fill vector with parameter values
-    ParameterMultimap::const_iterator it = _params.lower_bound(tag);
-    ParameterMultimap::const_iterator last = _params.upper_bound(tag);
-    for (int i = 0; it != last; ++it, ++i) {
-        if (it->second.compound.isNull()) {
+    size_t i = 0;
+    for (const auto& it : _params) {
+        if (it.tag != tag) {
+            continue;
+        }
+        else if (it.compound == nullptr) {
             throw DeserializationInternalError(UString::Format(u"Occurence %d of parameter 0x%X not a compound TLV", {i, tag}));
         }
         else {
-            it->second.compound->factory(param[i]);
+            it.compound->factory(param[i++]);
         }
     }
 }
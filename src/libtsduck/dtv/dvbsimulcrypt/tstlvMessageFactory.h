@@ -201,10 +201,7 @@ namespace ts {
             //! @param [in] tag Parameter tag to search.
             //! @return The actual number of occurences of a parameter.
             //!
-            size_t count(TAG tag) const
-            {
-                return _params.count(tag);
-            }
+            size_t count(TAG tag) const;
 
             //!
             //! Get the location of a parameter.
@@ -317,19 +314,22 @@ namespace ts {
         private:
             // Internal description of a parameter.
             // Include the description of compound TLV parameter.
-            // When compound.isNull(), this is not a compound TLV parameter.
+            // When compound is null, this is not a compound TLV parameter.
             struct ExtParameter : public Parameter
             {
                 // Public fields:
-                MessageFactoryPtr compound; // for compound TLV parameter
+                TAG                   tag;      // parameter tag
+                const MessageFactory* compound; // for compound TLV parameter, owned by _compounds
 
                 // Constructor:
-                ExtParameter(const void*     tlv_addr_ = nullptr,
-                             size_t          tlv_size_ = 0,
-                             const void*     addr_ = nullptr,
-                             LENGTH          length_ = 0,
-                             MessageFactory* compound_ = nullptr) :
+                ExtParameter(TAG                   tag_ = 0,
+                             const void*           tlv_addr_ = nullptr,
+                             size_t                tlv_size_ = 0,
+                             const void*           addr_ = nullptr,
+                             LENGTH                length_ = 0,
+                             const MessageFactory* compound_ = nullptr) :
                     Parameter(tlv_addr_, tlv_size_, addr_, length_),
+                    tag(tag_),
                     compound(compound_)
                 {
                 }
@@ -345,13 +345,37 @@ namespace ts {
             VERSION         _protocol_version;
             TAG             _command_tag;
 
-            // Location of actual parameters. Point into the message block.
-            typedef std::multimap <TAG, ExtParameter> ParameterMultimap;
-            ParameterMultimap _params;
+            // Number of parameters which are stored without allocation.
+            static constexpr size_t INLINE_PARAM_COUNT = 16;
+
+            // Flat list of parameters, faster to build and to search than a multimap with one node
+            // per parameter. The first INLINE_PARAM_COUNT parameters are stored in the object itself.
+            // A vector is allocated only for messages with more parameters.
+            class ParameterList
+            {
+            public:
+                ParameterList() : _count(0), _inline(), _extra() {}
+                void push_back(const ExtParameter& param);
+                const ExtParameter* begin() const { return _extra.empty() ? _inline : _extra.data(); }
+                const ExtParameter* end() const { return begin() + _count; }
+            private:
+                size_t _count;
+                ExtParameter _inline[INLINE_PARAM_COUNT];
+                std::vector<ExtParameter> _extra;
+            };
+
+            // Location of actual parameters, in message order. Point into the message block.
+            ParameterList _params;
+
+            // Analyzed compound TLV parameters, usually none.
+            std::vector<MessageFactoryPtr> _compounds;
 
             // Analyze the TLV message, called by constructors.
             void analyzeMessage();
 
+            // Get the first occurence of a parameter. Return a null pointer if not found.
+            const ExtParameter* findParameter(TAG tag) const;
+
             // Expected size of a type: default is sizeof().
             // Specializations can be provided.
             template <typename T> size_t dataSize() const {return sizeof(T);}
@@ -360,7 +384,7 @@ namespace ts {
             // Should never throw an exception, except bug in the
             // constructor of the Message subclasses.
             template <typename T>
-            void checkParamSize(TAG, const ParameterMultimap::const_iterator&) const;
+            void checkParamSize(const ExtParameter&) const;
         };
 
         // Template specializations for performance.
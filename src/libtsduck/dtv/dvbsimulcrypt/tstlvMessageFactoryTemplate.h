@@ -42,12 +42,12 @@
 //----------------------------------------------------------------------------
 
 template <typename T>
-void ts::tlv::MessageFactory::checkParamSize(TAG tag, const ParameterMultimap::const_iterator& it) const
+void ts::tlv::MessageFactory::checkParamSize(const ExtParameter& param) const
 {
     const size_t expected = dataSize<T>();
-    if (it->second.length != expected) {
+    if (param.length != expected) {
         throw DeserializationInternalError(
-            UString::Format(u"Bad size for parameter 0x%X in message, expected %d bytes, found %d", {tag, expected, it->second.length}));
+            UString::Format(u"Bad size for parameter 0x%X in message, expected %d bytes, found %d", {param.tag, expected, param.length}));
     }
 }
 
@@ -59,13 +59,13 @@ void ts::tlv::MessageFactory::checkParamSize(TAG tag, const ParameterMultimap::c
 template <typename INT, typename std::enable_if<std::is_integral<INT>::value>::type*>
 INT ts::tlv::MessageFactory::get(TAG tag) const
 {
-    ParameterMultimap::const_iterator it = _params.find(tag);
-    if (it == _params.end()) {
+    const ExtParameter* p = findParameter(tag);
+    if (p == nullptr) {
         throw DeserializationInternalError(UString::Format(u"No parameter 0x%X in message", {tag}));
     }
     else {
-        checkParamSize<INT>(tag, it);
-        return GetInt<INT>(it->second.addr);
+        checkParamSize<INT>(*p);
+        return GetInt<INT>(p->addr);
     }
 }
 
@@ -79,13 +79,13 @@ void ts::tlv::MessageFactory::get(TAG tag, std::vector<INT>& param) const
 {
     // Reinitialize result vector
     param.clear();
-    param.reserve(_params.count(tag));
+    param.reserve(count(tag));
     // Fill vector with parameter values
-    ParameterMultimap::const_iterator it = _params.lower_bound(tag);
-    ParameterMultimap::const_iterator last = _params.upper_bound (tag);
-    for (; it != last; ++it) {
-        checkParamSize<INT>(tag, it);
-        param.push_back(GetInt<INT>(it->second.addr));
+    for (const auto& it : _params) {
+        if (it.tag == tag) {
+            checkParamSize<INT>(it);
+            param.push_back(GetInt<INT>(it.addr));
+        }
     }
 }
 
@@ -120,20 +120,23 @@ void ts::tlv::MessageFactory::getCompound(TAG tag, std::vector<MSG>& param) cons
     // Reinitialize result vector
     param.clear();
     // Fill vector with parameter values
-    ParameterMultimap::const_iterator it = _params.lower_bound(tag);
-    ParameterMultimap::const_iterator last = _params.upper_bound(tag);
-    for (int i = 0; it != last; ++it, ++i) {
-        if (it->second.compound.isNull()) {
+    int i = 0;
+    for (const auto& it : _params) {
+        if (it.tag != tag) {
+            continue;
+        }
+        else if (it.compound == nullptr) {
             throw DeserializationInternalError(UString::Format(u"Occurence %d of parameter 0x%X not a compound TLV", {i, tag}));
         }
         else {
             MessagePtr gen;
-            it->second.compound->factory(gen);
+            it.compound->factory(gen);
             MSG* msg = dynamic_cast<MSG*> (gen.pointer());
             if (msg == 0) {
                 throw DeserializationInternalError(UString::Format(u"Wrong compound TLV type for occurence %d of parameter 0x%X", {i, tag}));
             }
             param.push_back(*msg);
         }
+        ++i;
     }
 }
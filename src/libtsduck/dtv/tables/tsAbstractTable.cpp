@@ -138,3 +138,26 @@ void ts::AbstractTable::deserialize(DuckContext& duck, const BinaryTable& table)
     // Add the standards of the deserialized table into the context.
     duck.addStandards(definingStandards());
 }
+
+
+//----------------------------------------------------------------------------
+// Add the sections of a serialized table into a binary table.
+//----------------------------------------------------------------------------
+
+void ts::AbstractTable::AddSections(BinaryTable& bin, SectionPtrVector& sections)
+{
+    // A table has at most 256 sections. The content of a larger table is truncated.
+    if (sections.size() > 256) {
+        sections.resize(256);
+    }
+    if (!sections.empty()) {
+        const uint8_t last = uint8_t(sections.size() - 1);
+        for (auto it = sections.begin(); it != sections.end(); ++it) {
+            if ((*it)->lastSectionNumber() != last) {
+                (*it)->setLastSectionNumber(last);
+            }
+        }
+        bin.addSections(sections);
+        sections.clear();
+    }
+}
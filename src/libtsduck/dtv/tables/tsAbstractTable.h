@@ -296,6 +296,19 @@ namespace ts {
         //!
         virtual void deserializeContent(DuckContext& duck, const BinaryTable& bin) = 0;
 
+        //!
+        //! Add the sections of a serialized table into a binary table.
+        //! This is a helper for serializeContent() in subclasses which build their sections
+        //! in sequence, all sections having the same last_section_number as their section_number.
+        //! The last_section_number of all sections is set once to its final value. This avoids
+        //! the update of all previous sections each time the binary table grows by one section.
+        //! @param [in,out] bin The binary table.
+        //! @param [in,out] sections The sections to add, in order of section number.
+        //! Sections after the 256th one are dropped, they cannot be numbered.
+        //! The vector is cleared on return.
+        //!
+        static void AddSections(BinaryTable& bin, SectionPtrVector& sections);
+
     private:
         // Unreachable constructors and operators.
         AbstractTable() = delete;
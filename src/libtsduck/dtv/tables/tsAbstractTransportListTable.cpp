@@ -35,8 +35,34 @@
 #include "tsAbstractTransportListTable.h"
 #include "tsBinaryTable.h"
 #include "tsTablesDisplay.h"
+#include "tsFieldLayout.h"
 TSDUCK_SOURCE;
 
+namespace {
+    // Binary layout of the top-level descriptor loop length (network or bouquet descriptors).
+    class TopLevelLoop: public ts::FieldLayout<2>
+    {
+    public:
+        typedef Bits<size_t, 4, 12> descriptors_length;
+    };
+
+    // Binary layout of the transport stream loop length.
+    class TransportLoop: public ts::FieldLayout<2>
+    {
+    public:
+        typedef Bits<size_t, 4, 12> transport_stream_loop_length;
+    };
+
+    // Binary layout of a transport stream entry.
+    class TransportLoopEntry: public ts::FieldLayout<6>
+    {
+    public:
+        typedef Bits<uint16_t,  0, 16> transport_stream_id;
+        typedef Bits<uint16_t, 16, 16> original_network_id;
+        typedef Bits<size_t,   36, 12> transport_descriptors_length;
+    };
+}
+
 
 //----------------------------------------------------------------------------
 // Constructors
@@ -124,41 +150,28 @@ void ts::AbstractTransportListTable::deserializeContent(DuckContext& duck, const
         _tid_ext = sect.tableIdExtension();
 
         // Analyze the section payload:
-        const uint8_t* data = sect.payload();
-        size_t remain = sect.payloadSize();
+        FieldReader reader(sect.payload(), sect.payloadSize());
 
         // Get top-level descriptor list
-        if (remain < 2) {
+        const uint8_t* const loop = reader.get<TopLevelLoop>();
+        if (loop == nullptr) {
             return;
         }
-        size_t info_length (GetUInt16 (data) & 0x0FFF);
-        data += 2;
-        remain -= 2;
-        info_length = std::min (info_length, remain);
-        descs.add (data, info_length);
-        data += info_length;
-        remain -= info_length;
+        reader.getDescriptors<TopLevelLoop::descriptors_length>(descs, loop);
 
         // Get transports description length
-        if (remain < 2) {
+        const uint8_t* const ts_loop = reader.get<TransportLoop>();
+        if (ts_loop == nullptr) {
             return;
         }
-        size_t ts_length (GetUInt16 (data) & 0x0FFF);
-        data += 2;
-        remain -= 2;
-        remain = std::min (ts_length, remain);
+        reader.limit(TransportLoop::transport_stream_loop_length::get(ts_loop));
 
         // Get transports description
-        while (remain >= 6) {
-            TransportStreamId id(GetUInt16 (data), GetUInt16 (data + 2)); // tsid, onid
-            info_length = GetUInt16(data + 4) & 0x0FFF;
-            data += 6;
-            remain -= 6;
-            info_length = std::min(info_length, remain);
-            transports[id].descs.add(data, info_length);
-            transports[id].preferred_section = int(si);
-            data += info_length;
-            remain -= info_length;
+        while (const uint8_t* entry = reader.get<TransportLoopEntry>()) {
+            const TransportStreamId id(TransportLoopEntry::transport_stream_id::get(entry), TransportLoopEntry::original_network_id::get(entry));
+            Transport& ts(transports[id]);
+            reader.getDescriptors<TransportLoopEntry::transport_descriptors_length>(ts.descs, entry);
+            ts.preferred_section = int(si);
         }
     }
 
@@ -168,29 +181,24 @@ void ts::AbstractTransportListTable::deserializeContent(DuckContext& duck, const
 
 //----------------------------------------------------------------------------
 // Private method: Add a new section to a table being serialized.
-// Section number is incremented. Data and remain are reinitialized.
+// The writer is rewound at the start of the payload.
 //----------------------------------------------------------------------------
 
-void ts::AbstractTransportListTable::addSection(BinaryTable& table,
-                                                int& section_number,
-                                                uint8_t* payload,
-                                                uint8_t*& data,
-                                                size_t& remain) const
+void ts::AbstractTransportListTable::addSection(SectionPtrVector& sections, const uint8_t* payload, FieldWriter& writer) const
 {
-    table.addSection(new Section(_table_id,
-                                 true,   // is_private_section
-                                 _tid_ext,
-                                 version,
-                                 is_current,
-                                 uint8_t(section_number),
-                                 uint8_t(section_number),   //last_section_number
-                                 payload,
-                                 data - payload)); // payload_size,
-
-    // Reinitialize pointers.
-    remain += data - payload;
-    data = payload;
-    section_number++;
+    // We always use last_section_number = section_number, it is adjusted in AddSections().
+    const uint8_t section_number = uint8_t(sections.size());
+    sections.push_back(new Section(_table_id,
+                                   true,   // is_private_section
+                                   _tid_ext,
+                                   version,
+                                   is_current,
+                                   section_number,
+                                   section_number,   //last_section_number
+                                   payload,
+                                   writer.size())); // payload_size,
+
+    writer.rewind(0);
 }
 
 
@@ -198,28 +206,22 @@ void ts::AbstractTransportListTable::addSection(BinaryTable& table,
 // Private method: Same as previous, while being inside the transport loop.
 //----------------------------------------------------------------------------
 
-void ts::AbstractTransportListTable::addSection(BinaryTable& table,
-                                                int& section_number,
-                                                uint8_t* payload,
-                                                uint8_t*& tsll_addr,
-                                                uint8_t*& data,
-                                                size_t& remain) const
+void ts::AbstractTransportListTable::addSection(SectionPtrVector& sections, const uint8_t* payload, FieldWriter& writer, uint8_t*& ts_loop) const
 {
     // Update transport_stream_loop_length in current section
-    PutUInt16(tsll_addr, 0xF000 | uint16_t(data - tsll_addr - 2));
+    TransportLoop::transport_stream_loop_length::put(ts_loop, size_t(writer.current() - ts_loop) - TransportLoop::BYTE_SIZE);
 
     // Add current section, open a new one
-    addSection(table, section_number, payload, data, remain);
+    addSection(sections, payload, writer);
 
     // Insert a zero-length global descriptor loop
-    assert(remain >= 4);
-    PutUInt16(data, 0xF000);
+    uint8_t* const loop = writer.put<TopLevelLoop>();
+    assert(loop != nullptr);
+    TopLevelLoop::descriptors_length::put(loop, 0);
 
     // Reserve transport_stream_loop_length.
-    tsll_addr = data + 2;
-    PutUInt16(data + 2, 0xF000);
-    data += 4;
-    remain -= 4;
+    ts_loop = writer.put<TransportLoop>();
+    assert(ts_loop != nullptr);
 }
 
 
@@ -272,9 +274,8 @@ void ts::AbstractTransportListTable::serializeContent(DuckContext& duck, BinaryT
 
     // Build the sections
     uint8_t payload[MAX_PSI_LONG_SECTION_PAYLOAD_SIZE];
-    int section_number = 0;
-    uint8_t* data = payload;
-    size_t remain = sizeof(payload);
+    FieldWriter writer(payload, sizeof(payload));
+    SectionPtrVector sections;
 
     // Add top-level descriptor list.
     // If the descriptor list is too long to fit into one section,
@@ -282,11 +283,12 @@ void ts::AbstractTransportListTable::serializeContent(DuckContext& duck, BinaryT
     for (size_t start_index = 0; ; ) {
 
         // Add the descriptor list (or part of it).
-        // Reserve 2 extra bytes at end, for the rest of the section
-        assert(remain > 2);
-        remain -= 2;
-        start_index = descs.lengthSerialize(data, remain, start_index);
-        remain += 2;
+        // Reserve space at end for the transport_stream_loop_length.
+        uint8_t* const loop = writer.put<TopLevelLoop>();
+        assert(loop != nullptr);
+        writer.reserve(TransportLoop::BYTE_SIZE);
+        start_index = writer.putDescriptors<TopLevelLoop::descriptors_length>(descs, loop, start_index);
+        writer.release();
 
         // If all descriptors were serialized, exit loop
         if (start_index == descs.count()) {
@@ -296,34 +298,30 @@ void ts::AbstractTransportListTable::serializeContent(DuckContext& duck, BinaryT
 
         // Need to close the section and open a new one.
         // Add a zero transport_stream_loop_length.
-        assert(remain >= 2);
-        PutUInt16(data, 0xF000);
-        data += 2;
-        remain -= 2;
-        addSection(table, section_number, payload, data, remain);
+        uint8_t* const ts_loop = writer.put<TransportLoop>();
+        assert(ts_loop != nullptr);
+        TransportLoop::transport_stream_loop_length::put(ts_loop, 0);
+        addSection(sections, payload, writer);
     }
 
     // Reserve transport_stream_loop_length.
-    assert (remain >= 2);
-    uint8_t* tsll_addr = data;
-    PutUInt16 (data, 0xF000);
-    data += 2;
-    remain -= 2;
+    uint8_t* ts_loop = writer.put<TransportLoop>();
+    assert(ts_loop != nullptr);
 
     // Add all transports
     while (!ts_set.empty()) {
 
         // If we cannot at least add the fixed part of a transport, open a new section
-        if (remain < 6) {
-            addSection (table, section_number, payload, tsll_addr, data, remain);
-            assert (remain >= 6);
+        if (writer.remain() < TransportLoopEntry::BYTE_SIZE) {
+            addSection(sections, payload, writer, ts_loop);
+            assert(writer.remain() >= TransportLoopEntry::BYTE_SIZE);
         }
 
         // Get a TS to serialize in current section
         TransportStreamId ts_id;
-        while (!getNextTransport (ts_set, ts_id, section_number)) {
+        while (!getNextTransport(ts_set, ts_id, int(sections.size()))) {
             // No transport found for this section, close it and starts a new one.
-            addSection (table, section_number, payload, tsll_addr, data, remain);
+            addSection(sections, payload, writer, ts_loop);
         }
 
         // Locate transport description
@@ -336,11 +334,11 @@ void ts::AbstractTransportListTable::serializeContent(DuckContext& duck, BinaryT
         // start a new section. Huge transport descriptions may not fit into
         // one section, even when starting at the beginning of the transport loop.
         // In that case, the transport description will span two sections later.
-        if (data > tsll_addr + 2 && 6 + dlist.binarySize() > remain) {
+        if (writer.current() > ts_loop + TransportLoop::BYTE_SIZE && !writer.fits<TransportLoopEntry>(dlist)) {
             // Push back the transport in the set
-            ts_set.insert (ts_id);
+            ts_set.insert(ts_id);
             // Create a new section
-            addSection (table, section_number, payload, tsll_addr, data, remain);
+            addSection(sections, payload, writer, ts_loop);
             // Loop back since the section number has changed and a new transport may be better
             continue;
         }
@@ -352,14 +350,13 @@ void ts::AbstractTransportListTable::serializeContent(DuckContext& duck, BinaryT
         size_t start_index = 0;
         for (;;) {
             // Insert common characteristics of the transport
-            assert (remain >= 6);
-            PutUInt16 (data, ts_id.transport_stream_id);
-            PutUInt16 (data + 2, ts_id.original_network_id);
-            data += 4;
-            remain -= 4;
+            uint8_t* const entry = writer.put<TransportLoopEntry>();
+            assert(entry != nullptr);
+            TransportLoopEntry::transport_stream_id::put(entry, ts_id.transport_stream_id);
+            TransportLoopEntry::original_network_id::put(entry, ts_id.original_network_id);
 
             // Insert descriptors (all or some).
-            start_index = dlist.lengthSerialize(data, remain, start_index);
+            start_index = writer.putDescriptors<TransportLoopEntry::transport_descriptors_length>(dlist, entry, start_index);
 
             // Exit loop when all descriptors were serialized.
             if (start_index >= dlist.count()) {
@@ -368,10 +365,11 @@ void ts::AbstractTransportListTable::serializeContent(DuckContext& duck, BinaryT
 
             // Not all descriptors were written, the section is full.
             // Open a new one and continue with this transport.
-            addSection(table, section_number, payload, tsll_addr, data, remain);
+            addSection(sections, payload, writer, ts_loop);
         }
     }
 
     // Add partial section.
-    addSection(table, section_number, payload, tsll_addr, data, remain);
+    addSection(sections, payload, writer, ts_loop);
+    AddSections(table, sections);
 }
@@ -39,6 +39,9 @@
 #include "tsDescriptorList.h"
 
 namespace ts {
+
+    class FieldWriter;
+
     //!
     //! Abstract base class for tables containing a list of transport stream descriptions.
     //! Common code for BAT and NIT.
@@ -138,20 +141,12 @@ namespace ts {
         typedef std::set<TransportStreamId> TransportStreamIdSet;
 
         // Add a new section to a table being serialized.
-        // Session number is incremented. Data and remain are reinitialized.
-        void addSection(BinaryTable& table,
-                        int& section_number,
-                        uint8_t* payload,
-                        uint8_t*& data,
-                        size_t& remain) const;
+        // The writer is rewound at the start of the payload.
+        void addSection(SectionPtrVector& sections, const uint8_t* payload, FieldWriter& writer) const;
 
         // Same as previous, while being inside the transport loop.
-        void addSection(BinaryTable& table,
-                        int& section_number,
-                        uint8_t* payload,
-                        uint8_t*& tsll_addr,
-                        uint8_t*& data,
-                        size_t& remain) const;
+        // The transport_stream_loop_length is updated and a new one is reserved.
+        void addSection(SectionPtrVector& sections, const uint8_t* payload, FieldWriter& writer, uint8_t*& ts_loop) const;
 
         // Select a transport stream for serialization in current section.
         // If found, set ts_id, remove the ts id from the set and return true.
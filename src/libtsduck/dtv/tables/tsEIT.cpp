@@ -40,6 +40,7 @@
 #include "tsTablesDisplay.h"
 #include "tsTablesFactory.h"
 #include "tsxmlElement.h"
+#include "tsFieldLayout.h"
 TSDUCK_SOURCE;
 
 #define MY_XML_NAME u"EIT"
@@ -49,6 +50,30 @@ TS_XML_TABLE_FACTORY(ts::EIT, MY_XML_NAME);
 TS_ID_TABLE_RANGE_FACTORY(ts::EIT, ts::TID_EIT_MIN, ts::TID_EIT_MAX, MY_STD);
 TS_FACTORY_REGISTER(ts::EIT::DisplaySection, ts::TID_EIT_MIN, ts::TID_EIT_MAX, ts::CASID_NULL, ts::CASID_NULL);
 
+namespace {
+    // Binary layout of the fixed part of an EIT section payload.
+    class EITHeader: public ts::FieldLayout<6>
+    {
+    public:
+        typedef Bits<uint16_t,  0, 16> transport_stream_id;
+        typedef Bits<uint16_t, 16, 16> original_network_id;
+        typedef Bits<uint8_t,  32,  8> segment_last_section_number;
+        typedef Bits<uint8_t,  40,  8> last_table_id;
+    };
+
+    // Binary layout of an event entry in an EIT.
+    class EITEventEntry: public ts::FieldLayout<12>
+    {
+    public:
+        typedef Bits<uint16_t,  0, 16> event_id;
+        typedef Bytes<2, 5>            start_time;  // MJD date and BCD time
+        typedef Bytes<7, 3>            duration;    // BCD hours, minutes, seconds
+        typedef Bits<uint8_t,  80,  3> running_status;
+        typedef Bits<bool,     83,  1> free_CA_mode;
+        typedef Bits<size_t,   84, 12> descriptors_loop_length;
+    };
+}
+
 
 //----------------------------------------------------------------------------
 // Constructors
@@ -191,39 +216,29 @@ void ts::EIT::deserializeContent(DuckContext& duck, const BinaryTable& table)
         service_id = sect.tableIdExtension();
 
         // Analyze the section payload:
-        const uint8_t* data = sect.payload();
-        size_t remain = sect.payloadSize();
+        FieldReader reader(sect.payload(), sect.payloadSize());
 
-        if (remain < EIT_PAYLOAD_FIXED_SIZE) {
+        const uint8_t* const header = reader.get<EITHeader>();
+        if (header == nullptr) {
             return;
         }
-
-        ts_id = GetUInt16(data);
-        onetw_id = GetUInt16(data + 2);
-        last_table_id = data[5];
-        data += EIT_PAYLOAD_FIXED_SIZE;
-        remain -= EIT_PAYLOAD_FIXED_SIZE;
+        ts_id = EITHeader::transport_stream_id::get(header);
+        onetw_id = EITHeader::original_network_id::get(header);
+        last_table_id = EITHeader::last_table_id::get(header);
 
         // Get events description
-        while (remain >= EIT_EVENT_FIXED_SIZE) {
+        while (const uint8_t* entry = reader.get<EITEventEntry>()) {
             Event& event(events.newEntry());
-            event.event_id = GetUInt16(data);
-            DecodeMJD(data + 2, 5, event.start_time);
-            const int hour = DecodeBCD(data[7]);
-            const int min = DecodeBCD(data[8]);
-            const int sec = DecodeBCD(data[9]);
+            event.event_id = EITEventEntry::event_id::get(entry);
+            DecodeMJD(EITEventEntry::start_time::at(entry), EITEventEntry::start_time::SIZE, event.start_time);
+            const uint8_t* const duration = EITEventEntry::duration::at(entry);
+            const int hour = DecodeBCD(duration[0]);
+            const int min = DecodeBCD(duration[1]);
+            const int sec = DecodeBCD(duration[2]);
             event.duration = (hour * 3600) + (min * 60) + sec;
-            event.running_status = (data[10] >> 5) & 0x07;
-            event.CA_controlled = (data[10] >> 4) & 0x01;
-
-            size_t info_length = GetUInt16(data + 10) & 0x0FFF;
-            data += EIT_EVENT_FIXED_SIZE;
-            remain -= EIT_EVENT_FIXED_SIZE;
-
-            info_length = std::min(info_length, remain);
-            event.descs.add(data, info_length);
-            data += info_length;
-            remain -= info_length;
+            event.running_status = EITEventEntry::running_status::get(entry);
+            event.CA_controlled = EITEventEntry::free_CA_mode::get(entry);
+            reader.getDescriptors<EITEventEntry::descriptors_loop_length>(event.descs, entry);
         }
     }
 
@@ -260,35 +275,33 @@ void ts::EIT::serializeContent(DuckContext& duck, BinaryTable& table) const
 
     // Build the sections
     uint8_t payload[MAX_PSI_LONG_SECTION_PAYLOAD_SIZE];
-    int section_number = 0;
-    uint8_t* data = payload;
-    size_t remain = sizeof(payload);
+    FieldWriter writer(payload, sizeof(payload));
+    SectionPtrVector sections;
 
     // The first 6 bytes are identical in all sections. Build them once.
-    PutUInt16(data, ts_id);
-    PutUInt16(data + 2, onetw_id);
-    data[4] = 0; // segment_last_section_number, will be fixed later.
-    data[5] = last_table_id;
-    data += EIT_PAYLOAD_FIXED_SIZE;
-    remain -= EIT_PAYLOAD_FIXED_SIZE;
+    uint8_t* const header = writer.put<EITHeader>();
+    EITHeader::transport_stream_id::put(header, ts_id);
+    EITHeader::original_network_id::put(header, onetw_id);
+    EITHeader::segment_last_section_number::put(header, 0); // will be fixed later.
+    EITHeader::last_table_id::put(header, last_table_id);
 
     // Add all events in time order.
     for (auto evit = ordered_events.begin(); evit != ordered_events.end(); ++evit) {
         const Event* const ev = *evit;
 
         // Compute target section number for this event.
-        int target_section = section_number;
+        size_t target_section = sections.size();
 
         // With EIT schedule, the events are grouped in 32 segments of 8 sections, covering 3 hours each.
         if (_table_id >= TID_EIT_S_ACT_MIN && _table_id <= TID_EIT_S_OTH_MAX) {
             assert(ev->start_time >= base_time);
-            target_section = 8 * std::min<int>(31, int((ev->start_time - base_time) / SEGMENT_DURATION));
+            target_section = 8 * std::min<size_t>(31, size_t((ev->start_time - base_time) / SEGMENT_DURATION));
         }
 
         // If we cannot at least add the fixed part, open a new section.
         // Also add empty sections up to the target section.
-        while (remain < EIT_EVENT_FIXED_SIZE || section_number < target_section) {
-            addSection(table, section_number, payload, data, remain);
+        while (writer.remain() < EITEventEntry::BYTE_SIZE || sections.size() < target_section) {
+            addSection(sections, payload, writer);
         }
 
         // Insert the characteristics of the event. When the section is
@@ -304,46 +317,45 @@ void ts::EIT::serializeContent(DuckContext& duck, BinaryTable& table) const
             // entire event description fits in the section. If it does not fit, start
             // a new section. Note that huge event descriptions may not fit into one
             // section. In that case, the event description will span two sections later.
-            if (starting && EIT_EVENT_FIXED_SIZE + ev->descs.binarySize() > remain) {
-                addSection(table, section_number, payload, data, remain);
+            if (starting && !writer.fits<EITEventEntry>(ev->descs)) {
+                addSection(sections, payload, writer);
             }
 
             starting = false;
 
-            // Insert common characteristics of the service
-            assert(remain >= 12);
-            PutUInt16(data, ev->event_id);
-            EncodeMJD(ev->start_time, data + 2, 5);
-            data[7] = EncodeBCD(int(ev->duration / 3600));
-            data[8] = EncodeBCD(int((ev->duration / 60) % 60));
-            data[9] = EncodeBCD(int(ev->duration % 60));
-            data += 10;
-            remain -= 10;
+            // Insert common characteristics of the event
+            uint8_t* const entry = writer.put<EITEventEntry>();
+            assert(entry != nullptr);
+            EITEventEntry::event_id::put(entry, ev->event_id);
+            EncodeMJD(ev->start_time, EITEventEntry::start_time::at(entry), EITEventEntry::start_time::SIZE);
+            uint8_t* const duration = EITEventEntry::duration::at(entry);
+            duration[0] = EncodeBCD(int(ev->duration / 3600));
+            duration[1] = EncodeBCD(int((ev->duration / 60) % 60));
+            duration[2] = EncodeBCD(int(ev->duration % 60));
+            EITEventEntry::running_status::put(entry, ev->running_status);
+            EITEventEntry::free_CA_mode::put(entry, ev->CA_controlled);
 
             // Insert descriptors (all or some).
-            uint8_t* flags = data;
-            start_index = ev->descs.lengthSerialize(data, remain, start_index);
-
-            // The following fields are inserted in the 4 "reserved" bits of the descriptor_loop_length.
-            flags[0] = (flags[0] & 0x0F) | uint8_t(ev->running_status << 5) | (ev->CA_controlled ? 0x10 : 0x00);
+            start_index = writer.putDescriptors<EITEventEntry::descriptors_loop_length>(ev->descs, entry, start_index);
 
             // If not all descriptors were written, the section is full.
             // Open a new one and continue with this event.
             if (start_index < ev->descs.count()) {
-                addSection(table, section_number, payload, data, remain);
+                addSection(sections, payload, writer);
             }
         }
 
         // With EIT p/f, close the section after each event (one event per section).
         if (_table_id == TID_EIT_PF_ACT || _table_id == TID_EIT_PF_OTH) {
-            addSection(table, section_number, payload, data, remain);
+            addSection(sections, payload, writer);
         }
     }
 
     // Add partial section (if there is one)
-    if (data > payload + EIT_PAYLOAD_FIXED_SIZE || table.sectionCount() == 0) {
-        addSection(table, section_number, payload, data, remain);
+    if (writer.size() > EITHeader::BYTE_SIZE || sections.empty()) {
+        addSection(sections, payload, writer);
     }
+    AddSections(table, sections);
 
     // Finally, fix the segmentation values in the serialized binary table.
     Fix(table, FIX_EXISTING);
@@ -352,26 +364,25 @@ void ts::EIT::serializeContent(DuckContext& duck, BinaryTable& table) const
 
 //----------------------------------------------------------------------------
 // Private method: Add a new section to a table being serialized.
-// Session number is incremented. Data and remain are reinitialized.
+// The writer is rewound after the constant part of the payload.
 //----------------------------------------------------------------------------
 
-void ts::EIT::addSection(BinaryTable& table, int& section_number, uint8_t* payload, uint8_t*& data, size_t& remain) const
+void ts::EIT::addSection(SectionPtrVector& sections, const uint8_t* payload, FieldWriter& writer) const
 {
-    table.addSection(new Section(_table_id,
-                                 true,         // is_private_section
-                                 service_id,   // tid_ext
-                                 version,
-                                 is_current,
-                                 uint8_t(section_number),
-                                 uint8_t(section_number), //last_section_number
-                                 payload,
-                                 data - payload)); // payload_size,
-
-    // Reinitialize pointers.
+    // We always use last_section_number = section_number, it is adjusted in AddSections().
+    const uint8_t section_number = uint8_t(sections.size());
+    sections.push_back(new Section(_table_id,
+                                   true,         // is_private_section
+                                   service_id,   // tid_ext
+                                   version,
+                                   is_current,
+                                   section_number,
+                                   section_number, //last_section_number
+                                   payload,
+                                   writer.size())); // payload_size,
+
     // Restart after constant part of payload (6 bytes).
-    remain += data - payload - 6;
-    data = payload + 6;
-    section_number++;
+    writer.rewind(EITHeader::BYTE_SIZE);
 }
 
 
@@ -38,6 +38,9 @@
 #include "tsTime.h"
 
 namespace ts {
+
+    class FieldWriter;
+
     //!
     //! Representation of an Event Information Table (EIT).
     //! @ingroup table
@@ -207,9 +210,9 @@ namespace ts {
         constexpr static size_t EIT_PAYLOAD_FIXED_SIZE = 6;   // Payload size before event loop.
         constexpr static size_t EIT_EVENT_FIXED_SIZE   = 12;  // Event size before descriptor loop.
 
-        // Add a new section to a table being serialized
-        // Section number is incremented. Data and remain are reinitialized.
-        void addSection(BinaryTable& table, int& section_number, uint8_t* payload, uint8_t*& data, size_t& remain) const;
+        // Add a new section to a table being serialized.
+        // The writer is rewound after the constant part of the payload.
+        void addSection(SectionPtrVector& sections, const uint8_t* payload, FieldWriter& writer) const;
 
         // Get the table id from XML element.
         bool getTableId(const xml::Element*);
@@ -55,9 +55,12 @@ ts::NIT::NIT(bool is_actual, uint8_t vers, bool cur, uint16_t id) :
 }
 
 ts::NIT::NIT(DuckContext& duck, const BinaryTable& table) :
-    AbstractTransportListTable(duck, TID_NIT_ACT, MY_XML_NAME, MY_STD, table),  // TID updated by deserialize()
+    AbstractTransportListTable(TID_NIT_ACT, MY_XML_NAME, MY_STD, 0xFFFF, 0, true),  // TID updated by deserialize()
     network_id(_tid_ext)
 {
+    // Deserialize here, not in the base class constructor, where the
+    // overridden isValidTableId() is not yet available for NIT Other.
+    deserialize(duck, table);
 }
 
 ts::NIT::NIT(const NIT& other) :
@@ -36,6 +36,7 @@
 #include "tsTablesDisplay.h"
 #include "tsTablesFactory.h"
 #include "tsxmlElement.h"
+#include "tsFieldLayout.h"
 TSDUCK_SOURCE;
 
 #define MY_XML_NAME u"PAT"
@@ -46,6 +47,16 @@ TS_XML_TABLE_FACTORY(ts::PAT, MY_XML_NAME);
 TS_ID_TABLE_FACTORY(ts::PAT, MY_TID, MY_STD);
 TS_FACTORY_REGISTER(ts::PAT::DisplaySection, MY_TID);
 
+namespace {
+    // Binary layout of an entry in the PAT.
+    class PATEntry: public ts::FieldLayout<4>
+    {
+    public:
+        typedef Bits<uint16_t, 0, 16> program_number;
+        typedef Bits<ts::PID, 19, 13> pid;
+    };
+}
+
 
 //----------------------------------------------------------------------------
 // Constructors
@@ -90,15 +101,10 @@ void ts::PAT::deserializeContent(DuckContext& duck, const BinaryTable& table)
 
         // Analyze the section payload:
         // This is a list of service_id/pmt_pid pairs
-        const uint8_t* data (sect.payload());
-        size_t remain (sect.payloadSize());
-
-        while (remain >= 4) {
-            // Extract one id/pid entry
-            uint16_t id (GetUInt16 (data));
-            uint16_t pid (GetUInt16 (data + 2) & 0x1FFF);
-            data += 4;
-            remain -= 4;
+        FieldReader reader(sect.payload(), sect.payloadSize());
+        while (const uint8_t* entry = reader.get<PATEntry>()) {
+            const uint16_t id = PATEntry::program_number::get(entry);
+            const PID pid = PATEntry::pid::get(entry);
 
             // Register the PID
             if (id == 0) {
@@ -122,59 +128,57 @@ void ts::PAT::serializeContent(DuckContext& duck, BinaryTable& table) const
 {
     // Build the sections
     uint8_t payload[MAX_PSI_LONG_SECTION_PAYLOAD_SIZE];
-    int section_number = 0;
-    uint8_t* data = payload;
-    size_t remain = sizeof(payload);
+    FieldWriter writer(payload, sizeof(payload));
+    SectionPtrVector sections;
 
     // Add the NIT PID in the first section
     if (nit_pid != PID_NULL) {
-        PutUInt16 (data, 0); // pseudo service_id
-        PutUInt16 (data + 2, nit_pid | 0xE000);
-        data += 4;
-        remain -= 4;
+        uint8_t* const entry = writer.put<PATEntry>();
+        PATEntry::program_number::put(entry, 0); // pseudo service_id
+        PATEntry::pid::put(entry, nit_pid);
     }
 
     // Add all services
     for (ServiceMap::const_iterator it = pmts.begin(); it != pmts.end(); ++it) {
 
         // If current section payload is full, close the current section.
-        // We always use last_section_number = section_number but the
-        // table is allowed to grow (see BinaryTable::AddSection).
-        if (remain < 4) {
-            table.addSection (new Section (_table_id,
-                                           false,   // is_private_section
-                                           ts_id,   // tid_ext
-                                           version,
-                                           is_current,
-                                           uint8_t(section_number),
-                                           uint8_t(section_number), //last_section_number
-                                           payload,
-                                           data - payload)); // payload_size,
-            section_number++;
-            data = payload;
-            remain = sizeof(payload);
+        uint8_t* entry = writer.put<PATEntry>();
+        if (entry == nullptr) {
+            addSection(sections, payload, writer.size());
+            writer.rewind(0);
+            entry = writer.put<PATEntry>();
         }
 
         // Add current service entry into the PAT section
-        PutUInt16 (data, it->first);               // service_id
-        PutUInt16 (data + 2, it->second | 0xE000); // pmt pid
-        data += 4;
-        remain -= 4;
+        PATEntry::program_number::put(entry, it->first);
+        PATEntry::pid::put(entry, it->second);
     }
 
     // Add partial section (if there is one)
-
-    if (data > payload || table.sectionCount() == 0) {
-        table.addSection (new Section (_table_id,
-                                       false,   // is_private_section
-                                       ts_id,   // tid_ext
-                                       version,
-                                       is_current,
-                                       uint8_t(section_number),
-                                       uint8_t(section_number), //last_section_number
-                                       payload,
-                                       data - payload)); // payload_size,
+    if (writer.size() > 0 || sections.empty()) {
+        addSection(sections, payload, writer.size());
     }
+    AddSections(table, sections);
+}
+
+
+//----------------------------------------------------------------------------
+// Private method: Add a new section to a table being serialized.
+//----------------------------------------------------------------------------
+
+void ts::PAT::addSection(SectionPtrVector& sections, const uint8_t* payload, size_t payload_size) const
+{
+    // We always use last_section_number = section_number, it is adjusted in AddSections().
+    const uint8_t section_number = uint8_t(sections.size());
+    sections.push_back(new Section(_table_id,
+                                   false,   // is_private_section
+                                   ts_id,   // tid_ext
+                                   version,
+                                   is_current,
+                                   section_number,
+                                   section_number, //last_section_number
+                                   payload,
+                                   payload_size));
 }
 
 
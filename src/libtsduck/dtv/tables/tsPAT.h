@@ -82,5 +82,9 @@ namespace ts {
         virtual void serializeContent(DuckContext&, BinaryTable&) const override;
         virtual void deserializeContent(DuckContext&, const BinaryTable&) override;
         virtual void buildXML(DuckContext&, xml::Element*) const override;
+
+    private:
+        // Add a new section to a table being serialized.
+        void addSection(SectionPtrVector& sections, const uint8_t* payload, size_t payload_size) const;
     };
 }
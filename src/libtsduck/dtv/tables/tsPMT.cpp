@@ -37,6 +37,7 @@
 #include "tsTablesDisplay.h"
 #include "tsTablesFactory.h"
 #include "tsxmlElement.h"
+#include "tsFieldLayout.h"
 TSDUCK_SOURCE;
 
 #define MY_XML_NAME u"PMT"
@@ -47,6 +48,25 @@ TS_XML_TABLE_FACTORY(ts::PMT, MY_XML_NAME);
 TS_ID_TABLE_FACTORY(ts::PMT, MY_TID, MY_STD);
 TS_FACTORY_REGISTER(ts::PMT::DisplaySection, MY_TID);
 
+namespace {
+    // Binary layout of the fixed part of a PMT section payload.
+    class PMTHeader: public ts::FieldLayout<4>
+    {
+    public:
+        typedef Bits<ts::PID,  3, 13> PCR_PID;
+        typedef Bits<size_t,  20, 12> program_info_length;
+    };
+
+    // Binary layout of an elementary stream entry in a PMT.
+    class PMTStreamEntry: public ts::FieldLayout<5>
+    {
+    public:
+        typedef Bits<uint8_t,  0,  8> stream_type;
+        typedef Bits<ts::PID, 11, 13> elementary_PID;
+        typedef Bits<size_t,  28, 12> ES_info_length;
+    };
+}
+
 
 //----------------------------------------------------------------------------
 // Constructors
@@ -103,41 +123,21 @@ void ts::PMT::deserializeContent(DuckContext& duck, const BinaryTable& table)
         service_id = sect.tableIdExtension();
 
         // Analyze the section payload:
-        const uint8_t* data(sect.payload());
-        size_t remain(sect.payloadSize());
-
-        // Get PCR PID
-        if (remain < 2) {
-            return;
-        }
-        pcr_pid = GetUInt16(data) & 0x1FFF;
-        data += 2;
-        remain -= 2;
+        FieldReader reader(sect.payload(), sect.payloadSize());
 
-        // Get program information descriptor list
-        if (remain < 2) {
+        // Get PCR PID and program information descriptor list
+        const uint8_t* const header = reader.get<PMTHeader>();
+        if (header == nullptr) {
             return;
         }
-        size_t info_length(GetUInt16(data) & 0x0FFF);
-        data += 2;
-        remain -= 2;
-        info_length = std::min(info_length, remain);
-        descs.add(data, info_length);
-        data += info_length;
-        remain -= info_length;
+        pcr_pid = PMTHeader::PCR_PID::get(header);
+        reader.getDescriptors<PMTHeader::program_info_length>(descs, header);
 
         // Get elementary streams description
-        while (remain >= 5) {
-            PID pid = GetUInt16(data + 1) & 0x1FFF;
-            Stream& str(streams[pid]);
-            str.stream_type = data[0];
-            info_length = GetUInt16(data + 3) & 0x0FFF;
-            data += 5;
-            remain -= 5;
-            info_length = std::min(info_length, remain);
-            str.descs.add(data, info_length);
-            data += info_length;
-            remain -= info_length;
+        while (const uint8_t* entry = reader.get<PMTStreamEntry>()) {
+            Stream& str(streams[PMTStreamEntry::elementary_PID::get(entry)]);
+            str.stream_type = PMTStreamEntry::stream_type::get(entry);
+            reader.getDescriptors<PMTStreamEntry::ES_info_length>(str.descs, entry);
         }
     }
 
@@ -154,28 +154,26 @@ void ts::PMT::serializeContent(DuckContext& duck, BinaryTable& table) const
     // Build the section. Note that a PMT is not allowed to use more than
     // one section, see ISO/IEC 13818-1:2000 2.4.4.8 & 2.4.4.9
     uint8_t payload [MAX_PSI_LONG_SECTION_PAYLOAD_SIZE];
-    uint8_t* data = payload;
-    size_t remain = sizeof(payload);
-
-    // Add PCR PID
-    PutUInt16(data, pcr_pid | 0xE000);
-    data += 2;
-    remain -= 2;
+    FieldWriter writer(payload, sizeof(payload));
 
-    // Insert program_info descriptor list (with leading length field)
-    descs.lengthSerialize(data, remain);
+    // Add PCR PID and program_info descriptor list
+    uint8_t* const header = writer.put<PMTHeader>();
+    PMTHeader::PCR_PID::put(header, pcr_pid);
+    writer.putDescriptors<PMTHeader::program_info_length>(descs, header);
 
     // Add description of all elementary streams
-    for (StreamMap::const_iterator it = streams.begin(); it != streams.end() && remain >= 5; ++it) {
+    for (StreamMap::const_iterator it = streams.begin(); it != streams.end(); ++it) {
 
         // Insert stream type and pid
-        data[0] = it->second.stream_type;
-        PutUInt16(data + 1, it->first | 0xE000); // PID
-        data += 3;
-        remain -= 3;
+        uint8_t* const entry = writer.put<PMTStreamEntry>();
+        if (entry == nullptr) {
+            break;
+        }
+        PMTStreamEntry::stream_type::put(entry, it->second.stream_type);
+        PMTStreamEntry::elementary_PID::put(entry, it->first);
 
         // Insert descriptor list for elem. stream (with leading length field)
-        size_t next_index = it->second.descs.lengthSerialize(data, remain);
+        const size_t next_index = writer.putDescriptors<PMTStreamEntry::ES_info_length>(it->second.descs, entry);
         if (next_index != it->second.descs.count()) {
             // Not enough space to serialize all descriptors in the section.
             // A PMT cannot have more than one section.
@@ -193,7 +191,7 @@ void ts::PMT::serializeContent(DuckContext& duck, BinaryTable& table) const
                                  0,                // section_number,
                                  0,                // last_section_number
                                  payload,
-                                 data - payload)); // payload_size,
+                                 writer.size()));  // payload_size,
 }
 
 
@@ -38,6 +38,7 @@
 #include "tsTablesDisplay.h"
 #include "tsTablesFactory.h"
 #include "tsxmlElement.h"
+#include "tsFieldLayout.h"
 TSDUCK_SOURCE;
 
 #define MY_XML_NAME u"SDT"
@@ -49,6 +50,27 @@ TS_ID_TABLE_FACTORY(ts::SDT, ts::TID_SDT_OTH, MY_STD);
 TS_FACTORY_REGISTER(ts::SDT::DisplaySection, ts::TID_SDT_ACT);
 TS_FACTORY_REGISTER(ts::SDT::DisplaySection, ts::TID_SDT_OTH);
 
+namespace {
+    // Binary layout of the fixed part of an SDT section payload.
+    class SDTHeader: public ts::FieldLayout<3>
+    {
+    public:
+        typedef Bits<uint16_t, 0, 16> original_network_id;
+    };
+
+    // Binary layout of a service entry in an SDT.
+    class SDTServiceEntry: public ts::FieldLayout<5>
+    {
+    public:
+        typedef Bits<uint16_t,  0, 16> service_id;
+        typedef Bits<bool,     22,  1> EIT_schedule_flag;
+        typedef Bits<bool,     23,  1> EIT_present_following_flag;
+        typedef Bits<uint8_t,  24,  3> running_status;
+        typedef Bits<bool,     27,  1> free_CA_mode;
+        typedef Bits<size_t,   28, 12> descriptors_loop_length;
+    };
+}
+
 
 //----------------------------------------------------------------------------
 // Constructors
@@ -148,33 +170,24 @@ void ts::SDT::deserializeContent(DuckContext& duck, const BinaryTable& table)
         ts_id = sect.tableIdExtension();
 
         // Analyze the section payload:
-        const uint8_t* data (sect.payload());
-        size_t remain (sect.payloadSize());
+        FieldReader reader(sect.payload(), sect.payloadSize());
 
         // Get original_network_id (should be identical on all sections).
         // Note that there is one trailing reserved byte.
-        if (remain < 3) {
+        const uint8_t* const header = reader.get<SDTHeader>();
+        if (header == nullptr) {
             return;
         }
-        onetw_id = GetUInt16(data);
-        data += 3;
-        remain -= 3;
+        onetw_id = SDTHeader::original_network_id::get(header);
 
         // Get services description
-        while (remain >= 5) {
-            uint16_t service_id = GetUInt16(data);
-            Service& serv(services[service_id]);
-            serv.EITs_present = (data[2] & 0x02) != 0;
-            serv.EITpf_present = (data[2] & 0x01) != 0;
-            serv.running_status = data[3] >> 5;
-            serv.CA_controlled = (data[3] & 0x10) != 0;
-            size_t info_length = GetUInt16(data + 3) & 0x0FFF;
-            data += 5;
-            remain -= 5;
-            info_length = std::min(info_length, remain);
-            serv.descs.add(data, info_length);
-            data += info_length;
-            remain -= info_length;
+        while (const uint8_t* entry = reader.get<SDTServiceEntry>()) {
+            Service& serv(services[SDTServiceEntry::service_id::get(entry)]);
+            serv.EITs_present = SDTServiceEntry::EIT_schedule_flag::get(entry);
+            serv.EITpf_present = SDTServiceEntry::EIT_present_following_flag::get(entry);
+            serv.running_status = SDTServiceEntry::running_status::get(entry);
+            serv.CA_controlled = SDTServiceEntry::free_CA_mode::get(entry);
+            reader.getDescriptors<SDTServiceEntry::descriptors_loop_length>(serv.descs, entry);
         }
     }
 
@@ -184,30 +197,25 @@ void ts::SDT::deserializeContent(DuckContext& duck, const BinaryTable& table)
 
 //----------------------------------------------------------------------------
 // Private method: Add a new section to a table being serialized.
-// Section number is incremented. Data and remain are reinitialized.
+// The writer is rewound after the constant part of the payload.
 //----------------------------------------------------------------------------
 
-void ts::SDT::addSection(BinaryTable& table,
-                         int& section_number,
-                         uint8_t* payload,
-                         uint8_t*& data,
-                         size_t& remain) const
+void ts::SDT::addSection(SectionPtrVector& sections, const uint8_t* payload, FieldWriter& writer) const
 {
-    table.addSection(new Section(_table_id,
-                                 true,    // is_private_section
-                                 ts_id,   // tid_ext
-                                 version,
-                                 is_current,
-                                 uint8_t(section_number),
-                                 uint8_t(section_number),   //last_section_number
-                                 payload,
-                                 data - payload)); // payload_size,
-
-    // Reinitialize pointers.
+    // We always use last_section_number = section_number, it is adjusted in AddSections().
+    const uint8_t section_number = uint8_t(sections.size());
+    sections.push_back(new Section(_table_id,
+                                   true,    // is_private_section
+                                   ts_id,   // tid_ext
+                                   version,
+                                   is_current,
+                                   section_number,
+                                   section_number,   //last_section_number
+                                   payload,
+                                   writer.size())); // payload_size,
+
     // Restart after constant part of payload (3 bytes).
-    remain += data - payload - 3;
-    data = payload + 3;
-    section_number++;
+    writer.rewind(SDTHeader::BYTE_SIZE);
 }
 
 
@@ -219,16 +227,13 @@ void ts::SDT::serializeContent(DuckContext& duck, BinaryTable& table) const
 {
     // Build the sections
     uint8_t payload[MAX_PSI_LONG_SECTION_PAYLOAD_SIZE];
-    int section_number = 0;
-    uint8_t* data = payload;
-    size_t remain = sizeof(payload);
+    FieldWriter writer(payload, sizeof(payload));
+    SectionPtrVector sections;
 
     // Add original_network_id and one reserved byte at beginning of the
     // payload (will remain identical in all sections).
-    PutUInt16(data, onetw_id);
-    data[2] = 0xFF;
-    data += 3;
-    remain -= 3;
+    uint8_t* const header = writer.put<SDTHeader>();
+    SDTHeader::original_network_id::put(header, onetw_id);
 
     // Add all services
     for (ServiceMap::const_iterator it = services.begin(); it != services.end(); ++it) {
@@ -237,8 +242,8 @@ void ts::SDT::serializeContent(DuckContext& duck, BinaryTable& table) const
         const Service& serv(it->second);
 
         // If we cannot at least add the fixed part, open a new section
-        if (remain < 5) {
-            addSection(table, section_number, payload, data, remain);
+        if (writer.remain() < SDTServiceEntry::BYTE_SIZE) {
+            addSection(sections, payload, writer);
         }
 
         // Insert the characteristics of the service. When the section is
@@ -256,39 +261,37 @@ void ts::SDT::serializeContent(DuckContext& duck, BinaryTable& table) const
             // Note that huge service descriptions may not fit into
             // one section. In that case, the service description
             // will span two sections later.
-            if (starting && 5 + serv.descs.binarySize() > remain) {
-                addSection(table, section_number, payload, data, remain);
+            if (starting && !writer.fits<SDTServiceEntry>(serv.descs)) {
+                addSection(sections, payload, writer);
             }
 
             starting = false;
 
             // Insert common characteristics of the service
-            assert(remain >= 5);
-            PutUInt16(data, service_id);
-            data[2] = 0xFC | (serv.EITs_present ? 0x02 : 0x00) | (serv.EITpf_present ? 0x01 : 0x00);
-            data += 3;
-            remain -= 3;
+            uint8_t* const entry = writer.put<SDTServiceEntry>();
+            assert(entry != nullptr);
+            SDTServiceEntry::service_id::put(entry, service_id);
+            SDTServiceEntry::EIT_schedule_flag::put(entry, serv.EITs_present);
+            SDTServiceEntry::EIT_present_following_flag::put(entry, serv.EITpf_present);
+            SDTServiceEntry::running_status::put(entry, serv.running_status);
+            SDTServiceEntry::free_CA_mode::put(entry, serv.CA_controlled);
 
             // Insert descriptors (all or some).
-            uint8_t* flags(data);
-            start_index = serv.descs.lengthSerialize(data, remain, start_index);
-
-            // The following fields are inserted in the 4 "reserved" bits
-            // of the descriptor_loop_length.
-            flags[0] = (flags[0] & 0x0F) | uint8_t(serv.running_status << 5) | (serv.CA_controlled ? 0x10 : 0x00);
+            start_index = writer.putDescriptors<SDTServiceEntry::descriptors_loop_length>(serv.descs, entry, start_index);
 
             // If not all descriptors were written, the section is full.
             // Open a new one and continue with this service.
             if (start_index < serv.descs.count()) {
-                addSection(table, section_number, payload, data, remain);
+                addSection(sections, payload, writer);
             }
         }
     }
 
     // Add partial section (if there is one)
-    if (data > payload + 3 || table.sectionCount() == 0) {
-        addSection(table, section_number, payload, data, remain);
+    if (writer.size() > SDTHeader::BYTE_SIZE || sections.empty()) {
+        addSection(sections, payload, writer);
     }
+    AddSections(table, sections);
 }
 
 
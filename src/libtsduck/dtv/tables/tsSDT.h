@@ -39,6 +39,9 @@
 #include "tsService.h"
 
 namespace ts {
+
+    class FieldWriter;
+
     //!
     //! Representation of a Service Description Table (SDT).
     //! @ingroup table
@@ -259,8 +262,8 @@ namespace ts {
         virtual void buildXML(DuckContext&, xml::Element*) const override;
 
     private:
-        // Add a new section to a table being serialized
-        // Section number is incremented. Data and remain are reinitialized.
-        void addSection(BinaryTable& table, int& section_number, uint8_t* payload, uint8_t*& data, size_t& remain) const;
+        // Add a new section to a table being serialized.
+        // The writer is rewound after the constant part of the payload.
+        void addSection(SectionPtrVector& sections, const uint8_t* payload, FieldWriter& writer) const;
     };
 }
@@ -0,0 +1,430 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsATSCHuffman.h"
+#include "tsSysUtils.h"
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr ts::UChar ts::ATSCHuffman::TERMINATE;
+constexpr ts::UChar ts::ATSCHuffman::ESCAPE;
+constexpr size_t ts::ATSCHuffman::CONTEXT_COUNT;
+constexpr size_t ts::ATSCHuffman::MAX_CODE_BITS;
+constexpr uint8_t ts::ATSCHuffman::INVALID_LENGTH;
+#endif
+
+// Size of the header of a decode tree table: one 16-bit offset per context.
+#define TREE_HEADER_SIZE (2 * CONTEXT_COUNT)
+
+namespace {
+    // Get 8 bits at a given bit position, zero-padded after end of data.
+    inline uint8_t Peek8(const uint8_t* data, size_t size, size_t pos)
+    {
+        const size_t index = pos >> 3;
+        const unsigned int hi = index < size ? data[index] : 0;
+        const unsigned int lo = index + 1 < size ? data[index + 1] : 0;
+        return uint8_t(((hi << 8) | lo) >> (8 - (pos & 7)));
+    }
+
+    // Get one bit at a given bit position.
+    inline uint8_t GetBit(const uint8_t* data, size_t pos)
+    {
+        return (data[pos >> 3] >> (7 - (pos & 7))) & 0x01;
+    }
+
+    // Append bits to a byte block, most significant bit first.
+    class BitWriter
+    {
+    public:
+        BitWriter(ts::ByteBlock& data) : _data(data), _bits(0) {}
+        void put(uint64_t value, size_t length)
+        {
+            while (length-- > 0) {
+                if (_bits % 8 == 0) {
+                    _data.push_back(0);
+                }
+                if (((value >> length) & 1) != 0) {
+                    _data.back() |= uint8_t(0x80 >> (_bits % 8));
+                }
+                _bits++;
+            }
+        }
+    private:
+        ts::ByteBlock& _data;
+        size_t         _bits;
+    };
+
+    // Node of a Huffman tree while building a code.
+    struct BuildNode
+    {
+        uint64_t weight;
+        int      symbol;  // -1 for internal nodes
+        size_t   left;
+        size_t   right;
+    };
+}
+
+
+//----------------------------------------------------------------------------
+// Constructors.
+//----------------------------------------------------------------------------
+
+ts::ATSCHuffman::ATSCHuffman() :
+    _valid(false),
+    _tree(),
+    _lookup(),
+    _codes()
+{
+}
+
+ts::ATSCHuffman::ATSCHuffman(const ByteBlock& decode_tree) :
+    ATSCHuffman()
+{
+    setDecodeTree(decode_tree);
+}
+
+
+//----------------------------------------------------------------------------
+// Set a new decode tree and compile the lookup and encoding tables.
+//----------------------------------------------------------------------------
+
+bool ts::ATSCHuffman::setDecodeTree(const ByteBlock& decode_tree)
+{
+    _tree = decode_tree;
+    _lookup.clear();
+    _codes.clear();
+    _valid = _tree.size() >= TREE_HEADER_SIZE;
+
+    if (_valid) {
+        _lookup.resize(CONTEXT_COUNT * 256);
+        _codes.resize(CONTEXT_COUNT * CONTEXT_COUNT, Code({0, 0}));
+    }
+
+    for (size_t context = 0; _valid && context < CONTEXT_COUNT; ++context) {
+        const size_t offset = treeOffset(context);
+
+        // Build the lookup table: walk the tree along the 8 bits of each index.
+        for (size_t value = 0; value < 256; ++value) {
+            LookupEntry& entry(_lookup[context * 256 + value]);
+            entry.symbol = 0;
+            entry.length = 0;
+            entry.node = 0;
+            for (size_t bit = 0; bit < 8; ++bit) {
+                const size_t index = offset + 2 * entry.node + ((value >> (7 - bit)) & 1);
+                if (index >= _tree.size()) {
+                    entry.length = INVALID_LENGTH;
+                    _valid = false;
+                    break;
+                }
+                else if ((_tree[index] & 0x80) != 0) {
+                    entry.symbol = _tree[index] & 0x7F;
+                    entry.length = uint8_t(bit + 1);
+                    break;
+                }
+                else {
+                    entry.node = _tree[index];
+                }
+            }
+        }
+
+        // Build the encoding table.
+        std::vector<bool> visited(CONTEXT_COUNT, false);
+        _valid = _valid && collectCodes(context, offset, 0, 0, 0, visited);
+    }
+    return _valid;
+}
+
+
+//----------------------------------------------------------------------------
+// Collect the codes of all leaves under a node pair.
+//----------------------------------------------------------------------------
+
+bool ts::ATSCHuffman::collectCodes(size_t context, size_t offset, size_t node, uint64_t value, size_t length, std::vector<bool>& visited)
+{
+    // In a valid tree, each node pair is reached only once. Also protect against loops.
+    if (node >= visited.size() || visited[node] || length >= MAX_CODE_BITS) {
+        return false;
+    }
+    visited[node] = true;
+
+    for (uint8_t bit = 0; bit < 2; ++bit) {
+        const size_t index = offset + 2 * node + bit;
+        if (index >= _tree.size()) {
+            return false;
+        }
+        const uint64_t code = (value << 1) | bit;
+        const uint8_t next = _tree[index];
+        if ((next & 0x80) != 0) {
+            Code& leaf(_codes[context * CONTEXT_COUNT + (next & 0x7F)]);
+            if (leaf.length == 0 || leaf.length > length + 1) {
+                leaf.value = code;
+                leaf.length = length + 1;
+            }
+        }
+        else if (!collectCodes(context, offset, next, code, length + 1, visited)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Decode a compressed string.
+//----------------------------------------------------------------------------
+
+bool ts::ATSCHuffman::decode(UString& text, const uint8_t* data, size_t size) const
+{
+    text.clear();
+    if (!_valid || (data == nullptr && size > 0)) {
+        return false;
+    }
+
+    const size_t total = 8 * size;
+    size_t pos = 0;
+    size_t context = 0;
+
+    while (pos < total) {
+
+        // Decode up to 8 bits in one lookup.
+        const LookupEntry& entry(_lookup[context * 256 + Peek8(data, size, pos)]);
+        uint8_t symbol = entry.symbol;
+
+        if (entry.length == INVALID_LENGTH) {
+            return false;
+        }
+        else if (entry.length > 0) {
+            pos += entry.length;
+        }
+        else {
+            // Long code, continue with a tree walk.
+            const size_t offset = treeOffset(context);
+            size_t node = entry.node;
+            size_t length = 8;
+            pos += 8;
+            for (;;) {
+                if (pos >= total) {
+                    // Truncated code in padding bits.
+                    return true;
+                }
+                const size_t index = offset + 2 * node + GetBit(data, pos++);
+                if (index >= _tree.size() || ++length > MAX_CODE_BITS) {
+                    return false;
+                }
+                else if ((_tree[index] & 0x80) != 0) {
+                    symbol = _tree[index] & 0x7F;
+                    break;
+                }
+                node = _tree[index];
+            }
+        }
+
+        // A code which ends after the data is made of padding bits.
+        if (pos > total || symbol == TERMINATE) {
+            break;
+        }
+        else if (symbol == ESCAPE) {
+            // Uncompressed 8-bit character.
+            if (pos + 8 > total) {
+                break;
+            }
+            const UChar c = Peek8(data, size, pos);
+            pos += 8;
+            text.push_back(c);
+            context = NextContext(c);
+        }
+        else {
+            text.push_back(UChar(symbol));
+            context = symbol;
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Encode a string.
+//----------------------------------------------------------------------------
+
+bool ts::ATSCHuffman::encode(ByteBlock& data, const UString& text) const
+{
+    if (!_valid) {
+        return false;
+    }
+
+    ByteBlock bits;
+    BitWriter writer(bits);
+    size_t context = 0;
+
+    for (size_t i = 0; i < text.size(); ++i) {
+        const UChar c = text[i];
+        const Code* code = c < CONTEXT_COUNT && c != TERMINATE && c != ESCAPE ? &_codes[context * CONTEXT_COUNT + c] : nullptr;
+        if (code != nullptr && code->length > 0) {
+            writer.put(code->value, code->length);
+        }
+        else {
+            // Use an escape sequence for characters without code in this context.
+            const Code& esc(_codes[context * CONTEXT_COUNT + ESCAPE]);
+            if (c > 0xFF || esc.length == 0) {
+                return false;
+            }
+            writer.put(esc.value, esc.length);
+            writer.put(c, 8);
+        }
+        context = NextContext(c);
+    }
+
+    // Terminate the string when possible. Otherwise, the end of data terminates the string.
+    const Code& term(_codes[context * CONTEXT_COUNT + TERMINATE]);
+    writer.put(term.value, term.length);
+
+    data.append(bits);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Build a new code from a corpus of typical strings.
+//----------------------------------------------------------------------------
+
+bool ts::ATSCHuffman::build(const UStringList& corpus)
+{
+    // Count symbols in each context.
+    std::vector<uint64_t> freq(CONTEXT_COUNT * CONTEXT_COUNT, 0);
+    for (auto it = corpus.begin(); it != corpus.end(); ++it) {
+        size_t context = 0;
+        for (size_t i = 0; i < it->size(); ++i) {
+            const UChar c = (*it)[i];
+            if (c > 0xFF) {
+                continue;  // cannot be encoded
+            }
+            else if (c < CONTEXT_COUNT && c != TERMINATE && c != ESCAPE) {
+                freq[context * CONTEXT_COUNT + c]++;
+            }
+            else {
+                freq[context * CONTEXT_COUNT + ESCAPE]++;
+            }
+            context = NextContext(c);
+        }
+        freq[context * CONTEXT_COUNT + TERMINATE]++;
+    }
+
+    // Build the decode tree table.
+    ByteBlock table(TREE_HEADER_SIZE, 0);
+    for (size_t context = 0; context < CONTEXT_COUNT; ++context) {
+
+        // The string terminator and the escape are always available.
+        uint64_t* const cfreq = &freq[context * CONTEXT_COUNT];
+        cfreq[TERMINATE] = std::max<uint64_t>(cfreq[TERMINATE], 1);
+        cfreq[ESCAPE] = std::max<uint64_t>(cfreq[ESCAPE], 1);
+
+        // Create the leaves.
+        std::vector<BuildNode> nodes;
+        std::vector<size_t> active;
+        for (size_t sym = 0; sym < CONTEXT_COUNT; ++sym) {
+            if (cfreq[sym] > 0) {
+                active.push_back(nodes.size());
+                nodes.push_back({cfreq[sym], int(sym), 0, 0});
+            }
+        }
+
+        // Merge the two lightest nodes until only the root remains.
+        // Ties are broken by creation order to get a deterministic result.
+        while (active.size() > 1) {
+            size_t first = 0;
+            size_t second = 1;
+            if (nodes[active[second]].weight < nodes[active[first]].weight) {
+                std::swap(first, second);
+            }
+            for (size_t i = 2; i < active.size(); ++i) {
+                if (nodes[active[i]].weight < nodes[active[first]].weight) {
+                    second = first;
+                    first = i;
+                }
+                else if (nodes[active[i]].weight < nodes[active[second]].weight) {
+                    second = i;
+                }
+            }
+            const BuildNode parent = {nodes[active[first]].weight + nodes[active[second]].weight, -1, active[first], active[second]};
+            active.erase(active.begin() + std::max(first, second));
+            active[std::min(first, second)] = nodes.size();
+            nodes.push_back(parent);
+        }
+
+        // Serialize the tree in breadth-first order, the root being the node pair 0.
+        PutUInt16(&table[2 * context], uint16_t(table.size()));
+        if (table.size() > 0xFFFF) {
+            return false;
+        }
+        std::vector<size_t> queue(1, active[0]);
+        for (size_t i = 0; i < queue.size(); ++i) {
+            const size_t children[2] = {nodes[queue[i]].left, nodes[queue[i]].right};
+            for (size_t b = 0; b < 2; ++b) {
+                const BuildNode& child(nodes[children[b]]);
+                if (child.symbol >= 0) {
+                    table.push_back(uint8_t(0x80 | child.symbol));
+                }
+                else {
+                    table.push_back(uint8_t(queue.size()));
+                    queue.push_back(children[b]);
+                }
+            }
+        }
+    }
+
+    return setDecodeTree(table);
+}
+
+
+//----------------------------------------------------------------------------
+// Get a standard ATSC Huffman code.
+//----------------------------------------------------------------------------
+
+ts::ByteBlock ts::ATSCHuffman::LoadStandardTree(const UString& file_name)
+{
+    ByteBlock tree;
+    const UString path(SearchConfigurationFile(file_name));
+    if (!path.empty()) {
+        tree.loadFromFile(path);
+    }
+    return tree;
+}
+
+const ts::ATSCHuffman* ts::ATSCHuffman::Standard(uint8_t compression_type)
+{
+    // The standard codes are loaded once, on first use.
+    static const ATSCHuffman title(LoadStandardTree(u"tsduck.atsc.title.huffman"));
+    static const ATSCHuffman description(LoadStandardTree(u"tsduck.atsc.description.huffman"));
+
+    switch (compression_type) {
+        case 0x01: return title.isValid() ? &title : nullptr;
+        case 0x02: return description.isValid() ? &description : nullptr;
+        default: return nullptr;
+    }
+}
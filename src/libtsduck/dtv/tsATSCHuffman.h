@@ -0,0 +1,180 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Huffman compression of ATSC text strings.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsUString.h"
+#include "tsByteBlock.h"
+
+namespace ts {
+    //!
+    //! Huffman compression of ATSC text strings (ATSC A/65, Annex C).
+    //!
+    //! ATSC uses an order-1 Huffman code for compressed multiple_string_structure
+    //! segments: the code of a character depends on the previous character.
+    //! A code is described by a "decode tree" table, as published in ATSC A/65,
+    //! table C.5 for titles (compression_type 0x01) and table C.7 for descriptions
+    //! (compression_type 0x02).
+    //!
+    //! A decode tree table starts with 128 big-endian 16-bit byte offsets, one per
+    //! previous character, to the tree of this context. Each tree is an array of node
+    //! pairs, one byte for a 0 bit, one byte for a 1 bit. A node byte with the most
+    //! significant bit set is a leaf and the 7 least significant bits are the character.
+    //! Otherwise, the byte is the index of the next node pair in the same tree.
+    //!
+    //! Decoding does not walk the trees bit by bit. Each tree is compiled into a lookup
+    //! table which is indexed by the next 8 bits of compressed data and returns the
+    //! decoded character and its code length in one step. Only codes which are longer
+    //! than 8 bits continue with a tree walk.
+    //!
+    //! The decode trees of the ATSC standard are not embedded in TSDuck. They are loaded
+    //! from the binary configuration files @c tsduck.atsc.title.huffman and
+    //! @c tsduck.atsc.description.huffman, respectively containing the tables C.5 and C.7
+    //! of ATSC A/65, when present.
+    //!
+    //! @see ATSC A/65, Annex C.
+    //! @ingroup mpeg
+    //!
+    class TSDUCKDLL ATSCHuffman
+    {
+    public:
+        static constexpr UChar  TERMINATE = 0x00;      //!< Symbol which terminates a compressed string.
+        static constexpr UChar  ESCAPE = 0x1B;         //!< Symbol which precedes an uncompressed 8-bit character.
+        static constexpr size_t CONTEXT_COUNT = 128;   //!< Number of contexts, ie. possible previous characters.
+        static constexpr size_t MAX_CODE_BITS = 64;    //!< Maximum supported code length in bits.
+
+        //!
+        //! Default constructor.
+        //! The object is invalid until a decode tree is set.
+        //!
+        ATSCHuffman();
+
+        //!
+        //! Constructor from a decode tree.
+        //! @param [in] decode_tree Binary decode tree table, in ATSC A/65 Annex C format.
+        //!
+        ATSCHuffman(const ByteBlock& decode_tree);
+
+        //!
+        //! Set a new decode tree.
+        //! @param [in] decode_tree Binary decode tree table, in ATSC A/65 Annex C format.
+        //! @return True on success, false if the decode tree is invalid.
+        //!
+        bool setDecodeTree(const ByteBlock& decode_tree);
+
+        //!
+        //! Get the binary decode tree table.
+        //! @return A constant reference to the decode tree, in ATSC A/65 Annex C format.
+        //!
+        const ByteBlock& decodeTree() const { return _tree; }
+
+        //!
+        //! Check if this object contains a valid decode tree.
+        //! @return True if this object contains a valid decode tree.
+        //!
+        bool isValid() const { return _valid; }
+
+        //!
+        //! Build a new code from a corpus of typical strings.
+        //! This can be used to generate decode tree tables.
+        //! Only characters in the range 0x00-0xFF can be compressed. Characters in the range
+        //! 0x80-0xFF and the character 0x1B are always encoded using an escape sequence.
+        //! @param [in] corpus A list of typical strings.
+        //! @return True on success, false on error.
+        //!
+        bool build(const UStringList& corpus);
+
+        //!
+        //! Decode a compressed string.
+        //! @param [out] text Decoded string. All characters are in the range 0x00-0xFF.
+        //! @param [in] data Address of compressed data.
+        //! @param [in] size Size in bytes of compressed data.
+        //! @return True on success, false on invalid compressed data.
+        //!
+        bool decode(UString& text, const uint8_t* data, size_t size) const;
+
+        //!
+        //! Encode a string.
+        //! @param [in,out] data Byte block where the compressed string is appended.
+        //! @param [in] text String to compress. All characters must be in the range 0x00-0xFF.
+        //! @return True on success, false if the string cannot be compressed with this code.
+        //!
+        bool encode(ByteBlock& data, const UString& text) const;
+
+        //!
+        //! Get a standard ATSC Huffman code.
+        //! @param [in] compression_type Compression type in a multiple_string_structure,
+        //! 0x01 for titles, 0x02 for descriptions.
+        //! @return Address of the standard code or a null pointer if the compression type
+        //! is unknown or the corresponding decode tree is not available.
+        //!
+        static const ATSCHuffman* Standard(uint8_t compression_type);
+
+    private:
+        // Entry in a lookup table for one context, indexed by the next 8 bits.
+        // When length is zero, the code is longer than 8 bits and the decoding
+        // continues with a tree walk from the node pair index in node.
+        struct LookupEntry
+        {
+            uint8_t symbol;   // Decoded symbol.
+            uint8_t length;   // Code length in bits, 0 for long code, INVALID_LENGTH on invalid tree.
+            uint8_t node;     // Next node pair after 8 bits, for long codes.
+        };
+
+        // Code of one symbol in one context, for encoding.
+        struct Code
+        {
+            uint64_t value;   // Code value, in the least significant bits.
+            size_t   length;  // Code length in bits, zero if the symbol has no code.
+        };
+
+        static constexpr uint8_t INVALID_LENGTH = 0xFF;
+
+        bool                     _valid;    // The decode tree is valid.
+        ByteBlock                _tree;     // Binary decode tree, A/65 Annex C format.
+        std::vector<LookupEntry> _lookup;   // Lookup tables, 256 entries per context.
+        std::vector<Code>        _codes;    // Encoding table, CONTEXT_COUNT entries per context.
+
+        // Context which follows a character.
+        static size_t NextContext(UChar c) { return c < 0x80 ? size_t(c) : size_t(ESCAPE); }
+
+        // Offset of the tree of a context in the decode tree.
+        size_t treeOffset(size_t context) const { return GetUInt16(_tree.data() + 2 * context); }
+
+        // Collect the codes of all leaves under a node pair. Return false on invalid tree.
+        bool collectCodes(size_t context, size_t offset, size_t node, uint64_t value, size_t length, std::vector<bool>& visited);
+
+        // Load a standard decode tree from a configuration file, empty if not found.
+        static ByteBlock LoadStandardTree(const UString& file_name);
+    };
+}
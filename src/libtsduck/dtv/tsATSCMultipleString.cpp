@@ -28,6 +28,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsATSCMultipleString.h"
+#include "tsATSCHuffman.h"
 #include "tsDuckContext.h"
 #include "tsxmlElement.h"
 #include "tsTablesDisplay.h"
@@ -498,8 +499,19 @@ bool ts::ATSCMultipleString::DecodeSegment(UString& segment, const uint8_t*& dat
             segment.append(u"(unsupported mode)");
         }
     }
-    else if (display) {
-        segment.append(u"(compressed)");
+    else {
+        // Huffman-compressed segment, characters are in the range of the mode.
+        const ATSCHuffman* const huffman = ATSCHuffman::Standard(compression);
+        UString text;
+        if (huffman != nullptr && _unicode_modes.find(mode) != _unicode_modes.end() && huffman->decode(text, data, nbytes)) {
+            const UChar base = UChar(uint16_t(mode) << 8);
+            for (size_t i = 0; i < text.size(); ++i) {
+                segment.push_back(base | text[i]);
+            }
+        }
+        else if (display) {
+            segment.append(u"(compressed)");
+        }
     }
 
     data += nbytes; size -= nbytes; max_size -= nbytes;
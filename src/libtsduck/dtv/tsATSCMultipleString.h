@@ -48,8 +48,10 @@ namespace ts {
     //! Representation of an ATSC multiple_string_structure.
     //!
     //! An ATSC multiple_string_structure is a set of strings. Each string has
-    //! a language code and a compression mode. In this implementation, we only
-    //! support non-compressed text.
+    //! a language code and a compression mode. In this implementation, strings are
+    //! always serialized as non-compressed text. When deserializing, the Huffman-compressed
+    //! segments (compression types 0x01 and 0x02) are decoded when the corresponding
+    //! standard decode trees are available (see ts::ATSCHuffman).
     //!
     //! @see ATSC A/65, section 6.10.
     //! @ingroup mpeg
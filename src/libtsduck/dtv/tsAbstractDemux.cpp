@@ -60,18 +60,15 @@ ts::AbstractDemux::~AbstractDemux()
 void ts::AbstractDemux::setPIDFilter(const PIDSet& pids)
 {
     // Get list of removed PID's
-    const PIDSet removed_pids(_pid_filter & ~pids);
+    PIDSet removed_pids(_pid_filter);
+    removed_pids.exclude(pids);
 
     // Set the new filter
     _pid_filter = pids;
 
     // Reset context of all removed PID's
-    if (removed_pids.any()) {
-        for (PID pid = 0; pid < PID_MAX; ++pid) {
-            if (removed_pids[pid]) {
-                resetPID(pid);
-            }
-        }
+    for (size_t pid = removed_pids.first(); pid < PID_MAX; pid = removed_pids.next(pid)) {
+        resetPID(PID(pid));
     }
 }
 
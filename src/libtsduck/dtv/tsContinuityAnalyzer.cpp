@@ -92,18 +92,15 @@ void ts::ContinuityAnalyzer::reset()
 void ts::ContinuityAnalyzer::setPIDFilter(const PIDSet& pids)
 {
     // Get list of removed PID's
-    const PIDSet removed_pids(_pid_filter & ~pids);
+    PIDSet removed_pids(_pid_filter);
+    removed_pids.exclude(pids);
 
     // Set the new filter
     _pid_filter = pids;
 
     // Reset context of all removed PID's
-    if (removed_pids.any()) {
-        for (PID pid = 0; pid < PID_MAX; ++pid) {
-            if (removed_pids[pid]) {
-                _pid_states.erase(pid);
-            }
-        }
+    for (size_t pid = removed_pids.first(); pid < PID_MAX; pid = removed_pids.next(pid)) {
+        _pid_states.erase(PID(pid));
     }
 }
 
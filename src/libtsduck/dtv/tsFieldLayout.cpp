@@ -0,0 +1,85 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Declarative binary layout of fixed-size structures in PSI/SI sections.
+//
+//----------------------------------------------------------------------------
+
+#include "tsFieldLayout.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Read a descriptor list.
+//----------------------------------------------------------------------------
+
+void ts::FieldReader::getDescriptors(DescriptorList& dlist, size_t length)
+{
+    length = std::min(length, _remain);
+    dlist.add(_data, length);
+    _data += length;
+    _remain -= length;
+}
+
+
+//----------------------------------------------------------------------------
+// Skip bytes.
+//----------------------------------------------------------------------------
+
+void ts::FieldReader::skip(size_t length)
+{
+    length = std::min(length, _remain);
+    _data += length;
+    _remain -= length;
+}
+
+
+//----------------------------------------------------------------------------
+// Rewind the writer to a previous position.
+//----------------------------------------------------------------------------
+
+void ts::FieldWriter::rewind(size_t size)
+{
+    if (size < this->size()) {
+        _remain += _data - _start - size;
+        _data = _start + size;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Reserve bytes at the end of the binary area.
+//----------------------------------------------------------------------------
+
+void ts::FieldWriter::reserve(size_t size)
+{
+    size = std::min(size, _remain);
+    _remain -= size;
+    _reserved += size;
+}
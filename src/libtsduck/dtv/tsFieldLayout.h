@@ -0,0 +1,356 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Declarative binary layout of fixed-size structures in PSI/SI sections.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsDescriptorList.h"
+
+namespace ts {
+    //!
+    //! Declarative description of a bit field inside a fixed-size binary structure.
+    //!
+    //! Bits are numbered from the most significant bit of the first byte of the
+    //! structure, as in all syntax tables of MPEG, DVB, ATSC, etc. The field shall
+    //! not span more than 8 bytes. All offsets and masks are compile-time constants.
+    //!
+    //! Typical usage: see class ts::FieldLayout.
+    //!
+    //! @tparam INT Integer type of the field value (can be @c bool for one-bit fields).
+    //! @tparam OFFSET Offset in bits of the field from the start of the structure.
+    //! @tparam WIDTH Width in bits of the field.
+    //! @ingroup mpeg
+    //!
+    template <typename INT, size_t OFFSET, size_t WIDTH>
+    class BitField
+    {
+    public:
+        static_assert(WIDTH > 0, "empty bit field");
+        static_assert(OFFSET % 8 + WIDTH <= 64, "bit field spans more than 8 bytes");
+
+        typedef INT value_type;  //!< Integer type of the field value.
+
+        static constexpr size_t   FIRST_BYTE = OFFSET / 8;                 //!< Index of the first byte of the field.
+        static constexpr size_t   LAST_BYTE = (OFFSET + WIDTH - 1) / 8;    //!< Index of the last byte of the field.
+        static constexpr size_t   SHIFT = 8 * (LAST_BYTE + 1) - OFFSET - WIDTH;  //!< Shift of the field in its bytes.
+        static constexpr uint64_t MASK = WIDTH >= 64 ? ~uint64_t(0) : (uint64_t(1) << WIDTH) - 1;  //!< Mask of the value.
+
+        //!
+        //! Get the value of the field.
+        //! @param [in] base Address of the structure.
+        //! @return The value of the field.
+        //!
+        static INT get(const uint8_t* base);
+
+        //!
+        //! Set the value of the field.
+        //! The other bits in the bytes of the field are unchanged.
+        //! @param [in,out] base Address of the structure.
+        //! @param [in] value The value of the field. Extra upper bits are ignored.
+        //!
+        static void put(uint8_t* base, INT value);
+    };
+
+    //!
+    //! Declarative description of a field which is made of complete bytes inside a fixed-size binary structure.
+    //! This is used for fields with specific encodings (MJD dates, BCD durations, strings, etc.)
+    //!
+    //! @tparam OFFSET Offset in bytes of the field from the start of the structure.
+    //! @tparam LENGTH Size in bytes of the field.
+    //! @ingroup mpeg
+    //!
+    template <size_t OFFSET, size_t LENGTH>
+    class ByteField
+    {
+    public:
+        static constexpr size_t SIZE = LENGTH;  //!< Size in bytes of the field.
+
+        //!
+        //! Get the address of the field.
+        //! @param [in] base Address of the structure.
+        //! @return The address of the field.
+        //!
+        static const uint8_t* at(const uint8_t* base) { return base + OFFSET; }
+
+        //!
+        //! Get the address of the field.
+        //! @param [in] base Address of the structure.
+        //! @return The address of the field.
+        //!
+        static uint8_t* at(uint8_t* base) { return base + OFFSET; }
+    };
+
+    //!
+    //! Declarative binary layout of a fixed-size structure in a PSI/SI section.
+    //!
+    //! A layout is declared as a subclass of FieldLayout which lists its fields.
+    //! The position of each field in the structure is checked at compile time.
+    //! Reserved bits are not declared, they are all set to 1 when the structure
+    //! is initialized.
+    //!
+    //! Example, the elementary stream entry of a PMT:
+    //! @code
+    //! class PMTStreamEntry: public ts::FieldLayout<5>
+    //! {
+    //! public:
+    //!     typedef Bits<uint8_t,   0,  8> stream_type;
+    //!     typedef Bits<ts::PID,  11, 13> elementary_PID;
+    //!     typedef Bits<size_t,   28, 12> ES_info_length;
+    //! };
+    //! @endcode
+    //!
+    //! The layouts are read and written using ts::FieldReader and ts::FieldWriter:
+    //! @code
+    //! while (const uint8_t* entry = reader.get<PMTStreamEntry>()) {
+    //!     const ts::PID pid = PMTStreamEntry::elementary_PID::get(entry);
+    //!     ...
+    //! }
+    //! @endcode
+    //!
+    //! @tparam SIZE Size in bytes of the structure.
+    //! @ingroup mpeg
+    //!
+    template <size_t SIZE>
+    class FieldLayout
+    {
+    public:
+        static constexpr size_t BYTE_SIZE = SIZE;  //!< Size in bytes of the structure.
+
+        //!
+        //! Declaration of a bit field inside the structure.
+        //! @tparam INT Integer type of the field value.
+        //! @tparam OFFSET Offset in bits of the field from the start of the structure.
+        //! @tparam WIDTH Width in bits of the field.
+        //!
+        template <typename INT, size_t OFFSET, size_t WIDTH>
+        class Bits : public BitField<INT, OFFSET, WIDTH>
+        {
+            static_assert(OFFSET + WIDTH <= 8 * SIZE, "bit field outside of structure");
+        };
+
+        //!
+        //! Declaration of a byte field inside the structure.
+        //! @tparam OFFSET Offset in bytes of the field from the start of the structure.
+        //! @tparam LENGTH Size in bytes of the field.
+        //!
+        template <size_t OFFSET, size_t LENGTH>
+        class Bytes : public ByteField<OFFSET, LENGTH>
+        {
+            static_assert(OFFSET + LENGTH <= SIZE, "byte field outside of structure");
+        };
+
+        //!
+        //! Initialize a structure before setting its fields.
+        //! All reserved bits are set to 1.
+        //! @param [out] base Address of the structure.
+        //!
+        static void Init(uint8_t* base) { ::memset(base, 0xFF, SIZE); }
+    };
+
+    //!
+    //! Bounds-checked sequential reader of fixed-size layouts and descriptor lists in a binary area.
+    //!
+    //! The reader never reads beyond the end of the area. When the remaining data are too
+    //! short for a layout, nothing is read. This is the usual behaviour of deserializers
+    //! on truncated sections: the trailing bytes are ignored.
+    //!
+    //! @ingroup mpeg
+    //!
+    class TSDUCKDLL FieldReader
+    {
+    public:
+        //!
+        //! Constructor.
+        //! @param [in] data Address of the binary area to read.
+        //! @param [in] size Size in bytes of the binary area.
+        //!
+        FieldReader(const uint8_t* data, size_t size) : _data(data), _remain(data == nullptr ? 0 : size) {}
+
+        //!
+        //! Get the number of remaining bytes to read.
+        //! @return The number of remaining bytes to read.
+        //!
+        size_t remain() const { return _remain; }
+
+        //!
+        //! Get the address of the next byte to read.
+        //! @return The address of the next byte to read.
+        //!
+        const uint8_t* current() const { return _data; }
+
+        //!
+        //! Read a fixed-size structure.
+        //! @tparam LAYOUT A subclass of ts::FieldLayout describing the structure.
+        //! @return The address of the structure or a null pointer if there is not enough data.
+        //! In the later case, nothing is read.
+        //!
+        template <class LAYOUT>
+        const uint8_t* get();
+
+        //!
+        //! Read a descriptor list.
+        //! @param [in,out] dlist The descriptor list to which the descriptors are added.
+        //! @param [in] length Size in bytes of the descriptor list. It is reduced to the remaining data.
+        //!
+        void getDescriptors(DescriptorList& dlist, size_t length);
+
+        //!
+        //! Read a descriptor list which size is stored in a field of a previously read structure.
+        //! @tparam LENGTH_FIELD A ts::BitField containing the size of the descriptor list.
+        //! @param [in,out] dlist The descriptor list to which the descriptors are added.
+        //! @param [in] base Address of the structure containing @a LENGTH_FIELD.
+        //!
+        template <class LENGTH_FIELD>
+        void getDescriptors(DescriptorList& dlist, const uint8_t* base)
+        {
+            getDescriptors(dlist, size_t(LENGTH_FIELD::get(base)));
+        }
+
+        //!
+        //! Restrict the remaining data to read, typically to the size of a loop.
+        //! @param [in] length Number of bytes of data to keep. When larger than the remaining data, do nothing.
+        //!
+        void limit(size_t length) { _remain = std::min(_remain, length); }
+
+        //!
+        //! Skip bytes.
+        //! @param [in] length Number of bytes to skip. It is reduced to the remaining data.
+        //!
+        void skip(size_t length);
+
+    private:
+        const uint8_t* _data;
+        size_t         _remain;
+    };
+
+    //!
+    //! Bounds-checked sequential writer of fixed-size layouts and descriptor lists in a binary area.
+    //!
+    //! The writer never writes beyond the end of the area. When there is not enough space for a
+    //! layout, nothing is written. The writer can be rewound to a previous position, typically
+    //! to start a new section after the fixed part of a section payload.
+    //!
+    //! @ingroup mpeg
+    //!
+    class TSDUCKDLL FieldWriter
+    {
+    public:
+        //!
+        //! Constructor.
+        //! @param [out] data Address of the binary area to write.
+        //! @param [in] size Size in bytes of the binary area.
+        //!
+        FieldWriter(uint8_t* data, size_t size) : _start(data), _data(data), _remain(data == nullptr ? 0 : size), _reserved(0) {}
+
+        //!
+        //! Get the number of remaining bytes to write.
+        //! @return The number of remaining bytes to write.
+        //!
+        size_t remain() const { return _remain; }
+
+        //!
+        //! Get the number of written bytes.
+        //! @return The number of written bytes since the start of the binary area.
+        //!
+        size_t size() const { return _data - _start; }
+
+        //!
+        //! Get the address of the next byte to write.
+        //! @return The address of the next byte to write.
+        //!
+        uint8_t* current() const { return _data; }
+
+        //!
+        //! Check if there is enough space to write a fixed-size structure and a descriptor list.
+        //! @tparam LAYOUT A subclass of ts::FieldLayout describing the structure.
+        //! @param [in] dlist The descriptor list to write after the structure.
+        //! @return True if the structure and all descriptors fit in the remaining space.
+        //!
+        template <class LAYOUT>
+        bool fits(const DescriptorList& dlist) const { return LAYOUT::BYTE_SIZE + dlist.binarySize() <= _remain; }
+
+        //!
+        //! Write a fixed-size structure.
+        //! The structure is initialized with all reserved bits set to 1.
+        //! @tparam LAYOUT A subclass of ts::FieldLayout describing the structure.
+        //! @return The address of the structure, where the fields shall be set, or a null pointer
+        //! if there is not enough space. In the later case, nothing is written.
+        //!
+        template <class LAYOUT>
+        uint8_t* put();
+
+        //!
+        //! Write a descriptor list and store its size in a field of a previously written structure.
+        //! Descriptors are written one by one until either the end of the list or until one
+        //! descriptor does not fit.
+        //! @tparam LENGTH_FIELD A ts::BitField receiving the size of the descriptor list.
+        //! @param [in] dlist The descriptor list to write.
+        //! @param [in,out] base Address of the structure containing @a LENGTH_FIELD.
+        //! @param [in] start Index of the first descriptor to write.
+        //! @return The index of the first descriptor that could not be written
+        //! (or dlist.count() if all descriptors were written).
+        //!
+        template <class LENGTH_FIELD>
+        size_t putDescriptors(const DescriptorList& dlist, uint8_t* base, size_t start = 0);
+
+        //!
+        //! Rewind the writer to a previous position.
+        //! @param [in] size Number of bytes to keep from the start of the binary area.
+        //! When larger than the written size, do nothing.
+        //!
+        void rewind(size_t size);
+
+        //!
+        //! Reserve bytes at the end of the binary area, typically for a structure which must follow.
+        //! The reserved bytes cannot be written until they are released.
+        //! @param [in] size Number of bytes to reserve. It is reduced to the remaining space.
+        //!
+        void reserve(size_t size);
+
+        //!
+        //! Release all bytes which were previously reserved.
+        //!
+        void release()
+        {
+            _remain += _reserved;
+            _reserved = 0;
+        }
+
+    private:
+        uint8_t* _start;
+        uint8_t* _data;
+        size_t   _remain;
+        size_t   _reserved;
+    };
+}
+
+#include "tsFieldLayoutTemplate.h"
@@ -0,0 +1,117 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Declarative binary layout of fixed-size structures in PSI/SI sections.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+template <typename INT, size_t OFFSET, size_t WIDTH> constexpr size_t ts::BitField<INT, OFFSET, WIDTH>::FIRST_BYTE;
+template <typename INT, size_t OFFSET, size_t WIDTH> constexpr size_t ts::BitField<INT, OFFSET, WIDTH>::LAST_BYTE;
+template <typename INT, size_t OFFSET, size_t WIDTH> constexpr size_t ts::BitField<INT, OFFSET, WIDTH>::SHIFT;
+template <typename INT, size_t OFFSET, size_t WIDTH> constexpr uint64_t ts::BitField<INT, OFFSET, WIDTH>::MASK;
+template <size_t OFFSET, size_t LENGTH> constexpr size_t ts::ByteField<OFFSET, LENGTH>::SIZE;
+template <size_t SIZE> constexpr size_t ts::FieldLayout<SIZE>::BYTE_SIZE;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Get / set the value of a bit field.
+// The loops have a constant number of iterations and are unrolled.
+//----------------------------------------------------------------------------
+
+template <typename INT, size_t OFFSET, size_t WIDTH>
+INT ts::BitField<INT, OFFSET, WIDTH>::get(const uint8_t* base)
+{
+    uint64_t bytes = 0;
+    for (size_t i = FIRST_BYTE; i <= LAST_BYTE; ++i) {
+        bytes = (bytes << 8) | base[i];
+    }
+    return static_cast<INT>((bytes >> SHIFT) & MASK);
+}
+
+template <typename INT, size_t OFFSET, size_t WIDTH>
+void ts::BitField<INT, OFFSET, WIDTH>::put(uint8_t* base, INT value)
+{
+    uint64_t bytes = 0;
+    for (size_t i = FIRST_BYTE; i <= LAST_BYTE; ++i) {
+        bytes = (bytes << 8) | base[i];
+    }
+    bytes = (bytes & ~(MASK << SHIFT)) | ((static_cast<uint64_t>(value) & MASK) << SHIFT);
+    for (size_t i = LAST_BYTE + 1; i-- > FIRST_BYTE; ) {
+        base[i] = static_cast<uint8_t>(bytes);
+        bytes >>= 8;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Read / write fixed-size structures.
+//----------------------------------------------------------------------------
+
+template <class LAYOUT>
+const uint8_t* ts::FieldReader::get()
+{
+    if (_remain < LAYOUT::BYTE_SIZE) {
+        return nullptr;
+    }
+    const uint8_t* const base = _data;
+    _data += LAYOUT::BYTE_SIZE;
+    _remain -= LAYOUT::BYTE_SIZE;
+    return base;
+}
+
+template <class LAYOUT>
+uint8_t* ts::FieldWriter::put()
+{
+    if (_remain < LAYOUT::BYTE_SIZE) {
+        return nullptr;
+    }
+    uint8_t* const base = _data;
+    LAYOUT::Init(base);
+    _data += LAYOUT::BYTE_SIZE;
+    _remain -= LAYOUT::BYTE_SIZE;
+    return base;
+}
+
+
+//----------------------------------------------------------------------------
+// Write a descriptor list and its length.
+//----------------------------------------------------------------------------
+
+template <class LENGTH_FIELD>
+size_t ts::FieldWriter::putDescriptors(const DescriptorList& dlist, uint8_t* base, size_t start)
+{
+    const uint8_t* const list_start = _data;
+    const size_t next = dlist.serialize(_data, _remain, start);
+    LENGTH_FIELD::put(base, static_cast<typename LENGTH_FIELD::value_type>(_data - list_start));
+    return next;
+}
@@ -0,0 +1,1144 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "tsHTTPStreamServer.h"
+#include "tsIPUtils.h"
+#include "tsNullReport.h"
+#include "tsGuard.h"
+#include "tsGuardCondition.h"
+#include "tsMPEG.h"
+#if defined(TS_LINUX)
+#include <sys/epoll.h>
+#elif defined(TS_UNIX)
+#include <poll.h>
+#endif
+#if defined(TS_UNIX)
+#include <fcntl.h>
+#endif
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::HTTPStreamServer::DEFAULT_BUFFER_PACKETS;
+constexpr size_t ts::HTTPStreamServer::DEFAULT_MAX_CLIENTS;
+constexpr ts::Second ts::HTTPStreamServer::DEFAULT_HLS_DURATION;
+constexpr size_t ts::HTTPStreamServer::DEFAULT_HLS_LIVE;
+#endif
+
+namespace {
+#if defined(TS_UNIX)
+    // Timeout of the event loop. The event loop is woken up when new packets are added.
+    constexpr ts::MilliSecond POLL_INTERVAL = 1000;
+#else
+    // Timeout of the event loop, the latency of the live stream.
+    constexpr ts::MilliSecond POLL_INTERVAL = 10;
+#endif
+
+    // Maximum number of packets in one chunk of live stream.
+    constexpr size_t MAX_CHUNK_PACKETS = 512;
+
+    // Maximum size of an HTTP request header.
+    constexpr size_t MAX_REQUEST_SIZE = 8192;
+
+    // Maximum number of packets in an HLS segment, when the duration cannot be evaluated.
+    constexpr ts::PacketCounter MAX_SEGMENT_PACKETS = 100000;
+
+    // Number of HLS segments which are kept after they left the playlist,
+    // for clients which loaded a previous version of the playlist.
+    constexpr size_t HLS_EXTRA_SEGMENTS = 2;
+
+    // Maximum number of events in one call to epoll_wait().
+    constexpr int MAX_EVENTS = 64;
+
+    // Flags for send operations: never raise SIGPIPE on a broken connection.
+#if defined(MSG_NOSIGNAL)
+    constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    constexpr int SEND_FLAGS = 0;
+#endif
+
+    // Check if a socket error means "try again later".
+    bool WouldBlock(ts::SocketErrorCode code)
+    {
+#if defined(TS_WINDOWS)
+        return code == WSAEWOULDBLOCK;
+#elif EAGAIN != EWOULDBLOCK
+        return code == EAGAIN || code == EWOULDBLOCK;
+#else
+        return code == EAGAIN;
+#endif
+    }
+
+    // Check if a socket error means "interrupted, try again now".
+    bool Interrupted(ts::SocketErrorCode code)
+    {
+#if defined(TS_WINDOWS)
+        return code == WSAEINTR;
+#else
+        return code == EINTR;
+#endif
+    }
+
+    // Set a socket in non-blocking mode.
+    bool SetNonBlocking(TS_SOCKET_T sock, ts::Report& report)
+    {
+#if defined(TS_WINDOWS)
+        ::u_long mode = 1;
+#else
+        int mode = 1;
+#endif
+        if (TS_SOCKET_IOCTL(sock, FIONBIO, &mode) != 0) {
+            report.error(u"error setting socket in non-blocking mode: %s", {ts::SocketErrorCodeMessage()});
+            return false;
+        }
+        return true;
+    }
+
+#if defined(TS_UNIX)
+    // Open a non-blocking pipe which wakes up the event loop.
+    bool OpenWakeUp(int fds[2], ts::Report& report)
+    {
+        if (::pipe(fds) != 0) {
+            report.error(u"error creating pipe: %s", {ts::SocketErrorCodeMessage()});
+            fds[0] = fds[1] = -1;
+            return false;
+        }
+        for (int i = 0; i < 2; ++i) {
+            ::fcntl(fds[i], F_SETFL, ::fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+            ::fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+        }
+        return true;
+    }
+
+    // Close the wake-up pipe.
+    void CloseWakeUp(int fds[2])
+    {
+        for (int i = 0; i < 2; ++i) {
+            if (fds[i] >= 0) {
+                ::close(fds[i]);
+                fds[i] = -1;
+            }
+        }
+    }
+
+    // Read all pending wake-up signals.
+    void DrainWakeUp(int fds[2])
+    {
+        char buffer[64];
+        while (::read(fds[0], buffer, sizeof(buffer)) > 0) {
+        }
+    }
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructors.
+//----------------------------------------------------------------------------
+
+ts::HTTPStreamServer::Args::Args() :
+    local_address(),
+    buffer_packets(DEFAULT_BUFFER_PACKETS),
+    max_clients(DEFAULT_MAX_CLIENTS),
+    max_lag(0),
+    send_buffer_size(0),
+    wait_clients(false),
+    hls(false),
+    hls_duration(DEFAULT_HLS_DURATION),
+    hls_live(DEFAULT_HLS_LIVE)
+{
+}
+
+ts::HTTPStreamServer::Client::Client() :
+    conn(),
+    address(),
+    state(READ_REQUEST),
+    closing(false),
+    keep_alive(false),
+    chunked(false),
+    want_write(false),
+    poll_write(false),
+    readable(false),
+    writable(false),
+    request(),
+    header(),
+    body(),
+    sent(0),
+    position(0),
+    stream_end(0),
+    chunk_packets(0),
+    prefix(),
+    prefix_size(0)
+{
+}
+
+ts::HTTPStreamServer::HTTPStreamServer() :
+    Thread(),
+    _report(&NULLREP),
+    _args(),
+    _server(),
+    _mutex(),
+    _room(),
+    _terminate(false),
+    _ring(),
+    _write_count(0),
+    _clients(),
+    _sending(false),
+    _stream_clients(false),
+    _read_floor(0),
+    _wake_on_data(false),
+    _segments(),
+    _playlist(),
+    _playlist_data(),
+    _max_duration(0),
+    _seg_data(),
+    _seg_packets(0),
+    _seg_sequence(0),
+    _pcr_pid(PID_NULL),
+    _seg_first_pcr(INVALID_PCR),
+    _seg_last_pcr(INVALID_PCR)
+#if defined(TS_LINUX)
+    , _epoll_fd(-1)
+#endif
+#if defined(TS_UNIX)
+    , _wakeup_fds{-1, -1}
+#endif
+{
+}
+
+ts::HTTPStreamServer::~HTTPStreamServer()
+{
+    close();
+}
+
+
+//----------------------------------------------------------------------------
+// Open and close the server.
+//----------------------------------------------------------------------------
+
+bool ts::HTTPStreamServer::open(const Args& args, Report& report)
+{
+    if (_server.isOpen()) {
+        report.error(u"HTTP server already open");
+        return false;
+    }
+
+    // Initialize the shared state before starting the server thread.
+    _report = &report;
+    _args = args;
+    _args.buffer_packets = std::max<size_t>(_args.buffer_packets, MAX_CHUNK_PACKETS);
+    _args.hls_duration = std::max<Second>(_args.hls_duration, 1);
+    _args.hls_live = std::max<size_t>(_args.hls_live, 1);
+    _terminate = false;
+    _ring.resize(_args.buffer_packets);
+    _write_count = 0;
+    _clients.clear();
+    _sending = false;
+    _stream_clients = false;
+    _read_floor = 0;
+    _wake_on_data = false;
+    _segments.clear();
+    _playlist.reset(hls::MEDIA_PLAYLIST, u"stream.m3u8");
+    _playlist.setTargetDuration(_args.hls_duration, report);
+    _playlist.setMediaSequence(0, report);
+    _playlist_data.clear();
+    _max_duration = _args.hls_duration;
+    _seg_data = new ByteBlock;
+    _seg_packets = 0;
+    _seg_sequence = 0;
+    _pcr_pid = PID_NULL;
+    _seg_first_pcr = _seg_last_pcr = INVALID_PCR;
+
+    // Open the listening socket.
+    if (!_server.open(report) ||
+        !_server.reusePort(true, report) ||
+        !_server.bind(_args.local_address, report) ||
+        !_server.listen(SOMAXCONN, report) ||
+        !SetNonBlocking(_server.getSocket(), report) ||
+        !openEvents())
+    {
+        closeEvents();
+        _server.close(NULLREP);
+        return false;
+    }
+
+    report.verbose(u"HTTP server listening on %s", {_args.local_address});
+    return start();
+}
+
+void ts::HTTPStreamServer::close()
+{
+    if (_server.isOpen()) {
+        // The server thread checks the termination flag at each iteration of the event loop.
+        _terminate = true;
+        wakeUp();
+        waitForTermination();
+        closeEvents();
+        _server.close(NULLREP);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get the number of currently connected clients.
+//----------------------------------------------------------------------------
+
+size_t ts::HTTPStreamServer::clientCount() const
+{
+    Guard lock(_mutex);
+    return _clients.size();
+}
+
+
+//----------------------------------------------------------------------------
+// Add TS packets to the live stream.
+//----------------------------------------------------------------------------
+
+void ts::HTTPStreamServer::addPackets(const TSPacket* packets, size_t count, BitRate bitrate)
+{
+    if (packets == nullptr || count == 0 || _ring.empty()) {
+        return;
+    }
+
+    // Build HLS segments without holding the lock, only completed segments are shared.
+    if (_args.hls) {
+        const MilliSecond target = _args.hls_duration * MilliSecPerSec;
+        for (size_t i = 0; i < count; ++i) {
+            const TSPacket& pkt(packets[i]);
+
+            // Cut the segment on a random access point after the target duration.
+            if (_seg_packets > 0) {
+                const MilliSecond duration = segmentDuration(bitrate);
+                if ((duration >= target && pkt.getRandomAccessIndicator()) || duration >= 2 * target || _seg_packets >= MAX_SEGMENT_PACKETS) {
+                    closeSegment(duration, bitrate);
+                }
+            }
+
+            // The PCR's of the first PID with PCR are used to evaluate the segment duration.
+            if (pkt.hasPCR()) {
+                const PID pid = pkt.getPID();
+                if (_pcr_pid == PID_NULL) {
+                    _pcr_pid = pid;
+                }
+                if (pid == _pcr_pid) {
+                    _seg_last_pcr = pkt.getPCR();
+                    if (_seg_first_pcr == INVALID_PCR) {
+                        _seg_first_pcr = _seg_last_pcr;
+                    }
+                }
+            }
+
+            _seg_data->append(pkt.b, PKT_SIZE);
+            _seg_packets++;
+        }
+    }
+
+    // Write the packets in the ring buffer.
+    GuardCondition lock(_mutex, _room);
+    const size_t size = _ring.size();
+    while (count > 0) {
+        const size_t room = writeRoom();
+        if (room == 0) {
+            // Wait for the server thread to send packets to the clients.
+            lock.waitCondition();
+            continue;
+        }
+        const size_t index = size_t(_write_count % size);
+        const size_t n = std::min(std::min(count, room), size - index);
+        TSPacket::Copy(&_ring[index], packets, n);
+        packets += n;
+        count -= n;
+        _write_count += n;
+        if (_wake_on_data) {
+            _wake_on_data = false;
+            wakeUp();
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Number of packets which can be written in the ring buffer, with the mutex held.
+//----------------------------------------------------------------------------
+
+size_t ts::HTTPStreamServer::writeRoom() const
+{
+    const size_t size = _ring.size();
+    if (!_stream_clients || _terminate || (!_sending && !_args.wait_clients)) {
+        // The oldest packets can be overwritten, too slow clients are disconnected.
+        return size;
+    }
+
+    // Never overwrite packets which are being sent without lock. With wait_clients,
+    // do not let the slowest client lag behind by more than the maximum lag.
+    PacketCounter limit = _read_floor + size;
+    if (_args.wait_clients) {
+        limit = std::min<PacketCounter>(limit, _read_floor + maxLag());
+    }
+    return limit > _write_count ? size_t(limit - _write_count) : 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Compute the oldest packet to send to live clients, with the mutex held.
+//----------------------------------------------------------------------------
+
+void ts::HTTPStreamServer::updateReadFloor()
+{
+    _stream_clients = false;
+    _read_floor = _write_count;
+    for (const auto& client : _clients) {
+        if (!client.closing && client.state == SEND_STREAM) {
+            _stream_clients = true;
+            _read_floor = std::min(_read_floor, client.position);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Duration of the HLS segment being built, in the application thread.
+//----------------------------------------------------------------------------
+
+ts::MilliSecond ts::HTTPStreamServer::segmentDuration(BitRate bitrate) const
+{
+    if (_seg_first_pcr != INVALID_PCR && _seg_last_pcr != _seg_first_pcr) {
+        return MilliSecond(DiffPCR(_seg_first_pcr, _seg_last_pcr) * MilliSecPerSec / SYSTEM_CLOCK_FREQ);
+    }
+    else if (bitrate > 0) {
+        return PacketInterval(bitrate, _seg_packets);
+    }
+    else {
+        return 0;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Publish the HLS segment being built, in the application thread.
+//----------------------------------------------------------------------------
+
+void ts::HTTPStreamServer::closeSegment(MilliSecond duration, BitRate bitrate)
+{
+    // Unknown duration (no PCR, no bitrate), assume the target duration.
+    if (duration <= 0) {
+        duration = _args.hls_duration * MilliSecPerSec;
+    }
+
+    hls::MediaSegment seg;
+    seg.uri = UString::Format(u"segment-%d.ts", {_seg_sequence});
+    seg.duration = duration;
+    seg.bitrate = bitrate > 0 ? bitrate : PacketBitRate(_seg_packets, duration);
+
+    {
+        Guard lock(_mutex);
+
+        // The target duration shall not be lower than any rounded segment duration.
+        const Second seconds = (duration + MilliSecPerSec / 2) / MilliSecPerSec;
+        if (seconds > _max_duration) {
+            _max_duration = seconds;
+            _playlist.setTargetDuration(_max_duration, *_report);
+        }
+
+        // Publish the segment and the new playlist.
+        _segments.push_back({_seg_sequence, _seg_data});
+        _playlist.addSegment(seg, *_report);
+        while (_playlist.segmentCount() > _args.hls_live) {
+            _playlist.popFirstSegment();
+        }
+        while (_segments.size() > _args.hls_live + HLS_EXTRA_SEGMENTS) {
+            _segments.pop_front();
+        }
+        const std::string text(_playlist.textContent(*_report).toUTF8());
+        _playlist_data = new ByteBlock(text.data(), text.size());
+    }
+
+    _report->debug(u"new HLS segment %s, %d packets, %d ms", {seg.uri, _seg_packets, duration});
+
+    // Start next segment, with the same allocated size as the previous one.
+    const size_t previous = _seg_data->size();
+    _seg_data = new ByteBlock;
+    _seg_data->reserve(previous);
+    _seg_packets = 0;
+    _seg_sequence++;
+    _seg_first_pcr = _seg_last_pcr;
+}
+
+
+//----------------------------------------------------------------------------
+// Server thread.
+//----------------------------------------------------------------------------
+
+void ts::HTTPStreamServer::main()
+{
+    _report->debug(u"HTTP server thread started");
+    bool pending = false;
+
+    while (!_terminate) {
+
+        // Wait for socket events without holding the lock. Do not wait when
+        // some data can be sent, independently of any socket event.
+        bool accept = false;
+        waitEvents(accept, pending);
+
+        // Accept new clients and receive requests without holding the lock.
+        // The list of clients is modified in this thread only.
+        std::list<Client> new_clients;
+        if (accept) {
+            acceptClients(new_clients);
+        }
+        for (auto& client : _clients) {
+            if (client.readable) {
+                receiveData(client);
+            }
+        }
+
+        // Process the requests and mark the data to send, with the lock held.
+        {
+            Guard lock(_mutex);
+            _clients.splice(_clients.end(), new_clients);
+            for (auto& client : _clients) {
+                if (!client.closing && client.state == READ_REQUEST) {
+                    processRequest(client);
+                }
+                if (!client.closing && client.state == SEND_STREAM && _write_count - client.position > maxLag()) {
+                    _report->verbose(u"HTTP client %s too slow, disconnected", {client.address});
+                    client.closing = true;
+                }
+                client.stream_end = _write_count;
+            }
+            updateReadFloor();
+            _sending = true;
+        }
+
+        // Send data without holding the lock. As long as _sending is true, addPackets()
+        // does not overwrite the packets of the ring buffer which remain to be sent.
+        for (auto& client : _clients) {
+            if (!client.closing && client.state != READ_REQUEST && (!client.want_write || client.writable)) {
+                sendData(client);
+            }
+            client.readable = client.writable = false;
+        }
+
+        // Cleanup and prepare next iteration, with the lock held.
+        GuardCondition lock(_mutex, _room);
+        _sending = false;
+        _wake_on_data = false;
+        pending = false;
+        for (auto it = _clients.begin(); it != _clients.end(); ) {
+            Client& client(*it);
+            if (!client.closing && client.state == READ_REQUEST && !client.request.empty()) {
+                // Next pipelined request on a persistent connection. Its response is sent in next iteration.
+                processRequest(client);
+            }
+            if (client.closing) {
+                closeClient(client);
+                it = _clients.erase(it);
+                continue;
+            }
+            updateEvents(client);
+            if (!client.want_write) {
+                if (client.state == SEND_RESPONSE || (client.state == SEND_STREAM && client.position < _write_count)) {
+                    pending = true;
+                }
+                else if (client.state == SEND_STREAM) {
+                    _wake_on_data = true;
+                }
+            }
+            ++it;
+        }
+        updateReadFloor();
+        lock.signal();
+    }
+
+    // Disconnect all clients.
+    GuardCondition lock(_mutex, _room);
+    for (auto& client : _clients) {
+        closeClient(client);
+    }
+    _clients.clear();
+    _stream_clients = false;
+    lock.signal();
+    _report->debug(u"HTTP server thread completed");
+}
+
+
+//----------------------------------------------------------------------------
+// Event loop primitives, epoll on Linux.
+//----------------------------------------------------------------------------
+
+#if defined(TS_LINUX)
+
+bool ts::HTTPStreamServer::openEvents()
+{
+    _epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll_fd < 0) {
+        _report->error(u"epoll error: %s", {SocketErrorCodeMessage()});
+        return false;
+    }
+    if (!OpenWakeUp(_wakeup_fds, *_report)) {
+        return false;
+    }
+    // The listening socket is identified by a null pointer, the wake-up pipe by its file descriptors.
+    ::epoll_event ev;
+    TS_ZERO(ev);
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;
+    if (::epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _server.getSocket(), &ev) != 0) {
+        _report->error(u"epoll error: %s", {SocketErrorCodeMessage()});
+        return false;
+    }
+    ev.data.ptr = _wakeup_fds;
+    if (::epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _wakeup_fds[0], &ev) != 0) {
+        _report->error(u"epoll error: %s", {SocketErrorCodeMessage()});
+        return false;
+    }
+    return true;
+}
+
+void ts::HTTPStreamServer::closeEvents()
+{
+    if (_epoll_fd >= 0) {
+        ::close(_epoll_fd);
+        _epoll_fd = -1;
+    }
+    CloseWakeUp(_wakeup_fds);
+}
+
+void ts::HTTPStreamServer::addEvents(Client& client)
+{
+    ::epoll_event ev;
+    TS_ZERO(ev);
+    ev.events = EPOLLIN;
+    ev.data.ptr = &client;
+    if (::epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, client.conn.getSocket(), &ev) != 0) {
+        _report->error(u"epoll error: %s", {SocketErrorCodeMessage()});
+        client.closing = true;
+    }
+}
+
+void ts::HTTPStreamServer::updateEvents(Client& client)
+{
+    if (client.want_write != client.poll_write) {
+        ::epoll_event ev;
+        TS_ZERO(ev);
+        ev.events = client.want_write ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        ev.data.ptr = &client;
+        if (::epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, client.conn.getSocket(), &ev) != 0) {
+            _report->error(u"epoll error: %s", {SocketErrorCodeMessage()});
+        }
+        client.poll_write = client.want_write;
+    }
+}
+
+void ts::HTTPStreamServer::removeEvents(Client& client)
+{
+    ::epoll_event ev;
+    TS_ZERO(ev);
+    ::epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, client.conn.getSocket(), &ev);
+}
+
+void ts::HTTPStreamServer::waitEvents(bool& accept, bool immediate)
+{
+    ::epoll_event events[MAX_EVENTS];
+    const int count = ::epoll_wait(_epoll_fd, events, MAX_EVENTS, immediate ? 0 : int(POLL_INTERVAL));
+    for (int i = 0; i < count; ++i) {
+        Client* client = reinterpret_cast<Client*>(events[i].data.ptr);
+        if (client == nullptr) {
+            accept = true;
+        }
+        else if (events[i].data.ptr == _wakeup_fds) {
+            DrainWakeUp(_wakeup_fds);
+        }
+        else {
+            // Errors and hang-ups are detected when reading.
+            client->readable = (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0;
+            client->writable = (events[i].events & EPOLLOUT) != 0;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Event loop primitives, poll() on other systems.
+//----------------------------------------------------------------------------
+
+#else
+
+bool ts::HTTPStreamServer::openEvents()
+{
+#if defined(TS_UNIX)
+    if (!OpenWakeUp(_wakeup_fds, *_report)) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+void ts::HTTPStreamServer::closeEvents()
+{
+#if defined(TS_UNIX)
+    CloseWakeUp(_wakeup_fds);
+#endif
+}
+
+void ts::HTTPStreamServer::addEvents(Client&)
+{
+}
+
+void ts::HTTPStreamServer::updateEvents(Client& client)
+{
+    client.poll_write = client.want_write;
+}
+
+void ts::HTTPStreamServer::removeEvents(Client&)
+{
+}
+
+void ts::HTTPStreamServer::waitEvents(bool& accept, bool immediate)
+{
+    // The list of clients is modified in this thread only, no need to lock.
+    // The first descriptors are the listening socket and the wake-up pipe, when there is one.
+#if defined(TS_UNIX)
+    constexpr size_t first = 2;
+#else
+    constexpr size_t first = 1;
+#endif
+    std::vector<::pollfd> fds(_clients.size() + first);
+    std::vector<Client*> refs(_clients.size() + first, nullptr);
+    fds[0].fd = _server.getSocket();
+    fds[0].events = POLLIN;
+#if defined(TS_UNIX)
+    fds[1].fd = _wakeup_fds[0];
+    fds[1].events = POLLIN;
+#endif
+    size_t count = first;
+    for (auto& client : _clients) {
+        fds[count].fd = client.conn.getSocket();
+        fds[count].events = POLLIN | (client.poll_write ? POLLOUT : 0);
+        refs[count++] = &client;
+    }
+
+#if defined(TS_WINDOWS)
+    const int status = ::WSAPoll(fds.data(), ::ULONG(count), immediate ? 0 : int(POLL_INTERVAL));
+#else
+    const int status = ::poll(fds.data(), ::nfds_t(count), immediate ? 0 : int(POLL_INTERVAL));
+#endif
+
+    if (status > 0) {
+        accept = (fds[0].revents & POLLIN) != 0;
+#if defined(TS_UNIX)
+        if ((fds[1].revents & POLLIN) != 0) {
+            DrainWakeUp(_wakeup_fds);
+        }
+#endif
+        for (size_t i = first; i < count; ++i) {
+            refs[i]->readable = (fds[i].revents & (POLLIN | POLLERR | POLLHUP)) != 0;
+            refs[i]->writable = (fds[i].revents & POLLOUT) != 0;
+        }
+    }
+}
+
+#endif
+
+
+//----------------------------------------------------------------------------
+// Wake up the event loop, from any thread.
+//----------------------------------------------------------------------------
+
+void ts::HTTPStreamServer::wakeUp()
+{
+#if defined(TS_UNIX)
+    // Without wake-up pipe (Windows), the event loop wakes up every POLL_INTERVAL.
+    if (_wakeup_fds[1] >= 0) {
+        const char byte = 0;
+        // The pipe is non-blocking. When it is full, the event loop is already signaled.
+        TS_UNUSED const ssize_t ret = ::write(_wakeup_fds[1], &byte, 1);
+    }
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Accept all pending client connections into a list of new clients.
+//----------------------------------------------------------------------------
+
+void ts::HTTPStreamServer::acceptClients(std::list<Client>& clients)
+{
+    for (;;) {
+        // The listening socket is non-blocking, a failure means no more pending connection.
+        clients.emplace_back();
+        Client& client(clients.back());
+        if (!_server.accept(client.conn, client.address, NULLREP)) {
+            clients.pop_back();
+            return;
+        }
+        if (_clients.size() + clients.size() > _args.max_clients) {
+            _report->verbose(u"too many HTTP clients, rejecting %s", {client.address});
+            client.conn.close(NULLREP);
+            clients.pop_back();
+            continue;
+        }
+        _report->verbose(u"HTTP client %s connected", {client.address});
+        if (!SetNonBlocking(client.conn.getSocket(), *_report) ||
+            (_args.send_buffer_size > 0 && !client.conn.setSendBufferSize(_args.send_buffer_size, *_report)))
+        {
+            client.closing = true;
+        }
+#if defined(SO_NOSIGPIPE)
+        int nosig = 1;
+        ::setsockopt(client.conn.getSocket(), SOL_SOCKET, SO_NOSIGPIPE, TS_SOCKOPT_T(&nosig), sizeof(nosig));
+#endif
+        addEvents(client);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Disconnect a client.
+//----------------------------------------------------------------------------
+
+void ts::HTTPStreamServer::closeClient(Client& client)
+{
+    _report->verbose(u"HTTP client %s disconnected", {client.address});
+    removeEvents(client);
+    client.conn.close(NULLREP);
+}
+
+
+//----------------------------------------------------------------------------
+// Receive all available data from a client.
+//----------------------------------------------------------------------------
+
+void ts::HTTPStreamServer::receiveData(Client& client)
+{
+    char buffer[2048];
+    for (;;) {
+        const TS_SOCKET_SSIZE_T got = ::recv(client.conn.getSocket(), TS_RECVBUF_T(buffer), int(sizeof(buffer)), 0);
+        if (got > 0) {
+            // Data are ignored while streaming, the request is complete.
+            if (client.state != SEND_STREAM) {
+                client.request.append(buffer, size_t(got));
+            }
+        }
+        else if (got == 0) {
+            // End of connection.
+            client.closing = true;
+            return;
+        }
+        else {
+            const SocketErrorCode code = LastSocketErrorCode();
+            if (WouldBlock(code)) {
+                break;
+            }
+            else if (!Interrupted(code)) {
+                if (code != TS_SOCKET_ERR_RESET) {
+                    _report->debug(u"error receiving from HTTP client %s: %s", {client.address, SocketErrorCodeMessage(code)});
+                }
+                client.closing = true;
+                return;
+            }
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Process a complete HTTP request, if one is available.
+//----------------------------------------------------------------------------
+
+void ts::HTTPStreamServer::processRequest(Client& client)
+{
+    // Wait for the complete request header.
+    const size_t end = client.request.find("\r\n\r\n");
+    if (end == std::string::npos) {
+        if (client.request.size() > MAX_REQUEST_SIZE) {
+            client.keep_alive = false;
+            setResponse(client, 400, u"Bad Request", ByteBlockPtrMT(), false);
+        }
+        return;
+    }
+    UStringVector lines;
+    UString::FromUTF8(client.request.substr(0, end)).split(lines, u'\n');
+    client.request.erase(0, end + 4);
+
+    // Analyze the request line: method, path, HTTP version.
+    UStringVector words;
+    if (!lines.empty()) {
+        lines[0].split(words, u' ', true, true);
+    }
+    if (words.size() != 3 || !words[2].startWith(u"HTTP/1.")) {
+        client.keep_alive = false;
+        setResponse(client, 400, u"Bad Request", ByteBlockPtrMT(), false);
+        return;
+    }
+    const UString& method(words[0]);
+    const bool head = method == u"HEAD";
+    const bool http11 = words[2] != u"HTTP/1.0";
+    UString path(words[1]);
+    const size_t query = path.find(u'?');
+    if (query != NPOS) {
+        path.resize(query);
+    }
+    _report->debug(u"HTTP client %s: %s", {client.address, lines[0]});
+
+    // Persistent connections are the default in HTTP/1.1 only.
+    client.keep_alive = http11;
+    for (size_t i = 1; i < lines.size(); ++i) {
+        const size_t colon = lines[i].find(u':');
+        if (colon != NPOS && lines[i].substr(0, colon).similar(u"Connection")) {
+            const UString value(lines[i].substr(colon + 1));
+            if (value.similar(u"close")) {
+                client.keep_alive = false;
+            }
+            else if (value.similar(u"keep-alive")) {
+                client.keep_alive = true;
+            }
+        }
+    }
+
+    if (!head && method != u"GET") {
+        client.keep_alive = false;
+        setResponse(client, 405, u"Method Not Allowed", ByteBlockPtrMT(), false);
+    }
+    else if (path == u"/" || path == u"/stream.ts") {
+        // Live stream, starting at the live point.
+        client.chunked = http11;
+        client.header = "HTTP/1.1 200 OK\r\n"
+                        "Content-Type: video/mp2t\r\n"
+                        "Cache-Control: no-cache\r\n";
+        if (client.chunked) {
+            client.header.append("Transfer-Encoding: chunked\r\n");
+        }
+        client.header.append("Connection: close\r\n\r\n");
+        client.body.clear();
+        client.sent = 0;
+        client.keep_alive = false;
+        client.position = _write_count;
+        client.chunk_packets = 0;
+        client.state = head ? SEND_RESPONSE : SEND_STREAM;
+    }
+    else if (_args.hls && path == u"/stream.m3u8" && !_playlist_data.isNull()) {
+        setResponse(client, 200, u"OK", _playlist_data, head, u"application/vnd.apple.mpegurl");
+    }
+    else {
+        // Look for an HLS segment.
+        ByteBlockPtrMT segment;
+        size_t sequence = 0;
+        if (_args.hls && path.startWith(u"/segment-") && path.endWith(u".ts") && path.substr(9, path.size() - 12).toInteger(sequence)) {
+            for (const auto& seg : _segments) {
+                if (seg.sequence == sequence) {
+                    segment = seg.data;
+                    break;
+                }
+            }
+        }
+        if (segment.isNull()) {
+            setResponse(client, 404, u"Not Found", ByteBlockPtrMT(), head);
+        }
+        else {
+            setResponse(client, 200, u"OK", segment, head, u"video/mp2t");
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Prepare a response with a fixed content.
+//----------------------------------------------------------------------------
+
+void ts::HTTPStreamServer::setResponse(Client& client, int status, const UString& reason, const ByteBlockPtrMT& body, bool head, const UString& type)
+{
+    UString header(UString::Format(u"HTTP/1.1 %d %s\r\n", {status, reason}));
+    if (!type.empty()) {
+        header += UString::Format(u"Content-Type: %s\r\nCache-Control: no-cache\r\n", {type});
+    }
+    header += UString::Format(u"Content-Length: %d\r\nConnection: %s\r\n\r\n", {body.isNull() ? 0 : body->size(), client.keep_alive ? u"keep-alive" : u"close"});
+    client.header = header.toUTF8();
+    client.body = head ? ByteBlockPtrMT() : body;
+    client.sent = 0;
+    client.state = SEND_RESPONSE;
+}
+
+
+//----------------------------------------------------------------------------
+// Send pending data to a client.
+//----------------------------------------------------------------------------
+
+void ts::HTTPStreamServer::sendData(Client& client)
+{
+    if (client.state == SEND_RESPONSE) {
+        const IOBuffer buffers[2] {
+            {client.header.data(), client.header.size()},
+            {client.body.isNull() ? nullptr : client.body->data(), client.body.isNull() ? 0 : client.body->size()}
+        };
+        if (sendBuffers(client, buffers, 2)) {
+            // Response completely sent.
+            client.header.clear();
+            client.body.clear();
+            client.sent = 0;
+            if (client.keep_alive) {
+                // The next pipelined request, if already received, is processed with the lock held.
+                client.state = READ_REQUEST;
+            }
+            else {
+                client.closing = true;
+            }
+        }
+    }
+    else if (client.state == SEND_STREAM) {
+        // Send the response header first.
+        if (!client.header.empty()) {
+            const IOBuffer buffer {client.header.data(), client.header.size()};
+            if (!sendBuffers(client, &buffer, 1)) {
+                return;
+            }
+            client.header.clear();
+            client.sent = 0;
+        }
+
+        // Send as many contiguous chunks as possible, directly from the shared ring buffer.
+        // Only the packets which were available before releasing the lock are sent.
+        const size_t size = _ring.size();
+        for (;;) {
+            if (client.chunk_packets == 0) {
+                const PacketCounter available = client.stream_end - client.position;
+                if (available == 0) {
+                    break;
+                }
+                client.chunk_packets = size_t(std::min<PacketCounter>(available, std::min(MAX_CHUNK_PACKETS, size - size_t(client.position % size))));
+                client.prefix_size = 0;
+                if (client.chunked) {
+                    // Chunk size line: hexadecimal size without leading zeroes.
+                    const size_t bytes = client.chunk_packets * PKT_SIZE;
+                    int shift = 28;
+                    while (shift > 0 && (bytes >> shift) == 0) {
+                        shift -= 4;
+                    }
+                    for (; shift >= 0; shift -= 4) {
+                        client.prefix[client.prefix_size++] = "0123456789ABCDEF"[(bytes >> shift) & 0x0F];
+                    }
+                    client.prefix[client.prefix_size++] = '\r';
+                    client.prefix[client.prefix_size++] = '\n';
+                }
+                client.sent = 0;
+            }
+            const IOBuffer buffers[3] {
+                {client.prefix, client.prefix_size},
+                {&_ring[size_t(client.position % size)], client.chunk_packets * PKT_SIZE},
+                {"\r\n", size_t(client.chunked ? 2 : 0)}
+            };
+            if (!sendBuffers(client, buffers, 3)) {
+                break;
+            }
+            client.position += client.chunk_packets;
+            client.chunk_packets = 0;
+            client.sent = 0;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Send a list of buffers, starting at offset client.sent, without blocking.
+//----------------------------------------------------------------------------
+
+bool ts::HTTPStreamServer::sendBuffers(Client& client, const IOBuffer* buffers, size_t count)
+{
+    // Build the vector of data which remain to be sent.
+#if defined(TS_WINDOWS)
+    ::WSABUF vec[4];
+#else
+    ::iovec vec[4];
+#endif
+    assert(count <= 4);
+    size_t skip = client.sent;
+    size_t total = 0;
+    size_t vcount = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t size = buffers[i].size;
+        total += size;
+        if (skip >= size) {
+            skip -= size;
+        }
+        else {
+            char* data = reinterpret_cast<char*>(const_cast<void*>(buffers[i].data)) + skip;
+#if defined(TS_WINDOWS)
+            vec[vcount].buf = data;
+            vec[vcount].len = ::ULONG(size - skip);
+#else
+            vec[vcount].iov_base = data;
+            vec[vcount].iov_len = size - skip;
+#endif
+            vcount++;
+            skip = 0;
+        }
+    }
+
+    // Send as much as possible in one system call.
+    while (vcount > 0) {
+#if defined(TS_WINDOWS)
+        ::DWORD gone = 0;
+        const bool success = ::WSASend(client.conn.getSocket(), vec, ::DWORD(vcount), &gone, 0, nullptr, nullptr) == 0;
+#else
+        ::msghdr msg;
+        TS_ZERO(msg);
+        msg.msg_iov = vec;
+        msg.msg_iovlen = vcount;
+        const TS_SOCKET_SSIZE_T gone = ::sendmsg(client.conn.getSocket(), &msg, SEND_FLAGS);
+        const bool success = gone >= 0;
+#endif
+        if (success) {
+            client.sent += size_t(gone);
+            break;
+        }
+        const SocketErrorCode code = LastSocketErrorCode();
+        if (WouldBlock(code)) {
+            break;
+        }
+        else if (!Interrupted(code)) {
+            if (code != TS_SOCKET_ERR_RESET) {
+                _report->debug(u"error sending to HTTP client %s: %s", {client.address, SocketErrorCodeMessage(code)});
+            }
+            client.closing = true;
+            return false;
+        }
+    }
+
+    // Wait for the socket to be writable when the data were not completely sent.
+    client.want_write = client.sent < total;
+    return !client.want_write;
+}
+
+
+//----------------------------------------------------------------------------
+// Maximum number of packets a live client may lag behind.
+//----------------------------------------------------------------------------
+
+size_t ts::HTTPStreamServer::maxLag() const
+{
+    return _args.max_lag == 0 || _args.max_lag > _ring.size() ? _ring.size() : _args.max_lag;
+}
@@ -0,0 +1,277 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  HTTP server for live transport streams and in-memory HLS.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSPacket.h"
+#include "tsTCPServer.h"
+#include "tsTCPConnection.h"
+#include "tsByteBlock.h"
+#include "tshlsPlayList.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+
+namespace ts {
+    //!
+    //! HTTP server for live transport streams and in-memory HLS.
+    //! @ingroup net
+    //!
+    //! The server runs in its own thread. All client connections are handled in
+    //! one event loop with non-blocking sockets (epoll on Linux, poll() on other
+    //! systems). The application pushes TS packets using addPackets().
+    //!
+    //! The live transport stream is stored once in a ring buffer which is shared
+    //! by all clients. Each client has its own position in the ring buffer and
+    //! the data are sent directly from the ring buffer, without per-client copy.
+    //! The data are sent without holding the lock of the server. The packets which
+    //! are being sent are never overwritten, addPackets() waits for them if necessary.
+    //!
+    //! By default, the server is meant for live streams: addPackets() never waits for
+    //! the clients and a client which lags too far behind the live point (typically
+    //! because of a slow network) is disconnected. With the option @a wait_clients,
+    //! addPackets() waits for the slowest client instead. This is the way to serve
+    //! an offline input such as a file, which is read faster than the clients can receive.
+    //!
+    //! When HLS is enabled, the stream is also cut into media segments which
+    //! are kept in memory. Segments and playlist are shared by all clients.
+    //! Segments are cut on random access points after the target duration.
+    //!
+    //! Served URL paths:
+    //! - @c / or @c /stream.ts : live transport stream. The chunked transfer encoding
+    //!   is used with HTTP/1.1 clients. With HTTP/1.0 clients, the stream is sent raw.
+    //! - @c /stream.m3u8 : HLS media playlist (when HLS is enabled).
+    //! - @c /segment-N.ts : HLS media segment number N (when HLS is enabled).
+    //!
+    class TSDUCKDLL HTTPStreamServer: private Thread
+    {
+        TS_NOCOPY(HTTPStreamServer);
+    public:
+        static constexpr size_t DEFAULT_BUFFER_PACKETS = 50000;  //!< Default size in packets of the ring buffer.
+        static constexpr size_t DEFAULT_MAX_CLIENTS = 100;       //!< Default maximum number of simultaneous clients.
+        static constexpr Second DEFAULT_HLS_DURATION = 5;        //!< Default target duration of HLS segments.
+        static constexpr size_t DEFAULT_HLS_LIVE = 5;            //!< Default number of HLS segments in the playlist.
+
+        //!
+        //! Server parameters.
+        //!
+        class TSDUCKDLL Args
+        {
+        public:
+            //!
+            //! Constructor.
+            //!
+            Args();
+
+            SocketAddress local_address;     //!< Local socket address to listen to. The port is mandatory.
+            size_t        buffer_packets;    //!< Size in packets of the ring buffer which is shared by all clients.
+            size_t        max_clients;       //!< Maximum number of simultaneous clients.
+            size_t        max_lag;           //!< Maximum number of packets a live client may lag behind, zero means the ring buffer size.
+            size_t        send_buffer_size;  //!< Socket send buffer size of each client, zero means system default.
+            bool          wait_clients;      //!< Wait for the slowest client in addPackets() instead of disconnecting it.
+            bool          hls;               //!< Enable in-memory HLS.
+            Second        hls_duration;      //!< Target duration of HLS segments.
+            size_t        hls_live;          //!< Number of HLS segments in the playlist.
+        };
+
+        //!
+        //! Constructor.
+        //!
+        HTTPStreamServer();
+
+        //!
+        //! Destructor.
+        //!
+        virtual ~HTTPStreamServer() override;
+
+        //!
+        //! Open the server and start the server thread.
+        //! @param [in] args Server parameters.
+        //! @param [in,out] report Where to report errors. Messages are also reported from
+        //! the server thread, the report object shall be thread-safe and shall remain valid
+        //! until the server is closed.
+        //! @return True on success, false on error.
+        //!
+        bool open(const Args& args, Report& report);
+
+        //!
+        //! Close the server, disconnect all clients and stop the server thread.
+        //!
+        void close();
+
+        //!
+        //! Check if the server is open.
+        //! @return True if the server is open.
+        //!
+        bool isOpen() const { return _server.isOpen(); }
+
+        //!
+        //! Get the local socket address of the server.
+        //! This is useful when the server was opened on a port which was dynamically allocated by the system.
+        //! @param [out] addr Local socket address of the server.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool getLocalAddress(SocketAddress& addr, Report& report) { return _server.getLocalAddress(addr, report); }
+
+        //!
+        //! Add TS packets to the live stream.
+        //! @param [in] packets Address of the packets.
+        //! @param [in] count Number of packets.
+        //! @param [in] bitrate Current bitrate of the stream, if known. It is used to
+        //! estimate the duration of HLS segments when the stream has no PCR.
+        //! This method waits when the ring buffer has no room for the packets, without overwriting
+        //! packets which are being sent or, with the option @a wait_clients, packets which were not
+        //! yet sent to the slowest client.
+        //!
+        void addPackets(const TSPacket* packets, size_t count, BitRate bitrate = 0);
+
+        //!
+        //! Get the number of currently connected clients.
+        //! @return The number of currently connected clients.
+        //!
+        size_t clientCount() const;
+
+    private:
+        // State of a client connection.
+        enum ClientState {
+            READ_REQUEST,   // Receiving an HTTP request.
+            SEND_RESPONSE,  // Sending a response with a fixed content.
+            SEND_STREAM,    // Sending the live stream.
+        };
+
+        // Description of a client connection.
+        class Client
+        {
+            TS_NOCOPY(Client);
+        public:
+            Client();
+            TCPConnection   conn;           // Client connection.
+            SocketAddress   address;        // Client address.
+            ClientState     state;          // Connection state.
+            bool            closing;        // Close the connection as soon as possible.
+            bool            keep_alive;     // Keep the connection open after the response.
+            bool            chunked;        // Use chunked transfer encoding for the live stream.
+            bool            want_write;     // Waiting for the socket to be writable.
+            bool            poll_write;     // Currently polling for the socket to be writable.
+            bool            readable;       // Socket is readable in this iteration of the event loop.
+            bool            writable;       // Socket is writable in this iteration of the event loop.
+            std::string     request;        // Received request data, not yet processed.
+            std::string     header;         // Response header being sent.
+            ByteBlockPtrMT  body;           // Response body (shared, may be null).
+            size_t          sent;           // Bytes already sent in current response or chunk.
+            PacketCounter   position;       // Index of next packet to send in the live stream.
+            PacketCounter   stream_end;     // End of the live stream which can be sent in the current iteration.
+            size_t          chunk_packets;  // Number of packets in current chunk, zero if none.
+            char            prefix[16];     // Chunk size line.
+            size_t          prefix_size;    // Chunk size line size.
+        };
+
+        // Description of an HLS segment in memory.
+        struct Segment
+        {
+            size_t         sequence;  // Media sequence number.
+            ByteBlockPtrMT data;      // Segment content.
+        };
+
+        // Description of a data buffer to send.
+        struct IOBuffer
+        {
+            const void* data;
+            size_t      size;
+        };
+
+        Report*                _report;         // Where to report messages.
+        Args                   _args;           // Server parameters.
+        TCPServer              _server;         // Listening socket.
+        mutable Mutex          _mutex;          // Protect all fields below, except segment building.
+        Condition              _room;           // Signaled when packets were sent from the ring buffer.
+        volatile bool          _terminate;      // Request the server thread to terminate.
+        std::vector<TSPacket>  _ring;           // Ring buffer of live packets.
+        PacketCounter          _write_count;    // Total number of packets written in the ring buffer.
+        std::list<Client>      _clients;        // All client connections, modified in the server thread only.
+        bool                   _sending;        // The server thread is sending data without lock.
+        bool                   _stream_clients; // There are clients of the live stream.
+        PacketCounter          _read_floor;     // Oldest packet which remains to be sent to a client of the live stream.
+        bool                   _wake_on_data;   // The server thread must be woken up when packets are added.
+        std::deque<Segment>    _segments;       // Available HLS segments.
+        hls::PlayList          _playlist;       // HLS playlist.
+        ByteBlockPtrMT         _playlist_data;  // HLS playlist content.
+        Second                 _max_duration;   // Longest HLS segment duration.
+        // HLS segment being built, in the application thread, without lock.
+        ByteBlockPtrMT         _seg_data;       // Current segment content.
+        PacketCounter          _seg_packets;    // Number of packets in current segment.
+        size_t                 _seg_sequence;   // Sequence number of current segment.
+        PID                    _pcr_pid;        // Reference PID for PCR.
+        uint64_t               _seg_first_pcr;  // First PCR in current segment.
+        uint64_t               _seg_last_pcr;   // Last PCR in current segment.
+#if defined(TS_LINUX)
+        int                    _epoll_fd;       // Event loop.
+#endif
+#if defined(TS_UNIX)
+        int                    _wakeup_fds[2];  // Pipe to wake up the event loop.
+#endif
+
+        // Implementation of Thread.
+        virtual void main() override;
+
+        // Event loop primitives, platform-specific.
+        bool openEvents();
+        void closeEvents();
+        void addEvents(Client& client);
+        void updateEvents(Client& client);
+        void removeEvents(Client& client);
+        void waitEvents(bool& accept, bool immediate);
+        void wakeUp();
+
+        // Client management, in the server thread, without the mutex.
+        void acceptClients(std::list<Client>& clients);
+        void receiveData(Client& client);
+        void sendData(Client& client);
+        bool sendBuffers(Client& client, const IOBuffer* buffers, size_t count);
+
+        // Client management, in the server thread, with the mutex held.
+        void closeClient(Client& client);
+        void processRequest(Client& client);
+        void setResponse(Client& client, int status, const UString& reason, const ByteBlockPtrMT& body, bool head, const UString& type = UString());
+        void updateReadFloor();
+
+        // Ring buffer management, with the mutex held.
+        size_t maxLag() const;
+        size_t writeRoom() const;
+
+        // HLS segments, in the application thread.
+        MilliSecond segmentDuration(BitRate bitrate) const;
+        void closeSegment(MilliSecond duration, BitRate bitrate);
+    };
+}
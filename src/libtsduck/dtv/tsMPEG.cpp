@@ -37,7 +37,7 @@ TSDUCK_SOURCE;
 
 //----------------------------------------------------------------------------
 // These PID sets respectively contains no PID and all PID's.
-// The default constructor for PIDSet (std::bitset) sets all bits to 0.
+// The default constructor for PIDSet (BitSet) sets all bits to 0.
 //----------------------------------------------------------------------------
 
 const ts::PIDSet ts::NoPID;
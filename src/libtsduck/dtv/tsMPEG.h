@@ -36,6 +36,7 @@
 #pragma once
 #include "tsPlatform.h"
 #include "tsEnumeration.h"
+#include "tsBitSet.h"
 
 namespace ts {
 
@@ -191,7 +192,7 @@ namespace ts {
     //! A bit mask for PID values.
     //! Useful to implement PID filtering.
     //!
-    typedef std::bitset <PID_MAX> PIDSet;
+    typedef BitSet<PID_MAX> PIDSet;
 
     //!
     //! PIDSet constant with no PID set.
@@ -1410,6 +1411,7 @@ namespace ts {
         SCRAMBLING_USER_MIN      = 0x80, //!< First user-defined value.
         SCRAMBLING_DUCK_AES_CBC  = 0xF0, //!< TSDuck-defined value, AES-CBC (with externally-defined IV).
         SCRAMBLING_DUCK_AES_CTR  = 0xF1, //!< TSDuck-defined value, AES-CTR (with externally-defined IV).
+        SCRAMBLING_DUCK_SCTE52   = 0xF2, //!< TSDuck-defined value, DES in ANSI/SCTE 52 mode (with externally-defined IV).
         SCRAMBLING_USER_MAX      = 0xFE, //!< Last user-defined value.
         SCRAMBLING_RESERVED      = 0xFF, //!< Reserved value.
     };
@@ -37,6 +37,12 @@
 #include "tsPMT.h"
 TSDUCK_SOURCE;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::PESDemux::SMALL_BUFFER_SIZE;
+constexpr size_t ts::PESDemux::LARGE_BUFFER_SIZE;
+constexpr size_t ts::PESDemux::MAX_POOLED_BUFFERS;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Delimiters
@@ -61,7 +67,10 @@ ts::PESDemux::PESDemux(DuckContext& duck, PESHandlerInterface* pes_handler, cons
     _pes_handler(pes_handler),
     _pids(),
     _stream_types(),
-    _section_demux(_duck, this)
+    _buffers(),
+    _section_demux(_duck, this),
+    _sample_rate(0),
+    _sampled_count(0)
 {
     // Analyze the PAT, to get the PMT's, to get the stream types.
     _section_demux.addPID(PID_PAT);
@@ -87,12 +96,13 @@ ts::PESDemux::PIDContext::PIDContext() :
     sync(false),
     first_pkt(0),
     last_pkt(0),
-    ts(new ByteBlock()),
+    ts(),
     audio(),
     video(),
     avc(),
     ac3(),
-    ac3_count(0)
+    ac3_count(0),
+    sample_idx(0)
 {
 }
 
@@ -104,7 +114,9 @@ ts::PESDemux::PIDContext::PIDContext() :
 void ts::PESDemux::immediateReset()
 {
     SuperClass::immediateReset();
-    _pids.clear();
+    while (!_pids.empty()) {
+        erasePIDContext(_pids.begin());
+    }
     _stream_types.clear();
 
     // Reset the section demux back to initial state (intercepting the PAT).
@@ -115,11 +127,65 @@ void ts::PESDemux::immediateReset()
 void ts::PESDemux::immediateResetPID(PID pid)
 {
     SuperClass::immediateResetPID(pid);
-    _pids.erase(pid);
+    const PIDContextMap::iterator it = _pids.find(pid);
+    if (it != _pids.end()) {
+        erasePIDContext(it);
+    }
     _stream_types.erase(pid);
 }
 
 
+//----------------------------------------------------------------------------
+// Reassembly buffer pool.
+//----------------------------------------------------------------------------
+
+ts::ByteBlockPtr ts::PESDemux::getBuffer(size_t capacity)
+{
+    // Reuse the smallest free buffer which is large enough.
+    const BufferPool::iterator it = _buffers.lower_bound(capacity);
+    if (it != _buffers.end()) {
+        assert(!it->second.empty());
+        ByteBlockPtr buffer(it->second.back());
+        it->second.pop_back();
+        if (it->second.empty()) {
+            _buffers.erase(it);
+        }
+        return buffer;
+    }
+
+    // Allocate a new buffer in the corresponding size class.
+    size_t size = SMALL_BUFFER_SIZE;
+    if (capacity > SMALL_BUFFER_SIZE) {
+        size = LARGE_BUFFER_SIZE;
+        while (size < capacity) {
+            size *= 2;
+        }
+    }
+    ByteBlockPtr buffer(new ByteBlock());
+    buffer->reserve(size);
+    return buffer;
+}
+
+void ts::PESDemux::recycleBuffer(ByteBlockPtr& buffer)
+{
+    // A buffer which is still referenced by a PES packet outside the demux is not recycled.
+    if (!buffer.isNull() && buffer.count() == 1 && buffer->capacity() >= SMALL_BUFFER_SIZE) {
+        std::vector<ByteBlockPtr>& pool(_buffers[buffer->capacity()]);
+        if (pool.size() < MAX_POOLED_BUFFERS) {
+            buffer->clear();
+            pool.push_back(buffer);
+        }
+    }
+    buffer.clear();
+}
+
+void ts::PESDemux::erasePIDContext(PIDContextMap::iterator it)
+{
+    recycleBuffer(it->second.ts);
+    _pids.erase(it);
+}
+
+
 //----------------------------------------------------------------------------
 // Get current audio/video attributes on the specified PID.
 // Check isValid() on returned object.
@@ -225,7 +291,7 @@ void ts::PESDemux::processPacket(const TSPacket& pkt)
     // for a while => release context.
     if (pkt.getScrambling() != SC_CLEAR) {
         if (pc_exists) {
-            _pids.erase(pid);
+            erasePIDContext(pci);
         }
         return;
     }
@@ -241,6 +307,18 @@ void ts::PESDemux::processPacket(const TSPacket& pkt)
         if (pl_size >= 3 && pl[0] == 0 && pl[1] == 0 && pl[2] == 1) {
             // We are at the beginning of a PES packet. Create context if non existent.
             PIDContext& pc(_pids[pid]);
+            if (pc.ts.isNull()) {
+                pc.ts = getBuffer(SMALL_BUFFER_SIZE);
+            }
+            // In sampling mode, skip most PES packets on this PID.
+            if (_sample_rate <= 1) {
+                pc.sample_idx = 0;
+            }
+            else if (pc.sample_idx++ % _sample_rate != 0) {
+                pc.syncLost();
+                _sampled_count++;
+                return;
+            }
             pc.continuity = pkt.getCC();
             pc.sync = true;
             pc.ts->copy(pl, pl_size);
@@ -249,7 +327,7 @@ void ts::PESDemux::processPacket(const TSPacket& pkt)
         }
         else if (pc_exists) {
             // This PID does not contain PES packet, reset context
-            _pids.erase(pid);
+            erasePIDContext(pci);
         }
         // PUSI packet processing done.
         return;
@@ -275,22 +353,13 @@ void ts::PESDemux::processPacket(const TSPacket& pkt)
     pc.continuity = pkt.getCC();
 
     // Append the TS payload in PID context.
-    size_t capacity = pc.ts->capacity();
-    if (pc.ts->size() + pl_size > capacity) {
+    if (pc.ts->size() + pl_size > pc.ts->capacity()) {
         // Internal reallocation needed in ts buffer.
-        // Do not allow implicit reallocation, do it manually for better performance.
-        // Use two predefined thresholds: 64 kB and 512 kB. Above that, double the size.
-        // Note that 64 kB is OK for audio PIDs. Video PIDs are usually unbounded. The
-        // maximum observed PES rate is 2 PES/s, meaning 512 kB / PES at 8 Mb/s.
-        if (capacity < 64 * 1024) {
-            pc.ts->reserve(64 * 1024);
-        }
-        else if (capacity < 512 * 1024) {
-            pc.ts->reserve(512 * 1024);
-        }
-        else {
-            pc.ts->reserve(2 * capacity);
-        }
+        // Do not allow implicit reallocation, move to a larger buffer from the pool.
+        ByteBlockPtr buffer(getBuffer(std::max(pc.ts->size() + pl_size, 2 * pc.ts->capacity())));
+        buffer->copy(pc.ts->data(), pc.ts->size());
+        recycleBuffer(pc.ts);
+        pc.ts = buffer;
     }
     pc.ts->append(pl, pl_size);
 
@@ -519,6 +588,12 @@ void ts::PESDemux::processPESPacket(PID pid, PIDContext& pc)
                 _pes_handler->handleNewAudioAttributes(*this, pp, pc.audio);
             }
         }
+
+        // If a handler kept a shared copy of the PES packet, the buffer now belongs to it.
+        // Use another buffer for the next PES packet in this PID.
+        if (pc.ts.count() > 2) {
+            pc.ts = getBuffer(SMALL_BUFFER_SIZE);
+        }
     }
     catch (...) {
         afterCallingHandler(false);
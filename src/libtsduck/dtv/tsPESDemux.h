@@ -124,6 +124,21 @@ namespace ts {
         //!
         bool allAC3(PID) const;
 
+        //!
+        //! Set the sampling rate of the demux.
+        //! In sampling mode, typically when the processing chain is overloaded,
+        //! only one PES packet out of @a rate is reassembled on each PID.
+        //! The TS packets of the other PES packets are ignored.
+        //! @param [in] rate Sampling rate. Zero or one means no sampling.
+        //!
+        void setSampling(size_t rate) { _sample_rate = rate; }
+
+        //!
+        //! Get the number of PES packets which were skipped in sampling mode.
+        //! @return The number of skipped PES packets.
+        //!
+        PacketCounter sampledCount() const { return _sampled_count; }
+
     protected:
         //!
         //! This hook is invoked when a complete PES packet is available.
@@ -145,12 +160,13 @@ namespace ts {
             bool            sync;        // We are synchronous in this PID
             PacketCounter   first_pkt;   // Index of first TS packet for current PES packet
             PacketCounter   last_pkt;    // Index of last TS packet for current PES packet
-            ByteBlockPtr    ts;          // TS payload buffer
+            ByteBlockPtr    ts;          // TS payload buffer, from the buffer pool
             AudioAttributes audio;       // Current audio attributes
             VideoAttributes video;       // Current video attributes (MPEG-1, MPEG-2)
             AVCAttributes   avc;         // Current AVC attributes
             AC3Attributes   ac3;         // Current AC-3 attributes
             PacketCounter   ac3_count;   // Number of PES packets with contents which looks like AC-3
+            size_t          sample_idx;  // Index of PES packet in current sampling period
 
             // Default constructor:
             PIDContext();
@@ -167,6 +183,28 @@ namespace ts {
         // All known PID's are referenced here, not only demuxed PES PID's.
         typedef std::map<PID,uint8_t> StreamTypeMap;
 
+        // Pool of free reassembly buffers, indexed by capacity.
+        typedef std::map<size_t,std::vector<ByteBlockPtr>> BufferPool;
+
+        // Size classes of reassembly buffers.
+        // Note that 64 kB is OK for audio PIDs. Video PIDs are usually unbounded. The
+        // maximum observed PES rate is 2 PES/s, meaning 512 kB / PES at 8 Mb/s.
+        // Above 512 kB, the size classes are powers of 2.
+        static constexpr size_t SMALL_BUFFER_SIZE = 64 * 1024;
+        static constexpr size_t LARGE_BUFFER_SIZE = 512 * 1024;
+
+        // Maximum number of free buffers of the same capacity in the pool.
+        static constexpr size_t MAX_POOLED_BUFFERS = 16;
+
+        // Get an empty buffer with at least the specified capacity.
+        ByteBlockPtr getBuffer(size_t capacity);
+
+        // Recycle a buffer in the pool. The buffer is cleared.
+        void recycleBuffer(ByteBlockPtr& buffer);
+
+        // Erase a PID context, recycling its buffer.
+        void erasePIDContext(PIDContextMap::iterator it);
+
         // Feed the demux with a TS packet (PID already filtered).
         void processPacket(const TSPacket&);
 
@@ -180,6 +218,9 @@ namespace ts {
         PESHandlerInterface* _pes_handler;
         PIDContextMap        _pids;
         StreamTypeMap        _stream_types;
+        BufferPool           _buffers;
         SectionDemux         _section_demux;
+        size_t               _sample_rate;    // Reassemble one PES packet out of this in sampling mode.
+        PacketCounter        _sampled_count;  // Number of PES packets skipped in sampling mode.
     };
 }
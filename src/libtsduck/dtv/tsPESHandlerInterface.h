@@ -53,6 +53,13 @@ namespace ts {
     public:
         //!
         //! This hook is invoked when a complete PES packet is available.
+        //!
+        //! The content of @a packet is not copied, it remains in a reassembly buffer of the
+        //! demux which is reused after the handler returns. To keep the PES packet after
+        //! returning, the handler shall create a copy of @a packet in ts::SHARE mode (or assign
+        //! it to another PESPacket object). The demux detects it and leaves the buffer to the
+        //! copy, without copying the data.
+        //!
         //! @param [in,out] demux A reference to the PES demux.
         //! @param [in] packet The demultiplexed PES packet.
         //!
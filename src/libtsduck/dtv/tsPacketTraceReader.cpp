@@ -0,0 +1,277 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsPacketTraceReader.h"
+#include "tsCRC32.h"
+#include "tsMemory.h"
+TSDUCK_SOURCE;
+
+// Read a variable length integer, update data pointer, return false on error.
+namespace {
+    bool GetVarint(const uint8_t*& data, const uint8_t* end, uint64_t& value)
+    {
+        value = 0;
+        for (size_t shift = 0; data < end && shift < 64; shift += 7) {
+            const uint8_t b = *data++;
+            value |= uint64_t(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Constructor.
+//----------------------------------------------------------------------------
+
+ts::PacketTraceReader::PacketTraceReader() :
+    _filename(),
+    _file(),
+    _error(false),
+    _names(),
+    _indexes(),
+    _rows(),
+    _next(0),
+    _data()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Open a packet trace file and read its header.
+//----------------------------------------------------------------------------
+
+bool ts::PacketTraceReader::open(const UString& filename, Report& report)
+{
+    if (_file.is_open()) {
+        report.error(u"%s is already open", {_filename});
+        return false;
+    }
+
+    _filename = filename;
+    _error = false;
+    _names.clear();
+    _indexes.clear();
+    _rows.clear();
+    _next = 0;
+
+    _file.open(filename.toUTF8().c_str(), std::ios::in | std::ios::binary);
+    if (!_file) {
+        report.error(u"error opening %s", {filename});
+        return false;
+    }
+
+    // Read fixed part of header.
+    uint8_t header[8];
+    if (!readData(header, sizeof(header), false, report)) {
+        close();
+        return false;
+    }
+    if (GetUInt32(header) != PacketTraceRecord::FILE_MAGIC) {
+        report.error(u"%s is not a packet trace file", {filename});
+        close();
+        return false;
+    }
+    if (GetUInt16(header + 4) > PacketTraceRecord::FORMAT_VERSION) {
+        report.error(u"%s: unsupported packet trace format version %d", {filename, GetUInt16(header + 4)});
+        close();
+        return false;
+    }
+
+    // Read column descriptions, map them by name.
+    // The number of columns bounds the size of the blocks, check it before reading any block.
+    const size_t count = GetUInt16(header + 6);
+    if (count > PacketTraceRecord::MAX_COLUMNS) {
+        report.error(u"%s: invalid packet trace file, %d columns", {filename, count});
+        close();
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t len = 0;
+        uint8_t encoding = 0;
+        std::string name;
+        if (!readData(&len, 1, false, report)) {
+            close();
+            return false;
+        }
+        name.resize(len);
+        if ((len > 0 && !readData(&name[0], len, false, report)) || !readData(&encoding, 1, false, report)) {
+            close();
+            return false;
+        }
+        if (encoding != PacketTraceRecord::ENCODING_DELTA_VARINT) {
+            report.error(u"%s: unsupported encoding %d for column %s", {filename, encoding, name});
+            close();
+            return false;
+        }
+        size_t index = 0;
+        while (index < PacketTraceRecord::COLUMN_COUNT && PacketTraceRecord::ColumnName(index) != name) {
+            ++index;
+        }
+        _names.push_back(UString::FromUTF8(name));
+        _indexes.push_back(index);
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Close the file.
+//----------------------------------------------------------------------------
+
+void ts::PacketTraceReader::close()
+{
+    if (_file.is_open()) {
+        _file.close();
+    }
+    _rows.clear();
+    _next = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Read the next row from the file.
+//----------------------------------------------------------------------------
+
+bool ts::PacketTraceReader::read(PacketTraceRecord& rec, Report& report)
+{
+    while (_next >= _rows.size()) {
+        if (!readBlock(report)) {
+            return false;
+        }
+    }
+    rec = _rows[_next++];
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Read all remaining rows from the file.
+//----------------------------------------------------------------------------
+
+bool ts::PacketTraceReader::readAll(PacketTraceRecordVector& rows, Report& report)
+{
+    rows.clear();
+    PacketTraceRecord rec;
+    while (read(rec, report)) {
+        rows.push_back(rec);
+    }
+    return !_error;
+}
+
+
+//----------------------------------------------------------------------------
+// Read and decode the next block.
+//----------------------------------------------------------------------------
+
+bool ts::PacketTraceReader::readBlock(Report& report)
+{
+    _rows.clear();
+    _next = 0;
+
+    // Read block header.
+    uint8_t header[8];
+    if (_error || !_file.is_open() || !readData(header, sizeof(header), true, report)) {
+        return false;
+    }
+    const size_t row_count = GetUInt32(header);
+    const size_t data_size = GetUInt32(header + 4);
+
+    // Check the block size before allocating memory. Each column has a size and one value per row.
+    if (row_count > PacketTraceRecord::MAX_BLOCK_ROWS || data_size > _indexes.size() * (row_count + 1) * PacketTraceRecord::MAX_VARINT_SIZE) {
+        report.error(u"%s: invalid packet trace block, %'d rows, %'d bytes", {_filename, row_count, data_size});
+        _error = true;
+        return false;
+    }
+
+    // Read block data and CRC.
+    _data.resize(data_size + 4);
+    if (!readData(_data.data(), _data.size(), false, report)) {
+        return false;
+    }
+    if (CRC32(_data.data(), data_size).value() != GetUInt32(_data.data() + data_size)) {
+        report.error(u"%s: CRC error in packet trace block", {_filename});
+        _error = true;
+        return false;
+    }
+
+    // Decode all columns.
+    _rows.resize(row_count);
+    const uint8_t* data = _data.data();
+    const uint8_t* const end = data + data_size;
+    for (size_t col = 0; col < _indexes.size(); ++col) {
+        uint64_t col_size = 0;
+        if (!GetVarint(data, end, col_size) || col_size > uint64_t(end - data)) {
+            report.error(u"%s: invalid packet trace block", {_filename});
+            _error = true;
+            return false;
+        }
+        const uint8_t* const col_end = data + col_size;
+        if (_indexes[col] < PacketTraceRecord::COLUMN_COUNT) {
+            uint64_t value = 0;
+            for (size_t row = 0; row < row_count; ++row) {
+                uint64_t zz = 0;
+                if (!GetVarint(data, col_end, zz)) {
+                    report.error(u"%s: truncated column %s in packet trace block", {_filename, _names[col]});
+                    _error = true;
+                    return false;
+                }
+                value += (zz >> 1) ^ (~(zz & 1) + 1);
+                _rows[row].setColumn(_indexes[col], value);
+            }
+        }
+        data = col_end;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Read raw data from the file.
+//----------------------------------------------------------------------------
+
+bool ts::PacketTraceReader::readData(void* data, size_t size, bool eof_ok, Report& report)
+{
+    _file.read(reinterpret_cast<char*>(data), std::streamsize(size));
+    const size_t got = size_t(_file.gcount());
+    if (got == size) {
+        return true;
+    }
+    else if (got == 0 && eof_ok && _file.eof()) {
+        return false;
+    }
+    else {
+        report.error(u"%s: truncated packet trace file", {_filename});
+        _error = true;
+        return false;
+    }
+}
@@ -0,0 +1,109 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Reader of binary packet trace files.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsPacketTraceRecord.h"
+#include "tsByteBlock.h"
+#include "tsReport.h"
+
+namespace ts {
+    //!
+    //! Reader of binary packet trace files.
+    //! @ingroup mpeg
+    //! @see PacketTraceRecord for the file format.
+    //!
+    class TSDUCKDLL PacketTraceReader
+    {
+        TS_NOCOPY(PacketTraceReader);
+    public:
+        //!
+        //! Constructor.
+        //!
+        PacketTraceReader();
+
+        //!
+        //! Open a packet trace file and read its header.
+        //! @param [in] filename File name.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool open(const UString& filename, Report& report);
+
+        //!
+        //! Check if the file is open.
+        //! @return True if the file is open.
+        //!
+        bool isOpen() const { return _file.is_open(); }
+
+        //!
+        //! Read the next row from the file.
+        //! @param [out] rec Returned row.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on end of file or error.
+        //!
+        bool read(PacketTraceRecord& rec, Report& report);
+
+        //!
+        //! Read all remaining rows from the file.
+        //! @param [out] rows Returned rows.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success (end of file reached), false on error.
+        //!
+        bool readAll(PacketTraceRecordVector& rows, Report& report);
+
+        //!
+        //! Close the file.
+        //!
+        void close();
+
+        //!
+        //! Get the names of the columns in the file, in file order.
+        //! @return A constant reference to the column names.
+        //!
+        const UStringVector& columnNames() const { return _names; }
+
+    private:
+        UString                 _filename;
+        std::ifstream           _file;
+        bool                    _error;
+        UStringVector           _names;    // Column names in file.
+        std::vector<size_t>     _indexes;  // Column indexes in PacketTraceRecord, COLUMN_COUNT if unknown.
+        PacketTraceRecordVector _rows;     // Rows in current block.
+        size_t                  _next;     // Index of next row to return in _rows.
+        ByteBlock               _data;
+
+        bool readData(void* data, size_t size, bool eof_ok, Report& report);
+        bool readBlock(Report& report);
+    };
+}
@@ -0,0 +1,113 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsPacketTraceRecord.h"
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr uint32_t ts::PacketTraceRecord::FILE_MAGIC;
+constexpr uint16_t ts::PacketTraceRecord::FORMAT_VERSION;
+constexpr uint8_t ts::PacketTraceRecord::ENCODING_DELTA_VARINT;
+constexpr size_t ts::PacketTraceRecord::COLUMN_COUNT;
+constexpr size_t ts::PacketTraceRecord::MAX_COLUMNS;
+constexpr size_t ts::PacketTraceRecord::MAX_BLOCK_ROWS;
+constexpr size_t ts::PacketTraceRecord::MAX_VARINT_SIZE;
+#endif
+
+// Column names, in order of columns.
+namespace {
+    const char* const ColumnNames[ts::PacketTraceRecord::COLUMN_COUNT] = {
+        "packet", "pid", "event", "flags", "value", "pcr", "extra"
+    };
+}
+
+
+//----------------------------------------------------------------------------
+// Constructor and clear.
+//----------------------------------------------------------------------------
+
+ts::PacketTraceRecord::PacketTraceRecord() :
+    packet(0),
+    pid(PID_NULL),
+    event(NONE),
+    flags(0),
+    value(0),
+    pcr(INVALID_PCR),
+    extra(0)
+{
+}
+
+void ts::PacketTraceRecord::clear()
+{
+    packet = 0;
+    pid = PID_NULL;
+    event = NONE;
+    flags = 0;
+    value = 0;
+    pcr = INVALID_PCR;
+    extra = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Access rows by column index.
+//----------------------------------------------------------------------------
+
+std::string ts::PacketTraceRecord::ColumnName(size_t index)
+{
+    return index < COLUMN_COUNT ? ColumnNames[index] : "";
+}
+
+uint64_t ts::PacketTraceRecord::getColumn(size_t index) const
+{
+    switch (index) {
+        case 0: return packet;
+        case 1: return pid;
+        case 2: return event;
+        case 3: return flags;
+        case 4: return value;
+        case 5: return pcr;
+        case 6: return extra;
+        default: return 0;
+    }
+}
+
+void ts::PacketTraceRecord::setColumn(size_t index, uint64_t val)
+{
+    switch (index) {
+        case 0: packet = val; break;
+        case 1: pid = PID(val); break;
+        case 2: event = uint8_t(val); break;
+        case 3: flags = uint16_t(val); break;
+        case 4: value = val; break;
+        case 5: pcr = val; break;
+        case 6: extra = val; break;
+        default: break;
+    }
+}
@@ -0,0 +1,174 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  One row of a binary packet trace file.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsMPEG.h"
+
+namespace ts {
+    //!
+    //! One row of a binary packet trace file.
+    //! @ingroup mpeg
+    //!
+    //! A packet trace file is a compact columnar binary file which contains a sequence
+    //! of events on a transport stream, typically time stamps or major events, for offline
+    //! analysis. Each row is one event. Each field of the row is one column in the file.
+    //!
+    //! File format (all integers in big endian):
+    //! - File header: 32-bit magic number @c FILE_MAGIC, 16-bit format version, 16-bit number
+    //!   of columns (at most @c MAX_COLUMNS), then, for each column, 8-bit name length, column name in ASCII and 8-bit
+    //!   encoding (always @c ENCODING_DELTA_VARINT in this version).
+    //! - A sequence of blocks. Each block contains 32-bit number of rows (at most
+    //!   @c MAX_BLOCK_ROWS), 32-bit data size, data, 32-bit MPEG CRC32 of data. The data contain all columns, one after the other.
+    //!   Each column starts with its size in bytes as a variable length integer. In a column,
+    //!   each value is stored as the difference with the previous value in the same block,
+    //!   in zigzag representation, as a variable length integer (7 bits per byte, least
+    //!   significant first, most significant bit set when more bytes follow).
+    //!
+    //! Readers map columns by name. Unknown columns are ignored and missing ones are zero.
+    //! Thus, future versions may add columns without breaking existing readers.
+    //!
+    class TSDUCKDLL PacketTraceRecord
+    {
+    public:
+        //!
+        //! Types of events.
+        //!
+        enum Event : uint8_t {
+            NONE              = 0,   //!< Not an event.
+            PCR               = 1,   //!< PCR, value = PCR.
+            OPCR              = 2,   //!< OPCR, value = OPCR.
+            PTS               = 3,   //!< PTS, value = PTS.
+            DTS               = 4,   //!< DTS, value = DTS.
+            PID_FIRST         = 16,  //!< First packet in a PID, value = scrambling control, extra = service id.
+            PID_LAST          = 17,  //!< Last packet in a PID, value = scrambling control, extra = service id.
+            PID_SUSPENDED     = 18,  //!< A PID is suspended, value = scrambling control, extra = service id.
+            PID_RESTARTED     = 19,  //!< A PID is restarted, value = scrambling control, extra = service id.
+            PID_SCRAMBLED     = 20,  //!< Clear to scrambled transition, value = scrambling control, extra = service id.
+            PID_CLEAR         = 21,  //!< Scrambled to clear transition, value = scrambling control, extra = service id.
+            CRYPTO_PERIOD     = 22,  //!< New crypto-period, value = scrambling control, extra = service id.
+            PES_STREAM_ID     = 23,  //!< New PES stream id, value = stream id, extra = service id.
+            TABLE             = 32,  //!< New table, value = table id, extra = version (8 bits) and table id extension (16 bits).
+            ECM               = 33,  //!< New ECM, value = table id, extra = service id.
+            UTC_TIME          = 34,  //!< TDT or TOT, value = time in milliseconds since 1970, extra = table id.
+        };
+
+        //!
+        //! Flags in the time stamp events.
+        //!
+        enum Flags : uint16_t {
+            GOOD_PTS      = 0x0001,  //!< The PTS is greater than the previous one in the PID.
+            EVALUATED_PCR = 0x0002,  //!< The PCR of the row is evaluated, not read from the packet.
+            SAMPLED       = 0x0004,  //!< Recorded in sampling mode, previous rows of the same type may be missing.
+        };
+
+        PacketCounter packet;  //!< Index of the packet in the transport stream.
+        PID           pid;     //!< PID of the event, PID_NULL if not associated with a PID.
+        uint8_t       event;   //!< Event type, one of Event.
+        uint16_t      flags;   //!< Event flags.
+        uint64_t      value;   //!< Main value, depends on event type.
+        uint64_t      pcr;     //!< PCR at the packet, INVALID_PCR if unknown.
+        uint64_t      extra;   //!< Additional value, depends on event type. For time stamps, index of the value in the PID.
+
+        //!
+        //! Constructor.
+        //!
+        PacketTraceRecord();
+
+        //!
+        //! Clear the content of the row.
+        //!
+        void clear();
+
+        //!
+        //! Magic number at start of a packet trace file ("TSTR").
+        //!
+        static constexpr uint32_t FILE_MAGIC = 0x54535452;
+
+        //!
+        //! Current format version of packet trace files.
+        //!
+        static constexpr uint16_t FORMAT_VERSION = 1;
+
+        //!
+        //! Column encoding: delta with previous value, zigzag, variable length.
+        //!
+        static constexpr uint8_t ENCODING_DELTA_VARINT = 1;
+
+        //!
+        //! Number of columns in a row.
+        //!
+        static constexpr size_t COLUMN_COUNT = 7;
+
+        //!
+        //! Maximum number of columns in a packet trace file, including columns from future versions.
+        //!
+        static constexpr size_t MAX_COLUMNS = 64;
+
+        //!
+        //! Maximum number of rows in a block of a packet trace file.
+        //!
+        static constexpr size_t MAX_BLOCK_ROWS = 4096;
+
+        //!
+        //! Maximum size in bytes of a variable length integer in a packet trace file.
+        //!
+        static constexpr size_t MAX_VARINT_SIZE = 10;
+
+        //!
+        //! Get the name of a column.
+        //! @param [in] index Column index, from 0 to COLUMN_COUNT-1.
+        //! @return Column name or an empty string if @a index is invalid.
+        //!
+        static std::string ColumnName(size_t index);
+
+        //!
+        //! Get the value of a column as a 64-bit integer.
+        //! @param [in] index Column index, from 0 to COLUMN_COUNT-1.
+        //! @return Column value or zero if @a index is invalid.
+        //!
+        uint64_t getColumn(size_t index) const;
+
+        //!
+        //! Set the value of a column from a 64-bit integer.
+        //! @param [in] index Column index, from 0 to COLUMN_COUNT-1.
+        //! @param [in] val Column value, truncated to the size of the field.
+        //!
+        void setColumn(size_t index, uint64_t val);
+    };
+
+    //!
+    //! Vector of packet trace rows.
+    //!
+    typedef std::vector<PacketTraceRecord> PacketTraceRecordVector;
+}
@@ -0,0 +1,195 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsPacketTraceWriter.h"
+#include "tsCRC32.h"
+#include "tsNullReport.h"
+#include "tsMemory.h"
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::PacketTraceWriter::DEFAULT_BLOCK_ROWS;
+#endif
+
+// Append a variable length integer.
+namespace {
+    void AppendVarint(ts::ByteBlock& bb, uint64_t value)
+    {
+        while (value >= 0x80) {
+            bb.appendUInt8(uint8_t(value | 0x80));
+            value >>= 7;
+        }
+        bb.appendUInt8(uint8_t(value));
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Constructor and destructor.
+//----------------------------------------------------------------------------
+
+ts::PacketTraceWriter::PacketTraceWriter(size_t block_rows) :
+    _filename(),
+    _file(),
+    _block_rows(std::max<size_t>(1, std::min(block_rows, PacketTraceRecord::MAX_BLOCK_ROWS))),
+    _row_count(0),
+    _rows(),
+    _column(),
+    _data()
+{
+}
+
+ts::PacketTraceWriter::~PacketTraceWriter()
+{
+    close(NULLREP);
+}
+
+
+//----------------------------------------------------------------------------
+// Create a packet trace file.
+//----------------------------------------------------------------------------
+
+bool ts::PacketTraceWriter::open(const UString& filename, Report& report)
+{
+    if (_file.is_open()) {
+        report.error(u"%s is already open", {_filename});
+        return false;
+    }
+
+    _filename = filename;
+    _row_count = 0;
+    _rows.clear();
+    _rows.reserve(_block_rows);
+
+    _file.open(filename.toUTF8().c_str(), std::ios::out | std::ios::binary);
+    if (!_file) {
+        report.error(u"error creating %s", {filename});
+        return false;
+    }
+
+    // Build the file header.
+    _data.clear();
+    _data.appendUInt32(PacketTraceRecord::FILE_MAGIC);
+    _data.appendUInt16(PacketTraceRecord::FORMAT_VERSION);
+    _data.appendUInt16(uint16_t(PacketTraceRecord::COLUMN_COUNT));
+    for (size_t col = 0; col < PacketTraceRecord::COLUMN_COUNT; ++col) {
+        const std::string name(PacketTraceRecord::ColumnName(col));
+        _data.appendUInt8(uint8_t(name.size()));
+        _data.append(name);
+        _data.appendUInt8(PacketTraceRecord::ENCODING_DELTA_VARINT);
+    }
+    return writeData(_data.data(), _data.size(), report);
+}
+
+
+//----------------------------------------------------------------------------
+// Write a row in the file.
+//----------------------------------------------------------------------------
+
+bool ts::PacketTraceWriter::write(const PacketTraceRecord& rec, Report& report)
+{
+    if (!_file.is_open()) {
+        report.error(u"packet trace file not open");
+        return false;
+    }
+    _rows.push_back(rec);
+    return _rows.size() < _block_rows || flush(report);
+}
+
+
+//----------------------------------------------------------------------------
+// Write the pending rows in a block.
+//----------------------------------------------------------------------------
+
+bool ts::PacketTraceWriter::flush(Report& report)
+{
+    if (!_file.is_open() || _rows.empty()) {
+        return _file.is_open();
+    }
+
+    // Build the block: header with placeholder for data size, then all columns.
+    _data.clear();
+    _data.appendUInt32(uint32_t(_rows.size()));
+    _data.appendUInt32(0);
+
+    for (size_t col = 0; col < PacketTraceRecord::COLUMN_COUNT; ++col) {
+        // Encode column values as zigzag deltas from previous value.
+        _column.clear();
+        uint64_t previous = 0;
+        for (auto it = _rows.begin(); it != _rows.end(); ++it) {
+            const uint64_t value = it->getColumn(col);
+            const int64_t delta = int64_t(value - previous);
+            AppendVarint(_column, (uint64_t(delta) << 1) ^ uint64_t(delta >> 63));
+            previous = value;
+        }
+        AppendVarint(_data, _column.size());
+        _data.append(_column);
+    }
+
+    // Complete the block with data size and CRC.
+    const size_t data_size = _data.size() - 8;
+    PutUInt32(_data.data() + 4, uint32_t(data_size));
+    _data.appendUInt32(CRC32(_data.data() + 8, data_size).value());
+
+    _row_count += _rows.size();
+    _rows.clear();
+    return writeData(_data.data(), _data.size(), report);
+}
+
+
+//----------------------------------------------------------------------------
+// Flush pending rows and close the file.
+//----------------------------------------------------------------------------
+
+bool ts::PacketTraceWriter::close(Report& report)
+{
+    bool ok = true;
+    if (_file.is_open()) {
+        ok = flush(report);
+        _file.close();
+        report.debug(u"closed %s, %d rows", {_filename, _row_count});
+    }
+    _rows.clear();
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Write raw data in the file.
+//----------------------------------------------------------------------------
+
+bool ts::PacketTraceWriter::writeData(const void* data, size_t size, Report& report)
+{
+    _file.write(reinterpret_cast<const char*>(data), std::streamsize(size));
+    if (!_file) {
+        report.error(u"error writing %s", {_filename});
+        return false;
+    }
+    return true;
+}
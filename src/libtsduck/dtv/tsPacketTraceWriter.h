@@ -0,0 +1,122 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Writer of binary packet trace files.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsPacketTraceRecord.h"
+#include "tsByteBlock.h"
+#include "tsReport.h"
+
+namespace ts {
+    //!
+    //! Writer of binary packet trace files.
+    //! @ingroup mpeg
+    //! @see PacketTraceRecord for the file format.
+    //!
+    class TSDUCKDLL PacketTraceWriter
+    {
+        TS_NOCOPY(PacketTraceWriter);
+    public:
+        //!
+        //! Default number of rows per block.
+        //!
+        static constexpr size_t DEFAULT_BLOCK_ROWS = PacketTraceRecord::MAX_BLOCK_ROWS;
+
+        //!
+        //! Constructor.
+        //! @param [in] block_rows Number of rows per block in the file,
+        //! at most PacketTraceRecord::MAX_BLOCK_ROWS.
+        //!
+        explicit PacketTraceWriter(size_t block_rows = DEFAULT_BLOCK_ROWS);
+
+        //!
+        //! Destructor.
+        //! The file is closed if still open but errors are not reported.
+        //!
+        ~PacketTraceWriter();
+
+        //!
+        //! Create a packet trace file.
+        //! @param [in] filename File name.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool open(const UString& filename, Report& report);
+
+        //!
+        //! Check if the file is open.
+        //! @return True if the file is open.
+        //!
+        bool isOpen() const { return _file.is_open(); }
+
+        //!
+        //! Write a row in the file.
+        //! Rows are accumulated in memory and written block by block.
+        //! @param [in] rec Row to write.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool write(const PacketTraceRecord& rec, Report& report);
+
+        //!
+        //! Write the pending rows in a block, even if the block is not full.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool flush(Report& report);
+
+        //!
+        //! Flush pending rows and close the file.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool close(Report& report);
+
+        //!
+        //! Get the total number of rows which were written in the file.
+        //! @return The total number of rows.
+        //!
+        uint64_t rowCount() const { return _row_count; }
+
+    private:
+        UString                 _filename;
+        std::ofstream           _file;
+        size_t                  _block_rows;
+        uint64_t                _row_count;
+        PacketTraceRecordVector _rows;
+        ByteBlock               _column;
+        ByteBlock               _data;
+
+        bool writeData(const void* data, size_t size, Report& report);
+    };
+}
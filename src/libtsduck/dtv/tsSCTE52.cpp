@@ -30,6 +30,22 @@
 #include "tsSCTE52.h"
 TSDUCK_SOURCE;
 
+bool ts::SCTE52::setKeyImpl(const void* key, size_t key_length, size_t rounds)
+{
+    // Keep the classical and bitsliced DES engines in sync.
+    return DVS042<DES>::setKeyImpl(key, key_length, rounds) && _batch.setKey(key, key_length);
+}
+
+bool ts::SCTE52::encryptBlocks(const uint8_t* const input[], uint8_t* const output[], size_t count)
+{
+    return _batch.encrypt(input, output, count);
+}
+
+bool ts::SCTE52::decryptBlocks(const uint8_t* const input[], uint8_t* const output[], size_t count)
+{
+    return _batch.decrypt(input, output, count);
+}
+
 ts::UString ts::SCTE52_2003::name() const
 {
     return u"ANSI/SCTE 52 (2003)";
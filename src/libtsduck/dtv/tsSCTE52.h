@@ -35,8 +35,35 @@
 #pragma once
 #include "tsDVS042.h"
 #include "tsDES.h"
+#include "tsDESBatch.h"
 
 namespace ts {
+    //!
+    //! Base class for ANSI/SCTE 52 DES-based TS packet encryption.
+    //! @ingroup crypto
+    //!
+    //! When several packets are encrypted or decrypted at once using encryptBatch()
+    //! or decryptBatch(), the DES blocks are processed by a bitsliced DES engine
+    //! (see ts::DESBatch). The result is identical to one packet at a time.
+    //!
+    class TSDUCKDLL SCTE52 : public DVS042<DES>
+    {
+        TS_NOCOPY(SCTE52);
+    protected:
+        //!
+        //! Constructor for subclasses.
+        //!
+        SCTE52() : DVS042<DES>(), _batch() {}
+
+        // Implementation of BlockCipher and DVS042 interfaces.
+        virtual bool setKeyImpl(const void* key, size_t key_length, size_t rounds) override;
+        virtual bool encryptBlocks(const uint8_t* const input[], uint8_t* const output[], size_t count) override;
+        virtual bool decryptBlocks(const uint8_t* const input[], uint8_t* const output[], size_t count) override;
+
+    private:
+        DESBatch _batch;  // Bitsliced DES for batch processing.
+    };
+
     //!
     //! ANSI/SCTE 52 2003 DES-based TS packet encryption.
     //! @ingroup crypto
@@ -48,14 +75,14 @@ namespace ts {
     //! standard) is used for long and short messages. In the 2008 version, a
     //! different "whitener2" must be used for messages shorter than the block size.
     //!
-    class TSDUCKDLL SCTE52_2003 : public DVS042<DES>
+    class TSDUCKDLL SCTE52_2003 : public SCTE52
     {
         TS_NOCOPY(SCTE52_2003);
     public:
         //!
         //! Constructor.
         //!
-        SCTE52_2003() : DVS042<DES>() {}
+        SCTE52_2003() : SCTE52() {}
 
         // Implementation of BlockCipher interface.
         virtual UString name() const override;
@@ -76,14 +103,14 @@ namespace ts {
     //! standard) is used for long and short messages. In the 2008 version, a
     //! different "whitener2" must be used for messages shorter than the block size.
     //!
-    class TSDUCKDLL SCTE52_2008 : public DVS042<DES>
+    class TSDUCKDLL SCTE52_2008 : public SCTE52
     {
         TS_NOCOPY(SCTE52_2008);
     public:
         //!
         //! Constructor.
         //!
-        SCTE52_2008() : DVS042<DES>() {}
+        SCTE52_2008() : SCTE52() {}
 
         // Implementation of BlockCipher interface.
         virtual UString name() const override;
@@ -184,6 +184,8 @@ ts::SectionDemux::PIDContext::PIDContext() :
     continuity(0),
     sync(false),
     ts(),
+    ts_offset(0),
+    skip(0),
     tids()
 {
 }
@@ -193,6 +195,8 @@ void ts::SectionDemux::PIDContext::syncLost()
 {
     sync = false;
     ts.clear();
+    ts_offset = 0;
+    skip = 0;
 }
 
 
@@ -343,12 +347,43 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
         pc.sync = true;
     }
 
-    // Copy TS packet payload in PID context
+    // Skip the end of an already known section, without reassembly.
+    if (pc.skip > 0) {
+        if (pkt.getPUSI() && pointer_field < pc.skip) {
+            // The skipped section is truncated, a new section starts before its end.
+            payload += pointer_field;
+            payload_size -= pointer_field;
+            pointer_field = 0;
+            pc.skip = 0;
+        }
+        else {
+            const size_t size = std::min(pc.skip, payload_size);
+            payload += size;
+            payload_size -= size;
+            pc.skip -= size;
+            if (pkt.getPUSI()) {
+                pointer_field = uint8_t(pointer_field - size);
+            }
+            if (payload_size == 0) {
+                return;
+            }
+            // The next section starts in current packet.
+            pusi_pkt_index = _packet_count;
+        }
+    }
+
+    // Copy TS packet payload in PID context. The already processed data at the beginning
+    // of the buffer are removed only when they use more space than the unprocessed data.
+    // This avoids moving the data after each section.
+    if (pc.ts_offset > 0 && pc.ts_offset >= pc.ts.size() - pc.ts_offset) {
+        pc.ts.erase(0, pc.ts_offset);
+        pc.ts_offset = 0;
+    }
     pc.ts.append(payload, payload_size);
 
     // Locate TS buffer by address and size.
-    const uint8_t* ts_start = pc.ts.data();
-    size_t ts_size = pc.ts.size();
+    const uint8_t* ts_start = pc.ts.data() + pc.ts_offset;
+    size_t ts_size = pc.ts.size() - pc.ts_offset;
 
     // If current packet has a PUSI, locate start of this new section
     // inside the TS buffer. This is not useful to locate the section but
@@ -413,8 +448,14 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
         }
 
         // Exit when end of section is missing. Wait for next TS packets.
+        // If the section is already known, there is no need to reassemble it,
+        // skip the rest of the section in the next TS packets.
 
         if (ts_size < section_length) {
+            if ((pusi_section == nullptr || pusi_section <= ts_start) && isKnownSection(pc, ts_start, ts_size)) {
+                pc.skip = section_length - ts_size;
+                ts_size = 0;
+            }
             break;
         }
 
@@ -541,17 +582,55 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
         pusi_pkt_index = _packet_count;
     }
 
-    // If an incomplete section remains in the buffer, move it back to
-    // the start of the buffer.
+    // If an incomplete section remains in the buffer, keep track of its start.
+    // It will be moved back to the start of the buffer later, if necessary.
 
     if (ts_size <= 0) {
         // TS buffer becomes empty
         pc.ts.clear();
+        pc.ts_offset = 0;
+    }
+    else {
+        pc.ts_offset = ts_start - pc.ts.data();
     }
-    else if (ts_start > pc.ts.data()) {
-        // Remove start of TS buffer
-        pc.ts.erase(0, ts_start - pc.ts.data());
+}
+
+
+//----------------------------------------------------------------------------
+// Check if an incomplete section is already known.
+//----------------------------------------------------------------------------
+
+bool ts::SectionDemux::isKnownSection(PIDContext& pc, const uint8_t* data, size_t size)
+{
+    // All sections must be reassembled when there is a section handler.
+    // Only long sections have a version and a section number.
+    if (_section_handler != nullptr || _table_handler == nullptr || size < LONG_SECTION_HEADER_SIZE || !Section::StartLongSection(data, size)) {
+        return false;
     }
+
+    // Same checks as on complete sections, an invalid section is not skipped.
+    const ETID etid(data[0], GetUInt16(data + 3));
+    const uint8_t version = (data[5] >> 1) & 0x1F;
+    const bool is_next = (data[5] & 0x01) == 0;
+    const uint8_t section_number = data[6];
+    const uint8_t last_section_number = data[7];
+    if (section_number > last_section_number || (is_next ? !_get_next : !_get_current)) {
+        return false;
+    }
+
+    // The section is known if the same section of the same version of the table was already received.
+    const auto it = pc.tids.find(etid);
+    if (it == pc.tids.end()) {
+        return false;
+    }
+    const ETIDContext& tc(it->second);
+    if (tc.sect_expected == 0 || tc.version != version || tc.sect_expected != size_t(last_section_number) + 1 || tc.sects[section_number].isNull()) {
+        return false;
+    }
+
+    // Same side effect as on complete sections: accumulate standards in context.
+    _duck.addStandards(TablesFactory::Instance()->getTableStandards(etid.tid()));
+    return true;
 }
 
 
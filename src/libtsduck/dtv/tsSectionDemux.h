@@ -239,6 +239,8 @@ namespace ts {
             uint8_t       continuity;         // Last continuity counter
             bool          sync;               // We are synchronous in this PID
             ByteBlock     ts;                 // TS payload buffer
+            size_t        ts_offset;          // Offset of the first unprocessed byte in ts, the previous ones are already processed
+            size_t        skip;               // Number of payload bytes to skip (end of an already known section)
             std::map<ETID,ETIDContext> tids;  // TID analysis contexts
 
             // Default constructor.
@@ -254,6 +256,10 @@ namespace ts {
         // If fill_eit is true, add missing sections in EIT.
         void fixAndFlush(bool pack, bool fill_eit);
 
+        // Check if an incomplete section is already known and can be skipped without reassembly.
+        // The section header is at the start of the data.
+        bool isKnownSection(PIDContext& pc, const uint8_t* data, size_t size);
+
         // Private members:
         TableHandlerInterface*   _table_handler;
         SectionHandlerInterface* _section_handler;
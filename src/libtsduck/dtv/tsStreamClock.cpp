@@ -0,0 +1,135 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsStreamClock.h"
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr uint64_t ts::StreamClock::MAX_PCR_GAP;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Constructor and reset.
+//----------------------------------------------------------------------------
+
+ts::StreamClock::StreamClock(PID pid) :
+    _pid(pid),
+    _bitrate_hint(0),
+    _packets(0),
+    _time(0),
+    _last_pcr(INVALID_PCR),
+    _base_time(0),
+    _base_packet(0),
+    _rate_ticks(0),
+    _rate_packets(0)
+{
+}
+
+void ts::StreamClock::reset(PID pid)
+{
+    _pid = pid;
+    _bitrate_hint = 0;
+    _packets = 0;
+    _time = 0;
+    _last_pcr = INVALID_PCR;
+    _base_time = 0;
+    _base_packet = 0;
+    _rate_ticks = 0;
+    _rate_packets = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Extrapolate the stream time of a packet from the last PCR.
+// The products are computed on the remainders of the divisions only, so that
+// they do not overflow 64 bits, even after billions of packets without PCR.
+//----------------------------------------------------------------------------
+
+uint64_t ts::StreamClock::extrapolate(PacketCounter packet) const
+{
+    const PacketCounter distance = packet - _base_packet;
+    if (_rate_packets > 0) {
+        // Use the PCR rate between the last two PCR's.
+        return _base_time + (distance / _rate_packets) * _rate_ticks + ((distance % _rate_packets) * _rate_ticks) / _rate_packets;
+    }
+    else if (_bitrate_hint > 0) {
+        // PCR rate unknown, use the bitrate hint.
+        const uint64_t bits = distance * PKT_SIZE * 8;
+        return _base_time + (bits / _bitrate_hint) * SYSTEM_CLOCK_FREQ + ((bits % _bitrate_hint) * SYSTEM_CLOCK_FREQ) / _bitrate_hint;
+    }
+    else {
+        // No way to compute a time.
+        return _base_time;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Feed the clock with the next TS packet.
+//----------------------------------------------------------------------------
+
+void ts::StreamClock::feedPacket(const TSPacket& pkt)
+{
+    uint64_t time = INVALID_PCR;
+
+    // Only the PCR's from the reference PID are used. The first PID with PCR is used by default.
+    if (pkt.hasPCR() && (_pid == PID_NULL || pkt.getPID() == _pid)) {
+        const uint64_t pcr = pkt.getPCR();
+        _pid = pkt.getPID();
+
+        if (_last_pcr != INVALID_PCR && !pkt.getDiscontinuityIndicator()) {
+            // Difference from previous PCR, taking wrap up into account.
+            const uint64_t diff = pcr >= _last_pcr ? pcr - _last_pcr : pcr + PCR_SCALE - _last_pcr;
+            if (diff > 0 && diff <= MAX_PCR_GAP && _packets > _base_packet) {
+                // Valid difference, the PCR gives the exact time and the PCR rate.
+                time = _base_time + diff;
+                _rate_ticks = diff;
+                _rate_packets = _packets - _base_packet;
+            }
+        }
+
+        // On first PCR or discontinuity, keep the extrapolated time.
+        if (time == INVALID_PCR) {
+            time = extrapolate(_packets);
+        }
+
+        // Restart extrapolations from this PCR, never going backward.
+        _last_pcr = pcr;
+        _base_time = std::max(time, _time);
+        _base_packet = _packets;
+        _time = _base_time;
+    }
+    else {
+        // Not a reference PCR, extrapolate, never going backward.
+        _time = std::max(_time, extrapolate(_packets));
+    }
+
+    _packets++;
+}
@@ -0,0 +1,128 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Stream time clock, derived from the PCR's of a reference PID.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsMPEG.h"
+#include "tsTSPacket.h"
+
+namespace ts {
+    //!
+    //! Stream time clock, derived from the PCR's of a reference PID.
+    //! @ingroup mpeg
+    //!
+    //! The stream time is the time of the transport stream, as seen by a receiver,
+    //! independently of the speed at which the stream is processed. A 2-hour file
+    //! which is processed in a few minutes has a 2-hour stream time.
+    //!
+    //! The stream time is expressed in PCR units (27 MHz) and starts at zero with
+    //! the first packet. It is monotonic and does not wrap up, even when the PCR
+    //! values wrap up or when a PCR discontinuity is found.
+    //!
+    //! The time of packets between two PCR's is extrapolated using the PCR rate
+    //! of the reference PID, as measured between its last two PCR's. Before the
+    //! second PCR, the time is extrapolated using a bitrate hint, if one is provided.
+    //!
+    class TSDUCKDLL StreamClock
+    {
+    public:
+        //!
+        //! Maximum gap between two consecutive PCR's of the reference PID.
+        //! A larger difference is considered as a discontinuity.
+        //!
+        static constexpr uint64_t MAX_PCR_GAP = SYSTEM_CLOCK_FREQ;
+
+        //!
+        //! Constructor.
+        //! @param [in] pid The reference PID. When PID_NULL, the first PID containing PCR's is used.
+        //!
+        StreamClock(PID pid = PID_NULL);
+
+        //!
+        //! Reset the clock.
+        //! @param [in] pid The reference PID. When PID_NULL, the first PID containing PCR's is used.
+        //!
+        void reset(PID pid = PID_NULL);
+
+        //!
+        //! Set a bitrate hint, used to extrapolate the stream time when the PCR rate is unknown.
+        //! @param [in] bitrate Transport stream bitrate in bits/second. Zero if unknown.
+        //!
+        void setBitrateHint(BitRate bitrate) { _bitrate_hint = bitrate; }
+
+        //!
+        //! Feed the clock with the next TS packet.
+        //! After this call, currentTime() returns the time of this packet.
+        //! @param [in] pkt The next TS packet in the stream.
+        //!
+        void feedPacket(const TSPacket& pkt);
+
+        //!
+        //! Get the stream time of the last packet.
+        //! @return The stream time of the last packet, in PCR units.
+        //!
+        uint64_t currentTime() const { return _time; }
+
+        //!
+        //! Get the stream time of the last packet in milliseconds.
+        //! @return The stream time of the last packet, in milliseconds.
+        //!
+        MilliSecond currentMilliSeconds() const { return MilliSecond(_time / (SYSTEM_CLOCK_FREQ / MilliSecPerSec)); }
+
+        //!
+        //! Get the reference PID.
+        //! @return The reference PID or PID_NULL if no PCR was found yet.
+        //!
+        PID referencePID() const { return _pid; }
+
+        //!
+        //! Check if at least one PCR was found in the reference PID.
+        //! @return True if at least one PCR was found in the reference PID.
+        //!
+        bool pcrFound() const { return _last_pcr != INVALID_PCR; }
+
+    private:
+        PID           _pid;           // Reference PID, PID_NULL if not yet known.
+        BitRate       _bitrate_hint;  // Bitrate for extrapolation when the PCR rate is unknown.
+        PacketCounter _packets;       // Number of packets so far.
+        uint64_t      _time;          // Stream time of the last packet.
+        uint64_t      _last_pcr;      // Last PCR value in reference PID.
+        uint64_t      _base_time;     // Stream time of the last PCR.
+        PacketCounter _base_packet;   // Packet index of the last PCR.
+        uint64_t      _rate_ticks;    // PCR difference between the last two PCR's.
+        PacketCounter _rate_packets;  // Number of packets between the last two PCR's.
+
+        // Extrapolate the stream time of a packet from the last PCR.
+        uint64_t extrapolate(PacketCounter packet) const;
+    };
+}
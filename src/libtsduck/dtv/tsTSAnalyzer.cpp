@@ -35,6 +35,8 @@
 #include "tsT2MIPacket.h"
 #include "tsNames.h"
 #include "tsAlgorithm.h"
+#include "tsSysUtils.h"
+#include "tsMemory.h"
 TSDUCK_SOURCE;
 
 // Constant string "Unreferenced"
@@ -53,6 +55,7 @@ ts::TSAnalyzer::TSAnalyzer(DuckContext& duck, BitRate bitrate_hint) :
     _invalid_sync(0),
     _transport_errors(0),
     _suspect_ignored(0),
+    _sampled_cnt(0),
     _pid_cnt(0),
     _scrambled_pid_cnt(0),
     _pcr_pid_cnt(0),
@@ -95,6 +98,7 @@ ts::TSAnalyzer::TSAnalyzer(DuckContext& duck, BitRate bitrate_hint) :
     _preceding_suspects(0),
     _min_error_before_suspect(1),
     _max_consecutive_suspects(1),
+    _sampling(false),
     _demux(_duck, this, this),
     _pes_demux(_duck, this),
     _t2mi_demux(_duck, this)
@@ -126,6 +130,7 @@ void ts::TSAnalyzer::reset()
     _invalid_sync = 0;
     _transport_errors = 0;
     _suspect_ignored = 0;
+    _sampled_cnt = 0;
     _pid_cnt = 0;
     _scrambled_pid_cnt = 0;
     _pcr_pid_cnt = 0;
@@ -1474,10 +1479,15 @@ void ts::TSAnalyzer::feedPacket(const TSPacket& pkt)
     _preceding_errors = 0;
     _preceding_suspects = 0;
 
-    // Feed packets into the various demux
+    // Feed packets into the various demux. In sampling mode, skip PES and T2-MI analysis.
     _demux.feedPacket(pkt);
-    _pes_demux.feedPacket(pkt);
-    _t2mi_demux.feedPacket(pkt);
+    if (_sampling) {
+        _sampled_cnt++;
+    }
+    else {
+        _pes_demux.feedPacket(pkt);
+        _t2mi_demux.feedPacket(pkt);
+    }
 
     // Get PID context
     PIDContextPtr ps(getPID(pkt.getPID()));
@@ -1525,8 +1535,8 @@ void ts::TSAnalyzer::feedPacket(const TSPacket& pkt)
     // Process discontinuities.
     // The continuity counter of null packets is undefined.
     if (ps->pid != PID_NULL) {
-        if (ps->ts_pkt_cnt == 1) {
-            // First packet, initialize continuity
+        if (ps->ts_pkt_cnt == 1 || ps->cur_continuity >= CC_MAX) {
+            // First packet (or first one after reloading a state), initialize continuity
             ps->cur_continuity = pkt.getCC();
         }
         else if (pkt.getDiscontinuityIndicator()) {
@@ -1876,3 +1886,494 @@ void ts::TSAnalyzer::getPIDsWithPES(std::vector<PID>& list)
         }
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Binary snapshots of the analysis state.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Snapshot header: magic number and format version.
+    // Version 1 has no count of sampled packets. It can still be read.
+    const uint8_t STATE_MAGIC[4] = {'T', 'S', 'A', 'S'};
+    constexpr uint8_t STATE_VERSION = 2;
+    constexpr uint8_t STATE_MIN_VERSION = 1;
+
+    // Serialize a string (UTF-8, 16-bit length).
+    void PutString(ts::ByteBlock& data, const ts::UString& str)
+    {
+        std::string utf8(str.toUTF8());
+        if (utf8.size() > 0xFFFF) {
+            utf8.resize(0xFFFF);
+        }
+        data.appendUInt16(uint16_t(utf8.size()));
+        data.append(utf8);
+    }
+
+    // Serialize a time as milliseconds since the Epoch.
+    void PutTime(ts::ByteBlock& data, const ts::Time& time)
+    {
+        data.appendInt64(time - ts::Time::Epoch);
+    }
+
+    // A sequential reader for binary snapshots. After an overflow, all
+    // subsequent reads return zero and the reader is no longer valid.
+    class StateReader
+    {
+    public:
+        StateReader(const uint8_t* data, size_t size) : _data(data), _size(size), _valid(data != nullptr) {}
+        bool valid() const { return _valid; }
+        bool atEnd() const { return _size == 0; }
+
+        const uint8_t* read(size_t size)
+        {
+            if (!_valid || size > _size) {
+                _valid = false;
+                return nullptr;
+            }
+            const uint8_t* const p = _data;
+            _data += size;
+            _size -= size;
+            return p;
+        }
+
+        uint8_t  getUInt8()  { const uint8_t* p = read(1); return p == nullptr ? 0 : *p; }
+        uint16_t getUInt16() { const uint8_t* p = read(2); return p == nullptr ? 0 : ts::GetUInt16(p); }
+        uint32_t getUInt32() { const uint8_t* p = read(4); return p == nullptr ? 0 : ts::GetUInt32(p); }
+        uint64_t getUInt64() { const uint8_t* p = read(8); return p == nullptr ? 0 : ts::GetUInt64(p); }
+        int64_t  getInt64()  { return int64_t(getUInt64()); }
+        bool     getBool()   { return getUInt8() != 0; }
+        ts::Time getTime()   { return ts::Time::Epoch + getInt64(); }
+
+        ts::UString getString()
+        {
+            const size_t len = getUInt16();
+            const uint8_t* p = read(len);
+            return p == nullptr ? ts::UString() : ts::UString::FromUTF8(reinterpret_cast<const char*>(p), len);
+        }
+
+    private:
+        const uint8_t* _data;
+        size_t         _size;
+        bool           _valid;
+    };
+}
+
+
+//----------------------------------------------------------------------------
+// Snapshot of the cumulative analysis state.
+// Only accumulated data are saved, the statistics which are recomputed
+// in recomputeStatistics() are not.
+//----------------------------------------------------------------------------
+
+ts::TSAnalyzer::StateSnapshot::StateSnapshot() :
+    _ts_id(0),
+    _ts_id_valid(false),
+    _ts_pkt_cnt(0),
+    _invalid_sync(0),
+    _transport_errors(0),
+    _suspect_ignored(0),
+    _sampled_cnt(0),
+    _scrambled_pid_cnt(0),
+    _pcr_pid_cnt(0),
+    _ts_bitrate_sum(0),
+    _ts_bitrate_cnt(0),
+    _first_utc(Time::Epoch),
+    _first_local(Time::Epoch),
+    _first_tdt(Time::Epoch),
+    _last_tdt(Time::Epoch),
+    _first_tot(Time::Epoch),
+    _last_tot(Time::Epoch),
+    _first_stt(Time::Epoch),
+    _last_stt(Time::Epoch),
+    _country_code(),
+    _tid_present(),
+    _pids(),
+    _services()
+{
+}
+
+void ts::TSAnalyzer::getState(StateSnapshot& state) const
+{
+    state._ts_id = _ts_id;
+    state._ts_id_valid = _ts_id_valid;
+    state._ts_pkt_cnt = _ts_pkt_cnt;
+    state._invalid_sync = _invalid_sync;
+    state._transport_errors = _transport_errors;
+    state._suspect_ignored = _suspect_ignored;
+    state._sampled_cnt = _sampled_cnt;
+    state._scrambled_pid_cnt = _scrambled_pid_cnt;
+    state._pcr_pid_cnt = _pcr_pid_cnt;
+    state._ts_bitrate_sum = _ts_bitrate_sum;
+    state._ts_bitrate_cnt = _ts_bitrate_cnt;
+    state._first_utc = _first_utc;
+    state._first_local = _first_local;
+    state._first_tdt = _first_tdt;
+    state._last_tdt = _last_tdt;
+    state._first_tot = _first_tot;
+    state._last_tot = _last_tot;
+    state._first_stt = _first_stt;
+    state._last_stt = _last_stt;
+    state._country_code = _country_code;
+    state._tid_present = _tid_present;
+
+    // Deep copy of the contexts, the analysis continues to update the originals.
+    state._services.clear();
+    for (ServiceContextMap::const_iterator it = _services.begin(); it != _services.end(); ++it) {
+        state._services.insert(std::make_pair(it->first, ServiceContextPtr(new ServiceContext(*it->second))));
+    }
+    state._pids.clear();
+    for (PIDContextMap::const_iterator it = _pids.begin(); it != _pids.end(); ++it) {
+        PIDContext* const pc = new PIDContext(*it->second);
+        for (ETIDContextMap::iterator itet = pc->sections.begin(); itet != pc->sections.end(); ++itet) {
+            itet->second = new ETIDContext(*itet->second);
+        }
+        state._pids.insert(std::make_pair(it->first, PIDContextPtr(pc)));
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Serialize the cumulative analysis state in binary form.
+// All integers are big endian.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::serializeState(ByteBlock& data) const
+{
+    StateSnapshot state;
+    getState(state);
+    state.serialize(data);
+}
+
+void ts::TSAnalyzer::StateSnapshot::serialize(ByteBlock& data) const
+{
+    data.clear();
+    data.append(STATE_MAGIC, sizeof(STATE_MAGIC));
+    data.appendUInt8(STATE_VERSION);
+
+    // Global state.
+    data.appendUInt16(_ts_id);
+    data.appendUInt8(_ts_id_valid);
+    data.appendUInt64(_ts_pkt_cnt);
+    data.appendUInt64(_invalid_sync);
+    data.appendUInt64(_transport_errors);
+    data.appendUInt64(_suspect_ignored);
+    data.appendUInt64(_sampled_cnt);
+    data.appendUInt32(uint32_t(_scrambled_pid_cnt));
+    data.appendUInt32(uint32_t(_pcr_pid_cnt));
+    data.appendUInt64(_ts_bitrate_sum);
+    data.appendUInt64(_ts_bitrate_cnt);
+    PutTime(data, _first_utc);
+    PutTime(data, _first_local);
+    PutTime(data, _first_tdt);
+    PutTime(data, _last_tdt);
+    PutTime(data, _first_tot);
+    PutTime(data, _last_tot);
+    PutTime(data, _first_stt);
+    PutTime(data, _last_stt);
+    PutString(data, _country_code);
+    for (size_t tid = 0; tid < TID_MAX; tid += 8) {
+        uint8_t mask = 0;
+        for (size_t bit = 0; bit < 8; ++bit) {
+            mask = uint8_t(mask << 1) | uint8_t(_tid_present.test(tid + bit));
+        }
+        data.appendUInt8(mask);
+    }
+
+    // Services.
+    data.appendUInt32(uint32_t(_services.size()));
+    for (ServiceContextMap::const_iterator it = _services.begin(); it != _services.end(); ++it) {
+        const ServiceContext& sv(*it->second);
+        data.appendUInt16(sv.service_id);
+        data.appendUInt16(sv.orig_netw_id);
+        data.appendUInt8(sv.service_type);
+        PutString(data, sv.name);
+        PutString(data, sv.provider);
+        data.appendUInt16(sv.pmt_pid);
+        data.appendUInt16(sv.pcr_pid);
+        data.appendUInt8(sv.carry_ssu);
+        data.appendUInt8(sv.carry_t2mi);
+    }
+
+    // PID's.
+    data.appendUInt32(uint32_t(_pids.size()));
+    for (PIDContextMap::const_iterator it = _pids.begin(); it != _pids.end(); ++it) {
+        const PIDContext& pc(*it->second);
+        data.appendUInt16(pc.pid);
+        PutString(data, pc.description);
+        PutString(data, pc.comment);
+        data.appendUInt32(uint32_t(pc.attributes.size()));
+        for (UStringVector::const_iterator itat = pc.attributes.begin(); itat != pc.attributes.end(); ++itat) {
+            PutString(data, *itat);
+        }
+        data.appendUInt32(uint32_t(pc.services.size()));
+        for (ServiceIdSet::const_iterator itsv = pc.services.begin(); itsv != pc.services.end(); ++itsv) {
+            data.appendUInt16(*itsv);
+        }
+        data.appendUInt8(pc.is_pmt_pid);
+        data.appendUInt8(pc.is_pcr_pid);
+        data.appendUInt8(pc.referenced);
+        data.appendUInt8(pc.optional);
+        data.appendUInt8(pc.carry_pes);
+        data.appendUInt8(pc.carry_section);
+        data.appendUInt8(pc.carry_ecm);
+        data.appendUInt8(pc.carry_emm);
+        data.appendUInt8(pc.carry_audio);
+        data.appendUInt8(pc.carry_video);
+        data.appendUInt8(pc.carry_t2mi);
+        data.appendUInt8(pc.scrambled);
+        data.appendUInt8(pc.same_stream_id);
+        data.appendUInt8(pc.pes_stream_id);
+        data.appendUInt64(pc.ts_pkt_cnt);
+        data.appendUInt64(pc.ts_af_cnt);
+        data.appendUInt64(pc.unit_start_cnt);
+        data.appendUInt64(pc.pl_start_cnt);
+        data.appendUInt64(pc.pmt_cnt);
+        data.appendUInt64(pc.unexp_discont);
+        data.appendUInt64(pc.exp_discont);
+        data.appendUInt64(pc.duplicated);
+        data.appendUInt64(pc.ts_sc_cnt);
+        data.appendUInt64(pc.inv_ts_sc_cnt);
+        data.appendUInt64(pc.inv_pes_start);
+        data.appendUInt64(pc.t2mi_cnt);
+        data.appendUInt64(pc.pcr_cnt);
+        data.appendUInt64(pc.cryptop_cnt);
+        data.appendUInt64(pc.cryptop_ts_cnt);
+        data.appendUInt64(pc.ts_bitrate_sum);
+        data.appendUInt64(pc.ts_bitrate_cnt);
+        PutString(data, pc.language);
+        data.appendUInt16(pc.cas_id);
+        data.appendUInt32(uint32_t(pc.cas_operators.size()));
+        for (std::set<uint32_t>::const_iterator itop = pc.cas_operators.begin(); itop != pc.cas_operators.end(); ++itop) {
+            data.appendUInt32(*itop);
+        }
+        data.appendUInt32(uint32_t(pc.ssu_oui.size()));
+        for (std::set<uint32_t>::const_iterator itoui = pc.ssu_oui.begin(); itoui != pc.ssu_oui.end(); ++itoui) {
+            data.appendUInt32(*itoui);
+        }
+        data.appendUInt32(uint32_t(pc.t2mi_plp_ts.size()));
+        for (std::map<uint8_t,uint64_t>::const_iterator itplp = pc.t2mi_plp_ts.begin(); itplp != pc.t2mi_plp_ts.end(); ++itplp) {
+            data.appendUInt8(itplp->first);
+            data.appendUInt64(itplp->second);
+        }
+
+        // Tables in this PID.
+        data.appendUInt32(uint32_t(pc.sections.size()));
+        for (ETIDContextMap::const_iterator itet = pc.sections.begin(); itet != pc.sections.end(); ++itet) {
+            const ETIDContext& etc(*itet->second);
+            data.appendUInt8(etc.etid.isLongSection());
+            data.appendUInt8(etc.etid.tid());
+            data.appendUInt16(etc.etid.tidExt());
+            data.appendUInt64(etc.table_count);
+            data.appendUInt64(etc.section_count);
+            data.appendUInt64(etc.repetition_ts);
+            data.appendUInt64(etc.min_repetition_ts);
+            data.appendUInt64(etc.max_repetition_ts);
+            data.appendUInt8(etc.first_version);
+            data.appendUInt8(etc.last_version);
+            data.appendUInt32(uint32_t(etc.versions.to_ulong()));
+            data.appendUInt64(etc.first_pkt);
+            data.appendUInt64(etc.last_pkt);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Restore the cumulative analysis state from its binary form.
+//----------------------------------------------------------------------------
+
+bool ts::TSAnalyzer::deserializeState(const uint8_t* data, size_t size)
+{
+    reset();
+    _modified = true;
+
+    StateReader rd(data, size);
+    const uint8_t* magic = rd.read(sizeof(STATE_MAGIC));
+    const uint8_t version = rd.getUInt8();
+    if (magic == nullptr || ::memcmp(magic, STATE_MAGIC, sizeof(STATE_MAGIC)) != 0 || version < STATE_MIN_VERSION || version > STATE_VERSION) {
+        reset();
+        return false;
+    }
+
+    // Global state.
+    _ts_id = rd.getUInt16();
+    _ts_id_valid = rd.getBool();
+    _ts_pkt_cnt = rd.getUInt64();
+    _invalid_sync = rd.getUInt64();
+    _transport_errors = rd.getUInt64();
+    _suspect_ignored = rd.getUInt64();
+    _sampled_cnt = version >= 2 ? rd.getUInt64() : 0;
+    _scrambled_pid_cnt = rd.getUInt32();
+    _pcr_pid_cnt = rd.getUInt32();
+    _ts_bitrate_sum = rd.getUInt64();
+    _ts_bitrate_cnt = rd.getUInt64();
+    _first_utc = rd.getTime();
+    _first_local = rd.getTime();
+    _first_tdt = rd.getTime();
+    _last_tdt = rd.getTime();
+    _first_tot = rd.getTime();
+    _last_tot = rd.getTime();
+    _first_stt = rd.getTime();
+    _last_stt = rd.getTime();
+    _country_code = rd.getString();
+    for (size_t tid = 0; tid < TID_MAX; tid += 8) {
+        const uint8_t mask = rd.getUInt8();
+        for (size_t bit = 0; bit < 8; ++bit) {
+            _tid_present.set(tid + bit, (mask & (0x80 >> bit)) != 0);
+        }
+    }
+
+    // Services.
+    for (uint32_t count = rd.getUInt32(); rd.valid() && count > 0; --count) {
+        ServiceContextPtr sv(getService(rd.getUInt16()));
+        sv->orig_netw_id = rd.getUInt16();
+        sv->service_type = rd.getUInt8();
+        sv->name = rd.getString();
+        sv->provider = rd.getString();
+        sv->pmt_pid = rd.getUInt16() & 0x1FFF;
+        sv->pcr_pid = rd.getUInt16() & 0x1FFF;
+        sv->carry_ssu = rd.getBool();
+        sv->carry_t2mi = rd.getBool();
+    }
+
+    // PID's.
+    for (uint32_t count = rd.getUInt32(); rd.valid() && count > 0; --count) {
+        PIDContextPtr pc(getPID(rd.getUInt16() & 0x1FFF));
+        pc->description = rd.getString();
+        pc->comment = rd.getString();
+        for (uint32_t acount = rd.getUInt32(); rd.valid() && acount > 0; --acount) {
+            pc->attributes.push_back(rd.getString());
+        }
+        for (uint32_t scount = rd.getUInt32(); rd.valid() && scount > 0; --scount) {
+            pc->services.insert(rd.getUInt16());
+        }
+        pc->is_pmt_pid = rd.getBool();
+        pc->is_pcr_pid = rd.getBool();
+        pc->referenced = rd.getBool();
+        pc->optional = rd.getBool();
+        pc->carry_pes = rd.getBool();
+        pc->carry_section = rd.getBool();
+        pc->carry_ecm = rd.getBool();
+        pc->carry_emm = rd.getBool();
+        pc->carry_audio = rd.getBool();
+        pc->carry_video = rd.getBool();
+        pc->carry_t2mi = rd.getBool();
+        pc->scrambled = rd.getBool();
+        pc->same_stream_id = rd.getBool();
+        pc->pes_stream_id = rd.getUInt8();
+        pc->ts_pkt_cnt = rd.getUInt64();
+        pc->ts_af_cnt = rd.getUInt64();
+        pc->unit_start_cnt = rd.getUInt64();
+        pc->pl_start_cnt = rd.getUInt64();
+        pc->pmt_cnt = rd.getUInt64();
+        pc->unexp_discont = rd.getUInt64();
+        pc->exp_discont = rd.getUInt64();
+        pc->duplicated = rd.getUInt64();
+        pc->ts_sc_cnt = rd.getUInt64();
+        pc->inv_ts_sc_cnt = rd.getUInt64();
+        pc->inv_pes_start = rd.getUInt64();
+        pc->t2mi_cnt = rd.getUInt64();
+        pc->pcr_cnt = rd.getUInt64();
+        pc->cryptop_cnt = rd.getUInt64();
+        pc->cryptop_ts_cnt = rd.getUInt64();
+        pc->ts_bitrate_sum = rd.getUInt64();
+        pc->ts_bitrate_cnt = rd.getUInt64();
+        pc->language = rd.getString();
+        pc->cas_id = rd.getUInt16();
+        for (uint32_t ocount = rd.getUInt32(); rd.valid() && ocount > 0; --ocount) {
+            pc->cas_operators.insert(rd.getUInt32());
+        }
+        for (uint32_t ocount = rd.getUInt32(); rd.valid() && ocount > 0; --ocount) {
+            pc->ssu_oui.insert(rd.getUInt32());
+        }
+        for (uint32_t pcount = rd.getUInt32(); rd.valid() && pcount > 0; --pcount) {
+            const uint8_t plp = rd.getUInt8();
+            pc->t2mi_plp_ts[plp] = rd.getUInt64();
+        }
+
+        // Tables in this PID.
+        for (uint32_t ecount = rd.getUInt32(); rd.valid() && ecount > 0; --ecount) {
+            const bool is_long = rd.getBool();
+            const TID tid = rd.getUInt8();
+            const uint16_t tid_ext = rd.getUInt16();
+            const ETID etid(is_long ? ETID(tid, tid_ext) : ETID(tid));
+            ETIDContextPtr etc(new ETIDContext(etid));
+            pc->sections[etid] = etc;
+            etc->table_count = rd.getUInt64();
+            etc->section_count = rd.getUInt64();
+            etc->repetition_ts = rd.getUInt64();
+            etc->min_repetition_ts = rd.getUInt64();
+            etc->max_repetition_ts = rd.getUInt64();
+            etc->first_version = rd.getUInt8();
+            etc->last_version = rd.getUInt8();
+            etc->versions = std::bitset<SVERSION_MAX>(rd.getUInt32());
+            etc->first_pkt = rd.getUInt64();
+            etc->last_pkt = rd.getUInt64();
+        }
+
+        // The current crypto-period, continuity counter and PCR are not
+        // meaningful across a restart. Resynchronize on next packets.
+        pc->cur_continuity = CC_MAX;
+        pc->cur_ts_sc = SC_CLEAR;
+        pc->cur_ts_sc_pkt = _ts_pkt_cnt;
+        pc->last_pcr = 0;
+        pc->last_pcr_pkt = 0;
+    }
+
+    // The complete snapshot must have been consumed.
+    if (!rd.valid() || !rd.atEnd()) {
+        reset();
+        return false;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Save the cumulative analysis state into a binary snapshot file.
+//----------------------------------------------------------------------------
+
+bool ts::TSAnalyzer::saveState(const UString& file_name, Report& report) const
+{
+    ByteBlock data;
+    serializeState(data);
+    return SaveStateFile(data, file_name, report);
+}
+
+bool ts::TSAnalyzer::SaveStateFile(const ByteBlock& data, const UString& file_name, Report& report)
+{
+    // Write a temporary file and rename it to atomically replace the previous snapshot.
+    const UString temp_name(file_name + u".tmp");
+    if (!data.saveToFile(temp_name, &report)) {
+        return false;
+    }
+    const ErrorCode status = RenameFile(temp_name, file_name);
+    if (status != SYS_SUCCESS) {
+        report.error(u"error renaming %s to %s: %s", {temp_name, file_name, ErrorCodeMessage(status)});
+        DeleteFile(temp_name);
+        return false;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Reload the cumulative analysis state from a binary snapshot file.
+//----------------------------------------------------------------------------
+
+bool ts::TSAnalyzer::loadState(const UString& file_name, Report& report)
+{
+    ByteBlock data;
+    if (!data.loadFromFile(file_name, std::numeric_limits<size_t>::max(), &report)) {
+        reset();
+        return false;
+    }
+    else if (!deserializeState(data.data(), data.size())) {
+        report.error(u"invalid analysis state file %s", {file_name});
+        return false;
+    }
+    else {
+        return true;
+    }
+}
@@ -48,6 +48,8 @@
 #include "tsTVCT.h"
 #include "tsCVCT.h"
 #include "tsSTT.h"
+#include "tsByteBlock.h"
+#include "tsReport.h"
 #include "tsTime.h"
 #include "tsUString.h"
 #include "tsSafePtr.h"
@@ -101,6 +103,72 @@ namespace ts {
         //!
         void setBitrateHint(BitRate bitrate_hint = 0);
 
+        //!
+        //! Save the cumulative analysis state into a binary snapshot file.
+        //! The snapshot contains all accumulated counters and the description of all
+        //! PID's, services and tables. It can be reloaded later using loadState() to
+        //! resume a long-term analysis after an application restart.
+        //! The file is first written under a temporary name and then renamed. Thus,
+        //! a complete snapshot always exists, even if the application is killed.
+        //! @param [in] file_name Name of the snapshot file.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool saveState(const UString& file_name, Report& report) const;
+
+        //!
+        //! Reload the cumulative analysis state from a binary snapshot file.
+        //! The current analysis context is replaced by the content of the snapshot.
+        //! The analysis of tables restarts from scratch since the demux state is not
+        //! saved. The continuity counters and PCR's of all PID's are resynchronized
+        //! on the next packets. Snapshots from previous versions of the format are accepted.
+        //! @param [in] file_name Name of the snapshot file.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error. On error, the analysis context is reset.
+        //!
+        bool loadState(const UString& file_name, Report& report);
+
+        //!
+        //! Serialize the cumulative analysis state in binary form.
+        //! @param [out] data Returned binary snapshot.
+        //! @see saveState()
+        //!
+        void serializeState(ByteBlock& data) const;
+
+        //!
+        //! Write a binary analysis state, as built by serializeState(), in a snapshot file.
+        //! The file is first written under a temporary name and then renamed.
+        //! This static method does not use any analyzer object. It can be used in
+        //! a background thread to save a snapshot without blocking the analysis.
+        //! @param [in] data Binary snapshot, as built by serializeState().
+        //! @param [in] file_name Name of the snapshot file.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //! @see saveState()
+        //!
+        static bool SaveStateFile(const ByteBlock& data, const UString& file_name, Report& report);
+
+        //!
+        //! Restore the cumulative analysis state from its binary form.
+        //! @param [in] data Address of a binary snapshot, as built by serializeState().
+        //! @param [in] size Size in bytes of the binary snapshot.
+        //! @return True on success, false on invalid snapshot. On error, the analysis context is reset.
+        //! @see loadState()
+        //!
+        bool deserializeState(const uint8_t* data, size_t size);
+
+        class StateSnapshot;
+
+        //!
+        //! Take a snapshot of the cumulative analysis state.
+        //! The snapshot is a copy of the data which are saved by serializeState().
+        //! Taking a snapshot is faster than serializing the state. The snapshot can be
+        //! serialized later, typically in a background thread while the analysis continues.
+        //! @param [out] state Returned snapshot.
+        //! @see StateSnapshot::serialize()
+        //!
+        void getState(StateSnapshot& state) const;
+
         //!
         //! Set the number of consecutive packet errors threshold.
         //! @param [in] count The number of consecutive packet errors after which a packet is
@@ -124,6 +192,18 @@ namespace ts {
             _max_consecutive_suspects = count;
         }
 
+        //!
+        //! Set the sampling mode, typically when the host cannot keep up with the stream.
+        //! In sampling mode, only the TS packet headers and the PSI/SI are analyzed.
+        //! PES and T2-MI packets are not analyzed. The number of packets which were
+        //! analyzed in sampling mode is displayed in the reports.
+        //! @param [in] on True to enter sampling mode, false to exit sampling mode.
+        //!
+        void setSampling(bool on)
+        {
+            _sampling = on;
+        }
+
         //!
         //! Get the list of service ids.
         //! @param [out] list The returned list of service ids.
@@ -173,7 +253,9 @@ namespace ts {
         //!
         class TSDUCKDLL ServiceContext
         {
-            TS_NOBUILD_NOCOPY(ServiceContext);
+            // No default constructor, no assignment. Copies are used in state snapshots.
+            ServiceContext() = delete;
+            ServiceContext& operator=(const ServiceContext&) = delete;
         public:
             // Public members - Synthetic data (do not modify outside ServiceContext methods)
             const uint16_t service_id;         //!< Service id.
@@ -196,6 +278,12 @@ namespace ts {
             //!
             ServiceContext(uint16_t serv_id);
 
+            //!
+            //! Copy constructor.
+            //! @param [in] other Other instance to copy.
+            //!
+            ServiceContext(const ServiceContext& other) = default;
+
             //!
             //! Destructor.
             //!
@@ -248,7 +336,9 @@ namespace ts {
         //!
         class TSDUCKDLL ETIDContext
         {
-            TS_NOBUILD_NOCOPY(ETIDContext);
+            // No default constructor, no assignment. Copies are used in state snapshots.
+            ETIDContext() = delete;
+            ETIDContext& operator=(const ETIDContext&) = delete;
         public:
             // Public members - Synthetic data (do not modify outside ETIDContext methods)
             const ETID etid;                      //!< ETID value.
@@ -270,6 +360,12 @@ namespace ts {
             //! @param [in] etid Extended table id.
             //!
             ETIDContext(const ETID& etid);
+
+            //!
+            //! Copy constructor.
+            //! @param [in] other Other instance to copy.
+            //!
+            ETIDContext(const ETIDContext& other) = default;
         };
 
         //!
@@ -301,7 +397,9 @@ namespace ts {
         //!
         class TSDUCKDLL PIDContext
         {
-            TS_NOBUILD_NOCOPY(PIDContext);
+            // No default constructor, no assignment. Copies are used in state snapshots.
+            PIDContext() = delete;
+            PIDContext& operator=(const PIDContext&) = delete;
         public:
             // Public members - Synthetic data (do not modify outside PIDContext methods)
             const PID     pid;             //!< PID value.
@@ -347,7 +445,7 @@ namespace ts {
             std::map<uint8_t,uint64_t> t2mi_plp_ts;   //!< For T2-MI streams, map key = PLP (Physical Layer Pipe) to value = number of embedded TS packets.
 
             // Public members - Analysis data:
-            uint8_t        cur_continuity;  //!< Current continuity count.
+            uint8_t        cur_continuity;  //!< Current continuity count (CC_MAX if unknown).
             // Public members - Analysis data: Crypto-period evaluation:
             uint8_t        cur_ts_sc;       //!< Current scrambling control in TS header.
             uint64_t       cur_ts_sc_pkt;   //!< First packet index of current crypto-period.
@@ -366,6 +464,12 @@ namespace ts {
             //!
             PIDContext(PID pid, const UString& description = UNREFERENCED);
 
+            //!
+            //! Copy constructor. The ETID contexts in @a sections are shared with @a other.
+            //! @param [in] other Other instance to copy.
+            //!
+            PIDContext(const PIDContext& other) = default;
+
             //!
             //! Register a service id for the PID.
             //! @param [in] service_id A service id which references the PID.
@@ -406,6 +510,53 @@ namespace ts {
         //!
         PIDContextPtr getPID(PID pid, const UString& description = UNREFERENCED);
 
+    public:
+        //!
+        //! A snapshot of the cumulative analysis state, independent from the analyzer.
+        //! @see getState()
+        //!
+        class TSDUCKDLL StateSnapshot
+        {
+            TS_NOCOPY(StateSnapshot);
+        public:
+            //!
+            //! Constructor.
+            //!
+            StateSnapshot();
+
+            //!
+            //! Serialize the snapshot in binary form, as TSAnalyzer::serializeState().
+            //! @param [out] data Returned binary snapshot.
+            //!
+            void serialize(ByteBlock& data) const;
+
+        private:
+            friend class TSAnalyzer;
+            uint16_t             _ts_id;
+            bool                 _ts_id_valid;
+            uint64_t             _ts_pkt_cnt;
+            uint64_t             _invalid_sync;
+            uint64_t             _transport_errors;
+            uint64_t             _suspect_ignored;
+            uint64_t             _sampled_cnt;
+            size_t               _scrambled_pid_cnt;
+            size_t               _pcr_pid_cnt;
+            uint64_t             _ts_bitrate_sum;
+            uint64_t             _ts_bitrate_cnt;
+            Time                 _first_utc;
+            Time                 _first_local;
+            Time                 _first_tdt;
+            Time                 _last_tdt;
+            Time                 _first_tot;
+            Time                 _last_tot;
+            Time                 _first_stt;
+            Time                 _last_stt;
+            UString              _country_code;
+            std::bitset<TID_MAX> _tid_present;
+            PIDContextMap        _pids;       // Copies of the PID contexts, with copies of their ETID contexts.
+            ServiceContextMap    _services;   // Copies of the service contexts.
+        };
+
     protected:
 
         // ----------------------------
@@ -427,6 +578,7 @@ namespace ts {
         uint64_t     _invalid_sync;       //!< Number of packets with invalid sync byte (not 0x47).
         uint64_t     _transport_errors;   //!< Number of packets with transport error.
         uint64_t     _suspect_ignored;    //!< Number of suspect packets, ignored.
+        uint64_t     _sampled_cnt;        //!< Number of packets which were analyzed in sampling mode (headers only).
         size_t       _pid_cnt;            //!< Number of PID's (with actual packets).
         size_t       _scrambled_pid_cnt;  //!< Number of scrambled PID's.
         size_t       _pcr_pid_cnt;        //!< Number of PID's with PCR's.
@@ -517,6 +669,7 @@ namespace ts {
         uint64_t          _preceding_suspects;        // Number of contiguous suspects packets before current packet
         uint64_t          _min_error_before_suspect;  // Required number of invalid packets before starting suspect
         uint64_t          _max_consecutive_suspects;  // Max number of consecutive suspect packets before clearing suspect
+        bool              _sampling;                  // Sampling mode, analyze packet headers and PSI/SI only
         SectionDemux      _demux;                     // PSI tables analysis
         PESDemux          _pes_demux;                 // Audio/video analysis
         T2MIDemux         _t2mi_demux;                // T2-MI analysis
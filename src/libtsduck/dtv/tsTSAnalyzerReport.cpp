@@ -233,6 +233,9 @@ void ts::TSAnalyzerReport::reportTS(Grid& grid, const UString& title)
                     {u"       With PCR's:", UString::Decimal(_pcr_pid_cnt)}});
     grid.putLayout({{u"   Suspect and ignored:", UString::Decimal(_suspect_ignored)},
                     {u"       Unreferenced:", UString::Decimal(_unref_pid_cnt)}});
+    if (_sampled_cnt > 0) {
+        grid.putLayout({{u"   Sampled, headers only:", UString::Decimal(_sampled_cnt)}, {u"", u""}});
+    }
     grid.subSection();
 
     grid.setLayout({grid.bothTruncateLeft(wide ? WIDE_TSBR_COL1 : DEF_TSBR_COL1, u'.'),
@@ -683,6 +686,9 @@ void ts::TSAnalyzerReport::reportErrors(std::ostream& stm, const UString& title)
         error_count++;
         stm << UString::Format(u"TS:%d:0x%X: Unreferenced PID's: %d", {_ts_id, _ts_id, _unref_pid_cnt}) << std::endl;
     }
+    if (_sampled_cnt > 0) {
+        stm << UString::Format(u"INFO: TS packets analyzed in sampling mode, PES not analyzed: %d", {_sampled_cnt}) << std::endl;
+    }
 
     // Report missing standard DVB tables
 
@@ -811,8 +817,11 @@ void ts::TSAnalyzerReport::reportNormalized(std::ostream& stm, const UString& ti
         << "packets=" << _ts_pkt_cnt << ":"
         << "invalidsyncs=" << _invalid_sync << ":"
         << "transporterrors=" << _transport_errors << ":"
-        << "suspectignored=" << _suspect_ignored << ":"
-        << "bytes=" << (PKT_SIZE * _ts_pkt_cnt) << ":"
+        << "suspectignored=" << _suspect_ignored << ":";
+    if (_sampled_cnt > 0) {
+        stm << "sampledpackets=" << _sampled_cnt << ":";
+    }
+    stm << "bytes=" << (PKT_SIZE * _ts_pkt_cnt) << ":"
         << "bitrate=" << _ts_bitrate << ":"
         << "bitrate204=" << ToBitrate204(_ts_bitrate) << ":"
         << "userbitrate=" << _ts_user_bitrate << ":"
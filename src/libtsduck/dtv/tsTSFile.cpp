@@ -30,6 +30,9 @@
 #include "tsTSFile.h"
 #include "tsNullReport.h"
 #include "tsSysUtils.h"
+#if defined(TS_LINUX)
+#include <fcntl.h>
+#endif
 TSDUCK_SOURCE;
 
 
@@ -417,6 +420,34 @@ bool ts::TSFile::seekInternal(uint64_t index, Report& report)
 }
 
 
+//----------------------------------------------------------------------------
+// Preallocate disk space for a file which is open for write.
+//----------------------------------------------------------------------------
+
+bool ts::TSFile::preallocate(uint64_t size, Report& report)
+{
+    if (!_is_open) {
+        report.log(_severity, u"not open");
+        return false;
+    }
+    else if ((_flags & WRITE) == 0) {
+        report.log(_severity, u"file %s is not open for write", {getDisplayFileName()});
+        return false;
+    }
+
+#if defined(TS_LINUX)
+    // Standard output is not a regular file, ignore it.
+    if (!_filename.empty() && ::fallocate(_fd, FALLOC_FL_KEEP_SIZE, 0, off_t(size)) < 0) {
+        const ErrorCode err = LastErrorCode();
+        report.log(_severity, u"error preallocating %'d bytes in %s: %s", {size, getDisplayFileName(), ErrorCodeMessage(err)});
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Seek the file to the specified packet_index plus the start_offset.
 //----------------------------------------------------------------------------
@@ -179,6 +179,18 @@ namespace ts {
         //!
         bool write(const TSPacket* buffer, size_t packet_count, Report& report);
 
+        //!
+        //! Preallocate disk space for a file which is open for write.
+        //! This is a hint to the file system to reduce fragmentation when the final size
+        //! of the file is approximately known in advance. The logical size of the file
+        //! is not modified. This operation is currently implemented on Linux only and
+        //! does nothing on other operating systems.
+        //! @param [in] size Number of bytes to preallocate from the beginning of the file.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool preallocate(uint64_t size, Report& report);
+
         //!
         //! Abort any currenly read/write operation in progress.
         //! The file is left in a broken state and can be only closed.
@@ -898,6 +898,75 @@ bool ts::TSPacket::isDuplicate(const TSPacket& other) const
 }
 
 
+//----------------------------------------------------------------------------
+// Check the synchronization of contiguous TS packets.
+//----------------------------------------------------------------------------
+
+size_t ts::TSPacket::CheckSync(const TSPacket* packets, size_t count, size_t& tei_count, size_t& null_count)
+{
+    // Only the 3 first bytes of each packet are used. Since they are 188 bytes apart,
+    // we use branch-free accumulations on groups of packets instead of wide registers.
+    size_t tei = 0;
+    size_t null = 0;
+    size_t n = 0;
+
+    // Process groups of 4 packets while they are all synchronized.
+    while (n + 4 <= count) {
+        const uint8_t* const p0 = packets[n].b;
+        const uint8_t* const p1 = packets[n + 1].b;
+        const uint8_t* const p2 = packets[n + 2].b;
+        const uint8_t* const p3 = packets[n + 3].b;
+        if (((p0[0] ^ SYNC_BYTE) | (p1[0] ^ SYNC_BYTE) | (p2[0] ^ SYNC_BYTE) | (p3[0] ^ SYNC_BYTE)) != 0) {
+            break;
+        }
+        tei += (p0[1] >> 7) + (p1[1] >> 7) + (p2[1] >> 7) + (p3[1] >> 7);
+        null += size_t((GetUInt16(p0 + 1) & 0x1FFF) == PID_NULL) +
+                size_t((GetUInt16(p1 + 1) & 0x1FFF) == PID_NULL) +
+                size_t((GetUInt16(p2 + 1) & 0x1FFF) == PID_NULL) +
+                size_t((GetUInt16(p3 + 1) & 0x1FFF) == PID_NULL);
+        n += 4;
+    }
+
+    // Process remaining packets, up to the first unsynchronized one.
+    for (; n < count && packets[n].b[0] == SYNC_BYTE; ++n) {
+        tei += packets[n].b[1] >> 7;
+        null += size_t((GetUInt16(packets[n].b + 1) & 0x1FFF) == PID_NULL);
+    }
+
+    tei_count = tei;
+    null_count = null;
+    return n;
+}
+
+
+//----------------------------------------------------------------------------
+// Find the first TS packet in a batch with a PID in a set of PID's.
+//----------------------------------------------------------------------------
+
+size_t ts::TSPacket::FindPID(const TSPacket* packets, size_t count, const PIDSet& pids)
+{
+    size_t n = 0;
+
+    // Test groups of 4 packets with one single branch per group.
+    while (n + 4 <= count) {
+        if (pids[GetUInt16(packets[n].b + 1) & 0x1FFF] |
+            pids[GetUInt16(packets[n + 1].b + 1) & 0x1FFF] |
+            pids[GetUInt16(packets[n + 2].b + 1) & 0x1FFF] |
+            pids[GetUInt16(packets[n + 3].b + 1) & 0x1FFF])
+        {
+            break;
+        }
+        n += 4;
+    }
+
+    // Locate the exact packet in the last group.
+    while (n < count && !pids[GetUInt16(packets[n].b + 1) & 0x1FFF]) {
+        ++n;
+    }
+    return n;
+}
+
+
 //----------------------------------------------------------------------------
 // Locate contiguous TS packets into a buffer.
 //----------------------------------------------------------------------------
@@ -846,6 +846,28 @@ namespace ts {
         //!
         static void Copy(uint8_t* dest, const TSPacket* source, size_t count = 1);
 
+        //!
+        //! Check the synchronization of contiguous TS packets and count some categories of packets.
+        //! This is a fast bulk scan, typically used on a buffer of packets from an input device.
+        //! @param [in] packets Address of the first contiguous TS packet to check.
+        //! @param [in] count Number of TS packets to check.
+        //! @param [out] tei_count Number of synchronized packets with the transport_error_indicator set.
+        //! @param [out] null_count Number of synchronized null packets.
+        //! @return Number of leading packets with a valid sync byte.
+        //! This is @a count when all packets are synchronized.
+        //!
+        static size_t CheckSync(const TSPacket* packets, size_t count, size_t& tei_count, size_t& null_count);
+
+        //!
+        //! Find the first TS packet in a batch of contiguous packets with a PID in a set of PID's.
+        //! This is a fast bulk scan, typically used as an "any in batch" membership test.
+        //! @param [in] packets Address of the first contiguous TS packet to check.
+        //! @param [in] count Number of TS packets to check.
+        //! @param [in] pids Set of PID's to search.
+        //! @return Index of the first packet with a PID in @a pids or @a count if there is none.
+        //!
+        static size_t FindPID(const TSPacket* packets, size_t count, const PIDSet& pids);
+
         //!
         //! Locate contiguous TS packets into a buffer.
         //!
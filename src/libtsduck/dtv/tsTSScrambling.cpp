@@ -28,6 +28,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsTSScrambling.h"
+#include "tsDESBatch.h"
 #include "tsNames.h"
 #include "tsArgs.h"
 TSDUCK_SOURCE;
@@ -52,7 +53,13 @@ ts::TSScrambling::TSScrambling(Report& report, uint8_t scrambling) :
     _idsa(),
     _aescbc(),
     _aesctr(),
-    _scrambler{nullptr, nullptr}
+    _scte52(),
+    _scrambler{nullptr, nullptr},
+    _batch_encrypt(false),
+    _batch_scv(SC_CLEAR),
+    _batch_packets(),
+    _batch_data(),
+    _batch_sizes()
 {
     setScramblingType(scrambling);
 }
@@ -72,7 +79,13 @@ ts::TSScrambling::TSScrambling(const TSScrambling& other) :
     _idsa(),
     _aescbc(),
     _aesctr(),
-    _scrambler{nullptr, nullptr}
+    _scte52(),
+    _scrambler{nullptr, nullptr},
+    _batch_encrypt(false),
+    _batch_scv(SC_CLEAR),
+    _batch_packets(),
+    _batch_data(),
+    _batch_sizes()
 {
     setScramblingType(_scrambling_type);
     _dvbcsa[0].setEntropyMode(other._dvbcsa[0].entropyMode());
@@ -94,7 +107,13 @@ ts::TSScrambling::TSScrambling(TSScrambling&& other) :
     _idsa(),
     _aescbc(),
     _aesctr(),
-    _scrambler{nullptr, nullptr}
+    _scte52(),
+    _scrambler{nullptr, nullptr},
+    _batch_encrypt(false),
+    _batch_scv(SC_CLEAR),
+    _batch_packets(),
+    _batch_data(),
+    _batch_sizes()
 {
     setScramblingType(_scrambling_type);
     _dvbcsa[0].setEntropyMode(other._dvbcsa[0].entropyMode());
@@ -110,6 +129,9 @@ bool ts::TSScrambling::setScramblingType(uint8_t scrambling, bool overrideExplic
 {
     if (overrideExplicit || !_explicit_type) {
 
+        // Pending packets are processed with the previous algorithm. Errors are reported there.
+        flush();
+
         // Select the right pair of scramblers.
         switch (scrambling) {
             case SCRAMBLING_DVB_CSA1:
@@ -133,6 +155,10 @@ bool ts::TSScrambling::setScramblingType(uint8_t scrambling, bool overrideExplic
                 _scrambler[0] = &_aesctr[0];
                 _scrambler[1] = &_aesctr[1];
                 break;
+            case SCRAMBLING_DUCK_SCTE52:
+                _scrambler[0] = &_scte52[0];
+                _scrambler[1] = &_scte52[1];
+                break;
             default:
                 // Fallback to DVB-CSA2 if no scrambler was previously defined.
                 if (_scrambler[0] == nullptr || _scrambler[1] == nullptr) {
@@ -160,6 +186,7 @@ bool ts::TSScrambling::setScramblingType(uint8_t scrambling, bool overrideExplic
 
 void ts::TSScrambling::setEntropyMode(DVBCSA2::EntropyMode mode)
 {
+    flush();
     _dvbcsa[0].setEntropyMode(mode);
     _dvbcsa[1].setEntropyMode(mode);
 }
@@ -202,10 +229,27 @@ void ts::TSScrambling::defineArgs(Args &args) const
 
     args.option(u"iv", 0, Args::STRING);
     args.help(u"iv",
-              u"With --aes-cbc or --aes-ctr, specifies a fixed initialization vector for all TS packets. "
-              u"The value must be a string of 32 hexadecimal digits. "
+              u"With --aes-cbc, --aes-ctr or --scte52, specifies a fixed initialization vector for all TS packets. "
+              u"The value must be a string of 32 hexadecimal digits (16 digits with --scte52). "
               u"The default IV is all zeroes.");
 
+    args.option(u"scte52");
+    args.help(u"scte52",
+              u"Use DES scrambling in ANSI/SCTE 52 mode (formerly DVS 042) instead of DVB-CSA2 (the default). "
+              u"The control words are 8-byte long. "
+              u"The residue is included in the scrambling. "
+              u"Specify a fixed initialization vector using the --iv option.\n\n"
+              u"Note that ANSI/SCTE 52 has no standard value in the scrambling_descriptor. "
+              u"The TSDuck scrambler automatically sets the scrambling_descriptor with "
+              u"user-defined value " + UString::Hexa(uint8_t(SCRAMBLING_DUCK_SCTE52)) + u".");
+
+    args.option(u"short-iv", 0, Args::STRING);
+    args.help(u"short-iv",
+              u"With --scte52, specifies a distinct initialization vector for payloads which are "
+              u"shorter than 8 bytes (the \"whitener2\" of ANSI/SCTE 52 2008). "
+              u"The value must be a string of 16 hexadecimal digits. "
+              u"By default, the same IV as --iv is used, as in ANSI/SCTE 52 2003.");
+
     args.option(u"ctr-counter-bits", 0, Args::UNSIGNED);
     args.help(u"ctr-counter-bits",
               u"With --aes-ctr, specifies the size in bits of the counter part. "
@@ -261,11 +305,12 @@ bool ts::TSScrambling::loadArgs(DuckContext& duck, Args& args)
         args.present(u"dvb-cissa") +
         args.present(u"dvb-csa2") +
         args.present(u"aes-cbc") +
-        args.present(u"aes-ctr");
+        args.present(u"aes-ctr") +
+        args.present(u"scte52");
 
     // Set the scrambler to use.
     if (algo_count > 1) {
-        args.error(u"--atis-idsa, --dvb-cissa, --dvb-csa2, --aes-cbc, --aes-ctr are mutually exclusive");
+        args.error(u"--atis-idsa, --dvb-cissa, --dvb-csa2, --aes-cbc, --aes-ctr, --scte52 are mutually exclusive");
     }
     else if (args.present(u"atis-idsa")) {
         setScramblingType(SCRAMBLING_ATIS_IIF_IDSA);
@@ -279,6 +324,9 @@ bool ts::TSScrambling::loadArgs(DuckContext& duck, Args& args)
     else if (args.present(u"aes-ctr")) {
         setScramblingType(SCRAMBLING_DUCK_AES_CTR);
     }
+    else if (args.present(u"scte52")) {
+        setScramblingType(SCRAMBLING_DUCK_SCTE52);
+    }
     else {
         setScramblingType(SCRAMBLING_DVB_CSA2);
     }
@@ -291,10 +339,15 @@ bool ts::TSScrambling::loadArgs(DuckContext& duck, Args& args)
     setEntropyMode(args.present(u"no-entropy-reduction") ? DVBCSA2::FULL_CW : DVBCSA2::REDUCE_ENTROPY);
 
     // Set AES-CBC/CTR initialization vector. The default is all zeroes.
+    // With ANSI/SCTE 52, --iv is a DES block instead.
+    const bool scte52 = _scrambling_type == SCRAMBLING_DUCK_SCTE52;
+    const size_t iv_size = scte52 ? DES::BLOCK_SIZE : AES::BLOCK_SIZE;
     ByteBlock iv(AES::BLOCK_SIZE, 0x00);
+    ByteBlock des_iv(DES::BLOCK_SIZE, 0x00);
+    ByteBlock& user_iv(scte52 ? des_iv : iv);
     const UString hex_iv(args.value(u"iv"));
-    if (!hex_iv.empty() && (!hex_iv.hexaDecode(iv) || iv.size() != AES::BLOCK_SIZE)) {
-        args.error(u"invalid initialization vector \"%s\", specify %d hexa digits", {hex_iv, 2 * AES::BLOCK_SIZE});
+    if (!hex_iv.empty() && (!hex_iv.hexaDecode(user_iv) || user_iv.size() != iv_size)) {
+        args.error(u"invalid initialization vector \"%s\", specify %d hexa digits", {hex_iv, 2 * iv_size});
     }
     else if (!_aescbc[0].setIV(iv.data(), iv.size()) ||
              !_aescbc[1].setIV(iv.data(), iv.size()) ||
@@ -304,6 +357,20 @@ bool ts::TSScrambling::loadArgs(DuckContext& duck, Args& args)
         args.error(u"error setting AES initialization vector");
     }
 
+    // Set ANSI/SCTE 52 initialization vectors. By default, short payloads use the same IV (2003 version).
+    ByteBlock short_iv(des_iv);
+    const UString hex_short_iv(args.value(u"short-iv"));
+    if (!hex_short_iv.empty() && (!hex_short_iv.hexaDecode(short_iv) || short_iv.size() != DES::BLOCK_SIZE)) {
+        args.error(u"invalid short initialization vector \"%s\", specify %d hexa digits", {hex_short_iv, 2 * DES::BLOCK_SIZE});
+    }
+    else if (!_scte52[0].setIV(des_iv.data(), des_iv.size()) ||
+             !_scte52[1].setIV(des_iv.data(), des_iv.size()) ||
+             !_scte52[0].setShortIV(short_iv.data(), short_iv.size()) ||
+             !_scte52[1].setShortIV(short_iv.data(), short_iv.size()))
+    {
+        args.error(u"error setting ANSI/SCTE 52 initialization vectors");
+    }
+
     // Set the size of the counter part with CTS mode.
     // The default is zero, meaning half nounce / half counter.
     const size_t counter_bits = args.intValue<size_t>(u"ctr-counter-bits");
@@ -361,6 +428,9 @@ bool ts::TSScrambling::start()
     // Point next CW to end of list. Will loop to first one.
     _next_cw = _cw_list.end();
 
+    // Forget packets from a previous session which were never flushed.
+    clearBatch();
+
     // Create the output file for control words.
     if (!_out_cw_name.empty()) {
         _out_cw_file.open(_out_cw_name.toUTF8().c_str(), std::ios::out);
@@ -425,6 +495,7 @@ bool ts::TSScrambling::handleBlockCipherAlert(BlockCipher& cipher, AlertReason r
 
 void ts::TSScrambling::rewindFixedCW()
 {
+    flush();
     _next_cw = _cw_list.end();
     _encrypt_scv = SC_CLEAR;
     _decrypt_scv = SC_CLEAR;
@@ -466,9 +537,12 @@ bool ts::TSScrambling::setCW(const ByteBlock& cw, int parity)
     CipherChaining* algo = _scrambler[parity & 1];
     assert(algo != nullptr);
 
+    // Pending packets are processed with the previous key.
+    const bool ok = flush();
+
     if (algo->setKey(cw.data(), cw.size())) {
         _report.debug(u"using scrambling key: " + UString::Dump(cw, UString::SINGLE_LINE));
-        return true;
+        return ok;
     }
     else {
         _report.error(u"error setting %d-byte key to %s", {cw.size(), algo->name()});
@@ -483,6 +557,11 @@ bool ts::TSScrambling::setCW(const ByteBlock& cw, int parity)
 
 bool ts::TSScrambling::setEncryptParity(int parity)
 {
+    // Pending packets are encrypted with the previous parity.
+    if (!flush()) {
+        return false;
+    }
+
     // Remember parity.
     const uint8_t previous_scv = _encrypt_scv;
     _encrypt_scv = SC_EVEN_KEY | (parity & 1);
@@ -492,6 +571,23 @@ bool ts::TSScrambling::setEncryptParity(int parity)
 }
 
 
+//----------------------------------------------------------------------------
+// Size of the part of the payload which is encrypted with a given algorithm.
+//----------------------------------------------------------------------------
+
+size_t ts::TSScrambling::ScrambledSize(const TSPacket& pkt, const CipherChaining* algo)
+{
+    // Check if the residue shall be included in the scrambling.
+    size_t psize = pkt.getPayloadSize();
+    if (!algo->residueAllowed()) {
+        // Remove the residue from the payload.
+        assert(algo->blockSize() != 0);
+        psize -= psize % algo->blockSize();
+    }
+    return psize;
+}
+
+
 //----------------------------------------------------------------------------
 // Encrypt a TS packet with the current parity and corresponding CW.
 //----------------------------------------------------------------------------
@@ -519,15 +615,8 @@ bool ts::TSScrambling::encrypt(TSPacket& pkt)
     CipherChaining* algo = _scrambler[_encrypt_scv & 1];
     assert(algo != nullptr);
 
-    // Check if the residue shall be included in the scrambling.
-    size_t psize = pkt.getPayloadSize();
-    if (!algo->residueAllowed()) {
-        // Remove the residue from the payload.
-        assert(algo->blockSize() != 0);
-        psize -= psize % algo->blockSize();
-    }
-
     // Encrypt the packet.
+    const size_t psize = ScrambledSize(pkt, algo);
     const bool ok = psize == 0 || algo->encryptInPlace(pkt.getPayload(), psize);
     if (ok) {
         pkt.setScrambling(_encrypt_scv);
@@ -564,15 +653,8 @@ bool ts::TSScrambling::decrypt(TSPacket& pkt)
     CipherChaining* algo = _scrambler[_decrypt_scv & 1];
     assert(algo != nullptr);
 
-    // Check if the residue shall be included in the scrambling.
-    size_t psize = pkt.getPayloadSize();
-    if (!algo->residueAllowed()) {
-        // Remove the residue from the payload.
-        assert(algo->blockSize() != 0);
-        psize -= psize % algo->blockSize();
-    }
-
     // Decrypt the packet.
+    const size_t psize = ScrambledSize(pkt, algo);
     const bool ok = psize == 0 || algo->decryptInPlace(pkt.getPayload(), psize);
     if (ok) {
         pkt.setScrambling(SC_CLEAR);
@@ -582,3 +664,130 @@ bool ts::TSScrambling::decrypt(TSPacket& pkt)
     }
     return ok;
 }
+
+
+//----------------------------------------------------------------------------
+// Encrypt or decrypt TS packets later, in a batch.
+//----------------------------------------------------------------------------
+
+bool ts::TSScrambling::encryptLater(TSPacket& pkt)
+{
+    // Same checks as encrypt().
+    if (pkt.isScrambled()) {
+        _report.error(u"try to scramble an already scrambled packet");
+        return false;
+    }
+    if (!pkt.hasPayload()) {
+        return true;
+    }
+    if (_encrypt_scv == SC_CLEAR && !setEncryptParity(SC_EVEN_KEY)) {
+        return false;
+    }
+    assert(_encrypt_scv == SC_EVEN_KEY || _encrypt_scv == SC_ODD_KEY);
+    return addToBatch(pkt, true, _encrypt_scv);
+}
+
+bool ts::TSScrambling::decryptLater(TSPacket& pkt)
+{
+    // Same checks as decrypt().
+    const uint8_t scv = pkt.getScrambling();
+    if (scv != SC_EVEN_KEY && scv != SC_ODD_KEY) {
+        return true;
+    }
+    const uint8_t previous_scv = _decrypt_scv;
+    _decrypt_scv = scv;
+    if (hasFixedCW() && previous_scv != _decrypt_scv && !setNextFixedCW(_decrypt_scv)) {
+        return false;
+    }
+    return addToBatch(pkt, false, _decrypt_scv);
+}
+
+
+//----------------------------------------------------------------------------
+// Batch processing work areas.
+//----------------------------------------------------------------------------
+
+bool ts::TSScrambling::addToBatch(TSPacket& pkt, bool encrypt, uint8_t scv)
+{
+    // All packets in a batch use the same algorithm and key.
+    bool ok = true;
+    if (!_batch_packets.empty() && (encrypt != _batch_encrypt || scv != _batch_scv)) {
+        ok = flush();
+    }
+    _batch_encrypt = encrypt;
+    _batch_scv = scv;
+
+    _batch_packets.push_back(&pkt);
+    const size_t psize = ScrambledSize(pkt, _scrambler[scv & 1]);
+    if (psize > 0) {
+        _batch_data.push_back(pkt.getPayload());
+        _batch_sizes.push_back(psize);
+    }
+
+    // A batch of DESBatch::BATCH_SIZE packets fills the bitsliced DES engine of ANSI/SCTE 52.
+    if (_batch_packets.size() >= DESBatch::BATCH_SIZE) {
+        ok = flush() && ok;
+    }
+    return ok;
+}
+
+void ts::TSScrambling::clearBatch()
+{
+    _batch_packets.clear();
+    _batch_data.clear();
+    _batch_sizes.clear();
+}
+
+bool ts::TSScrambling::flush()
+{
+    bool ok = true;
+    if (!_batch_packets.empty()) {
+        CipherChaining* algo = _scrambler[_batch_scv & 1];
+        assert(algo != nullptr);
+        if (_batch_encrypt) {
+            ok = algo->encryptBatch(_batch_data.data(), _batch_sizes.data(), _batch_data.size());
+        }
+        else {
+            ok = algo->decryptBatch(_batch_data.data(), _batch_sizes.data(), _batch_data.size());
+        }
+        if (ok) {
+            const uint8_t scv = _batch_encrypt ? _batch_scv : uint8_t(SC_CLEAR);
+            for (auto it = _batch_packets.begin(); it != _batch_packets.end(); ++it) {
+                (*it)->setScrambling(scv);
+            }
+        }
+        else {
+            _report.error(u"packet %s error using %s", {_batch_encrypt ? u"encryption" : u"decryption", algo->name()});
+        }
+        clearBatch();
+    }
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Encrypt several TS packets with the current parity and corresponding CW.
+//----------------------------------------------------------------------------
+
+bool ts::TSScrambling::encrypt(TSPacket* pkts, size_t count)
+{
+    bool ok = true;
+    for (size_t i = 0; i < count; ++i) {
+        ok = encryptLater(pkts[i]) && ok;
+    }
+    return flush() && ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Decrypt several TS packets with the CW corresponding to their parity.
+//----------------------------------------------------------------------------
+
+bool ts::TSScrambling::decrypt(TSPacket* pkts, size_t count)
+{
+    bool ok = true;
+    for (size_t i = 0; i < count; ++i) {
+        ok = decryptLater(pkts[i]) && ok;
+    }
+    return flush() && ok;
+}
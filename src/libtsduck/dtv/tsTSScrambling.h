@@ -43,6 +43,7 @@
 #include "tsCBC.h"
 #include "tsCTR.h"
 #include "tsIDSA.h"
+#include "tsSCTE52.h"
 #include "tsMPEG.h"
 
 namespace ts {
@@ -55,7 +56,13 @@ namespace ts {
     //! The scrambling type is indicated by a constant as present in a scrambling_descriptor.
     //! Currently, SCRAMBLING_DVB_CSA2, SCRAMBLING_DVB_CISSA1 and SCRAMBLING_ATIS_IIF_IDSA
     //! are supported as standard scrambling algorithms. Additionally, the non-standard
-    //! algorithms are also supported: SCRAMBLING_DUCK_AES_CBC, SCRAMBLING_DUCK_AES_CTR.
+    //! algorithms are also supported: SCRAMBLING_DUCK_AES_CBC, SCRAMBLING_DUCK_AES_CTR,
+    //! SCRAMBLING_DUCK_SCTE52 (ANSI/SCTE 52 has no standard value in a scrambling_descriptor).
+    //!
+    //! Several packets can be encrypted or decrypted at once, either from an array of packets
+    //! or by deferring the processing of individual packets using encryptLater(), decryptLater()
+    //! and flush(). With ANSI/SCTE 52, the DES blocks of all packets are then processed in
+    //! parallel, which is much faster.
     //!
     //! With fixed control words from the command line:
     //! - For encryption, the next key is used each time setEncryptParity() is called
@@ -192,6 +199,51 @@ namespace ts {
         //!
         bool decrypt(TSPacket& pkt);
 
+        //!
+        //! Encrypt several TS packets with the current parity and corresponding CW.
+        //! The result is the same as calling encrypt() on each packet.
+        //! @param [in,out] pkts Address of an array of packets to encrypt.
+        //! @param [in] count Number of packets in @a pkts.
+        //! @return True on success, false on error. An already encrypted packet is an error
+        //! but all other packets are encrypted.
+        //!
+        bool encrypt(TSPacket* pkts, size_t count);
+
+        //!
+        //! Decrypt several TS packets with the CW corresponding to the parity in each packet.
+        //! The result is the same as calling decrypt() on each packet.
+        //! @param [in,out] pkts Address of an array of packets to decrypt.
+        //! @param [in] count Number of packets in @a pkts.
+        //! @return True on success, false on error. Clear packets are not an error.
+        //!
+        bool decrypt(TSPacket* pkts, size_t count);
+
+        //!
+        //! Encrypt a TS packet later, in a batch with other packets.
+        //! The packet is encrypted with the current parity and corresponding CW, at the latest when
+        //! flush() is called. The pending packets are also encrypted before the control words, the
+        //! parity or the scrambling type are changed. The packet shall not be moved, modified or
+        //! freed until then.
+        //! @param [in,out] pkt The packet to encrypt.
+        //! @return True on success, false on error. An already encrypted packet is an error.
+        //!
+        bool encryptLater(TSPacket& pkt);
+
+        //!
+        //! Decrypt a TS packet later, in a batch with other packets.
+        //! The packet is decrypted with the CW corresponding to its parity, at the latest when
+        //! flush() is called. Same constraints as encryptLater().
+        //! @param [in,out] pkt The packet to decrypt.
+        //! @return True on success, false on error. A clear packet is not an error.
+        //!
+        bool decryptLater(TSPacket& pkt);
+
+        //!
+        //! Encrypt or decrypt all pending packets from encryptLater() or decryptLater().
+        //! @return True on success, false on error.
+        //!
+        bool flush();
+
     private:
         // List of control words
         typedef std::list<ByteBlock> CWList;
@@ -210,8 +262,25 @@ namespace ts {
         IDSA             _idsa[2];
         CBC<AES>         _aescbc[2];
         CTR<AES>         _aesctr[2];
+        SCTE52_2008      _scte52[2];
         CipherChaining*  _scrambler[2];
 
+        // Pending packets for batch processing, all with the same direction and parity.
+        bool                   _batch_encrypt;  // Encrypt (true) or decrypt (false) the batch.
+        uint8_t                _batch_scv;      // Parity of the batch (SC_EVEN_KEY or SC_ODD_KEY).
+        std::vector<TSPacket*> _batch_packets;  // Packets to update in the batch.
+        std::vector<uint8_t*>  _batch_data;     // Payloads to encrypt or decrypt.
+        std::vector<size_t>    _batch_sizes;    // Sizes of payloads.
+
+        // Size of the part of the payload which is encrypted with a given algorithm.
+        static size_t ScrambledSize(const TSPacket& pkt, const CipherChaining* algo);
+
+        // Add a packet in the current batch, process the batch when full.
+        bool addToBatch(TSPacket& pkt, bool encrypt, uint8_t scv);
+
+        // Clear the current batch.
+        void clearBatch();
+
         // Set the next fixed control word as scrambling key.
         bool setNextFixedCW(int parity);
 
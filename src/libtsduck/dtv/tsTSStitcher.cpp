@@ -0,0 +1,496 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSStitcher.h"
+#include "tsTSFile.h"
+#include "tsCRC32.h"
+#include "tsMemory.h"
+TSDUCK_SOURCE;
+
+// Number of packets per file I/O.
+#define STITCH_BUFFER_PACKETS 1024
+
+// Last PID which is always considered as PSI/SI.
+#define LAST_SI_PID 0x001F
+
+
+//----------------------------------------------------------------------------
+// Constructor and destructor.
+//----------------------------------------------------------------------------
+
+ts::TSStitcher::TSStitcher(Report& report) :
+    _report(report),
+    _filename(),
+    _file(),
+    _is_open(false),
+    _chunks(0),
+    _packets(0),
+    _cc_fixes(0),
+    _version_fixes(0),
+    _cc_pending(),
+    _last_cc(),
+    _cc_shift(),
+    _psi_pids(),
+    _sections(),
+    _last_sections(),
+    _last_versions(),
+    _version_map(),
+    _pending()
+{
+}
+
+ts::TSStitcher::~TSStitcher()
+{
+    close();
+}
+
+
+//----------------------------------------------------------------------------
+// Create the output file.
+//----------------------------------------------------------------------------
+
+bool ts::TSStitcher::open(const UString& filename)
+{
+    if (_is_open) {
+        _report.error(u"output file %s already open", {_filename});
+        return false;
+    }
+
+    // Read/write mode: the output file is patched when table versions are remapped.
+    _filename = filename;
+    _file.open(filename.toUTF8().c_str(), std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!_file) {
+        _report.error(u"cannot create file %s", {filename});
+        return false;
+    }
+
+    _is_open = true;
+    _chunks = 0;
+    _packets = 0;
+    _cc_fixes = 0;
+    _version_fixes = 0;
+    _cc_pending.reset();
+    TS_ZERO(_cc_shift);
+    for (PID pid = 0; pid < PID_MAX; ++pid) {
+        _last_cc[pid] = INVALID_CC;
+    }
+    _psi_pids.reset();
+    for (PID pid = 0; pid <= LAST_SI_PID; ++pid) {
+        _psi_pids.set(pid);
+    }
+    _sections.clear();
+    _last_sections.clear();
+    _last_versions.clear();
+    _version_map.clear();
+    _pending.clear();
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Close the output file.
+//----------------------------------------------------------------------------
+
+bool ts::TSStitcher::close()
+{
+    if (!_is_open) {
+        return false;
+    }
+    flushAllPending();
+    _file.close();
+    _is_open = false;
+    if (!_file) {
+        _report.error(u"error closing file %s", {_filename});
+        return false;
+    }
+    _report.debug(u"stitched %'d packets in %d chunks, %'d CC fixed, %'d versions fixed", {_packets, _chunks, _cc_fixes, _version_fixes});
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Start a new chunk.
+//----------------------------------------------------------------------------
+
+void ts::TSStitcher::startChunk()
+{
+    // Tables which are incomplete at the end of the previous chunk are decided on their received sections.
+    if (_is_open) {
+        flushAllPending();
+        _file.seekp(0, std::ios::end);
+    }
+
+    _chunks++;
+
+    // The CC shift of all PID's is computed on their first packet in the chunk.
+    _cc_pending.set();
+
+    // Sections cannot span two chunks.
+    _sections.clear();
+
+    // Version numbers of each chunk are independent.
+    _version_map.clear();
+}
+
+
+//----------------------------------------------------------------------------
+// Append the content of a file as the next chunk.
+//----------------------------------------------------------------------------
+
+bool ts::TSStitcher::addFile(const UString& filename)
+{
+    TSFile file;
+    if (!file.openRead(filename, 0, _report)) {
+        return false;
+    }
+
+    startChunk();
+
+    std::vector<TSPacket> buffer(STITCH_BUFFER_PACKETS);
+    bool success = true;
+    size_t count = 0;
+    while (success && (count = file.read(buffer.data(), buffer.size(), _report)) > 0) {
+        success = addPackets(buffer.data(), count);
+    }
+
+    file.close(_report);
+    return success;
+}
+
+
+//----------------------------------------------------------------------------
+// Append packets to the current chunk.
+//----------------------------------------------------------------------------
+
+bool ts::TSStitcher::addPackets(TSPacket* packets, size_t count)
+{
+    if (!_is_open) {
+        _report.error(u"stitcher output file not open");
+        return false;
+    }
+    if (_chunks == 0) {
+        startChunk();
+    }
+
+    // Shift continuity counters.
+    for (size_t i = 0; i < count; ++i) {
+        TSPacket& pkt(packets[i]);
+        const PID pid = pkt.getPID();
+        if (pid == PID_NULL) {
+            continue;
+        }
+        if (_cc_pending.test(pid)) {
+            // First packet of this PID in the chunk, compute the CC shift from the previous chunk.
+            _cc_pending.reset(pid);
+            _cc_shift[pid] = 0;
+            if (_last_cc[pid] != INVALID_CC && !pkt.getDiscontinuityIndicator()) {
+                const uint8_t expected = pkt.hasPayload() ? ((_last_cc[pid] + 1) & CC_MASK) : _last_cc[pid];
+                _cc_shift[pid] = (expected - pkt.getCC()) & CC_MASK;
+            }
+        }
+        if (_cc_shift[pid] != 0) {
+            pkt.setCC((pkt.getCC() + _cc_shift[pid]) & CC_MASK);
+            _cc_fixes++;
+        }
+        _last_cc[pid] = pkt.getCC();
+    }
+
+    // Write packets before analyzing sections, the sections may need to be patched.
+    const uint64_t position = _packets * PKT_SIZE;
+    _file.write(reinterpret_cast<const char*>(packets), std::streamsize(count * PKT_SIZE));
+    if (!_file) {
+        _report.error(u"error writing file %s", {_filename});
+        return false;
+    }
+
+    // Reconcile table versions. PSI/SI packets are sparse, skip other packets in bulk.
+    for (size_t i = TSPacket::FindPID(packets, count, _psi_pids); i < count; i += 1 + TSPacket::FindPID(packets + i + 1, count - i - 1, _psi_pids)) {
+        feedSections(packets[i], position + i * PKT_SIZE);
+    }
+
+    // Return to end of file after patches.
+    _file.seekp(0, std::ios::end);
+    _packets += count;
+    return bool(_file);
+}
+
+
+//----------------------------------------------------------------------------
+// Get the file position of a section offset.
+//----------------------------------------------------------------------------
+
+uint64_t ts::TSStitcher::SectionContext::position(size_t offset) const
+{
+    assert(!parts.empty());
+    size_t index = parts.size() - 1;
+    while (index > 0 && parts[index].first > offset) {
+        index--;
+    }
+    return parts[index].second + (offset - parts[index].first);
+}
+
+
+//----------------------------------------------------------------------------
+// Process PSI/SI content of a packet.
+//----------------------------------------------------------------------------
+
+void ts::TSStitcher::feedSections(const TSPacket& pkt, uint64_t position)
+{
+    const PID pid = pkt.getPID();
+    const uint8_t* data = pkt.getPayload();
+    size_t size = pkt.getPayloadSize();
+    position += pkt.getHeaderSize();
+
+    if (size == 0) {
+        return;
+    }
+
+    SectionContext& sect(_sections[pid]);
+
+    if (!pkt.getPUSI()) {
+        // Continuation of a section, if one was started.
+        if (!sect.data.empty()) {
+            appendSection(pid, sect, data, size, position);
+        }
+        return;
+    }
+
+    // Skip pointer field.
+    const size_t pointer = data[0];
+    data++; size--; position++;
+    if (pointer > size) {
+        sect.clear();
+        return;
+    }
+
+    // End of previous section, if any. If still incomplete, it is corrupted.
+    if (!sect.data.empty()) {
+        appendSection(pid, sect, data, pointer, position);
+        sect.clear();
+    }
+    data += pointer; size -= pointer; position += pointer;
+
+    // New sections, up to stuffing.
+    while (size > 0 && data[0] != 0xFF) {
+        const size_t used = appendSection(pid, sect, data, size, position);
+        data += used; size -= used; position += used;
+        if (!sect.data.empty()) {
+            // Incomplete section, continued in next packet.
+            break;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Append data to a section, return the number of used bytes.
+//----------------------------------------------------------------------------
+
+size_t ts::TSStitcher::appendSection(PID pid, SectionContext& sect, const uint8_t* data, size_t size, uint64_t position)
+{
+    size_t used = 0;
+    while (used < size) {
+        // Expected section size: need the first 3 bytes to get the section length.
+        const size_t total = sect.data.size() < 3 ? 3 : 3 + (GetUInt16(sect.data.data() + 1) & 0x0FFF);
+        const size_t chunk = std::min(size - used, total - sect.data.size());
+        sect.parts.push_back(std::make_pair(sect.data.size(), position + used));
+        sect.data.append(data + used, chunk);
+        used += chunk;
+        if (sect.data.size() >= 3 && sect.data.size() == 3 + size_t(GetUInt16(sect.data.data() + 1) & 0x0FFF)) {
+            processSection(pid, sect);
+            sect.clear();
+            break;
+        }
+    }
+    return used;
+}
+
+
+//----------------------------------------------------------------------------
+// Process a complete section.
+//----------------------------------------------------------------------------
+
+void ts::TSStitcher::processSection(PID pid, SectionContext& sect)
+{
+    uint8_t* const data = sect.data.data();
+    const size_t size = sect.data.size();
+
+    // Only valid long sections have a version.
+    if (size < MIN_LONG_SECTION_SIZE || (data[1] & 0x80) == 0 || CRC32(data, size - 4) != GetUInt32(data + size - 4)) {
+        return;
+    }
+
+    const uint8_t tid = data[0];
+    const uint16_t tid_ext = GetUInt16(data + 3);
+    const uint8_t version = (data[5] >> 1) & 0x1F;
+    const uint8_t section_number = data[6];
+
+    // Collect PMT PID's from the PAT.
+    if (pid == PID_PAT && tid == TID_PAT) {
+        for (size_t i = LONG_SECTION_HEADER_SIZE; i + 4 <= size - SECTION_CRC32_SIZE; i += 4) {
+            if (GetUInt16(data + i) != 0) {
+                _psi_pids.set(GetUInt16(data + i + 2) & 0x1FFF);
+            }
+        }
+    }
+
+    // Keys of the table and section.
+    const uint64_t table_key = (uint64_t(pid) << 24) | (uint64_t(tid) << 16) | tid_ext;
+    const uint64_t section_key = (table_key << 8) | section_number;
+    const uint64_t version_key = (table_key << 5) | version;
+
+    // Use the version remapping of this table in this chunk when already decided.
+    const auto map_it = _version_map.find(version_key);
+    if (map_it != _version_map.end()) {
+        outputSection(section_key, sect, map_it->second);
+        return;
+    }
+
+    // In the first chunk or for a new table, there is nothing to reconcile.
+    if (_chunks <= 1 || _last_versions.find(table_key) == _last_versions.end()) {
+        _version_map[version_key] = version;
+        outputSection(section_key, sect, version);
+        return;
+    }
+
+    // A previous version of the table, still incomplete, is decided first.
+    for (auto it = _pending.lower_bound(table_key << 5); it != _pending.end() && (it->first >> 5) == table_key; ) {
+        if (it->first == version_key) {
+            ++it;
+        }
+        else {
+            const uint64_t key = it->first;
+            flushPending(key);
+            it = _pending.upper_bound(key);
+        }
+    }
+
+    // Wait for all sections of the table to decide if the table changed.
+    PendingTable& table(_pending[version_key]);
+    table.table_key = table_key;
+    table.last_section = data[7];
+    table.received.insert(section_number);
+    table.sections.resize(table.sections.size() + 1);
+    table.sections.back().key = section_key;
+    table.sections.back().context = sect;
+    if (table.received.size() > size_t(table.last_section)) {
+        flushPending(version_key);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Decide the version remapping of a pending table and output its sections.
+//----------------------------------------------------------------------------
+
+void ts::TSStitcher::flushPending(uint64_t version_key)
+{
+    const auto it = _pending.find(version_key);
+    if (it == _pending.end()) {
+        return;
+    }
+    PendingTable& table(it->second);
+    const uint8_t last_version = _last_versions[table.table_key];
+
+    // The table is unchanged if all its sections are identical to the last output
+    // sections with the same numbers, ignoring the version and CRC. A section which
+    // was never output before, typically when a chunk contains only some sections
+    // of a table, gives no indication of a change.
+    bool same = true;
+    for (auto sec = table.sections.begin(); same && sec != table.sections.end(); ++sec) {
+        const auto last_it = _last_sections.find(sec->key);
+        if (last_it != _last_sections.end()) {
+            const ByteBlock& data(sec->context.data);
+            const ByteBlock& last(last_it->second.content);
+            const size_t size = data.size();
+            same = last.size() == size &&
+                ::memcmp(last.data(), data.data(), 5) == 0 &&
+                (last[5] & 0xC1) == (data[5] & 0xC1) &&
+                ::memcmp(last.data() + 6, data.data() + 6, size - 10) == 0;
+        }
+    }
+
+    const uint8_t out_version = same ? last_version : ((last_version + 1) & 0x1F);
+    _version_map[version_key] = out_version;
+    for (auto sec = table.sections.begin(); sec != table.sections.end(); ++sec) {
+        outputSection(sec->key, sec->context, out_version);
+    }
+    _pending.erase(it);
+}
+
+
+//----------------------------------------------------------------------------
+// Decide the version remapping of all pending tables.
+//----------------------------------------------------------------------------
+
+void ts::TSStitcher::flushAllPending()
+{
+    while (!_pending.empty()) {
+        flushPending(_pending.begin()->first);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Output a section with a given version.
+//----------------------------------------------------------------------------
+
+void ts::TSStitcher::outputSection(uint64_t section_key, SectionContext& sect, uint8_t out_version)
+{
+    uint8_t* const data = sect.data.data();
+    const size_t size = sect.data.size();
+
+    // Patch the section in the output file.
+    if (out_version != ((data[5] >> 1) & 0x1F)) {
+        data[5] = uint8_t((data[5] & 0xC1) | (out_version << 1));
+        PutUInt32(data + size - 4, CRC32(data, size - 4));
+        patch(sect.position(5), data + 5, 1);
+        for (size_t i = size - 4; i < size; ++i) {
+            patch(sect.position(i), data + i, 1);
+        }
+        _version_fixes++;
+    }
+
+    // Remember the last output section.
+    SectionRecord& rec(_last_sections[section_key]);
+    rec.version = out_version;
+    rec.content = sect.data;
+    _last_versions[section_key >> 8] = out_version;
+}
+
+
+//----------------------------------------------------------------------------
+// Write bytes at a given position in the output file.
+//----------------------------------------------------------------------------
+
+void ts::TSStitcher::patch(uint64_t position, const uint8_t* data, size_t size)
+{
+    _file.seekp(std::streamoff(position));
+    _file.write(reinterpret_cast<const char*>(data), std::streamsize(size));
+}
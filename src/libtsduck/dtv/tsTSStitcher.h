@@ -0,0 +1,208 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Concatenate transport stream files with seam reconciliation.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSPacket.h"
+#include "tsByteBlock.h"
+#include "tsReport.h"
+
+namespace ts {
+    //!
+    //! Concatenate transport stream files with seam reconciliation.
+    //! @ingroup mpeg
+    //!
+    //! This class builds one transport stream file from consecutive chunks of a
+    //! stream which were processed independently, typically by several @c tsp
+    //! processes working in parallel on distinct parts of a large file.
+    //!
+    //! At each seam between two chunks, the following inconsistencies are fixed:
+    //! - Continuity counters: on each PID, the continuity counters of the new chunk
+    //!   are shifted to continue the ones of the previous chunk.
+    //! - Table versions: on PSI/SI PID's (0x0000 to 0x001F and PMT PID's), the version
+    //!   numbers of long sections in the new chunk are remapped. A table with the same
+    //!   content as in the previous chunk gets the same version. A table with a different
+    //!   content, in any of its sections, gets the next version. The CRC32 of remapped
+    //!   sections is recomputed.
+    //!
+    //! The output file is directly patched when a table version is remapped.
+    //!
+    class TSDUCKDLL TSStitcher
+    {
+        TS_NOBUILD_NOCOPY(TSStitcher);
+    public:
+        //!
+        //! Constructor.
+        //! @param [in,out] report Where to report errors.
+        //!
+        TSStitcher(Report& report);
+
+        //!
+        //! Destructor.
+        //!
+        ~TSStitcher();
+
+        //!
+        //! Create the output file.
+        //! @param [in] filename Name of the output file.
+        //! @return True on success, false on error.
+        //!
+        bool open(const UString& filename);
+
+        //!
+        //! Append the content of a file as the next chunk.
+        //! @param [in] filename Name of the file containing the next chunk.
+        //! @return True on success, false on error.
+        //!
+        bool addFile(const UString& filename);
+
+        //!
+        //! Append packets to the current chunk.
+        //! @param [in] packets Address of the packets. The packets are modified when necessary.
+        //! @param [in] count Number of packets.
+        //! @return True on success, false on error.
+        //!
+        bool addPackets(TSPacket* packets, size_t count);
+
+        //!
+        //! Start a new chunk. The next packets are in a new chunk.
+        //!
+        void startChunk();
+
+        //!
+        //! Close the output file.
+        //! @return True on success, false on error.
+        //!
+        bool close();
+
+        //!
+        //! Get the number of written packets.
+        //! @return The number of written packets.
+        //!
+        PacketCounter packetCount() const { return _packets; }
+
+        //!
+        //! Get the number of packets with a modified continuity counter.
+        //! @return The number of packets with a modified continuity counter.
+        //!
+        PacketCounter ccFixCount() const { return _cc_fixes; }
+
+        //!
+        //! Get the number of sections with a modified version.
+        //! @return The number of sections with a modified version.
+        //!
+        PacketCounter versionFixCount() const { return _version_fixes; }
+
+    private:
+        // A section being reassembled, with the output file positions of its parts.
+        class SectionContext
+        {
+        public:
+            SectionContext() : data(), parts() {}
+            ByteBlock data;                                  // Section content so far.
+            std::vector<std::pair<size_t,uint64_t>> parts;  // Section offset and file position of each part.
+            void clear() { data.clear(); parts.clear(); }
+            uint64_t position(size_t offset) const;          // File position of a section offset.
+        };
+
+        // A section of a table version in the current chunk, waiting for the remapping decision.
+        class PendingSection
+        {
+        public:
+            PendingSection() : key(0), context() {}
+            uint64_t       key;       // Table and section number.
+            SectionContext context;   // Section content and file positions.
+        };
+
+        // All sections of a table version which were received so far in the current chunk.
+        // The version remapping is decided when all sections of the table were received
+        // (or at the end of the chunk) and applied to all pending sections.
+        class PendingTable
+        {
+        public:
+            PendingTable() : table_key(0), last_section(0), received(), sections() {}
+            uint64_t                    table_key;     // PID, table id and table id extension.
+            uint8_t                     last_section;  // Last section number in the table.
+            std::set<uint8_t>           received;      // Received section numbers.
+            std::vector<PendingSection> sections;      // Received sections, including repetitions.
+        };
+
+        // Last output section for a given table and section number.
+        class SectionRecord
+        {
+        public:
+            SectionRecord() : version(0), content() {}
+            uint8_t   version;
+            ByteBlock content;
+        };
+
+        Report&       _report;
+        UString       _filename;
+        std::fstream  _file;
+        bool          _is_open;
+        size_t        _chunks;          // Number of started chunks.
+        PacketCounter _packets;
+        PacketCounter _cc_fixes;
+        PacketCounter _version_fixes;
+        PIDSet        _cc_pending;      // PID's with a CC shift to compute in current chunk.
+        uint8_t       _last_cc[PID_MAX];
+        uint8_t       _cc_shift[PID_MAX];
+        PIDSet        _psi_pids;        // PID's carrying PSI/SI.
+        std::map<PID, SectionContext>      _sections;      // Sections being reassembled.
+        std::map<uint64_t, SectionRecord>  _last_sections; // Last output section, by table and section number.
+        std::map<uint64_t, uint8_t>        _last_versions; // Last output version, by table.
+        std::map<uint64_t, uint8_t>        _version_map;   // Version remapping in current chunk, by table and input version.
+        std::map<uint64_t, PendingTable>   _pending;       // Tables waiting for a remapping decision, by table and input version.
+
+        // Process PSI/SI content of a packet which is written at the given file position.
+        void feedSections(const TSPacket& pkt, uint64_t position);
+
+        // Append data to a section, return the number of used bytes.
+        size_t appendSection(PID pid, SectionContext& sect, const uint8_t* data, size_t size, uint64_t position);
+
+        // Process a complete section.
+        void processSection(PID pid, SectionContext& sect);
+
+        // Decide the version remapping of a pending table and output its sections.
+        void flushPending(uint64_t version_key);
+
+        // Decide the version remapping of all pending tables, at the end of a chunk.
+        void flushAllPending();
+
+        // Output a section with a given version, patch the output file when necessary.
+        void outputSection(uint64_t section_key, SectionContext& sect, uint8_t out_version);
+
+        // Write bytes at a given position in the output file.
+        void patch(uint64_t position, const uint8_t* data, size_t size);
+    };
+}
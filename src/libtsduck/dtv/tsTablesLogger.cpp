@@ -92,6 +92,9 @@ ts::TablesLogger::TablesLogger(TablesDisplay& display) :
     _exit(false),
     _table_count(0),
     _packet_count(0),
+    _sample_rate(0),
+    _sample_index(),
+    _sampled_count(0),
     _demux(_duck),
     _cas_mapper(_duck),
     _xmlOut(_report),
@@ -362,6 +365,8 @@ bool ts::TablesLogger::open()
     _abort = _exit = false;
     _table_count = 0;
     _packet_count = 0;
+    _sample_index.clear();
+    _sampled_count = 0;
     _demux.reset();
     _cas_mapper.reset();
     _xmlOut.close();
@@ -465,6 +470,30 @@ void ts::TablesLogger::close()
 }
 
 
+//----------------------------------------------------------------------------
+// Check if a table or section on a PID must be skipped because of sampling.
+// The sampling period is counted per PID so that a PID with frequent
+// tables does not hide the tables from the other PID's.
+//----------------------------------------------------------------------------
+
+bool ts::TablesLogger::skipSample(PID pid)
+{
+    if (_sample_rate <= 1) {
+        // Not in sampling mode, restart new periods next time.
+        _sample_index.clear();
+        return false;
+    }
+    else if (_sample_index[pid]++ % _sample_rate == 0) {
+        // First table of a sampling period, keep it.
+        return false;
+    }
+    else {
+        _sampled_count++;
+        return true;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // The following method feeds the logger with a TS packet.
 //----------------------------------------------------------------------------
@@ -515,6 +544,11 @@ void ts::TablesLogger::handleTable(SectionDemux&, const BinaryTable& table)
         }
     }
 
+    // In sampling mode, ignore most tables.
+    if (skipSample(pid)) {
+        return;
+    }
+
     // Filtering done, now save data.
     if (_use_text) {
         preDisplay(table.getFirstTSPacketIndex(), table.getLastTSPacketIndex());
@@ -628,6 +662,11 @@ void ts::TablesLogger::handleSection(SectionDemux& demux, const Section& sect)
         }
     }
 
+    // In sampling mode, ignore most sections.
+    if (skipSample(pid)) {
+        return;
+    }
+
     // Filtering done, now save data.
     // Note that no XML can be produced since valid XML structures contain complete tables only.
 
@@ -118,6 +118,21 @@ namespace ts {
             return _abort || _exit;
         }
 
+        //!
+        //! Set the sampling rate of the logger.
+        //! In sampling mode, typically when the processing chain is overloaded,
+        //! only one table (or section with --all-sections) out of @a rate is
+        //! logged. The other ones are counted but ignored.
+        //! @param [in] rate Sampling rate. Zero or one means no sampling.
+        //!
+        void setSampling(size_t rate) { _sample_rate = rate; }
+
+        //!
+        //! Get the number of tables or sections which were ignored in sampling mode.
+        //! @return The number of skipped tables or sections.
+        //!
+        uint32_t sampledCount() const { return _sampled_count; }
+
         //!
         //! Report the demux errors (if any).
         //! @param [in,out] strm Output text stream.
@@ -183,6 +198,9 @@ namespace ts {
         bool                     _exit;
         uint32_t                 _table_count;
         PacketCounter            _packet_count;
+        size_t                   _sample_rate;       // Log one table out of this in sampling mode.
+        std::map<PID,size_t>     _sample_index;      // Index of table in current sampling period, by PID.
+        uint32_t                 _sampled_count;     // Number of tables skipped in sampling mode.
         SectionDemux             _demux;
         CASMapper                _cas_mapper;
         TextFormatter            _xmlOut;            // XML output formatter.
@@ -217,6 +235,9 @@ namespace ts {
         // Check if a specific section must be filtered and displayed.
         bool isFiltered(const Section& section, uint16_t cas);
 
+        // Check if a table or section on a PID must be skipped because of sampling.
+        bool skipSample(PID pid);
+
         // Log a section (option --log).
         void logSection(const Section& section);
     };
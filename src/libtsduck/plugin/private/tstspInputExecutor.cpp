@@ -50,6 +50,8 @@ ts::tsp::InputExecutor::InputExecutor(const TSProcessorArgs& options,
     PluginExecutor(options, INPUT_PLUGIN, pl_options, attributes, global_mutex, report),
     _input(dynamic_cast<InputPlugin*>(PluginThread::plugin())),
     _in_sync_lost(false),
+    _tei_packets(0),
+    _null_packets(0),
     _instuff_start_remain(options.instuff_start),
     _instuff_stop_remain(options.instuff_stop),
     _instuff_nullpkt_remain(0),
@@ -57,6 +59,7 @@ ts::tsp::InputExecutor::InputExecutor(const TSProcessorArgs& options,
     _pcr_analyzer(MIN_ANALYZE_PID, MIN_ANALYZE_PCR),
     _dts_analyzer(),
     _use_dts_analyzer(false),
+    _stream_clock(options.stream_time_pid),
     _watchdog(this, options.receive_timeout, 0, *this),
     _use_watchdog(false)
 {
@@ -86,6 +89,7 @@ bool ts::tsp::InputExecutor::initAllBuffers(PacketBuffer* buffer, PacketMetadata
     if (pkt_read == 0) {
         return false; // receive error
     }
+    timeStampPackets(0, pkt_read);
 
     debug(u"initial buffer load: %'d packets, %'d bytes", {pkt_read, pkt_read * PKT_SIZE});
 
@@ -204,9 +208,7 @@ size_t ts::tsp::InputExecutor::receiveAndValidate(size_t index, size_t max_packe
     TSPacketMetadata* const data = _metadata->base() + index;
 
     // Reset metadata for new incoming packets.
-    for (size_t n = 0; n < max_packets; ++n) {
-        data[n].reset();
-    }
+    TSPacketMetadata::Reset(data, max_packets);
 
     // Invoke the plugin receive method
     if (_use_watchdog) {
@@ -217,34 +219,46 @@ size_t ts::tsp::InputExecutor::receiveAndValidate(size_t index, size_t max_packe
         _watchdog.suspend();
     }
 
-    // Validate sync byte (0x47) at beginning of each packet
-    for (size_t n = 0; n < count; ++n) {
-        if (pkt[n].hasValidSync()) {
-            // Count good packets from plugin
-            addPluginPackets(1);
-
-            // Include packet in bitrate analysis.
-            _pcr_analyzer.feedPacket(pkt[n]);
-            _dts_analyzer.feedPacket(pkt[n]);
+    // Validate sync byte (0x47) at beginning of each packet and count null and erroneous packets.
+    // When the bitrate is not fixed on the command line, the packets are included in the bitrate
+    // analysis in the same pass. Otherwise, the bitrate analysis is useless and the scan is faster.
+    size_t valid = 0;
+    size_t tei_count = 0;
+    size_t null_count = 0;
+    if (_options.fixed_bitrate != 0) {
+        valid = TSPacket::CheckSync(pkt, count, tei_count, null_count);
+    }
+    else {
+        for (; valid < count && pkt[valid].hasValidSync(); ++valid) {
+            tei_count += pkt[valid].b[1] >> 7;
+            null_count += size_t(pkt[valid].getPID() == PID_NULL);
+            _pcr_analyzer.feedPacket(pkt[valid]);
+            _dts_analyzer.feedPacket(pkt[valid]);
         }
-        else {
-            // Report error
-            error(u"synchronization lost after %'d packets, got 0x%X instead of 0x%X", {pluginPackets(), pkt[n].b[0], SYNC_BYTE});
-            // In debug mode, partial dump of input
-            // (one packet before lost of sync and 3 packets starting at lost of sync).
-            if (maxSeverity() >= 1) {
-                if (n > 0) {
-                    debug(u"content of packet before lost of synchronization:\n%s",
-                          {UString::Dump(pkt[n-1].b, PKT_SIZE, UString::HEXA | UString::OFFSET | UString::BPL, 4, 16)});
-                }
-                const size_t dump_count = std::min<size_t>(3, count - n);
-                debug(u"data at lost of synchronization:\n%s",
-                      {UString::Dump(pkt[n].b, dump_count * PKT_SIZE, UString::HEXA | UString::OFFSET | UString::BPL, 4, 16)});
+    }
+
+    // Count good packets from plugin
+    addPluginPackets(valid);
+    _tei_packets += tei_count;
+    _null_packets += null_count;
+
+    if (valid < count) {
+        // Report error
+        error(u"synchronization lost after %'d packets, got 0x%X instead of 0x%X", {pluginPackets(), pkt[valid].b[0], SYNC_BYTE});
+        // In debug mode, partial dump of input
+        // (one packet before lost of sync and 3 packets starting at lost of sync).
+        if (maxSeverity() >= 1) {
+            if (valid > 0) {
+                debug(u"content of packet before lost of synchronization:\n%s",
+                      {UString::Dump(pkt[valid-1].b, PKT_SIZE, UString::HEXA | UString::OFFSET | UString::BPL, 4, 16)});
             }
-            // Ignore subsequent packets
-            count = n;
-            _in_sync_lost = true;
+            const size_t dump_count = std::min<size_t>(3, count - valid);
+            debug(u"data at lost of synchronization:\n%s",
+                  {UString::Dump(pkt[valid].b, dump_count * PKT_SIZE, UString::HEXA | UString::OFFSET | UString::BPL, 4, 16)});
         }
+        // Ignore subsequent packets
+        count = valid;
+        _in_sync_lost = true;
     }
 
     return count;
@@ -328,6 +342,36 @@ size_t ts::tsp::InputExecutor::receiveAndStuff(size_t index, size_t max_packets)
 }
 
 
+//----------------------------------------------------------------------------
+// Time stamp received packets with the stream time and the system time.
+//----------------------------------------------------------------------------
+
+void ts::tsp::InputExecutor::timeStampPackets(size_t index, size_t count)
+{
+    TSPacketMetadata* const data = _metadata->base() + index;
+
+    // In low-latency mode, read the system clock once per input operation.
+    if (_options.latency_target > 0) {
+        const NanoSecond now = SystemClock();
+        for (size_t n = 0; n < count; ++n) {
+            data[n].setInputClock(now);
+        }
+    }
+
+    if (_options.stream_time) {
+        TSPacket* const pkt = _buffer->base() + index;
+
+        // Use the known bitrate to extrapolate the stream time as long as there is no PCR.
+        _stream_clock.setBitrateHint(_options.fixed_bitrate > 0 ? _options.fixed_bitrate : _tsp_bitrate);
+
+        for (size_t n = 0; n < count; ++n) {
+            _stream_clock.feedPacket(pkt[n]);
+            data[n].setInputTimeStamp(_stream_clock.currentTime());
+        }
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Input plugin thread
 //----------------------------------------------------------------------------
@@ -338,6 +382,7 @@ void ts::tsp::InputExecutor::main()
 
     Time current_time(Time::CurrentUTC());
     Time bitrate_due_time(current_time + _options.bitrate_adj);
+    MilliSecond bitrate_due_stream_time = _stream_clock.currentMilliSeconds() + _options.bitrate_adj;
     PacketCounter bitrate_due_packet = _options.init_bitrate_adj;
     bool plugin_completed = false;
     bool input_end = false;
@@ -372,9 +417,10 @@ void ts::tsp::InputExecutor::main()
             break;
         }
 
-        // Do not read more packets than request by --max-input-packets
-        if (_options.max_input_pkt > 0 && pkt_max > _options.max_input_pkt) {
-            pkt_max = _options.max_input_pkt;
+        // Do not read more packets than request by --max-input-packets or by the latency target.
+        const size_t max_input = latencyWindow(_options.max_input_pkt);
+        if (max_input > 0 && pkt_max > max_input) {
+            pkt_max = max_input;
         }
 
         // Now read at most the specified number of packets (pkt_max).
@@ -393,13 +439,20 @@ void ts::tsp::InputExecutor::main()
             _instuff_stop_remain -= count;
         }
 
+        // Time stamp all received packets, including trailing stuffing.
+        timeStampPackets(pkt_first, pkt_read);
+
         // Overall input is completed when input plugin and trailing stuffing are completed.
         input_end = plugin_completed && _instuff_stop_remain == 0;
 
         // Process periodic bitrate adjustment.
         // In initial phase, as long as the bitrate is unknown, retry every init_bitrate_adj packets.
-        // Once the bitrate is known, retry every bitrate_adj milliseconds.
-        if (_options.fixed_bitrate == 0 && ((_tsp_bitrate == 0 && pluginPackets() >= bitrate_due_packet) || (current_time = Time::CurrentUTC()) > bitrate_due_time)) {
+        // Once the bitrate is known, retry every bitrate_adj milliseconds, in system time or
+        // in stream time with --stream-time.
+        const bool bitrate_due = _options.stream_time ?
+            _stream_clock.currentMilliSeconds() > bitrate_due_stream_time :
+            (current_time = Time::CurrentUTC()) > bitrate_due_time;
+        if (_options.fixed_bitrate == 0 && ((_tsp_bitrate == 0 && pluginPackets() >= bitrate_due_packet) || bitrate_due)) {
 
             // When bitrate is unknown, retry in a fixed amount of packets.
             if (_tsp_bitrate == 0) {
@@ -411,7 +464,12 @@ void ts::tsp::InputExecutor::main()
             // Compute time for next bitrate adjustment. Note that we do not
             // use a monotonic time (we use current time and not due time as
             // base for next calculation).
-            if (current_time >= bitrate_due_time) {
+            if (_options.stream_time) {
+                if (_stream_clock.currentMilliSeconds() >= bitrate_due_stream_time) {
+                    bitrate_due_stream_time = _stream_clock.currentMilliSeconds() + _options.bitrate_adj;
+                }
+            }
+            else if (current_time >= bitrate_due_time) {
                 bitrate_due_time = current_time + _options.bitrate_adj;
             }
 
@@ -434,4 +492,5 @@ void ts::tsp::InputExecutor::main()
     _input->stop();
 
     debug(u"input thread %s after %'d packets", {aborted ? u"aborted" : u"terminated", totalPacketsInThread()});
+    verbose(u"input plugin packets: %'d, null packets: %'d, with transport error indicator: %'d", {pluginPackets(), _null_packets, _tei_packets});
 }
@@ -35,6 +35,7 @@
 #pragma once
 #include "tstspPluginExecutor.h"
 #include "tsPCRAnalyzer.h"
+#include "tsStreamClock.h"
 #include "tsWatchDog.h"
 
 namespace ts {
@@ -87,6 +88,8 @@ namespace ts {
         private:
             InputPlugin* _input;                  // Plugin API
             bool         _in_sync_lost;           // Input synchronization lost (no 0x47 at start of packet)
+            PacketCounter _tei_packets;           // Input packets with transport_error_indicator set.
+            PacketCounter _null_packets;          // Null packets from the input plugin.
             size_t       _instuff_start_remain;
             size_t       _instuff_stop_remain;
             size_t       _instuff_nullpkt_remain;
@@ -94,6 +97,7 @@ namespace ts {
             PCRAnalyzer  _pcr_analyzer;           // Compute input bitrate from PCR's.
             PCRAnalyzer  _dts_analyzer;           // Compute input bitrate from video DTS's.
             bool         _use_dts_analyzer;       // Use DTS analyzer, not PCR analyzer.
+            StreamClock  _stream_clock;           // Stream time of input packets (--stream-time).
             WatchDog     _watchdog;               // Watchdog when plugin does not support receive timeout.
             bool         _use_watchdog;           // The watchdog shall be used.
 
@@ -112,6 +116,9 @@ namespace ts {
             // Encapsulation of receiveAndValidate() method, adding tsp input stuffing options.
             size_t receiveAndStuff(size_t index, size_t max_packets);
 
+            // Time stamp received packets with the stream time (--stream-time) and the system time (--latency-target).
+            void timeStampPackets(size_t index, size_t count);
+
             // Encapsulation of the plugin's getBitrate() method, taking into account the tsp input
             // stuffing options. Use PCR analysis if bitrate not otherwise available.
             BitRate getBitrate();
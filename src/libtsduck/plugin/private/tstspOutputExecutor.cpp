@@ -58,6 +58,13 @@ void ts::tsp::OutputExecutor::main()
     PacketCounter output_packets = 0;
     bool aborted = false;
 
+    // In low-latency mode, measure the latency between input and output.
+    const bool low_latency = _options.latency_target > 0;
+    const NanoSecond latency_target = _options.latency_target * NanoSecPerMilliSec;
+    NanoSecond latency_total = 0;
+    NanoSecond latency_max = 0;
+    PacketCounter latency_count = 0;
+
     do {
         // Wait for packets to output
         size_t pkt_first = 0;
@@ -103,6 +110,13 @@ void ts::tsp::OutputExecutor::main()
         TSPacketMetadata* data = _metadata->base() + pkt_first;
         size_t pkt_remain = pkt_cnt;
 
+        // In low-latency mode, send at most one window of packets at a time and
+        // return the output packets to the input executor when the latency target
+        // has elapsed, without waiting for the end of the complete batch.
+        const size_t max_send = low_latency ? latencyWindow(_options.max_flush_pkt) : 0;
+        size_t pkt_released = 0;
+        NanoSecond flush_start = low_latency ? SystemClock() : 0;
+
         while (pkt_remain > 0) {
 
             // Skip dropped packets
@@ -120,6 +134,10 @@ void ts::tsp::OutputExecutor::main()
                 out_cnt++;
             }
 
+            if (max_send > 0) {
+                out_cnt = std::min(out_cnt, max_send);
+            }
+
             // Output a contiguous range of non-dropped packets.
             if (out_cnt > 0) {
                 if (_suspended) {
@@ -140,16 +158,40 @@ void ts::tsp::OutputExecutor::main()
                 data += out_cnt;
                 pkt_remain -= out_cnt;
             }
+
+            // Time flush in low-latency mode.
+            if (low_latency && !aborted && pkt_remain > 0 && SystemClock() - flush_start >= latency_target) {
+                const size_t pkt_done = pkt_cnt - pkt_remain;
+                aborted = !passPackets(pkt_done - pkt_released, 0, false, false);
+                pkt_released = pkt_done;
+                flush_start = SystemClock();
+                if (aborted) {
+                    break;
+                }
+            }
+        }
+
+        // Measure the latency of the last output packet, from the time of its input operation.
+        if (low_latency && pkt_cnt > 0) {
+            const NanoSecond latency = SystemClock() - _metadata->base()[pkt_first + pkt_cnt - 1].getInputClock();
+            latency_total += latency;
+            latency_max = std::max(latency_max, latency);
+            latency_count++;
         }
 
         // Pass free buffers to input processor.
         // Do not transmit bitrate or input end to next (since next is input processor).
-        aborted = !passPackets(pkt_cnt, 0, false, aborted);
+        aborted = !passPackets(pkt_cnt - pkt_released, 0, false, aborted);
 
     } while (!aborted);
 
     // Close the output processor
     _output->stop();
 
+    if (latency_count > 0) {
+        verbose(u"input to output latency: average %'d us, maximum %'d us, %'d samples",
+                {latency_total / latency_count / NanoSecPerMicroSec, latency_max / NanoSecPerMicroSec, latency_count});
+    }
+
     debug(u"output thread %s after %'d packets (%'d output)", {aborted ? u"aborted" : u"terminated", totalPacketsInThread(), output_packets});
 }
@@ -31,6 +31,7 @@
 #include "tsPluginRepository.h"
 #include "tsGuardCondition.h"
 #include "tsGuard.h"
+#include "tsMonotonic.h"
 TSDUCK_SOURCE;
 
 
@@ -58,6 +59,7 @@ ts::tsp::PluginExecutor::PluginExecutor(const TSProcessorArgs& options,
     _restart(false),
     _restart_data()
 {
+    _use_stream_time = options.stream_time;
 }
 
 ts::tsp::PluginExecutor::~PluginExecutor()
@@ -89,6 +91,32 @@ void ts::tsp::PluginExecutor::initBuffer(PacketBuffer* buffer,
 }
 
 
+//----------------------------------------------------------------------------
+// Compute the maximum size of a window of packets in low-latency mode.
+//----------------------------------------------------------------------------
+
+size_t ts::tsp::PluginExecutor::latencyWindow(size_t max_packets) const
+{
+    if (_options.latency_target <= 0 || _tsp_bitrate == 0) {
+        return max_packets;
+    }
+    // Number of packets during the latency target at current bitrate, at least one.
+    const size_t count = std::max<size_t>(1, size_t((uint64_t(_tsp_bitrate) * uint64_t(_options.latency_target)) / (MilliSecPerSec * PKT_SIZE * 8)));
+    return max_packets == 0 ? count : std::min(count, max_packets);
+}
+
+
+//----------------------------------------------------------------------------
+// Current monotonic system time, for the latency control in low-latency mode.
+//----------------------------------------------------------------------------
+
+ts::NanoSecond ts::tsp::PluginExecutor::SystemClock()
+{
+    static const Monotonic origin(true);
+    return Monotonic(true) - origin;
+}
+
+
 //----------------------------------------------------------------------------
 // Signal that the specified number of packets have been processed.
 //----------------------------------------------------------------------------
@@ -187,6 +215,20 @@ void ts::tsp::PluginExecutor::waitWork(size_t& pkt_first, size_t& pkt_cnt, BitRa
     bitrate = _bitrate;
     input_end = _input_end && pkt_cnt == _pkt_cnt;
 
+    // Overload detection: enter sampling mode when the backlog exceeds the threshold,
+    // exit when it drops below half the threshold.
+    if (_options.sampling_threshold > 0) {
+        const size_t backlog = (_pkt_cnt * 100) / _buffer->count();
+        if (!_tsp_sampling && backlog >= _options.sampling_threshold) {
+            _tsp_sampling = true;
+            verbose(u"backlog is %d%% of buffer, entering sampling mode", {backlog});
+        }
+        else if (_tsp_sampling && backlog < _options.sampling_threshold / 2) {
+            _tsp_sampling = false;
+            verbose(u"backlog is %d%% of buffer, exiting sampling mode", {backlog});
+        }
+    }
+
     // Force to abort our processor when the next one is aborting.
     // Don't do that if current is output and next is input because
     // there is no propagation of packets from output back to input.
@@ -197,6 +197,22 @@ namespace ts {
             //!
             bool processPendingRestart();
 
+            //!
+            //! Compute the maximum size of a window of packets in low-latency mode.
+            //! @param [in] max_packets Maximum number of packets from the command line, zero if unlimited.
+            //! @return In low-latency mode and when the bitrate is known, the number of packets
+            //! which are transmitted during the latency target, never more than @a max_packets.
+            //! Otherwise, return @a max_packets.
+            //!
+            size_t latencyWindow(size_t max_packets) const;
+
+            //!
+            //! Get the current monotonic system time, for the latency control in low-latency mode.
+            //! @return Current monotonic system time in nanoseconds, from an origin which is
+            //! common to all executors.
+            //!
+            static NanoSecond SystemClock();
+
         private:
             // A structure which is used to handle a restart of the plugin.
             class RestartData;
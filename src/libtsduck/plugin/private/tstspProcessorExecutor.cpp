@@ -59,7 +59,10 @@ void ts::tsp::ProcessorExecutor::main()
     PacketCounter passed_packets = 0;
     PacketCounter dropped_packets = 0;
     PacketCounter nullified_packets = 0;
+    PacketCounter sampled_packets = 0;
     BitRate output_bitrate = _tsp_bitrate;
+    const bool low_latency = _options.latency_target > 0;
+    const NanoSecond latency_target = _options.latency_target * NanoSecPerMilliSec;
     bool bitrate_never_modified = true;
     bool input_end = false;
     bool aborted = false;
@@ -105,6 +108,14 @@ void ts::tsp::ProcessorExecutor::main()
         }
 
         // Now process the packets.
+        // In low-latency mode, the flush size depends on the current bitrate.
+        const size_t max_flush = latencyWindow(_options.max_flush_pkt);
+
+        // In low-latency mode, read the system clock once per chunk of packets. The packets which
+        // were received more than the latency target ago are late. They are passed to the next
+        // executor as soon as they are processed, without waiting for the rest of the chunk. The
+        // packets are in input order, the late ones are at the beginning of the chunk.
+        const NanoSecond late_limit = low_latency ? SystemClock() - latency_target : 0;
         size_t pkt_done = 0;
         size_t pkt_flush = 0;
 
@@ -130,6 +141,10 @@ void ts::tsp::ProcessorExecutor::main()
                     // Either no --only-label option or the packet has a specified label => process it.
                     status = _processor->processPacket(*pkt, *pkt_data);
                     addPluginPackets(1);
+                    if (_tsp_sampling && _tsp_sampling_used) {
+                        // Only count plugins which actually sample the stream.
+                        sampled_packets++;
+                    }
                 }
                 else {
                     // The plugin is suspended or some --only-label was specified but the packet does
@@ -184,9 +199,19 @@ void ts::tsp::ProcessorExecutor::main()
 
             // Do not wait to process pkt_cnt packets before notifying
             // the next processor. Perform periodic flush to avoid waiting
-            // too long before two output operations.
-
-            if (pkt_data->getFlush() || pkt_done == pkt_cnt || (_options.max_flush_pkt > 0 && pkt_flush % _options.max_flush_pkt == 0)) {
+            // too long before two output operations. In low-latency mode,
+            // also flush after the last late packet.
+
+            if (pkt_data->getFlush() ||
+                pkt_done == pkt_cnt ||
+                (max_flush > 0 && pkt_flush % max_flush == 0) ||
+                (low_latency && pkt_data->getInputClock() <= late_limit && pkt_data[1].getInputClock() > late_limit))
+            {
+                // Let the plugin complete its deferred processing before passing the packets.
+                if (!_processor->flushPackets()) {
+                    input_end = aborted = true;
+                    pkt_cnt = pkt_done;
+                }
                 aborted = !passPackets(pkt_flush, output_bitrate, pkt_done == pkt_cnt && input_end, aborted);
                 pkt_flush = 0;
             }
@@ -197,6 +222,9 @@ void ts::tsp::ProcessorExecutor::main()
     // Close the packet processor
     _processor->stop();
 
-    debug(u"packet processing thread %s after %'d packets, %'d passed, %'d dropped, %'d nullified",
-          {input_end ? u"terminated" : u"aborted", pluginPackets(), passed_packets, dropped_packets, nullified_packets});
+    debug(u"packet processing thread %s after %'d packets, %'d passed, %'d dropped, %'d nullified, %'d sampled",
+          {input_end ? u"terminated" : u"aborted", pluginPackets(), passed_packets, dropped_packets, nullified_packets, sampled_packets});
+    if (sampled_packets > 0) {
+        info(u"%'d packets out of %'d processed in sampling mode (overload)", {sampled_packets, pluginPackets()});
+    }
 }
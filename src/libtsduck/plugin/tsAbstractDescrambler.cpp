@@ -29,6 +29,8 @@
 
 #include "tsAbstractDescrambler.h"
 #include "tsGuardCondition.h"
+#include "tsBinaryTable.h"
+#include "tsPAT.h"
 #include "tsNames.h"
 TSDUCK_SOURCE;
 
@@ -43,6 +45,7 @@ TSDUCK_SOURCE;
 ts::AbstractDescrambler::AbstractDescrambler(TSP* tsp_, const UString& description, const UString& syntax, size_t stack_usage) :
     ProcessorPlugin(tsp_, description, syntax),
     _use_service(false),
+    _all_services(false),
     _need_ecm(false),
     _abort(false),
     _synchronous(false),
@@ -51,12 +54,15 @@ ts::AbstractDescrambler::AbstractDescrambler(TSP* tsp_, const UString& descripti
     _pids(),
     _service(duck, this),
     _stack_usage(stack_usage),
+    _ecm_thread_count(1),
     _demux(duck, nullptr, this),
+    _pmt_demux(duck, this, nullptr),
     _ecm_streams(),
+    _scrambled_pids(),
     _scrambled_streams(),
     _mutex(),
     _ecm_to_do(),
-    _ecm_thread(this),
+    _ecm_threads(),
     _stop_thread(false)
 {
     // Generic scrambling options.
@@ -70,8 +76,21 @@ ts::AbstractDescrambler::AbstractDescrambler(TSP* tsp_, const UString& descripti
          u"interpreted as a service id. Otherwise, it is interpreted as a service name, "
          u"as specified in the SDT. The name is not case sensitive and blanks are "
          u"ignored. If the input TS does not contain an SDT, use service ids only.\n\n"
-         u"If the argument is omitted, --pid options shall be specified to list explicit "
-         u"PID's to descramble and fixed control words shall be specified as well.");
+         u"If the argument is omitted, either --all-services or --pid options shall be "
+         u"specified. With --pid options, fixed control words shall be specified as well.");
+
+    option(u"all-services", 0);
+    help(u"all-services",
+         u"Descramble all services in the transport stream. The PAT and all PMT's are "
+         u"analyzed to locate all scrambled elementary streams and their ECM streams. "
+         u"Each ECM stream is used independently, with its own control words and "
+         u"scrambling mode. Fixed control words cannot be used with this option.");
+
+    option(u"ecm-threads", 0, POSITIVE);
+    help(u"ecm-threads",
+         u"Number of threads which decipher ECM's in parallel. The default is one thread. "
+         u"Several threads are useful with --all-services when the CAS can process ECM's "
+         u"from distinct ECM streams in parallel. Ignored with --synchronous.");
 
     option(u"pid", 'p', PIDVAL, 0, UNLIMITED_COUNT);
     help(u"pid", u"pid1[-pid2]",
@@ -100,6 +119,8 @@ bool ts::AbstractDescrambler::getOptions()
 {
     // Load command line arguments.
     _use_service = present(u"");
+    _all_services = present(u"all-services");
+    _ecm_thread_count = intValue<size_t>(u"ecm-threads", 1);
     _service.set(value(u""));
     _synchronous = present(u"synchronous") || !tsp->realtime();
     _swap_cw = present(u"swap-cw");
@@ -108,14 +129,14 @@ bool ts::AbstractDescrambler::getOptions()
         return false;
     }
 
-    // Descramble either a service or a list of PID's, not a mixture of them.
-    if ((_use_service + _pids.any()) != 1) {
-        tsp->error(u"specify either a service or a list of PID's");
+    // Descramble either a service, all services or a list of PID's, not a mixture of them.
+    if ((_use_service + _all_services + _pids.any()) != 1) {
+        tsp->error(u"specify either a service, --all-services or a list of PID's");
         return false;
     }
 
-    // We need to decipher ECM's if we descramble a service without fixed control words.
-    _need_ecm = _use_service && !_scrambling.hasFixedCW();
+    // We need to decipher ECM's if we descramble services without fixed control words.
+    _need_ecm = (_use_service || _all_services) && !_scrambling.hasFixedCW();
 
     // To descramble a fixed list of PID's, we need fixed control words.
     if (_pids.any() && !_scrambling.hasFixedCW()) {
@@ -123,6 +144,12 @@ bool ts::AbstractDescrambler::getOptions()
         return false;
     }
 
+    // Fixed control words use one single scrambling type while each service may use its own.
+    if (_all_services && _scrambling.hasFixedCW()) {
+        tsp->error(u"fixed control words cannot be used with --all-services, use --pid instead");
+        return false;
+    }
+
     return true;
 }
 
@@ -150,6 +177,7 @@ ts::AbstractDescrambler::ECMStream::ECMStream(AbstractDescrambler* parent) :
     new_cw_even(false),
     new_cw_odd(false),
     new_ecm(false),
+    processing(false),
     ecm(),
     cw_even(),
     cw_odd()
@@ -168,7 +196,9 @@ ts::AbstractDescrambler::ECMStreamPtr ts::AbstractDescrambler::getOrCreateECMStr
         return ecm_it->second;
     }
     else {
+        // The ECM threads scan the map of ECM streams under protection of the mutex.
         ECMStreamPtr p(new ECMStream(this));
+        Guard lock(_mutex);
         _ecm_streams.insert(std::make_pair(ecm_pid, p));
         return p;
     }
@@ -184,22 +214,35 @@ bool ts::AbstractDescrambler::start()
     // Reset descrambler state
     _abort = false;
     _ecm_streams.clear();
+    _scrambled_pids.reset();
     _scrambled_streams.clear();
+    _scrambled_streams.resize(PID_MAX);
     _demux.reset();
+    _pmt_demux.reset();
+
+    // Collect all PMT's from the PAT when descrambling all services.
+    if (_all_services) {
+        _pmt_demux.addPID(PID_PAT);
+    }
 
     // Initialize the scrambling engine.
     if (!_scrambling.start()) {
         return false;
     }
 
-    // In asynchronous mode, create a thread for ECM processing
+    // In asynchronous mode, create the threads for ECM processing
+    _ecm_threads.clear();
     if (_need_ecm && !_synchronous) {
         _stop_thread = false;
-        ThreadAttributes attr;
-        _ecm_thread.getAttributes(attr);
-        attr.setStackSize(ECM_THREAD_STACK_OVERHEAD + _stack_usage);
-        _ecm_thread.setAttributes(attr);
-        _ecm_thread.start();
+        for (size_t i = 0; i < _ecm_thread_count; ++i) {
+            ECMThreadPtr thread(new ECMThread(this));
+            ThreadAttributes attr;
+            thread->getAttributes(attr);
+            attr.setStackSize(ECM_THREAD_STACK_OVERHEAD + _stack_usage);
+            thread->setAttributes(attr);
+            thread->start();
+            _ecm_threads.push_back(thread);
+        }
     }
 
     return true;
@@ -212,15 +255,19 @@ bool ts::AbstractDescrambler::start()
 
 bool ts::AbstractDescrambler::stop()
 {
-    // In asynchronous mode, notify the ECM processing thread to terminate
-    // and wait for its actual termination.
-    if (_need_ecm && !_synchronous) {
+    // In asynchronous mode, notify the ECM processing threads to terminate
+    // and wait for their actual termination. Each terminating thread notifies
+    // the next one.
+    if (!_ecm_threads.empty()) {
         {
             GuardCondition lock(_mutex, _ecm_to_do);
             _stop_thread = true;
             lock.signal();
         }
-        _ecm_thread.waitForTermination();
+        for (ECMThreadVector::const_iterator it = _ecm_threads.begin(); it != _ecm_threads.end(); ++it) {
+            (*it)->waitForTermination();
+        }
+        _ecm_threads.clear();
     }
 
     _scrambling.stop();
@@ -228,6 +275,37 @@ bool ts::AbstractDescrambler::stop()
 }
 
 
+//----------------------------------------------------------------------------
+// Invoked by the demux when a PAT or PMT is available (all services).
+//----------------------------------------------------------------------------
+
+void ts::AbstractDescrambler::handleTable(SectionDemux& demux, const BinaryTable& table)
+{
+    switch (table.tableId()) {
+        case TID_PAT: {
+            const PAT pat(duck, table);
+            if (pat.isValid()) {
+                // Collect the PMT's of all services.
+                for (PAT::ServiceMap::const_iterator it = pat.pmts.begin(); it != pat.pmts.end(); ++it) {
+                    _pmt_demux.addPID(it->second);
+                }
+            }
+            break;
+        }
+        case TID_PMT: {
+            const PMT pmt(duck, table);
+            if (pmt.isValid()) {
+                handlePMT(pmt);
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+
 //----------------------------------------------------------------------------
 //  This method is invoked when a PMT is available for the service.
 //----------------------------------------------------------------------------
@@ -243,6 +321,9 @@ void ts::AbstractDescrambler::handlePMT(const PMT& pmt)
     std::set<PID> service_ecm_pids;
     analyzeDescriptors(pmt.descs, service_ecm_pids, scrambling_type);
 
+    // All ECM PID's in this service.
+    std::set<PID> all_ecm_pids(service_ecm_pids);
+
     // Loop on all elementary streams in this service.
     // Create an entry in _scrambled_streams for each of them.
     for (PMT::StreamMap::const_iterator it = pmt.streams.begin(); it != pmt.streams.end(); ++it) {
@@ -252,27 +333,41 @@ void ts::AbstractDescrambler::handlePMT(const PMT& pmt)
         // Enforce an entry for this PID in _scrambled_streams, even no valid ECM PID is found
         // (maybe we don't need ECM at all). But the PID must be marked as potentially scrambled.
         ScrambledStream& scr_stream(_scrambled_streams[pid]);
+        _scrambled_pids.set(pid);
 
         // Search ECM PIDs at elementary stream level.
         std::set<PID> component_ecm_pids;
         analyzeDescriptors(pmt_stream.descs, component_ecm_pids, scrambling_type);
+        all_ecm_pids.insert(component_ecm_pids.begin(), component_ecm_pids.end());
 
         // If none found as stream level, use the ones from service level.
-        if (!component_ecm_pids.empty()) {
-            // Valid ECM PID's found at component level, use them.
-            scr_stream.ecm_pids = component_ecm_pids;
-        }
-        else if (!service_ecm_pids.empty()) {
-            // Valid ECM PID's found at service level, use them.
-            scr_stream.ecm_pids = service_ecm_pids;
+        const std::set<PID>& ecm_pids(component_ecm_pids.empty() ? service_ecm_pids : component_ecm_pids);
+        if (!ecm_pids.empty()) {
+            // Keep a direct reference to the ECM streams, avoid searching them for each packet.
+            scr_stream.ecm_streams.clear();
+            for (std::set<PID>::const_iterator itecm = ecm_pids.begin(); itecm != ecm_pids.end(); ++itecm) {
+                scr_stream.ecm_streams.push_back(getOrCreateECMStream(*itecm));
+            }
         }
     }
 
     // Set global scrambling type from scrambling descriptor, if not specified on the command line.
-    _scrambling.setScramblingType(scrambling_type, false);
-    tsp->verbose(u"using scrambling mode: %s", {NameFromSection(u"ScramblingMode", _scrambling.scramblingType())});
-    for (ECMStreamMap::iterator it = _ecm_streams.begin(); it != _ecm_streams.end(); ++it) {
-        it->second->scrambling.setScramblingType(scrambling_type, false);
+    // The global scrambling type is used with fixed control words, on one single service only.
+    // When descrambling all services, each service may use its own scrambling type and the type
+    // is set in the ECM streams of the service only.
+    if (!_all_services) {
+        _scrambling.setScramblingType(scrambling_type, false);
+        tsp->verbose(u"using scrambling mode: %s", {NameFromSection(u"ScramblingMode", _scrambling.scramblingType())});
+    }
+    else {
+        tsp->verbose(u"service 0x%X, using scrambling mode: %s", {pmt.service_id, NameFromSection(u"ScramblingMode", scrambling_type)});
+    }
+
+    // The scrambling type of an ECM stream is read by the ECM threads.
+    for (std::set<PID>::const_iterator it = all_ecm_pids.begin(); it != all_ecm_pids.end(); ++it) {
+        const ECMStreamPtr estream(getOrCreateECMStream(*it));
+        Guard lock(_mutex);
+        estream->scrambling.setScramblingType(scrambling_type, false);
     }
 }
 
@@ -455,8 +550,11 @@ void ts::AbstractDescrambler::ECMThread::main()
     // ECM processing loop.
     // The loop executes with the mutex held. The mutex is released
     // while deciphering an ECM and while waiting for the condition
-    // variable 'ecm_to_do'.
+    // variable 'ecm_to_do'. When there are several ECM threads, an ECM
+    // stream is processed by only one thread at a time, to make sure
+    // that the control words are set in the order of the ECM's.
     GuardCondition lock(_parent->_mutex, _parent->_ecm_to_do);
+    const bool multi_threads = _parent->_ecm_thread_count > 1;
 
     for (;;) {
 
@@ -473,23 +571,41 @@ void ts::AbstractDescrambler::ECMThread::main()
             got_ecm = false;
             terminate = _parent->_stop_thread;
 
-            // Decipher ECM's on all ECM PID's.
-            for (ECMStreamMap::iterator it = _parent->_ecm_streams.begin(); !terminate && it != _parent->_ecm_streams.end(); ++it) {
-                ECMStreamPtr& estream(it->second);
-                if (estream->new_ecm) {
+            // Decipher ECM's on all ECM PID's. New ECM streams may be added by the packet processing
+            // thread while the mutex is released. The ECM streams are never removed while the threads
+            // are running but, after deciphering an ECM, the iteration restarts after the PID of the
+            // ECM stream in the current state of the map. The safe pointers to the ECM streams are
+            // not copied here since they are not thread-safe and used in the packet processing thread.
+            for (ECMStreamMap::iterator it = _parent->_ecm_streams.begin(); !terminate && it != _parent->_ecm_streams.end(); ) {
+                const PID ecm_pid = it->first;
+                ECMStream* const estream = it->second.pointer();
+                if (!estream->new_ecm || estream->processing) {
+                    ++it;
+                }
+                else {
                     // Found an ECM, decipher it. Note that the mutex is
                     // released while deciphering the ECM.
                     got_ecm = true;
+                    estream->processing = true;
+                    // Other ECM's may be pending, wake up another thread to process them.
+                    if (multi_threads) {
+                        lock.signal();
+                    }
                     _parent->processECM(*estream);
+                    estream->processing = false;
 
                     // Look for termination request while deciphering
                     terminate = _parent->_stop_thread;
+
+                    // Continue after the same PID, in the current state of the map.
+                    it = _parent->_ecm_streams.upper_bound(ecm_pid);
                 }
             }
         } while (!terminate && got_ecm);
 
-        // Check if a terminate request is found
+        // Check if a terminate request is found, propagate it to other threads.
         if (terminate) {
+            lock.signal();
             break;
         }
 
@@ -517,15 +633,20 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
     // If there is a user-specified list of PID's, we don't manage a service
     // and there is nothing else to do.
     if (_pids.any()) {
-        return !_pids.test(pid) || _scrambling.decrypt(pkt) ? TSP_OK : TSP_END;
+        return !_pids.test(pid) || _scrambling.decryptLater(pkt) ? TSP_OK : TSP_END;
     }
 
-    // Filter sections to locate the service and grab ECM's.
-    _service.feedPacket(pkt);
+    // Filter sections to locate the services and grab ECM's.
+    if (_all_services) {
+        _pmt_demux.feedPacket(pkt);
+    }
+    else {
+        _service.feedPacket(pkt);
+    }
     _demux.feedPacket(pkt);
 
     // If the service is definitely unknown or a fatal error occured during table analysis, give up.
-    if (_abort || _service.nonExistentService()) {
+    if (_abort || (_use_service && _service.nonExistentService())) {
         return TSP_END;
     }
 
@@ -539,27 +660,25 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
 
     // Without ECM's, we descramble using fixed control words.
     if (!_need_ecm) {
-        return _scrambling.decrypt(pkt) ? TSP_OK : TSP_END;
+        return _scrambling.decryptLater(pkt) ? TSP_OK : TSP_END;
     }
 
     // Get PID context. If the PID is not known as a scrambled PID,
     // with a corresponding ECM stream, we cannot descramble it.
-    ScrambledStreamMap::iterator ssit = _scrambled_streams.find(pid);
-    if (ssit == _scrambled_streams.end()) {
+    if (!_scrambled_pids.test(pid)) {
         return TSP_OK;
     }
-    ScrambledStream& ss(ssit->second);
+    const ScrambledStream& ss(_scrambled_streams[pid]);
 
     // Locate an ECM stream with a currently valid pair of CW.
-    ECMStreamPtr pecm;
-    for (std::set<PID>::const_iterator it = ss.ecm_pids.begin(); pecm.isNull() && it != ss.ecm_pids.end(); ++it) {
-        pecm = getOrCreateECMStream(*it);
-        // Flag cw_valid is "write-protected, read-volatile", no mutex needed.
-        if (!pecm->cw_valid) {
-            pecm.clear();
+    // Flag cw_valid is "write-protected, read-volatile", no mutex needed.
+    ECMStream* pecm = nullptr;
+    for (std::vector<ECMStreamPtr>::const_iterator it = ss.ecm_streams.begin(); pecm == nullptr && it != ss.ecm_streams.end(); ++it) {
+        if ((*it)->cw_valid) {
+            pecm = it->pointer();
         }
     }
-    if (pecm.isNull()) {
+    if (pecm == nullptr) {
         // No ECM stream has valid Control Word now, cannot descramble
         return TSP_OK;
     }
@@ -591,6 +710,21 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
         }
     }
 
-    // Descramble the packet payload.
-    return pecm->scrambling.decrypt(pkt) ? TSP_OK : TSP_END;
+    // Descramble the packet payload, later, in a batch with other packets.
+    return pecm->scrambling.decryptLater(pkt) ? TSP_OK : TSP_END;
+}
+
+
+//----------------------------------------------------------------------------
+// Descramble the pending packets before passing them to the next plugin.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDescrambler::flushPackets()
+{
+    // The ECM streams are added by the packet processing thread only, this one.
+    bool ok = _scrambling.flush();
+    for (ECMStreamMap::const_iterator it = _ecm_streams.begin(); it != _ecm_streams.end(); ++it) {
+        ok = it->second->scrambling.flush() && ok;
+    }
+    return ok;
 }
@@ -38,6 +38,7 @@
 #include "tsSection.h"
 #include "tsServiceDiscovery.h"
 #include "tsTSScrambling.h"
+#include "tsTableHandlerInterface.h"
 #include "tsCondition.h"
 #include "tsMutex.h"
 #include "tsThread.h"
@@ -52,6 +53,7 @@ namespace ts {
     class TSDUCKDLL AbstractDescrambler:
         public ProcessorPlugin,
         protected PMTHandlerInterface,
+        protected TableHandlerInterface,
         protected SectionHandlerInterface
     {
         TS_NOBUILD_NOCOPY(AbstractDescrambler);
@@ -62,6 +64,7 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual bool flushPackets() override;
 
     protected:
         //!
@@ -153,6 +156,9 @@ namespace ts {
         //! an ECM, including submitting it to a smartcard. This method shall return
         //! either an odd CW, even CW or both. Missing CW's shall be empty.
         //!
+        //! With option -\-ecm-threads, several ECM's from distinct ECM streams may be
+        //! deciphered in parallel. In that case, this method must be thread-safe.
+        //!
         //! @param [in] ecm CMT section (typically an ECM).
         //! @param [in,out] cw_even Returned even CW. Empty if the ECM contains no even CW.
         //! On input, the scrambling field is set to the current descrambling mode.
@@ -174,6 +180,16 @@ namespace ts {
         //!
         virtual void handlePMT(const PMT& table) override;
 
+        //!
+        //! This hook is invoked when a complete table is available.
+        //! Implementation of TableHandlerInterface.
+        //! Used to collect the PAT and all PMT's when descrambling all services.
+        //! If overridden by a concrete descrambler, the superclass must be explicitly invoked.
+        //! @param [in,out] demux The demux which sends the table.
+        //! @param [in] table The new table from the demux.
+        //!
+        virtual void handleTable(SectionDemux& demux, const BinaryTable& table) override;
+
         //!
         //! This hook is invoked when a complete section is available.
         //! Implementation of SectionHandlerInterface.
@@ -194,18 +210,18 @@ namespace ts {
         // We filter ECM's on all these PID's and we hope that the subclass will indicate which
         // ECM's are the right ones in checkECM(). At worst, we try to decipher all ECM's from
         // all ECM streams and decipherECM() will fail with ECM's we cannot handle.
+        class ECMStream;
+        typedef SafePtr<ECMStream, NullMutex> ECMStreamPtr;
+
         class ScrambledStream
         {
         public:
             // Constructor
-            ScrambledStream() : ecm_pids() {}
+            ScrambledStream() : ecm_streams() {}
 
-            std::set<PID> ecm_pids;  // PIDs of ECM streams
+            std::vector<ECMStreamPtr> ecm_streams;  // ECM streams, in increasing order of ECM PID.
         };
 
-        // Map of scrambled streams in the service, indexed by PID.
-        typedef std::map<PID, ScrambledStream> ScrambledStreamMap;
-
         // Description of an ECM stream
         class ECMStream
         {
@@ -222,13 +238,13 @@ namespace ts {
             volatile bool new_cw_odd;   // New CW available (odd)
             // -- start of protected area --
             bool          new_ecm;      // New ECM available
+            bool          processing;   // An ECM from this stream is being deciphered by an ECM thread
             Section       ecm;          // Last received ECM
             CWData        cw_even;      // Last valid CW (even)
             CWData        cw_odd;       // Last valid CW (odd)
             // -- end of protected area --
         };
 
-        typedef SafePtr<ECMStream, NullMutex> ECMStreamPtr;
         typedef std::map<PID, ECMStreamPtr> ECMStreamMap;
 
         // ECM deciphering thread
@@ -247,6 +263,9 @@ namespace ts {
             AbstractDescrambler* _parent;
         };
 
+        typedef SafePtr<ECMThread, NullMutex> ECMThreadPtr;
+        typedef std::vector<ECMThreadPtr> ECMThreadVector;
+
         // Get the ECM stream for a PID, create it if non existent
         ECMStreamPtr getOrCreateECMStream(PID);
 
@@ -260,6 +279,7 @@ namespace ts {
 
         // Abstract descrambler private data.
         bool               _use_service;       // Descramble a service (ie. not a specific list of PID's).
+        bool               _all_services;      // Descramble all services in the transport stream.
         bool               _need_ecm;          // We need to get control words from ECM's.
         bool               _abort;             // Error, abort asap.
         bool               _synchronous;       // Synchronous ECM deciphering.
@@ -268,12 +288,15 @@ namespace ts {
         PIDSet             _pids;              // Explicit PID's to descramble.
         ServiceDiscovery   _service;           // Service to descramble (by name, id or none).
         size_t             _stack_usage;       // Stack usage for ECM deciphering.
+        size_t             _ecm_thread_count;  // Number of threads which decipher ECM's.
         SectionDemux       _demux;             // Section demux to extract ECM's.
+        SectionDemux       _pmt_demux;         // Table demux to extract the PAT and all PMT's (with _all_services).
         ECMStreamMap       _ecm_streams;       // ECM streams, indexed by PID.
-        ScrambledStreamMap _scrambled_streams; // Scrambled streams, indexed by PID.
+        PIDSet             _scrambled_pids;    // PID's with a valid entry in _scrambled_streams.
+        std::vector<ScrambledStream> _scrambled_streams; // Scrambled streams, flat table indexed by PID.
         Mutex              _mutex;             // Exclusive access to protected areas
-        Condition          _ecm_to_do;         // Notify thread to process ECM.
-        ECMThread          _ecm_thread;        // Thread which deciphers ECM's.
+        Condition          _ecm_to_do;         // Notify threads to process ECM.
+        ECMThreadVector    _ecm_threads;       // Threads which decipher ECM's.
         // -- start of protected area --
         bool               _stop_thread;       // Terminate ECM processing thread
         // -- end of protected area --
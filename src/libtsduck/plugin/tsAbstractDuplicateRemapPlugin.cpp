@@ -38,8 +38,12 @@ TSDUCK_SOURCE;
 ts::AbstractDuplicateRemapPlugin::AbstractDuplicateRemapPlugin(bool remap, TSP* tsp_, const UString& description, const UString& syntax) :
     ProcessorPlugin(tsp_, description, syntax),
     _unchecked(false),
+    _oldPIDs(),
     _newPIDs(),
-    _pidMap(),
+    _autoPIDs(),
+    _autoNewPIDs(),
+    _autoRange(),
+    _pidTable(),
     _setLabels(),
     _resetLabels(),
     _remap(remap),
@@ -57,7 +61,18 @@ ts::AbstractDuplicateRemapPlugin::AbstractDuplicateRemapPlugin(bool remap, TSP*
          u"In the latter form, all PID's within the range \"pid1\" to \"pid2\" "
          u"(inclusive) are respectively " + _verbed + u" to \"newpid\", \"newpid\"+1, etc. "
          u"This behaviour can be changed using option --single. "
-         u"The null PID 0x1FFF cannot be " + _verbed + u".");
+         u"The null PID 0x1FFF cannot be " + _verbed + u". "
+         u"When \"newpid\" is \"auto\", a new PID is automatically allocated for each "
+         u"input PID, the first time it is used. The allocated PID is not already used "
+         u"in the transport stream or as another " + _verbed + u" PID (see also option --auto-range). "
+         u"If the allocated PID is later found in the transport stream, another PID is allocated.");
+
+    option(u"auto-range", 0, PIDVAL, 0, UNLIMITED_COUNT);
+    help(u"auto-range", u"pid1[-pid2]",
+         u"Specify the PID's which can be allocated for \"auto\" " + _noun + u". "
+         u"The lowest free PID in the range is allocated first. "
+         u"Several --auto-range options may be specified. "
+         u"By default, all PID's from 0x0020 to 0x1FFE can be allocated.");
 
     option(u"single", 's');
     help(u"single",
@@ -96,21 +111,44 @@ bool ts::AbstractDuplicateRemapPlugin::getOptions()
     getIntValues(_setLabels, u"set-label");
     getIntValues(_resetLabels, u"reset-label");
 
-    _pidMap.clear();
+    getIntValues(_autoRange, u"auto-range");
+    if (!present(u"auto-range")) {
+        for (PID pid = 0x0020; pid < PID_NULL; ++pid) {
+            _autoRange.set(pid);
+        }
+    }
+
+    _oldPIDs.reset();
     _newPIDs.reset();
+    _autoPIDs.reset();
+    _autoNewPIDs.reset();
+    for (PID pid = 0; pid < PID_MAX; ++pid) {
+        _pidTable[pid] = pid;
+    }
 
     // Decode all PID duplications/remappings.
     for (size_t i = 0; i < count(u""); ++i) {
 
-        // Get parameter: pid[-pid]=newpid
+        // Get parameter: pid[-pid]=newpid or pid[-pid]=auto
         const UString param(value(u"", u"", i));
+        const bool auto_pid = param.endWith(u"=auto", CASE_INSENSITIVE);
 
         // Decode PID values
         PID pid1 = PID_NULL;
         PID pid2 = PID_NULL;
         PID newpid = PID_NULL;
 
-        if (param.scan(u"%d=%d", {&pid1, &newpid})) {
+        if (auto_pid) {
+            const UString input(param, 0, param.size() - 5);
+            if (input.scan(u"%d", {&pid1})) {
+                pid2 = pid1;
+            }
+            else if (!input.scan(u"%d-%d", {&pid1, &pid2})) {
+                tsp->error(u"invalid PID %s specification: %s", {_noun, param});
+                return false;
+            }
+        }
+        else if (param.scan(u"%d=%d", {&pid1, &newpid})) {
             // Simple form.
             pid2 = pid1;
         }
@@ -119,44 +157,106 @@ bool ts::AbstractDuplicateRemapPlugin::getOptions()
             return false;
         }
 
-        if (pid1 > pid2 || pid2 >= PID_NULL || newpid > PID_NULL || (!single && newpid + pid2 - pid1 > PID_NULL)) {
+        if (pid1 > pid2 || pid2 >= PID_NULL || newpid > PID_NULL || (!auto_pid && !single && newpid + pid2 - pid1 > PID_NULL)) {
             tsp->error(u"invalid PID %s values in %s", {_noun, param});
             return false;
         }
 
         // Skip void remapping (duplication is never void).
-        if (_remap && pid1 == newpid && (pid2 == pid1 || !single)) {
+        if (!auto_pid && _remap && pid1 == newpid && (pid2 == pid1 || !single)) {
             continue;
         }
 
         // Remember each PID remapping/duplication.
         while (pid1 <= pid2) {
-            tsp->debug(u"%s PID 0x%X (%d) to 0x%X (%d)", {_verbing, pid1, pid1, newpid, newpid});
 
             // Check that we don't remap/duplicate the same PID twice on distinct taget PID's.
             // Ignore --unchecked since this is always inconsistent.
-            const PIDMap::const_iterator it = _pidMap.find(pid1);
-            if (it != _pidMap.end() && it->second != newpid) {
+            if ((_oldPIDs.test(pid1) || _autoPIDs.test(pid1)) && (auto_pid || _autoPIDs.test(pid1) || _pidTable[pid1] != newpid)) {
                 tsp->error(u"PID 0x%X (%d) %s twice", {pid1, pid1, _verbed});
                 return false;
             }
 
-            // Remember PID mapping.
-            _pidMap.insert(std::make_pair(pid1, newpid));
-
-            // Remember output PID's
-            if (!_unchecked && _newPIDs.test(newpid)) {
-                tsp->error(u"duplicated output PID 0x%X (%d)", {newpid, newpid});
-                return false;
+            if (auto_pid) {
+                // Output PID allocated later.
+                tsp->debug(u"%s PID 0x%X (%d) to automatic PID", {_verbing, pid1, pid1});
+                _autoPIDs.set(pid1);
             }
-            _newPIDs.set(newpid);
+            else {
+                tsp->debug(u"%s PID 0x%X (%d) to 0x%X (%d)", {_verbing, pid1, pid1, newpid, newpid});
 
-            ++pid1;
-            if (!single) {
-                ++newpid;
+                // Remember output PID's
+                if (!_unchecked && _newPIDs.test(newpid)) {
+                    tsp->error(u"duplicated output PID 0x%X (%d)", {newpid, newpid});
+                    return false;
+                }
+
+                // Remember PID mapping.
+                _oldPIDs.set(pid1);
+                _newPIDs.set(newpid);
+                _pidTable[pid1] = newpid;
+                if (!single) {
+                    ++newpid;
+                }
             }
+            ++pid1;
         }
     }
 
     return true;
 }
+
+
+//----------------------------------------------------------------------------
+// Allocate the output PID of an input PID with automatic allocation.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDuplicateRemapPlugin::allocatePID(PID pid, const PIDSet& used)
+{
+    assert(pid < PID_MAX);
+    assert(_autoPIDs.test(pid));
+
+    // Never allocate an output PID, a PID which is known in the stream or another input PID with automatic allocation.
+    PIDSet candidates(_autoRange);
+    candidates.exclude(_newPIDs).exclude(used).exclude(_autoPIDs);
+
+    // Find the lowest PID in the allocation range.
+    const PID newpid = PID(candidates.first());
+    if (newpid >= PID_MAX) {
+        tsp->error(u"no more free PID to %s PID 0x%X (%d)", {_verb, pid, pid});
+        return false;
+    }
+
+    tsp->verbose(u"%s PID 0x%X (%d) to 0x%X (%d)", {_verbing, pid, pid, newpid, newpid});
+    _autoPIDs.reset(pid);
+    _oldPIDs.set(pid);
+    _newPIDs.set(newpid);
+    _autoNewPIDs.set(newpid);
+    _pidTable[pid] = newpid;
+    return true;
+}
+
+
+// Allocate another output PID when an automatic output PID is found in the input stream.
+
+bool ts::AbstractDuplicateRemapPlugin::reallocatePID(PID newpid, const PIDSet& used)
+{
+    assert(newpid < PID_MAX);
+    assert(_autoNewPIDs.test(newpid));
+
+    // Find the input PID which is mapped to this output PID.
+    PID pid = PID(_oldPIDs.first());
+    while (pid < PID_MAX && _pidTable[pid] != newpid) {
+        pid = PID(_oldPIDs.next(pid));
+    }
+    assert(pid < PID_MAX);
+
+    // Cancel the previous allocation and allocate again.
+    tsp->verbose(u"PID 0x%X (%d) found in the stream, no longer used to %s PID 0x%X (%d)", {newpid, newpid, _verb, pid, pid});
+    _oldPIDs.reset(pid);
+    _newPIDs.reset(newpid);
+    _autoNewPIDs.reset(newpid);
+    _autoPIDs.set(pid);
+    _pidTable[pid] = pid;
+    return allocatePID(pid, used);
+}
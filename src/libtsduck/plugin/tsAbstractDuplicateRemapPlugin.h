@@ -58,13 +58,41 @@ namespace ts {
         virtual bool getOptions() override;
 
     protected:
-        typedef std::map<PID, PID> PIDMap;        //!< A map from PID to PID.
+        //!
+        //! A map from PID to PID.
+        //! @deprecated No longer used, the mapping of PID's is the flat translation table @a _pidTable.
+        //!
+        typedef std::map<PID, PID> PIDMap;
+
         bool                       _unchecked;    //!< Ignore conflicting input/output PID's.
+        PIDSet                     _oldPIDs;      //!< Set of input PID values which are duplicated or remapped.
         PIDSet                     _newPIDs;      //!< Set of output (duplicated or remapped) PID values.
-        PIDMap                     _pidMap;       //!< Key = input pid, value = output PID.
+        PIDSet                     _autoPIDs;     //!< Input PID's with an automatic output PID which is not yet allocated.
+        PIDSet                     _autoNewPIDs;  //!< Output PID's which were automatically allocated.
+        PIDSet                     _autoRange;    //!< Range of PID's for automatic allocation.
+        PID                        _pidTable[PID_MAX]; //!< Flat translation table, output PID for each input PID (same PID if not duplicated or remapped).
         TSPacketMetadata::LabelSet _setLabels;    //!< Labels to set on output packets.
         TSPacketMetadata::LabelSet _resetLabels;  //!< Labels to reset on output packets.
 
+        //!
+        //! Allocate the output PID of an input PID with automatic allocation.
+        //! The output PID is the lowest PID in the allocation range which is not already an
+        //! output PID and is not in the set of PID's which are known to be used in the stream.
+        //! @param [in] pid Input PID with automatic allocation.
+        //! @param [in] used Set of PID's which are known to be used in the stream.
+        //! @return True on success, false if there is no more PID to allocate (error already reported).
+        //!
+        bool allocatePID(PID pid, const PIDSet& used);
+
+        //!
+        //! Allocate another output PID when an automatically allocated output PID is found in the input stream.
+        //! The input PID which was mapped to @a newpid is mapped to a new automatic output PID.
+        //! @param [in] newpid Automatically allocated output PID which is also used in the stream.
+        //! @param [in] used Set of PID's which are known to be used in the stream, including @a newpid.
+        //! @return True on success, false if there is no more PID to allocate (error already reported).
+        //!
+        bool reallocatePID(PID newpid, const PIDSet& used);
+
     private:
         const bool _remap;
         // Strings for help and error messages:
@@ -28,8 +28,14 @@
 //----------------------------------------------------------------------------
 
 #include "tsFileOutputPlugin.h"
+#include "tsSysUtils.h"
 TSDUCK_SOURCE;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::FileOutputPlugin::DEFAULT_NUM_WIDTH;
+constexpr size_t ts::FileOutputPlugin::WRITE_BUFFER_PACKETS;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Constructor
@@ -39,16 +45,86 @@ ts::FileOutputPlugin::FileOutputPlugin(TSP* tsp_) :
     OutputPlugin(tsp_, u"Write packets to a file", u"[options] [file-name]"),
     _name(),
     _flags(TSFile::NONE),
-    _file()
+    _max_size(0),
+    _max_duration(0),
+    _max_files(0),
+    _use_index(false),
+    _preallocate(false),
+    _segmented(false),
+    _file(),
+    _name_head(),
+    _name_tail(),
+    _name_width(DEFAULT_NUM_WIDTH),
+    _next_number(0),
+    _segment(),
+    _buffer(),
+    _buffer_count(0),
+    _seg_packets(0),
+    _pcr_pid(PID_NULL),
+    _seg_first_pcr(INVALID_PCR),
+    _seg_last_pcr(INVALID_PCR),
+    _last_index_pcr(INVALID_PCR),
+    _close_pending(false),
+    _index(),
+    _requests(),
+    _opened(),
+    _late(false),
+    _late_count(0),
+    _seg_files(),
+    _thread(this)
 {
     option(u"", 0, STRING, 0, 1);
-    help(u"", u"Name of the created output file. Use standard output by default.");
+    help(u"",
+         u"Name of the created output file. Use standard output by default. "
+         u"With --max-size or --max-duration, this is a template for the segment files. "
+         u"The segment number is inserted before the file extension. If the file name "
+         u"already ends with digits before the extension, they are used as initial "
+         u"segment number and width. Otherwise, the segment number uses " +
+         UString::Decimal(DEFAULT_NUM_WIDTH) + u" digits and starts at zero.");
 
     option(u"append", 'a');
     help(u"append", u"If the file already exists, append to the end of the file. By default, existing files are overwritten.");
 
+    option(u"index", 'i');
+    help(u"index",
+         u"With --max-size or --max-duration, create a time index file for each segment. "
+         u"The index file has the same name as the segment file with an additional '.idx' "
+         u"extension. It is a CSV text file with one line per second of stream time, "
+         u"containing the packet index, byte offset, PCR value and time offset in milliseconds "
+         u"from the beginning of the segment.");
+
     option(u"keep", 'k');
     help(u"keep", u"Keep existing file (abort if the specified file already exists). By default, existing files are overwritten.");
+
+    option(u"max-duration", 0, POSITIVE);
+    help(u"max-duration", u"seconds",
+         u"Perform a segmented recording. Start a new segment file when the current one "
+         u"has reached the specified duration in seconds. The duration is evaluated from "
+         u"the PCR's of the first PID carrying PCR's or, in the absence of PCR, from the "
+         u"transport stream bitrate. A new segment always starts on a packet containing a "
+         u"PCR or a random access point, after the maximum duration is reached.");
+
+    option(u"max-files", 0, POSITIVE);
+    help(u"max-files",
+         u"With --max-size or --max-duration, specify the maximum number of segment files "
+         u"to keep. When this number is exceeded, the oldest segment files are deleted. "
+         u"By default, all segment files are kept.");
+
+    option(u"max-size", 0, POSITIVE);
+    help(u"max-size", u"bytes",
+         u"Perform a segmented recording. Start a new segment file when the current one "
+         u"has reached the specified size in bytes. The new segment starts on the next "
+         u"packet containing a PCR or a random access point. When the operating system "
+         u"supports it, the disk space of each segment file is preallocated to this size.");
+}
+
+
+//----------------------------------------------------------------------------
+// Destructor
+//----------------------------------------------------------------------------
+
+ts::FileOutputPlugin::~FileOutputPlugin()
+{
 }
 
 
@@ -59,6 +135,12 @@ ts::FileOutputPlugin::FileOutputPlugin(TSP* tsp_) :
 bool ts::FileOutputPlugin::getOptions()
 {
     getValue(_name);
+    _max_size = intValue<uint64_t>(u"max-size", 0);
+    _max_duration = MilliSecPerSec * intValue<MilliSecond>(u"max-duration", 0);
+    _max_files = intValue<size_t>(u"max-files", 0);
+    _use_index = present(u"index");
+    _segmented = _max_size > 0 || _max_duration > 0;
+    _preallocate = _max_size > 0;
     _flags = TSFile::WRITE | TSFile::SHARED;
     if (present(u"append")) {
         _flags |= TSFile::APPEND;
@@ -66,20 +148,331 @@ bool ts::FileOutputPlugin::getOptions()
     if (present(u"keep")) {
         _flags |= TSFile::KEEP;
     }
+
+    if (_segmented && _name.empty()) {
+        tsp->error(u"a file name is required with --max-size or --max-duration");
+        return false;
+    }
+    if (_segmented && (_flags & TSFile::APPEND) != 0) {
+        tsp->error(u"--append cannot be used with --max-size or --max-duration");
+        return false;
+    }
+    if (!_segmented && (_max_files > 0 || _use_index)) {
+        tsp->error(u"--max-files and --index require --max-size or --max-duration");
+        return false;
+    }
     return true;
 }
 
 bool ts::FileOutputPlugin::start()
 {
-    return _file.open(_name, _flags, *tsp);
+    if (!_segmented) {
+        return _file.open(_name, _flags, *tsp);
+    }
+
+    // Analyze the segment file name template, same principle as hls plugin.
+    _name_head = PathPrefix(_name);
+    _name_tail = PathSuffix(_name);
+    const size_t len = _name_head.length();
+    _name_width = 0;
+    while (_name_width < len && IsDigit(_name_head[len - 1 - _name_width])) {
+        _name_width++;
+    }
+    if (_name_width == 0) {
+        _name_width = DEFAULT_NUM_WIDTH;
+        _next_number = 0;
+    }
+    else {
+        _name_head.substr(len - _name_width).toInteger(_next_number);
+        _name_head.erase(len - _name_width);
+    }
+
+    // Reset working data.
+    _buffer.resize(WRITE_BUFFER_PACKETS);
+    _buffer_count = 0;
+    _seg_packets = 0;
+    _pcr_pid = PID_NULL;
+    _seg_first_pcr = _seg_last_pcr = _last_index_pcr = INVALID_PCR;
+    _close_pending = false;
+    _late = false;
+    _late_count = 0;
+    _index.clear();
+    _seg_files.clear();
+
+    // Open the first segment synchronously, to report errors at startup.
+    _segment = new TSFile;
+    if (!openSegment(*_segment, segmentName(_next_number++))) {
+        _segment.clear();
+        return false;
+    }
+
+    // Start the segment thread and let it prepare the next segment.
+    _thread.start();
+    requestNextSegment();
+    return true;
 }
 
 bool ts::FileOutputPlugin::stop()
 {
-    return _file.close(*tsp);
+    if (!_segmented) {
+        return _file.close(*tsp);
+    }
+
+    // Write pending packets and let the segment thread close the last segment.
+    const bool ok = flushBuffer();
+    SegmentRequestQueue::MessagePtr req(new SegmentRequest);
+    req->file = _segment;
+    req->index.swap(_index);
+    _requests.forceEnqueue(req);
+    _segment.clear();
+
+    // Terminate the segment thread.
+    req = new SegmentRequest;
+    req->terminate = true;
+    _requests.forceEnqueue(req);
+    _thread.waitForTermination();
+
+    // Remove the next segment file which was prepared but not used.
+    TSFileQueue::MessagePtr next;
+    while (_opened.dequeue(next, 0)) {
+        if (!next.isNull() && next->isOpen()) {
+            const UString name(next->getFileName());
+            next->close(*tsp);
+            DeleteFile(name);
+        }
+    }
+    if (_late_count > 0) {
+        tsp->verbose(u"%'d segment switches were delayed, the next segment file was not ready", {_late_count});
+    }
+    return ok;
 }
 
 bool ts::FileOutputPlugin::send(const TSPacket* buffer, const TSPacketMetadata* pkt_data, size_t packet_count)
 {
-    return _file.write(buffer, packet_count, *tsp);
+    return _segmented ? sendSegmented(buffer, packet_count) : _file.write(buffer, packet_count, *tsp);
+}
+
+
+//----------------------------------------------------------------------------
+// Build the name of a segment file.
+//----------------------------------------------------------------------------
+
+ts::UString ts::FileOutputPlugin::segmentName(size_t number) const
+{
+    return UString::Format(u"%s%0*d%s", {_name_head, _name_width, number, _name_tail});
+}
+
+
+//----------------------------------------------------------------------------
+// Request the segment thread to open the next segment file.
+//----------------------------------------------------------------------------
+
+void ts::FileOutputPlugin::requestNextSegment()
+{
+    SegmentRequestQueue::MessagePtr req(new SegmentRequest);
+    req->open_name = segmentName(_next_number++);
+    _requests.forceEnqueue(req);
+}
+
+
+//----------------------------------------------------------------------------
+// Open a segment file and preallocate it if required.
+//----------------------------------------------------------------------------
+
+bool ts::FileOutputPlugin::openSegment(TSFile& file, const UString& name)
+{
+    if (!file.open(name, _flags, *tsp)) {
+        return false;
+    }
+    if (_preallocate) {
+        file.preallocate(_max_size, *tsp);
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Switch to the next segment.
+//----------------------------------------------------------------------------
+
+bool ts::FileOutputPlugin::renewSegment()
+{
+    // Get the next segment, opened and preallocated by the segment thread. Never wait for the
+    // segment thread: it may still be closing a previous segment, writing its index or purging
+    // old files. When the next segment is not ready, keep writing in the current segment and
+    // try again on the next boundary.
+    TSFileQueue::MessagePtr next;
+    if (!_opened.dequeue(next, 0)) {
+        if (!_late) {
+            _late = true;
+            _late_count++;
+            tsp->debug(u"next segment file not ready, continuing in %s", {_segment->getFileName()});
+        }
+        return true;
+    }
+    if (next.isNull() || !next->isOpen()) {
+        tsp->error(u"cannot create next segment file");
+        return false;
+    }
+
+    // Write pending packets in the current segment and let the segment thread close it.
+    const bool ok = flushBuffer();
+    SegmentRequestQueue::MessagePtr req(new SegmentRequest);
+    req->file = _segment;
+    req->index.swap(_index);
+    _requests.forceEnqueue(req);
+
+    _segment = next;
+    tsp->verbose(u"switching to segment file %s", {_segment->getFileName()});
+
+    // Reset segment state and prepare the next one.
+    _seg_packets = 0;
+    _seg_first_pcr = _seg_last_pcr = _last_index_pcr = INVALID_PCR;
+    _close_pending = false;
+    _late = false;
+    _index.clear();
+    requestNextSegment();
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Write the content of the write buffer in the current segment.
+//----------------------------------------------------------------------------
+
+bool ts::FileOutputPlugin::flushBuffer()
+{
+    bool ok = true;
+    if (_buffer_count > 0 && !_segment.isNull()) {
+        ok = _segment->write(_buffer.data(), _buffer_count, *tsp);
+    }
+    _buffer_count = 0;
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Write packets in segmented mode.
+//----------------------------------------------------------------------------
+
+bool ts::FileOutputPlugin::sendSegmented(const TSPacket* pkt, size_t count)
+{
+    for (; count > 0; pkt++, count--) {
+
+        // Get the PCR of the packet if it is on the reference PID.
+        const PID pid = pkt->getPID();
+        uint64_t pcr = INVALID_PCR;
+        if (pkt->hasPCR()) {
+            if (_pcr_pid == PID_NULL) {
+                _pcr_pid = pid;
+                tsp->debug(u"using PID 0x%X (%d) as PCR reference for segments", {pid, pid});
+            }
+            if (pid == _pcr_pid) {
+                pcr = pkt->getPCR();
+            }
+        }
+
+        // Start a new segment on the first boundary after the segment limit.
+        if (_close_pending && (_pcr_pid == PID_NULL || pcr != INVALID_PCR || pkt->getRandomAccessIndicator()) && !renewSegment()) {
+            return false;
+        }
+
+        // Accumulate time references of the segment.
+        if (pcr != INVALID_PCR) {
+            if (_seg_first_pcr == INVALID_PCR) {
+                _seg_first_pcr = pcr;
+            }
+            _seg_last_pcr = pcr;
+            if (_use_index && (_last_index_pcr == INVALID_PCR || DiffPCR(_last_index_pcr, pcr) >= SYSTEM_CLOCK_FREQ)) {
+                _index.push_back({_seg_packets, pcr, DiffPCR(_seg_first_pcr, pcr)});
+                _last_index_pcr = pcr;
+            }
+        }
+
+        // Buffer the packet, write the buffer when full.
+        _buffer[_buffer_count++] = *pkt;
+        _seg_packets++;
+        if (_buffer_count >= _buffer.size() && !flushBuffer()) {
+            return false;
+        }
+
+        // Check if the segment limits are reached.
+        if (!_close_pending) {
+            if (_max_size > 0 && _seg_packets * PKT_SIZE >= _max_size) {
+                _close_pending = true;
+            }
+            else if (_max_duration > 0) {
+                const MilliSecond duration = _seg_first_pcr != INVALID_PCR ?
+                    MilliSecond((DiffPCR(_seg_first_pcr, _seg_last_pcr) * MilliSecPerSec) / SYSTEM_CLOCK_FREQ) :
+                    PacketInterval(tsp->bitrate(), _seg_packets);
+                _close_pending = duration >= _max_duration;
+            }
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Segment thread.
+//----------------------------------------------------------------------------
+
+ts::FileOutputPlugin::SegmentThread::SegmentThread(FileOutputPlugin* plugin) :
+    Thread(),
+    _plugin(plugin)
+{
+}
+
+ts::FileOutputPlugin::SegmentThread::~SegmentThread()
+{
+    waitForTermination();
+}
+
+void ts::FileOutputPlugin::SegmentThread::main()
+{
+    SegmentRequestQueue::MessagePtr req;
+    while (_plugin->_requests.dequeue(req) && !req->terminate) {
+        if (!req->file.isNull()) {
+            _plugin->closeSegment(*req);
+        }
+        if (!req->open_name.empty()) {
+            // The file object is returned even if the open failed, the output thread checks if it is open.
+            TSFileQueue::MessagePtr file(new TSFile);
+            _plugin->openSegment(*file, req->open_name);
+            _plugin->_opened.forceEnqueue(file);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// In segment thread: close a segment file, write its index, purge old ones.
+//----------------------------------------------------------------------------
+
+void ts::FileOutputPlugin::closeSegment(SegmentRequest& request)
+{
+    const UString name(request.file->getFileName());
+    request.file->close(*tsp);
+    request.file.clear();
+
+    if (_use_index) {
+        UStringList lines;
+        lines.push_back(u"packet,offset,pcr,milliseconds");
+        for (auto it = request.index.begin(); it != request.index.end(); ++it) {
+            lines.push_back(UString::Format(u"%d,%d,%d,%d", {it->packet, it->packet * PKT_SIZE, it->pcr, (it->offset * MilliSecPerSec) / SYSTEM_CLOCK_FREQ}));
+        }
+        if (!UString::Save(lines, name + u".idx")) {
+            tsp->error(u"error creating index file %s.idx", {name});
+        }
+    }
+
+    _seg_files.push_back(name);
+    while (_max_files > 0 && _seg_files.size() > _max_files) {
+        tsp->verbose(u"deleting obsolete segment file %s", {_seg_files.front()});
+        DeleteFile(_seg_files.front());
+        if (_use_index) {
+            DeleteFile(_seg_files.front() + u".idx");
+        }
+        _seg_files.pop_front();
+    }
 }
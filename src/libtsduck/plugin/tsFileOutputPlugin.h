@@ -35,12 +35,23 @@
 #pragma once
 #include "tsPlugin.h"
 #include "tsTSFile.h"
+#include "tsThread.h"
+#include "tsMessageQueue.h"
 
 namespace ts {
     //!
     //! File output plugin for tsp.
     //! @ingroup plugin
     //!
+    //! In addition to the plain file mode, the plugin can perform segmented
+    //! recordings. The output is then split in successive files, rotated by size
+    //! or duration. Closing a segment file, writing its time index, purging
+    //! old segments and preparing the next one (including disk space preallocation)
+    //! are performed in a background thread, not in the tsp output thread.
+    //! The output thread never waits for the background thread: if the next segment
+    //! file is not ready at a segment boundary, the current segment is extended until
+    //! the next boundary.
+    //!
     class TSDUCKDLL FileOutputPlugin: public OutputPlugin
     {
         TS_NOBUILD_NOCOPY(FileOutputPlugin);
@@ -51,6 +62,11 @@ namespace ts {
         //!
         FileOutputPlugin(TSP* tsp);
 
+        //!
+        //! Destructor.
+        //!
+        virtual ~FileOutputPlugin() override;
+
         // Implementation of plugin API
         virtual bool getOptions() override;
         virtual bool start() override;
@@ -58,8 +74,101 @@ namespace ts {
         virtual bool send(const TSPacket*, const TSPacketMetadata*, size_t) override;
 
     private:
-        UString           _name;
-        TSFile::OpenFlags _flags;
-        TSFile            _file;
+        // Default number of digits in segment file names.
+        static constexpr size_t DEFAULT_NUM_WIDTH = 6;
+
+        // Size in packets of the write buffer in segmented mode.
+        // 1024 packets = 192,512 bytes = 47 blocks of 4 kB, a multiple of both packet and disk block sizes.
+        static constexpr size_t WRITE_BUFFER_PACKETS = 1024;
+
+        // One entry in the time index of a segment.
+        struct IndexEntry
+        {
+            PacketCounter packet;  // Packet index in segment.
+            uint64_t      pcr;     // PCR value of the packet.
+            uint64_t      offset;  // Offset in PCR units from first PCR in segment.
+        };
+        typedef std::vector<IndexEntry> IndexEntryVector;
+        typedef SafePtr<TSFile, Mutex> TSFilePtr;
+
+        // A request to the background segment thread.
+        class SegmentRequest
+        {
+            TS_NOCOPY(SegmentRequest);
+        public:
+            SegmentRequest(): terminate(false), open_name(), file(), index() {}
+            bool             terminate;   // Terminate the thread.
+            UString          open_name;   // If not empty, open and preallocate this segment file.
+            TSFilePtr        file;        // If not null, close this segment file.
+            IndexEntryVector index;       // Time index of the closed segment file.
+        };
+        typedef MessageQueue<SegmentRequest, Mutex> SegmentRequestQueue;
+        typedef MessageQueue<TSFile, Mutex> TSFileQueue;
+
+        // Background thread which opens and closes segment files.
+        class SegmentThread : public Thread
+        {
+            TS_NOBUILD_NOCOPY(SegmentThread);
+        public:
+            SegmentThread(FileOutputPlugin* plugin);
+            virtual ~SegmentThread() override;
+        private:
+            FileOutputPlugin* _plugin;
+            virtual void main() override;
+        };
+
+        // Command line options.
+        UString           _name;             // File name or segment file name template.
+        TSFile::OpenFlags _flags;            // Open flags.
+        uint64_t          _max_size;         // Maximum segment size in bytes.
+        MilliSecond       _max_duration;     // Maximum segment duration in milliseconds.
+        size_t            _max_files;        // Maximum number of segment files to keep.
+        bool              _use_index;        // Write a time index for each segment.
+        bool              _preallocate;      // Preallocate segment files.
+
+        // Working data.
+        bool              _segmented;        // Use segmented recording.
+        TSFile            _file;             // Output file in non-segmented mode.
+        UString           _name_head;        // Segment file name template, before segment number.
+        UString           _name_tail;        // Segment file name template, after segment number.
+        size_t            _name_width;       // Number of digits in segment number.
+        size_t            _next_number;      // Number of next segment file to open.
+        TSFilePtr         _segment;          // Current segment file.
+        TSPacketVector    _buffer;           // Write buffer in segmented mode.
+        size_t            _buffer_count;     // Number of packets in _buffer.
+        PacketCounter     _seg_packets;      // Number of packets in current segment.
+        PID               _pcr_pid;          // Reference PID for PCR.
+        uint64_t          _seg_first_pcr;    // First PCR in segment.
+        uint64_t          _seg_last_pcr;     // Last PCR in segment.
+        uint64_t          _last_index_pcr;   // PCR of last index entry.
+        bool              _close_pending;    // Close current segment at next boundary.
+        IndexEntryVector  _index;            // Time index of current segment.
+        SegmentRequestQueue _requests;       // Requests to the segment thread.
+        TSFileQueue       _opened;           // Segment files which were opened by the segment thread.
+        bool              _late;             // The next segment was not ready at the last boundary.
+        size_t            _late_count;       // Number of rotations which were delayed by the segment thread.
+        std::list<UString> _seg_files;       // Names of closed segment files (segment thread only).
+        SegmentThread     _thread;           // Background segment thread, declared last, terminated first.
+
+        // Build the name of a segment file.
+        UString segmentName(size_t number) const;
+
+        // Request the segment thread to open the next segment file.
+        void requestNextSegment();
+
+        // Switch to the next segment if it is ready, close the current one in the background.
+        bool renewSegment();
+
+        // Open a segment file and preallocate it if required.
+        bool openSegment(TSFile& file, const UString& name);
+
+        // Write the content of the write buffer in the current segment.
+        bool flushBuffer();
+
+        // Write packets in segmented mode.
+        bool sendSegmented(const TSPacket*, size_t);
+
+        // In segment thread: close a segment file, write its index, purge old segments.
+        void closeSegment(SegmentRequest& request);
     };
 }
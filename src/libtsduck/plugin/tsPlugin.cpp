@@ -38,9 +38,12 @@ TSDUCK_SOURCE;
 ts::TSP::TSP(int max_severity) :
     Report(max_severity),
     _use_realtime(false),
+    _use_stream_time(false),
     _tsp_bitrate(0),
     _tsp_timeout(Infinite),
     _tsp_aborting(false),
+    _tsp_sampling(false),
+    _tsp_sampling_used(false),
     _total_packets(0),
     _plugin_packets(0)
 {
@@ -178,3 +181,8 @@ ts::PluginType ts::ProcessorPlugin::type() const
 {
     return PROCESSOR_PLUGIN;
 }
+
+bool ts::ProcessorPlugin::flushPackets()
+{
+    return true;
+}
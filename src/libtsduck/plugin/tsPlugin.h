@@ -106,7 +106,7 @@ namespace ts {
         //! @c int data named @c tspInterfaceVersion which contains the current
         //! interface version at the time the library is built.
         //!
-        static const int API_VERSION = 13;
+        static const int API_VERSION = 16;
 
         //!
         //! Get the current input bitrate in bits/seconds.
@@ -137,6 +137,32 @@ namespace ts {
         //!
         bool realtime() const { return _use_realtime; }
 
+        //!
+        //! Check if the plugins should use the stream time instead of the system time.
+        //!
+        //! When tsp option -\-stream-time is specified, each input packet is time-stamped with
+        //! the stream time, as derived from PCR's (see TSPacketMetadata::getInputTimeStamp()).
+        //! Time-based plugins should then use the time stamp of the packets instead of the
+        //! system time. This way, an offline processing which runs faster than real time gives
+        //! the same results as a live processing.
+        //! @return True if the plugins should use the stream time.
+        //!
+        bool useStreamTime() const { return _use_stream_time; }
+
+        //!
+        //! Check if the plugin should switch to a lightweight sampling mode.
+        //!
+        //! When tsp option -\-sampling-threshold is specified and the number of packets which
+        //! wait for the plugin exceeds the threshold, the plugin slows down the processing chain.
+        //! Read-only analysis plugins should then analyze only a sample of the stream (for instance
+        //! packet headers only or one PES packet or section out of N) and mark their reports as
+        //! sampled. The sampling mode ends when the backlog drops below half the threshold.
+        //! A plugin which calls this method is considered as supporting the sampling mode.
+        //! Only the packets of such plugins are reported as processed in sampling mode.
+        //! @return True if the plugin should sample the stream.
+        //!
+        bool sampling() const { _tsp_sampling_used = true; return _tsp_sampling; }
+
         //!
         //! Set a timeout for the reception of packets by the current plugin.
         //! For input plugins, this is the timeout for the availability of free space in input buffer.
@@ -191,10 +217,13 @@ namespace ts {
         virtual bool thisJointTerminated() const = 0;
 
     protected:
-        bool          _use_realtime;  //!< The plugin should use realtime defaults.
-        BitRate       _tsp_bitrate;   //!< TSP input bitrate.
-        MilliSecond   _tsp_timeout;   //!< Timeout when waiting for packets (infinite by default).
-        volatile bool _tsp_aborting;  //!< TSP is currently aborting.
+        bool          _use_realtime;       //!< The plugin should use realtime defaults.
+        bool          _use_stream_time;    //!< The plugin should use the stream time.
+        BitRate       _tsp_bitrate;        //!< TSP input bitrate.
+        MilliSecond   _tsp_timeout;        //!< Timeout when waiting for packets (infinite by default).
+        volatile bool _tsp_aborting;       //!< TSP is currently aborting.
+        bool          _tsp_sampling;       //!< The plugin should sample the stream (overload).
+        mutable bool  _tsp_sampling_used;  //!< The plugin has checked the sampling mode.
 
         //!
         //! Constructor for subclasses.
@@ -526,6 +555,22 @@ namespace ts {
         //!
         virtual Status processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data) = 0;
 
+        //!
+        //! Complete the processing of packets before they are passed to the next plugin.
+        //!
+        //! The main application invokes flushPackets() each time the packets which were
+        //! submitted to processPacket() are about to be passed to the next plugin. A plugin
+        //! may defer some part of the processing of a packet, typically a cryptographic
+        //! transformation of the payload, to process many packets at once here. The packets
+        //! remain at the same address in memory and are not modified by anyone else until then.
+        //! A deferred processing shall not change the PID of a packet or drop it.
+        //!
+        //! The default implementation does nothing.
+        //! @return True on success, false on error. On error, the processing ends, as
+        //! with status TSP_END.
+        //!
+        virtual bool flushPackets();
+
         //!
         //! Get the content of the --only-label options.
         //! The value of the option is fetched each time this method is called.
@@ -40,6 +40,8 @@ const ts::TSPacketMetadata::LabelSet ts::TSPacketMetadata::AllLabels(~NoLabel);
 
 ts::TSPacketMetadata::TSPacketMetadata() :
     _labels(),
+    _input_time(INVALID_PCR),
+    _input_clock(0),
     _flush(false),
     _bitrate_changed(false),
     _input_stuffing(false),
@@ -55,12 +57,31 @@ ts::TSPacketMetadata::TSPacketMetadata() :
 void ts::TSPacketMetadata::reset()
 {
     _labels.reset();
+    _input_time = INVALID_PCR;
+    _input_clock = 0;
     _flush = false;
     _bitrate_changed = false;
     _input_stuffing = false;
     _nullified = false;
 }
 
+void ts::TSPacketMetadata::Reset(TSPacketMetadata* data, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        data[i].reset();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Input time stamp in milliseconds.
+//----------------------------------------------------------------------------
+
+ts::MilliSecond ts::TSPacketMetadata::getInputTimeStampMS() const
+{
+    return _input_time == INVALID_PCR ? 0 : MilliSecond(_input_time / (SYSTEM_CLOCK_FREQ / MilliSecPerSec));
+}
+
 
 //----------------------------------------------------------------------------
 // Label operations
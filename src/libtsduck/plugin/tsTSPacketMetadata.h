@@ -85,6 +85,13 @@ namespace ts {
         //!
         void reset();
 
+        //!
+        //! Reset the metadata of contiguous packets.
+        //! @param [in,out] data Address of the first packet metadata to reset.
+        //! @param [in] count Number of contiguous packet metadata to reset.
+        //!
+        static void Reset(TSPacketMetadata* data, size_t count);
+
         //!
         //! Specify if the packet was artificially inserted as input stuffing.
         //! @param [in] on When true, the packet was artificially inserted as input stuffing.
@@ -138,6 +145,41 @@ namespace ts {
         //!
         bool getBitrateChanged() const { return _bitrate_changed; }
 
+        //!
+        //! Set the input time stamp of the packet.
+        //! This is typically set by tsp when option -\-stream-time is used.
+        //! @param [in] time_stamp Stream time of the packet in PCR units (27 MHz), starting at
+        //! zero with the first packet. Use INVALID_PCR to clear the time stamp.
+        //!
+        void setInputTimeStamp(uint64_t time_stamp) { _input_time = time_stamp; }
+        //!
+        //! Get the input time stamp of the packet.
+        //! @return Stream time of the packet in PCR units (27 MHz) or INVALID_PCR if there is none.
+        //!
+        uint64_t getInputTimeStamp() const { return _input_time; }
+        //!
+        //! Check if the packet has an input time stamp.
+        //! @return True if the packet has an input time stamp.
+        //!
+        bool hasInputTimeStamp() const { return _input_time != INVALID_PCR; }
+        //!
+        //! Get the input time stamp of the packet in milliseconds.
+        //! @return Stream time of the packet in milliseconds or zero if there is none.
+        //!
+        MilliSecond getInputTimeStampMS() const;
+        //!
+        //! Set the system time of the input operation which received the packet.
+        //! This is set by tsp in low-latency mode (option -\-latency-target) only.
+        //! All packets from the same input operation have the same time.
+        //! @param [in] time Monotonic system time in nanoseconds, from an origin which is
+        //! common to all packets of a tsp session.
+        //!
+        void setInputClock(NanoSecond time) { _input_clock = time; }
+        //!
+        //! Get the system time of the input operation which received the packet.
+        //! @return Monotonic system time in nanoseconds in low-latency mode, zero otherwise.
+        //!
+        NanoSecond getInputClock() const { return _input_clock; }
         //!
         //! Check if the TS packet has a specific label set.
         //! @param [in] label The label to check.
@@ -165,6 +207,12 @@ namespace ts {
         //!
         bool hasAllLabels(const LabelSet& mask) const;
 
+        //!
+        //! Get all labels of the TS packet.
+        //! @return A constant reference to the set of labels of the TS packet.
+        //!
+        const LabelSet& getLabels() const { return _labels; }
+
         //!
         //! Set a specific label for the TS packet.
         //! @param [in] label The label to set.
@@ -195,11 +243,13 @@ namespace ts {
         void clearAllLabels() { _labels.reset(); }
 
     private:
-        LabelSet _labels;           // Bit mask of labels.
-        bool     _flush;            // Flush the packet buffer asap.
-        bool     _bitrate_changed;  // Call getBitrate() callback as soon as possible.
-        bool     _input_stuffing;   // Packet was artificially inserted as input stuffing.
-        bool     _nullified;        // Packet was explicitly turned into a null packet by a plugin.
+        LabelSet   _labels;            // Bit mask of labels.
+        uint64_t   _input_time;        // Input time stamp in PCR units, INVALID_PCR if none.
+        NanoSecond _input_clock;       // System time of the input operation (low-latency mode).
+        bool       _flush;             // Flush the packet buffer asap.
+        bool       _bitrate_changed;   // Call getBitrate() callback as soon as possible.
+        bool       _input_stuffing;    // Packet was artificially inserted as input stuffing.
+        bool       _nullified;         // Packet was explicitly turned into a null packet by a plugin.
     };
 
     //!
@@ -57,6 +57,8 @@ ts::TSProcessorArgs::TSProcessorArgs() :
     ts_buffer_size(DEFAULT_BUFFER_SIZE),
     max_flush_pkt(0),
     max_input_pkt(0),
+    latency_target(0),
+    sampling_threshold(0),
     instuff_nullpkt(0),
     instuff_inpkt(0),
     instuff_start(0),
@@ -66,6 +68,8 @@ ts::TSProcessorArgs::TSProcessorArgs() :
     init_bitrate_adj(DEF_INIT_BITRATE_PKT_INTERVAL),
     realtime(Tristate::MAYBE),
     receive_timeout(0),
+    stream_time(false),
+    stream_time_pid(PID_NULL),
     control_port(0),
     control_local(),
     control_reuse(false),
@@ -171,6 +175,45 @@ void ts::TSProcessorArgs::defineArgs(Args& args) const
               u"Equivalent to the same --receive-timeout options in some plugins. "
               u"By default, there is no input timeout.");
 
+    args.option(u"stream-time");
+    args.help(u"stream-time",
+              u"Time stamp all input packets with the stream time, as derived from the PCR's of "
+              u"a reference PID, and use the stream time instead of the system time for the "
+              u"periodic bitrate adjustments. Plugins which support it (for instance analyze, "
+              u"time, until) also use the stream time instead of the system time. This way, "
+              u"an offline processing which runs much faster than real time gives the same "
+              u"results as a live processing of the same stream.");
+
+    args.option(u"stream-time-pid", 0, Args::PIDVAL);
+    args.help(u"stream-time-pid",
+              u"With --stream-time, specify the reference PID for the PCR's. "
+              u"By default, the first PID containing PCR's is used.");
+
+    args.option(u"sampling-threshold", 0, Args::INTEGER, 0, 1, 1, 100);
+    args.help(u"sampling-threshold", u"percent",
+              u"Enable the overload sampling mode. When the number of packets which wait to be "
+              u"processed by a plugin exceeds the specified percentage of the global buffer size, "
+              u"the plugin is notified that it should switch to a lightweight sampling mode. "
+              u"Analysis plugins which support it (for instance analyze, pcrextract, pes, tables) "
+              u"then analyze only a sample of the stream and mark their reports as sampled. "
+              u"The sampling mode ends when the backlog drops below half the threshold. "
+              u"This option is useful to keep real time on overloaded systems. "
+              u"By default, plugins never switch to sampling mode.");
+
+    args.option(u"latency-target", 0, Args::POSITIVE);
+    args.help(u"latency-target", u"milliseconds",
+              u"Enable the low-latency mode with the specified latency budget in milliseconds. "
+              u"In this mode, the number of packets which are read at a time from the input plug-in "
+              u"and processed by each plugin before flushing them to the next one is computed from "
+              u"the input bitrate so that each window of packets does not last longer than the "
+              u"latency target. Packets are also flushed to the next plugin when the latency target "
+              u"has elapsed since the first pending packet, regardless of the number of packets. "
+              u"Similarly, the output plug-in sends at most one window of packets at a time and "
+              u"returns them to the input plug-in when the latency target has elapsed. "
+              u"The values of --max-flushed-packets and --max-input-packets remain upper limits. "
+              u"The latency of packets between the input and the output plugins is measured and "
+              u"reported in verbose mode.");
+
     args.option(u"max-flushed-packets", 0, Args::POSITIVE);
     args.help(u"max-flushed-packets",
               u"Specify the maximum number of packets to be processed before flushing "
@@ -217,11 +260,15 @@ bool ts::TSProcessorArgs::loadArgs(DuckContext& duck, Args& args)
     bitrate_adj = MilliSecPerSec * args.intValue(u"bitrate-adjust-interval", DEF_BITRATE_INTERVAL);
     max_flush_pkt = args.intValue<size_t>(u"max-flushed-packets", 0);
     max_input_pkt = args.intValue<size_t>(u"max-input-packets", 0);
+    latency_target = args.intValue<MilliSecond>(u"latency-target", 0);
+    sampling_threshold = args.intValue<size_t>(u"sampling-threshold", 0);
     instuff_start = args.intValue<size_t>(u"add-start-stuffing", 0);
     instuff_stop = args.intValue<size_t>(u"add-stop-stuffing", 0);
     ignore_jt = args.present(u"ignore-joint-termination");
     realtime = args.tristateValue(u"realtime");
     receive_timeout = args.intValue<MilliSecond>(u"receive-timeout", 0);
+    stream_time = args.present(u"stream-time") || args.present(u"stream-time-pid");
+    stream_time_pid = args.intValue<PID>(u"stream-time-pid", PID_NULL);
     control_port = args.intValue<uint16_t>(u"control-port", 0);
     control_timeout = args.intValue<MilliSecond>(u"control-timeout", DEF_CONTROL_TIMEOUT);
     control_reuse = args.present(u"control-reuse-port");
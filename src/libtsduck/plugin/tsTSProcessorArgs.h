@@ -51,6 +51,8 @@ namespace ts {
         size_t          ts_buffer_size;   //!< Size in bytes of the global TS packet buffer.
         size_t          max_flush_pkt;    //!< Max processed packets before flush.
         size_t          max_input_pkt;    //!< Max packets per input operation.
+        MilliSecond     latency_target;   //!< Target latency of packet windows in low-latency mode, zero if not used.
+        size_t          sampling_threshold; //!< Backlog of a plugin in percent of the buffer size to switch to sampling mode, zero if not used.
         size_t          instuff_nullpkt;  //!< Add input stuffing: add @a instuff_nullpkt null packets every @a instuff_inpkt input packets.
         size_t          instuff_inpkt;    //!< Add input stuffing: add @a instuff_nullpkt null packets every @a instuff_inpkt input packets.
         size_t          instuff_start;    //!< Add input stuffing: add @a instuff_start null packets before actual input.
@@ -60,6 +62,8 @@ namespace ts {
         PacketCounter   init_bitrate_adj; //!< As long as input bitrate is unknown, reevaluate periodically.
         Tristate        realtime;         //!< Use real-time options.
         MilliSecond     receive_timeout;  //!< Timeout on input operations.
+        bool            stream_time;      //!< Time stamp input packets with the stream time, derived from PCR's.
+        PID             stream_time_pid;  //!< Reference PID for the stream time, PID_NULL means first PID with PCR's.
         uint16_t        control_port;     //!< TCP server port for control commands.
         IPAddress       control_local;    //!< Local interface on which to listen for control commands.
         bool            control_reuse;    //!< Set the 'reuse port' socket option on the control TCP server port.
@@ -77,6 +77,7 @@
 #include "tsATSCAC3AudioStreamDescriptor.h"
 #include "tsATSCEAC3AudioDescriptor.h"
 #include "tsATSCEIT.h"
+#include "tsATSCHuffman.h"
 #include "tsATSCMultipleString.h"
 #include "tsATSCStuffingDescriptor.h"
 #include "tsATSCTimeShiftedServiceDescriptor.h"
@@ -97,6 +98,7 @@
 #include "tsBinaryTable.h"
 #include "tsBitrateDifferenceDVBT.h"
 #include "tsBitRateRegulator.h"
+#include "tsBitSet.h"
 #include "tsBitStream.h"
 #include "tsBlockCipher.h"
 #include "tsBlockCipherAlertInterface.h"
@@ -159,6 +161,7 @@
 #include "tsDektecUtils.h"
 #include "tsDeliverySystem.h"
 #include "tsDES.h"
+#include "tsDESBatch.h"
 #include "tsDescriptor.h"
 #include "tsDescriptorList.h"
 #include "tsDIILocationDescriptor.h"
@@ -220,6 +223,7 @@
 #include "tsExternalApplicationAuthorizationDescriptor.h"
 #include "tsExternalESIdDescriptor.h"
 #include "tsFatal.h"
+#include "tsFieldLayout.h"
 #include "tsFileInputPlugin.h"
 #include "tsFileNameRate.h"
 #include "tsFileOutputPlugin.h"
@@ -250,6 +254,7 @@
 #include "tshlsOutputPlugin.h"
 #include "tshlsPlayList.h"
 #include "tshlsTagAttributes.h"
+#include "tsHTTPStreamServer.h"
 #include "tsIBPDescriptor.h"
 #include "tsIDSA.h"
 #include "tsImageIconDescriptor.h"
@@ -278,6 +283,7 @@
 #include "tsjsonNull.h"
 #include "tsjsonNumber.h"
 #include "tsjsonObject.h"
+#include "tsjsonReader.h"
 #include "tsjsonString.h"
 #include "tsjsonTrue.h"
 #include "tsjsonValue.h"
@@ -335,6 +341,9 @@
 #include "tsPacketDecapsulation.h"
 #include "tsPacketEncapsulation.h"
 #include "tsPacketizer.h"
+#include "tsPacketTraceReader.h"
+#include "tsPacketTraceRecord.h"
+#include "tsPacketTraceWriter.h"
 #include "tsPagerArgs.h"
 #include "tsParentalRatingDescriptor.h"
 #include "tsPartialTransportStreamDescriptor.h"
@@ -433,6 +442,7 @@
 #include "tsStandaloneTableDemux.h"
 #include "tsStaticInstance.h"
 #include "tsSTDDescriptor.h"
+#include "tsStreamClock.h"
 #include "tsStreamEventDescriptor.h"
 #include "tsStreamIdentifierDescriptor.h"
 #include "tsStreamModeDescriptor.h"
@@ -528,6 +538,7 @@
 #include "tsTSScanner.h"
 #include "tsTSScrambling.h"
 #include "tsTSSpeedMetrics.h"
+#include "tsTSStitcher.h"
 #include "tsTuner.h"
 #include "tsTunerArgs.h"
 #include "tsTVCT.h"
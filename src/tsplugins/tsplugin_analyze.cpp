@@ -37,15 +37,20 @@
 #include "tsTSAnalyzerReport.h"
 #include "tsTSSpeedMetrics.h"
 #include "tsSysUtils.h"
+#include "tsMessageQueue.h"
+#include "tsThread.h"
 TSDUCK_SOURCE;
 
+#define MAX_QUEUED_STATES         1             // Max number of state snapshots waiting to be written.
+#define STATE_THREAD_STACK_SIZE   (128 * 1024)  // Stack size of the thread which writes state files.
+
 
 //----------------------------------------------------------------------------
 // Plugin definition
 //----------------------------------------------------------------------------
 
 namespace ts {
-    class AnalyzePlugin: public ProcessorPlugin
+    class AnalyzePlugin: public ProcessorPlugin, private Thread
     {
         TS_NOBUILD_NOCOPY(AnalyzePlugin);
     public:
@@ -57,10 +62,15 @@ namespace ts {
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
 
     private:
+        // Binary state snapshots are written by a background thread.
+        typedef MessageQueue<TSAnalyzer::StateSnapshot, Mutex> StateQueue;
+
         // Command line options:
         UString           _output_name;
         NanoSecond        _output_interval;
         bool              _multiple_output;
+        UString           _state_name;
+        NanoSecond        _state_interval;
         TSAnalyzerOptions _analyzer_options;
 
         // Working data:
@@ -68,11 +78,23 @@ namespace ts {
         std::ostream*     _output;
         TSSpeedMetrics    _metrics;
         NanoSecond        _next_report;
+        NanoSecond        _next_state;
+        Time              _start_time;   // Local time at start, origin of stream time.
+        MilliSecond       _stream_time;  // Stream time of last packet (tsp --stream-time).
         TSAnalyzerReport  _analyzer;
+        StateQueue        _states;         // Snapshots to write, a null pointer terminates the thread.
+        PacketCounter     _skipped_states; // Snapshots which were skipped because the previous one was not yet written.
 
         bool openOutput();
         void closeOutput();
         bool produceReport();
+
+        // Take a snapshot of the analysis state and pass it to the state thread.
+        // When force is false, the snapshot is skipped if the previous one is not yet written.
+        void saveState(bool force);
+
+        // Implementation of Thread: write the state snapshots.
+        virtual void main() override;
     };
 }
 
@@ -86,15 +108,23 @@ TSPLUGIN_DECLARE_PROCESSOR(analyze, ts::AnalyzePlugin)
 
 ts::AnalyzePlugin::AnalyzePlugin(TSP* tsp_) :
     ProcessorPlugin(tsp_, u"Analyze the structure of a transport stream", u"[options]"),
+    Thread(ThreadAttributes().setStackSize(STATE_THREAD_STACK_SIZE)),
     _output_name(),
     _output_interval(0),
     _multiple_output(false),
+    _state_name(),
+    _state_interval(0),
     _analyzer_options(),
     _output_stream(),
     _output(),
     _metrics(),
     _next_report(0),
-    _analyzer(duck)
+    _next_state(0),
+    _start_time(),
+    _stream_time(0),
+    _analyzer(duck),
+    _states(MAX_QUEUED_STATES),
+    _skipped_states(0)
 {
     // Define all standard analysis options.
     duck.defineArgsForStandards(*this);
@@ -106,7 +136,9 @@ ts::AnalyzePlugin::AnalyzePlugin(TSP* tsp_) :
          u"Produce a new output file at regular intervals. "
          u"The interval value is in seconds. "
          u"After outputing a file, the analysis context is reset, "
-         u"ie. each output file contains a fully independent analysis.");
+         u"ie. each output file contains a fully independent analysis. "
+         u"With the tsp option --stream-time, the interval is measured in "
+         u"stream time instead of system time.");
 
     option(u"multiple-files", 'm');
     help(u"multiple-files",
@@ -119,6 +151,18 @@ ts::AnalyzePlugin::AnalyzePlugin(TSP* tsp_) :
     help(u"output-file", u"filename",
          u"Specify the output text file for the analysis result. "
          u"By default, use the standard output.");
+
+    option(u"state-file", 0, STRING);
+    help(u"state-file", u"filename",
+         u"Save the cumulative analysis state in the specified binary file at regular "
+         u"intervals and when the plugin stops. If the file already exists when the "
+         u"plugin starts, the analysis resumes from the saved state. This is useful "
+         u"to keep long-term statistics across restarts of tsp.");
+
+    option(u"state-interval", 0, POSITIVE);
+    help(u"state-interval", u"seconds",
+         u"With --state-file, specify the interval in seconds between two saves "
+         u"of the analysis state. The default is 60 seconds.");
 }
 
 
@@ -133,6 +177,8 @@ bool ts::AnalyzePlugin::getOptions()
     _output_name = value(u"output-file");
     _output_interval = NanoSecPerSec * intValue<Second>(u"interval", 0);
     _multiple_output = present(u"multiple-files");
+    _state_name = value(u"state-file");
+    _state_interval = NanoSecPerSec * intValue<Second>(u"state-interval", 60);
     return true;
 }
 
@@ -146,9 +192,21 @@ bool ts::AnalyzePlugin::start()
     _output = _output_name.empty() ? &std::cout : &_output_stream;
     _analyzer.setAnalysisOptions(_analyzer_options);
 
-    // For production of multiple reports at regular intervals.
+    // Resume a previous analysis.
+    if (!_state_name.empty() && FileExists(_state_name)) {
+        if (!_analyzer.loadState(_state_name, *tsp)) {
+            return false;
+        }
+        tsp->verbose(u"analysis state reloaded from %s", {_state_name});
+    }
+
+    // For production of multiple reports and state snapshots at regular intervals.
     _metrics.start();
+    _start_time = Time::CurrentLocalTime();
+    _stream_time = 0;
     _next_report = _output_interval;
+    _next_state = _state_name.empty() ? 0 : _state_interval;
+    _skipped_states = 0;
 
     // Create the output file. Note that this file is used only in the stop
     // method and could be created there. However, if the file cannot be
@@ -157,6 +215,11 @@ bool ts::AnalyzePlugin::start()
         return false;
     }
 
+    // Start the thread which writes the state snapshots.
+    if (!_state_name.empty()) {
+        Thread::start();
+    }
+
     return true;
 }
 
@@ -175,7 +238,7 @@ bool ts::AnalyzePlugin::openOutput()
     // Build file name in case of --multiple-files
     UString name;
     if (_multiple_output) {
-        const Time::Fields now(Time::CurrentLocalTime());
+        const Time::Fields now(tsp->useStreamTime() ? _start_time + _stream_time : Time::CurrentLocalTime());
         name = UString::Format(u"%s_%04d%02d%02d_%02d%02d%02d%s", {PathPrefix(_output_name), now.year, now.month, now.day, now.hour, now.minute, now.second, PathSuffix(_output_name)});
     }
     else {
@@ -234,29 +297,101 @@ bool ts::AnalyzePlugin::produceReport()
 bool ts::AnalyzePlugin::stop()
 {
     produceReport();
+    if (!_state_name.empty()) {
+        // Save the final state, then terminate the state thread after all pending snapshots.
+        saveState(true);
+        _states.forceEnqueue(nullptr);
+        Thread::waitForTermination();
+        if (_skipped_states > 0) {
+            tsp->verbose(u"%'d state snapshots skipped, writing the state file was too slow", {_skipped_states});
+        }
+    }
     return true;
 }
 
 
+//----------------------------------------------------------------------------
+// Take a snapshot of the analysis state and pass it to the state thread.
+//----------------------------------------------------------------------------
+
+void ts::AnalyzePlugin::saveState(bool force)
+{
+    // Only a copy of the state is made in the packet processing thread.
+    // The serialization and the file operations, which may block, are done in the state thread.
+    StateQueue::MessagePtr state(new TSAnalyzer::StateSnapshot);
+    _analyzer.getState(*state);
+    if (force) {
+        _states.forceEnqueue(state);
+    }
+    else if (!_states.enqueue(state, 0)) {
+        // The previous snapshot is not yet written, skip this one.
+        _skipped_states++;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// State thread: write the state snapshots.
+//----------------------------------------------------------------------------
+
+void ts::AnalyzePlugin::main()
+{
+    tsp->debug(u"state thread started");
+
+    ByteBlock data;
+    for (;;) {
+        StateQueue::MessagePtr state;
+        _states.dequeue(state);
+        if (state.isNull()) {
+            break;
+        }
+        state->serialize(data);
+        TSAnalyzer::SaveStateFile(data, _state_name, *tsp);
+    }
+
+    tsp->debug(u"state thread completed");
+}
+
+
 //----------------------------------------------------------------------------
 // Packet processing method
 //----------------------------------------------------------------------------
 
 ts::ProcessorPlugin::Status ts::AnalyzePlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
 {
-    // Feed the analyzer with one packet
+    // Feed the analyzer with one packet, only the headers and PSI/SI when tsp is overloaded.
+    _analyzer.setSampling(tsp->sampling());
     _analyzer.feedPacket (pkt);
 
-    // With --interval, check if it is time to produce a report
-    if (_output_interval > 0 && _metrics.processedPacket() && _metrics.sessionNanoSeconds() >= _next_report) {
-        // Time to produce a report.
-        if (!produceReport()) {
-            return TSP_END;
+    // With tsp --stream-time, the time stamp of the packet is used instead of the system time.
+    const bool stream_time = tsp->useStreamTime() && pkt_data.hasInputTimeStamp();
+    if (stream_time) {
+        _stream_time = pkt_data.getInputTimeStampMS();
+    }
+
+    // With --interval or --state-file, the system clock is checked from time to time only.
+    if ((_output_interval > 0 || _next_state > 0) && (stream_time || _metrics.processedPacket())) {
+
+        // Current time since start.
+        const NanoSecond now = stream_time ? _stream_time * NanoSecPerMilliSec : _metrics.sessionNanoSeconds();
+
+        // With --interval, check if it is time to produce a report
+        if (_output_interval > 0 && now >= _next_report) {
+            // Time to produce a report.
+            if (!produceReport()) {
+                return TSP_END;
+            }
+            // Reset analysis context.
+            _analyzer.reset();
+            // Compute next report time.
+            _next_report += _output_interval;
+        }
+
+        // With --state-file, check if it is time to save the analysis state.
+        if (_next_state > 0 && now >= _next_state) {
+            saveState(false);
+            _next_state += _state_interval;
         }
-        // Reset analysis context.
-        _analyzer.reset();
-        // Compute next report time.
-        _next_report += _output_interval;
     }
 
     return TSP_OK;
@@ -61,6 +61,7 @@ namespace ts {
 
         bool             _silentDrop;       // Silently drop packets on overflow.
         size_t           _maxBuffered;      // Max buffered packets.
+        PIDSet           _inputPIDs;        // PID's which were found in the input stream.
         TSPacketPtrQueue _queue;            // Buffered packets, waiting for null packets to replace.
     };
 }
@@ -77,6 +78,7 @@ ts::DuplicatePlugin::DuplicatePlugin(TSP* tsp_) :
     AbstractDuplicateRemapPlugin(false, tsp_, u"Duplicate PID's, reusing null packets", u"[options] [pid[-pid]=newpid ...]"),
     _silentDrop(false),
     _maxBuffered(0),
+    _inputPIDs(),
     _queue()
 {
     option(u"drop-overflow", 'd');
@@ -116,7 +118,8 @@ bool ts::DuplicatePlugin::getOptions()
 bool ts::DuplicatePlugin::start()
 {
     _queue.clear();
-    tsp->verbose(u"%d PID's duplicated", {_pidMap.size()});
+    _inputPIDs.reset();
+    tsp->verbose(u"%d PID's duplicated, %d PID's with automatic allocation", {_oldPIDs.count(), _autoPIDs.count()});
     return true;
 }
 
@@ -129,12 +132,23 @@ ts::ProcessorPlugin::Status ts::DuplicatePlugin::processPacket(TSPacket& pkt, TS
 {
     // Get old and new PID.
     const PID pid = pkt.getPID();
-    const PIDMap::const_iterator it = _pidMap.find(pid);
-    const bool duplicate = it != _pidMap.end();
-    const PID newpid = duplicate ? it->second : pid;
+    _inputPIDs.set(pid);
 
-    // Check PID conflicts.
-    if (!_unchecked && !duplicate && _newPIDs.test(pid)) {
+    // Allocate the output PID on first use.
+    if (_autoPIDs.test(pid) && !allocatePID(pid, _inputPIDs)) {
+        return TSP_END;
+    }
+    const bool duplicate = _oldPIDs.test(pid);
+    const PID newpid = _pidTable[pid];
+
+    // Check PID conflicts. Since input packets are kept, an automatic output PID which is
+    // found in the input stream is allocated again, for the next duplicated packets.
+    if (_autoNewPIDs.test(pid)) {
+        if (!reallocatePID(pid, _inputPIDs)) {
+            return TSP_END;
+        }
+    }
+    else if (!_unchecked && !duplicate && _newPIDs.test(pid)) {
         tsp->error(u"PID conflict: PID %d (0x%X) present both in input and duplicate", {pid, pid});
         return TSP_END;
     }
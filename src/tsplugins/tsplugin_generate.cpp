@@ -0,0 +1,682 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Transport stream processor shared library:
+//  Generate a synthetic multi-service transport stream.
+//
+//  All packets are copied from precomputed templates. The position of each
+//  packet in the TS is precomputed once for a cycle of one second of stream.
+//  Only continuity counters, clocks and scrambling bits are patched in the
+//  copied packets.
+//
+//----------------------------------------------------------------------------
+
+#include "tsPlugin.h"
+#include "tsPluginRepository.h"
+#include "tsOneShotPacketizer.h"
+#include "tsPCR.h"
+#include "tsPAT.h"
+#include "tsPMT.h"
+#include "tsSDT.h"
+#include "tsNIT.h"
+#include "tsEIT.h"
+#include "tsShortEventDescriptor.h"
+#include "tsNetworkNameDescriptor.h"
+#include "tsServiceListDescriptor.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Plugin definition
+//----------------------------------------------------------------------------
+
+namespace ts {
+    class GenerateInput: public InputPlugin
+    {
+        TS_NOBUILD_NOCOPY(GenerateInput);
+    public:
+        // Implementation of plugin API
+        GenerateInput(TSP*);
+        virtual bool getOptions() override;
+        virtual bool start() override;
+        virtual size_t receive(TSPacket*, TSPacketMetadata*, size_t) override;
+        virtual BitRate getBitrate() override;
+        virtual bool abortInput() override;
+        virtual bool setReceiveTimeout(MilliSecond timeout) override;
+
+    private:
+        // Kind of packet source.
+        enum SourceKind {SRC_PSI, SRC_VIDEO, SRC_AUDIO};
+
+        // Index of a source in the schedule of a cycle. NO_SOURCE means null packet.
+        typedef uint16_t SourceIndex;
+        static constexpr SourceIndex NO_SOURCE = 0xFFFF;
+
+        // Timing of the generated elementary streams.
+        static constexpr MilliSecond VIDEO_FRAME_DURATION = 40;  // 25 frames per second.
+        static constexpr MilliSecond AUDIO_FRAME_DURATION = 24;  // MPEG-1 layer II, 48 kHz.
+        static constexpr MilliSecond DECODING_DELAY = 500;       // DTS (or PTS for audio) is PCR + delay.
+
+        // Offsets in the PES templates.
+        static constexpr size_t VIDEO_PCR_OFFSET = 6;
+        static constexpr size_t VIDEO_PTS_OFFSET = 21;
+        static constexpr size_t VIDEO_DTS_OFFSET = 26;
+        static constexpr size_t AUDIO_PTS_OFFSET = 13;
+
+        // Description of a source of packets in the generated TS.
+        class Source
+        {
+        public:
+            SourceKind     kind;        // Type of source.
+            uint8_t        cc;          // Last continuity counter.
+            size_t         period;      // PSI: packets are sent one cycle out of 'period'.
+            size_t         repeat;      // PSI: number of repetitions of the tables per cycle.
+            size_t         slots;       // Video, audio: number of packets per cycle.
+            size_t         pes_size;    // Video, audio: number of packets per PES packet.
+            size_t         next;        // Index of next packet in PSI packets or in current PES packet.
+            TSPacketVector packets;     // Templates: PSI packets or first and next packets of PES packets.
+
+            // Constructor.
+            Source(SourceKind k = SRC_PSI);
+
+            // Number of packets slots in a cycle.
+            size_t slotCount() const { return kind == SRC_PSI ? repeat * packets.size() : slots; }
+        };
+
+        // Command line options:
+        PacketCounter _max_count;         // Number of packets to generate.
+        size_t        _service_count;     // Number of services.
+        uint16_t      _first_service_id;  // Service id of first service.
+        PID           _first_pid;         // PMT PID of first service.
+        uint16_t      _ts_id;             // Transport stream id.
+        uint16_t      _network_id;        // Network id and original network id.
+        BitRate       _req_bitrate;       // Requested TS bitrate.
+        BitRate       _video_bitrate;     // Bitrate of each video PID.
+        BitRate       _audio_bitrate;     // Bitrate of each audio PID.
+        bool          _scrambling;        // Set scrambling control bits in audio and video packets.
+        Second        _crypto_period;     // Duration of a crypto period for scrambling control bits.
+        PacketCounter _cc_error_interval; // Inject a continuity error every N packets.
+        Second        _pcr_jump_interval; // Inject a PCR jump every N seconds.
+        MilliSecond   _pcr_jump;          // Amount of each PCR jump.
+
+        // Working data:
+        std::vector<Source>      _sources;       // All packet sources.
+        std::vector<SourceIndex> _schedule;      // Source of each packet in a cycle (one second).
+        BitRate                  _bitrate;       // Actual TS bitrate (number of slots in a cycle).
+        PacketCounter            _count;         // Number of generated packets.
+        PacketCounter            _limit;         // Current max number of packets.
+        uint64_t                 _cycle;         // Current cycle index (in seconds).
+        size_t                   _slot;          // Next slot in the current cycle.
+        uint64_t                 _clock_offset;  // Accumulated PCR jumps, in PCR units.
+        uint8_t                  _scrambling_bits; // Scrambling control value in current cycle.
+        bool                     _cc_error;      // Inject a continuity error in next audio or video packet.
+
+        // Build the sources and the schedule of a cycle.
+        bool buildSources();
+        void addPSI(PID pid, const AbstractTable& table, size_t repeat, size_t period);
+        void addPES(SourceKind kind, PID pid, BitRate bitrate);
+        bool buildSchedule();
+
+        // Update clocks and error state at the beginning of a cycle.
+        void startCycle();
+
+        // Generate the next packet of a source.
+        void generatePSI(Source&, TSPacket&);
+        void generatePES(Source&, TSPacket&);
+
+        // Insert a PTS or DTS value at a given address.
+        static void PutPDTS(uint8_t* b, uint64_t value);
+    };
+}
+
+TSPLUGIN_DECLARE_VERSION
+TSPLUGIN_DECLARE_INPUT(generate, ts::GenerateInput)
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr ts::GenerateInput::SourceIndex ts::GenerateInput::NO_SOURCE;
+constexpr ts::MilliSecond ts::GenerateInput::VIDEO_FRAME_DURATION;
+constexpr ts::MilliSecond ts::GenerateInput::AUDIO_FRAME_DURATION;
+constexpr ts::MilliSecond ts::GenerateInput::DECODING_DELAY;
+constexpr size_t ts::GenerateInput::VIDEO_PCR_OFFSET;
+constexpr size_t ts::GenerateInput::VIDEO_PTS_OFFSET;
+constexpr size_t ts::GenerateInput::VIDEO_DTS_OFFSET;
+constexpr size_t ts::GenerateInput::AUDIO_PTS_OFFSET;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Constructors
+//----------------------------------------------------------------------------
+
+ts::GenerateInput::Source::Source(SourceKind k) :
+    kind(k),
+    cc(0),
+    period(1),
+    repeat(1),
+    slots(0),
+    pes_size(1),
+    next(0),
+    packets()
+{
+}
+
+ts::GenerateInput::GenerateInput(TSP* tsp_) :
+    InputPlugin(tsp_, u"Generate a synthetic multi-service transport stream", u"[options] [count]"),
+    _max_count(0),
+    _service_count(0),
+    _first_service_id(0),
+    _first_pid(PID_NULL),
+    _ts_id(0),
+    _network_id(0),
+    _req_bitrate(0),
+    _video_bitrate(0),
+    _audio_bitrate(0),
+    _scrambling(false),
+    _crypto_period(0),
+    _cc_error_interval(0),
+    _pcr_jump_interval(0),
+    _pcr_jump(0),
+    _sources(),
+    _schedule(),
+    _bitrate(0),
+    _count(0),
+    _limit(0),
+    _cycle(0),
+    _slot(0),
+    _clock_offset(0),
+    _scrambling_bits(SC_CLEAR),
+    _cc_error(false)
+{
+    option(u"", 0, UNSIGNED, 0, 1);
+    help(u"",
+         u"Specify the number of packets to generate. After the last packet, "
+         u"an end-of-file condition is generated. By default, if count is not "
+         u"specified, packets are generated endlessly.");
+
+    option(u"audio-bitrate", 0, UINT32);
+    help(u"audio-bitrate",
+         u"Bitrate of the audio PID of each service, in bits/second. "
+         u"The default is 192,000 b/s.");
+
+    option(u"bitrate", 'b', UINT32);
+    help(u"bitrate",
+         u"Bitrate of the generated transport stream, in bits/second. "
+         u"The packets which are not used by the services are null packets. "
+         u"The actual bitrate is rounded to an integral number of packets per second. "
+         u"The default is 38,000,000 b/s.");
+
+    option(u"cc-error-interval", 0, POSITIVE);
+    help(u"cc-error-interval",
+         u"Inject a continuity error every specified number of packets. "
+         u"The error is a missing continuity counter in the next audio or video packet. "
+         u"By default, no continuity error is injected.");
+
+    option(u"crypto-period", 0, POSITIVE);
+    help(u"crypto-period",
+         u"With --scrambling, specify the duration of each crypto period in seconds, "
+         u"after which the scrambling control bits switch between even and odd key. "
+         u"The default is 10 seconds.");
+
+    option(u"first-pid", 0, PIDVAL);
+    help(u"first-pid",
+         u"PMT PID of the first service. The PMT PID of each subsequent service is "
+         u"16 PID's after the previous one. The video and audio PID's of a service "
+         u"are the two PID's following its PMT PID. The default is 0x0100.");
+
+    option(u"first-service-id", 0, UINT16);
+    help(u"first-service-id",
+         u"Service id of the first service. The subsequent services use consecutive "
+         u"service ids. The default is 1.");
+
+    option(u"joint-termination", 'j');
+    help(u"joint-termination",
+         u"When the number of packets is specified, perform a \"joint "
+         u"termination\" when completed instead of unconditional termination. "
+         u"See \"tsp --help\" for more details on \"joint termination\".");
+
+    option(u"network-id", 0, UINT16);
+    help(u"network-id",
+         u"Network id and original network id of the transport stream. The default is 1.");
+
+    option(u"pcr-jump", 0, POSITIVE);
+    help(u"pcr-jump",
+         u"With --pcr-jump-interval, amount of each jump in milliseconds. "
+         u"The default is 1,000 ms.");
+
+    option(u"pcr-jump-interval", 0, POSITIVE);
+    help(u"pcr-jump-interval",
+         u"Inject a jump in the PCR, PTS and DTS of all services every specified "
+         u"number of seconds, without discontinuity indicator. "
+         u"By default, the clocks are continuous.");
+
+    option(u"scrambling", 0);
+    help(u"scrambling",
+         u"Set the scrambling control bits in all audio and video packets, alternating "
+         u"even and odd key at each crypto period. The content of the packets is not "
+         u"actually scrambled. By default, all packets are clear.");
+
+    option(u"services", 's', INTEGER, 0, 1, 1, 400);
+    help(u"services",
+         u"Number of services in the transport stream. Each service contains "
+         u"one AVC video PID with PCR and one MPEG audio PID. The default is 4.");
+
+    option(u"ts-id", 0, UINT16);
+    help(u"ts-id",
+         u"Transport stream id of the generated transport stream. The default is 1.");
+
+    option(u"video-bitrate", 0, UINT32);
+    help(u"video-bitrate",
+         u"Bitrate of the video PID of each service, in bits/second. "
+         u"The default is 6,000,000 b/s.");
+}
+
+
+//----------------------------------------------------------------------------
+// Command line options method
+//----------------------------------------------------------------------------
+
+bool ts::GenerateInput::getOptions()
+{
+    tsp->useJointTermination(present(u"joint-termination"));
+    _max_count = intValue<PacketCounter>(u"", std::numeric_limits<PacketCounter>::max());
+    _service_count = intValue<size_t>(u"services", 4);
+    _first_service_id = intValue<uint16_t>(u"first-service-id", 1);
+    _first_pid = intValue<PID>(u"first-pid", 0x0100);
+    _ts_id = intValue<uint16_t>(u"ts-id", 1);
+    _network_id = intValue<uint16_t>(u"network-id", 1);
+    _req_bitrate = intValue<BitRate>(u"bitrate", 38000000);
+    _video_bitrate = intValue<BitRate>(u"video-bitrate", 6000000);
+    _audio_bitrate = intValue<BitRate>(u"audio-bitrate", 192000);
+    _scrambling = present(u"scrambling");
+    _crypto_period = intValue<Second>(u"crypto-period", 10);
+    _cc_error_interval = intValue<PacketCounter>(u"cc-error-interval", 0);
+    _pcr_jump_interval = intValue<Second>(u"pcr-jump-interval", 0);
+    _pcr_jump = intValue<MilliSecond>(u"pcr-jump", 1000);
+
+    if (_first_pid < PID_DVB_LAST + 1 || size_t(_first_pid) + 16 * (_service_count - 1) + 2 >= PID_NULL) {
+        tsp->error(u"invalid PID range for %d services starting at PID 0x%X (%d)", {_service_count, _first_pid, _first_pid});
+        return false;
+    }
+    if (size_t(_first_service_id) + _service_count > 0x10000) {
+        tsp->error(u"invalid service id range for %d services starting at %d", {_service_count, _first_service_id});
+        return false;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Start method
+//----------------------------------------------------------------------------
+
+bool ts::GenerateInput::start()
+{
+    if (!buildSources() || !buildSchedule()) {
+        return false;
+    }
+    tsp->verbose(u"generating %d services at %'d b/s, %'d packets per second", {_service_count, _bitrate, _schedule.size()});
+
+    _count = 0;
+    _limit = _max_count;
+    _cycle = 0;
+    _slot = 0;
+    _clock_offset = 0;
+    _cc_error = false;
+    _scrambling_bits = SC_CLEAR;
+    startCycle();
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Input is never blocking.
+//----------------------------------------------------------------------------
+
+bool ts::GenerateInput::setReceiveTimeout(MilliSecond timeout)
+{
+    return true;
+}
+
+bool ts::GenerateInput::abortInput()
+{
+    return true;
+}
+
+ts::BitRate ts::GenerateInput::getBitrate()
+{
+    return _bitrate;
+}
+
+
+//----------------------------------------------------------------------------
+// Build all packet sources.
+//----------------------------------------------------------------------------
+
+bool ts::GenerateInput::buildSources()
+{
+    _sources.clear();
+
+    PAT pat(0, true, _ts_id);
+    SDT sdt(true, 0, true, _ts_id, _network_id);
+    NIT nit(true, 0, true, _network_id);
+    NIT::Transport& nit_ts(nit.transports[TransportStreamId(_ts_id, _network_id)]);
+    ServiceListDescriptor sld;
+    nit.descs.add(duck, NetworkNameDescriptor(u"TSDuck Network"));
+
+    // EIT present/following: one hour events, starting at the beginning of the current hour.
+    const Time start_time(Time::ThisHourUTC());
+    std::vector<EIT> eits;
+
+    // The PMT, video and audio PID's of each service are sources by themselves.
+    std::vector<PMT> pmts;
+    for (size_t i = 0; i < _service_count; ++i) {
+        const uint16_t service_id = uint16_t(_first_service_id + i);
+        const PID pmt_pid = PID(_first_pid + 16 * i);
+        const PID video_pid = pmt_pid + 1;
+        const PID audio_pid = pmt_pid + 2;
+
+        pat.pmts[service_id] = pmt_pid;
+        pmts.push_back(PMT(0, true, service_id, video_pid));
+        pmts.back().streams[video_pid].stream_type = ST_AVC_VIDEO;
+        pmts.back().streams[audio_pid].stream_type = ST_MPEG1_AUDIO;
+
+        SDT::Service& srv(sdt.services[service_id]);
+        srv.EITpf_present = true;
+        srv.running_status = RS_RUNNING;
+        srv.CA_controlled = _scrambling;
+        srv.setName(duck, UString::Format(u"Service %d", {i + 1}));
+        srv.setProvider(duck, u"TSDuck");
+        sld.entries.push_back(ServiceListDescriptor::Entry(service_id, 0x01));
+
+        eits.push_back(EIT(true, true, 0, 0, true, service_id, _ts_id, _network_id));
+        for (size_t ev = 0; ev < 2; ++ev) {
+            EIT::Event& event(eits.back().events.newEntry());
+            event.event_id = uint16_t(ev + 1);
+            event.start_time = start_time + MilliSecond(ev) * MilliSecPerHour;
+            event.duration = MilliSecPerHour / MilliSecPerSec;
+            event.running_status = ev == 0 ? RS_RUNNING : RS_NOT_RUNNING;
+            event.CA_controlled = _scrambling;
+            event.descs.add(duck, ShortEventDescriptor(u"eng", UString::Format(u"Event %d/%d", {i + 1, ev + 1}), u"Synthetic event"));
+        }
+    }
+    nit_ts.descs.add(duck, sld);
+
+    // Standard repetition rates: PAT and PMT's every 100 ms, SDT and EIT p/f every second, NIT every 5 seconds.
+    addPSI(PID_PAT, pat, 10, 1);
+    addPSI(PID_SDT, sdt, 1, 1);
+    addPSI(PID_NIT, nit, 1, 5);
+    addPSI(PID_EIT, eits.front(), 1, 1);
+    for (size_t i = 1; i < eits.size(); ++i) {
+        // All EIT's are on the same PID, in the same source.
+        BinaryTable bin;
+        eits[i].serialize(duck, bin);
+        OneShotPacketizer pzer(PID_EIT, true);
+        pzer.addTable(bin);
+        TSPacketVector packets;
+        pzer.getPackets(packets);
+        _sources.back().packets.insert(_sources.back().packets.end(), packets.begin(), packets.end());
+    }
+    for (size_t i = 0; i < _service_count; ++i) {
+        const PID pmt_pid = PID(_first_pid + 16 * i);
+        addPSI(pmt_pid, pmts[i], 10, 1);
+        addPES(SRC_VIDEO, pmt_pid + 1, _video_bitrate);
+        addPES(SRC_AUDIO, pmt_pid + 2, _audio_bitrate);
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Add a PSI/SI source.
+//----------------------------------------------------------------------------
+
+void ts::GenerateInput::addPSI(PID pid, const AbstractTable& table, size_t repeat, size_t period)
+{
+    _sources.push_back(Source(SRC_PSI));
+    Source& src(_sources.back());
+    src.repeat = repeat;
+    src.period = period;
+
+    // Each section starts in a new packet, the packets can be repeated in any order of tables.
+    OneShotPacketizer pzer(pid, true);
+    pzer.addTable(duck, table);
+    pzer.getPackets(src.packets);
+}
+
+
+//----------------------------------------------------------------------------
+// Add an audio or video source.
+//----------------------------------------------------------------------------
+
+void ts::GenerateInput::addPES(SourceKind kind, PID pid, BitRate bitrate)
+{
+    _sources.push_back(Source(kind));
+    Source& src(_sources.back());
+
+    // Number of packets per second and per PES packet (one frame per PES packet).
+    const MilliSecond frame = kind == SRC_VIDEO ? VIDEO_FRAME_DURATION : AUDIO_FRAME_DURATION;
+    src.slots = std::max<size_t>(1, (size_t(bitrate) + PKT_SIZE_BITS / 2) / PKT_SIZE_BITS);
+    src.pes_size = std::max<size_t>(1, size_t((src.slots * frame + MilliSecPerSec / 2) / MilliSecPerSec));
+    if (kind == SRC_AUDIO) {
+        // Bounded PES packets, the PES_packet_length must fit in 16 bits.
+        src.pes_size = std::min<size_t>(src.pes_size, 0xFFFF / (PKT_SIZE - 4));
+    }
+
+    // Build the templates of the first and next packets of a PES packet.
+    src.packets.resize(2);
+    TSPacket& first(src.packets[0]);
+    TSPacket& next(src.packets[1]);
+    first.init(pid, 0, 0xFF);
+    next.init(pid, 0, 0xFF);
+    first.setPUSI();
+    uint8_t* b = first.b;
+
+    if (kind == SRC_VIDEO) {
+        // Adaptation field with random access indicator and PCR.
+        b[3] = 0x30;
+        b[4] = 7;
+        b[5] = 0x50;
+        // PES header: unbounded video PES packet with PTS and DTS.
+        static const uint8_t header[] = {
+            0x00, 0x00, 0x01, SID_VIDEO, 0x00, 0x00, 0x80, 0xC0, 0x0A,
+            0x31, 0x00, 0x01, 0x00, 0x01,   // PTS
+            0x11, 0x00, 0x01, 0x00, 0x01,   // DTS
+            0x00, 0x00, 0x00, 0x01, 0x09, 0xF0,  // AVC access unit delimiter
+            0x00, 0x00, 0x01, 0x0C,         // AVC filler data NALunit, up to next PES packet
+        };
+        ::memcpy(b + 12, header, sizeof(header));
+    }
+    else {
+        // PES header: bounded audio PES packet with PTS.
+        const uint16_t pes_length = uint16_t(src.pes_size * (PKT_SIZE - 4) - 6);
+        const uint8_t header[] = {
+            0x00, 0x00, 0x01, SID_AUDIO, uint8_t(pes_length >> 8), uint8_t(pes_length), 0x80, 0x80, 0x05,
+            0x21, 0x00, 0x01, 0x00, 0x01,   // PTS
+            0xFF, 0xFD, 0xA4, 0x04,         // MPEG-1 layer II frame header, 192 kb/s, 48 kHz
+        };
+        ::memcpy(b + 4, header, sizeof(header));
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Build the schedule of packets in a cycle of one second.
+//----------------------------------------------------------------------------
+
+bool ts::GenerateInput::buildSchedule()
+{
+    // Compute the total number of packets per second.
+    const size_t cycle_size = (size_t(_req_bitrate) + PKT_SIZE_BITS / 2) / PKT_SIZE_BITS;
+    size_t used = 0;
+    for (auto it = _sources.begin(); it != _sources.end(); ++it) {
+        used += it->slotCount();
+    }
+    if (used > cycle_size) {
+        tsp->error(u"bitrate too low, the services need at least %'d b/s", {used * PKT_SIZE_BITS});
+        return false;
+    }
+    if (_sources.size() >= NO_SOURCE) {
+        tsp->error(u"too many PID's in generated stream");
+        return false;
+    }
+
+    _bitrate = BitRate(cycle_size * PKT_SIZE_BITS);
+    _schedule.assign(cycle_size, NO_SOURCE);
+
+    // Spread the packets of each source evenly over the cycle, shifting the start of each source.
+    for (size_t si = 0; si < _sources.size(); ++si) {
+        const size_t count = _sources[si].slotCount();
+        const size_t shift = (cycle_size / count) * si / _sources.size();
+        for (size_t i = 0; i < count; ++i) {
+            size_t slot = (shift + i * cycle_size / count) % cycle_size;
+            while (_schedule[slot] != NO_SOURCE) {
+                slot = (slot + 1) % cycle_size;
+            }
+            _schedule[slot] = SourceIndex(si);
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Update clocks and scrambling at the beginning of a cycle.
+//----------------------------------------------------------------------------
+
+void ts::GenerateInput::startCycle()
+{
+    if (_pcr_jump_interval > 0 && _cycle > 0 && _cycle % _pcr_jump_interval == 0) {
+        _clock_offset += uint64_t(_pcr_jump) * (SYSTEM_CLOCK_FREQ / MilliSecPerSec);
+    }
+    if (_scrambling) {
+        _scrambling_bits = (_cycle / _crypto_period) % 2 == 0 ? SC_EVEN_KEY : SC_ODD_KEY;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Insert a PTS or DTS value, keeping the 4-bit prefix and the marker bits.
+//----------------------------------------------------------------------------
+
+void ts::GenerateInput::PutPDTS(uint8_t* b, uint64_t value)
+{
+    b[0] = (b[0] & 0xF1) | (uint8_t(value >> 29) & 0x0E);
+    PutUInt16(b + 1, uint16_t(value >> 14) | 0x0001);
+    PutUInt16(b + 3, uint16_t(value << 1) | 0x0001);
+}
+
+
+//----------------------------------------------------------------------------
+// Generate packets from the sources.
+//----------------------------------------------------------------------------
+
+void ts::GenerateInput::generatePSI(Source& src, TSPacket& pkt)
+{
+    if (_cycle % src.period != 0) {
+        pkt = NullPacket;
+    }
+    else {
+        pkt = src.packets[src.next];
+        src.next = (src.next + 1) % src.packets.size();
+        src.cc = (src.cc + 1) & CC_MASK;
+        pkt.setCC(src.cc);
+    }
+}
+
+void ts::GenerateInput::generatePES(Source& src, TSPacket& pkt)
+{
+    if (src.next == 0) {
+        // First packet of a PES packet, set the clocks from the position of the packet in the TS.
+        pkt = src.packets[0];
+        const uint64_t pcr = _cycle * SYSTEM_CLOCK_FREQ + (_slot * SYSTEM_CLOCK_FREQ) / _schedule.size() + _clock_offset;
+        const uint64_t dts = pcr / SYSTEM_CLOCK_SUBFACTOR + DECODING_DELAY * (SYSTEM_CLOCK_SUBFREQ / MilliSecPerSec);
+        if (src.kind == SRC_VIDEO) {
+            PutPCR(pkt.b + VIDEO_PCR_OFFSET, pcr);
+            PutPDTS(pkt.b + VIDEO_PTS_OFFSET, dts + VIDEO_FRAME_DURATION * (SYSTEM_CLOCK_SUBFREQ / MilliSecPerSec));
+            PutPDTS(pkt.b + VIDEO_DTS_OFFSET, dts);
+        }
+        else {
+            PutPDTS(pkt.b + AUDIO_PTS_OFFSET, dts);
+        }
+    }
+    else {
+        pkt = src.packets[1];
+    }
+    src.next = (src.next + 1) % src.pes_size;
+
+    // Continuity counter, with optional injected error.
+    src.cc = (src.cc + (_cc_error ? 2 : 1)) & CC_MASK;
+    _cc_error = false;
+    pkt.b[3] = (pkt.b[3] & 0x30) | uint8_t(_scrambling_bits << 6) | src.cc;
+}
+
+
+//----------------------------------------------------------------------------
+// Input method
+//----------------------------------------------------------------------------
+
+size_t ts::GenerateInput::receive(TSPacket* buffer, TSPacketMetadata* pkt_data, size_t max_packets)
+{
+    // If "joint termination" reached for this plugin
+    if (_count >= _limit && tsp->useJointTermination()) {
+        // Declare terminated
+        tsp->jointTerminate();
+        // Continue generating packets until completion of tsp (suppress max packet count)
+        _limit = std::numeric_limits<PacketCounter>::max();
+    }
+
+    size_t n = 0;
+    for (; n < max_packets && _count < _limit; ++n) {
+
+        const SourceIndex si = _schedule[_slot];
+        if (si == NO_SOURCE) {
+            buffer[n] = NullPacket;
+        }
+        else if (_sources[si].kind == SRC_PSI) {
+            generatePSI(_sources[si], buffer[n]);
+        }
+        else {
+            generatePES(_sources[si], buffer[n]);
+        }
+
+        // Schedule the next continuity error.
+        ++_count;
+        if (_cc_error_interval > 0 && _count % _cc_error_interval == 0) {
+            _cc_error = true;
+        }
+
+        // Move to next slot in the cycle.
+        if (++_slot >= _schedule.size()) {
+            _slot = 0;
+            _cycle++;
+            startCycle();
+        }
+    }
+    return n;
+}
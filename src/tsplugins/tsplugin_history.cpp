@@ -42,6 +42,7 @@
 #include "tsPMT.h"
 #include "tsTOT.h"
 #include "tsTDT.h"
+#include "tsPacketTraceWriter.h"
 TSDUCK_SOURCE;
 
 
@@ -68,6 +69,7 @@ namespace ts {
             PacketCounter     pkt_count;    // Number of packets on this PID
             PacketCounter     first_pkt;    // First packet in TS
             PacketCounter     last_pkt;     // Last packet in TS
+            MilliSecond       last_time;    // Stream time of last packet (with --stream-time)
             uint16_t          service_id;   // One service the PID belongs to
             uint8_t           scrambling;   // Last scrambling control value
             TID               last_tid;     // Last table on this PID
@@ -76,15 +78,19 @@ namespace ts {
 
         // Private members
         std::ofstream _outfile;           // User-specified output file
+        PacketTraceWriter _trace;         // Binary packet trace file
         PacketCounter _current_pkt;       // Current TS packet number
+        MilliSecond   _current_time;      // Stream time of current TS packet (with --stream-time)
         bool          _report_eit;        // Report EIT
         bool          _report_cas;        // Report CAS events
         bool          _time_all;          // Report all TDT/TOT
         bool          _ignore_stream_id;  // Ignore stream_id modifications
         bool          _use_milliseconds;  // Report playback time instead of packet number.
+        bool          _use_stream_time;   // Playback time is the stream time from tsp.
         PacketCounter _suspend_after;     // Number of missing packets after which a PID is considered as suspended
         TDT           _last_tdt;          // Last received TDT
         PacketCounter _last_tdt_pkt;      // Packet# of last TDT
+        MilliSecond   _last_tdt_time;     // Stream time of last TDT
         bool          _last_tdt_reported; // Last TDT already reported
         SectionDemux  _demux;             // Section filter
         PIDContext    _cpids[PID_MAX];    // Description of each PID
@@ -95,9 +101,15 @@ namespace ts {
         // Analyze a list of descriptors, looking for ECM PID's
         void analyzeCADescriptors(const DescriptorList& dlist, uint16_t service_id);
 
-        // Report a history line
-        void report(const UChar* fmt, const std::initializer_list<ArgMixIn> args);
-        void report(PacketCounter, const UChar* fmt, const std::initializer_list<ArgMixIn> args);
+        // Report a history line. The event, value and extra are used in the binary packet trace file.
+        void report(PID pid, uint8_t event, uint64_t value, uint64_t extra, const UChar* fmt, const std::initializer_list<ArgMixIn> args);
+        void report(PacketCounter, MilliSecond, PID pid, uint8_t event, uint64_t value, uint64_t extra, const UChar* fmt, const std::initializer_list<ArgMixIn> args);
+
+        // Report a table in binary packet trace file.
+        void reportTable(const BinaryTable&, const UChar* fmt, const std::initializer_list<ArgMixIn> args);
+
+        // Report a UTC time from TDT or TOT.
+        void reportTime(PacketCounter, MilliSecond, TID tid, const Time& utc, const UChar* fmt);
     };
 }
 
@@ -112,15 +124,19 @@ TSPLUGIN_DECLARE_PROCESSOR(history, ts::HistoryPlugin)
 ts::HistoryPlugin::HistoryPlugin(TSP* tsp_) :
     ProcessorPlugin(tsp_, u"Report a history of major events on the transport stream", u"[options]"),
     _outfile(),
+    _trace(),
     _current_pkt(0),
+    _current_time(0),
     _report_eit(false),
     _report_cas(false),
     _time_all(false),
     _ignore_stream_id(false),
     _use_milliseconds(false),
+    _use_stream_time(false),
     _suspend_after(0),
     _last_tdt(Time::Epoch),
     _last_tdt_pkt(0),
+    _last_tdt_time(0),
     _last_tdt_reported(false),
     _demux(duck, this),
     _cpids()
@@ -141,7 +157,8 @@ ts::HistoryPlugin::HistoryPlugin(TSP* tsp_) :
     help(u"milli-seconds",
          u"For each message, report time in milli-seconds from the beginning of the "
          u"stream instead of the TS packet number. This time is a playback time based "
-         u"on the current TS bitrate (use plugin pcrbitrate when necessary).");
+         u"on the current TS bitrate (use plugin pcrbitrate when necessary). With the "
+         u"tsp option --stream-time, this is the stream time, as derived from the PCR's.");
 
     option(u"output-file", 'o', STRING);
     help(u"output-file", u"filename",
@@ -163,6 +180,13 @@ ts::HistoryPlugin::HistoryPlugin(TSP* tsp_) :
 
     option(u"time-all", 't');
     help(u"time-all", u"Report all TDT and TOT. By default, only report TDT preceeding another event.");
+
+    option(u"trace-file", 0, STRING);
+    help(u"trace-file", u"filename",
+         u"Also write all events in a binary packet trace file. "
+         u"This is a compact columnar file format which is designed for offline analysis "
+         u"of very large captures. Each row contains the packet index in the TS, the PID, "
+         u"the type of event and its associated values (see the TSDuck class PacketTraceRecord).");
 }
 
 
@@ -174,6 +198,7 @@ ts::HistoryPlugin::PIDContext::PIDContext() :
     pkt_count(0),
     first_pkt(0),
     last_pkt(0),
+    last_time(0),
     service_id(0),
     scrambling(0),
     last_tid(0),
@@ -207,13 +232,25 @@ bool ts::HistoryPlugin::start()
         }
     }
 
+    // Create binary packet trace file.
+    if (present(u"trace-file") && !_trace.open(value(u"trace-file"), *tsp)) {
+        if (_outfile.is_open()) {
+            _outfile.close();
+        }
+        return false;
+    }
+
     // Reinitialize state
     _current_pkt = 0;
+    _current_time = 0;
+    _use_stream_time = tsp->useStreamTime();
     _last_tdt_pkt = 0;
+    _last_tdt_time = 0;
     _last_tdt_reported = false;
     _last_tdt.invalidate();
     for (PIDContext* p = _cpids; p < _cpids + PID_MAX; ++p) {
         p->pkt_count = p->first_pkt = p->last_pkt = 0;
+        p->last_time = 0;
         p->service_id = 0;
         p->scrambling = 0;
         p->last_tid = TID_NULL;
@@ -246,7 +283,8 @@ bool ts::HistoryPlugin::stop()
     // Report last packet of each PID
     for (PIDContext* p = _cpids; p < _cpids + PID_MAX; ++p) {
         if (p->pkt_count > 0) {
-            report(p->last_pkt, u"PID %d (0x%04X) last packet, %s", {p - _cpids, p - _cpids, p->scrambling ? u"scrambled" : u"clear"});
+            const PID pid = PID(p - _cpids);
+            report(p->last_pkt, p->last_time, pid, PacketTraceRecord::PID_LAST, p->scrambling, p->service_id, u"PID %d (0x%04X) last packet, %s", {pid, pid, p->scrambling ? u"scrambled" : u"clear"});
         }
     }
 
@@ -254,6 +292,9 @@ bool ts::HistoryPlugin::stop()
     if (_outfile.is_open()) {
         _outfile.close();
     }
+    if (_trace.isOpen()) {
+        _trace.close(*tsp);
+    }
 
     return true;
 }
@@ -272,7 +313,7 @@ void ts::HistoryPlugin::handleTable(SectionDemux& demux, const BinaryTable& tabl
 
         case TID_PAT: {
             if (table.sourcePID() == PID_PAT) {
-                report(u"PAT v%d, TS 0x%X", {table.version(), table.tableIdExtension()});
+                reportTable(table, u"PAT v%d, TS 0x%X", {table.version(), table.tableIdExtension()});
                 PAT pat(duck, table);
                 if (pat.isValid()) {
                     // Filter all PMT PIDs
@@ -291,10 +332,11 @@ void ts::HistoryPlugin::handleTable(SectionDemux& demux, const BinaryTable& tabl
                 // Save last TDT in context
                 _last_tdt.deserialize(duck, table);
                 _last_tdt_pkt = _current_pkt;
+                _last_tdt_time = _current_time;
                 _last_tdt_reported = false;
                 // Report TDT only if --time-all
                 if (_time_all && _last_tdt.isValid()) {
-                    report(u"TDT: %s UTC", {_last_tdt.utc_time.format(Time::DATE | Time::TIME)});
+                    reportTime(_current_pkt, _current_time, TID_TDT, _last_tdt.utc_time, u"TDT: %s UTC");
                 }
             }
             break;
@@ -306,10 +348,11 @@ void ts::HistoryPlugin::handleTable(SectionDemux& demux, const BinaryTable& tabl
                     TOT tot(duck, table);
                     if (tot.isValid()) {
                         if (tot.regions.empty()) {
-                            report(u"TOT: %s UTC", {tot.utc_time.format(Time::DATE | Time::TIME)});
+                            reportTime(_current_pkt, _current_time, TID_TOT, tot.utc_time, u"TOT: %s UTC");
                         }
                         else {
-                            report(u"TOT: %s LOCAL", {tot.localTime(tot.regions[0]).format(Time::DATE | Time::TIME)});
+                            const Time local(tot.localTime(tot.regions[0]));
+                            report(pid, PacketTraceRecord::UTC_TIME, uint64_t(tot.utc_time - Time::UnixEpoch), TID_TOT, u"TOT: %s LOCAL", {local.format(Time::DATE | Time::TIME)});
                         }
                     }
                 }
@@ -318,7 +361,7 @@ void ts::HistoryPlugin::handleTable(SectionDemux& demux, const BinaryTable& tabl
         }
 
         case TID_PMT: {
-            report(u"PMT v%d, service 0x%X", {table.version(), table.tableIdExtension()});
+            reportTable(table, u"PMT v%d, service 0x%X", {table.version(), table.tableIdExtension()});
             PMT pmt(duck, table);
             if (pmt.isValid()) {
                 // Get components of the service, including ECM PID's
@@ -335,7 +378,7 @@ void ts::HistoryPlugin::handleTable(SectionDemux& demux, const BinaryTable& tabl
         case TID_NIT_ACT:
         case TID_NIT_OTH: {
             if (table.sourcePID() == PID_NIT) {
-                report(u"%s v%d, network 0x%X", {names::TID(table.tableId()), table.version(), table.tableIdExtension()});
+                reportTable(table, u"%s v%d, network 0x%X", {names::TID(table.tableId()), table.version(), table.tableIdExtension()});
             }
             break;
         }
@@ -343,14 +386,14 @@ void ts::HistoryPlugin::handleTable(SectionDemux& demux, const BinaryTable& tabl
         case TID_SDT_ACT:
         case TID_SDT_OTH: {
             if (table.sourcePID() == PID_SDT) {
-                report(u"%s v%d, TS 0x%X", {names::TID(table.tableId()), table.version(), table.tableIdExtension()});
+                reportTable(table, u"%s v%d, TS 0x%X", {names::TID(table.tableId()), table.version(), table.tableIdExtension()});
             }
             break;
         }
 
         case TID_BAT: {
             if (table.sourcePID() == PID_BAT) {
-                report(u"BAT v%d, bouquet 0x%X", {table.version(), table.tableIdExtension()});
+                reportTable(table, u"BAT v%d, bouquet 0x%X", {table.version(), table.tableIdExtension()});
             }
             break;
         }
@@ -358,7 +401,7 @@ void ts::HistoryPlugin::handleTable(SectionDemux& demux, const BinaryTable& tabl
         case TID_CAT:
         case TID_TSDT: {
             // Long sections without TID extension
-            report(u"%s v%d", {names::TID(table.tableId()), table.version()});
+            reportTable(table, u"%s v%d", {names::TID(table.tableId()), table.version()});
             break;
         }
 
@@ -367,7 +410,7 @@ void ts::HistoryPlugin::handleTable(SectionDemux& demux, const BinaryTable& tabl
             // Got an ECM
             if (_report_cas && _cpids[pid].last_tid != table.tableId()) {
                 // Got a new ECM
-                report(u"PID %d (0x%X), service 0x%X, new ECM 0x%X", {pid, pid, _cpids[pid].service_id, table.tableId()});
+                report(pid, PacketTraceRecord::ECM, table.tableId(), _cpids[pid].service_id, u"PID %d (0x%X), service 0x%X, new ECM 0x%X", {pid, pid, _cpids[pid].service_id, table.tableId()});
             }
             break;
         }
@@ -375,13 +418,13 @@ void ts::HistoryPlugin::handleTable(SectionDemux& demux, const BinaryTable& tabl
         default: {
             const UString name(names::TID(table.tableId()));
             if (table.tableId() >= TID_EIT_MIN && table.tableId() <= TID_EIT_MAX) {
-                report(u"%s v%d, service 0x%X", {name, table.version(), table.tableIdExtension()});
+                reportTable(table, u"%s v%d, service 0x%X", {name, table.version(), table.tableIdExtension()});
             }
             else if (table.sectionCount() > 0 && table.sectionAt(0)->isLongSection()) {
-                report(u"%s v%d, TIDext 0x%X", {name, table.version(), table.tableIdExtension()});
+                reportTable(table, u"%s v%d, TIDext 0x%X", {name, table.version(), table.tableIdExtension()});
             }
             else {
-                report(u"%s", {name});
+                reportTable(table, u"%s", {name});
             }
             break;
         }
@@ -455,6 +498,11 @@ ts::ProcessorPlugin::Status ts::HistoryPlugin::processPacket(TSPacket& pkt, TSPa
         }
     }
 
+    // Stream time of the current packet, when provided by tsp.
+    if (_use_stream_time) {
+        _current_time = pkt_data.getInputTimeStampMS();
+    }
+
     // Record information about current PID
     const PID pid = pkt.getPID();
     PIDContext* const cpid = _cpids + pid;
@@ -471,34 +519,34 @@ ts::ProcessorPlugin::Status ts::HistoryPlugin::processPacket(TSPacket& pkt, TSPa
     if (cpid->pkt_count == 0) {
         // First packet in a PID
         cpid->first_pkt = _current_pkt;
-        report(u"PID %d (0x%X) first packet, %s", {pid, pid, scrambling ? u"scrambled" : u"clear"});
+        report(pid, PacketTraceRecord::PID_FIRST, scrambling, cpid->service_id, u"PID %d (0x%X) first packet, %s", {pid, pid, scrambling ? u"scrambled" : u"clear"});
     }
     else if (cpid->last_pkt + _suspend_after < _current_pkt) {
         // Last packet in the PID is so old that we consider the PID as suspended, and now restarted
-        report(cpid->last_pkt, u"PID %d (0x%X) suspended, %s, service 0x%X", {pid, pid, cpid->scrambling ? u"scrambled" : u"clear", _cpids[pid].service_id});
-        report(u"PID %d (0x%X) restarted, %s, service 0x%04X", {pid, pid, scrambling ? u"scrambled" : u"clear", _cpids[pid].service_id});
+        report(cpid->last_pkt, cpid->last_time, pid, PacketTraceRecord::PID_SUSPENDED, cpid->scrambling, cpid->service_id, u"PID %d (0x%X) suspended, %s, service 0x%X", {pid, pid, cpid->scrambling ? u"scrambled" : u"clear", _cpids[pid].service_id});
+        report(pid, PacketTraceRecord::PID_RESTARTED, scrambling, cpid->service_id, u"PID %d (0x%X) restarted, %s, service 0x%04X", {pid, pid, scrambling ? u"scrambled" : u"clear", _cpids[pid].service_id});
     }
     else if (!ignore_scrambling && cpid->scrambling == 0 && scrambling != 0) {
         // Clear to scrambled transition
-        report(u"PID %d (0x%X), clear to scrambled transition, %s key, service 0x%X", {pid, pid, names::ScramblingControl(scrambling), _cpids[pid].service_id});
+        report(pid, PacketTraceRecord::PID_SCRAMBLED, scrambling, cpid->service_id, u"PID %d (0x%X), clear to scrambled transition, %s key, service 0x%X", {pid, pid, names::ScramblingControl(scrambling), _cpids[pid].service_id});
     }
     else if (!ignore_scrambling && cpid->scrambling != 0 && scrambling == 0) {
         // Scrambled to clear transition
-        report(u"PID %d (0x%X), scrambled to clear transition, service 0x%X", {pid, pid, _cpids[pid].service_id});
+        report(pid, PacketTraceRecord::PID_CLEAR, scrambling, cpid->service_id, u"PID %d (0x%X), scrambled to clear transition, service 0x%X", {pid, pid, _cpids[pid].service_id});
     }
     else if (!ignore_scrambling && _report_cas && cpid->scrambling != scrambling) {
         // New crypto-period
-        report(u"PID %d (0x%X), new crypto-period, %s key, service 0x%X", {pid, pid, names::ScramblingControl(scrambling), _cpids[pid].service_id});
+        report(pid, PacketTraceRecord::CRYPTO_PERIOD, scrambling, cpid->service_id, u"PID %d (0x%X), new crypto-period, %s key, service 0x%X", {pid, pid, names::ScramblingControl(scrambling), _cpids[pid].service_id});
     }
 
     if (has_pes_start) {
         if (!cpid->pes_strid.set()) {
             // Found first PES stream id in the PID.
-            report(u"PID %d (0x%X), PES stream_id is %s", {pid, pid, names::StreamId(pes_stream_id, names::FIRST)});
+            report(pid, PacketTraceRecord::PES_STREAM_ID, pes_stream_id, cpid->service_id, u"PID %d (0x%X), PES stream_id is %s", {pid, pid, names::StreamId(pes_stream_id, names::FIRST)});
         }
         else if (cpid->pes_strid != pes_stream_id && !_ignore_stream_id) {
             // PES stream id has changed in the PID.
-            report(u"PID %d (0x%X), PES stream_id modified from 0x%X to %s", {pid, pid, cpid->pes_strid.value(), names::StreamId(pes_stream_id, names::FIRST)});
+            report(pid, PacketTraceRecord::PES_STREAM_ID, pes_stream_id, cpid->service_id, u"PID %d (0x%X), PES stream_id modified from 0x%X to %s", {pid, pid, cpid->pes_strid.value(), names::StreamId(pes_stream_id, names::FIRST)});
         }
         cpid->pes_strid = pes_stream_id;
     }
@@ -508,6 +556,7 @@ ts::ProcessorPlugin::Status ts::HistoryPlugin::processPacket(TSPacket& pkt, TSPa
     }
 
     cpid->last_pkt = _current_pkt;
+    cpid->last_time = _current_time;
     cpid->pkt_count++;
 
     // Filter interesting sections
@@ -523,22 +572,47 @@ ts::ProcessorPlugin::Status ts::HistoryPlugin::processPacket(TSPacket& pkt, TSPa
 // Report a history line
 //----------------------------------------------------------------------------
 
-void ts::HistoryPlugin::report(const UChar* fmt, const std::initializer_list<ArgMixIn> args)
+void ts::HistoryPlugin::report(PID pid, uint8_t event, uint64_t value, uint64_t extra, const UChar* fmt, const std::initializer_list<ArgMixIn> args)
 {
-    report(_current_pkt, fmt, args);
+    report(_current_pkt, _current_time, pid, event, value, extra, fmt, args);
 }
 
-void ts::HistoryPlugin::report(PacketCounter pkt, const UChar* fmt, const std::initializer_list<ArgMixIn> args)
+void ts::HistoryPlugin::reportTable(const BinaryTable& table, const UChar* fmt, const std::initializer_list<ArgMixIn> args)
+{
+    const bool is_long = table.sectionCount() > 0 && table.sectionAt(0)->isLongSection();
+    const uint64_t extra = is_long ? (uint64_t(table.version()) << 16) | table.tableIdExtension() : 0;
+    report(_current_pkt, _current_time, table.sourcePID(), PacketTraceRecord::TABLE, table.tableId(), extra, fmt, args);
+}
+
+void ts::HistoryPlugin::reportTime(PacketCounter pkt, MilliSecond time, TID tid, const Time& utc, const UChar* fmt)
+{
+    const PID pid = tid == TID_TDT ? PID_TDT : PID_TOT;
+    report(pkt, time, pid, PacketTraceRecord::UTC_TIME, uint64_t(utc - Time::UnixEpoch), tid, fmt, {utc.format(Time::DATE | Time::TIME)});
+}
+
+void ts::HistoryPlugin::report(PacketCounter pkt, MilliSecond time, PID pid, uint8_t event, uint64_t value, uint64_t extra, const UChar* fmt, const std::initializer_list<ArgMixIn> args)
 {
     // Reports the last TDT if required
     if (!_time_all && _last_tdt.isValid() && !_last_tdt_reported) {
         _last_tdt_reported = true;
-        report(_last_tdt_pkt, u"TDT: %s UTC", {_last_tdt.utc_time.format(Time::DATE | Time::TIME)});
+        reportTime(_last_tdt_pkt, _last_tdt_time, TID_TDT, _last_tdt.utc_time, u"TDT: %s UTC");
+    }
+
+    // Record the event in the binary trace file, always using packet index.
+    if (_trace.isOpen()) {
+        PacketTraceRecord rec;
+        rec.packet = pkt;
+        rec.pid = pid;
+        rec.event = event;
+        rec.value = value;
+        rec.extra = extra;
+        _trace.write(rec, *tsp);
     }
 
     // Convert pkt number in playback time when necessary.
+    // With --stream-time in tsp, use the stream time instead of the current bitrate.
     if (_use_milliseconds) {
-        pkt = PacketInterval(tsp->bitrate(), pkt);
+        pkt = _use_stream_time ? PacketCounter(time) : PacketInterval(tsp->bitrate(), pkt);
     }
 
     // Then report the message.
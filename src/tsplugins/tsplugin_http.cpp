@@ -28,7 +28,7 @@
 //----------------------------------------------------------------------------
 //
 //  Transport stream processor shared library:
-//  HTTP stream input
+//  HTTP stream input and output
 //
 //----------------------------------------------------------------------------
 
@@ -36,6 +36,7 @@
 #include "tsPluginRepository.h"
 #include "tsWebRequest.h"
 #include "tsWebRequestArgs.h"
+#include "tsHTTPStreamServer.h"
 #include "tsSysUtils.h"
 TSDUCK_SOURCE;
 
@@ -64,14 +65,32 @@ namespace ts {
         UString        _url;
         WebRequestArgs _web_args;
     };
+
+    class HttpOutput: public OutputPlugin
+    {
+        TS_NOBUILD_NOCOPY(HttpOutput);
+    public:
+        // Implementation of plugin API
+        HttpOutput(TSP*);
+        virtual bool getOptions() override;
+        virtual bool start() override;
+        virtual bool stop() override;
+        virtual bool isRealTime() override {return true;}
+        virtual bool send(const TSPacket*, const TSPacketMetadata*, size_t) override;
+
+    private:
+        HTTPStreamServer::Args _server_args;
+        HTTPStreamServer       _server;
+    };
 }
 
 TSPLUGIN_DECLARE_VERSION
 TSPLUGIN_DECLARE_INPUT(http, ts::HttpInput)
+TSPLUGIN_DECLARE_OUTPUT(http, ts::HttpOutput)
 
 
 //----------------------------------------------------------------------------
-// Constructor
+// Input constructor
 //----------------------------------------------------------------------------
 
 ts::HttpInput::HttpInput(TSP* tsp_) :
@@ -118,7 +137,7 @@ ts::HttpInput::HttpInput(TSP* tsp_) :
 
 
 //----------------------------------------------------------------------------
-// Command line options method
+// Input command line options method
 //----------------------------------------------------------------------------
 
 bool ts::HttpInput::getOptions()
@@ -174,3 +193,118 @@ void ts::HttpInput::processInput()
         ok = request.downloadToApplication(this);
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Output constructor
+//----------------------------------------------------------------------------
+
+ts::HttpOutput::HttpOutput(TSP* tsp_) :
+    OutputPlugin(tsp_, u"Serve the transport stream to HTTP clients, live TS or HLS", u"[options] [address:]port"),
+    _server_args(),
+    _server()
+{
+    option(u"", 0, STRING, 1, 1);
+    help(u"", u"[address:]port",
+         u"Local TCP port of the HTTP server. "
+         u"When present, the optional address shall specify a local IP address or host name. "
+         u"By default, the server listens on all local interfaces. "
+         u"The live transport stream is served on URL paths / and /stream.ts.");
+
+    option(u"buffer-packets", 0, POSITIVE);
+    help(u"buffer-packets",
+         u"Size in TS packets of the ring buffer which is shared by all clients. "
+         u"The default is " + UString::Decimal(HTTPStreamServer::DEFAULT_BUFFER_PACKETS) + u" packets.");
+
+    option(u"duration", 'd', POSITIVE);
+    help(u"duration",
+         u"With --hls, specify the target duration in seconds of the media segments. "
+         u"The default is " + UString::Decimal(HTTPStreamServer::DEFAULT_HLS_DURATION) + u" seconds.");
+
+    option(u"hls");
+    help(u"hls",
+         u"Also serve the transport stream using HLS. The media segments are kept in memory. "
+         u"The playlist is served on URL path /stream.m3u8.");
+
+    option(u"live", 'l', POSITIVE);
+    help(u"live",
+         u"With --hls, specify the number of media segments in the playlist. "
+         u"The default is " + UString::Decimal(HTTPStreamServer::DEFAULT_HLS_LIVE) + u".");
+
+    option(u"max-clients", 0, POSITIVE);
+    help(u"max-clients",
+         u"Maximum number of simultaneous HTTP clients. "
+         u"The default is " + UString::Decimal(HTTPStreamServer::DEFAULT_MAX_CLIENTS) + u".");
+
+    option(u"max-lag", 0, POSITIVE);
+    help(u"max-lag",
+         u"Maximum number of TS packets a live client may lag behind the live point. "
+         u"A slower client is disconnected, unless --wait-clients is specified. By default, "
+         u"a client is disconnected when it lags behind by the size of the ring buffer.");
+
+    option(u"send-buffer-size", 0, POSITIVE);
+    help(u"send-buffer-size",
+         u"Socket send buffer size in bytes for each client. The default is system-dependent.");
+
+    option(u"wait-clients", 'w');
+    help(u"wait-clients",
+         u"Slow down the transport stream processing to the speed of the slowest client "
+         u"instead of disconnecting the clients which lag behind. "
+         u"By default, the output is meant for live streams and never slows down the "
+         u"processing. With an offline input such as a file, which is read faster than "
+         u"real time, use this option to let the clients receive the complete stream.");
+}
+
+
+//----------------------------------------------------------------------------
+// Output command line options method
+//----------------------------------------------------------------------------
+
+bool ts::HttpOutput::getOptions()
+{
+    // Get server address. The only mandatory part is the TCP port.
+    if (!_server_args.local_address.resolve(value(u""), *tsp)) {
+        return false;
+    }
+    if (!_server_args.local_address.hasPort()) {
+        tsp->error(u"no TCP server port specified");
+        return false;
+    }
+
+    _server_args.buffer_packets = intValue<size_t>(u"buffer-packets", HTTPStreamServer::DEFAULT_BUFFER_PACKETS);
+    _server_args.max_clients = intValue<size_t>(u"max-clients", HTTPStreamServer::DEFAULT_MAX_CLIENTS);
+    _server_args.max_lag = intValue<size_t>(u"max-lag", 0);
+    _server_args.send_buffer_size = intValue<size_t>(u"send-buffer-size", 0);
+    _server_args.wait_clients = present(u"wait-clients");
+    _server_args.hls = present(u"hls");
+    _server_args.hls_duration = intValue<Second>(u"duration", HTTPStreamServer::DEFAULT_HLS_DURATION);
+    _server_args.hls_live = intValue<size_t>(u"live", HTTPStreamServer::DEFAULT_HLS_LIVE);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Output start / stop methods
+//----------------------------------------------------------------------------
+
+bool ts::HttpOutput::start()
+{
+    return _server.open(_server_args, *tsp);
+}
+
+bool ts::HttpOutput::stop()
+{
+    _server.close();
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Output method
+//----------------------------------------------------------------------------
+
+bool ts::HttpOutput::send(const TSPacket* buffer, const TSPacketMetadata*, size_t packet_count)
+{
+    _server.addPackets(buffer, packet_count, tsp->bitrate());
+    return true;
+}
@@ -78,6 +78,11 @@ namespace ts {
         BitRate               _files_bitrate;     // Bitrate from the repetition rates in files
         PacketCounter         _pid_inter_pkt;     // # TS packets between 2 new PID packets
         PacketCounter         _pid_next_pkt;      // Next time to insert a packet
+        bool                  _use_stream_time;   // Use the stream time from tsp instead of the TS bitrate
+        uint64_t              _stream_time;       // Stream time of current packet (PCR units)
+        uint64_t              _pid_inter_time;    // Stream time between 2 new PID packets (PCR units)
+        uint64_t              _pid_next_time;     // Next stream time to insert a packet (PCR units)
+        uint64_t              _eval_start_time;   // Stream time of the start of PID bitrate evaluation
         PacketCounter         _packet_count;      // TS packet counter
         PacketCounter         _pid_packet_count;  // Packet counter in -PID to replace
         PacketCounter         _eval_interval;     // PID bitrate re-evaluation interval
@@ -124,6 +129,11 @@ ts::InjectPlugin::InjectPlugin (TSP* tsp_) :
     _files_bitrate(0),
     _pid_inter_pkt(0),
     _pid_next_pkt(0),
+    _use_stream_time(false),
+    _stream_time(0),
+    _pid_inter_time(0),
+    _pid_next_time(0),
+    _eval_start_time(0),
     _packet_count(0),
     _pid_packet_count(0),
     _eval_interval(0),
@@ -144,7 +154,11 @@ ts::InjectPlugin::InjectPlugin (TSP* tsp_) :
     help(u"binary", u"Specify that all input files are binary, regardless of their file name.");
 
     option(u"bitrate", 'b', UINT32);
-    help(u"bitrate", u"Specifies the bitrate for the new PID, in bits/second.");
+    help(u"bitrate",
+         u"Specifies the bitrate for the new PID, in bits/second. "
+         u"With the tsp option --stream-time, the packets of the new PID are inserted "
+         u"at regular intervals of stream time, as derived from the PCR's, and the "
+         u"bitrate of the transport stream is not used.");
 
     option(u"evaluate-interval", 'e', POSITIVE);
     help(u"evaluate-interval",
@@ -307,6 +321,11 @@ bool ts::InjectPlugin::start()
     _packet_count = 0;
     _pid_packet_count = 0;
     _pid_next_pkt = 0;
+    _use_stream_time = tsp->useStreamTime();
+    _stream_time = 0;
+    _pid_inter_time = 0;
+    _pid_next_time = 0;
+    _eval_start_time = 0;
     _cycle_count = 0;
     return true;
 }
@@ -385,7 +404,12 @@ bool ts::InjectPlugin::processBitRates()
         _pid_bitrate = _files_bitrate;
     }
 
-    if (_pid_bitrate != 0) {
+    if (_pid_bitrate != 0 && _use_stream_time) {
+        // Non-replace mode with stream time, the packets are inserted at fixed stream time intervals.
+        _pid_inter_time = (PKT_SIZE * 8 * SYSTEM_CLOCK_FREQ) / _pid_bitrate;
+        tsp->verbose(u"new PID bitrate: %'d b/s, packet interval: %'d us in stream time", {_pid_bitrate, _pid_inter_time / (SYSTEM_CLOCK_FREQ / MicroSecPerSec)});
+    }
+    else if (_pid_bitrate != 0) {
         // Non-replace mode, we need to know the inter-packet interval.
         // Compute it based on the TS bitrate.
         const BitRate ts_bitrate = tsp->bitrate();
@@ -437,6 +461,11 @@ ts::ProcessorPlugin::Status ts::InjectPlugin::processPacket(TSPacket& pkt, TSPac
 {
     const PID pid = pkt.getPID();
 
+    // Stream time of the current packet, when provided by tsp.
+    if (_use_stream_time && pkt_data.hasInputTimeStamp()) {
+        _stream_time = pkt_data.getInputTimeStamp();
+    }
+
     // Initialization sequences (executed only once):
     // Must be done as soon as possible since it was not possible to do in start().
     if (_packet_count == 0 && !processBitRates()) {
@@ -448,9 +477,18 @@ ts::ProcessorPlugin::Status ts::InjectPlugin::processPacket(TSPacket& pkt, TSPac
     if (pid == _inject_pid) {
         _pid_packet_count++;
     }
+    // With stream time, the PID bitrate is directly measured in stream time.
     if (_replace && _specific_rates && _pid_packet_count == _eval_interval && _packet_count > 0) {
         const BitRate ts_bitrate = tsp->bitrate();
-        _pid_bitrate = BitRate((PacketCounter(ts_bitrate) * _pid_packet_count) / _packet_count);
+        if (!_use_stream_time) {
+            _pid_bitrate = BitRate((PacketCounter(ts_bitrate) * _pid_packet_count) / _packet_count);
+        }
+        else if (_stream_time > _eval_start_time) {
+            _pid_bitrate = BitRate((_pid_packet_count * PKT_SIZE * 8 * SYSTEM_CLOCK_FREQ) / (_stream_time - _eval_start_time));
+        }
+        else {
+            _pid_bitrate = 0;
+        }
         if (_pid_bitrate == 0) {
             tsp->warning(u"input bitrate unknown or too low, section-specific repetition rates will be ignored");
         }
@@ -460,6 +498,7 @@ ts::ProcessorPlugin::Status ts::InjectPlugin::processPacket(TSPacket& pkt, TSPac
         }
         _pid_packet_count = 0;
         _packet_count = 0;
+        _eval_start_time = _stream_time;
     }
 
     // Poll files when necessary.
@@ -512,9 +551,18 @@ ts::ProcessorPlugin::Status ts::InjectPlugin::processPacket(TSPacket& pkt, TSPac
     }
 
     // In non-replace mode (new PID insertion), replace stuffing packets when needed.
-    if (!_replace && !_completed && pid == PID_NULL && _packet_count >= _pid_next_pkt) {
-        replacePacket(pkt);
-        _pid_next_pkt += _pid_inter_pkt;
+    // With stream time and a PID bitrate, the insertion points are in stream time.
+    if (!_replace && !_completed && pid == PID_NULL) {
+        if (_pid_inter_time > 0) {
+            if (_stream_time >= _pid_next_time) {
+                replacePacket(pkt);
+                _pid_next_time += _pid_inter_time;
+            }
+        }
+        else if (_packet_count >= _pid_next_pkt) {
+            replacePacket(pkt);
+            _pid_next_pkt += _pid_inter_pkt;
+        }
     }
 
     return TSP_OK;
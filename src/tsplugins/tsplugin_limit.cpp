@@ -244,7 +244,8 @@ bool ts::LimitPlugin::start()
     _curBitrate = 0;
     _pidContexts.clear();
     _demux.reset();
-    _demux.setPIDFilter(PID_PAT);
+    _demux.setPIDFilter(NoPID);
+    _demux.addPID(PID_PAT);
 
     return true;
 }
@@ -41,6 +41,7 @@
 #include "tsRegistrationDescriptor.h"
 #include "tsSCTE35.h"
 #include "tsNames.h"
+#include "tsPacketTraceWriter.h"
 TSDUCK_SOURCE;
 
 #define DEFAULT_SEPARATOR u";"
@@ -85,14 +86,21 @@ namespace ts {
         bool             _get_dts;        // Get DTS
         bool             _csv_format;     // Output in CSV format
         bool             _log_format;     // Output in log format
+        bool             _trace_format;   // Output in binary packet trace file
         bool             _evaluate_pcr;   // Evaluate PCR offset for packets with PTS/DTS without PCR
         bool             _scte35;         // Detect SCTE 35 PTS values
         UString          _output_name;    // Output file name (empty means stderr)
         std::ofstream    _output_stream;  // Output stream file
         std::ostream*    _output;         // Reference to actual output stream file
+        UString          _trace_name;     // Binary packet trace file name
+        PacketTraceWriter _trace;         // Binary packet trace file
         PIDContextMap    _stats;          // Per-PID statistics
         SpliceContextMap _splices;        // Per-PID splice information
         SectionDemux     _demux;          // Section demux for service and SCTE 35 analysis
+        PacketCounter    _sampled_count;  // Number of values not reported in sampling mode
+
+        // In sampling mode (overload), report one value out of this number per PID and type.
+        static constexpr PacketCounter SAMPLING_RATE = 10;
 
         // Types of time stamps.
         enum DataType {PCR, OPCR, PTS, DTS};
@@ -156,13 +164,17 @@ namespace ts {
 
         // Report a value in csv or log format.
         void csvHeader();
-        void processValue(PIDContext&, PIDData PIDContext::*, uint64_t value, uint64_t pcr, bool report_it);
+        void processValue(PIDContext&, PIDData PIDContext::*, uint64_t value, uint64_t pcr, uint16_t flags, bool report_it);
     };
 }
 
 TSPLUGIN_DECLARE_VERSION
 TSPLUGIN_DECLARE_PROCESSOR(pcrextract, ts::PCRExtractPlugin)
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr ts::PacketCounter ts::PCRExtractPlugin::SAMPLING_RATE;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Plugin constructor
@@ -181,14 +193,18 @@ ts::PCRExtractPlugin::PCRExtractPlugin(TSP* tsp_) :
     _get_dts(false),
     _csv_format(false),
     _log_format(false),
+    _trace_format(false),
     _evaluate_pcr(false),
     _scte35(false),
     _output_name(),
     _output_stream(),
     _output(nullptr),
+    _trace_name(),
+    _trace(),
     _stats(),
     _splices(),
-    _demux(duck, this)
+    _demux(duck, this),
+    _sampled_count(0)
 {
     option(u"csv", 'c');
     help(u"csv",
@@ -255,6 +271,16 @@ ts::PCRExtractPlugin::PCRExtractPlugin(TSP* tsp_) :
     option(u"separator", 's', STRING);
     help(u"separator", "string"
          u"Field separator string in CSV output (default: '" DEFAULT_SEPARATOR u"').");
+
+    option(u"trace-file", 't', STRING);
+    help(u"trace-file", u"filename",
+         u"Write all reported values in a binary packet trace file. "
+         u"This is a compact columnar file format which is designed for offline analysis "
+         u"of very large captures. Each row contains the packet index in the TS, the PID, "
+         u"the type of value, the value, the PCR at that point (if known) and the count of "
+         u"values of this type in the PID. "
+         u"This option can be combined with --csv and --log. "
+         u"When used alone, there is no CSV output.");
 }
 
 
@@ -317,13 +343,15 @@ bool ts::PCRExtractPlugin::getOptions()
     _evaluate_pcr = present(u"evaluate-pcr-offset");
     _csv_format = present(u"csv") || !_output_name.empty();
     _log_format = present(u"log") || _scte35;
+    _trace_name = value(u"trace-file");
+    _trace_format = !_trace_name.empty();
 
     if (!_get_pts && !_get_dts && !_get_pcr && !_get_opcr) {
         // Report them all by default
         _get_pts = _get_dts = _get_pcr = _get_opcr = true;
     }
 
-    if (!_csv_format && !_log_format) {
+    if (!_csv_format && !_log_format && !_trace_format) {
         // Use CSV format by default.
         _csv_format = true;
     }
@@ -341,6 +369,7 @@ bool ts::PCRExtractPlugin::start()
     // Reset state
     _stats.clear();
     _splices.clear();
+    _sampled_count = 0;
     _demux.reset();
     _demux.addPID(PID_PAT);
 
@@ -357,6 +386,14 @@ bool ts::PCRExtractPlugin::start()
         }
     }
 
+    // Create the binary packet trace file if there is one.
+    if (_trace_format && !_trace.open(_trace_name, *tsp)) {
+        if (!_output_name.empty()) {
+            _output_stream.close();
+        }
+        return false;
+    }
+
     // Output header
     csvHeader();
     return true;
@@ -372,6 +409,12 @@ bool ts::PCRExtractPlugin::stop()
     if (!_output_name.empty()) {
         _output_stream.close();
     }
+    if (_trace.isOpen()) {
+        _trace.close(*tsp);
+    }
+    if (_sampled_count > 0) {
+        tsp->info(u"%'d values not reported in sampling mode (overload)", {_sampled_count});
+    }
     return true;
 }
 
@@ -420,12 +463,15 @@ ts::ProcessorPlugin::Status ts::PCRExtractPlugin::processPacket(TSPacket& pkt, T
     // Check if we must analyze and display this PID.
     if (_pids.test(pid)) {
 
+        // Flag for time stamps which are reported with an evaluated PCR.
+        const uint16_t pcr_flag = !has_pcr && pcr != INVALID_PCR ? uint16_t(PacketTraceRecord::EVALUATED_PCR) : 0;
+
         if (has_pcr) {
-            processValue(pc, &PIDContext::pcr, pcr, INVALID_PCR, _get_pcr);
+            processValue(pc, &PIDContext::pcr, pcr, INVALID_PCR, 0, _get_pcr);
         }
 
         if (pkt.hasOPCR()) {
-            processValue(pc, &PIDContext::opcr, pkt.getOPCR(), pcr, _get_opcr);
+            processValue(pc, &PIDContext::opcr, pkt.getOPCR(), pcr, pcr_flag, _get_opcr);
         }
 
         if (pkt.hasPTS()) {
@@ -436,11 +482,11 @@ ts::ProcessorPlugin::Status ts::PCRExtractPlugin::processPacket(TSPacket& pkt, T
             if (good_pts) {
                 pc.last_good_pts = pts;
             }
-            processValue(pc, &PIDContext::pts, pts, pcr, _get_pts && (good_pts || !_good_pts_only));
+            processValue(pc, &PIDContext::pts, pts, pcr, uint16_t(pcr_flag | (good_pts ? PacketTraceRecord::GOOD_PTS : 0)), _get_pts && (good_pts || !_good_pts_only));
         }
 
         if (pkt.hasDTS()) {
-            processValue(pc, &PIDContext::dts, pkt.getDTS(), pcr, _get_dts);
+            processValue(pc, &PIDContext::dts, pkt.getDTS(), pcr, pcr_flag, _get_dts);
         }
 
         pc.packet_count++;
@@ -473,7 +519,7 @@ void ts::PCRExtractPlugin::csvHeader()
 // Report a value in CSV and/or log format.
 //----------------------------------------------------------------------------
 
-void ts::PCRExtractPlugin::processValue(PIDContext& ctx, PIDData PIDContext::* pdata, uint64_t value, uint64_t pcr, bool report_it)
+void ts::PCRExtractPlugin::processValue(PIDContext& ctx, PIDData PIDContext::* pdata, uint64_t value, uint64_t pcr, uint16_t flags, bool report_it)
 {
     PIDData& data(ctx.*pdata);
     const UString name(_type_names.name(data.type));
@@ -484,6 +530,15 @@ void ts::PCRExtractPlugin::processValue(PIDContext& ctx, PIDData PIDContext::* p
         data.first_value = value;
     }
 
+    // In sampling mode (overload), report only a few values.
+    if (tsp->sampling() && report_it) {
+        flags = uint16_t(flags | PacketTraceRecord::SAMPLED);
+        if ((data.count - 1) % SAMPLING_RATE != 0) {
+            report_it = false;
+            _sampled_count++;
+        }
+    }
+
     // Time offset since first value of this type in the PID.
     const uint64_t since_start = value - data.first_value;
     const int64_t since_previous = data.last_value == INVALID_PCR ? 0 : int64_t(value) - int64_t(data.last_value);
@@ -516,6 +571,20 @@ void ts::PCRExtractPlugin::processValue(PIDContext& ctx, PIDData PIDContext::* p
                   (since_previous * MilliSecPerSec) / frequency});
     }
 
+    // Report in binary packet trace file.
+    if (_trace_format && report_it) {
+        static const uint8_t events[] = {PacketTraceRecord::PCR, PacketTraceRecord::OPCR, PacketTraceRecord::PTS, PacketTraceRecord::DTS};
+        PacketTraceRecord rec;
+        rec.packet = tsp->pluginPackets();
+        rec.pid = ctx.pid;
+        rec.event = events[data.type];
+        rec.flags = flags;
+        rec.value = value;
+        rec.pcr = pcr;
+        rec.extra = data.count;
+        _trace.write(rec, *tsp);
+    }
+
     // Remember last value.
     data.last_value = value;
     data.last_packet = tsp->pluginPackets();
@@ -645,11 +714,9 @@ void ts::PCRExtractPlugin::processPMT(const PMT& pmt)
 
     // Now, we know all components and all splice info PID's.
     if (scte35_found) {
-        for (PID pid = 0; pid < splicePIDs.size(); ++pid) {
-            if (splicePIDs.test(pid)) {
-                // Add components which are associated with this splice info PID.
-                getSpliceContext(pid)->components |= servicePIDs;
-            }
+        for (size_t pid = splicePIDs.first(); pid < splicePIDs.size(); pid = splicePIDs.next(pid)) {
+            // Add components which are associated with this splice info PID.
+            getSpliceContext(PID(pid))->components |= servicePIDs;
         }
     }
 }
@@ -669,15 +736,13 @@ void ts::PCRExtractPlugin::processSpliceCommand(PID pid, SpliceInformationTable&
 
     // Get the highest PTS from all associated components.
     uint64_t service_pts = INVALID_PTS;
-    for (PID comp_pid = 0; comp_pid < pc->components.size(); ++comp_pid) {
-        if (pc->components.test(comp_pid)) {
-            const auto it = _stats.find(comp_pid);
-            if (it != _stats.end()) {
-                // PCR or PTS were found in this component.
-                const uint64_t comp_pts = it->second->last_good_pts;
-                if (comp_pts != 0 && (service_pts == INVALID_PTS || comp_pts > service_pts)) {
-                    service_pts = comp_pts;
-                }
+    for (size_t comp_pid = pc->components.first(); comp_pid < pc->components.size(); comp_pid = pc->components.next(comp_pid)) {
+        const auto it = _stats.find(PID(comp_pid));
+        if (it != _stats.end()) {
+            // PCR or PTS were found in this component.
+            const uint64_t comp_pts = it->second->last_good_pts;
+            if (comp_pts != 0 && (service_pts == INVALID_PTS || comp_pts > service_pts)) {
+                service_pts = comp_pts;
             }
         }
     }
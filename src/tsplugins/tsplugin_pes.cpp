@@ -80,6 +80,9 @@ namespace ts {
         int             _max_payload;    // Maximum payload size (<0: no filter)
         PESDemux        _demux;
 
+        // In sampling mode (overload), analyze one PES packet out of this number per PID.
+        static constexpr size_t SAMPLING_RATE = 10;
+
         // Process dump count. Return true when terminated. Also process error on output.
         bool lastDump(std::ostream&);
 
@@ -98,6 +101,10 @@ namespace ts {
 TSPLUGIN_DECLARE_VERSION
 TSPLUGIN_DECLARE_PROCESSOR(pes, ts::PESPlugin)
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::PESPlugin::SAMPLING_RATE;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Constructor
@@ -331,6 +338,10 @@ bool ts::PESPlugin::stop()
         _outfile.close();
     }
 
+    // Report how much was lost in sampling mode.
+    if (_demux.sampledCount() > 0) {
+        tsp->info(u"%'d PES packets not analyzed in sampling mode (overload)", {_demux.sampledCount()});
+    }
     return true;
 }
 
@@ -341,6 +352,7 @@ bool ts::PESPlugin::stop()
 
 ts::ProcessorPlugin::Status ts::PESPlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
 {
+    _demux.setSampling(tsp->sampling() ? SAMPLING_RATE : 0);
     _demux.feedPacket(pkt);
     return _abort ? TSP_END : TSP_OK;
 }
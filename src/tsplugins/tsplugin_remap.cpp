@@ -64,14 +64,39 @@ namespace ts {
         typedef SafePtr<CyclingPacketizer, NullMutex> CyclingPacketizerPtr;
         typedef std::map<PID, CyclingPacketizerPtr> PacketizerMap;
 
+        // Last input PAT, CAT or PMT. The version offset is incremented each time the output table
+        // is rebuilt without a new input table, so that the receivers notice the change.
+        class InputTable
+        {
+        public:
+            InputTable() : table(), version_offset(0) {}
+            BinaryTablePtr table;
+            uint8_t        version_offset;
+        };
+        typedef std::map<uint32_t, InputTable> TableMap;  // Key: PID and service id.
+
         bool          _update_psi;      // Update all PSI
         bool          _pmt_ready;       // All PMT PID's are known
+        bool          _abort;           // Error, no more PID to allocate
+        bool          _reallocated;     // Some automatic PID was allocated again, rebuild the PSI
+        PIDSet        _inputPIDs;       // PID's which were found in the input stream
+        PIDSet        _psiPIDs;         // PID's which are referenced in the input PSI
+        PIDSet        _pzerPIDs;        // PID's with a packetizer
         SectionDemux  _demux;           // Section demux
         PacketizerMap _pzer;            // Packetizer for sections
+        TableMap      _tables;          // Last input PAT, CAT and PMT's
 
         // Invoked by the demux when a complete table is available.
         virtual void handleTable(SectionDemux&, const BinaryTable&) override;
 
+        // Remap the PID's in an input table and replace it in the output.
+        void processTable(const BinaryTable&, uint8_t version_offset);
+
+        // Allocate again the automatic output PID's which are also used in the input stream.
+        // Then rebuild the PSI from the last input tables.
+        void checkAutoPIDs(const PIDSet& pids);
+        void rebuildPSI();
+
         // Get the remapped value of a PID (or same PID if not remapped)
         PID remap(PID);
 
@@ -80,6 +105,9 @@ namespace ts {
 
         // Process a list of descriptors, remap PIDs in CA descriptors.
         void processDescriptors(DescriptorList&, TID);
+
+        // Mark PIDs in CA descriptors as referenced in the input PSI.
+        void addCAPIDs(const DescriptorList&);
     };
 }
 
@@ -95,8 +123,14 @@ ts::RemapPlugin::RemapPlugin(TSP* tsp_) :
     AbstractDuplicateRemapPlugin(true, tsp_, u"Generic PID remapper", u"[options] [pid[-pid]=newpid ...]"),
     _update_psi(false),
     _pmt_ready(false),
+    _abort(false),
+    _reallocated(false),
+    _inputPIDs(),
+    _psiPIDs(),
+    _pzerPIDs(),
     _demux(duck, this),
-    _pzer()
+    _pzer(),
+    _tables()
 {
     option(u"no-psi", 'n');
     help(u"no-psi",
@@ -128,6 +162,12 @@ bool ts::RemapPlugin::start()
 {
     // Clear the list of packetizers
     _pzer.clear();
+    _pzerPIDs.reset();
+    _inputPIDs.reset();
+    _psiPIDs.reset();
+    _tables.clear();
+    _abort = false;
+    _reallocated = false;
 
     // Initialize the demux
     _demux.reset();
@@ -141,7 +181,7 @@ bool ts::RemapPlugin::start()
     // Do not care about PMT if no need to update PSI
     _pmt_ready = !_update_psi;
 
-    tsp->verbose(u"%d PID's remapped", {_pidMap.size()});
+    tsp->verbose(u"%d PID's remapped, %d PID's with automatic allocation", {_oldPIDs.count(), _autoPIDs.count()});
     return true;
 }
 
@@ -152,8 +192,11 @@ bool ts::RemapPlugin::start()
 
 ts::PID ts::RemapPlugin::remap(PID pid)
 {
-    const PIDMap::const_iterator it = _pidMap.find(pid);
-    return it == _pidMap.end() ? pid : it->second;
+    // Allocate the output PID on first use.
+    if (_autoPIDs.test(pid) && !allocatePID(pid, _inputPIDs | _psiPIDs)) {
+        _abort = true;
+    }
+    return _pidTable[pid];
 }
 
 
@@ -170,6 +213,7 @@ ts::RemapPlugin::CyclingPacketizerPtr ts::RemapPlugin::getPacketizer(PID pid, bo
     else if (create) {
         const CyclingPacketizerPtr ptr(new CyclingPacketizer(pid, CyclingPacketizer::ALWAYS));
         _pzer.insert(std::make_pair(pid, ptr));
+        _pzerPIDs.set(pid);
         return ptr;
     }
     else {
@@ -196,16 +240,92 @@ void ts::RemapPlugin::processDescriptors(DescriptorList& dlist, TID table_id)
 }
 
 
+//----------------------------------------------------------------------------
+// Mark PIDs in CA descriptors as referenced in the input PSI.
+//----------------------------------------------------------------------------
+
+void ts::RemapPlugin::addCAPIDs(const DescriptorList& dlist)
+{
+    for (size_t i = dlist.search(DID_CA); i < dlist.count(); i = dlist.search(DID_CA, i + 1)) {
+        CADescriptor cadesc(duck, *dlist[i]);
+        if (cadesc.isValid()) {
+            _psiPIDs.set(cadesc.ca_pid);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Allocate again the automatic output PID's which are also used in the input.
+//----------------------------------------------------------------------------
+
+void ts::RemapPlugin::checkAutoPIDs(const PIDSet& pids)
+{
+    // A conflicting PID is used in the input and is not remapped itself.
+    PIDSet conflicts(pids & _autoNewPIDs);
+    conflicts.exclude(_oldPIDs).exclude(_autoPIDs);
+    for (size_t pid = conflicts.first(); !_abort && pid < conflicts.size(); pid = conflicts.next(pid)) {
+        if (reallocatePID(PID(pid), _inputPIDs | _psiPIDs)) {
+            _reallocated = true;
+        }
+        else {
+            _abort = true;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Rebuild the PSI after allocating again some automatic PID's.
+//----------------------------------------------------------------------------
+
+void ts::RemapPlugin::rebuildPSI()
+{
+    // The previous references to the reallocated PID's are in the output tables.
+    while (_reallocated && !_abort) {
+        _reallocated = false;
+        for (TableMap::iterator it = _tables.begin(); it != _tables.end(); ++it) {
+            it->second.version_offset++;
+            processTable(*it->second.table, it->second.version_offset);
+        }
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Invoked by the demux when a complete table is available.
 //----------------------------------------------------------------------------
 
 void ts::RemapPlugin::handleTable(SectionDemux& demux, const BinaryTable& table)
+{
+    // Keep the input tables to rebuild the PSI when an automatic PID is allocated again.
+    const TID tid = table.tableId();
+    if ((tid == TID_PAT && table.sourcePID() == PID_PAT) || (tid == TID_CAT && table.sourcePID() == PID_CAT) || tid == TID_PMT) {
+        InputTable& input(_tables[(uint32_t(table.sourcePID()) << 16) | (tid == TID_PMT ? table.tableIdExtension() : 0)]);
+        input.table = new BinaryTable(table, SHARE);
+        processTable(table, input.version_offset);
+        rebuildPSI();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Remap the PID's in an input table and replace it in the output.
+//----------------------------------------------------------------------------
+
+void ts::RemapPlugin::processTable(const BinaryTable& table, uint8_t version_offset)
 {
     if (table.tableId() == TID_PAT && table.sourcePID() == PID_PAT) {
         PAT pat(duck, table);
         if (pat.isValid()) {
+            // Record all input PID's before allocating new ones.
+            _psiPIDs.set(pat.nit_pid);
+            for (PAT::ServiceMap::const_iterator it = pat.pmts.begin(); it != pat.pmts.end(); ++it) {
+                _psiPIDs.set(it->second);
+            }
+            checkAutoPIDs(_psiPIDs);
             // Process the PAT content
+            pat.version = (pat.version + version_offset) & SVERSION_MASK;
             pat.nit_pid = remap(pat.nit_pid);
             for (PAT::ServiceMap::iterator it = pat.pmts.begin(); it != pat.pmts.end(); ++it) {
                 // Need to filter and transform this PMT
@@ -226,7 +346,11 @@ void ts::RemapPlugin::handleTable(SectionDemux& demux, const BinaryTable& table)
     else if (table.tableId() == TID_CAT && table.sourcePID() == PID_CAT) {
         CAT cat(duck, table);
         if (cat.isValid()) {
+            // Record all input PID's before allocating new ones.
+            addCAPIDs(cat.descs);
+            checkAutoPIDs(_psiPIDs);
             // Process the CAT content
+            cat.version = (cat.version + version_offset) & SVERSION_MASK;
             processDescriptors(cat.descs, TID_CAT);
             // Replace the CAT
             const CyclingPacketizerPtr pzer = getPacketizer(PID_CAT, true);
@@ -238,7 +362,16 @@ void ts::RemapPlugin::handleTable(SectionDemux& demux, const BinaryTable& table)
     else if (table.tableId() == TID_PMT) {
         PMT pmt(duck, table);
         if (pmt.isValid()) {
+            // Record all input PID's before allocating new ones.
+            _psiPIDs.set(pmt.pcr_pid);
+            addCAPIDs(pmt.descs);
+            for (PMT::StreamMap::const_iterator it = pmt.streams.begin(); it != pmt.streams.end(); ++it) {
+                _psiPIDs.set(it->first);
+                addCAPIDs(it->second.descs);
+            }
+            checkAutoPIDs(_psiPIDs);
             // Process the PMT content
+            pmt.version = (pmt.version + version_offset) & SVERSION_MASK;
             processDescriptors(pmt.descs, TID_PMT);
             pmt.pcr_pid = remap(pmt.pcr_pid);
             PMT::StreamMap new_map(nullptr);
@@ -263,7 +396,7 @@ void ts::RemapPlugin::handleTable(SectionDemux& demux, const BinaryTable& table)
 ts::ProcessorPlugin::Status ts::RemapPlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
 {
     const PID pid = pkt.getPID();
-    const PID new_pid = remap(pid);
+    _inputPIDs.set(pid);
 
     // PSI processing
     if (_update_psi) {
@@ -272,10 +405,9 @@ ts::ProcessorPlugin::Status ts::RemapPlugin::processPacket(TSPacket& pkt, TSPack
         _demux.feedPacket (pkt);
 
         // Rebuild PSI packets
-        const CyclingPacketizerPtr pzer = getPacketizer(pid, false);
-        if (!pzer.isNull()) {
+        if (_pzerPIDs.test(pid)) {
             // This is a PSI PID, its content may haved changed
-            pzer->getNextPacket(pkt);
+            getPacketizer(pid, false)->getNextPacket(pkt);
         }
         else if (!_pmt_ready) {
             // While not all PMT identified, nullify all packets without packetizer
@@ -283,8 +415,21 @@ ts::ProcessorPlugin::Status ts::RemapPlugin::processPacket(TSPacket& pkt, TSPack
         }
     }
 
-    // Check conflicts
-    if (!_unchecked && new_pid == pid && _newPIDs.test(pid)) {
+    // Translate the PID, allocate automatic PID if necessary.
+    const PID new_pid = remap(pid);
+    if (_abort) {
+        return TSP_END;
+    }
+
+    // Check conflicts. An automatic output PID which is found in the input is allocated again.
+    if (new_pid == pid && _autoNewPIDs.test(pid)) {
+        checkAutoPIDs(PIDSet().set(pid));
+        rebuildPSI();
+        if (_abort) {
+            return TSP_END;
+        }
+    }
+    else if (!_unchecked && new_pid == pid && _newPIDs.test(pid)) {
         tsp->error(u"PID conflict: PID %d (0x%X) present both in input and remap", {pid, pid});
         return TSP_END;
     }
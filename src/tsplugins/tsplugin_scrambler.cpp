@@ -105,6 +105,7 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual bool flushPackets() override;
 
     private:
         // Description of a crypto-period.
@@ -846,8 +847,8 @@ ts::ProcessorPlugin::Status ts::ScramblerPlugin::processPacket(TSPacket& pkt, TS
         _partial_clear = _partial_scrambling - 1;
     }
 
-    // Scramble the packet payload.
-    if (!_scrambling.encrypt(pkt)) {
+    // Scramble the packet payload, later, in a batch with other packets.
+    if (!_scrambling.encryptLater(pkt)) {
         return TSP_END;
     }
     _scrambled_count++;
@@ -856,6 +857,16 @@ ts::ProcessorPlugin::Status ts::ScramblerPlugin::processPacket(TSPacket& pkt, TS
 }
 
 
+//----------------------------------------------------------------------------
+// Scramble the pending packets before passing them to the next plugin.
+//----------------------------------------------------------------------------
+
+bool ts::ScramblerPlugin::flushPackets()
+{
+    return _scrambling.flush();
+}
+
+
 //----------------------------------------------------------------------------
 // CryptoPeriod default constructor.
 //----------------------------------------------------------------------------
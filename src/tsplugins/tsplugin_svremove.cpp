@@ -63,17 +63,27 @@ namespace ts {
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
 
     private:
+        typedef std::map<uint16_t, PID> PMTPIDMap;
+        typedef std::map<uint16_t, PIDSet> ServicePIDMap;
+        typedef std::set<uint16_t> ServiceIdSet;
+        typedef std::vector<Service> ServiceVector;
+
         bool              _abort;          // Error (service not found, etc)
         bool              _ready;          // Ready to pass packets
         bool              _transparent;    // Transparent mode, pass all packets
-        Service           _service;        // Service name & id
+        bool              _ids_known;      // All service ids are known
+        ServiceVector     _services;       // Services names & ids to remove
+        ServiceIdSet      _removed_ids;    // Ids of services to remove
+        ServiceIdSet      _pending_pmts;   // Ids of removed services with PMT not yet analyzed
+        PMTPIDMap         _pmt_pids;       // PMT PID of all services, indexed by service id
+        ServicePIDMap     _service_pids;   // PIDs referenced by the PMT of all services, indexed by service id
         bool              _ignore_absent;  // Ignore service if absent
         bool              _ignore_bat;     // Do not modify the BAT
         bool              _ignore_eit;     // Do not modify the EIT's
         bool              _ignore_nit;     // Do not modify the NIT
         Status            _drop_status;    // Status for dropped packets
-        PIDSet            _drop_pids;      // List of PIDs to drop
-        PIDSet            _ref_pids;       // List of other referenced PIDs
+        PIDSet            _drop_pids;      // List of PIDs to drop, recomputed on PAT or PMT change
+        PIDSet            _ref_pids;       // List of predefined PIDs, never dropped
         SectionDemux      _demux;          // Section demux
         CyclingPacketizer _pzer_pat;       // Packetizer for modified PAT
         CyclingPacketizer _pzer_sdt_bat;   // Packetizer for modified SDT/BAT
@@ -92,6 +102,12 @@ namespace ts {
 
         // Mark all ECM PIDs from the specified descriptor list in the specified PID set
         void addECMPID(const DescriptorList&, PIDSet&);
+
+        // Check if a service id is removed.
+        bool isRemoved(uint16_t id) const { return _removed_ids.find(id) != _removed_ids.end(); }
+
+        // Recompute the bitmap of PIDs to drop after a PAT or PMT change.
+        void updateDropPIDs();
     };
 }
 
@@ -104,11 +120,16 @@ TSPLUGIN_DECLARE_PROCESSOR(svremove, ts::SVRemovePlugin)
 //----------------------------------------------------------------------------
 
 ts::SVRemovePlugin::SVRemovePlugin (TSP* tsp_) :
-    ProcessorPlugin(tsp_, u"Remove a service", u"[options] service"),
+    ProcessorPlugin(tsp_, u"Remove one or more services", u"[options] service ..."),
     _abort(false),
     _ready(false),
     _transparent(false),
-    _service(),
+    _ids_known(false),
+    _services(),
+    _removed_ids(),
+    _pending_pmts(),
+    _pmt_pids(),
+    _service_pids(),
     _ignore_absent(false),
     _ignore_bat(false),
     _ignore_eit(false),
@@ -122,17 +143,19 @@ ts::SVRemovePlugin::SVRemovePlugin (TSP* tsp_) :
     _pzer_nit(PID_NIT, CyclingPacketizer::ALWAYS),
     _eit_process(duck, PID_EIT)
 {
-    option(u"", 0, STRING, 1, 1);
+    option(u"", 0, STRING, 1, UNLIMITED_COUNT);
     help(u"",
-         u"Specifies the service to remove. If the argument is an integer value "
+         u"Specifies the services to remove. If an argument is an integer value "
          u"(either decimal or hexadecimal), it is interpreted as a service id. "
          u"Otherwise, it is interpreted as a service name, as specified in the SDT. "
-         u"The name is not case sensitive and blanks are ignored.");
+         u"The name is not case sensitive and blanks are ignored. "
+         u"Several services can be removed at once. This is more efficient than "
+         u"chaining several instances of this plugin.");
 
     option(u"ignore-absent", 'a');
     help(u"ignore-absent",
-         u"Ignore service if not present in the transport stream. By default, tsp "
-         u"fails if the service is not found.");
+         u"Ignore services which are not present in the transport stream. By default, tsp "
+         u"fails if a service is not found.");
 
     option(u"ignore-bat", 'b');
     help(u"ignore-bat", u"Do not modify the BAT.");
@@ -157,7 +180,15 @@ ts::SVRemovePlugin::SVRemovePlugin (TSP* tsp_) :
 bool ts::SVRemovePlugin::start()
 {
     // Get option values
-    _service.set(value(u""));
+    _services.clear();
+    _removed_ids.clear();
+    for (size_t i = 0; i < count(u""); ++i) {
+        _services.push_back(Service(value(u"", u"", i)));
+        if (_services.back().hasId()) {
+            _removed_ids.insert(_services.back().getId());
+        }
+    }
+    _ids_known = _removed_ids.size() == _services.size();
     _ignore_absent = present(u"ignore-absent");
     _ignore_bat = present(u"ignore-bat");
     _ignore_eit = present(u"ignore-eit");
@@ -168,12 +199,12 @@ bool ts::SVRemovePlugin::start()
     _demux.reset();
     _demux.addPID(PID_SDT);
 
-    // When the service id is known, we wait for the PAT. If it is not yet
+    // When all service ids are known, we wait for the PAT. If some are not yet
     // known (only the service name is known), we do not know how to modify
     // the PAT. We will wait for it after receiving the SDT.
     // Packets from PAT PID are analyzed but not passed. When a complete
     // PAT is read, a modified PAT will be transmitted.
-    if (_service.hasId()) {
+    if (_ids_known) {
         _demux.addPID(PID_PAT);
         if (!_ignore_nit) {
             _demux.addPID(PID_NIT);
@@ -182,9 +213,15 @@ bool ts::SVRemovePlugin::start()
 
     // Initialize the EIT processing.
     _eit_process.reset();
+    if (!_ignore_eit) {
+        for (auto it = _services.begin(); it != _services.end(); ++it) {
+            if (it->hasId()) {
+                _eit_process.removeService(*it);
+            }
+        }
+    }
 
-    // Build a list of referenced PID's (except those in the removed service).
-    // Prevent predefined PID's from being removed.
+    // Build the list of predefined PID's, prevent them from being removed.
     _ref_pids.reset();
     _ref_pids.set(PID_PAT);
     _ref_pids.set(PID_CAT);
@@ -206,6 +243,9 @@ bool ts::SVRemovePlugin::start()
     _abort = false;
     _ready = false;
     _transparent = false;
+    _pending_pmts.clear();
+    _pmt_pids.clear();
+    _service_pids.clear();
     _drop_pids.reset();
     _pzer_pat.reset();
     _pzer_sdt_bat.reset();
@@ -269,9 +309,9 @@ void ts::SVRemovePlugin::handleTable(SectionDemux& demux, const BinaryTable& tab
 
         case TID_BAT:
             if (table.sourcePID() == PID_BAT) {
-                if (!_service.hasId()) {
+                if (!_ids_known) {
                     // The BAT and SDT are on the same PID. Here, we are in the case
-                    // were the service was designated by name and the first BAT arrives
+                    // were a service was designated by name and the first BAT arrives
                     // before the first SDT. We do not know yet how to modify the BAT.
                     // Reset the demux on this PID, so that this BAT will be submitted
                     // again the next time.
@@ -336,43 +376,52 @@ void ts::SVRemovePlugin::handleTable(SectionDemux& demux, const BinaryTable& tab
 
 void ts::SVRemovePlugin::processSDT(SDT& sdt)
 {
-    bool found = false;
-
-    // Look for the service by name or by id
-    if (_service.hasId()) {
-        // Search service by id
-        found = sdt.services.find(_service.getId()) != sdt.services.end();
-        if (!found) {
-            // Informational only, SDT entry is not mandatory.
-            tsp->info(u"service %d (0x%X) not found in SDT, ignoring it", {_service.getId(), _service.getId()});
-        }
-    }
-    else {
-        // Service id is currently unknown, search service by name
-        found = sdt.findService(duck, _service);
-        if (!found) {
-            // Here, this is an error. A service can be searched by name only in current TS
-            if (_ignore_absent) {
-                tsp->warning(u"service \"%s\" not found in SDT, ignoring it", {_service.getName()});
-                _transparent = true;
+    // Look for the services by name or by id
+    for (auto it = _services.begin(); it != _services.end(); ) {
+        if (it->hasId()) {
+            // Search service by id
+            if (sdt.services.find(it->getId()) == sdt.services.end()) {
+                // Informational only, SDT entry is not mandatory.
+                tsp->info(u"service %d (0x%X) not found in SDT, ignoring it", {it->getId(), it->getId()});
             }
-            else {
-                tsp->error(u"service \"%s\" not found in SDT", {_service.getName()});
-                _abort = true;
+        }
+        else if (sdt.findService(duck, *it)) {
+            // The service id was previously unknown.
+            tsp->verbose(u"found service \"%s\", service id is 0x%X", {it->getName(), it->getId()});
+            _removed_ids.insert(it->getId());
+            if (!_ignore_eit) {
+                _eit_process.removeService(*it);
             }
+        }
+        else if (_ignore_absent) {
+            // A service can be searched by name only in current TS
+            tsp->warning(u"service \"%s\" not found in SDT, ignoring it", {it->getName()});
+            it = _services.erase(it);
+            continue;
+        }
+        else {
+            tsp->error(u"service \"%s\" not found in SDT", {it->getName()});
+            _abort = true;
             return;
         }
-        // The service id was previously unknown, now wait for the PAT
+        // Remove service description in the SDT
+        sdt.services.erase(it->getId());
+        ++it;
+    }
+
+    // If all services are absent, nothing to remove.
+    if (_services.empty()) {
+        _transparent = true;
+        return;
+    }
+
+    // When all service ids are known for the first time, now wait for the PAT.
+    if (!_ids_known) {
+        _ids_known = true;
         _demux.addPID(PID_PAT);
         if (!_ignore_nit) {
             _demux.addPID(PID_NIT);
         }
-        tsp->verbose(u"found service \"%s\", service id is 0x%X", {_service.getName(), _service.getId()});
-    }
-
-    // Remove service description in the SDT
-    if (_service.hasId()) {
-        sdt.services.erase(_service.getId());
     }
 
     // Replace the SDT in the PID
@@ -387,58 +436,65 @@ void ts::SVRemovePlugin::processSDT(SDT& sdt)
 
 void ts::SVRemovePlugin::processPAT(PAT& pat)
 {
-    // PAT not normally fetched until service id is known
-    assert(_service.hasId());
+    // PAT not normally fetched until all service ids are known
+    assert(_ids_known);
 
     // Save the NIT PID
     _pzer_nit.setPID(pat.nit_pid);
     _demux.addPID(pat.nit_pid);
+    _ref_pids.set(pat.nit_pid);
+
+    // Forget services which are no longer in the PAT.
+    for (auto it = _service_pids.begin(); it != _service_pids.end(); ) {
+        if (pat.pmts.find(it->first) == pat.pmts.end()) {
+            it = _service_pids.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
 
     // Loop on all services in the PAT. We need to scan all PMT's to know which
-    // PID to remove and which to keep (if shared between the removed service
+    // PID to remove and which to keep (if shared between a removed service
     // and other services).
-    bool found = false;
+    _pmt_pids.clear();
     for (PAT::ServiceMap::const_iterator it = pat.pmts.begin(); it != pat.pmts.end(); ++it) {
         // Scan all PMT's
         _demux.addPID(it->second);
+        _pmt_pids[it->first] = it->second;
+        // Wait for the PMT of removed services before passing packets.
+        if (isRemoved(it->first) && _service_pids.find(it->first) == _service_pids.end()) {
+            _pending_pmts.insert(it->first);
+        }
+    }
 
-        // Check if service to remove is here
-        if (it->first == _service.getId()) {
-            found = true;
-            _service.setPMTPID(it->second);
-            tsp->verbose(u"found service id 0x%X, PMT PID is 0x%X", {_service.getId(), _service.getPMTPID()});
-            // Drop PMT of the service
-            _drop_pids.set(it->second);
+    // Check that all services to remove are here, remove them from the PAT.
+    for (auto it = _services.begin(); it != _services.end(); ++it) {
+        const uint16_t id = it->getId();
+        const auto pmt = pat.pmts.find(id);
+        if (pmt != pat.pmts.end()) {
+            it->setPMTPID(pmt->second);
+            tsp->verbose(u"found service id 0x%X, PMT PID is 0x%X", {id, pmt->second});
+            pat.pmts.erase(pmt);
+        }
+        else if (_ignore_absent || !_ignore_nit || !_ignore_bat) {
+            // Service is not present in current TS, but continue
+            tsp->info(u"service id 0x%X not found in PAT, ignoring it", {id});
         }
         else {
-            // Mark other PMT's as referenced
-            _ref_pids.set(it->second);
+            // If service is not found and no need to modify to NIT or BAT, abort
+            tsp->error(u"service id 0x%X not found in PAT", {id});
+            _abort = true;
         }
     }
 
-    if (found) {
-        // Remove the service from the PAT
-        pat.pmts.erase(_service.getId());
-    }
-    else if (_ignore_absent || !_ignore_nit || !_ignore_bat) {
-        // Service is not present in current TS, but continue
-        tsp->info(u"service id 0x%X not found in PAT, ignoring it", {_service.getId()});
-        _ready = true;
-    }
-    else {
-        // If service is not found and no need to modify to NIT or BAT, abort
-        tsp->error(u"service id 0x%X not found in PAT", {_service.getId()});
-        _abort = true;
-    }
+    // Ready to filter PIDs when all removed services are analyzed.
+    _ready = _ready || _pending_pmts.empty();
+    updateDropPIDs();
 
     // Replace the PAT.in the PID
     _pzer_pat.removeSections(TID_PAT);
     _pzer_pat.addTable(duck, pat);
-
-    // Remove EIT's for this service.
-    if (!_ignore_eit) {
-        _eit_process.removeService(_service);
-    }
 }
 
 
@@ -448,11 +504,9 @@ void ts::SVRemovePlugin::processPAT(PAT& pat)
 
 void ts::SVRemovePlugin::processPMT(PMT& pmt)
 {
-    // Is this the PMT of the service to remove?
-    const bool removed_service = pmt.service_id == _service.getId();
-
-    // Mark PIDs as dropped or referenced.
-    PIDSet& pid_set(removed_service ? _drop_pids : _ref_pids);
+    // Rebuild the list of PIDs which are referenced by this service.
+    PIDSet& pid_set(_service_pids[pmt.service_id]);
+    pid_set.reset();
 
     // Mark all program-level ECM PID's
     addECMPID(pmt.descs, pid_set);
@@ -468,8 +522,36 @@ void ts::SVRemovePlugin::processPMT(PMT& pmt)
         addECMPID(it->second.descs, pid_set);
     }
 
-    // When the service to remove has been analyzed, we are ready to filter PIDs
-    _ready = _ready || removed_service;
+    // When all services to remove have been analyzed, we are ready to filter PIDs
+    _pending_pmts.erase(pmt.service_id);
+    _ready = _ready || _pending_pmts.empty();
+    updateDropPIDs();
+}
+
+
+//----------------------------------------------------------------------------
+// Recompute the bitmap of PIDs to drop after a PAT or PMT change.
+//----------------------------------------------------------------------------
+
+void ts::SVRemovePlugin::updateDropPIDs()
+{
+    // PIDs to drop and PIDs to keep (shared between a removed service and other services).
+    PIDSet drop;
+    PIDSet keep(_ref_pids);
+
+    for (PMTPIDMap::const_iterator it = _pmt_pids.begin(); it != _pmt_pids.end(); ++it) {
+        (isRemoved(it->first) ? drop : keep).set(it->second);
+    }
+    for (ServicePIDMap::const_iterator it = _service_pids.begin(); it != _service_pids.end(); ++it) {
+        if (isRemoved(it->first)) {
+            drop |= it->second;
+        }
+        else {
+            keep |= it->second;
+        }
+    }
+
+    _drop_pids = drop.exclude(keep);
 }
 
 
@@ -527,8 +609,8 @@ void ts::SVRemovePlugin::processNITBATDescriptorList(DescriptorList& dlist)
         uint8_t* new_data = base;
 
         while (size >= 3) {
-            if (GetUInt16 (data) != _service.getId()) {
-                // Not the removed service, keep this entry
+            if (!isRemoved(GetUInt16(data))) {
+                // Not a removed service, keep this entry
                 new_data[0] = data[0];
                 new_data[1] = data[1];
                 new_data[2] = data[2];
@@ -551,8 +633,8 @@ void ts::SVRemovePlugin::processNITBATDescriptorList(DescriptorList& dlist)
         uint8_t* new_data = base;
 
         while (size >= 4) {
-            if (GetUInt16 (data) != _service.getId()) {
-                // Not the removed service, keep this entry
+            if (!isRemoved(GetUInt16(data))) {
+                // Not a removed service, keep this entry
                 new_data[0] = data[0];
                 new_data[1] = data[1];
                 new_data[2] = data[2];
@@ -594,7 +676,7 @@ ts::ProcessorPlugin::Status ts::SVRemovePlugin::processPacket(TSPacket& pkt, TSP
     }
 
     // Packets from removed PIDs are either dropped or nullified
-    if (_drop_pids[pid] && !_ref_pids[pid]) {
+    if (_drop_pids[pid]) {
         return _drop_status;
     }
 
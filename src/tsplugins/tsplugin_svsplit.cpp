@@ -0,0 +1,680 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Transport stream processor shared library:
+//  Split an MPTS into several SPTS, one per service, in one single pass.
+//
+//----------------------------------------------------------------------------
+
+#include "tsPlugin.h"
+#include "tsPluginRepository.h"
+#include "tsService.h"
+#include "tsSectionDemux.h"
+#include "tsCyclingPacketizer.h"
+#include "tsCADescriptor.h"
+#include "tsTSFile.h"
+#include "tsUDPSocket.h"
+#include "tsPAT.h"
+#include "tsPMT.h"
+#include "tsSDT.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Plugin definition
+//----------------------------------------------------------------------------
+
+namespace ts {
+    class SVSplitPlugin: public ProcessorPlugin, private TableHandlerInterface
+    {
+        TS_NOBUILD_NOCOPY(SVSplitPlugin);
+    public:
+        // Implementation of plugin API
+        SVSplitPlugin(TSP*);
+        virtual bool getOptions() override;
+        virtual bool start() override;
+        virtual bool stop() override;
+        virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+
+    private:
+        // Each split service is identified by a bit in a mask.
+        // The number of services which can be split by one instance is the number of bits in a mask.
+        typedef uint64_t ServiceMask;
+        static constexpr size_t MAX_SERVICES = 8 * sizeof(ServiceMask);
+
+        // Default number of buffered packets per SPTS, for file output.
+        static constexpr size_t DEF_FILE_BUFFER = 512;
+
+        // Description of one output SPTS.
+        class SPTS
+        {
+            TS_NOBUILD_NOCOPY(SPTS);
+        public:
+            SPTS(uint16_t id, size_t buffer_size);
+
+            uint16_t          service_id;   // Service id.
+            PID               pmt_pid;      // PMT PID of the service, PID_NULL if unknown.
+            bool              has_pat;      // A PAT is available in pzer_pat.
+            bool              has_pmt;      // A PMT is available in pzer_pmt.
+            bool              has_sdt;      // An SDT is available in pzer_sdt.
+            CyclingPacketizer pzer_pat;     // Packetizer for the PAT of the SPTS.
+            CyclingPacketizer pzer_pmt;     // Packetizer for the PMT of the SPTS.
+            CyclingPacketizer pzer_sdt;     // Packetizer for the SDT of the SPTS.
+            TSPacketVector    buffer;       // Buffer of packets to write.
+            size_t            buffer_count; // Number of packets in buffer.
+            TSFile            file;         // Output file (file output only).
+            SocketAddress     destination;  // Destination socket address (UDP output only).
+            PacketCounter     packets;      // Total number of output packets.
+        };
+        typedef SafePtr<SPTS> SPTSPtr;
+
+        // Command line options.
+        std::vector<Service> _services;       // Services to split, all services in PAT if empty.
+        UString              _file_template;  // Output file name template.
+        UString              _udp_dest;       // UDP base destination.
+        UString              _local_addr;     // Local address for multicast.
+        int                  _ttl;            // Time to live option.
+        size_t               _buffer_size;    // Number of buffered packets per SPTS.
+        bool                 _drop;           // Drop all packets from main stream after splitting.
+
+        // Working data.
+        bool                 _abort;          // Error, abort asap.
+        SectionDemux         _demux;          // Section demux for the PSI of the MPTS.
+        UDPSocket            _sock;           // Output socket, shared by all SPTS.
+        SocketAddress        _udp_base;       // UDP base destination address and port.
+        uint16_t             _next_port;      // Next UDP port to allocate.
+        std::vector<SPTSPtr> _spts;           // All SPTS, index is bit number in masks.
+        ServiceMask          _pid_mask[PID_MAX];  // For each PID, mask of SPTS which pass the packets.
+        ServiceMask          _pmt_mask[PID_MAX];  // For each PID, mask of SPTS which use it as PMT PID.
+
+        // Invoked by the demux when a complete table is available.
+        virtual void handleTable(SectionDemux&, const BinaryTable&) override;
+
+        // Process specific tables.
+        void processPAT(const PAT&);
+        void processPMT(const PMT&, PID);
+        void processSDT(const SDT&);
+
+        // Check if a service is selected by the command line.
+        bool isSelected(uint16_t service_id) const;
+
+        // Get the index of the SPTS for a service id, allocate it if necessary. Return MAX_SERVICES on error.
+        size_t getSPTS(uint16_t service_id);
+
+        // Clear a service from all PID masks.
+        void clearPIDs(size_t index);
+
+        // Mark all ECM PIDs from a descriptor list in a PID mask.
+        void addECMPIDs(const DescriptorList& dlist, ServiceMask mask);
+
+        // Push a packet into an SPTS, flush the SPTS buffer when full.
+        bool pushPacket(SPTS& spts, const TSPacket& pkt);
+        bool flush(SPTS& spts);
+    };
+}
+
+TSPLUGIN_DECLARE_VERSION
+TSPLUGIN_DECLARE_PROCESSOR(svsplit, ts::SVSplitPlugin)
+
+constexpr size_t ts::SVSplitPlugin::MAX_SERVICES;
+constexpr size_t ts::SVSplitPlugin::DEF_FILE_BUFFER;
+
+
+//----------------------------------------------------------------------------
+// Constructors
+//----------------------------------------------------------------------------
+
+ts::SVSplitPlugin::SVSplitPlugin(TSP* tsp_) :
+    ProcessorPlugin(tsp_, u"Split an MPTS into several SPTS, one per service, in one single pass", u"[options]"),
+    _services(),
+    _file_template(),
+    _udp_dest(),
+    _local_addr(),
+    _ttl(0),
+    _buffer_size(0),
+    _drop(false),
+    _abort(false),
+    _demux(duck, this),
+    _sock(false, *tsp_),
+    _udp_base(),
+    _next_port(0),
+    _spts(),
+    _pid_mask(),
+    _pmt_mask()
+{
+    option(u"buffered-packets", 'b', POSITIVE);
+    help(u"buffered-packets",
+         u"Specifies the number of packets which are buffered for each SPTS before being written. "
+         u"With --output-files, the default is " + UString::Decimal(DEF_FILE_BUFFER) + u" packets. "
+         u"With --udp, this is the number of TS packets per UDP datagram and the default is 7.");
+
+    option(u"drop", 'd');
+    help(u"drop",
+         u"Drop all packets from the main transport stream after splitting them. "
+         u"By default, the main transport stream is passed unmodified.");
+
+    option(u"local-address", 'l', STRING);
+    help(u"local-address",
+         u"With --udp, when the destination is a multicast address, specify the IP address "
+         u"of the outgoing local interface. It can be also a host name that translates to a local address.");
+
+    option(u"output-files", 'o', STRING);
+    help(u"output-files", u"template",
+         u"Write each SPTS in a file. The template is used to build the file name of each SPTS. "
+         u"All occurences of the character '%' in the template are replaced by the service id in decimal. "
+         u"Example: --output-files 'spts-%.ts'. "
+         u"Exactly one of --output-files and --udp must be specified.");
+
+    option(u"service", 's', STRING, 0, UNLIMITED_COUNT);
+    help(u"service", u"name-or-id",
+         u"Specifies a service to split. If the argument is an integer value (either "
+         u"decimal or hexadecimal), it is interpreted as a service id. Otherwise, it "
+         u"is interpreted as a service name, as specified in the SDT. The name is not "
+         u"case sensitive and blanks are ignored. Several --service options may be specified. "
+         u"By default, all services of the PAT are split, up to " + UString::Decimal(MAX_SERVICES) + u" services.");
+
+    option(u"ttl", 't', INTEGER, 0, 1, 1, 255);
+    help(u"ttl", u"With --udp, specifies the TTL (Time-To-Live) socket option.");
+
+    option(u"udp", 'u', STRING);
+    help(u"udp", u"address:port",
+         u"Send each SPTS over UDP. The address specifies an IP address which can be either unicast or multicast. "
+         u"It can be also a host name that translates to an IP address. The port specifies the base destination UDP port. "
+         u"Each SPTS is sent on its own port. Ports are allocated in sequence, starting at the base port, "
+         u"in the order of discovery of the services. "
+         u"Exactly one of --output-files and --udp must be specified.");
+}
+
+ts::SVSplitPlugin::SPTS::SPTS(uint16_t id, size_t buffer_size) :
+    service_id(id),
+    pmt_pid(PID_NULL),
+    has_pat(false),
+    has_pmt(false),
+    has_sdt(false),
+    pzer_pat(PID_PAT, CyclingPacketizer::ALWAYS),
+    pzer_pmt(PID_NULL, CyclingPacketizer::ALWAYS),
+    pzer_sdt(PID_SDT, CyclingPacketizer::ALWAYS),
+    buffer(buffer_size),
+    buffer_count(0),
+    file(),
+    destination(),
+    packets(0)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Get options method
+//----------------------------------------------------------------------------
+
+bool ts::SVSplitPlugin::getOptions()
+{
+    UStringVector services;
+    getValues(services, u"service");
+    getValue(_file_template, u"output-files");
+    getValue(_udp_dest, u"udp");
+    getValue(_local_addr, u"local-address");
+    _ttl = intValue<int>(u"ttl", 0);
+    _drop = present(u"drop");
+
+    if (_file_template.empty() == _udp_dest.empty()) {
+        tsp->error(u"specify exactly one of --output-files and --udp");
+        return false;
+    }
+    if (!_file_template.empty() && !_file_template.contain(u'%')) {
+        tsp->error(u"the template of --output-files must contain a '%'");
+        return false;
+    }
+    if (services.size() > MAX_SERVICES) {
+        tsp->error(u"too many services, at most %d services can be split", {MAX_SERVICES});
+        return false;
+    }
+
+    _buffer_size = intValue<size_t>(u"buffered-packets", _udp_dest.empty() ? DEF_FILE_BUFFER : 7);
+
+    _services.clear();
+    for (auto it = services.begin(); it != services.end(); ++it) {
+        _services.push_back(Service(*it));
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Start method
+//----------------------------------------------------------------------------
+
+bool ts::SVSplitPlugin::start()
+{
+    // Open the UDP socket, shared by all output SPTS.
+    if (!_udp_dest.empty()) {
+        if (!_udp_base.resolve(_udp_dest, *tsp)) {
+            return false;
+        }
+        if (!_udp_base.hasAddress() || !_udp_base.hasPort()) {
+            tsp->error(u"missing address or port in --udp %s", {_udp_dest});
+            return false;
+        }
+        if (!_sock.open(*tsp) ||
+            (!_local_addr.empty() && !_sock.setOutgoingMulticast(_local_addr, *tsp)) ||
+            (_ttl > 0 && !_sock.setTTL(_ttl, _udp_base.isMulticast(), *tsp)))
+        {
+            _sock.close(*tsp);
+            return false;
+        }
+        _next_port = _udp_base.port();
+    }
+
+    // Clear name-based service ids from a previous run.
+    for (auto it = _services.begin(); it != _services.end(); ++it) {
+        if (it->hasName()) {
+            it->clearId();
+        }
+    }
+
+    // Reset all PID masks.
+    ::memset(_pid_mask, 0, sizeof(_pid_mask));
+    ::memset(_pmt_mask, 0, sizeof(_pmt_mask));
+
+    _spts.clear();
+    _abort = false;
+    _demux.reset();
+    _demux.addPID(PID_PAT);
+    _demux.addPID(PID_SDT);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Stop method
+//----------------------------------------------------------------------------
+
+bool ts::SVSplitPlugin::stop()
+{
+    // Flush and close all SPTS.
+    for (auto it = _spts.begin(); it != _spts.end(); ++it) {
+        SPTS& spts(**it);
+        flush(spts);
+        if (spts.file.isOpen()) {
+            spts.file.close(*tsp);
+        }
+        tsp->verbose(u"service 0x%X (%d): %'d packets", {spts.service_id, spts.service_id, spts.packets});
+    }
+    _spts.clear();
+
+    if (_sock.isOpen()) {
+        _sock.close(*tsp);
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Invoked by the demux when a complete table is available.
+//----------------------------------------------------------------------------
+
+void ts::SVSplitPlugin::handleTable(SectionDemux& demux, const BinaryTable& table)
+{
+    switch (table.tableId()) {
+
+        case TID_PAT: {
+            if (table.sourcePID() == PID_PAT) {
+                PAT pat(duck, table);
+                if (pat.isValid()) {
+                    processPAT(pat);
+                }
+            }
+            break;
+        }
+
+        case TID_PMT: {
+            PMT pmt(duck, table);
+            if (pmt.isValid()) {
+                processPMT(pmt, table.sourcePID());
+            }
+            break;
+        }
+
+        case TID_SDT_ACT: {
+            if (table.sourcePID() == PID_SDT) {
+                SDT sdt(duck, table);
+                if (sdt.isValid()) {
+                    processSDT(sdt);
+                }
+            }
+            break;
+        }
+
+        default: {
+            break;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Check if a service is selected by the command line.
+//----------------------------------------------------------------------------
+
+bool ts::SVSplitPlugin::isSelected(uint16_t service_id) const
+{
+    if (_services.empty()) {
+        return true;
+    }
+    for (auto it = _services.begin(); it != _services.end(); ++it) {
+        if (it->hasId(service_id)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Get the index of the SPTS for a service id, allocate it if necessary.
+//----------------------------------------------------------------------------
+
+size_t ts::SVSplitPlugin::getSPTS(uint16_t service_id)
+{
+    // Look for an existing SPTS. There are only a few of them, a linear search is fine.
+    for (size_t i = 0; i < _spts.size(); ++i) {
+        if (_spts[i]->service_id == service_id) {
+            return i;
+        }
+    }
+
+    if (_spts.size() >= MAX_SERVICES) {
+        tsp->warning(u"too many services, ignoring service 0x%X (%d)", {service_id, service_id});
+        return MAX_SERVICES;
+    }
+
+    // Allocate a new SPTS.
+    SPTSPtr spts(new SPTS(service_id, _buffer_size));
+    CheckNonNull(spts.pointer());
+
+    if (!_file_template.empty()) {
+        const UString name(_file_template.toSubstituted(u"%", UString::Decimal(service_id, 0, true, UString())));
+        if (!spts->file.open(name, TSFile::WRITE | TSFile::SHARED, *tsp)) {
+            _abort = true;
+            return MAX_SERVICES;
+        }
+        tsp->verbose(u"service 0x%X (%d) written in %s", {service_id, service_id, name});
+    }
+    else {
+        spts->destination = SocketAddress(_udp_base, _next_port++);
+        tsp->verbose(u"service 0x%X (%d) sent to %s", {service_id, service_id, spts->destination});
+    }
+
+    _spts.push_back(spts);
+    return _spts.size() - 1;
+}
+
+
+//----------------------------------------------------------------------------
+// Clear a service from all PID masks.
+//----------------------------------------------------------------------------
+
+void ts::SVSplitPlugin::clearPIDs(size_t index)
+{
+    const ServiceMask mask = ~(ServiceMask(1) << index);
+    for (PID pid = 0; pid < PID_MAX; ++pid) {
+        _pid_mask[pid] &= mask;
+        _pmt_mask[pid] &= mask;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Process a PAT: allocate SPTS, build one PAT per SPTS.
+//----------------------------------------------------------------------------
+
+void ts::SVSplitPlugin::processPAT(const PAT& pat)
+{
+    for (auto it = pat.pmts.begin(); !_abort && it != pat.pmts.end(); ++it) {
+
+        const uint16_t service_id = it->first;
+        const PID pmt_pid = it->second;
+        if (!isSelected(service_id)) {
+            continue;
+        }
+        const size_t index = getSPTS(service_id);
+        if (index >= MAX_SERVICES) {
+            continue;
+        }
+        SPTS& spts(*_spts[index]);
+        const ServiceMask bit = ServiceMask(1) << index;
+
+        // If the PMT PID changed, all components of the service must be rediscovered.
+        if (spts.pmt_pid != pmt_pid) {
+            clearPIDs(index);
+            spts.pmt_pid = pmt_pid;
+            spts.has_pmt = false;
+            spts.pzer_pmt.reset();
+            spts.pzer_pmt.setPID(pmt_pid);
+            _pmt_mask[pmt_pid] |= bit;
+            _pid_mask[PID_TDT] |= bit;
+            _demux.addPID(pmt_pid);
+        }
+
+        // Build a PAT containing only this service.
+        PAT spat(pat.version, true, pat.ts_id, PID_NULL);
+        spat.pmts[service_id] = pmt_pid;
+        spts.pzer_pat.removeAll();
+        spts.pzer_pat.addTable(duck, spat);
+        spts.has_pat = true;
+    }
+
+    // Services which disappeared from the PAT no longer pass any PID.
+    for (size_t index = 0; index < _spts.size(); ++index) {
+        SPTS& spts(*_spts[index]);
+        if (spts.pmt_pid != PID_NULL && pat.pmts.find(spts.service_id) == pat.pmts.end()) {
+            tsp->verbose(u"service 0x%X (%d) removed from PAT", {spts.service_id, spts.service_id});
+            clearPIDs(index);
+            spts.pmt_pid = PID_NULL;
+            spts.has_pat = false;
+            spts.has_pmt = false;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Process a PMT: compute the PID mask of the service.
+//----------------------------------------------------------------------------
+
+void ts::SVSplitPlugin::processPMT(const PMT& pmt, PID pid)
+{
+    for (size_t index = 0; index < _spts.size(); ++index) {
+        SPTS& spts(*_spts[index]);
+        if (spts.service_id != pmt.service_id || spts.pmt_pid != pid) {
+            continue;
+        }
+
+        // Recompute all PIDs of the service. This is done only on PMT change, not per packet.
+        const ServiceMask bit = ServiceMask(1) << index;
+        clearPIDs(index);
+        _pmt_mask[spts.pmt_pid] |= bit;
+        _pid_mask[PID_TDT] |= bit;
+        if (pmt.pcr_pid != PID_NULL) {
+            _pid_mask[pmt.pcr_pid] |= bit;
+        }
+        addECMPIDs(pmt.descs, bit);
+        for (auto it = pmt.streams.begin(); it != pmt.streams.end(); ++it) {
+            _pid_mask[it->first] |= bit;
+            addECMPIDs(it->second.descs, bit);
+        }
+
+        // The PMT is copied unmodified, but with its own continuity counters.
+        spts.pzer_pmt.removeAll();
+        spts.pzer_pmt.addTable(duck, pmt);
+        spts.has_pmt = true;
+        break;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Process an SDT: resolve service names, build one SDT per SPTS.
+//----------------------------------------------------------------------------
+
+void ts::SVSplitPlugin::processSDT(const SDT& sdt)
+{
+    // Resolve services which are specified by name.
+    bool new_ids = false;
+    for (auto it = _services.begin(); it != _services.end(); ++it) {
+        uint16_t service_id = 0;
+        if (it->hasName() && !it->hasId() && sdt.findService(duck, it->getName(), service_id)) {
+            tsp->verbose(u"found service \"%s\", service id 0x%X (%d)", {it->getName(), service_id, service_id});
+            it->setId(service_id);
+            new_ids = true;
+        }
+    }
+
+    // If new service ids are known, the PAT must be analyzed again.
+    if (new_ids) {
+        _demux.resetPID(PID_PAT);
+    }
+
+    // Build an SDT with one service for each SPTS.
+    for (auto it = _spts.begin(); it != _spts.end(); ++it) {
+        SPTS& spts(**it);
+        SDT ssdt(sdt);
+        auto srv = ssdt.services.find(spts.service_id);
+        if (srv == ssdt.services.end()) {
+            ssdt.services.clear();
+        }
+        else {
+            ssdt.services.erase(ssdt.services.begin(), srv);
+            srv = ssdt.services.begin();
+            ssdt.services.erase(++srv, ssdt.services.end());
+        }
+        spts.pzer_sdt.removeAll();
+        spts.pzer_sdt.addTable(duck, ssdt);
+        spts.has_sdt = true;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Mark all ECM PIDs from a descriptor list in a PID mask.
+//----------------------------------------------------------------------------
+
+void ts::SVSplitPlugin::addECMPIDs(const DescriptorList& dlist, ServiceMask mask)
+{
+    for (size_t index = dlist.search(DID_CA); index < dlist.count(); index = dlist.search(DID_CA, index + 1)) {
+        CADescriptor ca(duck, *dlist[index]);
+        if (ca.isValid()) {
+            _pid_mask[ca.ca_pid] |= mask;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Push a packet into an SPTS, flush the SPTS buffer when full.
+//----------------------------------------------------------------------------
+
+bool ts::SVSplitPlugin::pushPacket(SPTS& spts, const TSPacket& pkt)
+{
+    assert(spts.buffer_count < spts.buffer.size());
+    spts.buffer[spts.buffer_count++] = pkt;
+    return spts.buffer_count < spts.buffer.size() || flush(spts);
+}
+
+bool ts::SVSplitPlugin::flush(SPTS& spts)
+{
+    bool ok = true;
+    if (spts.buffer_count > 0) {
+        if (spts.file.isOpen()) {
+            ok = spts.file.write(spts.buffer.data(), spts.buffer_count, *tsp);
+        }
+        else if (_sock.isOpen()) {
+            ok = _sock.send(spts.buffer.data(), spts.buffer_count * PKT_SIZE, spts.destination, *tsp);
+        }
+        spts.packets += spts.buffer_count;
+        spts.buffer_count = 0;
+    }
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Packet processing method
+//----------------------------------------------------------------------------
+
+ts::ProcessorPlugin::Status ts::SVSplitPlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
+{
+    const PID pid = pkt.getPID();
+    bool ok = true;
+
+    // Parse the PSI of the MPTS, once for all services.
+    _demux.feedPacket(pkt);
+    if (_abort) {
+        return TSP_END;
+    }
+
+    if (pid == PID_PAT || pid == PID_SDT) {
+        // Replace each PAT or SDT/BAT packet by the next packet of the SPTS-specific table.
+        TSPacket tmp;
+        for (auto it = _spts.begin(); ok && it != _spts.end(); ++it) {
+            SPTS& spts(**it);
+            if (pid == PID_PAT && spts.has_pat) {
+                spts.pzer_pat.getNextPacket(tmp);
+                ok = pushPacket(spts, tmp);
+            }
+            else if (pid == PID_SDT && spts.has_sdt) {
+                spts.pzer_sdt.getNextPacket(tmp);
+                ok = pushPacket(spts, tmp);
+            }
+        }
+    }
+    else {
+        // Replace PMT packets by the next packet of the SPTS-specific PMT.
+        ServiceMask mask = _pmt_mask[pid];
+        for (size_t index = 0; ok && mask != 0; ++index, mask >>= 1) {
+            if ((mask & 1) != 0 && _spts[index]->has_pmt) {
+                TSPacket tmp;
+                _spts[index]->pzer_pmt.getNextPacket(tmp);
+                ok = pushPacket(*_spts[index], tmp);
+            }
+        }
+        // Copy all other packets of each service, as is. One single table lookup per packet.
+        mask = _pid_mask[pid];
+        for (size_t index = 0; ok && mask != 0; ++index, mask >>= 1) {
+            if ((mask & 1) != 0) {
+                ok = pushPacket(*_spts[index], pkt);
+            }
+        }
+    }
+
+    if (!ok) {
+        return TSP_END;
+    }
+    return _drop ? TSP_DROP : TSP_OK;
+}
@@ -55,6 +55,9 @@ namespace ts {
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
 
     private:
+        // In sampling mode (overload), log one table out of this number.
+        static constexpr size_t SAMPLING_RATE = 10;
+
         TablesDisplay _display;
         TablesLogger  _logger;
     };
@@ -63,6 +66,10 @@ namespace ts {
 TSPLUGIN_DECLARE_VERSION
 TSPLUGIN_DECLARE_PROCESSOR(tables, ts::TablesPlugin)
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::TablesPlugin::SAMPLING_RATE;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Constructor
@@ -101,6 +108,9 @@ bool ts::TablesPlugin::start()
 bool ts::TablesPlugin::stop()
 {
     _logger.close();
+    if (_logger.sampledCount() > 0) {
+        tsp->info(u"%'d tables not logged in sampling mode (overload)", {_logger.sampledCount()});
+    }
     return true;
 }
 
@@ -111,6 +121,7 @@ bool ts::TablesPlugin::stop()
 
 ts::ProcessorPlugin::Status ts::TablesPlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
 {
+    _logger.setSampling(tsp->sampling() ? SAMPLING_RATE : 0);
     _logger.feedPacket(pkt);
     return _logger.completed() ? TSP_END : TSP_OK;
 }
@@ -76,6 +76,7 @@ namespace ts {
         bool              _relative;     // Use relative time from the beginning
         bool              _use_utc;      // Use UTC time
         bool              _use_tdt;      // Use TDT as time reference
+        Time              _start_time;   // Time at start, origin of stream time
         Time              _last_time;    // Last measured time
         const Enumeration _status_names; // Names of packet status
         SectionDemux      _demux;        // Section filter
@@ -104,6 +105,7 @@ ts::TimePlugin::TimePlugin (TSP* tsp_) :
     _relative(false),
     _use_utc(false),
     _use_tdt(false),
+    _start_time(Time::Epoch),
     _last_time(Time::Epoch),
     _status_names({{u"pass", TSP_OK}, {u"stop", TSP_END}, {u"drop", TSP_DROP}, {u"null", TSP_NULL}}),
     _demux(duck, this),
@@ -135,7 +137,9 @@ ts::TimePlugin::TimePlugin (TSP* tsp_) :
          u"All time values are interpreted as a number of seconds relative to the "
          u"tsp start time. By default, all time values are interpreted as an "
          u"absolute time in the format \"year/month/day:hour:minute:second\". "
-         u"Option --relative is incompatible with --tdt or --utc.");
+         u"Option --relative is incompatible with --tdt or --utc. "
+         u"With the tsp option --stream-time, unless --tdt is specified, the time "
+         u"advances with the stream time, starting at the tsp start time.");
 
     option(u"stop", 's', STRING);
     help(u"stop", u"Packet transmission stops after the specified time and tsp terminates.");
@@ -170,6 +174,9 @@ bool ts::TimePlugin::start()
         return false;
     }
 
+    // Origin of relative times and stream time.
+    _start_time = _use_utc ? Time::CurrentUTC() : Time::CurrentLocalTime();
+
     // Get list of time events
     _events.clear();
     if (!addEvents(u"drop", TSP_DROP) ||
@@ -210,8 +217,6 @@ bool ts::TimePlugin::start()
 
 bool ts::TimePlugin::addEvents(const UChar* option, Status status)
 {
-    const Time start_time(Time::CurrentLocalTime());
-
     for (size_t index = 0; index < count(option); ++index) {
         const UString timeString(value(option, u"", index));
         if (timeString.empty()) {
@@ -225,7 +230,7 @@ bool ts::TimePlugin::addEvents(const UChar* option, Status status)
                 tsp->error(u"invalid relative number of seconds: %s", {timeString});
                 return false;
             }
-            _events.push_back(TimeEvent(status, start_time + second * MilliSecPerSec));
+            _events.push_back(TimeEvent(status, _start_time + second * MilliSecPerSec));
         }
         else {
             // Decode an absolute time string
@@ -269,8 +274,14 @@ ts::ProcessorPlugin::Status ts::TimePlugin::processPacket(TSPacket& pkt, TSPacke
     // Filter sections
     _demux.feedPacket(pkt);
 
-    // Get current system time (unless TDT is used as reference)
-    if (!_use_tdt) {
+    // Get current system time or stream time (unless TDT is used as reference)
+    if (_use_tdt) {
+        // Already updated by the demux.
+    }
+    else if (tsp->useStreamTime() && pkt_data.hasInputTimeStamp()) {
+        _last_time = _start_time + pkt_data.getInputTimeStampMS();
+    }
+    else {
         _last_time = _use_utc ? Time::CurrentUTC() : Time::CurrentLocalTime();
     }
 
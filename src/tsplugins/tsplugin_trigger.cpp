@@ -37,16 +37,22 @@
 #include "tsForkPipe.h"
 #include "tsByteBlock.h"
 #include "tsUDPSocket.h"
+#include "tsMessageQueue.h"
+#include "tsThread.h"
 #include "tsTime.h"
 TSDUCK_SOURCE;
 
+#define DEFAULT_MAX_QUEUED_EVENTS  1000          // Default size of the queue of events to the action thread.
+#define MAX_BATCH_EVENTS           256           // Max number of events which are processed at once by the action thread.
+#define ACTION_THREAD_STACK_SIZE   (128 * 1024)  // Stack size of the action thread.
+
 
 //----------------------------------------------------------------------------
 // Plugin definition
 //----------------------------------------------------------------------------
 
 namespace ts {
-    class TriggerPlugin: public ProcessorPlugin
+    class TriggerPlugin: public ProcessorPlugin, private Thread
     {
         TS_NOBUILD_NOCOPY(TriggerPlugin);
     public:
@@ -58,14 +64,32 @@ namespace ts {
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
 
     private:
+        // Description of an event, passed from the plugin thread to the action thread.
+        class Event
+        {
+        public:
+            Event(const UChar* type_, PacketCounter index_, PID pid_, const TSPacketMetadata::LabelSet& labels_);
+            const UChar*               type;    // Event type: "start", "packet", "stop".
+            PacketCounter              index;   // Index of the packet in the stream.
+            PID                        pid;     // PID of the packet, PID_MAX on start and stop.
+            TSPacketMetadata::LabelSet labels;  // Labels of the packet.
+            Time                       time;    // UTC time of the event.
+        };
+        typedef MessageQueue<Event, Mutex> EventQueue;
+        typedef std::vector<EventQueue::MessagePtr> EventVector;
+
         // Command line options:
         PacketCounter              _minInterPacket; // Minimum interval in packets between two actions.
         MilliSecond                _minInterTime;   // Minimum interval in milliseconds between two actions.
         UString                    _execute;        // Command to execute on trigger.
+        UString                    _pipeCommand;    // Persistent command which receives all events.
         UString                    _udpDestination; // UDP/IP destination address:port.
         UString                    _udpLocal;       // Name of outgoing local address (empty if unspecified).
         ByteBlock                  _udpMessage;     // What to send as UDP message.
+        bool                       _udpJSON;        // Send JSON event records as UDP messages.
+        size_t                     _udpBatch;       // Max number of events per UDP datagram.
         int                        _udpTTL;         // Time-to-live socket option.
+        size_t                     _maxQueued;      // Max number of queued events.
         bool                       _onStart;        // Trigger action on start.
         bool                       _onStop;         // Trigger action on stop.
         bool                       _allPackets;     // Trigger on all packets in the stream.
@@ -75,10 +99,24 @@ namespace ts {
         // Working data:
         PacketCounter _lastPacket;    // Last action packet.
         Time          _lastTime;      // UTC time of last action.
-        UDPSocket     _sock;          // Output socket.
+        PacketCounter _dropped;       // Number of dropped events, when the action thread is too slow.
+        EventQueue    _events;        // Queue of events to the action thread.
+        UDPSocket     _sock;          // Output socket, used in the action thread.
+        ForkPipe      _pipe;          // Pipe to the persistent command, used in the action thread.
+        std::string   _pipeBuffer;    // Batch of records to send to the persistent command.
+        ByteBlock     _udpBuffer;     // Batch of messages to send in one UDP datagram.
+
+        // Trigger the actions, in the plugin thread.
+        void trigger(const UChar* type, PID pid, const TSPacketMetadata::LabelSet& labels);
 
-        // Trigger the actions (exec, UDP).
-        void trigger();
+        // Implementation of Thread: the action thread.
+        virtual void main() override;
+
+        // Execute the actions for a batch of events, in the action thread.
+        void execute(const EventVector& batch);
+
+        // Build the JSON record for an event.
+        static std::string JSONRecord(const Event& event);
     };
 }
 
@@ -87,18 +125,32 @@ TSPLUGIN_DECLARE_PROCESSOR(trigger, ts::TriggerPlugin)
 
 
 //----------------------------------------------------------------------------
-// Constructor
+// Constructors
 //----------------------------------------------------------------------------
 
+ts::TriggerPlugin::Event::Event(const UChar* type_, PacketCounter index_, PID pid_, const TSPacketMetadata::LabelSet& labels_) :
+    type(type_),
+    index(index_),
+    pid(pid_),
+    labels(labels_),
+    time(Time::CurrentUTC())
+{
+}
+
 ts::TriggerPlugin::TriggerPlugin(TSP* tsp_) :
     ProcessorPlugin(tsp_, u"Trigger actions on selected TS packets", u"[options]"),
+    Thread(ThreadAttributes().setStackSize(ACTION_THREAD_STACK_SIZE)),
     _minInterPacket(0),
     _minInterTime(0),
     _execute(),
+    _pipeCommand(),
     _udpDestination(),
     _udpLocal(),
     _udpMessage(),
+    _udpJSON(false),
+    _udpBatch(1),
     _udpTTL(0),
+    _maxQueued(DEFAULT_MAX_QUEUED_EVENTS),
     _onStart(false),
     _onStop(false),
     _allPackets(false),
@@ -106,7 +158,12 @@ ts::TriggerPlugin::TriggerPlugin(TSP* tsp_) :
     _labels(),
     _lastPacket(INVALID_PACKET_COUNTER),
     _lastTime(),
-    _sock(false, *tsp)
+    _dropped(0),
+    _events(DEFAULT_MAX_QUEUED_EVENTS),
+    _sock(false, *tsp),
+    _pipe(),
+    _pipeBuffer(),
+    _udpBuffer()
 {
     option(u"all-labels", 'a');
     help(u"all-labels",
@@ -115,7 +172,8 @@ ts::TriggerPlugin::TriggerPlugin(TSP* tsp_) :
 
     option(u"execute", 'e', STRING);
     help(u"execute", u"'command'",
-         u"Run the specified command when the current packet triggers the actions.");
+         u"Run the specified command when the current packet triggers the actions. "
+         u"A new process is created for each action. With frequent actions, prefer option --pipe.");
 
     option(u"label", 'l', INTEGER, 0, UNLIMITED_COUNT, 0, TSPacketMetadata::LABEL_MAX);
     help(u"label", u"label1[-label2]",
@@ -130,6 +188,13 @@ ts::TriggerPlugin::TriggerPlugin(TSP* tsp_) :
          u"is specific to the trigger plugin and selects packets with specific labels "
          u"among the packets which are passed to this plugin.");
 
+    option(u"max-queue", 0, POSITIVE);
+    help(u"max-queue", u"count",
+         u"The actions are executed in a separate thread and never block the transport stream processing. "
+         u"This option specifies the maximum number of queued events, waiting for their actions to be executed. "
+         u"When the queue is full, new events are dropped. "
+         u"The default is " TS_STRINGIFY(DEFAULT_MAX_QUEUED_EVENTS) u".");
+
     option(u"min-inter-packet", 0, UNSIGNED);
     help(u"min-inter-packet", u"count",
          u"Specify the minimum number of packets between two triggered actions. "
@@ -140,6 +205,15 @@ ts::TriggerPlugin::TriggerPlugin(TSP* tsp_) :
          u"Specify the minimum time, in milliseconds, between two triggered actions. "
          u"Actions which should be triggered in the meantime are ignored.");
 
+    option(u"pipe", 'p', STRING);
+    help(u"pipe", u"'command'",
+         u"Start the specified command once, when the plugin starts, and send a description "
+         u"of each event on its standard input. Each event is described by a JSON record, "
+         u"on one line. Example: "
+         u"{\"event\": \"packet\", \"packet-index\": 1234, \"pid\": 256, \"time\": \"2020/06/26 11:32:10.275\", \"labels\": [1, 4]}. "
+         u"The event type is one of \"start\", \"packet\" or \"stop\". "
+         u"The standard input of the command is closed when the plugin stops.");
+
     option(u"udp", 'u', STRING);
     help(u"udp", u"address:port",
          u"Send a UDP/IP message to the specified destination when the current packet triggers the actions. "
@@ -147,6 +221,18 @@ ts::TriggerPlugin::TriggerPlugin(TSP* tsp_) :
          u"It can be also a host name that translates to an IP address. "
          u"The 'port' specifies the destination UDP port.");
 
+    option(u"udp-batch", 0, POSITIVE);
+    help(u"udp-batch", u"count",
+         u"With --udp, when several events are pending, group up to the specified number of "
+         u"messages in one UDP datagram. The messages are concatenated. With --udp-json, "
+         u"each JSON record is terminated by a new-line character. "
+         u"By default, each message is sent in its own datagram.");
+
+    option(u"udp-json");
+    help(u"udp-json",
+         u"With --udp, send the JSON record which describes the event as UDP message. "
+         u"See option --pipe for the format of the JSON record.");
+
     option(u"udp-message", 0, STRING);
     help(u"udp-message", u"hexa-string",
          u"With --udp, specifies the binary message to send as UDP datagram. "
@@ -182,10 +268,14 @@ bool ts::TriggerPlugin::getOptions()
     getIntValue(_minInterTime, u"min-inter-time");
     getIntValue(_minInterPacket, u"min-inter-packet");
     getValue(_execute, u"execute");
+    getValue(_pipeCommand, u"pipe");
     getValue(_udpDestination, u"udp");
     getValue(_udpLocal, u"local-address");
     getIntValue(_udpTTL, u"ttl");
+    getIntValue<size_t>(_udpBatch, u"udp-batch", 1);
+    getIntValue<size_t>(_maxQueued, u"max-queue", DEFAULT_MAX_QUEUED_EVENTS);
     getIntValues(_labels, u"label");
+    _udpJSON = present(u"udp-json");
     _onStart = present(u"start");
     _onStop = present(u"stop");
     _allLabels = present(u"all-labels");
@@ -208,6 +298,9 @@ bool ts::TriggerPlugin::start()
 {
     _lastPacket = INVALID_PACKET_COUNTER;
     _lastTime = Time::Epoch;
+    _dropped = 0;
+    _events.clear();
+    _events.setMaxMessages(_maxQueued);
 
     // Initialize UDP output.
     if (!_udpDestination.empty()) {
@@ -223,9 +316,20 @@ bool ts::TriggerPlugin::start()
         }
     }
 
+    // Start the persistent command.
+    if (!_pipeCommand.empty() && !_pipe.open(_pipeCommand, ForkPipe::SYNCHRONOUS, 0, *tsp, ForkPipe::KEEP_BOTH, ForkPipe::STDIN_PIPE)) {
+        if (_sock.isOpen()) {
+            _sock.close(*tsp);
+        }
+        return false;
+    }
+
+    // Start the action thread.
+    Thread::start();
+
     // Initial trigger.
     if (_onStart) {
-        trigger();
+        trigger(u"start", PID_MAX, TSPacketMetadata::LabelSet());
     }
     return true;
 }
@@ -239,9 +343,20 @@ bool ts::TriggerPlugin::stop()
 {
     // Final trigger.
     if (_onStop) {
-        trigger();
+        trigger(u"stop", PID_MAX, TSPacketMetadata::LabelSet());
     }
 
+    // A null pointer is the termination message of the action thread.
+    // All previous events are processed before.
+    _events.forceEnqueue(nullptr);
+    Thread::waitForTermination();
+
+    if (_dropped > 0) {
+        tsp->warning(u"%'d events dropped, actions were too slow", {_dropped});
+    }
+    if (_pipe.isOpen()) {
+        _pipe.close(*tsp);
+    }
     if (_sock.isOpen()) {
         _sock.close(*tsp);
     }
@@ -267,7 +382,7 @@ ts::ProcessorPlugin::Status ts::TriggerPlugin::processPacket(TSPacket& pkt, TSPa
         tsp->debug(u"triggering action, packet %'d", {tsp->pluginPackets()});
         _lastTime = now == Time::Epoch ? Time::CurrentUTC() : now;
         _lastPacket = tsp->pluginPackets();
-        trigger();
+        trigger(u"packet", pkt.getPID(), pkt_data.getLabels());
     }
 
     return TSP_OK;
@@ -275,18 +390,111 @@ ts::ProcessorPlugin::Status ts::TriggerPlugin::processPacket(TSPacket& pkt, TSPa
 
 
 //----------------------------------------------------------------------------
-// Trigger the actions (exec, UDP).
+// Trigger the actions, in the plugin thread.
+//----------------------------------------------------------------------------
+
+void ts::TriggerPlugin::trigger(const UChar* type, PID pid, const TSPacketMetadata::LabelSet& labels)
+{
+    // Never wait for the action thread.
+    if (!_events.enqueue(new Event(type, tsp->pluginPackets(), pid, labels), 0)) {
+        _dropped++;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Action thread.
+//----------------------------------------------------------------------------
+
+void ts::TriggerPlugin::main()
+{
+    tsp->debug(u"action thread started");
+
+    EventVector batch;
+    bool terminate = false;
+
+    while (!terminate) {
+        // Wait for one event, then get all pending events.
+        EventQueue::MessagePtr event;
+        _events.dequeue(event);
+        terminate = event.isNull();
+        while (!terminate) {
+            batch.push_back(event);
+            if (batch.size() >= MAX_BATCH_EVENTS || !_events.dequeue(event, 0)) {
+                break;
+            }
+            terminate = event.isNull();
+        }
+        execute(batch);
+        batch.clear();
+    }
+
+    tsp->debug(u"action thread completed");
+}
+
+
+//----------------------------------------------------------------------------
+// Execute the actions for a batch of events, in the action thread.
 //----------------------------------------------------------------------------
 
-void ts::TriggerPlugin::trigger()
+void ts::TriggerPlugin::execute(const EventVector& batch)
 {
-    // Execute external command.
+    // Execute external command, once per event.
     if (!_execute.empty()) {
-        ForkPipe::Launch(_execute, *tsp, ForkPipe::STDERR_ONLY, ForkPipe::STDIN_NONE);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            ForkPipe::Launch(_execute, *tsp, ForkPipe::STDERR_ONLY, ForkPipe::STDIN_NONE);
+        }
     }
 
-    // Send message over a socket.
+    // Send all event records to the persistent command at once.
+    if (_pipe.isOpen() && !_pipe.isBroken() && !batch.empty()) {
+        _pipeBuffer.clear();
+        for (const auto& event : batch) {
+            _pipeBuffer.append(JSONRecord(*event));
+            _pipeBuffer.push_back('\n');
+        }
+        _pipe.write(_pipeBuffer.data(), _pipeBuffer.size(), *tsp);
+    }
+
+    // Send messages over a socket, grouping up to _udpBatch messages per datagram.
     if (_sock.isOpen()) {
-        _sock.send(_udpMessage.data(), _udpMessage.size(), *tsp);
+        for (size_t first = 0; first < batch.size(); first += _udpBatch) {
+            _udpBuffer.clear();
+            for (size_t i = first; i < batch.size() && i < first + _udpBatch; ++i) {
+                if (_udpJSON) {
+                    const std::string record(JSONRecord(*batch[i]));
+                    _udpBuffer.append(record.data(), record.size());
+                    _udpBuffer.appendUInt8('\n');
+                }
+                else {
+                    _udpBuffer.append(_udpMessage);
+                }
+            }
+            _sock.send(_udpBuffer.data(), _udpBuffer.size(), *tsp);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Build the JSON record for an event.
+//----------------------------------------------------------------------------
+
+std::string ts::TriggerPlugin::JSONRecord(const Event& event)
+{
+    UString labels;
+    for (size_t i = 0; i < event.labels.size(); ++i) {
+        if (event.labels.test(i)) {
+            if (!labels.empty()) {
+                labels.append(u", ");
+            }
+            labels.append(UString::Decimal(i, 0, true, UString()));
+        }
     }
+    return UString::Format(u"{\"event\": \"%s\", \"packet-index\": %d, \"pid\": %s, \"time\": \"%s\", \"labels\": [%s]}",
+                           {event.type,
+                            event.index,
+                            event.pid >= PID_MAX ? UString(u"null") : UString::Decimal(event.pid, 0, true, UString()),
+                            event.time.format(Time::ALL),
+                            labels}).toUTF8();
 }
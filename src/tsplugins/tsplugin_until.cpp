@@ -61,10 +61,14 @@ namespace ts {
         PacketCounter  _null_seq_cnt;     // Sequence of null packets counter
         MilliSecond    _msec_max;         // Stop after N milli-seconds
         Time           _start_time;       // Time of first packet reception
+        MilliSecond    _start_stream;     // Stream time of first packet (tsp --stream-time)
         PID            _previous_pid;     // PID of previous packet
         bool           _started;          // First packet was received
         bool           _terminated;       // Final condition is met
         bool           _transparent;      // Pass all packets, no longer check conditions
+
+        // Milliseconds since the first packet, in system time or stream time.
+        MilliSecond elapsed(const TSPacketMetadata& pkt_data) const;
     };
 }
 
@@ -86,6 +90,7 @@ ts::UntilPlugin::UntilPlugin (TSP* tsp_) :
     _null_seq_cnt(0),
     _msec_max(0),
     _start_time(Time::Epoch),
+    _start_stream(0),
     _previous_pid(PID_NULL),
     _started(false),
     _terminated(false),
@@ -105,7 +110,8 @@ ts::UntilPlugin::UntilPlugin (TSP* tsp_) :
 
     option(u"milli-seconds", 'm', UNSIGNED);
     help(u"milli-seconds",
-         u"Stop the specified number of milli-seconds after receiving the first packet.");
+         u"Stop the specified number of milli-seconds after receiving the first packet. "
+         u"With the tsp option --stream-time, the stream time is used instead of the system time.");
 
     option(u"null-sequence-count", 'n', UNSIGNED);
     help(u"null-sequence-count",
@@ -115,7 +121,9 @@ ts::UntilPlugin::UntilPlugin (TSP* tsp_) :
     help(u"packets", u"Stop after the specified number of packets.");
 
     option(u"seconds", 's', UNSIGNED);
-    help(u"seconds", u"Stop the specified number of seconds after receiving the first packet.");
+    help(u"seconds",
+         u"Stop the specified number of seconds after receiving the first packet. "
+         u"With the tsp option --stream-time, the stream time is used instead of the system time.");
 
     option(u"unit-start-count", 'u', UNSIGNED);
     help(u"unit-start-count",
@@ -148,6 +156,21 @@ bool ts::UntilPlugin::start()
 }
 
 
+//----------------------------------------------------------------------------
+// Milliseconds since the first packet, in system time or stream time.
+//----------------------------------------------------------------------------
+
+ts::MilliSecond ts::UntilPlugin::elapsed(const TSPacketMetadata& pkt_data) const
+{
+    if (tsp->useStreamTime() && pkt_data.hasInputTimeStamp()) {
+        return pkt_data.getInputTimeStampMS() - _start_stream;
+    }
+    else {
+        return Time::CurrentUTC() - _start_time;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Packet processing method
 //----------------------------------------------------------------------------
@@ -175,6 +198,7 @@ ts::ProcessorPlugin::Status ts::UntilPlugin::processPacket(TSPacket& pkt, TSPack
     if (!_started) {
         _started = true;
         _start_time = Time::CurrentUTC();
+        _start_stream = pkt_data.getInputTimeStampMS();
     }
 
     // Update context information
@@ -191,7 +215,7 @@ ts::ProcessorPlugin::Status ts::UntilPlugin::processPacket(TSPacket& pkt, TSPack
         (_pack_max > 0 && tsp->pluginPackets() + 1 >= _pack_max) ||
         (_null_seq_max > 0 && _null_seq_cnt >= _null_seq_max) ||
         (_unit_start_max > 0 && _unit_start_cnt >= _unit_start_max) ||
-        (_msec_max && Time::CurrentUTC() - _start_time >= _msec_max);
+        (_msec_max > 0 && elapsed(pkt_data) >= _msec_max);
 
     // Update context information for next packet
     _previous_pid = pkt.getPID();
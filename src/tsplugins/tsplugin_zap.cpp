@@ -76,6 +76,7 @@ namespace ts {
             TSPID_PES,    // A PES component of the service, unmodified
             TSPID_DATA,   // A non-PES component of the service, unmodified
             TSPID_EMM,    // EMM's, unmodified
+            TSPID_COUNT   // Number of PID states
         };
 
         // Private data
@@ -91,6 +92,7 @@ namespace ts {
         bool              _pes_only;           // Keep PES streams only
         Status            _drop_status;        // Status for dropped packets
         uint8_t           _pid_state[PID_MAX]; // Status of each PID.
+        PIDSet            _state_pids[TSPID_COUNT]; // Set of PID's in each state.
         SectionDemux      _demux;              // Section demux
         CyclingPacketizer _pzer_sdt;           // Packetizer for modified SDT
         CyclingPacketizer _pzer_pat;           // Packetizer for modified PAT
@@ -108,6 +110,12 @@ namespace ts {
         void processMGT(MGT&);
         void processVCT(VCT&);
 
+        // Set the state of a PID.
+        void setPIDState(PID pid, uint8_t state);
+
+        // Drop all PID's of the service (PMT and components).
+        void dropServicePIDs();
+
         // Called when the service id becomes known.
         void setServiceId(uint16_t);
 
@@ -236,10 +244,14 @@ bool ts::ZapPlugin::start()
     // All PIDs are dropped by default.
     // Selected PIDs will be added when discovered.
     ::memset(_pid_state, TSPID_DROP, sizeof(_pid_state));
+    for (size_t i = 0; i < TSPID_COUNT; ++i) {
+        _state_pids[i].reset();
+    }
+    _state_pids[TSPID_DROP].set();
 
     // The TOT and TDT are always passed.
     assert(PID_TOT == PID_TDT);
-    _pid_state[PID_TOT] = TSPID_PASS;
+    setPIDState(PID_TOT, TSPID_PASS);
 
     // Initialize the demux
     _demux.reset();
@@ -257,12 +269,12 @@ bool ts::ZapPlugin::start()
     // Include CAT and EMM if required
     if (_include_cas) {
         _demux.addPID(PID_CAT);
-        _pid_state[PID_CAT] = TSPID_PASS;
+        setPIDState(PID_CAT, TSPID_PASS);
     }
 
     // ATSC PSIP PID is also always passed.
     _demux.addPID(PID_PSIP);
-    _pid_state[PID_PSIP] = TSPID_PASS;
+    setPIDState(PID_PSIP, TSPID_PASS);
 
     // Configure the EIT processor to keep only the selected service.
     _eit_process.reset();
@@ -411,7 +423,7 @@ void ts::ZapPlugin::processSDT(SDT& sdt)
     _pzer_sdt.addTable(duck, sdt);
 
     // Now allow transmission of (modified) packets from SDT PID
-    _pid_state[PID_SDT] = TSPID_SDT;
+    setPIDState(PID_SDT, TSPID_SDT);
 }
 
 
@@ -479,17 +491,7 @@ void ts::ZapPlugin::setServiceId(uint16_t service_id)
             // The service was previously known but has changed its service id.
             // We need to rescan the service map. The PMT is reset.
             // All PIDs related to the service are erased.
-            for (PID pid = 0; pid < PID_MAX; pid++) {
-                uint8_t pstate = _pid_state[pid];
-                if (pstate == TSPID_PMT) {
-                    _demux.removePID (pid);
-                    _pzer_pmt.reset();
-                    _pid_state[pid] = TSPID_DROP;
-                }
-                else if (pstate == TSPID_PES || pstate == TSPID_DATA) {
-                    _pid_state[pid] = TSPID_DROP;
-                }
-            }
+            dropServicePIDs();
         }
 
         _service.setId(service_id);
@@ -502,13 +504,45 @@ void ts::ZapPlugin::setServiceId(uint16_t service_id)
         // Packets from PAT PID are analyzed but not passed. When a complete
         // PAT is read, a modified PAT will be transmitted.
         _demux.addPID(PID_PAT);
-        _pid_state[PID_PAT] = TSPID_DROP;
+        setPIDState(PID_PAT, TSPID_DROP);
 
         tsp->verbose(u"found service %s", {_service});
     }
 }
 
 
+//----------------------------------------------------------------------------
+// Set the state of a PID.
+//----------------------------------------------------------------------------
+
+void ts::ZapPlugin::setPIDState(PID pid, uint8_t state)
+{
+    _state_pids[_pid_state[pid]].reset(pid);
+    _state_pids[state].set(pid);
+    _pid_state[pid] = state;
+}
+
+
+//----------------------------------------------------------------------------
+// Drop all PID's of the service (PMT and components).
+//----------------------------------------------------------------------------
+
+void ts::ZapPlugin::dropServicePIDs()
+{
+    // Iterate on copies of the sets since they are modified in the loops.
+    const PIDSet pmt_pids(_state_pids[TSPID_PMT]);
+    for (size_t pid = pmt_pids.first(); pid < PID_MAX; pid = pmt_pids.next(pid)) {
+        _demux.removePID(PID(pid));
+        _pzer_pmt.reset();
+        setPIDState(PID(pid), TSPID_DROP);
+    }
+    const PIDSet comp_pids(_state_pids[TSPID_PES] | _state_pids[TSPID_DATA]);
+    for (size_t pid = comp_pids.first(); pid < PID_MAX; pid = comp_pids.next(pid)) {
+        setPIDState(PID(pid), TSPID_DROP);
+    }
+}
+
+
 //----------------------------------------------------------------------------
 //  This method processes a Program Association Table (PAT).
 //----------------------------------------------------------------------------
@@ -533,17 +567,7 @@ void ts::ZapPlugin::processPAT(PAT& pat)
         if (_service.hasPMTPID()) {
             // The PMT PID was previously known but has changed.
             // We need to rescan the PMT. All PIDs related to the service are erased.
-            for (PID pid = 0; pid < PID_MAX; pid++) {
-                uint8_t pstate = _pid_state[pid];
-                if (pstate == TSPID_PMT) {
-                    _demux.removePID (pid);
-                    _pzer_pmt.reset();
-                    _pid_state[pid] = TSPID_DROP;
-                }
-                else if (pstate == TSPID_PES || pstate == TSPID_DATA) {
-                    _pid_state[pid] = TSPID_DROP;
-                }
-            }
+            dropServicePIDs();
         }
 
         _service.setPMTPID(it->second);
@@ -567,7 +591,7 @@ void ts::ZapPlugin::processPAT(PAT& pat)
     _pzer_pat.addTable(duck, pat);
 
     // Now allow transmission of (modified) packets from PAT PID
-    _pid_state[PID_PAT] = TSPID_PAT;
+    setPIDState(PID_PAT, TSPID_PAT);
 }
 
 
@@ -579,7 +603,7 @@ void ts::ZapPlugin::processPMT(PMT& pmt)
 {
     // Record the PCR PID as a PES component of the service
     if (pmt.pcr_pid != PID_NULL) {
-        _pid_state[pmt.pcr_pid] = TSPID_PES;
+        setPIDState(pmt.pcr_pid, TSPID_PES);
     }
 
     // Record or remove ECMs PIDs from the descriptor loop
@@ -637,7 +661,7 @@ void ts::ZapPlugin::processPMT(PMT& pmt)
         }
 
         // We keep this component, record component PID
-        _pid_state[pid] = uint8_t(IsPES(stream.stream_type) ? TSPID_PES : TSPID_DATA);
+        setPIDState(pid, uint8_t(IsPES(stream.stream_type) ? TSPID_PES : TSPID_DATA));
 
         // Record or remove ECMs PIDs from the descriptor loop
         if (_no_ecm) {
@@ -670,7 +694,7 @@ void ts::ZapPlugin::processPMT(PMT& pmt)
     _pzer_pmt.addTable(duck, pmt);
 
     // Now allow transmission of (modified) packets from PMT PID
-    _pid_state[_service.getPMTPID()] = TSPID_PMT;
+    setPIDState(_service.getPMTPID(), TSPID_PMT);
 }
 
 
@@ -681,10 +705,9 @@ void ts::ZapPlugin::processPMT(PMT& pmt)
 void ts::ZapPlugin::processCAT(CAT& cat)
 {
     // Erase all previously known EMM PIDs
-    for (size_t pid = 0; pid < PID_MAX; pid++) {
-        if (_pid_state[pid] == TSPID_EMM) {
-            _pid_state[pid] = TSPID_DROP;
-        }
+    const PIDSet emm_pids(_state_pids[TSPID_EMM]);
+    for (size_t pid = emm_pids.first(); pid < PID_MAX; pid = emm_pids.next(pid)) {
+        setPIDState(PID(pid), TSPID_DROP);
     }
 
     // Register all new EMM PIDs
@@ -718,7 +741,7 @@ void ts::ZapPlugin::analyzeCADescriptors(const DescriptorList& dlist, uint8_t pi
         const CASFamily cas = CASFamilyOf(sysid);
 
         // Record state of main CA pid for this descriptor
-        _pid_state[pid] = pid_state;
+        setPIDState(pid, pid_state);
 
         // Normally, no PID should be referenced in the private part of
         // a CA descriptor. However, this rule is not followed by the
@@ -733,7 +756,7 @@ void ts::ZapPlugin::analyzeCADescriptors(const DescriptorList& dlist, uint8_t pi
                 pid = GetUInt16 (desc) & 0x1FFF;
                 desc += 4; size -= 4; nb_opi--;
                 // Record state of secondary pid
-                _pid_state[pid] = pid_state;
+                setPIDState(pid, pid_state);
             }
         }
         else if (cas == CAS_MEDIAGUARD && pid_state == TSPID_DATA && size >= 13) {
@@ -743,7 +766,7 @@ void ts::ZapPlugin::analyzeCADescriptors(const DescriptorList& dlist, uint8_t pi
                 pid = GetUInt16 (desc) & 0x1FFF;
                 desc += 15; size -= 15;
                 // Record state of secondary pid
-                _pid_state[pid] = pid_state;
+                setPIDState(pid, pid_state);
             }
         }
     }
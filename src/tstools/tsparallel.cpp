@@ -0,0 +1,265 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Parallel processing of a large TS file using several tsp processes.
+//
+//----------------------------------------------------------------------------
+
+#include "tsMain.h"
+#include "tsArgsWithPlugins.h"
+#include "tsForkPipe.h"
+#include "tsTSStitcher.h"
+#include "tsSysUtils.h"
+#include <thread>
+TSDUCK_SOURCE;
+TS_MAIN(MainCode);
+
+
+//----------------------------------------------------------------------------
+//  Command line options
+//----------------------------------------------------------------------------
+
+class Options: public ts::ArgsWithPlugins
+{
+    TS_NOBUILD_NOCOPY(Options);
+public:
+    Options(int argc, char *argv[]);
+    virtual ~Options();
+
+    ts::UString                 input;        // Input file name.
+    ts::UString                 output;       // Output file name.
+    ts::UString                 tsp_command;  // Command to run tsp, possibly with a prefix.
+    ts::UString                 temp_dir;     // Directory for intermediate chunks.
+    size_t                      jobs;         // Number of parallel tsp processes.
+    ts::PacketCounter           overlap;      // Number of warm-up packets before each chunk.
+    size_t                      label;        // Label of warm-up packets.
+    bool                        keep_chunks;  // Keep intermediate chunk files.
+    bool                        dry_run;      // Only display the commands.
+    ts::PluginOptionsVector     plugins;      // Packet processor plugins.
+};
+
+// Destructor.
+Options::~Options() {}
+
+// Constructor.
+Options::Options(int argc, char *argv[]) :
+    ts::ArgsWithPlugins(0, 0, 0, UNLIMITED_COUNT, 0, 0),
+    input(),
+    output(),
+    tsp_command(),
+    temp_dir(),
+    jobs(0),
+    overlap(0),
+    label(0),
+    keep_chunks(false),
+    dry_run(false),
+    plugins()
+{
+    setDescription(u"Process a large TS file with several tsp processes in parallel");
+
+    setSyntax(u"[options] input-file output-file \\\n"
+              u"    [-P processor-name [processor-options]] ...");
+
+    option(u"", 0, STRING, 2, 2);
+    help(u"",
+         u"The input and output transport stream files. "
+         u"The input file is split in consecutive chunks which are processed in parallel "
+         u"by distinct tsp processes using the specified packet processor plugins. "
+         u"The processed chunks are then concatenated into the output file. "
+         u"Continuity counters and table versions are fixed at each seam between chunks.");
+
+    option(u"dry-run", 'n');
+    help(u"dry-run", u"Display the tsp commands which would be run but do not run them.");
+
+    option(u"jobs", 'j', POSITIVE);
+    help(u"jobs",
+         u"Number of tsp processes to run in parallel. "
+         u"The default is the number of processors in the system.");
+
+    option(u"keep-chunks", 'k');
+    help(u"keep-chunks", u"Keep the processed chunk files after building the output file.");
+
+    option(u"label", 'l', INTEGER, 0, 1, 0, ts::TSPacketMetadata::LABEL_MAX);
+    help(u"label",
+         u"Label which is internally used to mark the warm-up packets in the tsp processes. "
+         u"This label shall not be used by the specified plugins. "
+         u"The default is " + ts::UString::Decimal(ts::TSPacketMetadata::LABEL_MAX) + u".");
+
+    option(u"overlap", 'o', UNSIGNED);
+    help(u"overlap",
+         u"Number of warm-up packets to process before each chunk. "
+         u"These packets are processed by the plugins of the corresponding tsp process "
+         u"to build their internal state (PSI/SI, clock references, etc.) but they are "
+         u"removed from the chunk output. The default is 100,000 packets.");
+
+    option(u"temp-directory", 't', STRING);
+    help(u"temp-directory",
+         u"Directory where the processed chunk files are created. "
+         u"The default is the directory of the output file.");
+
+    option(u"tsp", 0, STRING);
+    help(u"tsp", u"'command'",
+         u"Command to use to run tsp. The default is 'tsp'. "
+         u"The command may include a prefix such as a remote shell invocation, "
+         u"as long as the input file and the temporary directory are accessible "
+         u"with the same names from where tsp runs.");
+
+    // Analyze the command.
+    analyze(argc, argv);
+
+    // Load option values.
+    getValue(input, u"", u"", 0);
+    getValue(output, u"", u"", 1);
+    getValue(tsp_command, u"tsp", u"tsp");
+    getValue(temp_dir, u"temp-directory", ts::DirectoryName(output).c_str());
+    jobs = intValue<size_t>(u"jobs", std::max<size_t>(1, std::thread::hardware_concurrency()));
+    overlap = intValue<ts::PacketCounter>(u"overlap", 100000);
+    label = intValue<size_t>(u"label", ts::TSPacketMetadata::LABEL_MAX);
+    keep_chunks = present(u"keep-chunks");
+    dry_run = present(u"dry-run");
+    getPlugins(plugins, ts::PROCESSOR_PLUGIN);
+
+    // Final checking
+    exitOnError();
+}
+
+
+//----------------------------------------------------------------------------
+//  Build the tsp command for one chunk.
+//----------------------------------------------------------------------------
+
+namespace {
+    ts::UString ChunkCommand(const Options& opt, const ts::UString& chunk_file, ts::PacketCounter start, ts::PacketCounter count, bool last)
+    {
+        // Number of warm-up packets before the chunk.
+        const ts::PacketCounter warmup = std::min(opt.overlap, start);
+
+        ts::UString cmd(opt.tsp_command);
+        cmd.format(u" -I file %s --packet-offset %d", {opt.input.toQuoted(), start - warmup});
+        if (!last) {
+            cmd.format(u" -P until --packets %d", {warmup + count});
+        }
+        if (warmup > 0) {
+            cmd.format(u" -P filter --interval 0-%d --set-label %d", {warmup - 1, opt.label});
+        }
+        for (auto it = opt.plugins.begin(); it != opt.plugins.end(); ++it) {
+            cmd.format(u" -P %s", {it->name.toQuoted()});
+            if (!it->args.empty()) {
+                cmd.append(u' ');
+                cmd.append(ts::UString::ToQuotedLine(it->args));
+            }
+        }
+        if (warmup > 0) {
+            cmd.format(u" -P filter --label %d --negate", {opt.label});
+        }
+        cmd.format(u" -O file %s", {chunk_file.toQuoted()});
+        return cmd;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+//  Program main code.
+//----------------------------------------------------------------------------
+
+int MainCode(int argc, char *argv[])
+{
+    Options opt(argc, argv);
+
+    // Split the input file in chunks of equal size.
+    const int64_t file_size = ts::GetFileSize(opt.input);
+    if (file_size < 0) {
+        opt.error(u"cannot access %s", {opt.input});
+        return EXIT_FAILURE;
+    }
+    const ts::PacketCounter total = ts::PacketCounter(file_size) / ts::PKT_SIZE;
+    const size_t count = size_t(std::max<ts::PacketCounter>(1, std::min<ts::PacketCounter>(opt.jobs, total)));
+    opt.verbose(u"%'d packets in %s, using %d chunks", {total, opt.input, count});
+
+    // Build the chunk file names and the tsp commands.
+    ts::UStringVector chunk_files(count);
+    ts::UStringVector commands(count);
+    for (size_t i = 0; i < count; ++i) {
+        const ts::PacketCounter start = i * total / count;
+        const ts::PacketCounter end = (i + 1) * total / count;
+        chunk_files[i] = (opt.temp_dir.empty() ? ts::UString(u".") : opt.temp_dir) + ts::PathSeparator + ts::BaseName(opt.output) + ts::UString::Format(u".%d.ts", {i});
+        commands[i] = ChunkCommand(opt, chunk_files[i], start, end - start, i + 1 == count);
+    }
+
+    if (opt.dry_run) {
+        for (size_t i = 0; i < count; ++i) {
+            std::cout << commands[i] << std::endl;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    // Start all tsp processes in parallel.
+    bool success = true;
+    std::vector<ts::ForkPipe> processes(count);
+    for (size_t i = 0; i < count; ++i) {
+        opt.verbose(u"starting: %s", {commands[i]});
+        if (!processes[i].open(commands[i], ts::ForkPipe::SYNCHRONOUS, 0, opt, ts::ForkPipe::KEEP_BOTH, ts::ForkPipe::STDIN_NONE)) {
+            success = false;
+        }
+    }
+
+    // Wait for all processes.
+    for (size_t i = 0; i < count; ++i) {
+        if (processes[i].isOpen()) {
+            processes[i].close(opt);
+            if (processes[i].exitCode() != EXIT_SUCCESS) {
+                opt.error(u"tsp process for chunk %d failed, exit code %d", {i, processes[i].exitCode()});
+                success = false;
+            }
+        }
+    }
+
+    // Concatenate all chunks.
+    if (success) {
+        ts::TSStitcher stitcher(opt);
+        success = stitcher.open(opt.output);
+        for (size_t i = 0; success && i < count; ++i) {
+            success = stitcher.addFile(chunk_files[i]);
+        }
+        success = stitcher.close() && success;
+        opt.verbose(u"%'d packets written in %s, %'d fixed continuity counters, %'d fixed table versions",
+                    {stitcher.packetCount(), opt.output, stitcher.ccFixCount(), stitcher.versionFixCount()});
+    }
+
+    // Cleanup intermediate files.
+    if (!opt.keep_chunks) {
+        for (size_t i = 0; i < count; ++i) {
+            if (ts::FileExists(chunk_files[i])) {
+                ts::DeleteFile(chunk_files[i]);
+            }
+        }
+    }
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,214 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for ATSC Huffman compression.
+//
+//----------------------------------------------------------------------------
+
+#include "tsATSCHuffman.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class ATSCHuffmanTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testDecodeTree();
+    void testInvalidTree();
+    void testBuild();
+    void testLongCodes();
+
+    TSUNIT_TEST_BEGIN(ATSCHuffmanTest);
+    TSUNIT_TEST(testDecodeTree);
+    TSUNIT_TEST(testInvalidTree);
+    TSUNIT_TEST(testBuild);
+    TSUNIT_TEST(testLongCodes);
+    TSUNIT_TEST_END();
+};
+
+TSUNIT_REGISTER(ATSCHuffmanTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void ATSCHuffmanTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void ATSCHuffmanTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void ATSCHuffmanTest::testDecodeTree()
+{
+    // Same tree in all contexts: 'a' = 0, terminate = 10, escape = 110, 'b' = 111.
+    ts::ByteBlock tree;
+    for (size_t i = 0; i < ts::ATSCHuffman::CONTEXT_COUNT; ++i) {
+        tree.appendUInt16(uint16_t(2 * ts::ATSCHuffman::CONTEXT_COUNT));
+    }
+    tree.append(ts::ByteBlock({0x80 | 'a', 0x01, 0x80, 0x02, 0x80 | 0x1B, 0x80 | 'b'}));
+
+    ts::ATSCHuffman huff(tree);
+    TSUNIT_ASSERT(huff.isValid());
+    TSUNIT_ASSERT(huff.decodeTree() == tree);
+
+    // "abba" = 0 111 111 0 10 (padded with zeros)
+    ts::ByteBlock data;
+    TSUNIT_ASSERT(huff.encode(data, u"abba"));
+    TSUNIT_EQUAL(2, data.size());
+    TSUNIT_EQUAL(0x7E, data[0]);
+    TSUNIT_EQUAL(0x80, data[1]);
+
+    ts::UString text;
+    TSUNIT_ASSERT(huff.decode(text, data.data(), data.size()));
+    TSUNIT_EQUAL(u"abba", text);
+
+    // 'x' and 0xE9 are escaped: 0 110 01111000 110 11101001 10.
+    data.clear();
+    TSUNIT_ASSERT(huff.encode(data, u"axé"));
+    TSUNIT_EQUAL(4, data.size());
+    TSUNIT_EQUAL(0x67, data[0]);
+    TSUNIT_EQUAL(0x8D, data[1]);
+    TSUNIT_EQUAL(0xD3, data[2]);
+    TSUNIT_EQUAL(0x00, data[3]);
+    TSUNIT_ASSERT(huff.decode(text, data.data(), data.size()));
+    TSUNIT_EQUAL(u"axé", text);
+
+    // Characters above 0xFF cannot be encoded.
+    data.clear();
+    TSUNIT_ASSERT(!huff.encode(data, u"aĀ"));
+}
+
+void ATSCHuffmanTest::testInvalidTree()
+{
+    ts::ATSCHuffman huff;
+    TSUNIT_ASSERT(!huff.isValid());
+    TSUNIT_ASSERT(!huff.setDecodeTree(ts::ByteBlock(100, 0)));
+
+    // Offsets after end of table.
+    ts::ByteBlock tree;
+    for (size_t i = 0; i < ts::ATSCHuffman::CONTEXT_COUNT; ++i) {
+        tree.appendUInt16(0x1000);
+    }
+    TSUNIT_ASSERT(!huff.setDecodeTree(tree));
+
+    // Loop in tree.
+    tree.clear();
+    for (size_t i = 0; i < ts::ATSCHuffman::CONTEXT_COUNT; ++i) {
+        tree.appendUInt16(uint16_t(2 * ts::ATSCHuffman::CONTEXT_COUNT));
+    }
+    tree.append(ts::ByteBlock({0x00, 0x80}));
+    TSUNIT_ASSERT(!huff.setDecodeTree(tree));
+
+    ts::UString text;
+    const uint8_t data[] = {0x00};
+    TSUNIT_ASSERT(!huff.decode(text, data, sizeof(data)));
+}
+
+void ATSCHuffmanTest::testBuild()
+{
+    const ts::UStringList corpus({
+        u"Local News at Six",
+        u"The Evening News",
+        u"Weather Forecast",
+        u"Movie: The Long Night",
+        u"Sports Tonight",
+        u"News Update",
+    });
+
+    ts::ATSCHuffman huff;
+    TSUNIT_ASSERT(huff.build(corpus));
+    TSUNIT_ASSERT(huff.isValid());
+
+    // A code rebuilt from its decode tree is the same.
+    ts::ATSCHuffman copy(huff.decodeTree());
+    TSUNIT_ASSERT(copy.isValid());
+
+    // Strings from the corpus and other ones, with escaped characters.
+    ts::UStringList strings(corpus);
+    strings.push_back(u"");
+    strings.push_back(u"Zürich: 10 QUIZ xyz à ÿ");
+    strings.push_back(u"\x1B\x01 control chars");
+
+    for (auto it = strings.begin(); it != strings.end(); ++it) {
+        ts::ByteBlock data;
+        ts::UString text;
+        TSUNIT_ASSERT(huff.encode(data, *it));
+        TSUNIT_ASSERT(copy.decode(text, data.data(), data.size()));
+        TSUNIT_EQUAL(*it, text);
+    }
+
+    // Strings from the corpus are compressed.
+    ts::ByteBlock data;
+    TSUNIT_ASSERT(huff.encode(data, u"The Evening News"));
+    TSUNIT_ASSERT(data.size() < 16);
+}
+
+void ATSCHuffmanTest::testLongCodes()
+{
+    // Skewed frequencies after a space produce codes which are longer than 8 bits.
+    ts::UStringList corpus;
+    for (ts::UChar c = u'!'; c < 0x7F; ++c) {
+        const size_t count = c < u'0' ? 1 : (c < u'A' ? 10 : 200);
+        for (size_t i = 0; i < count; ++i) {
+            corpus.push_back(ts::UString(1, u' ') + ts::UString(1, c));
+        }
+    }
+
+    ts::ATSCHuffman huff;
+    TSUNIT_ASSERT(huff.build(corpus));
+
+    ts::UString all(u" ");
+    for (ts::UChar c = u'!'; c < 0x7F; ++c) {
+        all.push_back(c);
+        all.push_back(u' ');
+    }
+
+    ts::ByteBlock data;
+    ts::UString text;
+    TSUNIT_ASSERT(huff.encode(data, all));
+    TSUNIT_ASSERT(huff.decode(text, data.data(), data.size()));
+    TSUNIT_EQUAL(all, text);
+}
@@ -0,0 +1,196 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::BitSet
+//
+//----------------------------------------------------------------------------
+
+#include "tsBitSet.h"
+#include "tsMPEG.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class BitSetTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testBasic();
+    void testPartialWord();
+    void testOperators();
+    void testIterate();
+
+    TSUNIT_TEST_BEGIN(BitSetTest);
+    TSUNIT_TEST(testBasic);
+    TSUNIT_TEST(testPartialWord);
+    TSUNIT_TEST(testOperators);
+    TSUNIT_TEST(testIterate);
+    TSUNIT_TEST_END();
+};
+
+TSUNIT_REGISTER(BitSetTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void BitSetTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void BitSetTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void BitSetTest::testBasic()
+{
+    ts::PIDSet pids;
+    TSUNIT_EQUAL(8192, pids.size());
+    TSUNIT_EQUAL(0, pids.count());
+    TSUNIT_ASSERT(pids.none());
+    TSUNIT_ASSERT(!pids.any());
+    TSUNIT_ASSERT(!pids.all());
+
+    pids.set(0);
+    pids.set(100);
+    pids[ts::PID_NULL] = true;
+    TSUNIT_EQUAL(3, pids.count());
+    TSUNIT_ASSERT(pids.any());
+    TSUNIT_ASSERT(pids.test(0));
+    TSUNIT_ASSERT(pids.test(100));
+    TSUNIT_ASSERT(pids[ts::PID_NULL]);
+    TSUNIT_ASSERT(!pids.test(101));
+
+    pids.reset(100);
+    pids.flip(0);
+    pids.set(200, false);
+    TSUNIT_EQUAL(1, pids.count());
+    TSUNIT_ASSERT(!pids.test(0));
+
+    pids[ts::PID_NULL].flip();
+    TSUNIT_ASSERT(pids.none());
+
+    TSUNIT_EQUAL(0, ts::NoPID.count());
+    TSUNIT_EQUAL(8192, ts::AllPIDs.count());
+    TSUNIT_ASSERT(ts::AllPIDs.all());
+    TSUNIT_ASSERT(ts::NoPID == ~ts::AllPIDs);
+
+    // Same behaviour as std::bitset on out of range positions.
+    TSUNIT_ASSERT(!pids.test(8191));
+    bool thrown = false;
+    try {
+        pids.set(10000);
+    }
+    catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    TSUNIT_ASSERT(thrown);
+}
+
+void BitSetTest::testPartialWord()
+{
+    // Size is not a multiple of the word size.
+    ts::BitSet<100> bits;
+    bits.set();
+    TSUNIT_EQUAL(100, bits.count());
+    TSUNIT_ASSERT(bits.all());
+    bits.flip();
+    TSUNIT_ASSERT(bits.none());
+    bits.flip();
+    TSUNIT_EQUAL(100, (~ts::BitSet<100>()).count());
+    TSUNIT_EQUAL(99, bits.next(98));
+    TSUNIT_EQUAL(100, bits.next(99));
+}
+
+void BitSetTest::testOperators()
+{
+    ts::PIDSet a;
+    ts::PIDSet b;
+    a.set(1); a.set(2); a.set(3000);
+    b.set(2); b.set(3000); b.set(8000);
+
+    TSUNIT_EQUAL(2, (a & b).count());
+    TSUNIT_EQUAL(4, (a | b).count());
+    TSUNIT_EQUAL(2, (a ^ b).count());
+    TSUNIT_ASSERT(a.intersects(b));
+    TSUNIT_ASSERT(!a.intersects(~a));
+
+    ts::PIDSet c(a);
+    TSUNIT_ASSERT(c == a);
+    TSUNIT_ASSERT(c != b);
+    c.exclude(b);
+    TSUNIT_ASSERT(c == (a & ~b));
+    TSUNIT_EQUAL(1, c.count());
+    TSUNIT_ASSERT(c.test(1));
+
+    c = a;
+    c |= b;
+    TSUNIT_ASSERT(c == (a | b));
+    c &= b;
+    TSUNIT_ASSERT(c == b);
+    c ^= b;
+    TSUNIT_ASSERT(c.none());
+}
+
+void BitSetTest::testIterate()
+{
+    ts::PIDSet pids;
+    TSUNIT_EQUAL(ts::PID_MAX, pids.first());
+
+    const ts::PID ref[] = {0, 1, 63, 64, 65, 127, 128, 1000, 4095, 8190, 8191};
+    for (size_t i = 0; i < sizeof(ref) / sizeof(ref[0]); ++i) {
+        pids.set(ref[i]);
+    }
+
+    size_t index = 0;
+    for (size_t pid = pids.first(); pid < pids.size(); pid = pids.next(pid)) {
+        TSUNIT_ASSERT(index < sizeof(ref) / sizeof(ref[0]));
+        TSUNIT_EQUAL(ref[index], pid);
+        index++;
+    }
+    TSUNIT_EQUAL(sizeof(ref) / sizeof(ref[0]), index);
+    TSUNIT_EQUAL(64, pids.next(63));
+    TSUNIT_EQUAL(1000, pids.next(128));
+    TSUNIT_EQUAL(8192, pids.next(8191));
+    TSUNIT_EQUAL(8192, pids.next(10000));
+}
@@ -33,6 +33,7 @@
 
 #include "tsAES.h"
 #include "tsDES.h"
+#include "tsDESBatch.h"
 #include "tsTDES.h"
 #include "tsSHA1.h"
 #include "tsSHA256.h"
@@ -96,6 +97,9 @@ public:
     void testIDSA();
     void testSCTE52_2003();
     void testSCTE52_2008();
+    void testDESBatch();
+    void testSCTE52Batch();
+    void testDVS042Batch();
     void testSHA1();
     void testSHA256();
     void testSHA512();
@@ -119,6 +123,9 @@ public:
     TSUNIT_TEST(testIDSA);
     TSUNIT_TEST(testSCTE52_2003);
     TSUNIT_TEST(testSCTE52_2008);
+    TSUNIT_TEST(testDESBatch);
+    TSUNIT_TEST(testSCTE52Batch);
+    TSUNIT_TEST(testDVS042Batch);
     TSUNIT_TEST(testSHA1);
     TSUNIT_TEST(testSHA256);
     TSUNIT_TEST(testSHA512);
@@ -150,6 +157,8 @@ private:
 
     void testChainingSizes(ts::CipherChaining& algo, int sizes, ...);
 
+    void testBatch(ts::CipherChaining& algo, ts::CipherChaining& ref, size_t count);
+
     void testHash(ts::Hash& algo,
                   size_t tv_index,
                   size_t tv_count,
@@ -304,6 +313,49 @@ void CryptoTest::testChainingSizes(ts::CipherChaining& algo, int sizes, ...)
     va_end(ap);
 }
 
+void CryptoTest::testBatch(ts::CipherChaining& algo, ts::CipherChaining& ref, size_t count)
+{
+    // Encrypt and decrypt random messages in one batch, compare with one message at a time.
+    ts::SystemRandomGenerator prng;
+    ts::ByteBlock key(algo.maxKeySize());
+    ts::ByteBlock iv(algo.maxIVSize());
+    TSUNIT_ASSERT(prng.read(key.data(), key.size()));
+    TSUNIT_ASSERT(prng.read(iv.data(), iv.size()));
+    TSUNIT_ASSERT(algo.setKey(key.data(), key.size()));
+    TSUNIT_ASSERT(algo.setIV(iv.data(), iv.size()));
+    TSUNIT_ASSERT(ref.setKey(key.data(), key.size()));
+    TSUNIT_ASSERT(ref.setIV(iv.data(), iv.size()));
+
+    // Message sizes up to 184 bytes, the maximum TS payload size.
+    std::vector<ts::ByteBlock> plain(count);
+    std::vector<ts::ByteBlock> cipher(count);
+    std::vector<uint8_t*> data(count);
+    std::vector<size_t> sizes(count);
+    for (size_t i = 0; i < count; ++i) {
+        size_t size = (i * 37) % 185;
+        if (!algo.residueAllowed()) {
+            size -= size % algo.blockSize();
+        }
+        plain[i].resize(std::max(size, algo.minMessageSize()));
+        TSUNIT_ASSERT(plain[i].empty() || prng.read(plain[i].data(), plain[i].size()));
+        cipher[i] = plain[i];
+        data[i] = cipher[i].data();
+        sizes[i] = cipher[i].size();
+    }
+
+    TSUNIT_ASSERT(algo.encryptBatch(data.data(), sizes.data(), count));
+    for (size_t i = 0; i < count; ++i) {
+        ts::ByteBlock expected(plain[i]);
+        TSUNIT_ASSERT(expected.empty() || ref.encryptInPlace(expected.data(), expected.size()));
+        TSUNIT_ASSERT(cipher[i] == expected);
+    }
+
+    TSUNIT_ASSERT(algo.decryptBatch(data.data(), sizes.data(), count));
+    for (size_t i = 0; i < count; ++i) {
+        TSUNIT_ASSERT(cipher[i] == plain[i]);
+    }
+}
+
 void CryptoTest::testHash(ts::Hash& algo,
                           size_t tv_index,
                           size_t tv_count,
@@ -541,6 +593,119 @@ void CryptoTest::testSCTE52_2008()
     }
 }
 
+void CryptoTest::testDESBatch()
+{
+    ts::DES des;
+    ts::DESBatch batch;
+    ts::SystemRandomGenerator prng;
+
+    TSUNIT_ASSERT(!batch.hasKey());
+
+    // Test vectors, each one replicated in a large batch, at different positions.
+    const size_t tv_count = sizeof(tv_des) / sizeof(TV_DES);
+    const size_t count = ts::DESBatch::BATCH_SIZE + 10;
+    ts::ByteBlock buffer(count * ts::DESBatch::BLOCK_SIZE);
+    std::vector<uint8_t*> blocks(count);
+    for (size_t i = 0; i < count; ++i) {
+        blocks[i] = buffer.data() + i * ts::DESBatch::BLOCK_SIZE;
+    }
+    for (size_t tvi = 0; tvi < tv_count; ++tvi) {
+        const TV_DES* tv = tv_des + tvi;
+        TSUNIT_ASSERT(batch.setKey(tv->key, sizeof(tv->key)));
+        TSUNIT_ASSERT(batch.hasKey());
+        for (size_t i = 0; i < count; ++i) {
+            ::memcpy(blocks[i], tv->plain, sizeof(tv->plain));
+        }
+        TSUNIT_ASSERT(batch.encrypt(blocks.data(), blocks.data(), count));
+        for (size_t i = 0; i < count; ++i) {
+            TSUNIT_EQUAL(0, ::memcmp(blocks[i], tv->cipher, sizeof(tv->cipher)));
+        }
+        TSUNIT_ASSERT(batch.decrypt(blocks.data(), blocks.data(), count));
+        for (size_t i = 0; i < count; ++i) {
+            TSUNIT_EQUAL(0, ::memcmp(blocks[i], tv->plain, sizeof(tv->plain)));
+        }
+    }
+
+    // Random blocks, various batch sizes, below and above the bitslice threshold.
+    static const size_t counts[] = {1, 7, ts::DESBatch::MIN_BITSLICE - 1, ts::DESBatch::MIN_BITSLICE, 64, 100, 128, 129, 300};
+    for (size_t ci = 0; ci < sizeof(counts) / sizeof(counts[0]); ++ci) {
+        const size_t n = counts[ci];
+        ts::ByteBlock key(ts::DESBatch::KEY_SIZE);
+        ts::ByteBlock plain(n * ts::DESBatch::BLOCK_SIZE);
+        ts::ByteBlock cipher(plain.size());
+        ts::ByteBlock decipher(plain.size());
+        std::vector<const uint8_t*> in(n);
+        std::vector<uint8_t*> out(n);
+        std::vector<uint8_t*> back(n);
+        TSUNIT_ASSERT(prng.read(key.data(), key.size()));
+        TSUNIT_ASSERT(prng.read(plain.data(), plain.size()));
+        for (size_t i = 0; i < n; ++i) {
+            in[i] = plain.data() + i * ts::DESBatch::BLOCK_SIZE;
+            out[i] = cipher.data() + i * ts::DESBatch::BLOCK_SIZE;
+            back[i] = decipher.data() + i * ts::DESBatch::BLOCK_SIZE;
+        }
+        TSUNIT_ASSERT(des.setKey(key.data(), key.size()));
+        TSUNIT_ASSERT(batch.setKey(key.data(), key.size()));
+        TSUNIT_ASSERT(batch.encrypt(in.data(), out.data(), n));
+        for (size_t i = 0; i < n; ++i) {
+            uint8_t expected[ts::DES::BLOCK_SIZE];
+            TSUNIT_ASSERT(des.encrypt(in[i], ts::DES::BLOCK_SIZE, expected, sizeof(expected)));
+            TSUNIT_EQUAL(0, ::memcmp(out[i], expected, sizeof(expected)));
+        }
+        TSUNIT_ASSERT(batch.decrypt(out.data(), back.data(), n));
+        TSUNIT_ASSERT(decipher == plain);
+    }
+}
+
+void CryptoTest::testSCTE52Batch()
+{
+    // Test vectors, each one replicated in a batch.
+    ts::SCTE52_2008 scte;
+    const size_t count = 100;
+    const size_t tv_count = sizeof(tv_scte52_2008) / sizeof(tv_scte52_2008[0]);
+    for (size_t tvi = 0; tvi < tv_count; ++tvi) {
+        const TV_SCTE52_2008* tv = tv_scte52_2008 + tvi;
+        TSUNIT_ASSERT(scte.setKey(tv->key, sizeof(tv->key)));
+        TSUNIT_ASSERT(scte.setIV(tv->iv, sizeof(tv->iv)));
+        TSUNIT_ASSERT(scte.setShortIV(tv->short_iv, sizeof(tv->short_iv)));
+        std::vector<ts::ByteBlock> msg(count, ts::ByteBlock(tv->plain, tv->plain_size));
+        std::vector<uint8_t*> data(count);
+        std::vector<size_t> sizes(count, tv->plain_size);
+        for (size_t i = 0; i < count; ++i) {
+            data[i] = msg[i].data();
+        }
+        TSUNIT_ASSERT(scte.encryptBatch(data.data(), sizes.data(), count));
+        for (size_t i = 0; i < count; ++i) {
+            TSUNIT_ASSERT(msg[i] == ts::ByteBlock(tv->cipher, tv->cipher_size));
+        }
+        TSUNIT_ASSERT(scte.decryptBatch(data.data(), sizes.data(), count));
+        for (size_t i = 0; i < count; ++i) {
+            TSUNIT_ASSERT(msg[i] == ts::ByteBlock(tv->plain, tv->plain_size));
+        }
+    }
+
+    // Random messages of all sizes.
+    ts::SCTE52_2003 scte2003;
+    ts::SCTE52_2003 ref2003;
+    ts::SCTE52_2008 ref2008;
+    testBatch(scte2003, ref2003, 10);
+    testBatch(scte2003, ref2003, 500);
+    testBatch(scte, ref2008, 500);
+}
+
+void CryptoTest::testDVS042Batch()
+{
+    // Default implementation of batch processing, using the block cipher.
+    ts::DVS042<ts::AES> algo;
+    ts::DVS042<ts::AES> ref;
+    testBatch(algo, ref, 200);
+
+    // Chaining modes without specific batch processing.
+    ts::CBC<ts::AES> cbc;
+    ts::CBC<ts::AES> cbcref;
+    testBatch(cbc, cbcref, 20);
+}
+
 void CryptoTest::testSHA1()
 {
     ts::SHA1 sha1;
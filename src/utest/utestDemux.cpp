@@ -91,6 +91,7 @@ public:
     void testTDT();
     void testTOT();
     void testHEVC();
+    void testRepeatedSections();
 
     TSUNIT_TEST_BEGIN(DemuxTest);
     TSUNIT_TEST(testPAT);
@@ -104,6 +105,7 @@ public:
     TSUNIT_TEST(testTDT);
     TSUNIT_TEST(testTOT);
     TSUNIT_TEST(testHEVC);
+    TSUNIT_TEST(testRepeatedSections);
     TSUNIT_TEST_END();
 
 private:
@@ -115,6 +117,9 @@ private:
 
     // Unitary test for one table.
     void testTable(const char* name, const uint8_t* ref_packets, size_t ref_packets_size, const uint8_t* ref_sections, size_t ref_sections_size);
+
+    // Feed a demux with repeated tables, with or without stuffing at end of sections.
+    void testRepeated(bool stuffing, bool table_handler, bool section_handler);
 };
 
 TSUNIT_REGISTER(DemuxTest);
@@ -488,3 +493,74 @@ void DemuxTest::testHEVC()
 {
     TEST_TABLE("PMT with HEVC descriptor", pmt_hevc);
 }
+
+
+//----------------------------------------------------------------------------
+// Test the demux with repeated unchanged tables.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Count tables and sections, remember the versions of the tables.
+    class RepeatCounter: public ts::TableHandlerInterface, public ts::SectionHandlerInterface
+    {
+    public:
+        size_t sections;
+        std::vector<uint8_t> versions;
+        RepeatCounter() : sections(0), versions() {}
+        virtual void handleTable(ts::SectionDemux&, const ts::BinaryTable& table) override { versions.push_back(table.version()); }
+        virtual void handleSection(ts::SectionDemux&, const ts::Section&) override { sections++; }
+    };
+}
+
+void DemuxTest::testRepeatedSections()
+{
+    testRepeated(false, true, false);
+    testRepeated(true, true, false);
+    testRepeated(false, true, true);
+    testRepeated(true, false, true);
+}
+
+void DemuxTest::testRepeated(bool stuffing, bool table_handler, bool section_handler)
+{
+    ts::DuckContext duck;
+    debug() << "DemuxTest::testRepeated: stuffing: " << stuffing << ", table handler: " << table_handler << ", section handler: " << section_handler << std::endl;
+
+    // Get a reference table with a section of several packets (the section is skipped after the first one).
+    ts::StandaloneTableDemux ref_demux(duck, ts::AllPIDs);
+    const ts::TSPacket* ref_pkt = reinterpret_cast<const ts::TSPacket*>(psi_bat_cplus_packets);
+    for (size_t pi = 0; pi < sizeof(psi_bat_cplus_packets) / ts::PKT_SIZE; ++pi) {
+        ref_demux.feedPacket(ref_pkt[pi]);
+    }
+    TSUNIT_EQUAL(1, ref_demux.tableCount());
+    const ts::BinaryTable& v1(*ref_demux.tableAt(0));
+    TSUNIT_ASSERT(v1.sectionAt(0)->size() > 2 * ts::PKT_SIZE);
+
+    // Same table, next version.
+    ts::BinaryTable v2(v1, ts::COPY);
+    v2.setVersion((v1.version() + 1) & ts::SVERSION_MASK);
+
+    // Packetize 5 x v1, 5 x v2, 5 x v1, in one single cycle.
+    ts::TSPacketVector all;
+    ts::OneShotPacketizer pzer(v1.sourcePID(), stuffing);
+    for (size_t i = 0; i < 15; ++i) {
+        pzer.addTable(i / 5 == 1 ? v2 : v1);
+    }
+    pzer.getPackets(all);
+
+    // Demux all packets.
+    RepeatCounter counter;
+    ts::SectionDemux demux(duck, table_handler ? &counter : nullptr, section_handler ? &counter : nullptr, ts::AllPIDs);
+    for (size_t i = 0; i < all.size(); ++i) {
+        demux.feedPacket(all[i]);
+    }
+    TSUNIT_ASSERT(!demux.hasErrors());
+
+    // Each version change is notified once, each section is notified each time.
+    if (table_handler) {
+        TSUNIT_EQUAL(3, counter.versions.size());
+        TSUNIT_EQUAL(v1.version(), counter.versions[0]);
+        TSUNIT_EQUAL(v2.version(), counter.versions[1]);
+        TSUNIT_EQUAL(v1.version(), counter.versions[2]);
+    }
+    TSUNIT_EQUAL(section_handler ? 15 * v1.sectionCount() : 0, counter.sections);
+}
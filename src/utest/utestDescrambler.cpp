@@ -0,0 +1,322 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::AbstractDescrambler
+//
+//----------------------------------------------------------------------------
+
+#include "tsAbstractDescrambler.h"
+#include "tsTSProcessor.h"
+#include "tsPluginRepository.h"
+#include "tsOneShotPacketizer.h"
+#include "tsCADescriptor.h"
+#include "tsScramblingDescriptor.h"
+#include "tsGuardCondition.h"
+#include "tsSysUtils.h"
+#include "tsNullReport.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class DescramblerTest: public tsunit::Test
+{
+public:
+    DescramblerTest();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testAllServices();
+
+    TSUNIT_TEST_BEGIN(DescramblerTest);
+    TSUNIT_TEST(testAllServices);
+    TSUNIT_TEST_END();
+
+private:
+    ts::UString _inFileName;
+    ts::UString _outFileName;
+};
+
+TSUNIT_REGISTER(DescramblerTest);
+
+
+//----------------------------------------------------------------------------
+// Test stream and test descrambler.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Description of the test stream: each service has one scrambled PID and
+    // one ECM PID. The services alternately use DVB-CSA2 and DVB-CISSA.
+    const size_t   SERVICE_COUNT = 4;
+    const size_t   PACKET_COUNT = 40;   // Scrambled packets per service, half even, half odd.
+    const uint16_t CAS_ID = 0x4ADC;
+    const ts::MilliSecond ECM_DELAY = 50;  // Time to decipher an ECM.
+
+    uint16_t ServiceId(size_t srv) { return uint16_t(srv + 1); }
+    ts::PID  PMTPID(size_t srv) { return ts::PID(0x0100 + srv); }
+    ts::PID  ESPID(size_t srv) { return ts::PID(0x0200 + srv); }
+    ts::PID  ECMPID(size_t srv) { return ts::PID(0x0300 + srv); }
+    uint8_t  ScramblingMode(size_t srv) { return srv % 2 == 0 ? ts::SCRAMBLING_DVB_CSA2 : ts::SCRAMBLING_DVB_CISSA1; }
+
+    // Control word of a service, 8 bytes for DVB-CSA2, 16 bytes for DVB-CISSA.
+    ts::ByteBlock ControlWord(size_t srv, int parity)
+    {
+        ts::ByteBlock cw(ScramblingMode(srv) == ts::SCRAMBLING_DVB_CSA2 ? 8 : 16);
+        for (size_t i = 0; i < cw.size(); ++i) {
+            cw[i] = uint8_t(0x10 * (srv + 1) + 2 * i + (parity & 1));
+        }
+        return cw;
+    }
+
+    // Clear content of a packet in the scrambled PID of a service.
+    ts::TSPacket ClearPacket(size_t srv, size_t index)
+    {
+        ts::TSPacket pkt;
+        pkt.init(ESPID(srv), uint8_t(index % ts::CC_MAX));
+        for (size_t i = 4; i < ts::PKT_SIZE; ++i) {
+            pkt.b[i] = uint8_t(srv + index + i);
+        }
+        return pkt;
+    }
+
+    // Statistics of the test descrambler, shared by all threads.
+    ts::Mutex     stats_mutex;
+    ts::Condition stats_condition;
+    size_t        active_ecms = 0;      // Number of ECM's which are being deciphered.
+    size_t        max_active_ecms = 0;  // Max number of ECM's which were deciphered in parallel.
+    size_t        deciphered_ecms = 0;  // Number of deciphered ECM's.
+
+    // A descrambler where the ECM contains the even and odd control words in clear.
+    class TestDescrambler: public ts::AbstractDescrambler
+    {
+        TS_NOBUILD_NOCOPY(TestDescrambler);
+    public:
+        TestDescrambler(ts::TSP* tsp_) : ts::AbstractDescrambler(tsp_, u"Test descrambler"), _ready(false) {}
+
+        // The result must not depend on the speed of the ECM threads: wait for all
+        // ECM's to be deciphered before the first scrambled packet. Then, give some
+        // time to the ECM threads to store the control words.
+        virtual Status processPacket(ts::TSPacket& pkt, ts::TSPacketMetadata& pkt_data) override
+        {
+            if (!_ready && pkt.isScrambled()) {
+                {
+                    ts::GuardCondition lock(stats_mutex, stats_condition);
+                    while (deciphered_ecms < SERVICE_COUNT && lock.waitCondition(5000)) {
+                    }
+                }
+                ts::SleepThread(ECM_DELAY);
+                _ready = true;
+            }
+            return ts::AbstractDescrambler::processPacket(pkt, pkt_data);
+        }
+
+    protected:
+        virtual bool checkCADescriptor(uint16_t cas_id, const ts::ByteBlock&) override
+        {
+            return cas_id == CAS_ID;
+        }
+
+        virtual bool checkECM(const ts::Section& ecm) override
+        {
+            return ecm.payloadSize() == 16 || ecm.payloadSize() == 32;
+        }
+
+        virtual bool decipherECM(const ts::Section& ecm, CWData& cw_even, CWData& cw_odd) override
+        {
+            {
+                ts::Guard lock(stats_mutex);
+                max_active_ecms = std::max(max_active_ecms, ++active_ecms);
+            }
+            ts::SleepThread(ECM_DELAY);
+            const size_t size = ecm.payloadSize() / 2;
+            cw_even.cw.copy(ecm.payload(), size);
+            cw_odd.cw.copy(ecm.payload() + size, size);
+            {
+                ts::GuardCondition lock(stats_mutex, stats_condition);
+                active_ecms--;
+                deciphered_ecms++;
+                lock.signal();
+            }
+            return true;
+        }
+
+    private:
+        bool _ready;
+    };
+
+    ts::ProcessorPlugin* NewTestDescrambler(ts::TSP* tsp) { return new TestDescrambler(tsp); }
+
+    // Add the packets of a table.
+    void AddTable(ts::DuckContext& duck, ts::TSPacketVector& packets, const ts::AbstractTable& table, ts::PID pid)
+    {
+        ts::OneShotPacketizer pzer(pid, true);
+        ts::TSPacketVector pkts;
+        pzer.addTable(duck, table);
+        pzer.getPackets(pkts);
+        packets.insert(packets.end(), pkts.begin(), pkts.end());
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+DescramblerTest::DescramblerTest() :
+    _inFileName(),
+    _outFileName()
+{
+}
+
+// Test suite initialization method.
+void DescramblerTest::beforeTest()
+{
+    if (_inFileName.empty()) {
+        _inFileName = ts::TempFile(u".in.ts");
+        _outFileName = ts::TempFile(u".out.ts");
+    }
+    ts::DeleteFile(_inFileName);
+    ts::DeleteFile(_outFileName);
+}
+
+// Test suite cleanup method.
+void DescramblerTest::afterTest()
+{
+    ts::DeleteFile(_inFileName);
+    ts::DeleteFile(_outFileName);
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void DescramblerTest::testAllServices()
+{
+    active_ecms = max_active_ecms = deciphered_ecms = 0;
+
+    ts::DuckContext duck;
+    ts::TSPacketVector packets;
+
+    // PAT and PMT's. The CA_descriptor and scrambling_descriptor are at service level.
+    ts::PAT pat(0, true, 1);
+    for (size_t srv = 0; srv < SERVICE_COUNT; ++srv) {
+        pat.pmts[ServiceId(srv)] = PMTPID(srv);
+    }
+    AddTable(duck, packets, pat, ts::PID_PAT);
+    for (size_t srv = 0; srv < SERVICE_COUNT; ++srv) {
+        ts::PMT pmt(0, true, ServiceId(srv), ESPID(srv));
+        pmt.descs.add(duck, ts::CADescriptor(CAS_ID, ECMPID(srv)));
+        pmt.descs.add(duck, ts::ScramblingDescriptor(ScramblingMode(srv)));
+        pmt.streams[ESPID(srv)].stream_type = ts::ST_MPEG2_VIDEO;
+        AddTable(duck, packets, pmt, PMTPID(srv));
+    }
+
+    // One ECM per service, with the two control words in clear.
+    for (size_t srv = 0; srv < SERVICE_COUNT; ++srv) {
+        ts::ByteBlock payload(ControlWord(srv, 0));
+        payload.append(ControlWord(srv, 1));
+        ts::OneShotPacketizer pzer(ECMPID(srv), true);
+        ts::TSPacketVector pkts;
+        pzer.addSection(new ts::Section(ts::TID_ECM_80, true, payload.data(), payload.size()));
+        pzer.getPackets(pkts);
+        packets.insert(packets.end(), pkts.begin(), pkts.end());
+    }
+
+    // Scrambled packets of all services, interleaved.
+    std::vector<ts::TSScrambling> scramblers;
+    for (size_t srv = 0; srv < SERVICE_COUNT; ++srv) {
+        scramblers.push_back(ts::TSScrambling(NULLREP, ScramblingMode(srv)));
+    }
+    for (size_t srv = 0; srv < SERVICE_COUNT; ++srv) {
+        TSUNIT_ASSERT(scramblers[srv].start());
+        TSUNIT_ASSERT(scramblers[srv].setCW(ControlWord(srv, 0), 0));
+        TSUNIT_ASSERT(scramblers[srv].setCW(ControlWord(srv, 1), 1));
+    }
+    for (size_t i = 0; i < PACKET_COUNT; ++i) {
+        for (size_t srv = 0; srv < SERVICE_COUNT; ++srv) {
+            ts::TSPacket pkt(ClearPacket(srv, i));
+            TSUNIT_ASSERT(scramblers[srv].setEncryptParity(i < PACKET_COUNT / 2 ? 0 : 1));
+            TSUNIT_ASSERT(scramblers[srv].encrypt(pkt));
+            TSUNIT_ASSERT(pkt.isScrambled());
+            packets.push_back(pkt);
+        }
+    }
+    {
+        std::ofstream file(_inFileName.toUTF8().c_str(), std::ios::out | std::ios::binary);
+        TSUNIT_ASSERT(file.is_open());
+        file.write(reinterpret_cast<const char*>(packets.data()), std::streamsize(packets.size() * ts::PKT_SIZE));
+    }
+
+    // Descramble all services with several ECM threads.
+    // In non real-time mode, the ECM's would be deciphered synchronously.
+    ts::PluginRepository::Instance()->registerProcessor(u"utest_descrambler", NewTestDescrambler);
+    ts::TSProcessorArgs args;
+    args.app_name = u"utest";
+    args.realtime = ts::TRUE;
+    args.input.set(u"file", {_inFileName});
+    args.plugins.resize(1);
+    args.plugins[0].set(u"utest_descrambler", {u"--all-services", u"--ecm-threads", ts::UString::Decimal(SERVICE_COUNT, 0, true, u"")});
+    args.output.set(u"file", {_outFileName});
+
+    ts::TSProcessor tsproc(NULLREP);
+    TSUNIT_ASSERT(tsproc.start(args));
+    tsproc.waitForTermination();
+
+    debug() << "DescramblerTest::testAllServices: deciphered ECM's: " << deciphered_ecms << ", max in parallel: " << max_active_ecms << std::endl;
+    TSUNIT_EQUAL(SERVICE_COUNT, deciphered_ecms);
+    TSUNIT_ASSERT(max_active_ecms > 1);
+
+    // Each service must be descrambled with its own control words.
+    TSUNIT_EQUAL(int64_t(packets.size() * ts::PKT_SIZE), ts::GetFileSize(_outFileName));
+    ts::TSPacketVector output(packets.size());
+    {
+        std::ifstream file(_outFileName.toUTF8().c_str(), std::ios::in | std::ios::binary);
+        TSUNIT_ASSERT(file.is_open());
+        file.read(reinterpret_cast<char*>(output.data()), std::streamsize(output.size() * ts::PKT_SIZE));
+    }
+    std::vector<size_t> counts(SERVICE_COUNT, 0);
+    for (auto it = output.begin(); it != output.end(); ++it) {
+        for (size_t srv = 0; srv < SERVICE_COUNT; ++srv) {
+            if (it->getPID() == ESPID(srv)) {
+                TSUNIT_ASSERT(!it->isScrambled());
+                TSUNIT_ASSERT(*it == ClearPacket(srv, counts[srv]++));
+            }
+        }
+    }
+    for (size_t srv = 0; srv < SERVICE_COUNT; ++srv) {
+        TSUNIT_EQUAL(PACKET_COUNT, counts[srv]);
+    }
+}
@@ -0,0 +1,569 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//
+//  TSUnit test suite for class ts::FieldLayout and the PSI/SI tables which
+//  are serialized using field layouts.
+//
+//----------------------------------------------------------------------------
+
+#include "tsFieldLayout.h"
+#include "tsPAT.h"
+#include "tsPMT.h"
+#include "tsSDT.h"
+#include "tsNIT.h"
+#include "tsBAT.h"
+#include "tsEIT.h"
+#include "tsShortEventDescriptor.h"
+#include "tsBinaryTable.h"
+#include "tsSectionFile.h"
+#include "tsDuckContext.h"
+#include "tsCRC32.h"
+#include "tsNames.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+#include "tables/psi_all_sections.h"
+#include "tables/psi_pat_r4_sections.h"
+#include "tables/psi_pmt_scte35_sections.h"
+#include "tables/psi_bat_tvnum_sections.h"
+#include "tables/psi_pmt_hevc_sections.h"
+#include "tables/psi_sdt_r3_sections.h"
+#include "tables/psi_nit_tntv23_sections.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class FieldLayoutTest: public tsunit::Test
+{
+public:
+    FieldLayoutTest();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testBitField();
+    void testByteField();
+    void testReader();
+    void testWriter();
+    void testRoundTrip();
+    void testReference();
+    void testOversizedTable();
+
+    TSUNIT_TEST_BEGIN(FieldLayoutTest);
+    TSUNIT_TEST(testBitField);
+    TSUNIT_TEST(testByteField);
+    TSUNIT_TEST(testReader);
+    TSUNIT_TEST(testWriter);
+    TSUNIT_TEST(testRoundTrip);
+    TSUNIT_TEST(testReference);
+    TSUNIT_TEST(testOversizedTable);
+    TSUNIT_TEST_END();
+
+private:
+    ts::DuckContext _duck;
+
+    // Build large reference tables, spanning several sections.
+    static void BuildPAT(ts::PAT&);
+    static void BuildPMT(ts::PMT&);
+    static void BuildSDT(ts::SDT&);
+    static void BuildNIT(ts::NIT&);
+    static void BuildEIT(ts::EIT&);
+
+    // Serialize a table and return the CRC32 of all its sections.
+    uint32_t serializedCRC(const ts::AbstractTable& table, ts::BinaryTable& bin);
+
+    // Check that a binary table is identical after deserialization and serialization.
+    template <class TABLE>
+    void checkRoundTrip(const ts::BinaryTable& bin, const char* name);
+
+    // Check that all tables from a memory area are identical after deserialization and serialization.
+    void checkSections(const uint8_t* data, size_t size, const char* name);
+};
+
+TSUNIT_REGISTER(FieldLayoutTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+FieldLayoutTest::FieldLayoutTest() :
+    _duck()
+{
+}
+
+// Test suite initialization method.
+void FieldLayoutTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void FieldLayoutTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Test helpers.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Add a raw descriptor with a given tag and a payload of a given size.
+    void AddDescriptor(ts::DescriptorList& dlist, uint8_t tag, size_t size, uint8_t seed)
+    {
+        uint8_t desc[257];
+        desc[0] = tag;
+        desc[1] = uint8_t(size);
+        for (size_t i = 0; i < size; ++i) {
+            desc[2 + i] = uint8_t(seed + i);
+        }
+        dlist.add(desc, size + 2);
+    }
+}
+
+void FieldLayoutTest::BuildPAT(ts::PAT& pat)
+{
+    pat.ts_id = 0x1234;
+    pat.version = 7;
+    pat.nit_pid = ts::PID_NIT;
+    for (uint16_t i = 0; i < 600; ++i) {
+        pat.pmts[uint16_t(i + 1)] = ts::PID(0x0100 + 3 * i);
+    }
+}
+
+void FieldLayoutTest::BuildPMT(ts::PMT& pmt)
+{
+    pmt.service_id = 0x0456;
+    pmt.version = 3;
+    pmt.pcr_pid = 0x0101;
+    AddDescriptor(pmt.descs, 0x09, 4, 0x10);
+    AddDescriptor(pmt.descs, 0x80, 30, 0x20);
+    for (uint16_t i = 0; i < 40; ++i) {
+        ts::PMT::Stream& stream(pmt.streams[ts::PID(0x0101 + i)]);
+        stream.stream_type = uint8_t(i == 0 ? ts::ST_AVC_VIDEO : ts::ST_MPEG1_AUDIO);
+        AddDescriptor(stream.descs, 0x52, 1, uint8_t(i));
+        AddDescriptor(stream.descs, 0x0A, 4 * (i % 5), uint8_t(i));
+    }
+}
+
+void FieldLayoutTest::BuildSDT(ts::SDT& sdt)
+{
+    sdt.ts_id = 0x2345;
+    sdt.onetw_id = 0x3456;
+    sdt.version = 12;
+    for (uint16_t i = 0; i < 300; ++i) {
+        ts::SDT::Service& srv(sdt.services[uint16_t(0x100 + i)]);
+        srv.EITpf_present = i % 2 == 0;
+        srv.EITs_present = i % 3 == 0;
+        srv.running_status = uint8_t(i % 8);
+        srv.CA_controlled = i % 5 == 0;
+        AddDescriptor(srv.descs, 0x48, 10 + (i % 40), uint8_t(i));
+        if (i % 7 == 0) {
+            AddDescriptor(srv.descs, 0x5F, 4, uint8_t(i));
+        }
+    }
+}
+
+void FieldLayoutTest::BuildNIT(ts::NIT& nit)
+{
+    nit.network_id = 0x4567;
+    nit.version = 21;
+    for (uint8_t i = 0; i < 20; ++i) {
+        AddDescriptor(nit.descs, 0x40, 200, i);
+    }
+    for (uint16_t i = 0; i < 150; ++i) {
+        ts::NIT::Transport& ts(nit.transports[ts::TransportStreamId(uint16_t(i + 1), 0x3456)]);
+        AddDescriptor(ts.descs, 0x41, 3 * (i % 20), uint8_t(i));
+        AddDescriptor(ts.descs, 0x5A, 11, uint8_t(i));
+    }
+}
+
+void FieldLayoutTest::BuildEIT(ts::EIT& eit)
+{
+    eit.service_id = 0x0567;
+    eit.ts_id = 0x2345;
+    eit.onetw_id = 0x3456;
+    eit.last_table_id = eit.tableId();
+    eit.version = 30;
+    const ts::Time base(2020, 3, 1, 0, 0);
+    for (uint16_t i = 0; i < 200; ++i) {
+        ts::EIT::Event& ev(eit.events.newEntry());
+        ev.event_id = uint16_t(0x1000 + i);
+        ev.start_time = base + ts::MilliSecond(i) * 20 * ts::MilliSecPerMin;
+        ev.duration = 20 * 60 + i % 60;
+        ev.running_status = uint8_t(i % 5);
+        ev.CA_controlled = i % 2 != 0;
+        AddDescriptor(ev.descs, 0x4D, 40 + (i % 100), uint8_t(i));
+    }
+}
+
+uint32_t FieldLayoutTest::serializedCRC(const ts::AbstractTable& table, ts::BinaryTable& bin)
+{
+    bin.clear();
+    table.serialize(_duck, bin);
+    TSUNIT_ASSERT(bin.isValid());
+    ts::ByteBlock data;
+    for (size_t i = 0; i < bin.sectionCount(); ++i) {
+        // Exclude the CRC32 of each section, the CRC32 of a section including its CRC32 is always zero.
+        data.append(bin.sectionAt(i)->content(), bin.sectionAt(i)->size() - 4);
+    }
+    return ts::CRC32(data.data(), data.size()).value();
+}
+
+template <class TABLE>
+void FieldLayoutTest::checkRoundTrip(const ts::BinaryTable& bin, const char* name)
+{
+    debug() << "FieldLayoutTest::checkRoundTrip: " << name << ", " << ts::names::TID(bin.tableId()) << ", " << bin.sectionCount() << " sections" << std::endl;
+    TABLE table(_duck, bin);
+    TSUNIT_ASSERT(table.isValid());
+    ts::BinaryTable bin2;
+    table.serialize(_duck, bin2);
+    TSUNIT_ASSERT(bin2.isValid());
+    TSUNIT_EQUAL(bin.sectionCount(), bin2.sectionCount());
+    for (size_t i = 0; i < bin.sectionCount() && i < bin2.sectionCount(); ++i) {
+        TSUNIT_ASSERT(*bin.sectionAt(i) == *bin2.sectionAt(i));
+    }
+}
+
+void FieldLayoutTest::checkSections(const uint8_t* data, size_t size, const char* name)
+{
+    std::istringstream strm(std::string(reinterpret_cast<const char*>(data), size));
+    ts::SectionFile file(_duck);
+    TSUNIT_ASSERT(file.loadBinary(strm, CERR));
+    TSUNIT_ASSERT(!file.tables().empty());
+
+    for (auto it = file.tables().begin(); it != file.tables().end(); ++it) {
+        const ts::BinaryTable& bin(**it);
+        switch (bin.tableId()) {
+            case ts::TID_PAT:
+                checkRoundTrip<ts::PAT>(bin, name);
+                break;
+            case ts::TID_PMT:
+                checkRoundTrip<ts::PMT>(bin, name);
+                break;
+            case ts::TID_SDT_ACT:
+            case ts::TID_SDT_OTH:
+                checkRoundTrip<ts::SDT>(bin, name);
+                break;
+            case ts::TID_NIT_ACT:
+            case ts::TID_NIT_OTH:
+                checkRoundTrip<ts::NIT>(bin, name);
+                break;
+            case ts::TID_BAT:
+                checkRoundTrip<ts::BAT>(bin, name);
+                break;
+            default:
+                if (bin.tableId() >= ts::TID_EIT_MIN && bin.tableId() <= ts::TID_EIT_MAX) {
+                    checkRoundTrip<ts::EIT>(bin, name);
+                }
+                break;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test cases on layouts.
+//----------------------------------------------------------------------------
+
+namespace {
+    // A test structure with fields at odd bit offsets.
+    class TestLayout: public ts::FieldLayout<7>
+    {
+    public:
+        typedef Bits<uint8_t,   0,  3> first;     // 3 bits at start of byte 0
+        typedef Bits<bool,      3,  1> flag;      // 1 bit
+        typedef Bits<uint16_t, 11, 13> pid;       // 13 bits in bytes 1-2
+        typedef Bits<uint32_t, 26, 22> wide;      // 22 bits in bytes 3-5
+        typedef Bytes<6, 1>            raw;       // last byte
+    };
+}
+
+void FieldLayoutTest::testBitField()
+{
+    TSUNIT_EQUAL(0, TestLayout::first::FIRST_BYTE);
+    TSUNIT_EQUAL(0, TestLayout::first::LAST_BYTE);
+    TSUNIT_EQUAL(5, TestLayout::first::SHIFT);
+    TSUNIT_EQUAL(1, TestLayout::pid::FIRST_BYTE);
+    TSUNIT_EQUAL(2, TestLayout::pid::LAST_BYTE);
+    TSUNIT_EQUAL(0x1FFF, TestLayout::pid::MASK);
+    TSUNIT_EQUAL(3, TestLayout::wide::FIRST_BYTE);
+    TSUNIT_EQUAL(5, TestLayout::wide::LAST_BYTE);
+    TSUNIT_EQUAL(7, TestLayout::BYTE_SIZE);
+
+    // Reserved bits are all set to 1.
+    uint8_t data[8];
+    ::memset(data, 0x00, sizeof(data));
+    TestLayout::Init(data);
+    TSUNIT_EQUAL(0xFF, data[0]);
+    TSUNIT_EQUAL(0xFF, data[6]);
+    TSUNIT_EQUAL(0x00, data[7]);
+
+    TestLayout::first::put(data, 5);
+    TestLayout::flag::put(data, false);
+    TestLayout::pid::put(data, 0x1234);
+    TestLayout::wide::put(data, 0x2ABCDE);
+
+    static const uint8_t expected[] = {0xAF, 0xF2, 0x34, 0xEA, 0xBC, 0xDE, 0xFF, 0x00};
+    TSUNIT_EQUAL(0, ::memcmp(data, expected, sizeof(expected)));
+
+    TSUNIT_EQUAL(5, TestLayout::first::get(data));
+    TSUNIT_ASSERT(!TestLayout::flag::get(data));
+    TSUNIT_EQUAL(0x1234, TestLayout::pid::get(data));
+    TSUNIT_EQUAL(0x2ABCDE, TestLayout::wide::get(data));
+
+    // Extra upper bits are ignored, other fields are unchanged.
+    TestLayout::first::put(data, 0xFA);
+    TestLayout::flag::put(data, true);
+    TSUNIT_EQUAL(0x5F, data[0]);
+    TSUNIT_EQUAL(2, TestLayout::first::get(data));
+    TSUNIT_ASSERT(TestLayout::flag::get(data));
+    TSUNIT_EQUAL(0x1234, TestLayout::pid::get(data));
+
+    TestLayout::pid::put(data, 0xFFFF);
+    TSUNIT_EQUAL(0x1FFF, TestLayout::pid::get(data));
+    TSUNIT_EQUAL(0x5F, data[0]);
+    TSUNIT_EQUAL(0xEA, data[3]);
+}
+
+void FieldLayoutTest::testByteField()
+{
+    uint8_t data[7];
+    TestLayout::Init(data);
+    TSUNIT_EQUAL(1, TestLayout::raw::SIZE);
+    TSUNIT_ASSERT(TestLayout::raw::at(data) == data + 6);
+    *TestLayout::raw::at(data) = 0x47;
+    const uint8_t* const cdata = data;
+    TSUNIT_EQUAL(0x47, *TestLayout::raw::at(cdata));
+}
+
+void FieldLayoutTest::testReader()
+{
+    // Two entries of 7 bytes, the second one having a 3-byte descriptor list length.
+    static const uint8_t data[] = {
+        0x20, 0x00, 0x10, 0x00, 0x00, 0x03, 0xAA,
+        0x05, 0x01, 0x00,
+        0xE0, 0x00, 0x10, 0x00, 0x00, 0x05, 0xBB,
+        0x06, 0x03, 0x01, 0x02, 0x03,
+        0x11, 0x22,
+    };
+
+    ts::FieldReader reader(data, sizeof(data));
+    TSUNIT_EQUAL(sizeof(data), reader.remain());
+
+    const uint8_t* entry = reader.get<TestLayout>();
+    TSUNIT_ASSERT(entry == data);
+    TSUNIT_EQUAL(1, TestLayout::first::get(entry));
+    TSUNIT_EQUAL(0x0010, TestLayout::pid::get(entry));
+    TSUNIT_EQUAL(0xAA, *TestLayout::raw::at(entry));
+
+    ts::DescriptorList dlist(nullptr);
+    reader.getDescriptors(dlist, TestLayout::wide::get(entry));
+    TSUNIT_EQUAL(1, dlist.count());
+    TSUNIT_EQUAL(0x05, dlist[0]->tag());
+
+    entry = reader.get<TestLayout>();
+    TSUNIT_ASSERT(entry == data + 10);
+    TSUNIT_EQUAL(7, TestLayout::first::get(entry));
+    reader.getDescriptors<TestLayout::wide>(dlist, entry);
+    TSUNIT_EQUAL(2, dlist.count());
+    TSUNIT_EQUAL(0x06, dlist[1]->tag());
+    TSUNIT_EQUAL(2, reader.remain());
+    TSUNIT_ASSERT(reader.current() == data + sizeof(data) - 2);
+
+    // Not enough data for another entry, nothing is read.
+    TSUNIT_ASSERT(reader.get<TestLayout>() == nullptr);
+    TSUNIT_EQUAL(2, reader.remain());
+
+    // Descriptor list length is truncated to the remaining data.
+    reader.skip(1);
+    TSUNIT_EQUAL(1, reader.remain());
+    reader.getDescriptors(dlist, 100);
+    TSUNIT_EQUAL(0, reader.remain());
+    reader.skip(10);
+    TSUNIT_EQUAL(0, reader.remain());
+
+    // Limit the data to read.
+    ts::FieldReader limited(data, sizeof(data));
+    limited.limit(100);
+    TSUNIT_EQUAL(sizeof(data), limited.remain());
+    limited.limit(12);
+    TSUNIT_ASSERT(limited.get<TestLayout>() == data);
+    TSUNIT_EQUAL(5, limited.remain());
+    TSUNIT_ASSERT(limited.get<TestLayout>() == nullptr);
+
+    ts::FieldReader empty(nullptr, 100);
+    TSUNIT_EQUAL(0, empty.remain());
+    TSUNIT_ASSERT(empty.get<TestLayout>() == nullptr);
+}
+
+void FieldLayoutTest::testWriter()
+{
+    ts::DescriptorList dlist(nullptr);
+    AddDescriptor(dlist, 0x40, 3, 0x10);
+    AddDescriptor(dlist, 0x41, 4, 0x20);
+    TSUNIT_EQUAL(11, dlist.binarySize());
+
+    uint8_t data[24];
+    ::memset(data, 0x00, sizeof(data));
+    ts::FieldWriter writer(data, 20);
+    TSUNIT_EQUAL(20, writer.remain());
+    TSUNIT_EQUAL(0, writer.size());
+    TSUNIT_ASSERT(writer.fits<TestLayout>(dlist));
+
+    uint8_t* entry = writer.put<TestLayout>();
+    TSUNIT_ASSERT(entry == data);
+    TSUNIT_EQUAL(0xFF, data[0]);
+    TestLayout::pid::put(entry, 0x0123);
+    TSUNIT_EQUAL(2, writer.putDescriptors<TestLayout::wide>(dlist, entry));
+    TSUNIT_EQUAL(11, TestLayout::wide::get(entry));
+    TSUNIT_EQUAL(0x0123, TestLayout::pid::get(entry));
+    TSUNIT_EQUAL(18, writer.size());
+    TSUNIT_EQUAL(2, writer.remain());
+    TSUNIT_EQUAL(0x40, data[7]);
+    TSUNIT_EQUAL(0x41, data[12]);
+    TSUNIT_EQUAL(0x23, data[17]);
+
+    // Not enough space for another entry, nothing is written.
+    TSUNIT_ASSERT(!writer.fits<TestLayout>(dlist));
+    TSUNIT_ASSERT(writer.put<TestLayout>() == nullptr);
+    TSUNIT_EQUAL(18, writer.size());
+    TSUNIT_EQUAL(0x00, data[18]);
+
+    // Rewind after the first entry, only the first descriptor fits with reserved bytes.
+    writer.rewind(100);
+    TSUNIT_EQUAL(18, writer.size());
+    writer.rewind(7);
+    TSUNIT_EQUAL(13, writer.remain());
+    TSUNIT_ASSERT(writer.current() == data + 7);
+    writer.reserve(1);
+    TSUNIT_EQUAL(12, writer.remain());
+    entry = writer.put<TestLayout>();
+    TSUNIT_ASSERT(entry == data + 7);
+    TSUNIT_EQUAL(1, writer.putDescriptors<TestLayout::wide>(dlist, entry));
+    TSUNIT_EQUAL(5, TestLayout::wide::get(entry));
+    TSUNIT_EQUAL(19, writer.size());
+    TSUNIT_EQUAL(0, writer.remain());
+
+    // The reserved byte is available after release.
+    writer.release();
+    TSUNIT_EQUAL(1, writer.remain());
+    TSUNIT_EQUAL(0x00, data[19]);
+
+    ts::FieldWriter empty(nullptr, 100);
+    TSUNIT_EQUAL(0, empty.remain());
+    TSUNIT_ASSERT(empty.put<TestLayout>() == nullptr);
+}
+
+
+//----------------------------------------------------------------------------
+// Test cases on tables.
+//----------------------------------------------------------------------------
+
+void FieldLayoutTest::testRoundTrip()
+{
+    checkSections(psi_all_sections, sizeof(psi_all_sections), "psi_all");
+    checkSections(psi_pat_r4_sections, sizeof(psi_pat_r4_sections), "psi_pat_r4");
+    checkSections(psi_pmt_hevc_sections, sizeof(psi_pmt_hevc_sections), "psi_pmt_hevc");
+    checkSections(psi_pmt_scte35_sections, sizeof(psi_pmt_scte35_sections), "psi_pmt_scte35");
+    checkSections(psi_sdt_r3_sections, sizeof(psi_sdt_r3_sections), "psi_sdt_r3");
+    checkSections(psi_nit_tntv23_sections, sizeof(psi_nit_tntv23_sections), "psi_nit_tntv23");
+    checkSections(psi_bat_tvnum_sections, sizeof(psi_bat_tvnum_sections), "psi_bat_tvnum");
+}
+
+void FieldLayoutTest::testReference()
+{
+    // The reference CRC's were computed with the serializers which were used
+    // before field layouts. The serialization must remain byte-identical.
+    ts::BinaryTable bin;
+    ts::PAT pat;
+    ts::PMT pmt;
+    ts::SDT sdt;
+    ts::NIT nit;
+    ts::EIT eit(true, false, 1);
+
+    BuildPAT(pat);
+    TSUNIT_EQUAL(uint32_t(0x8E522FB1), serializedCRC(pat, bin));
+    TSUNIT_EQUAL(3, bin.sectionCount());
+    checkRoundTrip<ts::PAT>(bin, "reference PAT");
+
+    BuildPMT(pmt);
+    TSUNIT_EQUAL(uint32_t(0x7669974C), serializedCRC(pmt, bin));
+    TSUNIT_EQUAL(1, bin.sectionCount());
+    checkRoundTrip<ts::PMT>(bin, "reference PMT");
+
+    BuildSDT(sdt);
+    TSUNIT_EQUAL(uint32_t(0xFFF3D969), serializedCRC(sdt, bin));
+    TSUNIT_EQUAL(12, bin.sectionCount());
+    checkRoundTrip<ts::SDT>(bin, "reference SDT");
+
+    BuildNIT(nit);
+    TSUNIT_EQUAL(uint32_t(0x3D254EA3), serializedCRC(nit, bin));
+    TSUNIT_EQUAL(13, bin.sectionCount());
+    checkRoundTrip<ts::NIT>(bin, "reference NIT");
+
+    BuildEIT(eit);
+    TSUNIT_EQUAL(uint32_t(0xE023C8BB), serializedCRC(eit, bin));
+    TSUNIT_EQUAL(177, bin.sectionCount());
+    checkRoundTrip<ts::EIT>(bin, "reference EIT");
+}
+
+void FieldLayoutTest::testOversizedTable()
+{
+    // An EIT schedule with too many events for 256 sections.
+    // The serialized table is truncated to 256 sections but remains valid.
+    ts::EIT eit(true, false, 0, 1, true, 0x0001, 0x0002, 0x0003);
+    const ts::Time base(2020, 1, 1, 0, 0);
+    for (uint16_t i = 0; i < 400; ++i) {
+        ts::EIT::Event& ev(eit.events.newEntry());
+        ev.event_id = uint16_t(i + 1);
+        ev.start_time = base + ts::MilliSecond(i) * 30 * ts::MilliSecPerMin;
+        ev.duration = 30 * 60;
+        ev.running_status = ts::RS_NOT_RUNNING;
+        ev.descs.add(_duck, ts::ShortEventDescriptor(u"eng", ts::UString::Format(u"Event %d", {i + 1}), u"Description of the event"));
+    }
+
+    ts::BinaryTable bin;
+    eit.serialize(_duck, bin);
+    TSUNIT_ASSERT(bin.isValid());
+    TSUNIT_EQUAL(256, bin.sectionCount());
+    for (size_t i = 0; i < bin.sectionCount(); ++i) {
+        TSUNIT_EQUAL(i, bin.sectionAt(i)->sectionNumber());
+        TSUNIT_EQUAL(255, bin.sectionAt(i)->lastSectionNumber());
+    }
+
+    ts::EIT eit2(_duck, bin);
+    TSUNIT_ASSERT(eit2.isValid());
+    TSUNIT_ASSERT(!eit2.events.empty());
+    TSUNIT_ASSERT(eit2.events.size() < eit.events.size());
+}
@@ -0,0 +1,185 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::FileOutputPlugin (segmented recording)
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSProcessor.h"
+#include "tsSysUtils.h"
+#include "tsNullReport.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class FileOutputPluginTest: public tsunit::Test
+{
+public:
+    FileOutputPluginTest();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testMaxSize();
+    void testMaxDuration();
+
+    TSUNIT_TEST_BEGIN(FileOutputPluginTest);
+    TSUNIT_TEST(testMaxSize);
+    TSUNIT_TEST(testMaxDuration);
+    TSUNIT_TEST_END();
+
+private:
+    ts::UString _tempPrefix;
+
+    // Number of packets in each test, segment size in packets.
+    static constexpr size_t TOTAL_PACKETS = 20000;
+    static constexpr size_t SEGMENT_PACKETS = 1000;
+
+    // Delete all segment files.
+    void cleanup();
+
+    // Run tsp with null packets into segment files, return the sorted list of segment files.
+    void record(ts::UStringVector& files, ts::BitRate bitrate, const ts::UStringVector& options);
+
+    // Check the sizes of the segment files.
+    void checkSegments(const ts::UStringVector& files);
+};
+
+TSUNIT_REGISTER(FileOutputPluginTest);
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t FileOutputPluginTest::TOTAL_PACKETS;
+constexpr size_t FileOutputPluginTest::SEGMENT_PACKETS;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+FileOutputPluginTest::FileOutputPluginTest() :
+    _tempPrefix()
+{
+}
+
+// Test suite initialization method.
+void FileOutputPluginTest::beforeTest()
+{
+    if (_tempPrefix.empty()) {
+        _tempPrefix = ts::TempFile(u"-seg");
+    }
+    cleanup();
+}
+
+// Test suite cleanup method.
+void FileOutputPluginTest::afterTest()
+{
+    cleanup();
+}
+
+void FileOutputPluginTest::cleanup()
+{
+    ts::UStringVector files;
+    ts::ExpandWildcard(files, _tempPrefix + u"*");
+    for (auto it = files.begin(); it != files.end(); ++it) {
+        ts::DeleteFile(*it);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Run a segmented recording.
+//----------------------------------------------------------------------------
+
+void FileOutputPluginTest::record(ts::UStringVector& files, ts::BitRate bitrate, const ts::UStringVector& options)
+{
+    ts::TSProcessorArgs args;
+    args.app_name = u"utest";
+    args.fixed_bitrate = bitrate;
+    args.input.set(u"null", {ts::UString::Decimal(TOTAL_PACKETS, 0, true, u"")});
+    args.output.set(u"file", options);
+    args.output.args.push_back(_tempPrefix + u".ts");
+
+    ts::TSProcessor tsproc(NULLREP);
+    TSUNIT_ASSERT(tsproc.start(args));
+    tsproc.waitForTermination();
+
+    files.clear();
+    ts::ExpandWildcard(files, _tempPrefix + u"*.ts");
+    std::sort(files.begin(), files.end());
+    for (auto it = files.begin(); it != files.end(); ++it) {
+        debug() << "FileOutputPluginTest: " << *it << ", " << ts::GetFileSize(*it) << " bytes" << std::endl;
+    }
+}
+
+void FileOutputPluginTest::checkSegments(const ts::UStringVector& files)
+{
+    // A segment switch may be delayed when the next segment file is not ready,
+    // never advanced. No packet is lost.
+    TSUNIT_ASSERT(files.size() >= 2);
+    TSUNIT_ASSERT(files.size() <= TOTAL_PACKETS / SEGMENT_PACKETS);
+    TSUNIT_EQUAL(_tempPrefix + u"000000.ts", files.front());
+    int64_t total = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        const int64_t size = ts::GetFileSize(files[i]);
+        TSUNIT_ASSERT(size > 0);
+        TSUNIT_EQUAL(0, size % ts::PKT_SIZE);
+        if (i + 1 < files.size()) {
+            TSUNIT_ASSERT(size >= int64_t(SEGMENT_PACKETS * ts::PKT_SIZE));
+        }
+        total += size;
+    }
+    TSUNIT_EQUAL(int64_t(TOTAL_PACKETS * ts::PKT_SIZE), total);
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void FileOutputPluginTest::testMaxSize()
+{
+    ts::UStringVector files;
+    record(files, 0, {u"--max-size", ts::UString::Decimal(SEGMENT_PACKETS * ts::PKT_SIZE, 0, true, u"")});
+    checkSegments(files);
+}
+
+void FileOutputPluginTest::testMaxDuration()
+{
+    // Null packets have no PCR, the duration is computed from the bitrate: 1000 packets per second.
+    ts::UStringVector files;
+    record(files, 1000 * ts::PKT_SIZE * 8, {u"--max-duration", u"1"});
+    checkSegments(files);
+}
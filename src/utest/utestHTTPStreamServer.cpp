@@ -0,0 +1,522 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::HTTPStreamServer.
+//
+//----------------------------------------------------------------------------
+
+#include "tsHTTPStreamServer.h"
+#include "tsTCPConnection.h"
+#include "tsIPUtils.h"
+#include "tsSysUtils.h"
+#include "tsThread.h"
+#include "tsCerrReport.h"
+#include "tsNullReport.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class HTTPStreamServerTest: public tsunit::Test
+{
+public:
+    HTTPStreamServerTest();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testLiveStream();
+    void testHLS();
+    void testErrors();
+    void testSlowClient();
+    void testWaitClients();
+
+    TSUNIT_TEST_BEGIN(HTTPStreamServerTest);
+    TSUNIT_TEST(testLiveStream);
+    TSUNIT_TEST(testHLS);
+    TSUNIT_TEST(testErrors);
+    TSUNIT_TEST(testSlowClient);
+    TSUNIT_TEST(testWaitClients);
+    TSUNIT_TEST_END();
+
+private:
+    int _previousSeverity;
+};
+
+TSUNIT_REGISTER(HTTPStreamServerTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+HTTPStreamServerTest::HTTPStreamServerTest() :
+    _previousSeverity(0)
+{
+}
+
+// Test suite initialization method.
+void HTTPStreamServerTest::beforeTest()
+{
+    _previousSeverity = CERR.maxSeverity();
+    if (tsunit::Test::debugMode()) {
+        CERR.setMaxSeverity(ts::Severity::Debug);
+    }
+}
+
+// Test suite cleanup method.
+void HTTPStreamServerTest::afterTest()
+{
+    CERR.setMaxSeverity(_previousSeverity);
+}
+
+
+//----------------------------------------------------------------------------
+// Test utilities.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Build a test packet with a recognizable content.
+    // With a non-zero interval, a random access indicator is set every interval packets.
+    ts::TSPacket TestPacket(size_t index, size_t rai_interval = 0)
+    {
+        ts::TSPacket pkt;
+        pkt.init(100, uint8_t(index & 0x0F), uint8_t(index));
+        if (rai_interval > 0 && index % rai_interval == 0) {
+            pkt.b[3] |= 0x20;  // adaptation field present
+            pkt.b[4] = 1;      // adaptation field length
+            pkt.b[5] = 0x40;   // random access indicator
+        }
+        return pkt;
+    }
+
+    // A simple blocking HTTP client.
+    class HTTPClient
+    {
+        TS_NOCOPY(HTTPClient);
+    public:
+        HTTPClient(const ts::SocketAddress& server) : _server(server), _conn(), _data() {}
+
+        // Connect to the test server.
+        bool connect(size_t receive_buffer_size = 0)
+        {
+            return _conn.open(CERR) &&
+                (receive_buffer_size == 0 || _conn.setReceiveBufferSize(receive_buffer_size, CERR)) &&
+                _conn.setReceiveTimeout(5000, CERR) &&
+                _conn.connect(_server, CERR);
+        }
+
+        // Send a request.
+        bool send(const std::string& request)
+        {
+            return _conn.send(request.data(), request.size(), CERR);
+        }
+
+        // Receive until the received data contain at least a given size.
+        bool receive(size_t size)
+        {
+            char buffer[4096];
+            size_t got = 0;
+            while (_data.size() < size) {
+                if (!_conn.receive(buffer, sizeof(buffer), got, nullptr, NULLREP)) {
+                    return false;
+                }
+                _data.append(buffer, got);
+            }
+            return true;
+        }
+
+        // Extract a given size of received data.
+        bool read(std::string& data, size_t size)
+        {
+            if (!receive(size)) {
+                return false;
+            }
+            data = _data.substr(0, size);
+            _data.erase(0, size);
+            return true;
+        }
+
+        // Extract received data up to a given delimiter.
+        bool readUntil(std::string& data, const std::string& delimiter)
+        {
+            size_t end = std::string::npos;
+            while ((end = _data.find(delimiter)) == std::string::npos) {
+                if (!receive(_data.size() + 1)) {
+                    return false;
+                }
+            }
+            return read(data, end + delimiter.size());
+        }
+
+        // Read a response header, return the status.
+        int readHeader(std::string& header)
+        {
+            int status = 0;
+            return readUntil(header, "\r\n\r\n") && header.size() > 12 && ts::UString::FromUTF8(header.substr(9, 3)).toInteger(status) ? status : 0;
+        }
+
+        // Read a complete response with a Content-Length, return the status.
+        int readResponse(std::string& body)
+        {
+            std::string header;
+            const int status = readHeader(header);
+            const size_t pos = header.find("Content-Length: ");
+            size_t length = 0;
+            body.clear();
+            if (status == 0 || pos == std::string::npos || !ts::UString::FromUTF8(header.substr(pos + 16, header.find("\r\n", pos) - pos - 16)).toInteger(length)) {
+                return 0;
+            }
+            return read(body, length) ? status : 0;
+        }
+
+        // Check if the server closed the connection.
+        bool closed()
+        {
+            return _data.empty() && !receive(1) && !_conn.isConnected();
+        }
+
+    private:
+        ts::SocketAddress _server;
+        ts::TCPConnection _conn;
+        std::string       _data;
+    };
+
+    // Open a test server on a port which is allocated by the system, return its address.
+    bool OpenServer(ts::HTTPStreamServer& server, ts::HTTPStreamServer::Args& args, ts::SocketAddress& address)
+    {
+        args.local_address = ts::SocketAddress(ts::IPAddress::LocalHost, ts::SocketAddress::AnyPort);
+        return server.open(args, CERR) && server.getLocalAddress(address, CERR) && address.hasPort();
+    }
+
+    // A thread which adds packets to a server, in batches of 100 packets.
+    class WriterThread: public ts::Thread
+    {
+        TS_NOBUILD_NOCOPY(WriterThread);
+    public:
+        WriterThread(ts::HTTPStreamServer& server, const std::vector<ts::TSPacket>& packets) : ts::Thread(), _server(server), _packets(packets) {}
+        // Closing the server unblocks addPackets() if the test failed.
+        virtual ~WriterThread() override { _server.close(); waitForTermination(); }
+        virtual void main() override
+        {
+            for (size_t i = 0; i < _packets.size(); i += 100) {
+                _server.addPackets(&_packets[i], std::min<size_t>(100, _packets.size() - i));
+            }
+        }
+    private:
+        ts::HTTPStreamServer& _server;
+        const std::vector<ts::TSPacket>& _packets;
+    };
+
+    // Wait until a condition becomes true, at most a few seconds.
+    template <class PREDICATE>
+    bool WaitFor(PREDICATE pred)
+    {
+        for (int i = 0; i < 500 && !pred(); ++i) {
+            ts::SleepThread(10);
+        }
+        return pred();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void HTTPStreamServerTest::testLiveStream()
+{
+    TSUNIT_ASSERT(ts::IPInitialize());
+
+    ts::HTTPStreamServer::Args args;
+    args.buffer_packets = 1000;
+
+    ts::HTTPStreamServer server;
+    ts::SocketAddress address;
+    TSUNIT_ASSERT(OpenServer(server, args, address));
+    TSUNIT_ASSERT(server.isOpen());
+
+    // Packets which are sent before the client connects are not received.
+    for (size_t i = 0; i < 10; ++i) {
+        const ts::TSPacket pkt(TestPacket(1000 + i));
+        server.addPackets(&pkt, 1);
+    }
+
+    // Two clients, HTTP/1.1 (chunked) and HTTP/1.0 (raw).
+    HTTPClient client1(address);
+    HTTPClient client2(address);
+    TSUNIT_ASSERT(client1.connect());
+    TSUNIT_ASSERT(client2.connect());
+    TSUNIT_ASSERT(client1.send("GET /stream.ts HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+    TSUNIT_ASSERT(client2.send("GET / HTTP/1.0\r\n\r\n"));
+
+    std::string header;
+    TSUNIT_EQUAL(200, client1.readHeader(header));
+    TSUNIT_ASSERT(header.find("Content-Type: video/mp2t\r\n") != std::string::npos);
+    TSUNIT_ASSERT(header.find("Transfer-Encoding: chunked\r\n") != std::string::npos);
+    TSUNIT_EQUAL(200, client2.readHeader(header));
+    TSUNIT_ASSERT(header.find("Transfer-Encoding") == std::string::npos);
+    TSUNIT_EQUAL(2, server.clientCount());
+
+    // Packets are added in several calls, going around the ring buffer.
+    const size_t count = 1500;
+    std::string expected;
+    for (size_t i = 0; i < count; i += 100) {
+        std::vector<ts::TSPacket> packets;
+        for (size_t j = i; j < i + 100; ++j) {
+            packets.push_back(TestPacket(j));
+            expected.append(reinterpret_cast<const char*>(packets.back().b), ts::PKT_SIZE);
+        }
+        server.addPackets(packets.data(), packets.size());
+        ts::SleepThread(20);
+    }
+
+    // Decode chunks from client 1.
+    std::string received;
+    while (received.size() < expected.size()) {
+        std::string line;
+        std::string chunk;
+        size_t size = 0;
+        TSUNIT_ASSERT(client1.readUntil(line, "\r\n"));
+        TSUNIT_ASSERT((u"0x" + ts::UString::FromUTF8(line.substr(0, line.size() - 2))).toInteger(size));
+        TSUNIT_ASSERT(size > 0);
+        TSUNIT_EQUAL(0, size % ts::PKT_SIZE);
+        TSUNIT_ASSERT(client1.read(chunk, size + 2));
+        TSUNIT_ASSERT(chunk.substr(size) == "\r\n");
+        received.append(chunk.substr(0, size));
+    }
+    TSUNIT_EQUAL(expected.size(), received.size());
+    TSUNIT_ASSERT(expected == received);
+
+    // Raw stream from client 2.
+    TSUNIT_ASSERT(client2.read(received, expected.size()));
+    TSUNIT_ASSERT(expected == received);
+
+    server.close();
+    TSUNIT_ASSERT(!server.isOpen());
+    TSUNIT_ASSERT(client1.closed());
+    TSUNIT_ASSERT(client2.closed());
+}
+
+void HTTPStreamServerTest::testHLS()
+{
+    TSUNIT_ASSERT(ts::IPInitialize());
+
+    ts::HTTPStreamServer::Args args;
+    args.hls = true;
+    args.hls_duration = 1;
+    args.hls_live = 2;
+
+    ts::HTTPStreamServer server;
+    ts::SocketAddress address;
+    TSUNIT_ASSERT(OpenServer(server, args, address));
+
+    // No playlist before the first segment.
+    HTTPClient client(address);
+    std::string body;
+    TSUNIT_ASSERT(client.connect());
+    TSUNIT_ASSERT(client.send("GET /stream.m3u8 HTTP/1.1\r\n\r\n"));
+    TSUNIT_EQUAL(404, client.readResponse(body));
+
+    // At 1,504,000 b/s, 1000 packets per second: segments of one second, cut on random access points.
+    const size_t count = 3500;
+    std::vector<ts::TSPacket> packets;
+    for (size_t i = 0; i < count; ++i) {
+        packets.push_back(TestPacket(i, 500));
+    }
+    server.addPackets(packets.data(), packets.size(), 1504000);
+
+    // Pipelined requests on a persistent connection.
+    TSUNIT_ASSERT(client.send("GET /stream.m3u8 HTTP/1.1\r\n\r\n"
+                              "GET /segment-1.ts HTTP/1.1\r\n\r\n"
+                              "GET /segment-0.ts?foo=bar HTTP/1.1\r\n\r\n"
+                              "GET /segment-3.ts HTTP/1.1\r\n\r\n"
+                              "HEAD /segment-2.ts HTTP/1.1\r\nConnection: close\r\n\r\n"));
+
+    TSUNIT_EQUAL(200, client.readResponse(body));
+    debug() << "HTTPStreamServerTest: playlist:" << std::endl << body;
+    TSUNIT_ASSERT(body.find("#EXTM3U") == 0);
+    TSUNIT_ASSERT(body.find("#EXT-X-TARGETDURATION:1") != std::string::npos);
+    TSUNIT_ASSERT(body.find("#EXT-X-MEDIA-SEQUENCE:1") != std::string::npos);
+    TSUNIT_ASSERT(body.find("segment-0.ts") == std::string::npos);
+    TSUNIT_ASSERT(body.find("segment-1.ts") != std::string::npos);
+    TSUNIT_ASSERT(body.find("segment-2.ts") != std::string::npos);
+    TSUNIT_ASSERT(body.find("segment-3.ts") == std::string::npos);
+
+    // Segment 1 contains packets 1000 to 1999.
+    TSUNIT_EQUAL(200, client.readResponse(body));
+    TSUNIT_EQUAL(1000 * ts::PKT_SIZE, body.size());
+    TSUNIT_ASSERT(body == std::string(reinterpret_cast<const char*>(packets[1000].b), 1000 * ts::PKT_SIZE));
+
+    // Segment 0 is no longer in the playlist but is still available.
+    TSUNIT_EQUAL(200, client.readResponse(body));
+    TSUNIT_ASSERT(body == std::string(reinterpret_cast<const char*>(packets[0].b), 1000 * ts::PKT_SIZE));
+
+    // Segment 3 is not yet complete.
+    TSUNIT_EQUAL(404, client.readResponse(body));
+
+    // HEAD request: header only, then the connection is closed.
+    std::string header;
+    TSUNIT_EQUAL(200, client.readHeader(header));
+    TSUNIT_ASSERT(header.find("Content-Length: 188000\r\n") != std::string::npos);
+    TSUNIT_ASSERT(header.find("Connection: close\r\n") != std::string::npos);
+    TSUNIT_ASSERT(client.closed());
+
+    server.close();
+}
+
+void HTTPStreamServerTest::testErrors()
+{
+    TSUNIT_ASSERT(ts::IPInitialize());
+
+    ts::HTTPStreamServer::Args args;
+    args.max_clients = 2;
+
+    ts::HTTPStreamServer server;
+    ts::SocketAddress address;
+    TSUNIT_ASSERT(OpenServer(server, args, address));
+
+    std::string body;
+    HTTPClient client1(address);
+    TSUNIT_ASSERT(client1.connect());
+    TSUNIT_ASSERT(client1.send("POST /stream.ts HTTP/1.1\r\n\r\n"));
+    TSUNIT_EQUAL(405, client1.readResponse(body));
+    TSUNIT_ASSERT(client1.closed());
+
+    HTTPClient client2(address);
+    TSUNIT_ASSERT(client2.connect());
+    TSUNIT_ASSERT(client2.send("HELLO\r\n\r\n"));
+    TSUNIT_EQUAL(400, client2.readResponse(body));
+    TSUNIT_ASSERT(client2.closed());
+
+    // HLS is not enabled.
+    HTTPClient client3(address);
+    TSUNIT_ASSERT(client3.connect());
+    TSUNIT_ASSERT(client3.send("GET /stream.m3u8 HTTP/1.0\r\n\r\n"));
+    TSUNIT_EQUAL(404, client3.readResponse(body));
+    TSUNIT_ASSERT(client3.closed());
+
+    // Too many clients.
+    HTTPClient client4(address);
+    HTTPClient client5(address);
+    HTTPClient client6(address);
+    TSUNIT_ASSERT(client4.connect());
+    TSUNIT_ASSERT(client5.connect());
+    TSUNIT_ASSERT(WaitFor([&server]() { return server.clientCount() == 2; }));
+    TSUNIT_ASSERT(client6.connect());
+    TSUNIT_ASSERT(client6.closed());
+    TSUNIT_EQUAL(2, server.clientCount());
+
+    server.close();
+}
+
+void HTTPStreamServerTest::testSlowClient()
+{
+    TSUNIT_ASSERT(ts::IPInitialize());
+
+    ts::HTTPStreamServer::Args args;
+    args.buffer_packets = 1000;
+    args.max_lag = 500;
+    args.send_buffer_size = 4096;
+
+    ts::HTTPStreamServer server;
+    ts::SocketAddress address;
+    TSUNIT_ASSERT(OpenServer(server, args, address));
+
+    // The client never reads the stream.
+    HTTPClient client(address);
+    TSUNIT_ASSERT(client.connect(1024));
+    TSUNIT_ASSERT(client.send("GET /stream.ts HTTP/1.1\r\n\r\n"));
+    TSUNIT_ASSERT(WaitFor([&server]() { return server.clientCount() == 1; }));
+
+    const ts::TSPacket pkt(TestPacket(0));
+    for (size_t i = 0; i < 20000 && server.clientCount() > 0; ++i) {
+        server.addPackets(&pkt, 1);
+        if (i % 100 == 0) {
+            ts::SleepThread(1);
+        }
+    }
+    TSUNIT_ASSERT(WaitFor([&server]() { return server.clientCount() == 0; }));
+
+    server.close();
+}
+
+void HTTPStreamServerTest::testWaitClients()
+{
+    TSUNIT_ASSERT(ts::IPInitialize());
+
+    ts::HTTPStreamServer::Args args;
+    args.buffer_packets = 1000;
+    args.max_lag = 500;
+    args.send_buffer_size = 4096;
+    args.wait_clients = true;
+
+    ts::HTTPStreamServer server;
+    ts::SocketAddress address;
+    TSUNIT_ASSERT(OpenServer(server, args, address));
+
+    HTTPClient client(address);
+    std::string header;
+    TSUNIT_ASSERT(client.connect(1024));
+    TSUNIT_ASSERT(client.send("GET /stream.ts HTTP/1.0\r\n\r\n"));
+    TSUNIT_EQUAL(200, client.readHeader(header));
+    TSUNIT_ASSERT(WaitFor([&server]() { return server.clientCount() == 1; }));
+
+    // The packets are added much faster than the client reads them. As in testSlowClient,
+    // the client would be disconnected without wait_clients. Here, it receives all packets.
+    const size_t count = 20000;
+    std::vector<ts::TSPacket> packets;
+    std::string expected;
+    for (size_t i = 0; i < count; ++i) {
+        packets.push_back(TestPacket(i));
+        expected.append(reinterpret_cast<const char*>(packets.back().b), ts::PKT_SIZE);
+    }
+
+    WriterThread writer(server, packets);
+    TSUNIT_ASSERT(writer.start());
+    std::string received;
+    for (size_t i = 0; i < count; i += 1000) {
+        std::string data;
+        TSUNIT_ASSERT(client.read(data, 1000 * ts::PKT_SIZE));
+        received.append(data);
+        ts::SleepThread(5);
+    }
+    TSUNIT_ASSERT(writer.waitForTermination());
+    TSUNIT_EQUAL(expected.size(), received.size());
+    TSUNIT_ASSERT(expected == received);
+    TSUNIT_EQUAL(1, server.clientCount());
+
+    server.close();
+    TSUNIT_ASSERT(client.closed());
+}
@@ -53,6 +53,8 @@ public:
     void testRoundDown();
     void testRoundUp();
     void testSignExtend();
+    void testCountOneBits();
+    void testCountTrailingZeroBits();
 
     TSUNIT_TEST_BEGIN(IntegerUtilsTest);
     TSUNIT_TEST(testBoundedAdd);
@@ -60,6 +62,8 @@ public:
     TSUNIT_TEST(testRoundDown);
     TSUNIT_TEST(testRoundUp);
     TSUNIT_TEST(testSignExtend);
+    TSUNIT_TEST(testCountOneBits);
+    TSUNIT_TEST(testCountTrailingZeroBits);
     TSUNIT_TEST_END();
 };
 
@@ -191,3 +195,23 @@ void IntegerUtilsTest::testSignExtend()
     TSUNIT_EQUAL(-2047, ts::SignExtend(int16_t(0x0801), 12));
     TSUNIT_EQUAL(-2048, ts::SignExtend(int16_t(0x2800), 12));
 }
+
+void IntegerUtilsTest::testCountOneBits()
+{
+    TSUNIT_EQUAL(0, ts::CountOneBits(0));
+    TSUNIT_EQUAL(1, ts::CountOneBits(1));
+    TSUNIT_EQUAL(8, ts::CountOneBits(0xFF));
+    TSUNIT_EQUAL(32, ts::CountOneBits(TS_UCONST64(0xAAAAAAAAAAAAAAAA)));
+    TSUNIT_EQUAL(63, ts::CountOneBits(TS_UCONST64(0x7FFFFFFFFFFFFFFF)));
+    TSUNIT_EQUAL(64, ts::CountOneBits(TS_UCONST64(0xFFFFFFFFFFFFFFFF)));
+}
+
+void IntegerUtilsTest::testCountTrailingZeroBits()
+{
+    TSUNIT_EQUAL(64, ts::CountTrailingZeroBits(0));
+    TSUNIT_EQUAL(0, ts::CountTrailingZeroBits(1));
+    TSUNIT_EQUAL(0, ts::CountTrailingZeroBits(TS_UCONST64(0xFFFFFFFFFFFFFFFF)));
+    TSUNIT_EQUAL(4, ts::CountTrailingZeroBits(0xF0));
+    TSUNIT_EQUAL(36, ts::CountTrailingZeroBits(TS_UCONST64(0x0000003000000000)));
+    TSUNIT_EQUAL(63, ts::CountTrailingZeroBits(TS_UCONST64(0x8000000000000000)));
+}
@@ -40,6 +40,7 @@
 #include "tsjsonString.h"
 #include "tsjsonObject.h"
 #include "tsjsonArray.h"
+#include "tsjsonReader.h"
 #include "tsCerrReport.h"
 #include "tsNullReport.h"
 #include "tsunit.h"
@@ -58,11 +59,26 @@ public:
 
     void testSimple();
     void testGitHub();
+    void testReader();
+    void testReaderChunks();
+    void testReaderPath();
+    void testReaderErrors();
 
     TSUNIT_TEST_BEGIN(JsonTest);
     TSUNIT_TEST(testSimple);
     TSUNIT_TEST(testGitHub);
+    TSUNIT_TEST(testReader);
+    TSUNIT_TEST(testReaderChunks);
+    TSUNIT_TEST(testReaderPath);
+    TSUNIT_TEST(testReaderErrors);
     TSUNIT_TEST_END();
+
+private:
+    // Read all events from a JSON text and return a one-line summary.
+    static ts::UString Events(const std::string& text, size_t chunk_size);
+
+    // Build a large JSON event feed.
+    static std::string BuildFeed(size_t count);
 };
 
 TSUNIT_REGISTER(JsonTest);
@@ -603,3 +619,158 @@ void JsonTest::testGitHub()
         u"}",
         jv->printed());
 }
+
+ts::UString JsonTest::Events(const std::string& text, size_t chunk_size)
+{
+    std::istringstream strm(text);
+    ts::json::Reader reader(strm, NULLREP, chunk_size);
+    ts::UString result;
+    for (;;) {
+        const ts::json::Reader::Event ev = reader.next();
+        if (!result.empty()) {
+            result.push_back(u' ');
+        }
+        switch (ev) {
+            case ts::json::Reader::BeginObject: result.append(u"{"); break;
+            case ts::json::Reader::EndObject:   result.append(u"}"); break;
+            case ts::json::Reader::BeginArray:  result.append(u"["); break;
+            case ts::json::Reader::EndArray:    result.append(u"]"); break;
+            case ts::json::Reader::Name:        result.append(reader.text() + u":"); break;
+            case ts::json::Reader::StringValue: result.append(u"'" + reader.text() + u"'"); break;
+            case ts::json::Reader::NumberValue: result.append(reader.text()); break;
+            case ts::json::Reader::NullValue:   result.append(u"null"); break;
+            case ts::json::Reader::TrueValue:   result.append(u"true"); break;
+            case ts::json::Reader::FalseValue:  result.append(u"false"); break;
+            case ts::json::Reader::EndOfStream: result.append(u"EOS"); return result;
+            case ts::json::Reader::Error:       result.append(u"ERROR"); return result;
+            default: result.append(u"?"); return result;
+        }
+    }
+}
+
+std::string JsonTest::BuildFeed(size_t count)
+{
+    std::string text("{\"source\": \"scheduler\", \"events\": [\n");
+    for (size_t i = 0; i < count; ++i) {
+        text.append(ts::UString::Format(u"  {\"id\": %d, \"service\": %d, \"start\": \"2020-01-01T%02d:%02d:00Z\", \"duration\": 1800, "
+                                        u"\"title\": \"Event \\\"%d\\\"\", \"running\": %s, \"tags\": [\"news\", \"live\", null]}%s\n",
+                                        {i, 100 + i % 10, (i / 60) % 24, i % 60, i, i % 2 == 0, i + 1 < count ? u"," : u""}).toUTF8());
+    }
+    text.append("]}\n");
+    return text;
+}
+
+void JsonTest::testReader()
+{
+    TSUNIT_EQUAL(u"EOS", Events("", 1024));
+    TSUNIT_EQUAL(u"null EOS", Events(" null  ", 1024));
+    TSUNIT_EQUAL(u"[ true { ab: 67 foo: 'bar' } ] EOS", Events("[ true, {\"ab\":67, \"foo\" : \"bar\"} ]", 1024));
+    TSUNIT_EQUAL(u"{ } [ ] -12 1.5e3 false EOS", Events("{} [] -12 1.5e3 false", 1024));
+    TSUNIT_EQUAL(u"{ a: 'x\"y\\\\z/é€' } EOS", Events("\xEF\xBB\xBF{\"a\": \"x\\\"y\\\\\\\\z\\/\xC3\xA9\\u20AC\"}", 1024));
+
+    // JSON lines: one value per line.
+    TSUNIT_EQUAL(u"{ id: 1 } { id: 2 } EOS", Events("{\"id\": 1}\n{\"id\": 2}\n", 1024));
+
+    // Compare with the tree parser.
+    std::istringstream strm(BuildFeed(10));
+    ts::json::Reader reader(strm, CERR);
+    ts::json::ValuePtr jv1, jv2;
+    TSUNIT_EQUAL(ts::json::Reader::BeginObject, reader.next());
+    TSUNIT_ASSERT(reader.readValue(jv1));
+    TSUNIT_EQUAL(ts::json::Reader::EndOfStream, reader.next());
+    TSUNIT_ASSERT(ts::json::Parse(jv2, ts::UString::FromUTF8(BuildFeed(10)), CERR));
+    TSUNIT_ASSERT(!jv1.isNull());
+    TSUNIT_ASSERT(!jv2.isNull());
+    TSUNIT_EQUAL(jv2->printed(), jv1->printed());
+    TSUNIT_EQUAL(u"Event \"3\"", jv1->value(u"events").at(3).value(u"title").toString());
+}
+
+void JsonTest::testReaderChunks()
+{
+    // The result shall not depend on chunk boundaries.
+    const std::string text(BuildFeed(20));
+    const ts::UString ref(Events(text, 1024 * 1024));
+    TSUNIT_ASSERT(ref.endWith(u"] } EOS"));
+    for (size_t size = 1; size <= 40; ++size) {
+        TSUNIT_EQUAL(ref, Events(text, size));
+    }
+}
+
+void JsonTest::testReaderPath()
+{
+    std::istringstream strm(BuildFeed(5));
+    ts::json::Reader reader(strm, CERR, 7);
+
+    TSUNIT_ASSERT(reader.findNext(u"source"));
+    TSUNIT_EQUAL(ts::json::Reader::StringValue, reader.event());
+    TSUNIT_EQUAL(u"scheduler", reader.text());
+    TSUNIT_EQUAL(u"source", reader.path());
+    TSUNIT_EQUAL(1, reader.depth());
+
+    TSUNIT_ASSERT(reader.findNext(u"events[*].title"));
+    TSUNIT_EQUAL(u"events[0].title", reader.path());
+    TSUNIT_ASSERT(reader.matchPath(u"events[0].title"));
+    TSUNIT_ASSERT(reader.matchPath(u"events[*].*"));
+    TSUNIT_ASSERT(!reader.matchPath(u"events[1].title"));
+    TSUNIT_ASSERT(!reader.matchPath(u"events.title"));
+    TSUNIT_EQUAL(u"Event \"0\"", reader.text());
+
+    // Extract a complete element.
+    TSUNIT_ASSERT(reader.findNext(u"events[3]"));
+    TSUNIT_EQUAL(ts::json::Reader::BeginObject, reader.event());
+    ts::json::ValuePtr jv;
+    TSUNIT_ASSERT(reader.readValue(jv));
+    TSUNIT_EQUAL(ts::json::Reader::EndObject, reader.event());
+    TSUNIT_EQUAL(u"events[3]", reader.path());
+    TSUNIT_EQUAL(3, jv->value(u"id").toInteger());
+    TSUNIT_EQUAL(3, jv->value(u"tags").size());
+
+    // Skip an element.
+    TSUNIT_EQUAL(ts::json::Reader::BeginObject, reader.next());
+    TSUNIT_EQUAL(u"events[4]", reader.path());
+    TSUNIT_ASSERT(reader.skipValue());
+    TSUNIT_EQUAL(ts::json::Reader::EndObject, reader.event());
+    TSUNIT_EQUAL(ts::json::Reader::EndArray, reader.next());
+    TSUNIT_EQUAL(u"events", reader.path());
+
+    int64_t id = 0;
+    TSUNIT_ASSERT(!reader.findNext(u"events[*].id"));
+    TSUNIT_EQUAL(ts::json::Reader::EndOfStream, reader.event());
+    TSUNIT_ASSERT(!reader.intValue(id));
+}
+
+void JsonTest::testReaderErrors()
+{
+    TSUNIT_EQUAL(u"[ 1 ERROR", Events("[1 2]", 1024));
+    TSUNIT_EQUAL(u"[ 1 ERROR", Events("[1,]", 1024));
+    TSUNIT_EQUAL(u"{ ERROR", Events("{,}", 1024));
+    TSUNIT_EQUAL(u"{ ERROR", Events("{\"a\" 1}", 1024));
+    TSUNIT_EQUAL(u"{ a: 1 ERROR", Events("{\"a\": 1", 1024));
+    TSUNIT_EQUAL(u"ERROR", Events("\"abc", 1024));
+    TSUNIT_EQUAL(u"ERROR", Events("nul", 1024));
+    TSUNIT_EQUAL(u"true ERROR", Events("true xyz", 1024));
+
+    // Malformed numbers.
+    TSUNIT_EQUAL(u"[ 0 -1.5e+3 2E-2 ] EOS", Events("[0, -1.5e+3, 2E-2]", 4));
+    TSUNIT_EQUAL(u"ERROR", Events("-", 1024));
+    TSUNIT_EQUAL(u"ERROR", Events("--1", 1024));
+    TSUNIT_EQUAL(u"ERROR", Events("01", 1024));
+    TSUNIT_EQUAL(u"ERROR", Events("-01", 2));
+    TSUNIT_EQUAL(u"ERROR", Events("1.", 1024));
+    TSUNIT_EQUAL(u"ERROR", Events(".5", 1024));
+    TSUNIT_EQUAL(u"ERROR", Events("1.2.3", 1024));
+    TSUNIT_EQUAL(u"ERROR", Events("1e", 1024));
+    TSUNIT_EQUAL(u"ERROR", Events("1e+", 3));
+    TSUNIT_EQUAL(u"ERROR", Events("1-2", 1024));
+    TSUNIT_EQUAL(u"[ ERROR", Events("[+1]", 1024));
+
+    std::istringstream strm("[1,\n2,\n#]");
+    ts::json::Reader reader(strm);
+    ts::json::ValuePtr jv;
+    TSUNIT_EQUAL(ts::json::Reader::BeginArray, reader.next());
+    TSUNIT_ASSERT(!reader.readValue(jv));
+    TSUNIT_ASSERT(jv.isNull());
+    TSUNIT_EQUAL(ts::json::Reader::Error, reader.event());
+    TSUNIT_EQUAL(ts::json::Reader::Error, reader.next());
+    TSUNIT_EQUAL(3, reader.lineNumber());
+}
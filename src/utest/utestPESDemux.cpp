@@ -0,0 +1,179 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::PESDemux
+//
+//----------------------------------------------------------------------------
+
+#include "tsPESDemux.h"
+#include "tsDuckContext.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class PESDemuxTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testReassembly();
+    void testRetain();
+
+    TSUNIT_TEST_BEGIN(PESDemuxTest);
+    TSUNIT_TEST(testReassembly);
+    TSUNIT_TEST(testRetain);
+    TSUNIT_TEST_END();
+};
+
+TSUNIT_REGISTER(PESDemuxTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void PESDemuxTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void PESDemuxTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Test data: PES packets with a short header, in 3 TS packets each.
+// The payload of PES packet number N is filled with N.
+//----------------------------------------------------------------------------
+
+namespace {
+    const ts::PID TEST_PID = 100;
+    const size_t PES_SIZE = 3 * 184;
+    const uint8_t PES_SID = 0xBF;  // private_stream_2, short header
+
+    void FeedPES(ts::PESDemux& demux, uint8_t index)
+    {
+        uint8_t pes[PES_SIZE];
+        ::memset(pes, index, sizeof(pes));
+        pes[0] = pes[1] = 0x00;
+        pes[2] = 0x01;
+        pes[3] = PES_SID;
+        ts::PutUInt16(pes + 4, uint16_t(PES_SIZE - 6));
+
+        for (size_t i = 0; i < 3; ++i) {
+            ts::TSPacket pkt;
+            pkt.init(TEST_PID, uint8_t((3 * index + i) & ts::CC_MASK));
+            pkt.setPUSI(i == 0);
+            ::memcpy(pkt.getPayload(), pes + 184 * i, 184);
+            demux.feedPacket(pkt);
+        }
+    }
+
+    // Check that a PES packet was built by FeedPES().
+    bool CheckPES(const ts::PESPacket& pes, uint8_t index)
+    {
+        if (!pes.isValid() || pes.size() != PES_SIZE || pes.payloadSize() != PES_SIZE - 6) {
+            return false;
+        }
+        for (size_t i = 0; i < pes.payloadSize(); ++i) {
+            if (pes.payload()[i] != index) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // A PES handler which keeps some packets.
+    class PESCollector: public ts::PESHandlerInterface
+    {
+    public:
+        PESCollector(bool retain) : count(0), valid(0), retain_packets(retain), packets() {}
+        size_t count;
+        size_t valid;
+        bool retain_packets;
+        ts::PESPacketPtrVector packets;
+
+        virtual void handlePESPacket(ts::PESDemux& demux, const ts::PESPacket& packet) override
+        {
+            if (CheckPES(packet, uint8_t(count))) {
+                valid++;
+            }
+            if (retain_packets && count % 2 == 0) {
+                // Keep packet without copy.
+                packets.push_back(new ts::PESPacket(packet, ts::SHARE));
+            }
+            count++;
+        }
+    };
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void PESDemuxTest::testReassembly()
+{
+    ts::DuckContext duck;
+    PESCollector handler(false);
+    ts::PESDemux demux(duck, &handler);
+
+    for (uint8_t i = 0; i < 50; ++i) {
+        FeedPES(demux, i);
+    }
+    TSUNIT_EQUAL(50, handler.count);
+    TSUNIT_EQUAL(50, handler.valid);
+}
+
+void PESDemuxTest::testRetain()
+{
+    ts::DuckContext duck;
+    PESCollector handler(true);
+    ts::PESDemux demux(duck, &handler);
+
+    for (uint8_t i = 0; i < 20; ++i) {
+        FeedPES(demux, i);
+    }
+    TSUNIT_EQUAL(20, handler.count);
+    TSUNIT_EQUAL(20, handler.valid);
+
+    // The retained packets were not overwritten by subsequent packets.
+    TSUNIT_EQUAL(10, handler.packets.size());
+    for (size_t i = 0; i < handler.packets.size(); ++i) {
+        TSUNIT_ASSERT(CheckPES(*handler.packets[i], uint8_t(2 * i)));
+        TSUNIT_EQUAL(TEST_PID, handler.packets[i]->getSourcePID());
+    }
+}
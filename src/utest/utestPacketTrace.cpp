@@ -0,0 +1,234 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for classes ts::PacketTraceWriter and ts::PacketTraceReader
+//
+//----------------------------------------------------------------------------
+
+#include "tsPacketTraceWriter.h"
+#include "tsPacketTraceReader.h"
+#include "tsReportBuffer.h"
+#include "tsSysUtils.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class PacketTraceTest: public tsunit::Test
+{
+public:
+    PacketTraceTest();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testRoundTrip();
+    void testEmpty();
+    void testCorrupted();
+
+    TSUNIT_TEST_BEGIN(PacketTraceTest);
+    TSUNIT_TEST(testRoundTrip);
+    TSUNIT_TEST(testEmpty);
+    TSUNIT_TEST(testCorrupted);
+    TSUNIT_TEST_END();
+
+private:
+    ts::UString _tempFile;
+
+    // Build a set of test rows.
+    static void BuildRows(ts::PacketTraceRecordVector& rows, size_t count);
+};
+
+TSUNIT_REGISTER(PacketTraceTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+PacketTraceTest::PacketTraceTest() :
+    _tempFile()
+{
+}
+
+// Test suite initialization method.
+void PacketTraceTest::beforeTest()
+{
+    _tempFile = ts::TempFile(u".tstrace");
+}
+
+// Test suite cleanup method.
+void PacketTraceTest::afterTest()
+{
+    ts::DeleteFile(_tempFile);
+}
+
+// Build a set of test rows, with increasing and decreasing values.
+void PacketTraceTest::BuildRows(ts::PacketTraceRecordVector& rows, size_t count)
+{
+    rows.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        ts::PacketTraceRecord& rec(rows[i]);
+        rec.packet = 3 * i + 12345678901ULL;
+        rec.pid = ts::PID(i % 7 == 0 ? size_t(ts::PID_NULL) : 100 + i % 5);
+        rec.event = uint8_t(i % 2 == 0 ? ts::PacketTraceRecord::PTS : ts::PacketTraceRecord::PCR);
+        rec.flags = uint16_t(i & 0x0003);
+        rec.value = i % 3 == 0 ? 0xFFFFFFFFFFFFFFFFULL - i : i * 3600;
+        rec.pcr = i % 11 == 0 ? ts::INVALID_PCR : i * 1000;
+        rec.extra = i / 2;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void PacketTraceTest::testRoundTrip()
+{
+    ts::PacketTraceRecordVector rows;
+    BuildRows(rows, 10000);
+
+    // Write with small blocks to check block boundaries.
+    ts::PacketTraceWriter writer(1000);
+    TSUNIT_ASSERT(writer.open(_tempFile, CERR));
+    TSUNIT_ASSERT(writer.isOpen());
+    for (auto it = rows.begin(); it != rows.end(); ++it) {
+        TSUNIT_ASSERT(writer.write(*it, CERR));
+    }
+    TSUNIT_ASSERT(writer.close(CERR));
+    TSUNIT_ASSERT(!writer.isOpen());
+    TSUNIT_EQUAL(10000, writer.rowCount());
+
+    // Encoding must be much more compact than raw rows.
+    const int64_t size = ts::GetFileSize(_tempFile);
+    debug() << "PacketTraceTest::testRoundTrip: file size: " << size << " bytes, " << (double(size) / rows.size()) << " bytes/row" << std::endl;
+    TSUNIT_ASSERT(size > 0);
+    TSUNIT_ASSERT(size < int64_t(rows.size() * 20));
+
+    ts::PacketTraceReader reader;
+    ts::PacketTraceRecordVector rows2;
+    TSUNIT_ASSERT(reader.open(_tempFile, CERR));
+    TSUNIT_EQUAL(ts::PacketTraceRecord::COLUMN_COUNT, reader.columnNames().size());
+    TSUNIT_EQUAL(u"packet", reader.columnNames()[0]);
+    TSUNIT_ASSERT(reader.readAll(rows2, CERR));
+    reader.close();
+
+    TSUNIT_EQUAL(rows.size(), rows2.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        for (size_t col = 0; col < ts::PacketTraceRecord::COLUMN_COUNT; ++col) {
+            TSUNIT_EQUAL(rows[i].getColumn(col), rows2[i].getColumn(col));
+        }
+    }
+}
+
+void PacketTraceTest::testEmpty()
+{
+    ts::PacketTraceWriter writer;
+    TSUNIT_ASSERT(writer.open(_tempFile, CERR));
+    TSUNIT_ASSERT(writer.close(CERR));
+    TSUNIT_EQUAL(0, writer.rowCount());
+
+    ts::PacketTraceReader reader;
+    ts::PacketTraceRecord rec;
+    TSUNIT_ASSERT(reader.open(_tempFile, CERR));
+    TSUNIT_ASSERT(!reader.read(rec, CERR));
+    reader.close();
+}
+
+void PacketTraceTest::testCorrupted()
+{
+    ts::PacketTraceRecordVector rows;
+    BuildRows(rows, 100);
+
+    ts::PacketTraceWriter writer;
+    TSUNIT_ASSERT(writer.open(_tempFile, CERR));
+    for (auto it = rows.begin(); it != rows.end(); ++it) {
+        TSUNIT_ASSERT(writer.write(*it, CERR));
+    }
+    TSUNIT_ASSERT(writer.close(CERR));
+
+    // Corrupt one byte at the end of the file, in the last column.
+    {
+        std::fstream file(_tempFile.toUTF8().c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        TSUNIT_ASSERT(file.is_open());
+        file.seekp(-10, std::ios::end);
+        file.put(char(0xA5));
+    }
+
+    ts::ReportBuffer<> rep;
+    ts::PacketTraceReader reader;
+    ts::PacketTraceRecordVector rows2;
+    TSUNIT_ASSERT(reader.open(_tempFile, rep));
+    TSUNIT_ASSERT(!reader.readAll(rows2, rep));
+    TSUNIT_ASSERT(rows2.empty());
+    TSUNIT_ASSERT(rep.getMessages().find(u"CRC error") != ts::NPOS);
+    reader.close();
+
+    // A block with too many rows must be rejected before allocating them.
+    TSUNIT_ASSERT(writer.open(_tempFile, CERR));
+    for (auto it = rows.begin(); it != rows.end(); ++it) {
+        TSUNIT_ASSERT(writer.write(*it, CERR));
+    }
+    TSUNIT_ASSERT(writer.close(CERR));
+    {
+        static const char huge_block[] = {'\x7F', '\xFF', '\xFF', '\xFF', '\x00', '\x00', '\x00', '\x00'};
+        std::ofstream file(_tempFile.toUTF8().c_str(), std::ios::app | std::ios::binary);
+        TSUNIT_ASSERT(file.is_open());
+        file.write(huge_block, sizeof(huge_block));
+    }
+    rep.resetMessages();
+    TSUNIT_ASSERT(reader.open(_tempFile, rep));
+    TSUNIT_ASSERT(!reader.readAll(rows2, rep));
+    TSUNIT_EQUAL(rows.size(), rows2.size());
+    TSUNIT_ASSERT(rep.getMessages().find(u"invalid packet trace block") != ts::NPOS);
+    reader.close();
+
+    // A header with too many columns must be rejected before reading any block.
+    {
+        static const char huge_header[] = {'T', 'S', 'T', 'R', '\x00', '\x01', '\xFF', '\xFF'};
+        std::ofstream file(_tempFile.toUTF8().c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+        TSUNIT_ASSERT(file.is_open());
+        file.write(huge_header, sizeof(huge_header));
+    }
+    rep.resetMessages();
+    TSUNIT_ASSERT(!reader.open(_tempFile, rep));
+    TSUNIT_ASSERT(!reader.isOpen());
+    TSUNIT_ASSERT(rep.getMessages().find(u"65535 columns") != ts::NPOS);
+
+    // A non-trace file must be rejected.
+    TSUNIT_ASSERT(ts::UString::Save(ts::UStringVector({u"not a trace file"}), _tempFile));
+    rep.resetMessages();
+    TSUNIT_ASSERT(!reader.open(_tempFile, rep));
+    TSUNIT_ASSERT(!reader.isOpen());
+}
@@ -33,6 +33,8 @@
 
 #include "tsSafePtr.h"
 #include "tsMutex.h"
+#include "tsGuard.h"
+#include "tsThread.h"
 #include "tsunit.h"
 TSDUCK_SOURCE;
 
@@ -51,12 +53,18 @@ public:
     void testDowncast();
     void testUpcast();
     void testChangeMutex();
+    void testMakeSafe();
+    void testMakeSafeTransfer();
+    void testThreads();
 
     TSUNIT_TEST_BEGIN(SafePtrTest);
     TSUNIT_TEST(testSafePtr);
     TSUNIT_TEST(testDowncast);
     TSUNIT_TEST(testUpcast);
     TSUNIT_TEST(testChangeMutex);
+    TSUNIT_TEST(testMakeSafe);
+    TSUNIT_TEST(testMakeSafeTransfer);
+    TSUNIT_TEST(testThreads);
     TSUNIT_TEST_END();
 };
 
@@ -387,3 +395,121 @@ void SafePtrTest::testChangeMutex()
     pt.clear();
     TSUNIT_ASSERT(TestData::InstanceCount() == 0);
 }
+
+// Test case: allocation of object and safe pointer in one memory block
+void SafePtrTest::testMakeSafe()
+{
+    TSUNIT_ASSERT(TestData::InstanceCount() == 0);
+    TestDataPtr p (ts::MakeSafe<TestData>(123));
+    TSUNIT_ASSERT(TestData::InstanceCount() == 1);
+    TSUNIT_ASSERT(!p.isNull());
+    TSUNIT_ASSERT(p->value() == 123);
+    TSUNIT_ASSERT(p.count() == 1);
+    {
+        TestDataPtr p2 (p);
+        TSUNIT_ASSERT(p.count() == 2);
+        TSUNIT_ASSERT(p2->value() == 123);
+        TSUNIT_ASSERT(TestData::InstanceCount() == 1);
+    }
+    TSUNIT_ASSERT(p.count() == 1);
+
+    // Replace the embedded object.
+    p.reset(new TestData(456));
+    TSUNIT_ASSERT(TestData::InstanceCount() == 1);
+    TSUNIT_ASSERT(p->value() == 456);
+
+    p.clear();
+    TSUNIT_ASSERT(TestData::InstanceCount() == 0);
+
+    ts::SafePtr<TestData,ts::Mutex> pt (ts::MakeSafe<TestData,ts::Mutex>(789));
+    TSUNIT_ASSERT(pt.isThreadSafe());
+    TSUNIT_ASSERT(!p.isThreadSafe());
+    TSUNIT_ASSERT(TestData::InstanceCount() == 1);
+    TSUNIT_ASSERT(pt->value() == 789);
+    pt.clear();
+    TSUNIT_ASSERT(TestData::InstanceCount() == 0);
+}
+
+// Test case: transfer of an object allocated with MakeSafe
+void SafePtrTest::testMakeSafeTransfer()
+{
+    TSUNIT_ASSERT(TestData::InstanceCount() == 0);
+    TestDataPtr p (ts::MakeSafe<TestData>(111));
+    TestDataPtr p2 (p);
+
+    TestData* raw = p.release();
+    TSUNIT_ASSERT(raw != nullptr);
+    TSUNIT_ASSERT(p.isNull());
+    TSUNIT_ASSERT(p2.isNull());
+    TSUNIT_ASSERT(TestData::InstanceCount() == 1);
+    TSUNIT_ASSERT(raw->value() == 111);
+    delete raw;
+    TSUNIT_ASSERT(TestData::InstanceCount() == 0);
+
+    SubTestData1Ptr p3 (ts::MakeSafe<SubTestData1>(222));
+    TestDataPtr p4 (p3.upcast<TestData>());
+    TSUNIT_ASSERT(p3.isNull());
+    TSUNIT_ASSERT(TestData::InstanceCount() == 1);
+    TSUNIT_ASSERT(p4->value() == 222);
+
+    ts::SafePtr<TestData,ts::Mutex> p5 (p4.changeMutex<ts::Mutex>());
+    TSUNIT_ASSERT(p4.isNull());
+    TSUNIT_ASSERT(TestData::InstanceCount() == 1);
+    TSUNIT_ASSERT(p5->value() == 222);
+
+    p5.clear();
+    p2.clear();
+    TSUNIT_ASSERT(TestData::InstanceCount() == 0);
+}
+
+//----------------------------------------------------------------------------
+// Concurrent copies of thread-safe safe pointers.
+//----------------------------------------------------------------------------
+
+namespace {
+    typedef ts::SafePtr<TestData,ts::Mutex> TestDataPtrMT;
+
+    class CopyThread: public ts::Thread
+    {
+        TS_NOBUILD_NOCOPY(CopyThread);
+    private:
+        TestDataPtrMT _ptr;
+        size_t        _count;
+    public:
+        CopyThread(const TestDataPtrMT& ptr, size_t count) : ts::Thread(), _ptr(ptr), _count(count) {}
+        virtual ~CopyThread() override { waitForTermination(); }
+        virtual void main() override
+        {
+            std::vector<TestDataPtrMT> copies(16);
+            for (size_t i = 0; i < _count; ++i) {
+                copies[i % copies.size()] = _ptr;
+                TestDataPtrMT local(copies[(i * 7) % copies.size()]);
+                if (!local.isNull() && local->value() != 999) {
+                    return;
+                }
+            }
+        }
+    };
+}
+
+// Test case: copy the same pointer in several threads
+void SafePtrTest::testThreads()
+{
+    TSUNIT_ASSERT(TestData::InstanceCount() == 0);
+    {
+        TestDataPtrMT ptr(ts::MakeSafe<TestData,ts::Mutex>(999));
+        {
+            CopyThread t1(ptr, 100000);
+            CopyThread t2(ptr, 100000);
+            CopyThread t3(ptr, 100000);
+            CopyThread t4(ptr, 100000);
+            TSUNIT_ASSERT(t1.start());
+            TSUNIT_ASSERT(t2.start());
+            TSUNIT_ASSERT(t3.start());
+            TSUNIT_ASSERT(t4.start());
+        }
+        TSUNIT_ASSERT(ptr.count() == 1);
+        TSUNIT_ASSERT(TestData::InstanceCount() == 1);
+    }
+    TSUNIT_ASSERT(TestData::InstanceCount() == 0);
+}
@@ -32,6 +32,8 @@
 //----------------------------------------------------------------------------
 
 #include "tsDVBCSA2.h"
+#include "tsTSScrambling.h"
+#include "tsNullReport.h"
 #include "tsTSPacket.h"
 #include "tsNames.h"
 #include "tsunit.h"
@@ -49,9 +51,13 @@ public:
     virtual void afterTest() override;
 
     void testScrambling();
+    void testBatch();
+    void testLater();
 
     TSUNIT_TEST_BEGIN(ScramblingTest);
     TSUNIT_TEST(testScrambling);
+    TSUNIT_TEST(testBatch);
+    TSUNIT_TEST(testLater);
     TSUNIT_TEST_END();
 };
 
@@ -211,3 +217,114 @@ void ScramblingTest::testScrambling()
         TSUNIT_ASSERT(::memcmp(pkt.b + header_size, vec->cipher.b + header_size, payload_size) == 0);
     }
 }
+
+void ScramblingTest::testBatch()
+{
+    static const uint8_t cw_even[8] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+    static const uint8_t cw_odd[8]  = {0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10};
+    static const uint8_t types[] = {ts::SCRAMBLING_DUCK_SCTE52, ts::SCRAMBLING_DVB_CSA2};
+
+    // Packets with all payload sizes.
+    const size_t count = 300;
+    const size_t half = count / 2;
+    ts::TSPacketVector plain(count);
+    for (size_t i = 0; i < count; ++i) {
+        plain[i].init(100, uint8_t(i), uint8_t(i));
+        TSUNIT_ASSERT(plain[i].setPayloadSize((i * 37) % 185));
+    }
+
+    for (size_t ti = 0; ti < sizeof(types); ++ti) {
+
+        ts::TSScrambling single(NULLREP, types[ti]);
+        ts::TSScrambling batch(NULLREP, types[ti]);
+        TSUNIT_ASSERT(single.setCW(ts::ByteBlock(cw_even, sizeof(cw_even)), 0));
+        TSUNIT_ASSERT(single.setCW(ts::ByteBlock(cw_odd, sizeof(cw_odd)), 1));
+        TSUNIT_ASSERT(batch.setCW(ts::ByteBlock(cw_even, sizeof(cw_even)), 0));
+        TSUNIT_ASSERT(batch.setCW(ts::ByteBlock(cw_odd, sizeof(cw_odd)), 1));
+
+        debug() << "ScramblingTest::testBatch: " << batch.algoName() << std::endl;
+
+        // Encrypt half of the packets with each parity, one at a time and in batch.
+        ts::TSPacketVector ref(plain);
+        ts::TSPacketVector pkts(plain);
+        for (size_t i = 0; i < count; ++i) {
+            TSUNIT_ASSERT(single.setEncryptParity(i < half ? 0 : 1));
+            TSUNIT_ASSERT(single.encrypt(ref[i]));
+        }
+        TSUNIT_ASSERT(batch.setEncryptParity(0));
+        TSUNIT_ASSERT(batch.encrypt(&pkts[0], half));
+        TSUNIT_ASSERT(batch.setEncryptParity(1));
+        TSUNIT_ASSERT(batch.encrypt(&pkts[half], count - half));
+        for (size_t i = 0; i < count; ++i) {
+            TSUNIT_ASSERT(pkts[i] == ref[i]);
+        }
+
+        // Decrypt all packets in one batch, with a parity change.
+        TSUNIT_ASSERT(batch.decrypt(&pkts[0], count));
+        for (size_t i = 0; i < count; ++i) {
+            TSUNIT_ASSERT(pkts[i] == plain[i]);
+        }
+    }
+}
+
+void ScramblingTest::testLater()
+{
+    static const uint8_t cw1[8] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+    static const uint8_t cw2[8] = {0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10};
+    static const uint8_t cw3[8] = {0x10, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE};
+    const ts::ByteBlock key1(cw1, sizeof(cw1));
+    const ts::ByteBlock key2(cw2, sizeof(cw2));
+    const ts::ByteBlock key3(cw3, sizeof(cw3));
+
+    // More packets than one internal batch.
+    const size_t count = 500;
+    const size_t third = count / 3;
+    ts::TSPacketVector plain(count);
+    for (size_t i = 0; i < count; ++i) {
+        plain[i].init(100, uint8_t(i), uint8_t(i));
+        TSUNIT_ASSERT(plain[i].setPayloadSize((i * 37) % 185));
+    }
+
+    // Reference: one packet at a time. One third with each key, alternate parities.
+    ts::TSScrambling single(NULLREP, ts::SCRAMBLING_DUCK_SCTE52);
+    ts::TSPacketVector ref(plain);
+    TSUNIT_ASSERT(single.setCW(key1, 0));
+    TSUNIT_ASSERT(single.setCW(key2, 1));
+    for (size_t i = 0; i < count; ++i) {
+        if (i == 2 * third) {
+            TSUNIT_ASSERT(single.setCW(key3, 0));
+        }
+        TSUNIT_ASSERT(single.setEncryptParity(i < third || i >= 2 * third ? 0 : 1));
+        TSUNIT_ASSERT(single.encrypt(ref[i]));
+    }
+
+    // Deferred encryption: the key and parity changes apply to the next packets only.
+    ts::TSScrambling later(NULLREP, ts::SCRAMBLING_DUCK_SCTE52);
+    ts::TSPacketVector pkts(plain);
+    TSUNIT_ASSERT(later.setCW(key1, 0));
+    TSUNIT_ASSERT(later.setCW(key2, 1));
+    for (size_t i = 0; i < count; ++i) {
+        if (i == 2 * third) {
+            TSUNIT_ASSERT(later.setCW(key3, 0));
+        }
+        TSUNIT_ASSERT(later.setEncryptParity(i < third || i >= 2 * third ? 0 : 1));
+        TSUNIT_ASSERT(later.encryptLater(pkts[i]));
+    }
+    TSUNIT_ASSERT(later.flush());
+    for (size_t i = 0; i < count; ++i) {
+        TSUNIT_ASSERT(pkts[i] == ref[i]);
+    }
+
+    // Deferred decryption, with the same key changes.
+    TSUNIT_ASSERT(later.setCW(key1, 0));
+    for (size_t i = 0; i < count; ++i) {
+        if (i == 2 * third) {
+            TSUNIT_ASSERT(later.setCW(key3, 0));
+        }
+        TSUNIT_ASSERT(later.decryptLater(pkts[i]));
+    }
+    TSUNIT_ASSERT(later.flush());
+    for (size_t i = 0; i < count; ++i) {
+        TSUNIT_ASSERT(pkts[i] == plain[i]);
+    }
+}
@@ -0,0 +1,222 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::StreamClock
+//
+//----------------------------------------------------------------------------
+
+#include "tsStreamClock.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class StreamClockTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testPCR();
+    void testWrapUp();
+    void testDiscontinuity();
+    void testReferencePID();
+    void testBitrateHint();
+
+    TSUNIT_TEST_BEGIN(StreamClockTest);
+    TSUNIT_TEST(testPCR);
+    TSUNIT_TEST(testWrapUp);
+    TSUNIT_TEST(testDiscontinuity);
+    TSUNIT_TEST(testReferencePID);
+    TSUNIT_TEST(testBitrateHint);
+    TSUNIT_TEST_END();
+
+private:
+    static ts::TSPacket Packet(ts::PID pid, uint64_t pcr = ts::INVALID_PCR, bool discontinuity = false);
+};
+
+TSUNIT_REGISTER(StreamClockTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void StreamClockTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void StreamClockTest::afterTest()
+{
+}
+
+// Build a packet, with or without PCR.
+ts::TSPacket StreamClockTest::Packet(ts::PID pid, uint64_t pcr, bool discontinuity)
+{
+    ts::TSPacket pkt;
+    pkt.init(pid);
+    if (pcr != ts::INVALID_PCR) {
+        pkt.setPCR(pcr, true);
+        if (discontinuity) {
+            pkt.setDiscontinuityIndicator();
+        }
+    }
+    return pkt;
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void StreamClockTest::testPCR()
+{
+    ts::StreamClock clock;
+    TSUNIT_ASSERT(!clock.pcrFound());
+    TSUNIT_EQUAL(ts::PID_NULL, clock.referencePID());
+
+    // No PCR, no bitrate: time does not advance.
+    clock.feedPacket(Packet(200));
+    clock.feedPacket(Packet(200));
+    TSUNIT_EQUAL(0, clock.currentTime());
+
+    // First PCR at packet 2: time origin, no rate yet.
+    clock.feedPacket(Packet(100, 1000000));
+    TSUNIT_ASSERT(clock.pcrFound());
+    TSUNIT_EQUAL(100, clock.referencePID());
+    TSUNIT_EQUAL(0, clock.currentTime());
+    for (int i = 0; i < 9; ++i) {
+        clock.feedPacket(Packet(200));
+    }
+    TSUNIT_EQUAL(0, clock.currentTime());
+
+    // Second PCR, 10 packets later, 2700 ticks (270 ticks per packet).
+    clock.feedPacket(Packet(100, 1002700));
+    TSUNIT_EQUAL(2700, clock.currentTime());
+    clock.feedPacket(Packet(200));
+    TSUNIT_EQUAL(2970, clock.currentTime());
+    clock.feedPacket(Packet(200));
+    TSUNIT_EQUAL(3240, clock.currentTime());
+
+    // Next PCR, 3 packets later, exact time.
+    clock.feedPacket(Packet(100, 1003500));
+    TSUNIT_EQUAL(3500, clock.currentTime());
+    clock.feedPacket(Packet(200));
+    TSUNIT_EQUAL(3766, clock.currentTime());
+}
+
+void StreamClockTest::testWrapUp()
+{
+    ts::StreamClock clock;
+    clock.feedPacket(Packet(100, ts::MAX_PCR - 999));
+    for (int i = 0; i < 9; ++i) {
+        clock.feedPacket(Packet(200));
+    }
+    clock.feedPacket(Packet(100, 1000));
+    TSUNIT_EQUAL(2000, clock.currentTime());
+    clock.feedPacket(Packet(200));
+    TSUNIT_EQUAL(2200, clock.currentTime());
+}
+
+void StreamClockTest::testDiscontinuity()
+{
+    ts::StreamClock clock;
+    clock.feedPacket(Packet(100, 500000));
+    for (int i = 0; i < 9; ++i) {
+        clock.feedPacket(Packet(200));
+    }
+    clock.feedPacket(Packet(100, 502700));
+    TSUNIT_EQUAL(2700, clock.currentTime());
+    for (int i = 0; i < 9; ++i) {
+        clock.feedPacket(Packet(200));
+    }
+    TSUNIT_EQUAL(5130, clock.currentTime());
+
+    // Signalled discontinuity: the time is extrapolated.
+    clock.feedPacket(Packet(100, 20000000, true));
+    TSUNIT_EQUAL(5400, clock.currentTime());
+    for (int i = 0; i < 9; ++i) {
+        clock.feedPacket(Packet(200));
+    }
+    clock.feedPacket(Packet(100, 20002700));
+    TSUNIT_EQUAL(8100, clock.currentTime());
+
+    // Unsignalled PCR jump forward: the time is extrapolated.
+    for (int i = 0; i < 9; ++i) {
+        clock.feedPacket(Packet(200));
+    }
+    clock.feedPacket(Packet(100, 90000000));
+    TSUNIT_EQUAL(10800, clock.currentTime());
+
+    // PCR going backward: the time never goes backward.
+    clock.feedPacket(Packet(100, 80000000));
+    TSUNIT_EQUAL(11070, clock.currentTime());
+    clock.feedPacket(Packet(200));
+    TSUNIT_ASSERT(clock.currentTime() >= 11070);
+}
+
+void StreamClockTest::testReferencePID()
+{
+    ts::StreamClock clock(300);
+    clock.feedPacket(Packet(100, 1000000));
+    TSUNIT_ASSERT(!clock.pcrFound());
+    clock.feedPacket(Packet(300, 5000000));
+    TSUNIT_ASSERT(clock.pcrFound());
+    TSUNIT_EQUAL(300, clock.referencePID());
+    clock.feedPacket(Packet(100, 9000000));
+    clock.feedPacket(Packet(300, 5000540));
+    TSUNIT_EQUAL(540, clock.currentTime());
+    clock.feedPacket(Packet(100, 1000000));
+    TSUNIT_EQUAL(810, clock.currentTime());
+}
+
+void StreamClockTest::testBitrateHint()
+{
+    // With this bitrate, one packet lasts exactly one millisecond.
+    ts::StreamClock clock;
+    clock.setBitrateHint(ts::PKT_SIZE * 8 * ts::MilliSecPerSec);
+    clock.feedPacket(Packet(200));
+    TSUNIT_EQUAL(0, clock.currentMilliSeconds());
+    for (int i = 0; i < 100; ++i) {
+        clock.feedPacket(Packet(200));
+    }
+    TSUNIT_EQUAL(100, clock.currentMilliSeconds());
+    TSUNIT_EQUAL(100 * ts::SYSTEM_CLOCK_FREQ / ts::MilliSecPerSec, clock.currentTime());
+
+    // First PCR: time continues from the extrapolated value.
+    clock.feedPacket(Packet(100, 123456789));
+    TSUNIT_EQUAL(101, clock.currentMilliSeconds());
+    clock.feedPacket(Packet(200));
+    TSUNIT_EQUAL(102, clock.currentMilliSeconds());
+}
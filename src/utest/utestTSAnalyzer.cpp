@@ -0,0 +1,283 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::TSAnalyzer
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSAnalyzer.h"
+#include "tsDuckContext.h"
+#include "tsSysUtils.h"
+#include "tsNullReport.h"
+#include "tsCerrReport.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+#include "tables/psi_pat_r4_packets.h"
+#include "tables/psi_pmt_planete_packets.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSAnalyzerTest: public tsunit::Test
+{
+public:
+    TSAnalyzerTest();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testState();
+    void testStateFile();
+    void testStateSnapshot();
+    void testInvalidState();
+    void testStateVersion1();
+
+    TSUNIT_TEST_BEGIN(TSAnalyzerTest);
+    TSUNIT_TEST(testState);
+    TSUNIT_TEST(testStateFile);
+    TSUNIT_TEST(testStateSnapshot);
+    TSUNIT_TEST(testInvalidState);
+    TSUNIT_TEST(testStateVersion1);
+    TSUNIT_TEST_END();
+
+private:
+    ts::UString _tempFileName;
+
+    // Feed an analyzer with a PAT, a PMT (optional) and some packets on a video PID.
+    static void Feed(ts::TSAnalyzer& analyzer, uint8_t& cc, bool tables = true);
+};
+
+TSUNIT_REGISTER(TSAnalyzerTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+TSAnalyzerTest::TSAnalyzerTest() :
+    _tempFileName()
+{
+}
+
+void TSAnalyzerTest::beforeTest()
+{
+    if (_tempFileName.empty()) {
+        _tempFileName = ts::TempFile(u".tsas");
+    }
+    ts::DeleteFile(_tempFileName);
+}
+
+void TSAnalyzerTest::afterTest()
+{
+    ts::DeleteFile(_tempFileName);
+}
+
+void TSAnalyzerTest::Feed(ts::TSAnalyzer& analyzer, uint8_t& cc, bool tables)
+{
+    ts::TSPacket pkt;
+    for (size_t i = 0; tables && i < sizeof(psi_pat_r4_packets); i += ts::PKT_SIZE) {
+        pkt.copyFrom(psi_pat_r4_packets + i);
+        analyzer.feedPacket(pkt);
+    }
+    for (size_t i = 0; tables && i < sizeof(psi_pmt_planete_packets); i += ts::PKT_SIZE) {
+        pkt.copyFrom(psi_pmt_planete_packets + i);
+        analyzer.feedPacket(pkt);
+    }
+    for (size_t i = 0; i < 20; ++i) {
+        pkt = ts::NullPacket;
+        pkt.setPID(0x00A3);
+        pkt.setCC(cc);
+        pkt.setPUSI(i % 5 == 0);
+        analyzer.feedPacket(pkt);
+        cc = (cc + 1) % ts::CC_MAX;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void TSAnalyzerTest::testState()
+{
+    ts::DuckContext duck;
+    ts::TSAnalyzer an1(duck);
+    ts::TSAnalyzer an2(duck);
+    uint8_t cc1 = 0;
+    uint8_t cc2 = 0;
+
+    Feed(an1, cc1);
+
+    ts::ByteBlock state1;
+    ts::ByteBlock state2;
+    an1.serializeState(state1);
+    debug() << "TSAnalyzerTest::testState: state size: " << state1.size() << " bytes" << std::endl;
+    TSUNIT_ASSERT(!state1.empty());
+
+    // Restore in another analyzer, must get the same state.
+    TSUNIT_ASSERT(an2.deserializeState(state1.data(), state1.size()));
+    an2.serializeState(state2);
+    TSUNIT_ASSERT(state1 == state2);
+
+    std::vector<uint16_t> services1, services2;
+    std::vector<ts::PID> pids1, pids2;
+    an1.getServiceIds(services1);
+    an2.getServiceIds(services2);
+    an1.getPIDs(pids1);
+    an2.getPIDs(pids2);
+    TSUNIT_ASSERT(!services1.empty());
+    TSUNIT_ASSERT(!pids1.empty());
+    TSUNIT_ASSERT(services1 == services2);
+    TSUNIT_ASSERT(pids1 == pids2);
+
+    // Continue the analysis of the video PID on both analyzers. The reloaded analyzer
+    // resynchronizes on the continuity counter, the accumulated counters remain identical.
+    // Tables are not fed since the demux state is not part of the snapshot.
+    cc2 = cc1;
+    Feed(an1, cc1, false);
+    Feed(an2, cc2, false);
+    an1.serializeState(state1);
+    an2.serializeState(state2);
+    TSUNIT_ASSERT(state1 == state2);
+}
+
+void TSAnalyzerTest::testStateFile()
+{
+    ts::DuckContext duck;
+    ts::TSAnalyzer an1(duck);
+    ts::TSAnalyzer an2(duck);
+    uint8_t cc = 0;
+
+    Feed(an1, cc);
+    TSUNIT_ASSERT(an1.saveState(_tempFileName, CERR));
+    TSUNIT_ASSERT(ts::FileExists(_tempFileName));
+    TSUNIT_ASSERT(!ts::FileExists(_tempFileName + u".tmp"));
+    TSUNIT_ASSERT(an2.loadState(_tempFileName, CERR));
+
+    ts::ByteBlock state1;
+    ts::ByteBlock state2;
+    an1.serializeState(state1);
+    an2.serializeState(state2);
+    TSUNIT_ASSERT(state1 == state2);
+}
+
+void TSAnalyzerTest::testStateSnapshot()
+{
+    ts::DuckContext duck;
+    ts::TSAnalyzer an(duck);
+    uint8_t cc = 0;
+
+    Feed(an, cc);
+    ts::TSAnalyzer::StateSnapshot snapshot;
+    an.getState(snapshot);
+
+    ts::ByteBlock state1;
+    ts::ByteBlock state2;
+    an.serializeState(state1);
+    snapshot.serialize(state2);
+    TSUNIT_ASSERT(state1 == state2);
+
+    // The snapshot is not modified when the analysis continues.
+    Feed(an, cc);
+    snapshot.serialize(state2);
+    TSUNIT_ASSERT(state1 == state2);
+    an.serializeState(state2);
+    TSUNIT_ASSERT(state1 != state2);
+}
+
+void TSAnalyzerTest::testInvalidState()
+{
+    ts::DuckContext duck;
+    ts::TSAnalyzer an1(duck);
+    ts::TSAnalyzer an2(duck);
+    ts::TSAnalyzer empty(duck);
+    uint8_t cc = 0;
+
+    Feed(an1, cc);
+    ts::ByteBlock state1;
+    ts::ByteBlock state2;
+    ts::ByteBlock empty_state;
+    an1.serializeState(state1);
+    empty.serializeState(empty_state);
+
+    // Truncated snapshot.
+    TSUNIT_ASSERT(!an2.deserializeState(state1.data(), state1.size() - 1));
+    an2.serializeState(state2);
+    TSUNIT_ASSERT(state2 == empty_state);
+
+    // Extra data.
+    state2 = state1;
+    state2.appendUInt8(0);
+    TSUNIT_ASSERT(!an2.deserializeState(state2.data(), state2.size()));
+
+    // Invalid magic number.
+    state2 = state1;
+    state2[0] = 'X';
+    TSUNIT_ASSERT(!an2.deserializeState(state2.data(), state2.size()));
+
+    // Unknown format versions.
+    state2 = state1;
+    state2[4] = 0;
+    TSUNIT_ASSERT(!an2.deserializeState(state2.data(), state2.size()));
+    state2[4] = 3;
+    TSUNIT_ASSERT(!an2.deserializeState(state2.data(), state2.size()));
+    TSUNIT_ASSERT(!an2.deserializeState(nullptr, 0));
+
+    // Missing file.
+    TSUNIT_ASSERT(!an2.loadState(_tempFileName, NULLREP));
+}
+
+void TSAnalyzerTest::testStateVersion1()
+{
+    ts::DuckContext duck;
+    ts::TSAnalyzer an1(duck);
+    ts::TSAnalyzer an2(duck);
+    uint8_t cc = 0;
+
+    Feed(an1, cc);
+    ts::ByteBlock state1;
+    ts::ByteBlock state2;
+    an1.serializeState(state1);
+    TSUNIT_EQUAL(2, state1[4]);
+
+    // Build the same snapshot in format version 1: without the 64-bit count of sampled
+    // packets, after magic (4), version (1), TS id (2 + 1) and four 64-bit counters.
+    const size_t sampled_offset = 4 + 1 + 3 + 4 * 8;
+    ts::ByteBlock state_v1(state1);
+    state_v1[4] = 1;
+    state_v1.erase(sampled_offset, 8);
+
+    // A version 1 snapshot is still accepted and saved again in the current format.
+    TSUNIT_ASSERT(an2.deserializeState(state_v1.data(), state_v1.size()));
+    an2.serializeState(state2);
+    TSUNIT_ASSERT(state1 == state2);
+}
@@ -55,6 +55,8 @@ public:
     void testSetPayloadSize();
     void testFlags();
     void testPrivateData();
+    void testCheckSync();
+    void testFindPID();
 
     TSUNIT_TEST_BEGIN(TSPacketTest);
     TSUNIT_TEST(testPacket);
@@ -64,6 +66,8 @@ public:
     TSUNIT_TEST(testSetPayloadSize);
     TSUNIT_TEST(testFlags);
     TSUNIT_TEST(testPrivateData);
+    TSUNIT_TEST(testCheckSync);
+    TSUNIT_TEST(testFindPID);
     TSUNIT_TEST_END();
 };
 
@@ -495,3 +499,73 @@ void TSPacketTest::testPrivateData()
     pkt.getPrivateData(data);
     TSUNIT_ASSERT(data.empty());
 }
+
+void TSPacketTest::testCheckSync()
+{
+    // Packets: one null packet out of 3, transport_error_indicator in one packet out of 5.
+    const size_t count = 50;
+    ts::TSPacketVector pkts(count);
+    size_t ref_tei = 0;
+    size_t ref_null = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (i % 3 == 0) {
+            pkts[i] = ts::NullPacket;
+            ref_null++;
+        }
+        else {
+            pkts[i].init(ts::PID(i));
+        }
+        if (i % 5 == 0) {
+            pkts[i].setTEI(true);
+            ref_tei++;
+        }
+    }
+
+    size_t tei = 0;
+    size_t null = 0;
+    TSUNIT_EQUAL(count, ts::TSPacket::CheckSync(pkts.data(), count, tei, null));
+    TSUNIT_EQUAL(ref_tei, tei);
+    TSUNIT_EQUAL(ref_null, null);
+
+    TSUNIT_EQUAL(0, ts::TSPacket::CheckSync(pkts.data(), 0, tei, null));
+    TSUNIT_EQUAL(0, tei);
+    TSUNIT_EQUAL(0, null);
+
+    // Lost synchronization at all positions, inside and outside groups of packets.
+    for (size_t bad = 0; bad < count; ++bad) {
+        ts::TSPacketVector copy(pkts);
+        copy[bad].b[0] = 0x00;
+        size_t bad_tei = 0;
+        size_t bad_null = 0;
+        for (size_t i = 0; i < bad; ++i) {
+            bad_tei += copy[i].getTEI();
+            bad_null += copy[i].getPID() == ts::PID_NULL;
+        }
+        TSUNIT_EQUAL(bad, ts::TSPacket::CheckSync(copy.data(), count, tei, null));
+        TSUNIT_EQUAL(bad_tei, tei);
+        TSUNIT_EQUAL(bad_null, null);
+    }
+}
+
+void TSPacketTest::testFindPID()
+{
+    const size_t count = 50;
+    ts::TSPacketVector pkts(count);
+    for (size_t i = 0; i < count; ++i) {
+        pkts[i].init(ts::PID(100 + i));
+    }
+
+    ts::PIDSet pids;
+    TSUNIT_EQUAL(count, ts::TSPacket::FindPID(pkts.data(), count, pids));
+    TSUNIT_EQUAL(0, ts::TSPacket::FindPID(pkts.data(), 0, ts::AllPIDs));
+    TSUNIT_EQUAL(0, ts::TSPacket::FindPID(pkts.data(), count, ts::AllPIDs));
+
+    // Search one PID at all positions, inside and outside groups of packets.
+    for (size_t i = 0; i < count; ++i) {
+        pids.reset();
+        pids.set(100 + i);
+        pids.set(10);
+        TSUNIT_EQUAL(i, ts::TSPacket::FindPID(pkts.data(), count, pids));
+        TSUNIT_EQUAL(std::min(i, size_t(7)), ts::TSPacket::FindPID(pkts.data(), 7, pids));
+    }
+}
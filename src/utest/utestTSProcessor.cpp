@@ -0,0 +1,233 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::TSProcessor
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSProcessor.h"
+#include "tsPluginRepository.h"
+#include "tsSysUtils.h"
+#include "tsNullReport.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSProcessorTest: public tsunit::Test
+{
+public:
+    TSProcessorTest();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testDefault();
+    void testLowLatency();
+    void testLowLatencyPlugins();
+    void testFlushPackets();
+
+    TSUNIT_TEST_BEGIN(TSProcessorTest);
+    TSUNIT_TEST(testDefault);
+    TSUNIT_TEST(testLowLatency);
+    TSUNIT_TEST(testLowLatencyPlugins);
+    TSUNIT_TEST(testFlushPackets);
+    TSUNIT_TEST_END();
+
+private:
+    ts::UString _tempFileName;
+
+    // Number of packets in each test.
+    static constexpr size_t TOTAL_PACKETS = 50000;
+
+    // Run tsp from null packets to the temporary file, through the specified processors.
+    void run(ts::TSProcessorArgs& args);
+};
+
+TSUNIT_REGISTER(TSProcessorTest);
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t TSProcessorTest::TOTAL_PACKETS;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Test plugins.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Number of packets which were seen by CheckPlugin before being modified by DeferPlugin.
+    ts::PacketCounter unflushed_packets = 0;
+
+    // A plugin which clears the first byte of payload, in flushPackets() only.
+    class DeferPlugin: public ts::ProcessorPlugin
+    {
+        TS_NOBUILD_NOCOPY(DeferPlugin);
+    public:
+        DeferPlugin(ts::TSP* tsp_) : ts::ProcessorPlugin(tsp_), _pending() {}
+
+        virtual Status processPacket(ts::TSPacket& pkt, ts::TSPacketMetadata&) override
+        {
+            _pending.push_back(&pkt);
+            return TSP_OK;
+        }
+
+        virtual bool flushPackets() override
+        {
+            for (auto it = _pending.begin(); it != _pending.end(); ++it) {
+                (*it)->b[4] = 0;
+            }
+            _pending.clear();
+            return true;
+        }
+
+    private:
+        std::vector<ts::TSPacket*> _pending;
+    };
+
+    // A plugin which counts the packets which were not modified by DeferPlugin.
+    class CheckPlugin: public ts::ProcessorPlugin
+    {
+        TS_NOBUILD_NOCOPY(CheckPlugin);
+    public:
+        CheckPlugin(ts::TSP* tsp_) : ts::ProcessorPlugin(tsp_) {}
+
+        virtual Status processPacket(ts::TSPacket& pkt, ts::TSPacketMetadata&) override
+        {
+            if (pkt.b[4] != 0) {
+                unflushed_packets++;
+            }
+            return TSP_OK;
+        }
+    };
+
+    ts::ProcessorPlugin* NewDeferPlugin(ts::TSP* tsp) { return new DeferPlugin(tsp); }
+    ts::ProcessorPlugin* NewCheckPlugin(ts::TSP* tsp) { return new CheckPlugin(tsp); }
+}
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+TSProcessorTest::TSProcessorTest() :
+    _tempFileName()
+{
+}
+
+// Test suite initialization method.
+void TSProcessorTest::beforeTest()
+{
+    if (_tempFileName.empty()) {
+        _tempFileName = ts::TempFile(u".tmp.ts");
+    }
+    ts::DeleteFile(_tempFileName);
+}
+
+// Test suite cleanup method.
+void TSProcessorTest::afterTest()
+{
+    ts::DeleteFile(_tempFileName);
+}
+
+void TSProcessorTest::run(ts::TSProcessorArgs& args)
+{
+    args.app_name = u"utest";
+    args.input.set(u"null", {ts::UString::Decimal(TOTAL_PACKETS, 0, true, u"")});
+    args.output.set(u"file", {_tempFileName});
+
+    ts::TSProcessor tsproc(NULLREP);
+    TSUNIT_ASSERT(tsproc.start(args));
+    tsproc.waitForTermination();
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void TSProcessorTest::testDefault()
+{
+    ts::TSProcessorArgs args;
+    run(args);
+    TSUNIT_EQUAL(int64_t(TOTAL_PACKETS * ts::PKT_SIZE), ts::GetFileSize(_tempFileName));
+}
+
+void TSProcessorTest::testLowLatency()
+{
+    // With a known bitrate, 10 ms at 10 Mb/s are 66 packets per window.
+    ts::TSProcessorArgs args;
+    args.fixed_bitrate = 10000000;
+    args.latency_target = 10;
+    run(args);
+    TSUNIT_EQUAL(int64_t(TOTAL_PACKETS * ts::PKT_SIZE), ts::GetFileSize(_tempFileName));
+}
+
+void TSProcessorTest::testLowLatencyPlugins()
+{
+    // Packet processors drop half of the packets, with a latency target shorter than one packet.
+    ts::TSProcessorArgs args;
+    args.fixed_bitrate = 1000000;
+    args.latency_target = 1;
+    args.plugins.resize(2);
+    args.plugins[0].set(u"filter", {u"--every", u"2"});
+    args.plugins[1].set(u"skip", {u"0"});
+    run(args);
+    TSUNIT_EQUAL(int64_t(TOTAL_PACKETS / 2 * ts::PKT_SIZE), ts::GetFileSize(_tempFileName));
+}
+
+void TSProcessorTest::testFlushPackets()
+{
+    ts::PluginRepository::Instance()->registerProcessor(u"utest_defer", NewDeferPlugin);
+    ts::PluginRepository::Instance()->registerProcessor(u"utest_check", NewCheckPlugin);
+
+    // The deferred processing is complete when the next plugin gets the packets,
+    // in default mode (flush on full chunks) and in low-latency mode (small flushes).
+    for (int low_latency = 0; low_latency <= 1; ++low_latency) {
+        ts::DeleteFile(_tempFileName);
+        unflushed_packets = 0;
+        ts::TSProcessorArgs args;
+        if (low_latency) {
+            args.fixed_bitrate = 1000000;
+            args.latency_target = 1;
+        }
+        args.plugins.resize(2);
+        args.plugins[0].set(u"utest_defer");
+        args.plugins[1].set(u"utest_check");
+        run(args);
+        TSUNIT_EQUAL(int64_t(TOTAL_PACKETS * ts::PKT_SIZE), ts::GetFileSize(_tempFileName));
+        TSUNIT_EQUAL(0, unflushed_packets);
+    }
+}
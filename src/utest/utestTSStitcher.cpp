@@ -0,0 +1,275 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::TSStitcher
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSStitcher.h"
+#include "tsTSFile.h"
+#include "tsPAT.h"
+#include "tsBinaryTable.h"
+#include "tsOneShotPacketizer.h"
+#include "tsDuckContext.h"
+#include "tsSysUtils.h"
+#include "tsNullReport.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSStitcherTest: public tsunit::Test
+{
+public:
+    TSStitcherTest();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testContinuity();
+    void testVersions();
+    void testMultiSections();
+
+    TSUNIT_TEST_BEGIN(TSStitcherTest);
+    TSUNIT_TEST(testContinuity);
+    TSUNIT_TEST(testVersions);
+    TSUNIT_TEST(testMultiSections);
+    TSUNIT_TEST_END();
+
+private:
+    ts::UString _tempFileName;
+
+    // Build a one-packet PAT with one service.
+    static ts::TSPacket PATPacket(uint8_t version, ts::PID pmt_pid, uint8_t cc);
+
+    // Build a two-section SDT, one section per packet, the payload of each section is filled with a byte value.
+    static void SDTPackets(ts::TSPacketVector& packets, uint8_t version, uint8_t fill0, uint8_t fill1, uint8_t cc);
+
+    // Build a data packet.
+    static ts::TSPacket DataPacket(ts::PID pid, uint8_t cc);
+
+    // Read the stitched file.
+    void readFile(ts::TSPacketVector& packets);
+};
+
+TSUNIT_REGISTER(TSStitcherTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+TSStitcherTest::TSStitcherTest() :
+    _tempFileName()
+{
+}
+
+// Test suite initialization method.
+void TSStitcherTest::beforeTest()
+{
+    if (_tempFileName.empty()) {
+        _tempFileName = ts::TempFile(u".tmp.ts");
+    }
+    ts::DeleteFile(_tempFileName);
+}
+
+// Test suite cleanup method.
+void TSStitcherTest::afterTest()
+{
+    ts::DeleteFile(_tempFileName);
+}
+
+ts::TSPacket TSStitcherTest::PATPacket(uint8_t version, ts::PID pmt_pid, uint8_t cc)
+{
+    ts::DuckContext duck;
+    ts::PAT pat(version, true, 1);
+    pat.pmts[100] = pmt_pid;
+    ts::BinaryTable table;
+    pat.serialize(duck, table);
+
+    ts::OneShotPacketizer pzer(ts::PID_PAT, true);
+    ts::TSPacketVector packets;
+    pzer.setNextContinuityCounter(cc);
+    pzer.addTable(table);
+    pzer.getPackets(packets);
+    TSUNIT_EQUAL(1, packets.size());
+    return packets[0];
+}
+
+void TSStitcherTest::SDTPackets(ts::TSPacketVector& packets, uint8_t version, uint8_t fill0, uint8_t fill1, uint8_t cc)
+{
+    const ts::ByteBlock payload0(100, fill0);
+    const ts::ByteBlock payload1(100, fill1);
+
+    ts::OneShotPacketizer pzer(ts::PID_SDT, true);
+    pzer.setNextContinuityCounter(cc);
+    pzer.addSection(new ts::Section(ts::TID_SDT_ACT, true, 1, version, true, 0, 1, payload0.data(), payload0.size()));
+    pzer.addSection(new ts::Section(ts::TID_SDT_ACT, true, 1, version, true, 1, 1, payload1.data(), payload1.size()));
+    pzer.getPackets(packets);
+    TSUNIT_EQUAL(2, packets.size());
+}
+
+ts::TSPacket TSStitcherTest::DataPacket(ts::PID pid, uint8_t cc)
+{
+    ts::TSPacket pkt;
+    pkt.init(pid, cc);
+    return pkt;
+}
+
+void TSStitcherTest::readFile(ts::TSPacketVector& packets)
+{
+    ts::TSFile file;
+    TSUNIT_ASSERT(file.openRead(_tempFileName, 0, NULLREP));
+    packets.resize(100);
+    packets.resize(file.read(packets.data(), packets.size(), NULLREP));
+    file.close(NULLREP);
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void TSStitcherTest::testContinuity()
+{
+    ts::TSStitcher stitcher(NULLREP);
+    TSUNIT_ASSERT(stitcher.open(_tempFileName));
+
+    ts::TSPacket chunk1[] = {DataPacket(200, 0), DataPacket(200, 1), DataPacket(201, 7), DataPacket(200, 2)};
+    ts::TSPacket chunk2[] = {DataPacket(200, 9), DataPacket(201, 12), DataPacket(200, 10)};
+
+    stitcher.startChunk();
+    TSUNIT_ASSERT(stitcher.addPackets(chunk1, 4));
+    stitcher.startChunk();
+    TSUNIT_ASSERT(stitcher.addPackets(chunk2, 3));
+    TSUNIT_EQUAL(7, stitcher.packetCount());
+    TSUNIT_EQUAL(3, stitcher.ccFixCount());
+    TSUNIT_ASSERT(stitcher.close());
+
+    ts::TSPacketVector packets;
+    readFile(packets);
+    TSUNIT_EQUAL(7, packets.size());
+    TSUNIT_EQUAL(0, packets[0].getCC());
+    TSUNIT_EQUAL(1, packets[1].getCC());
+    TSUNIT_EQUAL(7, packets[2].getCC());
+    TSUNIT_EQUAL(2, packets[3].getCC());
+    TSUNIT_EQUAL(3, packets[4].getCC());
+    TSUNIT_EQUAL(8, packets[5].getCC());
+    TSUNIT_EQUAL(4, packets[6].getCC());
+}
+
+void TSStitcherTest::testVersions()
+{
+    ts::TSStitcher stitcher(NULLREP);
+    TSUNIT_ASSERT(stitcher.open(_tempFileName));
+
+    // Each chunk restarts its own versions.
+    ts::TSPacket chunk1[] = {PATPacket(3, 1000, 0), PATPacket(3, 1000, 1)};
+    ts::TSPacket chunk2[] = {PATPacket(3, 1001, 0), PATPacket(3, 1001, 1)};
+    ts::TSPacket chunk3[] = {PATPacket(7, 1001, 5), PATPacket(8, 1000, 6)};
+
+    stitcher.startChunk();
+    TSUNIT_ASSERT(stitcher.addPackets(chunk1, 2));
+    stitcher.startChunk();
+    TSUNIT_ASSERT(stitcher.addPackets(chunk2, 2));
+    stitcher.startChunk();
+    TSUNIT_ASSERT(stitcher.addPackets(chunk3, 2));
+    TSUNIT_EQUAL(4, stitcher.versionFixCount());
+    TSUNIT_ASSERT(stitcher.close());
+
+    ts::TSPacketVector packets;
+    readFile(packets);
+    TSUNIT_EQUAL(6, packets.size());
+
+    // Expected versions and PMT PID's in output file.
+    static const uint8_t versions[] = {3, 3, 4, 4, 4, 5};
+    static const ts::PID pmt_pids[] = {1000, 1000, 1001, 1001, 1001, 1000};
+
+    ts::DuckContext duck;
+    for (size_t i = 0; i < packets.size(); ++i) {
+        TSUNIT_EQUAL(i, packets[i].getCC());
+        TSUNIT_ASSERT(packets[i].getPUSI());
+        const uint8_t* section = packets[i].getPayload() + 1;
+        const size_t size = 3 + (ts::GetUInt16(section + 1) & 0x0FFF);
+        ts::BinaryTable table;
+        TSUNIT_ASSERT(table.addSection(new ts::Section(section, size, ts::PID_PAT, ts::CRC32::CHECK)));
+        TSUNIT_ASSERT(table.isValid());
+        ts::PAT pat(duck, table);
+        TSUNIT_ASSERT(pat.isValid());
+        TSUNIT_EQUAL(versions[i], pat.version);
+        TSUNIT_EQUAL(1, pat.pmts.size());
+        TSUNIT_EQUAL(pmt_pids[i], pat.pmts[100]);
+    }
+}
+
+void TSStitcherTest::testMultiSections()
+{
+    ts::TSStitcher stitcher(NULLREP);
+    TSUNIT_ASSERT(stitcher.open(_tempFileName));
+
+    // In chunk 2, only the second section differs from chunk 1: the whole table gets a new version.
+    // In chunk 3, the table is identical to chunk 2: it keeps the same version.
+    ts::TSPacketVector chunk1, chunk2, chunk3;
+    SDTPackets(chunk1, 2, 0xAA, 0xBB, 0);
+    SDTPackets(chunk2, 5, 0xAA, 0xCC, 0);
+    SDTPackets(chunk3, 9, 0xAA, 0xCC, 7);
+
+    stitcher.startChunk();
+    TSUNIT_ASSERT(stitcher.addPackets(chunk1.data(), chunk1.size()));
+    stitcher.startChunk();
+    TSUNIT_ASSERT(stitcher.addPackets(chunk2.data(), chunk2.size()));
+    stitcher.startChunk();
+    TSUNIT_ASSERT(stitcher.addPackets(chunk3.data(), chunk3.size()));
+    TSUNIT_EQUAL(4, stitcher.versionFixCount());
+    TSUNIT_ASSERT(stitcher.close());
+
+    ts::TSPacketVector packets;
+    readFile(packets);
+    TSUNIT_EQUAL(6, packets.size());
+
+    // Expected versions and section numbers in output file.
+    static const uint8_t versions[] = {2, 2, 3, 3, 3, 3};
+    static const uint8_t fills[] = {0xAA, 0xBB, 0xAA, 0xCC, 0xAA, 0xCC};
+
+    for (size_t i = 0; i < packets.size(); ++i) {
+        TSUNIT_EQUAL(i, packets[i].getCC());
+        TSUNIT_ASSERT(packets[i].getPUSI());
+        const uint8_t* data = packets[i].getPayload() + 1;
+        const size_t size = 3 + (ts::GetUInt16(data + 1) & 0x0FFF);
+        ts::Section section(data, size, ts::PID_SDT, ts::CRC32::CHECK);
+        TSUNIT_ASSERT(section.isValid());
+        TSUNIT_EQUAL(versions[i], section.version());
+        TSUNIT_EQUAL(i % 2, section.sectionNumber());
+        TSUNIT_EQUAL(fills[i], section.payload()[0]);
+    }
+}
@@ -52,12 +52,16 @@ public:
     void testEMMG();
     void testECMGError();
     void testEMMGError();
+    void testParameterOrder();
+    void testManyParameters();
 
     TSUNIT_TEST_BEGIN(TagLengthValueTest);
     TSUNIT_TEST(testECMG);
     TSUNIT_TEST(testEMMG);
     TSUNIT_TEST(testECMGError);
     TSUNIT_TEST(testEMMGError);
+    TSUNIT_TEST(testParameterOrder);
+    TSUNIT_TEST(testManyParameters);
     TSUNIT_TEST_END();
 };
 
@@ -347,3 +351,98 @@ void TagLengthValueTest::testEMMGError()
     debug() << "TagLengthValueTest::testEMMGError: dump" << std::endl << str << std::endl;
     TSUNIT_EQUAL(refString, str);
 }
+
+void TagLengthValueTest::testParameterOrder()
+{
+    // Interleaved occurences of the same parameters.
+    static uint8_t refData[] = {
+        0x03,
+        0x01, 0x06, 0x00, 0x2A,
+        0x70, 0x00, 0x00, 0x02, 0x00, 0x12,
+        0x00, 0x0E, 0x00, 0x02, 0x00, 0x02,
+        0x70, 0x01, 0x00, 0x02, 0x12, 0x34,
+        0x70, 0x00, 0x00, 0x02, 0x00, 0x0D,
+        0x00, 0x0F, 0x00, 0x02, 0x00, 0x03,
+        0x70, 0x01, 0x00, 0x02, 0x56, 0x78,
+        0x70, 0x00, 0x00, 0x02, 0x00, 0x07,
+    };
+
+    ts::tlv::MessageFactory fac(refData, sizeof(refData), ts::ecmgscs::Protocol::Instance());
+    TSUNIT_EQUAL(ts::tlv::OK, fac.errorStatus());
+    TSUNIT_EQUAL(ts::ecmgscs::Tags::stream_error, fac.commandTag());
+    TSUNIT_EQUAL(1, fac.count(ts::ecmgscs::Tags::ECM_channel_id));
+    TSUNIT_EQUAL(3, fac.count(ts::ecmgscs::Tags::error_status));
+    TSUNIT_EQUAL(2, fac.count(ts::ecmgscs::Tags::error_information));
+    TSUNIT_EQUAL(0, fac.count(ts::ecmgscs::Tags::CP_number));
+    TSUNIT_EQUAL(0x0003, fac.get<uint16_t>(ts::ecmgscs::Tags::ECM_stream_id));
+    TSUNIT_EQUAL(0x0012, fac.get<uint16_t>(ts::ecmgscs::Tags::error_status));
+
+    std::vector<uint16_t> values;
+    fac.get(ts::ecmgscs::Tags::error_status, values);
+    TSUNIT_ASSERT(values == std::vector<uint16_t>({0x0012, 0x000D, 0x0007}));
+    fac.get(ts::ecmgscs::Tags::error_information, values);
+    TSUNIT_ASSERT(values == std::vector<uint16_t>({0x1234, 0x5678}));
+
+    // Parameter locations point into the original message.
+    std::vector<ts::tlv::MessageFactory::Parameter> params;
+    fac.get(ts::ecmgscs::Tags::error_information, params);
+    TSUNIT_EQUAL(2, params.size());
+    TSUNIT_ASSERT(params[0].tlv_addr == refData + 17);
+    TSUNIT_ASSERT(params[0].addr == refData + 21);
+    TSUNIT_EQUAL(6, params[0].tlv_size);
+    TSUNIT_EQUAL(2, params[0].length);
+    TSUNIT_ASSERT(params[1].addr == refData + 39);
+
+    // Serializing twice in the same cleared buffer gives the same result.
+    ts::tlv::MessagePtr msg(fac.factory());
+    TSUNIT_ASSERT(!msg.isNull());
+    ts::ByteBlockPtr data(new ts::ByteBlock);
+    {
+        ts::tlv::Serializer zer(data);
+        msg->serialize(zer);
+    }
+    const ts::ByteBlock first(*data);
+    data->clear();
+    {
+        ts::tlv::Serializer zer(data);
+        msg->serialize(zer);
+    }
+    TSUNIT_ASSERT(first == *data);
+
+    // Serialization groups the occurences of each parameter.
+    ts::tlv::MessageFactory fac2(*data, ts::ecmgscs::Protocol::Instance());
+    TSUNIT_EQUAL(ts::tlv::OK, fac2.errorStatus());
+    fac2.get(ts::ecmgscs::Tags::error_status, values);
+    TSUNIT_ASSERT(values == std::vector<uint16_t>({0x0012, 0x000D, 0x0007}));
+}
+
+void TagLengthValueTest::testManyParameters()
+{
+    // More parameters than the message factory stores without allocation.
+    ts::ecmgscs::StreamError refMessage;
+    refMessage.channel_id = 0x0012;
+    refMessage.stream_id = 0x0034;
+    for (uint16_t i = 0; i < 40; ++i) {
+        refMessage.error_status.push_back(0x7000 + i);
+        refMessage.error_information.push_back(0x1000 + i);
+    }
+
+    ts::ByteBlockPtr data(new ts::ByteBlock);
+    ts::tlv::Serializer zer(data);
+    refMessage.serialize(zer);
+
+    ts::tlv::MessageFactory fac(*data, ts::ecmgscs::Protocol::Instance());
+    TSUNIT_EQUAL(ts::tlv::OK, fac.errorStatus());
+    TSUNIT_EQUAL(1, fac.count(ts::ecmgscs::Tags::ECM_channel_id));
+    TSUNIT_EQUAL(40, fac.count(ts::ecmgscs::Tags::error_status));
+    TSUNIT_EQUAL(40, fac.count(ts::ecmgscs::Tags::error_information));
+
+    ts::tlv::MessagePtr msg(fac.factory());
+    TSUNIT_ASSERT(!msg.isNull());
+    ts::ecmgscs::StreamError* ptr = dynamic_cast<ts::ecmgscs::StreamError*>(msg.pointer());
+    TSUNIT_ASSERT(ptr != nullptr);
+    TSUNIT_EQUAL(refMessage.channel_id, ptr->channel_id);
+    TSUNIT_EQUAL(refMessage.stream_id, ptr->stream_id);
+    TSUNIT_ASSERT(refMessage.error_status == ptr->error_status);
+    TSUNIT_ASSERT(refMessage.error_information == ptr->error_information);
+}